@@ -0,0 +1,125 @@
+//----------------------------------------------
+// Module: gateway_stream.h
+// Description: Binary record stream from the
+//   gateways to host clients
+// Author: Mark Gavin
+// Created: 2026-02-15
+// Copyright: (c) 2025-2026 by Mark Gavin
+// License: Proprietary - All Rights Reserved
+//
+// A client that sends {"cmd":"output","format":
+// "binary"} gets records instead of JSON lines.
+// Each record is a type byte, a payload and a
+// CRC-8 (LoRaProtocol_Crc8 over type and payload),
+// COBS-encoded and ended by a 0x00. The encoding
+// leaves no 0x00 inside a frame, so a reader that
+// joins mid-stream is in step at the next one.
+//
+// Telemetry goes out as the 55-byte packet with
+// the link and ground reference after it; the
+// host does the unit conversions JSON did on the
+// gateway. Flash data is the storage data packet
+// as received. Everything else is the JSON line it
+// would have been, as a text record.
+//
+// Layouts are in docs/PROTOCOL.md. The Heltec
+// gateway keeps its own copy of this encoder.
+//----------------------------------------------
+
+#pragma once
+
+#include "lora_protocol.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+//----------------------------------------------
+// Constants
+//----------------------------------------------
+#define kStreamVersion          1       // Reported in the output reply
+#define kStreamDelimiter        0x00    // Ends every frame
+
+// Record types (first byte after decoding)
+#define kStreamRecordTelemetry  0x01    // StreamTelemetryRecord
+#define kStreamRecordFrame      0x02    // RSSI, SNR, then a LoRa frame as received
+#define kStreamRecordFlashData  0x03    // kLoRaPacketStorageData packet
+#define kStreamRecordText       0x04    // JSON line without its newline
+
+// Gateway flags (StreamTelemetryRecord)
+#define kStreamGatewayGpsValid  0x01    // Gateway position is valid
+
+#define kStreamFrameHeaderLen   3       // RSSI (2) and SNR (1) before the frame
+
+// Encoded size of a record with inLen payload
+// bytes: type and CRC, one COBS code byte per 254
+// and the delimiter
+#define GATEWAY_STREAM_FRAME_SIZE(inLen) ((inLen) + 4 + ((inLen) + 2) / 254)
+
+//----------------------------------------------
+// Telemetry Record (71 bytes, little-endian)
+//----------------------------------------------
+typedef struct __attribute__((packed))
+{
+  LoRaTelemetryPacket pPacket ;   // As received (compact frames expanded)
+  int16_t pRssi ;                 // dBm
+  int8_t pSnr ;                   // dB
+  uint32_t pGroundPressurePa ;    // Gateway barometer, 0 if none
+  uint8_t pGatewayFlags ;         // kStreamGateway*
+  int32_t pGatewayLatitude ;      // Microdegrees
+  int32_t pGatewayLongitude ;     // Microdegrees
+} StreamTelemetryRecord ;
+
+#define kStreamTelemetryLen     71
+
+static_assert(sizeof(StreamTelemetryRecord) == kStreamTelemetryLen, "stream telemetry size") ;
+static_assert(offsetof(StreamTelemetryRecord, pRssi) == kLoRaTelemetryLen, "stream RSSI offset") ;
+static_assert(offsetof(StreamTelemetryRecord, pGroundPressurePa) == 58, "stream ground offset") ;
+static_assert(offsetof(StreamTelemetryRecord, pGatewayLatitude) == 63, "stream gateway GPS offset") ;
+
+//----------------------------------------------
+// Function: GatewayStream_Encode
+// Purpose: Frame one record
+// Parameters:
+//   inType - kStreamRecord*
+//   inPayload - Record payload
+//   inLen - Its length
+//   outFrame - Output buffer
+//   inMaxLen - Buffer size
+//     (GATEWAY_STREAM_FRAME_SIZE(inLen) is enough)
+// Returns: Frame length with the delimiter, 0 if
+//   it does not fit
+//----------------------------------------------
+size_t GatewayStream_Encode(
+  uint8_t inType,
+  const uint8_t * inPayload,
+  size_t inLen,
+  uint8_t * outFrame,
+  size_t inMaxLen) ;
+
+//----------------------------------------------
+// Function: GatewayStream_Decode
+// Purpose: Unframe one record
+// Parameters:
+//   inFrame - Bytes between two delimiters
+//   inLen - Their number
+//   outType - Record type
+//   outPayload - Payload buffer
+//   inMaxLen - Buffer size
+//   outLen - Payload length
+// Returns: true if the frame decoded and its
+//   CRC-8 matched
+// Notes: outPayload may be inFrame; decoding in
+//   place never overtakes the input
+//----------------------------------------------
+bool GatewayStream_Decode(
+  const uint8_t * inFrame,
+  size_t inLen,
+  uint8_t * outType,
+  uint8_t * outPayload,
+  size_t inMaxLen,
+  size_t * outLen) ;
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,695 @@
+//----------------------------------------------
+// Module: lora_protocol.h
+// Description: LoRa packet layout shared by the
+//   flight computer and the gateway
+// Author: Mark Gavin
+// Created: 2026-02-15
+// Modified: 2026-02-16 (all frame layouts, none left in the targets)
+// Copyright: (c) 2025-2026 by Mark Gavin
+// License: Proprietary - All Rights Reserved
+//
+// The one definition of the frame header, packet
+// types, command IDs, status flags, the full
+// telemetry packet and every other frame's
+// layout constants. Both RP2040 firmwares build
+// against it; the layout is pinned below by
+// static asserts, so a field moved by accident
+// stops the build instead of shifting every field
+// after it on air.
+//
+// Received frames are read in place: the
+// LoRaProtocol_Get* accessors take the buffer and
+// a field offset (offsetof on the packet struct)
+// and assemble little-endian values a byte at a
+// time, with no copy and no alignment needed.
+//
+// The Heltec sketches cannot include files from
+// outside their folders; they keep their own
+// copies of the structs with the same asserts.
+// Host tools include it from C++ as it is.
+//----------------------------------------------
+
+#pragma once
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <assert.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+//----------------------------------------------
+// Frame Header
+//----------------------------------------------
+#define kLoRaMagic              0xAF  // Byte 0 of every frame but compact telemetry
+#define kLoRaMagicCompact       0xAC  // Bit-packed telemetry frame (own magic, no type)
+#define kLoRaMagicCompactEvent  0xAD  // Compact frame followed by an event trailer
+#define kLoRaCrc8Init           0xFF  // CRC-8 initial value
+
+//----------------------------------------------
+// Packet Types (byte 1)
+//----------------------------------------------
+#define kLoRaPacketTelemetry    0x01
+#define kLoRaPacketStatus       0x02
+#define kLoRaPacketCommand      0x03
+#define kLoRaPacketAck          0x04
+#define kLoRaPacketData         0x05
+#define kLoRaPacketStorageList  0x06  // Storage list response
+#define kLoRaPacketStorageData  0x07  // Storage data chunk
+#define kLoRaPacketInfo         0x08  // Device info response
+#define kLoRaPacketBaroCompare  0x09  // Baro sensor comparison (debug)
+#define kLoRaPacketTelemetryBatch 0x0A  // Batched 100 Hz samples
+#define kLoRaPacketBeacon       0x0B  // TDMA beacon and slot table
+#define kLoRaPacketFlashBulk    0x0C  // Bulk flash download chunk
+#define kLoRaPacketRateAck      0x0D  // Data rate proposal confirm
+#define kLoRaPacketAckSummary   0x0E  // Periodic ACK for every rocket heard
+#define kLoRaPacketParity       0x0F  // FEC parity over a telemetry group
+#define kLoRaPacketRequest      0x10  // Command with a request ID
+#define kLoRaPacketCommandReply 0x11  // Outcome of a kLoRaPacketRequest
+#define kLoRaPacketRecovery     0x12  // GPS recovery beacon after landing
+#define kLoRaPacketBenchmark    0x13  // Link benchmark frame
+
+//----------------------------------------------
+// Command IDs (sent in kLoRaPacketCommand)
+//----------------------------------------------
+#define kCmdArm             0x01
+#define kCmdDisarm          0x02
+#define kCmdStatus          0x03
+#define kCmdReset           0x04
+#define kCmdDownload        0x05
+#define kCmdPing            0x06
+#define kCmdInfo            0x07  // Request device info
+
+// Mode commands
+#define kCmdOrientationMode 0x08  // Enable/disable high-rate orientation testing
+#define kCmdSetRocketName   0x09  // Set rocket name (followed by null-terminated string)
+#define kCmdTelemetryFormat 0x0B  // Select telemetry frame (param: kTelemetryFormat*)
+#define kCmdTelemetryBatch  0x0C  // Enable/disable batched telemetry in flight
+#define kCmdDataRate        0x0D  // Propose/commit a data rate
+#define kCmdFec             0x0E  // FEC group size (param: 0 off, 2, 4 or 8)
+#define kCmdChannelPlan     0x0F  // Send on the rocket's own channel (param: 0/1)
+#define kCmdTelemetryProfile 0x30 // Telemetry interval per flight phase
+#define kCmdBenchmark       0x31  // Run a link benchmark
+
+// Debug commands
+#define kCmdBaroCompare     0x0A  // Start/stop baro comparison stream
+
+// Storage commands
+#define kCmdSdList          0x10
+#define kCmdSdRead          0x11
+#define kCmdSdDelete        0x12
+#define kCmdFlashList       0x20
+#define kCmdFlashRead       0x21
+#define kCmdFlashDelete     0x22
+#define kCmdFlashBulkRead   0x23  // Stream a whole flight (slot, session)
+#define kCmdFlashBulkAck    0x24  // Received-chunk bitmap
+
+//----------------------------------------------
+// Status Flags (telemetry, batch and recovery
+// frames)
+//----------------------------------------------
+#define kFlagPyro1Continuity    0x01
+#define kFlagPyro2Continuity    0x02
+#define kFlagSdLogging          0x04
+#define kFlagLowBattery         0x08
+#define kFlagGpsFix             0x10  // GPS has valid fix
+#define kFlagSensorOk           0x20
+#define kFlagRxWindow           0x40  // Listening for commands after this frame
+#define kFlagOrientationMode    0x80  // Orientation testing mode active
+
+//----------------------------------------------
+// LoRa Telemetry Packet (binary, 55 bytes)
+// Sent at 10 Hz during flight; little-endian
+//----------------------------------------------
+typedef struct __attribute__((packed))
+{
+  // Header (5 bytes)
+  uint8_t pMagic ;                // 0xAF (Avionics Flight)
+  uint8_t pPacketType ;           // 0x01 = telemetry
+  uint8_t pRocketId ;             // Rocket ID (0-15 for multi-rocket support)
+  uint16_t pSequence ;            // Packet sequence number
+
+  // Time (4 bytes)
+  uint32_t pTimeMs ;              // Mission time (ms)
+
+  // Barometric data (12 bytes)
+  int32_t pAltitudeCm ;           // Barometric altitude in centimeters
+  int16_t pVelocityCmps ;         // Vertical velocity in cm/s
+  uint32_t pPressurePa ;          // Pressure (Pa)
+  int16_t pTemperatureC10 ;       // Temperature * 10 (0.1C resolution)
+
+  // GPS data (13 bytes)
+  int32_t pGpsLatitude ;          // Latitude in microdegrees (deg * 1e6)
+  int32_t pGpsLongitude ;         // Longitude in microdegrees (deg * 1e6)
+  int16_t pGpsSpeedCmps ;         // GPS ground speed in cm/s
+  uint16_t pGpsHeadingDeg10 ;     // Heading * 10 (0-3600 = 0-360.0 deg)
+  uint8_t pGpsSatellites ;        // Number of satellites in use
+
+  // Accelerometer (6 bytes) - values in milli-g (mg)
+  int16_t pAccelX ;               // Accelerometer X
+  int16_t pAccelY ;               // Accelerometer Y
+  int16_t pAccelZ ;               // Accelerometer Z
+
+  // Gyroscope (6 bytes) - values in 0.1 degrees/second
+  int16_t pGyroX ;                // Gyroscope X
+  int16_t pGyroY ;                // Gyroscope Y
+  int16_t pGyroZ ;                // Gyroscope Z
+
+  // Magnetometer (6 bytes) - values in milligauss
+  int16_t pMagX ;                 // Magnetometer X
+  int16_t pMagY ;                 // Magnetometer Y
+  int16_t pMagZ ;                 // Magnetometer Z
+
+  // Status (3 bytes)
+  uint8_t pState ;                // Flight state enum
+  uint8_t pFlags ;                // Status flags
+  uint8_t pCrc ;                  // CRC-8
+} LoRaTelemetryPacket ;
+
+#define kLoRaTelemetryLen       55
+
+//----------------------------------------------
+// Layout Checks
+// Offsets are what docs/PROTOCOL.md and the
+// Heltec sketches give; change all three or none
+//----------------------------------------------
+static_assert(sizeof(LoRaTelemetryPacket) == kLoRaTelemetryLen, "telemetry packet size") ;
+static_assert(offsetof(LoRaTelemetryPacket, pRocketId) == 2, "telemetry rocket ID offset") ;
+static_assert(offsetof(LoRaTelemetryPacket, pSequence) == 3, "telemetry sequence offset") ;
+static_assert(offsetof(LoRaTelemetryPacket, pTimeMs) == 5, "telemetry time offset") ;
+static_assert(offsetof(LoRaTelemetryPacket, pAltitudeCm) == 9, "telemetry altitude offset") ;
+static_assert(offsetof(LoRaTelemetryPacket, pGpsLatitude) == 21, "telemetry GPS offset") ;
+static_assert(offsetof(LoRaTelemetryPacket, pAccelX) == 34, "telemetry accel offset") ;
+static_assert(offsetof(LoRaTelemetryPacket, pState) == 52, "telemetry state offset") ;
+static_assert(offsetof(LoRaTelemetryPacket, pFlags) == 53, "telemetry flags offset") ;
+static_assert(offsetof(LoRaTelemetryPacket, pCrc) == kLoRaTelemetryLen - 1, "telemetry CRC offset") ;
+
+//----------------------------------------------
+// LoRa Compact Telemetry Frame (bit-packed,
+// 19-23 bytes in flight, 44 bytes max)
+//----------------------------------------------
+// Selected per flight computer with
+// kCmdTelemetryFormat. A magic byte of its own
+// replaces magic + type. Fields are packed
+// LSB-first in this order:
+//
+//   Core (always, 139 bits)
+//     8  magic (kLoRaMagicCompact)
+//     4  rocket ID
+//     8  sequence (low byte)
+//     3  flight state
+//     8  flags (kFlag*)
+//     3  sections present (kCompactHas*)
+//    18  time since launch, 10 ms (saturates)
+//    19  altitude, dm (signed, +/-26 km)
+//    15  velocity, dm/s (signed)
+//    17  pressure, Pa
+//    36  accel X/Y/Z, 12 bits each, 20 mg (signed)
+//   GPS (with a fix, 34 bits)
+//     2  origin epoch
+//    32  lat/lon offset from the origin, 16 bits
+//        each, 1e-5 deg (signed, ~+/-36 km)
+//   Orientation (orientation mode only, 72 bits)
+//    36  gyro X/Y/Z, 12 bits each, 1 dps (signed)
+//    36  mag X/Y/Z, 12 bits each, 1 mG (signed)
+//   Slow (every few frames in flight, on
+//   an origin change and at the low idle/landed
+//   rates, 96 bits)
+//     2  origin epoch
+//    64  origin lat/lon, microdegrees (int32)
+//     8  temperature, 0.5 C steps from -40 C
+//     5  satellites
+//     9  GPS speed, m/s
+//     8  GPS heading, 360/256 deg
+//
+// Padded to a whole byte, then CRC-8 over all
+// preceding bytes. Signed fields saturate at
+// their range.
+//
+// The GPS origin follows the first fix, is
+// re-latched at arming (launch position) and
+// moves again only when an offset would not fit.
+// Each move bumps the 2-bit epoch so a receiver
+// never applies an offset to the wrong origin.
+//----------------------------------------------
+#define kCompactTelemetryMinLen 19    // Core only, with CRC
+#define kCompactTelemetryMaxLen 44
+
+// Telemetry formats (kCmdTelemetryFormat)
+#define kTelemetryFormatFull    0     // LoRaTelemetryPacket
+#define kTelemetryFormatCompact 1     // Bit-packed frame
+
+// Section bits (compact frame)
+#define kCompactHasGps          0x01
+#define kCompactHasOrientation  0x02
+#define kCompactHasSlow         0x04
+
+//----------------------------------------------
+// LoRa Telemetry Batch Frame (variable length)
+//----------------------------------------------
+// Carries the 100 Hz samples taken since the
+// previous frame, oldest first. In flight with
+// batching enabled it replaces every telemetry
+// packet except every few (a snapshot),
+// which still carries GPS and the rest.
+//
+//   0      magic (kLoRaMagic)
+//   1      type (kLoRaPacketTelemetryBatch)
+//   2      rocket ID
+//   3-4    sequence (shared with telemetry)
+//   5      flight state
+//   6      flags (kFlag*)
+//   7      sample count
+//   8-11   first sample time since launch, ms (int32)
+//   12-15  first sample altitude, dm (int32)
+//   16-17  first sample velocity, dm/s (int16)
+//   18-19  first sample vertical accel, 0.1 m/s^2 (int16)
+//   20..   each further sample as four varints:
+//          time step (ms), then zigzag deltas
+//          of altitude, velocity and accel
+//   last   CRC-8 over all preceding bytes
+//
+// Varints hold 7 bits per byte, low group first,
+// with the top bit set on all but the last byte.
+// Zigzag maps 0,-1,1,-2,... to 0,1,2,3,... so a
+// small delta of either sign is one byte; a
+// sample costs about 4 bytes in flight.
+//----------------------------------------------
+#define kBatchHeaderLen         20
+#define kBatchFrameMaxLen       128
+
+//----------------------------------------------
+// Telemetry Profiles
+//----------------------------------------------
+// Each flight state sends telemetry at the
+// interval of its profile. kCmdTelemetryProfile
+// sets one:
+//
+//   4      profile (kTelemetryProfile*)
+//   5-6    interval, ms (uint16)
+//
+// Profile kTelemetryProfileDefaults restores all
+// five. Orientation mode still sends at 10 Hz in
+// idle. The flight computer batches at most 32
+// samples, so a descent interval past 320 ms
+// drops the oldest samples in each frame.
+//----------------------------------------------
+#define kTelemetryProfileIdle     0
+#define kTelemetryProfileArmed    1
+#define kTelemetryProfileAscent   2   // Boost, coast and apogee
+#define kTelemetryProfileDescent  3
+#define kTelemetryProfileLanded   4   // Landed and complete (recovery beacon)
+#define kTelemetryProfileCount    5
+#define kTelemetryProfileDefaults 0xFF
+#define kTelemetryProfileMinMs    50
+#define kTelemetryProfileMaxMs    60000
+
+//----------------------------------------------
+// LoRa Recovery Beacon (21 bytes)
+//----------------------------------------------
+// Replaces telemetry once landed: just what a
+// recovery crew needs, in half the airtime of a
+// full packet, at the landed profile's interval.
+// It shares the telemetry sequence, so it is
+// ACKed, FEC-protected and carries the event
+// trailer like any telemetry frame. Out of range
+// of the gateway the adaptive data rate falls
+// back to the base rate, the longest-range one.
+//
+//   0      magic (kLoRaMagic)
+//   1      type (kLoRaPacketRecovery)
+//   2      rocket ID
+//   3-4    sequence (shared with telemetry)
+//   5      flight state
+//   6      flags (kFlag*)
+//   7      satellites
+//   8-11   latitude, microdegrees (int32)
+//   12-15  longitude, microdegrees (int32)
+//   16-17  max altitude AGL, m (uint16)
+//   18-19  time since landing, s (uint16,
+//          saturates)
+//   20     CRC-8 over bytes 0-19
+//----------------------------------------------
+#define kRecoveryPacketLen      21
+
+//----------------------------------------------
+// ACK Summary (kLoRaPacketAckSummary)
+//
+// Sent by the gateway on its own cadence instead
+// of one kLoRaPacketAck per telemetry frame. One
+// entry per rocket heard since the previous
+// summary; a rocket not listed was not heard.
+//
+//   0      magic (kLoRaMagic)
+//   1      type (kLoRaPacketAckSummary)
+//   2      summary sequence
+//   3-4    ACK interval, ms (next summary due by then)
+//   5      entry count
+//   6..    entries of kAckSummaryEntryLen:
+//     0    rocket ID
+//     1    latest telemetry sequence (low byte)
+//     2-3  bitmap: bit n set if sequence - 1 - n
+//          was received
+//     4    frames received since the last summary
+//     5    average SNR of those, dB (int8)
+//     6-7  average RSSI of those, dBm (int16)
+//   then, optionally, flight event ACKs:
+//     0    event ACK count
+//     1..  entries of kAckEventEntryLen:
+//       0  rocket ID
+//       1  latest event sequence received
+//----------------------------------------------
+#define kAckSummaryHeaderLen    6
+#define kAckSummaryEntryLen     8
+#define kAckSummaryMaxEntries   12    // Fits the 128-byte receive buffer
+#define kAckEventEntryLen       2
+#define kAckEventMaxEntries     8
+
+//----------------------------------------------
+// Receive Window (kFlagRxWindow)
+//
+// Without TDMA, a telemetry frame with
+// kFlagRxWindow set is followed by a window in
+// which the rocket sends nothing and listens on
+// the control channel. It runs from TxDone for
+// kRxWindowGuardMs, for the gateway to turn
+// around, plus the airtime of a
+// kRxWindowCommandLen-byte command at the current
+// data rate. The gateway holds commands for a
+// rocket that announces windows and sends one in
+// each. A window follows every frame when the
+// gap to the next leaves room, and otherwise at
+// least once a second (the next frame waits
+// for it to close).
+//----------------------------------------------
+#define kRxWindowGuardMs        20
+#define kRxWindowCommandLen     40    // Longest command: set name
+
+//----------------------------------------------
+// Command Request (kLoRaPacketRequest) and Reply
+// (kLoRaPacketCommandReply)
+//
+// A command for one rocket may carry a request
+// ID, so the gateway can keep several in flight
+// and resend one that goes unanswered. The
+// request is a kLoRaPacketCommand with the ID
+// inserted before the command byte:
+//
+//   0      magic (kLoRaMagic)
+//   1      type (kLoRaPacketRequest)
+//   2      target rocket ID
+//   3      request ID
+//   4      command (kCmd*)
+//   5..    parameters, as in kLoRaPacketCommand
+//
+// The rocket answers every request, after any
+// reply packet the command itself sends:
+//
+//   0      magic (kLoRaMagic)
+//   1      type (kLoRaPacketCommandReply)
+//   2      rocket ID
+//   3      request ID
+//   4      command (kCmd*)
+//   5      status (kReply*)
+//
+// A repeat of one of the last few requests
+// (same ID and command, within 15 s) is
+// answered again without
+// being carried out twice; read requests are
+// served again, since their answer was lost too.
+//----------------------------------------------
+#define kCommandReplyLen        6
+
+// Reply status
+#define kReplyOk                0x00
+#define kReplyRejected          0x01  // Bad parameters, or not now
+#define kReplyUnknown           0x02  // Command not supported
+
+//----------------------------------------------
+// Flight Event Trailer
+//
+// A state change is journaled as an event
+// (event_journal.h) and rides on telemetry until
+// the gateway acknowledges it: the oldest event
+// not yet ACKed is appended to each telemetry
+// frame (full, compact, batch or recovery)
+// after the frame's own CRC:
+//
+//   0      event sequence
+//   1      event type (kEvent*)
+//   2      flight state after the event
+//   3-6    time, ms since boot (uint32)
+//   7-10   altitude, dm (int32)
+//   11-12  velocity, dm/s (int16)
+//   13     CRC-8 over bytes 0-12
+//   14     kEventTrailerTag
+//
+// A frame with a trailer says so in its header:
+// kLoRaPacketEventFlag is set in the type byte
+// of a full, batch or recovery frame, and a
+// compact frame starts with kLoRaMagicCompactEvent.
+// The mark is made after the frame's CRC, so a
+// receiver clears it (LoRaProtocol_TakeEventMark)
+// and strips the trailer before decoding the
+// frame. Frames without the mark are never
+// searched for a trailer.
+//
+// The ACK summary names the latest sequence
+// received from each rocket. Only the oldest
+// unacknowledged event is ever on air, so the
+// rocket takes an ACK naming that event and
+// ignores any other sequence.
+//----------------------------------------------
+#define kEventTrailerLen        15
+#define kEventTrailerTag        0xE7
+#define kLoRaPacketEventFlag    0x80  // Type byte: event trailer follows
+
+// Event types
+#define kEventArmed             0x01
+#define kEventDisarmed          0x02  // Armed back to idle
+#define kEventLaunch            0x03
+#define kEventBurnout           0x04
+#define kEventApogee            0x05
+#define kEventDescent           0x06
+#define kEventLanded            0x07
+#define kEventComplete          0x08
+#define kEventReset             0x09  // Back to idle from flight or landed
+
+//----------------------------------------------
+// TDMA Beacon (kLoRaPacketBeacon)
+// Header of kTdmaBeaconHeaderLen bytes, then one
+// rocket ID (or kTdmaSlotFree) per slot; the
+// layout is in tdma.h
+//----------------------------------------------
+#define kTdmaMaxSlots           16
+#define kTdmaSlotFree           0xFF
+#define kTdmaBeaconHeaderLen    12
+
+//----------------------------------------------
+// Bulk Flash Download (kLoRaPacketFlashBulk and
+// kCmdFlashBulkAck); layout in flash_bulk.h
+//----------------------------------------------
+#define kBulkSamplesPerChunk    2       // Delta-coded: 116 bytes at worst
+#define kBulkSampleLen          48      // sizeof(FlightSample)
+#define kBulkHeaderLen          11
+#define kBulkWindowChunks       32      // Span of the ACK bitmap
+#define kBulkFlagPoll           0x01
+#define kBulkMaxRun             8       // Chunks in one packet
+#define kBulkSampleFields       20      // Sample fields, delta-coded one by one
+#define kBulkAckLen             12
+#define kBulkRequestLen         7       // kCmdFlashBulkRead with the transfer rate
+
+//----------------------------------------------
+// Data Rate Change (kCmdDataRate and
+// kLoRaPacketRateAck); layout in link_rate.h
+//----------------------------------------------
+#define kRatePropose            0x01
+#define kRateCommit             0x02
+#define kRateConfirmLen         8
+#define kRateCommandLen         7
+
+//----------------------------------------------
+// FEC Parity (kLoRaPacketParity); layout in
+// telemetry_fec.h
+//----------------------------------------------
+#define kFecHeaderLen           7
+#define kFecMaxGroup            8
+#define kFecMaxFrameLen         kBatchFrameMaxLen
+
+//----------------------------------------------
+// Link Benchmark (kCmdBenchmark and
+// kLoRaPacketBenchmark); layout in link_bench.h
+//----------------------------------------------
+#define kBenchParamsLen         10      // Command bytes 4-13
+#define kBenchCommandLen        (4 + kBenchParamsLen)
+#define kBenchMaxChoices        3       // TX powers, frame lengths
+#define kBenchMaxPoints         48
+#define kBenchMaxFrames         100
+#define kBenchHeaderLen         6
+#define kBenchMinLen            (kBenchHeaderLen + 2)
+#define kBenchAnswerLen         8
+#define kBenchStartMs           500
+#define kBenchGuardMs           20
+#define kBenchFrameGapUs        3000    // TxDone to the next frame keyed up
+#define kBenchMaxMs             600000  // Whole run
+#define kBenchPointAnswer       0xFF
+
+//----------------------------------------------
+// Read-in-Place Accessors
+// inOffset is a byte offset into inData, usually
+// offsetof(LoRaTelemetryPacket, pField)
+//----------------------------------------------
+static inline uint8_t LoRaProtocol_GetU8(const uint8_t * inData, size_t inOffset)
+{
+  return inData[inOffset] ;
+}
+
+static inline uint16_t LoRaProtocol_GetU16(const uint8_t * inData, size_t inOffset)
+{
+  return (uint16_t)(inData[inOffset] | (inData[inOffset + 1] << 8)) ;
+}
+
+static inline int16_t LoRaProtocol_GetI16(const uint8_t * inData, size_t inOffset)
+{
+  return (int16_t)LoRaProtocol_GetU16(inData, inOffset) ;
+}
+
+static inline uint32_t LoRaProtocol_GetU32(const uint8_t * inData, size_t inOffset)
+{
+  return (uint32_t)inData[inOffset] | ((uint32_t)inData[inOffset + 1] << 8) |
+         ((uint32_t)inData[inOffset + 2] << 16) | ((uint32_t)inData[inOffset + 3] << 24) ;
+}
+
+static inline int32_t LoRaProtocol_GetI32(const uint8_t * inData, size_t inOffset)
+{
+  return (int32_t)LoRaProtocol_GetU32(inData, inOffset) ;
+}
+
+//----------------------------------------------
+// Function: LoRaProtocol_MarkEventTrailer
+// Purpose: Mark a telemetry frame as carrying an
+//   event trailer, after its CRC is in place
+// Parameters:
+//   ioFrame - Full, compact, batch or recovery frame
+//----------------------------------------------
+static inline void LoRaProtocol_MarkEventTrailer(uint8_t * ioFrame)
+{
+  if (ioFrame[0] == kLoRaMagicCompact)
+  {
+    ioFrame[0] = kLoRaMagicCompactEvent ;
+  }
+  else
+  {
+    ioFrame[1] |= kLoRaPacketEventFlag ;
+  }
+}
+
+//----------------------------------------------
+// Function: LoRaProtocol_TakeEventMark
+// Purpose: Clear the event trailer mark from a
+//   received frame
+// Parameters:
+//   ioFrame - Received frame
+//   inLen - Its length
+// Returns: true if the frame was marked (its last
+//   kEventTrailerLen bytes are the trailer)
+//----------------------------------------------
+static inline bool LoRaProtocol_TakeEventMark(uint8_t * ioFrame, size_t inLen)
+{
+  if (inLen >= 1 && ioFrame[0] == kLoRaMagicCompactEvent)
+  {
+    ioFrame[0] = kLoRaMagicCompact ;
+    return true ;
+  }
+  if (inLen >= 2 && ioFrame[0] == kLoRaMagic && (ioFrame[1] & kLoRaPacketEventFlag) != 0)
+  {
+    ioFrame[1] &= (uint8_t)~kLoRaPacketEventFlag ;
+    return true ;
+  }
+  return false ;
+}
+
+//----------------------------------------------
+// Function: LoRaProtocol_Crc8
+// Purpose: CRC-8 used by every frame (polynomial
+//   0x31, initial value 0xFF, no reflection)
+// Parameters:
+//   inData - Bytes to check
+//   inLen - Their number
+// Returns: CRC-8
+// Notes: Table-driven, one lookup per byte
+//----------------------------------------------
+uint8_t LoRaProtocol_Crc8(const uint8_t * inData, size_t inLen) ;
+
+//----------------------------------------------
+// Function: LoRaProtocol_Crc8Update
+// Purpose: Carry a CRC-8 on over more bytes, for
+//   data that is not in one buffer
+// Parameters:
+//   inCrc - CRC so far (kLoRaCrc8Init to start)
+//   inData - Next bytes
+//   inLen - Their number
+// Returns: CRC-8 over everything so far
+//----------------------------------------------
+uint8_t LoRaProtocol_Crc8Update(uint8_t inCrc, const uint8_t * inData, size_t inLen) ;
+
+//----------------------------------------------
+// Function: LoRaProtocol_PutSampleDelta
+// Purpose: Append a stored flight sample as the
+//   change from the one before it
+// Parameters:
+//   outData - Packet being built
+//   inLen - Its length so far
+//   inMaxLen - Room in the packet
+//   inPrevious - Sample before (kBulkSampleLen bytes)
+//   inSample - Sample to append
+// Returns: New length, 0 if it does not fit
+// Notes: One varint per field of FlightSample
+//   (kBulkSampleFields): the zigzag difference at
+//   the field's own width, so every value comes
+//   back exactly. A sample at rest takes 20 bytes,
+//   one in flight about 22, the worst case 68.
+//----------------------------------------------
+uint8_t LoRaProtocol_PutSampleDelta(
+  uint8_t * outData,
+  uint8_t inLen,
+  uint8_t inMaxLen,
+  const uint8_t * inPrevious,
+  const uint8_t * inSample) ;
+
+//----------------------------------------------
+// Function: LoRaProtocol_GetSampleDelta
+// Purpose: Rebuild a sample written by
+//   LoRaProtocol_PutSampleDelta
+// Parameters:
+//   inData - Received packet
+//   inLen - Its length
+//   ioOffset - Read position, moved past the sample
+//   inPrevious - Sample before (kBulkSampleLen bytes)
+//   outSample - The sample (may be inPrevious)
+// Returns: false if the packet ends inside it
+//----------------------------------------------
+bool LoRaProtocol_GetSampleDelta(
+  const uint8_t * inData,
+  int inLen,
+  int * ioOffset,
+  const uint8_t * inPrevious,
+  uint8_t * outSample) ;
+
+//----------------------------------------------
+// Function: LoRaProtocol_IsTelemetry
+// Purpose: Check a received frame is a whole,
+//   intact full telemetry packet
+// Parameters:
+//   inData - Received frame
+//   inLen - Its length
+// Returns: true if magic, type, length and CRC
+//   are right
+//----------------------------------------------
+bool LoRaProtocol_IsTelemetry(const uint8_t * inData, size_t inLen) ;
+
+#ifdef __cplusplus
+}
+#endif
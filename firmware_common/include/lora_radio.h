@@ -0,0 +1,673 @@
+//----------------------------------------------
+// Module: lora_radio.h
+// Description: RFM95 LoRa Radio Driver (SX1276)
+// Author: Mark Gavin
+// Created: 2026-01-10
+// Modified: 2026-02-08 (interrupt-driven TX/RX queues)
+// Modified: 2026-02-09 (DMA FIFO bursts, 8 MHz SPI)
+// Modified: 2026-02-12 (TX windows for TDMA slots)
+// Modified: 2026-02-14 (data rate table for adaptive switching)
+// Modified: 2026-02-15 (channel plan, separate TX frequency)
+// Modified: 2026-02-15 (receive window after a transmission)
+// Modified: 2026-02-15 (listen before talk)
+// Modified: 2026-02-15 (airtime at any rate and coding rate)
+// Modified: 2026-02-16 (one copy in firmware_common for both targets)
+// Copyright: (c) 2025-2026 by Mark Gavin
+// License: Proprietary - All Rights Reserved
+//
+// Hardware:
+//   - Adafruit Feather RP2040 with RFM95 LoRa (5714)
+//   - 915 MHz ISM band (North America)
+//   - SPI interface (kSpiLoRaBaudrate; FIFO bursts
+//     by DMA when two channels are free)
+//
+// Shared by the flight computer and the gateway.
+// Pins and the listen-before-talk default come
+// from each target's own pins.h.
+//
+// DIO0 raises a GPIO interrupt on TxDone/RxDone.
+// The ISR only latches the event; SPI1 is shared
+// (SD card, display, WiFi) so all register and
+// FIFO access happens in LoRa_Service from the
+// main loop. Callers queue packets with LoRa_Send
+// and drain received packets with LoRa_Receive;
+// the radio returns to receive on its own after
+// the TX queue empties.
+//
+// A TX window (LoRa_SetTxWindow) holds queued
+// packets until the window opens and starts one
+// only if its time on air ends inside it. A
+// packet longer than the whole window goes out
+// at the window start and counts as an overrun.
+//
+// Transmissions can use a frequency of their own
+// (LoRa_SetTxFrequency); the radio returns to the
+// receive frequency after each one.
+//
+// A packet sent with LoRa_SendWithRxWindow is
+// followed by a receive window: from its TxDone
+// the radio listens and starts nothing else
+// queued until the window has passed.
+//
+// With listen before talk on (kLoRaListenBeforeTalk
+// in pins.h, LoRa_SetListenBeforeTalk) each packet
+// first waits for a clear channel. A preamble
+// being received, or channel activity detection
+// (CAD) on the transmit frequency, finds it busy;
+// the packet then backs off a random time that
+// doubles with each deferral, listening meanwhile.
+// After kLoRaLbtMaxDeferrals, or kLoRaLbtMaxHoldUs
+// from the first check, it goes out regardless so
+// telemetry stays timely. A packet held for a TX
+// window skips the check: the slot is its own.
+//----------------------------------------------
+
+#pragma once
+
+#include <stdint.h>
+#include <stdbool.h>
+
+//----------------------------------------------
+// RFM95/SX1276 Register Addresses
+//----------------------------------------------
+#define RFM95_REG_FIFO                  0x00
+#define RFM95_REG_OP_MODE               0x01
+#define RFM95_REG_FRF_MSB               0x06
+#define RFM95_REG_FRF_MID               0x07
+#define RFM95_REG_FRF_LSB               0x08
+#define RFM95_REG_PA_CONFIG             0x09
+#define RFM95_REG_PA_RAMP               0x0A
+#define RFM95_REG_OCP                   0x0B
+#define RFM95_REG_LNA                   0x0C
+#define RFM95_REG_FIFO_ADDR_PTR         0x0D
+#define RFM95_REG_FIFO_TX_BASE_ADDR     0x0E
+#define RFM95_REG_FIFO_RX_BASE_ADDR     0x0F
+#define RFM95_REG_FIFO_RX_CURRENT_ADDR  0x10
+#define RFM95_REG_IRQ_FLAGS_MASK        0x11
+#define RFM95_REG_IRQ_FLAGS             0x12
+#define RFM95_REG_RX_NB_BYTES           0x13
+#define RFM95_REG_RX_HEADER_CNT_MSB     0x14
+#define RFM95_REG_RX_HEADER_CNT_LSB     0x15
+#define RFM95_REG_RX_PACKET_CNT_MSB     0x16
+#define RFM95_REG_RX_PACKET_CNT_LSB     0x17
+#define RFM95_REG_MODEM_STAT            0x18
+#define RFM95_REG_PKT_SNR_VALUE         0x19
+#define RFM95_REG_PKT_RSSI_VALUE        0x1A
+#define RFM95_REG_RSSI_VALUE            0x1B
+#define RFM95_REG_HOP_CHANNEL           0x1C
+#define RFM95_REG_MODEM_CONFIG_1        0x1D
+#define RFM95_REG_MODEM_CONFIG_2        0x1E
+#define RFM95_REG_SYMB_TIMEOUT_LSB      0x1F
+#define RFM95_REG_PREAMBLE_MSB          0x20
+#define RFM95_REG_PREAMBLE_LSB          0x21
+#define RFM95_REG_PAYLOAD_LENGTH        0x22
+#define RFM95_REG_MAX_PAYLOAD_LENGTH    0x23
+#define RFM95_REG_HOP_PERIOD            0x24
+#define RFM95_REG_FIFO_RX_BYTE_ADDR     0x25
+#define RFM95_REG_MODEM_CONFIG_3        0x26
+#define RFM95_REG_PPM_CORRECTION        0x27
+#define RFM95_REG_FEI_MSB               0x28
+#define RFM95_REG_FEI_MID               0x29
+#define RFM95_REG_FEI_LSB               0x2A
+#define RFM95_REG_RSSI_WIDEBAND         0x2C
+#define RFM95_REG_DETECT_OPTIMIZE       0x31
+#define RFM95_REG_INVERT_IQ             0x33
+#define RFM95_REG_DETECTION_THRESHOLD   0x37
+#define RFM95_REG_SYNC_WORD             0x39
+#define RFM95_REG_DIO_MAPPING_1         0x40
+#define RFM95_REG_DIO_MAPPING_2         0x41
+#define RFM95_REG_VERSION               0x42
+#define RFM95_REG_TCXO                  0x4B
+#define RFM95_REG_PA_DAC                0x4D
+#define RFM95_REG_FORMER_TEMP           0x5B
+#define RFM95_REG_AGC_REF               0x61
+#define RFM95_REG_AGC_THRESH_1          0x62
+#define RFM95_REG_AGC_THRESH_2          0x63
+#define RFM95_REG_AGC_THRESH_3          0x64
+
+//----------------------------------------------
+// Operating Modes
+//----------------------------------------------
+#define RFM95_MODE_LONG_RANGE           0x80
+#define RFM95_MODE_SLEEP                0x00
+#define RFM95_MODE_STDBY                0x01
+#define RFM95_MODE_FSTX                 0x02
+#define RFM95_MODE_TX                   0x03
+#define RFM95_MODE_FSRX                 0x04
+#define RFM95_MODE_RX_CONTINUOUS        0x05
+#define RFM95_MODE_RX_SINGLE            0x06
+#define RFM95_MODE_CAD                  0x07
+
+//----------------------------------------------
+// IRQ Flags
+//----------------------------------------------
+#define RFM95_IRQ_RX_TIMEOUT            0x80
+#define RFM95_IRQ_RX_DONE               0x40
+#define RFM95_IRQ_PAYLOAD_CRC_ERROR     0x20
+#define RFM95_IRQ_VALID_HEADER          0x10
+#define RFM95_IRQ_TX_DONE               0x08
+#define RFM95_IRQ_CAD_DONE              0x04
+#define RFM95_IRQ_FHSS_CHANGE_CHANNEL   0x02
+#define RFM95_IRQ_CAD_DETECTED          0x01
+
+//----------------------------------------------
+// PA Configuration
+//----------------------------------------------
+#define RFM95_PA_BOOST                  0x80
+#define RFM95_PA_OUTPUT_RFO_PIN         0x00
+
+//----------------------------------------------
+// Packet Queues
+//----------------------------------------------
+#define kLoRaMaxPacketLen       255
+#define kLoRaTxQueueSize        4         // Packets waiting for airtime
+#define kLoRaRxQueueSize        4         // Received, not yet read
+#define kLoRaTxTimeoutMs        500       // TxDone watchdog
+#define kLoRaTxWindowLateUs     2000      // Oversize packet: latest start in window
+
+//----------------------------------------------
+// Listen Before Talk
+//----------------------------------------------
+#define kLoRaLbtBackoffUs       5000      // First backoff: 5-10 ms, then doubled
+#define kLoRaLbtMaxDeferrals    4
+#define kLoRaLbtMaxHoldUs       100000    // Sent regardless after this
+#define kLoRaCadTimeoutUs       50000     // CadDone watchdog (SF10: ~17 ms)
+
+//----------------------------------------------
+// Spreading Factors
+//----------------------------------------------
+typedef enum
+{
+  LORA_SF6  = 6 ,
+  LORA_SF7  = 7 ,
+  LORA_SF8  = 8 ,
+  LORA_SF9  = 9 ,
+  LORA_SF10 = 10 ,
+  LORA_SF11 = 11 ,
+  LORA_SF12 = 12
+} LoRa_SpreadingFactor ;
+
+//----------------------------------------------
+// Bandwidth
+//----------------------------------------------
+typedef enum
+{
+  LORA_BW_7_8   = 0 ,   // 7.8 kHz
+  LORA_BW_10_4  = 1 ,   // 10.4 kHz
+  LORA_BW_15_6  = 2 ,   // 15.6 kHz
+  LORA_BW_20_8  = 3 ,   // 20.8 kHz
+  LORA_BW_31_25 = 4 ,   // 31.25 kHz
+  LORA_BW_41_7  = 5 ,   // 41.7 kHz
+  LORA_BW_62_5  = 6 ,   // 62.5 kHz
+  LORA_BW_125   = 7 ,   // 125 kHz
+  LORA_BW_250   = 8 ,   // 250 kHz
+  LORA_BW_500   = 9     // 500 kHz
+} LoRa_Bandwidth ;
+
+//----------------------------------------------
+// Coding Rates
+//----------------------------------------------
+typedef enum
+{
+  LORA_CR_4_5 = 1 ,     // 4/5
+  LORA_CR_4_6 = 2 ,     // 4/6
+  LORA_CR_4_7 = 3 ,     // 4/7
+  LORA_CR_4_8 = 4       // 4/8
+} LoRa_CodingRate ;
+
+//----------------------------------------------
+// Data Rates
+// Spreading factor and bandwidth pairs for
+// adaptive switching, most robust first. Both
+// ends switch by index, so the table must be
+// the same in both firmwares. SF11/SF12 are left
+// out: at 125 kHz they need LowDataRateOptimize.
+//----------------------------------------------
+#define kLoRaDataRateCount      6
+#define kLoRaDataRateBase       3         // SF7 / 125 kHz: boot and fallback rate
+
+typedef struct
+{
+  LoRa_SpreadingFactor pSpreadFactor ;
+  LoRa_Bandwidth pBandwidth ;
+  int8_t pMinSnrDb ;            // Demodulation floor, SNR in this bandwidth
+  int8_t pNoiseDb ;             // Noise bandwidth above 125 kHz
+} LoRa_DataRate ;
+
+//----------------------------------------------
+// Channel Plan
+// Channel 0 is kLoRaFrequency, the control channel
+// every device listens on (beacons, ACKs and
+// commands). Each rocket sends on the uplink
+// channel for its ID; 600 kHz spacing leaves a
+// guard band at the widest data rate (500 kHz).
+// Both firmwares must use the same plan.
+//----------------------------------------------
+#define kLoRaChannelCount       8
+#define kLoRaChannelSpacingHz   600000    // 915.0 to 919.2 MHz
+
+//----------------------------------------------
+// Radio State Structure
+//----------------------------------------------
+typedef struct
+{
+  bool pInitialized ;
+  uint32_t pFrequencyHz ;       // Receive frequency
+  uint32_t pTxFrequencyHz ;     // Transmit frequency (0: receive frequency)
+  LoRa_SpreadingFactor pSpreadFactor ;
+  LoRa_Bandwidth pBandwidth ;
+  LoRa_CodingRate pCodingRate ;
+  uint8_t pDataRate ;         // Data rate table index of SF/bandwidth
+  int8_t pTxPowerDbm ;
+  uint8_t pSyncWord ;
+
+  // Statistics
+  uint32_t pPacketsSent ;
+  uint32_t pPacketsReceived ;
+  int16_t pLastRssi ;
+  int8_t pLastSnr ;
+  uint32_t pTxQueueDrops ;    // LoRa_Send with a full TX queue
+  uint32_t pRxQueueDrops ;    // Packets lost to a full RX queue
+  uint32_t pTxTimeouts ;      // TxDone never arrived
+  uint32_t pRxCrcErrors ;     // Packets discarded on payload CRC
+  uint32_t pTxWindowOverruns ; // Packets longer than their TX window
+  uint32_t pRxWindows ;        // Receive windows opened after TxDone
+  bool pListenBeforeTalk ;    // Check the channel before each packet
+  uint32_t pCadChecks ;       // Channel checks run
+  uint32_t pLbtDeferrals ;    // Packets held for a busy channel
+  uint32_t pLbtForced ;       // Sent on a busy channel at the deferral cap
+  uint32_t pLbtHoldMaxUs ;    // Longest a packet waited for a clear channel
+  uint32_t pLastRxUs ;        // RxDone time of the last packet read (time_us_32)
+  uint32_t pLastRxFrequencyHz ; // Frequency the last packet read came in on
+
+  // SPI timing (microseconds)
+  uint32_t pLastTxSpiUs ;     // Queue entry to radio keyed up
+  uint32_t pLastRxSpiUs ;     // RxDone flags to packet queued
+  uint32_t pSpiBaselineUs ;   // 255B FIFO loopback, CPU at 1 MHz (boot)
+  uint32_t pSpiBurstUs ;      // 255B FIFO loopback, current path (boot)
+} LoRa_Radio ;
+
+//----------------------------------------------
+// Function: LoRa_Init
+// Purpose: Initialize the LoRa radio
+// Parameters:
+//   outRadio - Radio structure to initialize
+// Returns: true if successful
+//----------------------------------------------
+bool LoRa_Init(LoRa_Radio * outRadio) ;
+
+//----------------------------------------------
+// Function: LoRa_SetFrequency
+// Purpose: Set the receive frequency (and the
+//   transmit frequency unless one is set)
+// Parameters:
+//   ioRadio - Radio to configure
+//   inFrequencyHz - Frequency in Hz (e.g., 915000000)
+// Returns: true if successful
+// Notes: A listening radio is retuned at once (a
+//   packet being received is dropped); one that is
+//   sending retunes when it returns to receive
+//----------------------------------------------
+bool LoRa_SetFrequency(LoRa_Radio * ioRadio, uint32_t inFrequencyHz) ;
+
+//----------------------------------------------
+// Function: LoRa_SetTxFrequency
+// Purpose: Send on another frequency than the
+//   one received on
+// Parameters:
+//   ioRadio - Radio to configure
+//   inFrequencyHz - Frequency in Hz (0: send on
+//     the receive frequency)
+// Notes: Takes effect from the next packet
+//   started
+//----------------------------------------------
+void LoRa_SetTxFrequency(LoRa_Radio * ioRadio, uint32_t inFrequencyHz) ;
+
+//----------------------------------------------
+// Function: LoRa_GetChannelFrequency
+// Purpose: Look up a channel of the plan
+// Parameters:
+//   inChannel - Channel (0 to kLoRaChannelCount - 1)
+// Returns: Frequency in Hz (the control channel
+//   if out of range)
+//----------------------------------------------
+uint32_t LoRa_GetChannelFrequency(uint8_t inChannel) ;
+
+//----------------------------------------------
+// Function: LoRa_GetChannel
+// Purpose: Find the channel of a frequency
+// Parameters:
+//   inFrequencyHz - Frequency in Hz
+// Returns: Channel, or kLoRaChannelCount if the
+//   frequency is not in the plan
+//----------------------------------------------
+uint8_t LoRa_GetChannel(uint32_t inFrequencyHz) ;
+
+//----------------------------------------------
+// Function: LoRa_GetRocketChannel
+// Purpose: Uplink channel assigned to a rocket
+// Parameters:
+//   inRocketId - Rocket ID (0-15)
+// Returns: Channel 1 to kLoRaChannelCount - 1;
+//   IDs seven apart share a channel
+//----------------------------------------------
+uint8_t LoRa_GetRocketChannel(uint8_t inRocketId) ;
+
+//----------------------------------------------
+// Function: LoRa_SetSpreadingFactor
+// Purpose: Set the spreading factor
+// Parameters:
+//   ioRadio - Radio to configure
+//   inSF - Spreading factor (6-12)
+// Returns: true if successful
+//----------------------------------------------
+bool LoRa_SetSpreadingFactor(LoRa_Radio * ioRadio, LoRa_SpreadingFactor inSF) ;
+
+//----------------------------------------------
+// Function: LoRa_SetBandwidth
+// Purpose: Set the bandwidth
+// Parameters:
+//   ioRadio - Radio to configure
+//   inBW - Bandwidth setting
+// Returns: true if successful
+//----------------------------------------------
+bool LoRa_SetBandwidth(LoRa_Radio * ioRadio, LoRa_Bandwidth inBW) ;
+
+//----------------------------------------------
+// Function: LoRa_SetCodingRate
+// Purpose: Set the coding rate
+// Parameters:
+//   ioRadio - Radio to configure
+//   inCR - Coding rate
+// Returns: true if successful
+//----------------------------------------------
+bool LoRa_SetCodingRate(LoRa_Radio * ioRadio, LoRa_CodingRate inCR) ;
+
+//----------------------------------------------
+// Function: LoRa_GetDataRate
+// Purpose: Look up a data rate table entry
+// Parameters:
+//   inRate - Data rate index
+// Returns: Entry, or NULL if out of range
+//----------------------------------------------
+const LoRa_DataRate * LoRa_GetDataRate(uint8_t inRate) ;
+
+//----------------------------------------------
+// Function: LoRa_SetDataRate
+// Purpose: Switch spreading factor and bandwidth
+//   to a data rate table entry
+// Parameters:
+//   ioRadio - Radio to configure
+//   inRate - Data rate index
+// Returns: false if the index is out of range or
+//   a packet is on air (try again after TxDone)
+// Notes: A packet being received is dropped.
+//   Packets still queued go out at the new rate.
+//----------------------------------------------
+bool LoRa_SetDataRate(LoRa_Radio * ioRadio, uint8_t inRate) ;
+
+//----------------------------------------------
+// Function: LoRa_SetTxPower
+// Purpose: Set transmit power
+// Parameters:
+//   ioRadio - Radio to configure
+//   inPowerDbm - Power in dBm (2-20)
+// Returns: true if successful
+//----------------------------------------------
+bool LoRa_SetTxPower(LoRa_Radio * ioRadio, int8_t inPowerDbm) ;
+
+//----------------------------------------------
+// Function: LoRa_SetSyncWord
+// Purpose: Set sync word for network isolation
+// Parameters:
+//   ioRadio - Radio to configure
+//   inSyncWord - Sync word (0x12 = LoRaWAN, 0x14 = private)
+// Returns: true if successful
+//----------------------------------------------
+bool LoRa_SetSyncWord(LoRa_Radio * ioRadio, uint8_t inSyncWord) ;
+
+//----------------------------------------------
+// Function: LoRa_ReadVersion
+// Purpose: Read version register (SPI diagnostic)
+// Returns: 0x12 if radio responding, 0x00 if broken
+//----------------------------------------------
+uint8_t LoRa_ReadVersion(LoRa_Radio * inRadio) ;
+
+//----------------------------------------------
+// Function: LoRa_EnsureReady
+// Purpose: Check radio health and reset if needed
+// Parameters:
+//   ioRadio - Radio to check
+// Returns: true if radio is ready
+//----------------------------------------------
+bool LoRa_EnsureReady(LoRa_Radio * ioRadio) ;
+
+//----------------------------------------------
+// Function: LoRa_Send
+// Purpose: Queue a packet for transmission
+// Parameters:
+//   ioRadio - Radio to use
+//   inData - Data to send (copied)
+//   inLen - Data length (max 255)
+// Returns: true if packet queued successfully
+// Notes: Starts transmitting at once if the radio
+//   is not already sending; returns without
+//   waiting for TxDone
+//----------------------------------------------
+bool LoRa_Send(LoRa_Radio * ioRadio, const uint8_t * inData, uint8_t inLen) ;
+
+//----------------------------------------------
+// Function: LoRa_SendFirst
+// Purpose: Queue a packet ahead of all others
+// Parameters:
+//   ioRadio - Radio to use
+//   inData - Data to send (copied)
+//   inLen - Data length (max 255)
+// Returns: true if packet queued successfully
+// Notes: For time-critical frames (beacons); a
+//   packet already on air is not interrupted
+//----------------------------------------------
+bool LoRa_SendFirst(LoRa_Radio * ioRadio, const uint8_t * inData, uint8_t inLen) ;
+
+//----------------------------------------------
+// Function: LoRa_SendWithRxWindow
+// Purpose: Queue a packet and keep listening for
+//   a while after it
+// Parameters:
+//   ioRadio - Radio to use
+//   inData - Data to send (copied)
+//   inLen - Data length (max 255)
+//   inWindowUs - Receive window from its TxDone
+// Returns: true if packet queued successfully
+// Notes: Packets queued behind it (and LoRa_Send
+//   calls during the window) wait for the window
+//   to close
+//----------------------------------------------
+bool LoRa_SendWithRxWindow(
+  LoRa_Radio * ioRadio,
+  const uint8_t * inData,
+  uint8_t inLen,
+  uint32_t inWindowUs) ;
+
+//----------------------------------------------
+// Function: LoRa_SendBlocking
+// Purpose: Queue a packet and wait until the TX
+//   queue has drained
+// Parameters:
+//   ioRadio - Radio to use
+//   inData - Data to send
+//   inLen - Data length
+//   inTimeoutMs - Timeout in milliseconds
+// Returns: true if sent successfully
+//----------------------------------------------
+bool LoRa_SendBlocking(
+  LoRa_Radio * ioRadio,
+  const uint8_t * inData,
+  uint8_t inLen,
+  uint32_t inTimeoutMs) ;
+
+//----------------------------------------------
+// Function: LoRa_SetTxWindow
+// Purpose: Restrict transmissions to a time window
+// Parameters:
+//   ioRadio - Radio to use
+//   inStartUs - Window start (time_us_32)
+//   inEndUs - Window end (time_us_32)
+// Notes: Replaces any previous window. Queued
+//   packets wait for the next window once this
+//   one has passed. An empty window (inEndUs ==
+//   inStartUs) holds every packet.
+//----------------------------------------------
+void LoRa_SetTxWindow(LoRa_Radio * ioRadio, uint32_t inStartUs, uint32_t inEndUs) ;
+
+//----------------------------------------------
+// Function: LoRa_ClearTxWindow
+// Purpose: Allow transmissions at any time again
+// Parameters:
+//   ioRadio - Radio to use
+//----------------------------------------------
+void LoRa_ClearTxWindow(LoRa_Radio * ioRadio) ;
+
+//----------------------------------------------
+// Function: LoRa_SetListenBeforeTalk
+// Purpose: Turn the clear channel check before
+//   each packet on or off
+// Parameters:
+//   ioRadio - Radio
+//   inEnabled - true to check
+//----------------------------------------------
+void LoRa_SetListenBeforeTalk(LoRa_Radio * ioRadio, bool inEnabled) ;
+
+//----------------------------------------------
+// Function: LoRa_GetTimeOnAirUs
+// Purpose: Airtime of a packet at the current
+//   modem settings
+// Parameters:
+//   inRadio - Radio (SF, bandwidth, coding rate)
+//   inLen - Payload length in bytes
+// Returns: Time on air in microseconds, preamble
+//   to end of payload CRC (explicit header)
+//----------------------------------------------
+uint32_t LoRa_GetTimeOnAirUs(const LoRa_Radio * inRadio, uint8_t inLen) ;
+
+//----------------------------------------------
+// Function: LoRa_GetRateTimeOnAirUs
+// Purpose: Airtime of a packet at another data
+//   rate
+// Parameters:
+//   inRadio - Radio (coding rate)
+//   inRate - Data rate index
+//   inLen - Payload length in bytes
+// Returns: Time on air in microseconds, 0 if the
+//   index is out of range
+//----------------------------------------------
+uint32_t LoRa_GetRateTimeOnAirUs(const LoRa_Radio * inRadio, uint8_t inRate, uint8_t inLen) ;
+
+//----------------------------------------------
+// Function: LoRa_GetConfigTimeOnAirUs
+// Purpose: Airtime of a packet at a data rate and
+//   coding rate other than the radio's
+// Parameters:
+//   inRate - Data rate index
+//   inCR - Coding rate
+//   inLen - Payload length in bytes
+// Returns: Time on air in microseconds, 0 if the
+//   index is out of range
+//----------------------------------------------
+uint32_t LoRa_GetConfigTimeOnAirUs(uint8_t inRate, LoRa_CodingRate inCR, uint8_t inLen) ;
+
+//----------------------------------------------
+// Function: LoRa_StartReceive
+// Purpose: Start continuous receive mode
+// Parameters:
+//   ioRadio - Radio to use
+// Returns: true if successful
+// Notes: If a transmission is in progress the
+//   radio enters receive once the TX queue is
+//   empty. It stays in receive after every
+//   later transmission until LoRa_Idle/Sleep.
+//----------------------------------------------
+bool LoRa_StartReceive(LoRa_Radio * ioRadio) ;
+
+//----------------------------------------------
+// Function: LoRa_Available
+// Purpose: Check if a packet is available
+// Parameters:
+//   inRadio - Radio to check
+// Returns: Length of the oldest queued packet
+//   (0 if none)
+//----------------------------------------------
+uint8_t LoRa_Available(LoRa_Radio * inRadio) ;
+
+//----------------------------------------------
+// Function: LoRa_Receive
+// Purpose: Take the oldest packet from the RX queue
+// Parameters:
+//   ioRadio - Radio to use
+//   outData - Buffer for received data
+//   inMaxLen - Maximum bytes to receive
+// Returns: Number of bytes received (0 if none)
+// Notes: Updates the last RSSI/SNR and pLastRxUs
+//   to the values recorded with this packet; no
+//   SPI access
+//----------------------------------------------
+uint8_t LoRa_Receive(LoRa_Radio * ioRadio, uint8_t * outData, uint8_t inMaxLen) ;
+
+//----------------------------------------------
+// Function: LoRa_GetRssi
+// Purpose: Get RSSI of last received packet
+// Parameters:
+//   inRadio - Radio
+// Returns: RSSI in dBm
+//----------------------------------------------
+int16_t LoRa_GetRssi(LoRa_Radio * inRadio) ;
+
+//----------------------------------------------
+// Function: LoRa_GetSnr
+// Purpose: Get SNR of last received packet
+// Parameters:
+//   inRadio - Radio
+// Returns: SNR in dB (can be negative)
+//----------------------------------------------
+int8_t LoRa_GetSnr(LoRa_Radio * inRadio) ;
+
+//----------------------------------------------
+// Function: LoRa_Sleep
+// Purpose: Put radio in sleep mode
+// Parameters:
+//   ioRadio - Radio to sleep
+// Returns: true if successful
+//----------------------------------------------
+bool LoRa_Sleep(LoRa_Radio * ioRadio) ;
+
+//----------------------------------------------
+// Function: LoRa_Idle
+// Purpose: Put radio in standby mode
+// Parameters:
+//   ioRadio - Radio
+// Returns: true if successful
+//----------------------------------------------
+bool LoRa_Idle(LoRa_Radio * ioRadio) ;
+
+//----------------------------------------------
+// Function: LoRa_IsTransmitting
+// Purpose: Check for queued or in-flight packets
+// Parameters:
+//   inRadio - Radio to check
+// Returns: true until the TX queue has drained
+//----------------------------------------------
+bool LoRa_IsTransmitting(LoRa_Radio * inRadio) ;
+
+//----------------------------------------------
+// Function: LoRa_Service
+// Purpose: Handle radio events latched by the
+//   DIO0 interrupt
+// Parameters:
+//   ioRadio - Radio to service
+// Notes: Call every main loop pass. Moves received
+//   packets into the RX queue, starts the next
+//   queued transmission and returns to receive.
+//   Touches SPI only when DIO0 has fired or a
+//   new transmission starts.
+//----------------------------------------------
+void LoRa_Service(LoRa_Radio * ioRadio) ;
@@ -0,0 +1,137 @@
+//----------------------------------------------
+// Module: gateway_stream.c
+// Description: Binary record stream from the
+//   gateways to host clients
+// Author: Mark Gavin
+// Created: 2026-02-15
+// Copyright: (c) 2025-2026 by Mark Gavin
+// License: Proprietary - All Rights Reserved
+//----------------------------------------------
+
+#include "gateway_stream.h"
+
+//----------------------------------------------
+// Function: GatewayStream_Encode
+//----------------------------------------------
+size_t GatewayStream_Encode(
+  uint8_t inType,
+  const uint8_t * inPayload,
+  size_t inLen,
+  uint8_t * outFrame,
+  size_t inMaxLen)
+{
+  if (outFrame == NULL || (inPayload == NULL && inLen > 0) ||
+      inMaxLen < GATEWAY_STREAM_FRAME_SIZE(inLen))
+  {
+    return 0 ;
+  }
+
+  uint8_t theCrc = LoRaProtocol_Crc8Update(kLoRaCrc8Init, &inType, 1) ;
+  theCrc = LoRaProtocol_Crc8Update(theCrc, inPayload, inLen) ;
+
+  // COBS: each block of up to 254 non-zero bytes is
+  // led by its length plus one, which also stands
+  // for the zero that ended it
+  size_t theCodeAt = 0 ;
+  size_t theOut = 1 ;
+  uint8_t theCode = 1 ;
+  for (size_t i = 0 ; i < inLen + 2 ; i++)
+  {
+    uint8_t theByte = i == 0 ? inType : (i <= inLen ? inPayload[i - 1] : theCrc) ;
+    if (theByte != 0)
+    {
+      outFrame[theOut++] = theByte ;
+      theCode++ ;
+    }
+    if (theByte == 0 || theCode == 0xFF)
+    {
+      outFrame[theCodeAt] = theCode ;
+      theCodeAt = theOut++ ;
+      theCode = 1 ;
+    }
+  }
+  outFrame[theCodeAt] = theCode ;
+  outFrame[theOut++] = kStreamDelimiter ;
+
+  return theOut ;
+}
+
+//----------------------------------------------
+// Function: GatewayStream_Decode
+//----------------------------------------------
+bool GatewayStream_Decode(
+  const uint8_t * inFrame,
+  size_t inLen,
+  uint8_t * outType,
+  uint8_t * outPayload,
+  size_t inMaxLen,
+  size_t * outLen)
+{
+  if (inFrame == NULL || outType == NULL || outPayload == NULL || outLen == NULL)
+  {
+    return false ;
+  }
+
+  // Each decoded byte is held until the next one
+  // arrives: the last is the CRC and is not stored
+  size_t theCount = 0 ;
+  uint8_t theHeld = 0 ;
+  uint8_t theCrc = kLoRaCrc8Init ;
+  size_t theIn = 0 ;
+  while (theIn < inLen)
+  {
+    uint8_t theCode = inFrame[theIn++] ;
+    size_t theBlockEnd = theIn + theCode - 1 ;
+    if (theCode == kStreamDelimiter || theBlockEnd > inLen)
+    {
+      return false ;
+    }
+
+    // A short block stands for a zero after it,
+    // unless it ends the frame
+    bool theZero = theCode < 0xFF && theBlockEnd < inLen ;
+    while (theIn < theBlockEnd || theZero)
+    {
+      uint8_t theByte = 0 ;
+      if (theIn < theBlockEnd)
+      {
+        theByte = inFrame[theIn++] ;
+        if (theByte == kStreamDelimiter)
+        {
+          return false ;
+        }
+      }
+      else
+      {
+        theZero = false ;
+      }
+
+      if (theCount == 1)
+      {
+        *outType = theHeld ;
+      }
+      else if (theCount > 1)
+      {
+        if (theCount - 2 >= inMaxLen)
+        {
+          return false ;
+        }
+        outPayload[theCount - 2] = theHeld ;
+      }
+      if (theCount > 0)
+      {
+        theCrc = LoRaProtocol_Crc8Update(theCrc, &theHeld, 1) ;
+      }
+      theHeld = theByte ;
+      theCount++ ;
+    }
+  }
+
+  if (theCount < 2)
+  {
+    return false ;
+  }
+
+  *outLen = theCount - 2 ;
+  return theCrc == theHeld ;
+}
@@ -0,0 +1,190 @@
+//----------------------------------------------
+// Module: lora_protocol.c
+// Description: LoRa packet layout shared by the
+//   flight computer and the gateway
+// Author: Mark Gavin
+// Created: 2026-02-15
+// Copyright: (c) 2025-2026 by Mark Gavin
+// License: Proprietary - All Rights Reserved
+// Modified: 2026-02-16 (bulk sample delta coding)
+//----------------------------------------------
+
+#include "lora_protocol.h"
+
+//----------------------------------------------
+// CRC-8 Table (polynomial 0x31)
+// Entry n is the CRC register after shifting n
+// through eight times
+//----------------------------------------------
+static const uint8_t sCrc8Table[256] =
+{
+  0x00, 0x31, 0x62, 0x53, 0xC4, 0xF5, 0xA6, 0x97, 0xB9, 0x88, 0xDB, 0xEA, 0x7D, 0x4C, 0x1F, 0x2E,
+  0x43, 0x72, 0x21, 0x10, 0x87, 0xB6, 0xE5, 0xD4, 0xFA, 0xCB, 0x98, 0xA9, 0x3E, 0x0F, 0x5C, 0x6D,
+  0x86, 0xB7, 0xE4, 0xD5, 0x42, 0x73, 0x20, 0x11, 0x3F, 0x0E, 0x5D, 0x6C, 0xFB, 0xCA, 0x99, 0xA8,
+  0xC5, 0xF4, 0xA7, 0x96, 0x01, 0x30, 0x63, 0x52, 0x7C, 0x4D, 0x1E, 0x2F, 0xB8, 0x89, 0xDA, 0xEB,
+  0x3D, 0x0C, 0x5F, 0x6E, 0xF9, 0xC8, 0x9B, 0xAA, 0x84, 0xB5, 0xE6, 0xD7, 0x40, 0x71, 0x22, 0x13,
+  0x7E, 0x4F, 0x1C, 0x2D, 0xBA, 0x8B, 0xD8, 0xE9, 0xC7, 0xF6, 0xA5, 0x94, 0x03, 0x32, 0x61, 0x50,
+  0xBB, 0x8A, 0xD9, 0xE8, 0x7F, 0x4E, 0x1D, 0x2C, 0x02, 0x33, 0x60, 0x51, 0xC6, 0xF7, 0xA4, 0x95,
+  0xF8, 0xC9, 0x9A, 0xAB, 0x3C, 0x0D, 0x5E, 0x6F, 0x41, 0x70, 0x23, 0x12, 0x85, 0xB4, 0xE7, 0xD6,
+  0x7A, 0x4B, 0x18, 0x29, 0xBE, 0x8F, 0xDC, 0xED, 0xC3, 0xF2, 0xA1, 0x90, 0x07, 0x36, 0x65, 0x54,
+  0x39, 0x08, 0x5B, 0x6A, 0xFD, 0xCC, 0x9F, 0xAE, 0x80, 0xB1, 0xE2, 0xD3, 0x44, 0x75, 0x26, 0x17,
+  0xFC, 0xCD, 0x9E, 0xAF, 0x38, 0x09, 0x5A, 0x6B, 0x45, 0x74, 0x27, 0x16, 0x81, 0xB0, 0xE3, 0xD2,
+  0xBF, 0x8E, 0xDD, 0xEC, 0x7B, 0x4A, 0x19, 0x28, 0x06, 0x37, 0x64, 0x55, 0xC2, 0xF3, 0xA0, 0x91,
+  0x47, 0x76, 0x25, 0x14, 0x83, 0xB2, 0xE1, 0xD0, 0xFE, 0xCF, 0x9C, 0xAD, 0x3A, 0x0B, 0x58, 0x69,
+  0x04, 0x35, 0x66, 0x57, 0xC0, 0xF1, 0xA2, 0x93, 0xBD, 0x8C, 0xDF, 0xEE, 0x79, 0x48, 0x1B, 0x2A,
+  0xC1, 0xF0, 0xA3, 0x92, 0x05, 0x34, 0x67, 0x56, 0x78, 0x49, 0x1A, 0x2B, 0xBC, 0x8D, 0xDE, 0xEF,
+  0x82, 0xB3, 0xE0, 0xD1, 0x46, 0x77, 0x24, 0x15, 0x3B, 0x0A, 0x59, 0x68, 0xFF, 0xCE, 0x9D, 0xAC
+} ;
+
+//----------------------------------------------
+// Stored Sample Fields
+// Byte width of each FlightSample field in order
+// (flight_storage.h): time, altitude, velocity,
+// pressure, temperature, latitude, longitude,
+// GPS speed, heading, satellites, accel x3,
+// gyro x3, mag x3, state. 48 bytes in all.
+//----------------------------------------------
+static const uint8_t sSampleFieldWidths[kBulkSampleFields] =
+{
+  4, 4, 2, 4, 2, 4, 4, 2, 2, 1, 2, 2, 2, 2, 2, 2, 2, 2, 2, 1
+} ;
+
+//----------------------------------------------
+// Internal: GetField
+// Read a little-endian field of 1, 2 or 4 bytes
+//----------------------------------------------
+static uint32_t GetField(const uint8_t * inData, uint8_t inWidth)
+{
+  uint32_t theValue = 0 ;
+  for (uint8_t i = 0 ; i < inWidth ; i++)
+  {
+    theValue |= (uint32_t)inData[i] << (8 * i) ;
+  }
+  return theValue ;
+}
+
+//----------------------------------------------
+// Internal: FieldDelta
+// Difference of two field values at the field's
+// width, sign-extended
+//----------------------------------------------
+static int32_t FieldDelta(uint32_t inValue, uint32_t inPrevious, uint8_t inWidth)
+{
+  uint32_t theDelta = inValue - inPrevious ;
+  if (inWidth == 1) return (int8_t)theDelta ;
+  if (inWidth == 2) return (int16_t)theDelta ;
+  return (int32_t)theDelta ;
+}
+
+//----------------------------------------------
+// Function: LoRaProtocol_Crc8
+//----------------------------------------------
+uint8_t LoRaProtocol_Crc8(const uint8_t * inData, size_t inLen)
+{
+  return LoRaProtocol_Crc8Update(kLoRaCrc8Init, inData, inLen) ;
+}
+
+//----------------------------------------------
+// Function: LoRaProtocol_Crc8Update
+//----------------------------------------------
+uint8_t LoRaProtocol_Crc8Update(uint8_t inCrc, const uint8_t * inData, size_t inLen)
+{
+  uint8_t theCrc = inCrc ;
+
+  for (size_t i = 0 ; i < inLen ; i++)
+  {
+    theCrc = sCrc8Table[theCrc ^ inData[i]] ;
+  }
+
+  return theCrc ;
+}
+
+//----------------------------------------------
+// Function: LoRaProtocol_IsTelemetry
+//----------------------------------------------
+bool LoRaProtocol_IsTelemetry(const uint8_t * inData, size_t inLen)
+{
+  return inData != NULL && inLen == kLoRaTelemetryLen &&
+    inData[0] == kLoRaMagic && inData[1] == kLoRaPacketTelemetry &&
+    LoRaProtocol_Crc8(inData, kLoRaTelemetryLen - 1) == inData[kLoRaTelemetryLen - 1] ;
+}
+
+//----------------------------------------------
+// Function: LoRaProtocol_PutSampleDelta
+//----------------------------------------------
+uint8_t LoRaProtocol_PutSampleDelta(
+  uint8_t * outData,
+  uint8_t inLen,
+  uint8_t inMaxLen,
+  const uint8_t * inPrevious,
+  const uint8_t * inSample)
+{
+  uint8_t theOffset = 0 ;
+  uint32_t theLen = inLen ;
+
+  for (uint8_t i = 0 ; i < kBulkSampleFields ; i++)
+  {
+    uint8_t theWidth = sSampleFieldWidths[i] ;
+    int32_t theDelta = FieldDelta(GetField(&inSample[theOffset], theWidth),
+      GetField(&inPrevious[theOffset], theWidth), theWidth) ;
+    uint32_t theValue = ((uint32_t)theDelta << 1) ^ (uint32_t)(theDelta >> 31) ;
+    theOffset += theWidth ;
+
+    // Varint: 7 bits per byte, low group first
+    do
+    {
+      if (theLen >= inMaxLen)
+      {
+        return 0 ;
+      }
+      uint8_t theByte = theValue & 0x7F ;
+      theValue >>= 7 ;
+      outData[theLen++] = theValue != 0 ? (uint8_t)(theByte | 0x80) : theByte ;
+    } while (theValue != 0) ;
+  }
+
+  return (uint8_t)theLen ;
+}
+
+//----------------------------------------------
+// Function: LoRaProtocol_GetSampleDelta
+//----------------------------------------------
+bool LoRaProtocol_GetSampleDelta(
+  const uint8_t * inData,
+  int inLen,
+  int * ioOffset,
+  const uint8_t * inPrevious,
+  uint8_t * outSample)
+{
+  int theRead = *ioOffset ;
+  uint8_t theOffset = 0 ;
+
+  for (uint8_t i = 0 ; i < kBulkSampleFields ; i++)
+  {
+    uint32_t theValue = 0 ;
+    uint8_t theShift = 0 ;
+    uint8_t theByte ;
+    do
+    {
+      if (theRead >= inLen || theShift > 28)
+      {
+        return false ;
+      }
+      theByte = inData[theRead++] ;
+      theValue |= (uint32_t)(theByte & 0x7F) << theShift ;
+      theShift += 7 ;
+    } while ((theByte & 0x80) != 0) ;
+
+    uint8_t theWidth = sSampleFieldWidths[i] ;
+    int32_t theDelta = (int32_t)(theValue >> 1) ^ -(int32_t)(theValue & 1) ;
+    uint32_t theField = GetField(&inPrevious[theOffset], theWidth) + (uint32_t)theDelta ;
+    for (uint8_t j = 0 ; j < theWidth ; j++)
+    {
+      outSample[theOffset + j] = (uint8_t)(theField >> (8 * j)) ;
+    }
+    theOffset += theWidth ;
+  }
+
+  *ioOffset = theRead ;
+  return true ;
+}
@@ -0,0 +1,1420 @@
+//----------------------------------------------
+// Module: lora_radio.c
+// Description: RFM95 LoRa Radio Driver (SX1276)
+// Author: Mark Gavin
+// Created: 2026-01-10
+// Modified: 2026-02-08 (interrupt-driven TX/RX queues)
+// Modified: 2026-02-09 (DMA FIFO bursts, 8 MHz SPI)
+// Modified: 2026-02-12 (TX windows for TDMA slots)
+// Modified: 2026-02-14 (data rate table for adaptive switching)
+// Modified: 2026-02-15 (channel plan, separate TX frequency)
+// Modified: 2026-02-15 (listen before talk)
+// Modified: 2026-02-15 (airtime at any rate and coding rate)
+// Modified: 2026-02-16 (one copy in firmware_common for both targets)
+// Copyright: (c) 2025-2026 by Mark Gavin
+// License: Proprietary - All Rights Reserved
+//----------------------------------------------
+
+#include "lora_radio.h"
+#include "pins.h"
+
+#include "pico/stdlib.h"
+#include "hardware/spi.h"
+#include "hardware/gpio.h"
+#include "hardware/dma.h"
+
+#include <stdio.h>
+#include <string.h>
+
+#define printf(...) ((void)0)
+
+//----------------------------------------------
+// Constants
+//----------------------------------------------
+#define RFM95_FXOSC             32000000    // Crystal frequency
+#define RFM95_FSTEP             (RFM95_FXOSC / 524288.0)  // Frequency step
+#define RFM95_FIFO_SIZE         256
+
+#define kSpiTimeoutMs           5         // Per transaction, any length
+#define kSpiDmaMinBurst         8         // Shorter bursts stay on the CPU
+#define kSpiBaselineBaudrate    1000000   // Original clock, for the boot comparison
+#define kModemStatReceiving     0x0E      // Synchronized, RX on-going or header valid
+
+//----------------------------------------------
+// Packet Queue Entry
+//----------------------------------------------
+typedef struct
+{
+  uint8_t pLen ;
+  int16_t pRssi ;
+  int8_t pSnr ;
+  uint32_t pRxUs ;                // RxDone time
+  uint32_t pFrequencyHz ;         // Received on
+  uint32_t pRxWindowUs ;          // Listen this long after TxDone
+  uint8_t pData[kLoRaMaxPacketLen] ;
+} LoRaQueueEntry ;
+
+// Bandwidth in Hz by LoRa_Bandwidth
+static const uint32_t sBandwidthHz[] =
+{
+  7800, 10400, 15600, 20800, 31250, 41700, 62500, 125000, 250000, 500000
+} ;
+
+// Data rates by index. SNR floors from the SX1276
+// datasheet (-7.5 dB at SF7 down to -15 dB at
+// SF10), rounded up.
+static const LoRa_DataRate sDataRates[kLoRaDataRateCount] =
+{
+  { LORA_SF10, LORA_BW_125, -15, 0 },
+  { LORA_SF9,  LORA_BW_125, -12, 0 },
+  { LORA_SF8,  LORA_BW_125, -10, 0 },
+  { LORA_SF7,  LORA_BW_125, -7,  0 },
+  { LORA_SF7,  LORA_BW_250, -7,  3 },
+  { LORA_SF7,  LORA_BW_500, -7,  6 }
+} ;
+
+//----------------------------------------------
+// Module State
+//----------------------------------------------
+static volatile bool sDio0Pending = false ;   // Set by the DIO0 ISR
+static volatile uint32_t sDio0Us = 0 ;        // Time of the last DIO0 edge
+
+static LoRaQueueEntry sTxQueue[kLoRaTxQueueSize] ;
+static uint8_t sTxHead = 0 ;
+static uint8_t sTxCount = 0 ;
+static bool sTxActive = false ;               // Radio is in TX mode
+static uint32_t sTxStartMs = 0 ;
+static uint32_t sTxRxWindowUs = 0 ;           // Of the packet on air
+static bool sRxWindow = false ;               // Holding TX after TxDone
+static uint32_t sRxWindowEndUs = 0 ;
+
+static LoRaQueueEntry sRxQueue[kLoRaRxQueueSize] ;
+static uint8_t sRxHead = 0 ;
+static uint8_t sRxCount = 0 ;
+static bool sListen = false ;                 // Return to RX after TX
+static bool sRxArmed = false ;                // Radio is in RX mode
+
+static uint32_t sRxFrequencyHz = 0 ;
+static uint32_t sTxFrequencyHz = 0 ;          // 0: same as receive
+static uint32_t sTunedHz = 0 ;                // Written to the FRF registers
+
+static bool sCadActive = false ;              // Channel activity detection under way
+static uint32_t sCadStartUs = 0 ;
+static bool sCadClear = false ;               // Head packet found the channel clear
+static bool sLbtHeld = false ;                // Head packet has been checked
+static uint32_t sLbtFirstUs = 0 ;             // Its first check
+static uint8_t sLbtDeferrals = 0 ;            // Its deferrals
+static bool sLbtBackoff = false ;
+static uint32_t sLbtBackoffEndUs = 0 ;
+static uint32_t sRandom = 1 ;                 // Backoff generator (xorshift)
+
+static bool sTxWindow = false ;               // TX restricted to a window
+static uint32_t sTxWindowStartUs = 0 ;
+static uint32_t sTxWindowEndUs = 0 ;
+
+static int sDmaTx = -1 ;                      // -1: CPU bursts only
+static int sDmaRx = -1 ;
+static bool sForceCpu = false ;               // Boot baseline measurement
+static const uint8_t sDmaFill = 0x00 ;
+static uint8_t sDmaSink ;
+
+//----------------------------------------------
+// Internal: SPI1 Reinitialize
+// Resets SPI1 to recover from stuck state.
+//----------------------------------------------
+static void SpiReinit(void)
+{
+  spi_deinit(kSpiPort) ;
+  spi_init(kSpiPort, kSpiLoRaBaudrate) ;
+  gpio_set_function(kPinSpiSck, GPIO_FUNC_SPI) ;
+  gpio_set_function(kPinSpiMosi, GPIO_FUNC_SPI) ;
+  gpio_set_function(kPinSpiMiso, GPIO_FUNC_SPI) ;
+}
+
+//----------------------------------------------
+// Internal: SPI Burst (CPU)
+// inTx == NULL sends 0x00; outRx == NULL discards.
+// One deadline covers the whole transaction
+// instead of one per byte.
+//----------------------------------------------
+static bool SpiBurstCpu(
+  const uint8_t * inTx,
+  uint8_t * outRx,
+  uint16_t inLen,
+  absolute_time_t inDeadline)
+{
+  spi_hw_t * theSpi = spi_get_hw(kSpiPort) ;
+
+  for (uint16_t i = 0 ; i < inLen ; i++)
+  {
+    // TX: wait for space in FIFO
+    while (!spi_is_writable(kSpiPort))
+    {
+      if (time_reached(inDeadline))
+      {
+        SpiReinit() ;
+        return false ;
+      }
+    }
+    theSpi->dr = (inTx != NULL) ? inTx[i] : 0x00 ;
+
+    // RX: wait for data
+    while (!spi_is_readable(kSpiPort))
+    {
+      if (time_reached(inDeadline))
+      {
+        SpiReinit() ;
+        return false ;
+      }
+    }
+    uint8_t theIn = (uint8_t)theSpi->dr ;
+    if (outRx != NULL) outRx[i] = theIn ;
+  }
+
+  return true ;
+}
+
+//----------------------------------------------
+// Internal: SPI Burst (DMA)
+// TX and RX channels run together; RX paces TX
+// so the 8-deep FIFO never overflows. A stuck
+// bus aborts both channels and resets SPI1.
+//----------------------------------------------
+static bool SpiBurstDma(
+  const uint8_t * inTx,
+  uint8_t * outRx,
+  uint16_t inLen,
+  absolute_time_t inDeadline)
+{
+  spi_hw_t * theSpi = spi_get_hw(kSpiPort) ;
+
+  dma_channel_config theTxConfig = dma_channel_get_default_config((uint)sDmaTx) ;
+  channel_config_set_transfer_data_size(&theTxConfig, DMA_SIZE_8) ;
+  channel_config_set_dreq(&theTxConfig, spi_get_dreq(kSpiPort, true)) ;
+  channel_config_set_read_increment(&theTxConfig, inTx != NULL) ;
+  channel_config_set_write_increment(&theTxConfig, false) ;
+
+  dma_channel_config theRxConfig = dma_channel_get_default_config((uint)sDmaRx) ;
+  channel_config_set_transfer_data_size(&theRxConfig, DMA_SIZE_8) ;
+  channel_config_set_dreq(&theRxConfig, spi_get_dreq(kSpiPort, false)) ;
+  channel_config_set_read_increment(&theRxConfig, false) ;
+  channel_config_set_write_increment(&theRxConfig, outRx != NULL) ;
+
+  dma_channel_configure((uint)sDmaTx, &theTxConfig, &theSpi->dr,
+    (inTx != NULL) ? inTx : &sDmaFill, inLen, false) ;
+  dma_channel_configure((uint)sDmaRx, &theRxConfig,
+    (outRx != NULL) ? (void *)outRx : (void *)&sDmaSink, &theSpi->dr, inLen, false) ;
+
+  dma_start_channel_mask((1u << sDmaTx) | (1u << sDmaRx)) ;
+
+  while (dma_channel_is_busy((uint)sDmaRx))
+  {
+    if (time_reached(inDeadline))
+    {
+      dma_channel_abort((uint)sDmaTx) ;
+      dma_channel_abort((uint)sDmaRx) ;
+      SpiReinit() ;
+      return false ;
+    }
+  }
+
+  return true ;
+}
+
+//----------------------------------------------
+// Internal: Radio Transaction (timeout-protected)
+// Address byte, then inLen data bytes, under one
+// chip select. Data bursts of kSpiDmaMinBurst or
+// more go through DMA. A single transaction gets
+// kSpiTimeoutMs; a full 256-byte FIFO burst takes
+// ~270us at 8 MHz, so 5ms is very generous.
+//----------------------------------------------
+static bool Transaction(uint8_t inAddr, const uint8_t * inTx, uint8_t * outRx, uint16_t inLen)
+{
+  absolute_time_t theDeadline = make_timeout_time_ms(kSpiTimeoutMs) ;
+  bool theUseDma = sDmaTx >= 0 && !sForceCpu && inLen >= kSpiDmaMinBurst ;
+
+  gpio_put(kPinLoRaCs, 0) ;
+  bool theOk = SpiBurstCpu(&inAddr, NULL, 1, theDeadline) ;
+  if (theOk)
+  {
+    theOk = theUseDma ?
+      SpiBurstDma(inTx, outRx, inLen, theDeadline) :
+      SpiBurstCpu(inTx, outRx, inLen, theDeadline) ;
+  }
+  gpio_put(kPinLoRaCs, 1) ;
+
+  return theOk ;
+}
+
+//----------------------------------------------
+// Internal: Read Register
+//----------------------------------------------
+static uint8_t ReadRegister(uint8_t inAddr)
+{
+  uint8_t theValue = 0 ;
+  Transaction(inAddr & 0x7F, NULL, &theValue, 1) ;  // Read: MSB = 0
+  return theValue ;
+}
+
+//----------------------------------------------
+// Internal: Write Register
+//----------------------------------------------
+static void WriteRegister(uint8_t inAddr, uint8_t inValue)
+{
+  Transaction(inAddr | 0x80, &inValue, NULL, 1) ;  // Write: MSB = 1
+}
+
+//----------------------------------------------
+// Internal: Read FIFO
+//----------------------------------------------
+static void ReadFifo(uint8_t * outData, uint8_t inLen)
+{
+  Transaction(RFM95_REG_FIFO & 0x7F, NULL, outData, inLen) ;
+}
+
+//----------------------------------------------
+// Internal: Write FIFO
+//----------------------------------------------
+static void WriteFifo(const uint8_t * inData, uint8_t inLen)
+{
+  Transaction(RFM95_REG_FIFO | 0x80, inData, NULL, inLen) ;
+}
+
+//----------------------------------------------
+// Internal: Tune
+// Writes the carrier frequency unless the radio
+// is already on it. Call in standby or sleep.
+//----------------------------------------------
+static void Tune(uint32_t inFrequencyHz)
+{
+  if (inFrequencyHz == sTunedHz)
+  {
+    return ;
+  }
+
+  uint64_t theFrf = ((uint64_t)inFrequencyHz << 19) / RFM95_FXOSC ;
+
+  WriteRegister(RFM95_REG_FRF_MSB, (uint8_t)(theFrf >> 16)) ;
+  WriteRegister(RFM95_REG_FRF_MID, (uint8_t)(theFrf >> 8)) ;
+  WriteRegister(RFM95_REG_FRF_LSB, (uint8_t)(theFrf >> 0)) ;
+  sTunedHz = inFrequencyHz ;
+}
+
+//----------------------------------------------
+// Internal: Set Operating Mode
+//----------------------------------------------
+static void SetMode(uint8_t inMode)
+{
+  WriteRegister(RFM95_REG_OP_MODE, RFM95_MODE_LONG_RANGE | inMode) ;
+}
+
+//----------------------------------------------
+// Internal: DIO0 Interrupt
+// Runs in IRQ context. Only latches the event
+// and its time: SPI1 may be mid-transaction for
+// another device.
+//----------------------------------------------
+static void Dio0Callback(uint inGpio, uint32_t inEvents)
+{
+  (void)inEvents ;
+  if (inGpio == kPinLoRaDio0)
+  {
+    sDio0Us = time_us_32() ;
+    sDio0Pending = true ;
+  }
+}
+
+//----------------------------------------------
+// Internal: Drain SPI RX FIFO
+// Noise from eInk bit-bang can inject phantom
+// bytes into the SPI1 RX FIFO. Bounded to 16
+// iterations (FIFO is 8 deep) to prevent an
+// infinite loop if the peripheral is stuck
+// readable.
+//----------------------------------------------
+static void DrainSpiFifo(void)
+{
+  for (int i = 0 ; i < 16 && spi_is_readable(kSpiPort) ; i++)
+    (void)spi_get_hw(kSpiPort)->dr ;
+}
+
+//----------------------------------------------
+// Internal: Enter Receive
+//----------------------------------------------
+static void EnterReceive(void)
+{
+  DrainSpiFifo() ;
+
+  // Back from a transmit frequency of its own
+  if (sTunedHz != sRxFrequencyHz)
+  {
+    SetMode(RFM95_MODE_STDBY) ;
+    Tune(sRxFrequencyHz) ;
+  }
+
+  // Configure DIO0 for RxDone
+  WriteRegister(RFM95_REG_DIO_MAPPING_1, 0x00) ;
+
+  // Reset FIFO address
+  WriteRegister(RFM95_REG_FIFO_ADDR_PTR, 0x00) ;
+
+  // Clear IRQ flags
+  WriteRegister(RFM95_REG_IRQ_FLAGS, 0xFF) ;
+
+  // Start continuous receive
+  SetMode(RFM95_MODE_RX_CONTINUOUS) ;
+  sRxArmed = true ;
+}
+
+//----------------------------------------------
+// Internal: Reset Listen Before Talk
+// Forgets the checks made for the head packet.
+//----------------------------------------------
+static void ResetLbt(void)
+{
+  sCadActive = false ;
+  sCadClear = false ;
+  sLbtHeld = false ;
+  sLbtDeferrals = 0 ;
+  sLbtBackoff = false ;
+}
+
+//----------------------------------------------
+// Internal: Start Channel Activity Detection
+// CadDone raises DIO0; the radio returns to
+// standby by itself.
+//----------------------------------------------
+static void StartCad(LoRa_Radio * ioRadio, uint32_t inFrequencyHz)
+{
+  DrainSpiFifo() ;
+  SetMode(RFM95_MODE_STDBY) ;
+  Tune(inFrequencyHz) ;
+
+  // Configure DIO0 for CadDone
+  WriteRegister(RFM95_REG_DIO_MAPPING_1, 0x80) ;
+  WriteRegister(RFM95_REG_IRQ_FLAGS, 0xFF) ;
+  SetMode(RFM95_MODE_CAD) ;
+
+  sRxArmed = false ;
+  sCadActive = true ;
+  sCadStartUs = time_us_32() ;
+  ioRadio->pCadChecks++ ;
+}
+
+//----------------------------------------------
+// Internal: Defer Transmit
+// The channel was busy for the head packet: back
+// off a random time that doubles with each
+// deferral, or at the cap let it go anyway.
+// Returns true if it should go now.
+//----------------------------------------------
+static bool DeferTransmit(LoRa_Radio * ioRadio, uint32_t inNowUs)
+{
+  if (sLbtDeferrals >= kLoRaLbtMaxDeferrals ||
+      (inNowUs - sLbtFirstUs) >= kLoRaLbtMaxHoldUs)
+  {
+    ioRadio->pLbtForced++ ;
+    sCadClear = true ;
+    return true ;
+  }
+
+  sRandom ^= inNowUs ;
+  sRandom ^= sRandom << 13 ;
+  sRandom ^= sRandom >> 17 ;
+  sRandom ^= sRandom << 5 ;
+  uint32_t theSpanUs = (uint32_t)kLoRaLbtBackoffUs << sLbtDeferrals ;
+
+  sLbtDeferrals++ ;
+  ioRadio->pLbtDeferrals++ ;
+  sLbtBackoff = true ;
+  sLbtBackoffEndUs = inNowUs + theSpanUs + sRandom % theSpanUs ;
+  return false ;
+}
+
+//----------------------------------------------
+// Internal: Start Next Transmit
+// Loads the oldest queued packet into the radio.
+// Returns false if the TX queue is empty or the
+// packet must wait (TX window, receive window,
+// busy channel); true once it is on air or its
+// channel check has started.
+//----------------------------------------------
+static bool StartNextTransmit(LoRa_Radio * ioRadio)
+{
+  if (sTxCount == 0)
+  {
+    return false ;
+  }
+
+  uint32_t theStartUs = time_us_32() ;
+  const LoRaQueueEntry * theEntry = &sTxQueue[sTxHead] ;
+
+  // Listening after the last packet
+  if (sRxWindow)
+  {
+    if ((int32_t)(theStartUs - sRxWindowEndUs) < 0)
+    {
+      return false ;
+    }
+    sRxWindow = false ;
+  }
+
+  if (sTxWindow)
+  {
+    // Closed, not open yet, or already past
+    int32_t theIntoUs = (int32_t)(theStartUs - sTxWindowStartUs) ;
+    if (sTxWindowEndUs == sTxWindowStartUs || theIntoUs < 0)
+    {
+      return false ;
+    }
+
+    uint32_t theAirUs = LoRa_GetTimeOnAirUs(ioRadio, theEntry->pLen) ;
+    if ((int32_t)(sTxWindowEndUs - theStartUs) < (int32_t)theAirUs)
+    {
+      // Longer than the whole window: send it right at
+      // the start rather than hold the queue forever
+      if (theAirUs <= sTxWindowEndUs - sTxWindowStartUs ||
+          theIntoUs > kLoRaTxWindowLateUs)
+      {
+        return false ;
+      }
+      ioRadio->pTxWindowOverruns++ ;
+    }
+  }
+
+  // Listen before talk, unless a TX window gives
+  // the packet the channel
+  uint32_t theTxHz = sTxFrequencyHz != 0 ? sTxFrequencyHz : sRxFrequencyHz ;
+  if (ioRadio->pListenBeforeTalk && !sTxWindow && !sCadClear)
+  {
+    if (sLbtBackoff && (int32_t)(theStartUs - sLbtBackoffEndUs) < 0)
+    {
+      return false ;
+    }
+    sLbtBackoff = false ;
+    if (!sLbtHeld)
+    {
+      sLbtHeld = true ;
+      sLbtFirstUs = theStartUs ;
+    }
+
+    // A packet coming in on the transmit frequency
+    // makes the channel busy without a CAD
+    bool theReceiving = sRxArmed && sTunedHz == theTxHz &&
+      (ReadRegister(RFM95_REG_MODEM_STAT) & kModemStatReceiving) != 0 ;
+    if (!theReceiving)
+    {
+      StartCad(ioRadio, theTxHz) ;
+      return true ;
+    }
+    if (!DeferTransmit(ioRadio, theStartUs))
+    {
+      return false ;
+    }
+  }
+
+  if (sLbtHeld)
+  {
+    uint32_t theHoldUs = theStartUs - sLbtFirstUs ;
+    if (theHoldUs > ioRadio->pLbtHoldMaxUs)
+    {
+      ioRadio->pLbtHoldMaxUs = theHoldUs ;
+    }
+  }
+  ResetLbt() ;
+
+  DrainSpiFifo() ;
+
+  // Go to standby mode
+  SetMode(RFM95_MODE_STDBY) ;
+  Tune(theTxHz) ;
+
+  // Reset FIFO address
+  WriteRegister(RFM95_REG_FIFO_ADDR_PTR, 0x00) ;
+
+  // Write data to FIFO
+  WriteFifo(theEntry->pData, theEntry->pLen) ;
+
+  // Set payload length
+  WriteRegister(RFM95_REG_PAYLOAD_LENGTH, theEntry->pLen) ;
+
+  // Configure DIO0 for TxDone
+  WriteRegister(RFM95_REG_DIO_MAPPING_1, 0x40) ;
+
+  // Clear IRQ flags
+  WriteRegister(RFM95_REG_IRQ_FLAGS, 0xFF) ;
+
+  // Start transmission
+  SetMode(RFM95_MODE_TX) ;
+  sRxArmed = false ;
+  ioRadio->pLastTxSpiUs = time_us_32() - theStartUs ;
+
+  sTxRxWindowUs = theEntry->pRxWindowUs ;
+  sTxHead = (sTxHead + 1) % kLoRaTxQueueSize ;
+  sTxCount-- ;
+  sTxActive = true ;
+  sTxStartMs = to_ms_since_boot(get_absolute_time()) ;
+  return true ;
+}
+
+//----------------------------------------------
+// Internal: Queue Received Packet
+// Copies the packet that raised RxDone from the
+// radio FIFO into the RX queue. inEventUs is the
+// DIO0 (RxDone) time.
+//----------------------------------------------
+static void QueueReceivedPacket(LoRa_Radio * ioRadio, uint32_t inEventUs)
+{
+  if (sRxCount >= kLoRaRxQueueSize)
+  {
+    ioRadio->pRxQueueDrops++ ;
+    return ;
+  }
+
+  uint32_t theStartUs = time_us_32() ;
+  uint8_t theLen = ReadRegister(RFM95_REG_RX_NB_BYTES) ;
+  if (theLen == 0)
+  {
+    return ;
+  }
+
+  LoRaQueueEntry * theEntry = &sRxQueue[(sRxHead + sRxCount) % kLoRaRxQueueSize] ;
+
+  // Read RSSI and SNR before reading FIFO
+  theEntry->pRssi = -157 + ReadRegister(RFM95_REG_PKT_RSSI_VALUE) ;
+  theEntry->pSnr = (int8_t)ReadRegister(RFM95_REG_PKT_SNR_VALUE) / 4 ;
+  theEntry->pRxUs = inEventUs ;
+  theEntry->pFrequencyHz = sTunedHz ;
+
+  // Set FIFO address to current RX address
+  WriteRegister(RFM95_REG_FIFO_ADDR_PTR, ReadRegister(RFM95_REG_FIFO_RX_CURRENT_ADDR)) ;
+
+  ReadFifo(theEntry->pData, theLen) ;
+  theEntry->pLen = theLen ;
+
+  sRxCount++ ;
+  ioRadio->pPacketsReceived++ ;
+  ioRadio->pLastRxSpiUs = time_us_32() - theStartUs ;
+}
+
+//----------------------------------------------
+// Internal: FIFO Loopback
+// Writes a full-length pattern into the radio
+// FIFO and reads it back (standby mode). The TX/RX
+// queue slots serve as buffers, so call only while
+// both queues are empty.
+//----------------------------------------------
+static bool FifoLoopback(uint32_t * outUs)
+{
+  uint8_t * thePattern = sTxQueue[0].pData ;
+  uint8_t * theReadback = sRxQueue[0].pData ;
+
+  for (int i = 0 ; i < kLoRaMaxPacketLen ; i++)
+  {
+    thePattern[i] = (uint8_t)(i * 37 + 11) ;
+    theReadback[i] = 0 ;
+  }
+
+  uint32_t theStartUs = time_us_32() ;
+  WriteRegister(RFM95_REG_FIFO_ADDR_PTR, 0x00) ;
+  WriteFifo(thePattern, kLoRaMaxPacketLen) ;
+  WriteRegister(RFM95_REG_FIFO_ADDR_PTR, 0x00) ;
+  ReadFifo(theReadback, kLoRaMaxPacketLen) ;
+  *outUs = time_us_32() - theStartUs ;
+
+  return memcmp(thePattern, theReadback, kLoRaMaxPacketLen) == 0 ;
+}
+
+//----------------------------------------------
+// Function: LoRa_Init
+//----------------------------------------------
+bool LoRa_Init(LoRa_Radio * outRadio)
+{
+  memset(outRadio, 0, sizeof(LoRa_Radio)) ;
+
+  printf("LoRa: SPI pins SCK=%d MOSI=%d MISO=%d CS=%d RST=%d\n",
+    kPinSpiSck, kPinSpiMosi, kPinSpiMiso, kPinLoRaCs, kPinLoRaReset) ;
+
+  // Note: SPI and GPIO pins already initialized in main.c InitializeSPI()
+  // Just ensure CS is deselected
+  gpio_put(kPinLoRaCs, 1) ;
+
+  // Reset the radio
+  printf("LoRa: Resetting radio...\n") ;
+  gpio_put(kPinLoRaReset, 0) ;
+  sleep_ms(10) ;
+  gpio_put(kPinLoRaReset, 1) ;
+  sleep_ms(10) ;
+
+  // Check version register
+  uint8_t theVersion = ReadRegister(RFM95_REG_VERSION) ;
+  printf("LoRa: Version register = 0x%02X (expected 0x12)\n", theVersion) ;
+  if (theVersion != 0x12)
+  {
+    printf("LoRa: FAIL - wrong version, radio not responding\n") ;
+    return false ;  // Not an RFM95/SX1276
+  }
+
+  // Put in sleep mode to configure
+  SetMode(RFM95_MODE_SLEEP) ;
+  sleep_ms(10) ;
+
+  // Set FIFO base addresses
+  WriteRegister(RFM95_REG_FIFO_TX_BASE_ADDR, 0x00) ;
+  WriteRegister(RFM95_REG_FIFO_RX_BASE_ADDR, 0x00) ;
+
+  // Set LNA boost
+  WriteRegister(RFM95_REG_LNA, ReadRegister(RFM95_REG_LNA) | 0x03) ;
+
+  // Set auto AGC
+  WriteRegister(RFM95_REG_MODEM_CONFIG_3, 0x04) ;
+
+  // Configure with defaults
+  sTunedHz = 0 ;
+  sTxFrequencyHz = 0 ;
+  outRadio->pFrequencyHz = kLoRaFrequency ;
+  outRadio->pTxFrequencyHz = 0 ;
+  outRadio->pSpreadFactor = LORA_SF7 ;
+  outRadio->pBandwidth = LORA_BW_125 ;
+  outRadio->pCodingRate = LORA_CR_4_5 ;
+  outRadio->pDataRate = kLoRaDataRateBase ;
+  outRadio->pTxPowerDbm = kLoRaTxPower ;
+  outRadio->pSyncWord = kLoRaSyncWord ;
+  outRadio->pListenBeforeTalk = kLoRaListenBeforeTalk ;
+
+  // Apply configuration
+  LoRa_SetFrequency(outRadio, outRadio->pFrequencyHz) ;
+  LoRa_SetSpreadingFactor(outRadio, outRadio->pSpreadFactor) ;
+  LoRa_SetBandwidth(outRadio, outRadio->pBandwidth) ;
+  LoRa_SetCodingRate(outRadio, outRadio->pCodingRate) ;
+  LoRa_SetTxPower(outRadio, outRadio->pTxPowerDbm) ;
+  LoRa_SetSyncWord(outRadio, outRadio->pSyncWord) ;
+
+  // Go to standby mode
+  SetMode(RFM95_MODE_STDBY) ;
+
+  // DMA channels for FIFO bursts
+  if (sDmaTx < 0 && sDmaRx < 0)
+  {
+    sDmaTx = dma_claim_unused_channel(false) ;
+    sDmaRx = dma_claim_unused_channel(false) ;
+    if (sDmaTx < 0 || sDmaRx < 0)
+    {
+      // Need both; fall back to CPU bursts
+      if (sDmaTx >= 0) dma_channel_unclaim((uint)sDmaTx) ;
+      if (sDmaRx >= 0) dma_channel_unclaim((uint)sDmaRx) ;
+      sDmaTx = -1 ;
+      sDmaRx = -1 ;
+    }
+  }
+
+  // FIFO loopback, first byte-at-a-time at the original
+  // 1 MHz, then at kSpiLoRaBaudrate with DMA. Proves the
+  // faster clock moves data intact on this board and
+  // records the SPI time per full-FIFO burst.
+  sForceCpu = true ;
+  spi_set_baudrate(kSpiPort, kSpiBaselineBaudrate) ;
+  bool theBaselineOk = FifoLoopback(&outRadio->pSpiBaselineUs) ;
+  spi_set_baudrate(kSpiPort, kSpiLoRaBaudrate) ;
+  sForceCpu = false ;
+  if (!theBaselineOk || !FifoLoopback(&outRadio->pSpiBurstUs))
+  {
+    printf("LoRa: FAIL - FIFO loopback mismatch\n") ;
+    return false ;
+  }
+  printf("LoRa: 255B FIFO loopback %lu us -> %lu us (DMA %s)\n",
+    (unsigned long)outRadio->pSpiBaselineUs, (unsigned long)outRadio->pSpiBurstUs,
+    sDmaTx >= 0 ? "on" : "off") ;
+
+  // DIO0 interrupt (TxDone / RxDone), serviced by LoRa_Service
+  sTxHead = 0 ;
+  sTxCount = 0 ;
+  sTxActive = false ;
+  sRxWindow = false ;
+  ResetLbt() ;
+  sRandom = time_us_32() | 1 ;
+  sRxHead = 0 ;
+  sRxCount = 0 ;
+  sListen = false ;
+  sRxArmed = false ;
+  sDio0Pending = false ;
+  gpio_init(kPinLoRaDio0) ;
+  gpio_set_dir(kPinLoRaDio0, GPIO_IN) ;
+  gpio_set_irq_enabled_with_callback(kPinLoRaDio0, GPIO_IRQ_EDGE_RISE, true, &Dio0Callback) ;
+
+  outRadio->pInitialized = true ;
+  return true ;
+}
+
+//----------------------------------------------
+// Function: LoRa_SetFrequency
+//----------------------------------------------
+bool LoRa_SetFrequency(LoRa_Radio * ioRadio, uint32_t inFrequencyHz)
+{
+  ioRadio->pFrequencyHz = inFrequencyHz ;
+  sRxFrequencyHz = inFrequencyHz ;
+
+  // A transmission or channel check under way
+  // keeps its frequency; EnterReceive retunes after
+  if (sTxActive || sCadActive)
+  {
+    return true ;
+  }
+
+  if (sRxArmed)
+  {
+    DrainSpiFifo() ;
+    SetMode(RFM95_MODE_STDBY) ;
+    sRxArmed = false ;
+    Tune(inFrequencyHz) ;
+    EnterReceive() ;
+  }
+  else
+  {
+    Tune(inFrequencyHz) ;
+  }
+
+  return true ;
+}
+
+//----------------------------------------------
+// Function: LoRa_SetTxFrequency
+//----------------------------------------------
+void LoRa_SetTxFrequency(LoRa_Radio * ioRadio, uint32_t inFrequencyHz)
+{
+  ioRadio->pTxFrequencyHz = inFrequencyHz ;
+  sTxFrequencyHz = inFrequencyHz ;
+}
+
+//----------------------------------------------
+// Function: LoRa_GetChannelFrequency
+//----------------------------------------------
+uint32_t LoRa_GetChannelFrequency(uint8_t inChannel)
+{
+  if (inChannel >= kLoRaChannelCount)
+  {
+    return kLoRaFrequency ;
+  }
+
+  return kLoRaFrequency + (uint32_t)inChannel * kLoRaChannelSpacingHz ;
+}
+
+//----------------------------------------------
+// Function: LoRa_GetChannel
+//----------------------------------------------
+uint8_t LoRa_GetChannel(uint32_t inFrequencyHz)
+{
+  if (inFrequencyHz < kLoRaFrequency ||
+      (inFrequencyHz - kLoRaFrequency) % kLoRaChannelSpacingHz != 0)
+  {
+    return kLoRaChannelCount ;
+  }
+
+  uint32_t theChannel = (inFrequencyHz - kLoRaFrequency) / kLoRaChannelSpacingHz ;
+  return theChannel < kLoRaChannelCount ? (uint8_t)theChannel : kLoRaChannelCount ;
+}
+
+//----------------------------------------------
+// Function: LoRa_GetRocketChannel
+//----------------------------------------------
+uint8_t LoRa_GetRocketChannel(uint8_t inRocketId)
+{
+  return (uint8_t)(1 + inRocketId % (kLoRaChannelCount - 1)) ;
+}
+
+//----------------------------------------------
+// Function: LoRa_SetSpreadingFactor
+//----------------------------------------------
+bool LoRa_SetSpreadingFactor(LoRa_Radio * ioRadio, LoRa_SpreadingFactor inSF)
+{
+  ioRadio->pSpreadFactor = inSF ;
+
+  if (inSF == LORA_SF6)
+  {
+    WriteRegister(RFM95_REG_DETECT_OPTIMIZE, 0xC5) ;
+    WriteRegister(RFM95_REG_DETECTION_THRESHOLD, 0x0C) ;
+  }
+  else
+  {
+    WriteRegister(RFM95_REG_DETECT_OPTIMIZE, 0xC3) ;
+    WriteRegister(RFM95_REG_DETECTION_THRESHOLD, 0x0A) ;
+  }
+
+  uint8_t theConfig2 = ReadRegister(RFM95_REG_MODEM_CONFIG_2) ;
+  theConfig2 = (theConfig2 & 0x0F) | ((inSF << 4) & 0xF0) ;
+  WriteRegister(RFM95_REG_MODEM_CONFIG_2, theConfig2) ;
+
+  return true ;
+}
+
+//----------------------------------------------
+// Function: LoRa_SetBandwidth
+//----------------------------------------------
+bool LoRa_SetBandwidth(LoRa_Radio * ioRadio, LoRa_Bandwidth inBW)
+{
+  ioRadio->pBandwidth = inBW ;
+
+  uint8_t theConfig1 = ReadRegister(RFM95_REG_MODEM_CONFIG_1) ;
+  theConfig1 = (theConfig1 & 0x0F) | ((inBW << 4) & 0xF0) ;
+  WriteRegister(RFM95_REG_MODEM_CONFIG_1, theConfig1) ;
+
+  return true ;
+}
+
+//----------------------------------------------
+// Function: LoRa_SetCodingRate
+//----------------------------------------------
+bool LoRa_SetCodingRate(LoRa_Radio * ioRadio, LoRa_CodingRate inCR)
+{
+  ioRadio->pCodingRate = inCR ;
+
+  uint8_t theConfig1 = ReadRegister(RFM95_REG_MODEM_CONFIG_1) ;
+  theConfig1 = (theConfig1 & 0xF1) | ((inCR << 1) & 0x0E) ;
+  WriteRegister(RFM95_REG_MODEM_CONFIG_1, theConfig1) ;
+
+  return true ;
+}
+
+//----------------------------------------------
+// Function: LoRa_GetDataRate
+//----------------------------------------------
+const LoRa_DataRate * LoRa_GetDataRate(uint8_t inRate)
+{
+  return inRate < kLoRaDataRateCount ? &sDataRates[inRate] : NULL ;
+}
+
+//----------------------------------------------
+// Function: LoRa_SetDataRate
+// The modem registers are only rewritten in
+// standby, so receive is restarted afterwards.
+//----------------------------------------------
+bool LoRa_SetDataRate(LoRa_Radio * ioRadio, uint8_t inRate)
+{
+  if (inRate >= kLoRaDataRateCount || sTxActive || sCadActive)
+  {
+    return false ;
+  }
+
+  DrainSpiFifo() ;
+  SetMode(RFM95_MODE_STDBY) ;
+  sRxArmed = false ;
+
+  LoRa_SetSpreadingFactor(ioRadio, sDataRates[inRate].pSpreadFactor) ;
+  LoRa_SetBandwidth(ioRadio, sDataRates[inRate].pBandwidth) ;
+  ioRadio->pDataRate = inRate ;
+
+  // A packet held for its TX window starts from
+  // LoRa_Service as usual
+  if (sListen)
+  {
+    EnterReceive() ;
+  }
+  return true ;
+}
+
+//----------------------------------------------
+// Function: LoRa_SetTxPower
+//----------------------------------------------
+bool LoRa_SetTxPower(LoRa_Radio * ioRadio, int8_t inPowerDbm)
+{
+  ioRadio->pTxPowerDbm = inPowerDbm ;
+
+  // Clamp power to valid range
+  if (inPowerDbm < 2) inPowerDbm = 2 ;
+  if (inPowerDbm > 20) inPowerDbm = 20 ;
+
+  if (inPowerDbm > 17)
+  {
+    // Use PA_BOOST with high power settings
+    WriteRegister(RFM95_REG_PA_DAC, 0x87) ;  // Enable +20dBm
+    WriteRegister(RFM95_REG_PA_CONFIG, RFM95_PA_BOOST | (inPowerDbm - 5)) ;
+  }
+  else
+  {
+    WriteRegister(RFM95_REG_PA_DAC, 0x84) ;  // Default power
+    WriteRegister(RFM95_REG_PA_CONFIG, RFM95_PA_BOOST | (inPowerDbm - 2)) ;
+  }
+
+  return true ;
+}
+
+//----------------------------------------------
+// Function: LoRa_SetSyncWord
+//----------------------------------------------
+bool LoRa_SetSyncWord(LoRa_Radio * ioRadio, uint8_t inSyncWord)
+{
+  ioRadio->pSyncWord = inSyncWord ;
+  WriteRegister(RFM95_REG_SYNC_WORD, inSyncWord) ;
+  return true ;
+}
+
+//----------------------------------------------
+// Function: LoRa_ReadVersion
+// Reads the version register (0x42) for diagnostics.
+// Returns 0x12 for RFM95/SX1276, 0x00 if SPI broken.
+//----------------------------------------------
+uint8_t LoRa_ReadVersion(LoRa_Radio * inRadio)
+{
+  (void)inRadio ;
+  return ReadRegister(RFM95_REG_VERSION) ;
+}
+
+//----------------------------------------------
+// Function: LoRa_EnsureReady
+// Checks SPI1 communication with the radio by
+// reading the version register. If the radio is
+// not responding, performs a full hardware reset
+// (GP17 toggle) and reconfigures all settings.
+//----------------------------------------------
+bool LoRa_EnsureReady(LoRa_Radio * ioRadio)
+{
+  if (!ioRadio->pInitialized)
+    return false ;
+
+  // Full hardware reset — matches LoRa_Init timing exactly.
+  // NO SpiReinit (SPI peripheral is fine, only radio needs reset).
+  gpio_put(kPinLoRaCs, 1) ;
+  gpio_put(kPinLoRaReset, 0) ;
+  sleep_ms(10) ;
+  gpio_put(kPinLoRaReset, 1) ;
+  sleep_ms(10) ;
+
+  // Verify radio came back
+  uint8_t theVersion = ReadRegister(RFM95_REG_VERSION) ;
+  if (theVersion != 0x12)
+    return false ;
+
+  // Reconfigure radio (sleep → configure → standby)
+  SetMode(RFM95_MODE_SLEEP) ;
+  sleep_ms(10) ;
+
+  WriteRegister(RFM95_REG_FIFO_TX_BASE_ADDR, 0x00) ;
+  WriteRegister(RFM95_REG_FIFO_RX_BASE_ADDR, 0x00) ;
+  WriteRegister(RFM95_REG_LNA, ReadRegister(RFM95_REG_LNA) | 0x03) ;
+  WriteRegister(RFM95_REG_MODEM_CONFIG_3, 0x04) ;
+
+  // The reset cleared the carrier frequency too
+  sTunedHz = 0 ;
+  sRxArmed = false ;
+  LoRa_SetFrequency(ioRadio, ioRadio->pFrequencyHz) ;
+  LoRa_SetSpreadingFactor(ioRadio, ioRadio->pSpreadFactor) ;
+  LoRa_SetBandwidth(ioRadio, ioRadio->pBandwidth) ;
+  LoRa_SetCodingRate(ioRadio, ioRadio->pCodingRate) ;
+  LoRa_SetTxPower(ioRadio, ioRadio->pTxPowerDbm) ;
+  LoRa_SetSyncWord(ioRadio, ioRadio->pSyncWord) ;
+
+  // Reset dropped any transmission in progress
+  sTxActive = false ;
+  sRxArmed = false ;
+  SetMode(RFM95_MODE_STDBY) ;
+  if (sListen)
+  {
+    EnterReceive() ;
+  }
+  return true ;
+}
+
+//----------------------------------------------
+// Internal: Queue Packet
+// Adds a packet at the back of the TX queue, or
+// at the front for inFirst, and starts it if the
+// radio is free.
+//----------------------------------------------
+static bool QueuePacket(
+  LoRa_Radio * ioRadio,
+  const uint8_t * inData,
+  uint8_t inLen,
+  bool inFirst,
+  uint32_t inRxWindowUs)
+{
+  if (!ioRadio->pInitialized || inLen == 0)
+  {
+    return false ;
+  }
+
+  if (sTxCount >= kLoRaTxQueueSize)
+  {
+    ioRadio->pTxQueueDrops++ ;
+    return false ;
+  }
+
+  LoRaQueueEntry * theEntry ;
+  if (inFirst)
+  {
+    sTxHead = (sTxHead + kLoRaTxQueueSize - 1) % kLoRaTxQueueSize ;
+    theEntry = &sTxQueue[sTxHead] ;
+  }
+  else
+  {
+    theEntry = &sTxQueue[(sTxHead + sTxCount) % kLoRaTxQueueSize] ;
+  }
+  memcpy(theEntry->pData, inData, inLen) ;
+  theEntry->pLen = inLen ;
+  theEntry->pRxWindowUs = inRxWindowUs ;
+  sTxCount++ ;
+
+  // Radio idle or listening: start now, otherwise
+  // LoRa_Service starts it on TxDone
+  if (!sTxActive && !sCadActive)
+  {
+    StartNextTransmit(ioRadio) ;
+  }
+  return true ;
+}
+
+//----------------------------------------------
+// Function: LoRa_Send
+//----------------------------------------------
+bool LoRa_Send(LoRa_Radio * ioRadio, const uint8_t * inData, uint8_t inLen)
+{
+  return QueuePacket(ioRadio, inData, inLen, false, 0) ;
+}
+
+//----------------------------------------------
+// Function: LoRa_SendFirst
+//----------------------------------------------
+bool LoRa_SendFirst(LoRa_Radio * ioRadio, const uint8_t * inData, uint8_t inLen)
+{
+  return QueuePacket(ioRadio, inData, inLen, true, 0) ;
+}
+
+//----------------------------------------------
+// Function: LoRa_SendWithRxWindow
+//----------------------------------------------
+bool LoRa_SendWithRxWindow(
+  LoRa_Radio * ioRadio,
+  const uint8_t * inData,
+  uint8_t inLen,
+  uint32_t inWindowUs)
+{
+  return QueuePacket(ioRadio, inData, inLen, false, inWindowUs) ;
+}
+
+//----------------------------------------------
+// Function: LoRa_SendBlocking
+//----------------------------------------------
+bool LoRa_SendBlocking(
+  LoRa_Radio * ioRadio,
+  const uint8_t * inData,
+  uint8_t inLen,
+  uint32_t inTimeoutMs)
+{
+  if (!LoRa_Send(ioRadio, inData, inLen))
+  {
+    return false ;
+  }
+
+  // Wait for the queue (including this packet) to drain
+  uint32_t theStart = to_ms_since_boot(get_absolute_time()) ;
+  while (LoRa_IsTransmitting(ioRadio))
+  {
+    if ((to_ms_since_boot(get_absolute_time()) - theStart) > inTimeoutMs)
+    {
+      return false ;
+    }
+
+    busy_wait_us_32(100) ;
+    LoRa_Service(ioRadio) ;
+  }
+
+  return true ;
+}
+
+//----------------------------------------------
+// Function: LoRa_SetTxWindow
+//----------------------------------------------
+void LoRa_SetTxWindow(LoRa_Radio * ioRadio, uint32_t inStartUs, uint32_t inEndUs)
+{
+  (void)ioRadio ;
+  sTxWindow = true ;
+  sTxWindowStartUs = inStartUs ;
+  sTxWindowEndUs = inEndUs ;
+}
+
+//----------------------------------------------
+// Function: LoRa_ClearTxWindow
+//----------------------------------------------
+void LoRa_ClearTxWindow(LoRa_Radio * ioRadio)
+{
+  (void)ioRadio ;
+  sTxWindow = false ;
+}
+
+//----------------------------------------------
+// Function: LoRa_SetListenBeforeTalk
+//----------------------------------------------
+void LoRa_SetListenBeforeTalk(LoRa_Radio * ioRadio, bool inEnabled)
+{
+  ioRadio->pListenBeforeTalk = inEnabled ;
+}
+
+//----------------------------------------------
+// Internal: Time On Air
+// SX1276 datasheet 4.1.1.7 with explicit header
+// and payload CRC. The driver never sets
+// LowDataRateOptimize, so DE is 0.
+//----------------------------------------------
+static uint32_t TimeOnAirUs(
+  LoRa_SpreadingFactor inSF,
+  LoRa_Bandwidth inBW,
+  LoRa_CodingRate inCR,
+  uint8_t inLen)
+{
+  int32_t theSf = (int32_t)inSF ;
+  int32_t theCr = (int32_t)inCR ;
+  uint32_t theBwHz = sBandwidthHz[inBW <= LORA_BW_500 ? inBW : LORA_BW_125] ;
+
+  // Payload symbols beyond the first 8
+  int32_t theBits = 8 * (int32_t)inLen - 4 * theSf + 28 + 16 ;
+  int32_t theBlocks = theBits > 0 ? (theBits + 4 * theSf - 1) / (4 * theSf) : 0 ;
+  uint32_t theSymbols = (uint32_t)(8 + theBlocks * (theCr + 4)) ;
+
+  // Quarter symbols: preamble + 4.25 sync, then payload
+  uint32_t theQuarters = (kLoRaPreambleLen * 4 + 17) + theSymbols * 4 ;
+  return (uint32_t)(((uint64_t)theQuarters << theSf) * 1000000ULL / theBwHz / 4) ;
+}
+
+//----------------------------------------------
+// Function: LoRa_GetTimeOnAirUs
+//----------------------------------------------
+uint32_t LoRa_GetTimeOnAirUs(const LoRa_Radio * inRadio, uint8_t inLen)
+{
+  return TimeOnAirUs(inRadio->pSpreadFactor, inRadio->pBandwidth, inRadio->pCodingRate, inLen) ;
+}
+
+//----------------------------------------------
+// Function: LoRa_GetRateTimeOnAirUs
+//----------------------------------------------
+uint32_t LoRa_GetRateTimeOnAirUs(const LoRa_Radio * inRadio, uint8_t inRate, uint8_t inLen)
+{
+  if (inRate >= kLoRaDataRateCount)
+  {
+    return 0 ;
+  }
+
+  return TimeOnAirUs(sDataRates[inRate].pSpreadFactor, sDataRates[inRate].pBandwidth,
+                     inRadio->pCodingRate, inLen) ;
+}
+
+//----------------------------------------------
+// Function: LoRa_GetConfigTimeOnAirUs
+//----------------------------------------------
+uint32_t LoRa_GetConfigTimeOnAirUs(uint8_t inRate, LoRa_CodingRate inCR, uint8_t inLen)
+{
+  if (inRate >= kLoRaDataRateCount)
+  {
+    return 0 ;
+  }
+
+  return TimeOnAirUs(sDataRates[inRate].pSpreadFactor, sDataRates[inRate].pBandwidth, inCR, inLen) ;
+}
+
+//----------------------------------------------
+// Function: LoRa_StartReceive
+//----------------------------------------------
+bool LoRa_StartReceive(LoRa_Radio * ioRadio)
+{
+  if (!ioRadio->pInitialized)
+  {
+    return false ;
+  }
+
+  sListen = true ;
+
+  // Never abort a transmission; LoRa_Service enters
+  // receive once the TX queue is empty
+  if (!sTxActive)
+  {
+    EnterReceive() ;
+  }
+
+  return true ;
+}
+
+//----------------------------------------------
+// Function: LoRa_Available
+//----------------------------------------------
+uint8_t LoRa_Available(LoRa_Radio * inRadio)
+{
+  (void)inRadio ;
+
+  if (sRxCount == 0)
+  {
+    return 0 ;
+  }
+
+  return sRxQueue[sRxHead].pLen ;
+}
+
+//----------------------------------------------
+// Function: LoRa_Receive
+//----------------------------------------------
+uint8_t LoRa_Receive(LoRa_Radio * ioRadio, uint8_t * outData, uint8_t inMaxLen)
+{
+  if (sRxCount == 0)
+  {
+    return 0 ;
+  }
+
+  const LoRaQueueEntry * theEntry = &sRxQueue[sRxHead] ;
+
+  // Limit to buffer size
+  uint8_t theLen = theEntry->pLen ;
+  if (theLen > inMaxLen)
+  {
+    theLen = inMaxLen ;
+  }
+
+  memcpy(outData, theEntry->pData, theLen) ;
+  ioRadio->pLastRssi = theEntry->pRssi ;
+  ioRadio->pLastSnr = theEntry->pSnr ;
+  ioRadio->pLastRxUs = theEntry->pRxUs ;
+  ioRadio->pLastRxFrequencyHz = theEntry->pFrequencyHz ;
+
+  sRxHead = (sRxHead + 1) % kLoRaRxQueueSize ;
+  sRxCount-- ;
+  return theLen ;
+}
+
+//----------------------------------------------
+// Function: LoRa_GetRssi
+//----------------------------------------------
+int16_t LoRa_GetRssi(LoRa_Radio * inRadio)
+{
+  return inRadio->pLastRssi ;
+}
+
+//----------------------------------------------
+// Function: LoRa_GetSnr
+//----------------------------------------------
+int8_t LoRa_GetSnr(LoRa_Radio * inRadio)
+{
+  return inRadio->pLastSnr ;
+}
+
+//----------------------------------------------
+// Function: LoRa_Sleep
+//----------------------------------------------
+bool LoRa_Sleep(LoRa_Radio * ioRadio)
+{
+  (void)ioRadio ;
+  sListen = false ;
+  sTxActive = false ;
+  sTxCount = 0 ;
+  sRxWindow = false ;
+  ResetLbt() ;
+  sRxArmed = false ;
+  SetMode(RFM95_MODE_SLEEP) ;
+  return true ;
+}
+
+//----------------------------------------------
+// Function: LoRa_Idle
+//----------------------------------------------
+bool LoRa_Idle(LoRa_Radio * ioRadio)
+{
+  (void)ioRadio ;
+  sListen = false ;
+  sTxActive = false ;
+  sTxCount = 0 ;
+  sRxWindow = false ;
+  ResetLbt() ;
+  sRxArmed = false ;
+  SetMode(RFM95_MODE_STDBY) ;
+  return true ;
+}
+
+//----------------------------------------------
+// Function: LoRa_IsTransmitting
+//----------------------------------------------
+bool LoRa_IsTransmitting(LoRa_Radio * inRadio)
+{
+  (void)inRadio ;
+  return sTxActive || sTxCount > 0 ;
+}
+
+//----------------------------------------------
+// Function: LoRa_Service
+//----------------------------------------------
+void LoRa_Service(LoRa_Radio * ioRadio)
+{
+  if (!ioRadio->pInitialized)
+  {
+    return ;
+  }
+
+  // DIO0 stays high until the IRQ flags are cleared,
+  // so the pin level also catches an edge that
+  // arrived while the previous event was handled.
+  if (sDio0Pending || gpio_get(kPinLoRaDio0))
+  {
+    uint32_t theEventUs = sDio0Pending ? sDio0Us : time_us_32() ;
+    sDio0Pending = false ;
+
+    uint8_t theFlags = ReadRegister(RFM95_REG_IRQ_FLAGS) ;
+
+    if (sTxActive && (theFlags & RFM95_IRQ_TX_DONE))
+    {
+      sTxActive = false ;
+      ioRadio->pPacketsSent++ ;
+      if (sTxRxWindowUs != 0)
+      {
+        sRxWindow = true ;
+        sRxWindowEndUs = theEventUs + sTxRxWindowUs ;
+        ioRadio->pRxWindows++ ;
+      }
+    }
+
+    if (sCadActive && (theFlags & RFM95_IRQ_CAD_DONE))
+    {
+      sCadActive = false ;
+      if ((theFlags & RFM95_IRQ_CAD_DETECTED) == 0)
+      {
+        sCadClear = true ;
+      }
+      else
+      {
+        DeferTransmit(ioRadio, theEventUs) ;
+      }
+    }
+
+    if (theFlags & RFM95_IRQ_RX_DONE)
+    {
+      if (theFlags & RFM95_IRQ_PAYLOAD_CRC_ERROR)
+      {
+        ioRadio->pRxCrcErrors++ ;
+      }
+      else
+      {
+        QueueReceivedPacket(ioRadio, theEventUs) ;
+      }
+    }
+
+    WriteRegister(RFM95_REG_IRQ_FLAGS, theFlags) ;
+  }
+
+  // TxDone watchdog: recover if the interrupt was lost
+  if (sTxActive &&
+      (to_ms_since_boot(get_absolute_time()) - sTxStartMs) > kLoRaTxTimeoutMs)
+  {
+    ioRadio->pTxTimeouts++ ;
+    sTxActive = false ;
+    SetMode(RFM95_MODE_STDBY) ;
+  }
+
+  // CadDone watchdog: take the channel as clear
+  if (sCadActive && (time_us_32() - sCadStartUs) > kLoRaCadTimeoutUs)
+  {
+    sCadActive = false ;
+    sCadClear = true ;
+    SetMode(RFM95_MODE_STDBY) ;
+  }
+
+  // Next packet (or its channel check), or back
+  // to receive
+  if (!sTxActive && !sCadActive && !StartNextTransmit(ioRadio) && sListen && !sRxArmed)
+  {
+    EnterReceive() ;
+  }
+}
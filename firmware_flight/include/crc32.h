@@ -0,0 +1,76 @@
+//----------------------------------------------
+// Module: crc32.h
+// Description: CRC32 computed by the RP2040 DMA
+//   sniffer while data moves through a DMA channel
+// Author: Mark Gavin
+// Created: 2026-02-02
+// Copyright: (c) 2025-2026 by Mark Gavin
+// License: Proprietary - All Rights Reserved
+//
+// Algorithm:
+//   - CRC-32/MPEG-2 (the sniffer's native CRC32 mode)
+//   - Polynomial 0x04C11DB7, MSB first, no reflection
+//   - Initial value 0xFFFFFFFF, no final XOR
+//   - Check value for "123456789" is 0x0376E6E7
+//----------------------------------------------
+
+#pragma once
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+//----------------------------------------------
+// CRC Constants
+//----------------------------------------------
+#define kCrc32Initial       0xFFFFFFFF  // Seed for a new CRC
+
+//----------------------------------------------
+// Function: Crc32_Init
+// Purpose: Claim a DMA channel for the sniffer
+// Returns: true if a DMA channel was claimed
+// Notes: Falls back to a software CRC if no
+//   channel is available
+//----------------------------------------------
+bool Crc32_Init(void) ;
+
+//----------------------------------------------
+// Function: Crc32_Update
+// Purpose: Continue a CRC over a block of memory
+// Parameters:
+//   inCrc - running CRC (kCrc32Initial to start)
+//   inData - data to checksum (RAM or XIP flash)
+//   inSize - number of bytes
+// Returns: Updated CRC
+//----------------------------------------------
+uint32_t Crc32_Update(
+  uint32_t inCrc,
+  const void * inData,
+  size_t inSize) ;
+
+//----------------------------------------------
+// Function: Crc32_Copy
+// Purpose: Copy a block and continue the CRC over
+//   it in the same DMA transfer
+// Parameters:
+//   inCrc - running CRC (kCrc32Initial to start)
+//   outDest - destination buffer
+//   inSource - source data
+//   inSize - number of bytes
+// Returns: Updated CRC
+//----------------------------------------------
+uint32_t Crc32_Copy(
+  uint32_t inCrc,
+  void * outDest,
+  const void * inSource,
+  size_t inSize) ;
+
+//----------------------------------------------
+// Function: Crc32_Compute
+// Purpose: Compute the CRC of a single block
+// Parameters:
+//   inData - data to checksum
+//   inSize - number of bytes
+// Returns: CRC32 of the block
+//----------------------------------------------
+uint32_t Crc32_Compute(const void * inData, size_t inSize) ;
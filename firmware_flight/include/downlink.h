@@ -0,0 +1,189 @@
+//----------------------------------------------
+// Module: downlink.h
+// Description: Priority downlink scheduler with
+//   an airtime budget
+// Author: Mark Gavin
+// Created: 2026-02-15
+// Copyright: (c) 2025-2026 by Mark Gavin
+// License: Proprietary - All Rights Reserved
+//
+// Every frame the flight computer sends goes
+// through one queue in four classes, highest
+// first:
+//
+//   kDownlinkEvent      telemetry carrying a flight
+//                       event, data rate confirms
+//   kDownlinkTelemetry  telemetry, recovery beacons
+//                       and FEC parity
+//   kDownlinkResponse   command replies, device
+//                       info, flash list and data,
+//                       baro comparison
+//   kDownlinkBulk       bulk flash download chunks
+//
+// A frame is handed to the radio only once the
+// radio's own queue is empty, the highest class
+// first and the oldest first within a class, so
+// a flash read no longer holds up telemetry.
+//
+// Airtime is metered by a token bucket that fills
+// at kDownlinkDutyPercent of real time, up to
+// kDownlinkBurstUs. A frame costs its time on air
+// at the data rate in use when it goes out. Events
+// and telemetry are charged but never held: their
+// rate is the flight profile's, and they may run
+// the bucket down to -kDownlinkBurstUs. Responses
+// and bulk chunks wait until the bucket covers
+// them, so they get what is left of the budget.
+// A frame still queued after kDownlinkExpireMs is
+// dropped; the gateway asks again. A link
+// benchmark (link_bench.h) takes the radio from
+// under the queue while it runs.
+//
+// Each class keeps its queueing delay (queued to
+// handed to the radio), which the device info
+// packet reports.
+//----------------------------------------------
+
+#pragma once
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "lora_radio.h"
+
+//----------------------------------------------
+// Constants
+//----------------------------------------------
+#define kDownlinkClassCount     4
+#define kDownlinkQueueSize      6
+#define kDownlinkMaxLen         kLoRaMaxPacketLen
+#define kDownlinkDutyPercent    80        // Leaves the gateway room to talk
+#define kDownlinkBurstUs        1000000   // Bucket depth, us of airtime
+#define kDownlinkExpireMs       3000
+
+//----------------------------------------------
+// Priority Classes (highest first)
+//----------------------------------------------
+typedef enum
+{
+  kDownlinkEvent = 0 ,
+  kDownlinkTelemetry ,
+  kDownlinkResponse ,
+  kDownlinkBulk
+} DownlinkClass ;
+
+//----------------------------------------------
+// Queued Frame
+//----------------------------------------------
+typedef struct
+{
+  bool pUsed ;
+  bool pHeld ;                    // Has waited for the budget
+  uint8_t pClass ;                // DownlinkClass
+  uint8_t pLen ;
+  uint32_t pRxWindowUs ;          // Receive window after it (0: none)
+  uint32_t pQueuedUs ;
+  uint8_t pData[kDownlinkMaxLen] ;
+} DownlinkFrame ;
+
+//----------------------------------------------
+// Per-Class Statistics
+//----------------------------------------------
+typedef struct
+{
+  uint32_t pSent ;
+  uint32_t pDropped ;             // Queue full, pushed out or expired
+  uint32_t pHeld ;                // Frames that waited for the budget
+  uint64_t pDelayTotalUs ;
+  uint32_t pDelayMaxUs ;
+} DownlinkStats ;
+
+//----------------------------------------------
+// Scheduler State
+//----------------------------------------------
+typedef struct
+{
+  DownlinkFrame pFrames[kDownlinkQueueSize] ;
+  int32_t pTokensUs ;             // Airtime left in the bucket
+  uint32_t pLastRefillUs ;
+  DownlinkStats pStats[kDownlinkClassCount] ;
+} DownlinkQueue ;
+
+//----------------------------------------------
+// Function: Downlink_Init
+// Purpose: Start empty with a full bucket
+// Parameters:
+//   outQueue - Scheduler to initialize
+//   inNowUs - Current time (time_us_32)
+//----------------------------------------------
+void Downlink_Init(DownlinkQueue * outQueue, uint32_t inNowUs) ;
+
+//----------------------------------------------
+// Function: Downlink_Queue
+// Purpose: Queue a frame in its class
+// Parameters:
+//   ioQueue - Scheduler
+//   inClass - DownlinkClass
+//   inData - Frame
+//   inLen - Frame length (up to kDownlinkMaxLen)
+//   inRxWindowUs - Receive window to open after
+//     it (LoRa_SendWithRxWindow), 0 for none
+//   inNowUs - Current time (time_us_32)
+// Returns: false if the frame was dropped
+// Notes: With the queue full, the newest frame of
+//   the lowest class below inClass is pushed out;
+//   if there is none, this frame is dropped
+//----------------------------------------------
+bool Downlink_Queue(
+  DownlinkQueue * ioQueue,
+  uint8_t inClass,
+  const uint8_t * inData,
+  uint8_t inLen,
+  uint32_t inRxWindowUs,
+  uint32_t inNowUs) ;
+
+//----------------------------------------------
+// Function: Downlink_IsQueued
+// Purpose: Check for a waiting frame of a class
+// Parameters:
+//   inQueue - Scheduler
+//   inClass - DownlinkClass
+// Returns: true if one is queued
+//----------------------------------------------
+bool Downlink_IsQueued(const DownlinkQueue * inQueue, uint8_t inClass) ;
+
+//----------------------------------------------
+// Function: Downlink_Service
+// Purpose: Hand the next frame to the radio when
+//   it is free and the budget allows
+// Parameters:
+//   ioQueue - Scheduler
+//   ioRadio - Radio
+//   inNowUs - Current time (time_us_32)
+//   inMaxAirUs - Longest time on air that fits
+//     now (a TDMA slot), UINT32_MAX if free
+// Returns: true if a frame was handed over
+// Notes: Drops expired frames first. The next
+//   frame waits, rather than a later one going
+//   ahead, when it does not fit inMaxAirUs.
+//----------------------------------------------
+bool Downlink_Service(
+  DownlinkQueue * ioQueue,
+  LoRa_Radio * ioRadio,
+  uint32_t inNowUs,
+  uint32_t inMaxAirUs) ;
+
+//----------------------------------------------
+// Function: Downlink_GetDelayMs
+// Purpose: Queueing delay of a class
+// Parameters:
+//   inQueue - Scheduler
+//   inClass - DownlinkClass
+//   outAverageMs - Mean over frames sent
+//   outMaxMs - Longest
+//----------------------------------------------
+void Downlink_GetDelayMs(
+  const DownlinkQueue * inQueue,
+  uint8_t inClass,
+  uint16_t * outAverageMs,
+  uint16_t * outMaxMs) ;
@@ -0,0 +1,178 @@
+//----------------------------------------------
+// Module: event_journal.h
+// Description: Flash-backed journal of flight
+//   events, resent on telemetry until ACKed
+// Author: Mark Gavin
+// Created: 2026-02-15
+// Copyright: (c) 2025-2026 by Mark Gavin
+// License: Proprietary - All Rights Reserved
+//
+// Every flight state change is recorded with its
+// own sequence number, the time it happened and
+// the altitude and velocity at that moment. The
+// oldest event the gateway has not acknowledged
+// rides on each telemetry frame as a trailer
+// (layout: lora_protocol.h, kEventTrailerLen)
+// until an ACK summary names its sequence, so a
+// lost frame no longer loses the event.
+//
+// The journal lives in one flash sector as 32-
+// byte records:
+//
+//   0      kJournalRecordMarker (0xFF: end)
+//   1      0xFF until ACKed, then programmed to
+//          0x00 in place (not in the CRC)
+//   2      event sequence
+//   3      event type (kEvent*)
+//   4      flight state after the event
+//   5-7    0xFF
+//   8-11   time, ms since boot
+//   12-15  altitude, dm (int32)
+//   16-17  velocity, dm/s (int16)
+//   18-19  0xFF
+//   20-23  CRC32 of bytes 0 and 2-19
+//
+// Flash is only written on the ground (see
+// EventJournal_Flush): events from a flight are
+// stored at landing, along with the ACKs that
+// came in meanwhile. Events not ACKed before a
+// restart are sent again after it, and the
+// sequence carries on from the last one stored.
+//----------------------------------------------
+
+#pragma once
+
+#include <stdint.h>
+#include <stdbool.h>
+
+//----------------------------------------------
+// Constants
+//----------------------------------------------
+#define kEventJournalOffset     0x7FA000  // Below the settings log (storage.c)
+#define kJournalRecordSize      32
+#define kJournalRecordMarker    0xEA
+#define kJournalSize            16        // Events kept in RAM
+#define kJournalCompactRecords  64        // Compacted at boot past this
+
+//----------------------------------------------
+// Journal Event
+//----------------------------------------------
+typedef struct
+{
+  uint8_t pSequence ;
+  uint8_t pType ;                 // kEvent*
+  uint8_t pState ;                // Flight state after the event
+  uint32_t pTimeMs ;              // Ms since boot
+  int32_t pAltitudeDm ;
+  int16_t pVelocityDms ;
+  bool pAcked ;
+  bool pStored ;                  // Written to flash
+  bool pAckStored ;               // ACK mark written to flash
+  uint16_t pRecord ;              // Flash record index (when stored)
+} JournalEvent ;
+
+//----------------------------------------------
+// Journal State
+//----------------------------------------------
+typedef struct
+{
+  bool pFlashOk ;                 // Sector usable
+  bool pStateValid ;              // pLastState is known
+  uint8_t pLastState ;
+  uint8_t pNextSequence ;
+  uint16_t pNextRecord ;          // First free record in the sector
+
+  // Oldest first
+  JournalEvent pEvents[kJournalSize] ;
+  uint8_t pHead ;
+  uint8_t pCount ;
+
+  // Statistics
+  uint32_t pRecorded ;
+  uint32_t pTrailersSent ;
+  uint32_t pAcked ;
+  uint32_t pDropped ;             // Pushed out unACKed by newer events
+} EventJournal ;
+
+//----------------------------------------------
+// Function: EventJournal_Init
+// Purpose: Load the journal from flash
+// Parameters:
+//   outJournal - State to initialize
+// Returns: false if the sector could not be used
+//   (events are still kept and sent from RAM)
+// Notes: Erases and rewrites the sector when it
+//   holds more than kJournalCompactRecords; call
+//   at boot only
+//----------------------------------------------
+bool EventJournal_Init(EventJournal * outJournal) ;
+
+//----------------------------------------------
+// Function: EventJournal_NoteState
+// Purpose: Record an event when the flight state
+//   has changed since the last call
+// Parameters:
+//   ioJournal - State
+//   inState - Current flight state
+//   inTimeMs - Current time (ms since boot)
+//   inAltitudeM - Current altitude AGL
+//   inVelocityMps - Current vertical velocity
+// Returns: true if an event was recorded
+// Notes: The first call only sets the baseline
+//----------------------------------------------
+bool EventJournal_NoteState(
+  EventJournal * ioJournal,
+  uint8_t inState,
+  uint32_t inTimeMs,
+  float inAltitudeM,
+  float inVelocityMps) ;
+
+//----------------------------------------------
+// Function: EventJournal_Flush
+// Purpose: Write new events and ACK marks to
+//   flash
+// Parameters:
+//   ioJournal - State
+// Notes: Programs a page per record; the main
+//   loop calls it only outside boost to descent.
+//   A full sector is compacted first.
+//----------------------------------------------
+void EventJournal_Flush(EventJournal * ioJournal) ;
+
+//----------------------------------------------
+// Function: EventJournal_GetPending
+// Purpose: Oldest event not yet acknowledged
+// Parameters:
+//   inJournal - State
+// Returns: The event, NULL if all are delivered
+//----------------------------------------------
+const JournalEvent * EventJournal_GetPending(const EventJournal * inJournal) ;
+
+//----------------------------------------------
+// Function: EventJournal_BuildTrailer
+// Purpose: Append the oldest pending event to a
+//   telemetry frame
+// Parameters:
+//   ioJournal - State
+//   outTrailer - Where the trailer goes (right
+//     after the frame's CRC)
+//   inMaxLen - Room left
+// Returns: Trailer length (kEventTrailerLen), 0
+//   if nothing is pending or it does not fit
+//----------------------------------------------
+uint8_t EventJournal_BuildTrailer(
+  EventJournal * ioJournal,
+  uint8_t * outTrailer,
+  uint8_t inMaxLen) ;
+
+//----------------------------------------------
+// Function: EventJournal_Acknowledge
+// Purpose: Mark the event on air delivered
+// Parameters:
+//   ioJournal - State
+//   inSequence - Latest sequence the gateway has
+// Returns: 1 if inSequence names the oldest
+//   unacknowledged event (the one in the
+//   trailer), 0 otherwise
+//----------------------------------------------
+uint8_t EventJournal_Acknowledge(EventJournal * ioJournal, uint8_t inSequence) ;
@@ -13,7 +13,7 @@
 #define FF_USE_FIND      0     // Disable filtered directory read
 #define FF_USE_MKFS      0     // Disable mkfs (we don't format cards)
 #define FF_USE_FASTSEEK  0     // Disable fast seek
-#define FF_USE_EXPAND    0     // Disable f_expand
+#define FF_USE_EXPAND    1     // Enable f_expand (preallocated flight logs)
 #define FF_USE_CHMOD     0     // Disable chmod
 #define FF_USE_LABEL     0     // Disable volume label
 #define FF_USE_FORWARD   0     // Disable f_forward
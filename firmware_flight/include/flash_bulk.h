@@ -0,0 +1,171 @@
+//----------------------------------------------
+// Module: flash_bulk.h
+// Description: Sliding-window bulk download of a
+//   stored flight over LoRa (sender side)
+// Author: Mark Gavin
+// Created: 2026-02-13
+// Copyright: (c) 2025-2026 by Mark Gavin
+// License: Proprietary - All Rights Reserved
+// Modified: 2026-02-16 (delta-coded runs, transfer rate)
+//
+// One kCmdFlashBulkRead from the gateway starts
+// the stream:
+//
+//   4      slot
+//   5      session
+//   6      data rate for the transfer (optional;
+//          the link's rate when absent)
+//
+// The gateway picks the fastest rate the link to
+// this rocket has margin for. Both ends move to
+// it for the transfer alone and go back to the
+// link's rate when it ends or is given up.
+//
+// The flight is cut into chunks of
+// kBulkSamplesPerChunk samples, sent back-to-back
+// in bursts of kBulkBurstChunks. A packet holds
+// a run of consecutive chunks, delta-coded, as
+// many as fit (up to kBulkMaxRun). The last
+// packet of a burst carries the poll flag; the
+// gateway answers it with kCmdFlashBulkAck:
+//
+//   4      slot
+//   5      session
+//   6-7    base: first chunk not yet received
+//   8-11   bitmap: bit n set if chunk base+n was
+//          received
+//
+// Chunks below base are done. Clear bits below
+// the last chunk sent are sent again at the start
+// of the next burst, ahead of new chunks. No more
+// than kBulkWindowChunks chunks past base are ever
+// outstanding. An unanswered poll is repeated
+// (the polled packet again) every kBulkAckTimeoutMs,
+// and the transfer is dropped after kBulkMaxPolls.
+//
+// Chunk (kLoRaPacketFlashBulk, flight to gateway):
+//   0      magic (kLoRaMagic)
+//   1      type (kLoRaPacketFlashBulk)
+//   2      rocket ID
+//   3      slot
+//   4      session (from the request)
+//   5      flags (kBulkFlagPoll)
+//   6-7    first chunk index
+//   8-9    total samples in the flight
+//   10     chunks in the packet (1 to kBulkMaxRun)
+//   11..   the first sample as stored (FlightSample,
+//          48 bytes), then each further one as its
+//          change from the one before
+//          (LoRaProtocol_PutSampleDelta)
+//
+// A sample in flight codes to about 22 bytes, so
+// a packet carries about eight samples, against
+// five stored ones. One chunk always fits.
+//----------------------------------------------
+
+#pragma once
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "lora_protocol.h"
+#include "flight_storage.h"
+
+//----------------------------------------------
+// Constants
+//----------------------------------------------
+#define kBulkChunkMaxLen        250     // Packet limit, filled by a run
+#define kBulkBurstChunks        16      // Chunks per poll
+#define kBulkAckTimeoutMs       1000    // Poll to ACK, chunk airtime included
+#define kBulkMaxPolls           8       // Unanswered polls before giving up
+
+static_assert(sizeof(FlightSample) == kBulkSampleLen, "bulk chunk sample size") ;
+
+//----------------------------------------------
+// Sender State
+//----------------------------------------------
+typedef struct
+{
+  bool pActive ;
+  uint8_t pSlot ;
+  uint8_t pSession ;
+  uint16_t pSampleCount ;
+  uint16_t pChunkCount ;
+  uint16_t pBase ;                // First chunk not acknowledged
+  uint16_t pNext ;                // First chunk never sent
+  uint32_t pMissing ;             // Chunks to resend: bit n = pBase + n
+  uint8_t pBurstLeft ;            // Chunks until the next poll
+  bool pAwaitingAck ;
+  uint16_t pPolledChunk ;         // Repeated if the poll goes unanswered
+  uint8_t pPolledRun ;            // Chunks in the polled packet
+  uint32_t pPollMs ;
+  uint8_t pPolls ;                // Unanswered polls in a row
+  uint8_t pRate ;                 // Data rate for the transfer
+
+  // Statistics
+  uint32_t pChunksSent ;
+  uint32_t pPacketsSent ;
+  uint32_t pRetransmits ;         // Chunks sent again
+} FlashBulkState ;
+
+//----------------------------------------------
+// Function: FlashBulk_Start
+// Purpose: Begin streaming a stored flight
+// Parameters:
+//   outState - Sender state (any earlier transfer
+//     is dropped)
+//   inSlot - Flight slot
+//   inSession - Session number from the request
+//   inSampleCount - Samples in the flight
+//   inRate - Data rate for the transfer
+// Returns: false if the flight is empty or too
+//   long for 16-bit chunk numbers
+//----------------------------------------------
+bool FlashBulk_Start(
+  FlashBulkState * outState,
+  uint8_t inSlot,
+  uint8_t inSession,
+  uint32_t inSampleCount,
+  uint8_t inRate) ;
+
+//----------------------------------------------
+// Function: FlashBulk_ProcessAck
+// Purpose: Apply a kCmdFlashBulkAck from the
+//   gateway
+// Parameters:
+//   ioState - Sender state
+//   inParams - Command parameters (from byte 4)
+//   inLen - Parameter length
+// Returns: true if the ACK was for this transfer
+// Notes: Ends the transfer once every chunk is
+//   acknowledged. An ACK that arrives while no
+//   poll is outstanding is ignored, as it would
+//   predate chunks still on air.
+//----------------------------------------------
+bool FlashBulk_ProcessAck(
+  FlashBulkState * ioState,
+  const uint8_t * inParams,
+  uint8_t inLen) ;
+
+//----------------------------------------------
+// Function: FlashBulk_NextPacket
+// Purpose: Build the packet to send now: lost
+//   chunks first, then new ones, read from flash
+// Parameters:
+//   ioState - Sender state
+//   inRocketId - This rocket's ID
+//   inNowMs - Current time (ms since boot)
+//   outPacket - Output buffer
+//   inMaxLen - Buffer size (kBulkChunkMaxLen)
+// Returns: Packet length, 0 while waiting for an
+//   ACK or once the transfer has ended (a flash
+//   read error ends it)
+// Notes: Call only when the radio TX queue is
+//   empty, so the ACK timeout runs from about
+//   the start of the poll's airtime
+//----------------------------------------------
+uint8_t FlashBulk_NextPacket(
+  FlashBulkState * ioState,
+  uint8_t inRocketId,
+  uint32_t inNowMs,
+  uint8_t * outPacket,
+  uint8_t inMaxLen) ;
@@ -6,6 +6,20 @@
 // Created: 2026-01-10
 // Copyright: (c) 2025-2026 by Mark Gavin
 // License: Proprietary - All Rights Reserved
+// Modified: 2026-02-10 (compact telemetry frame)
+// Modified: 2026-02-11 (batched high-rate telemetry)
+// Modified: 2026-02-13 (bulk flash download)
+// Modified: 2026-02-14 (adaptive data rate)
+// Modified: 2026-02-14 (aggregated ACK summary)
+// Modified: 2026-02-14 (telemetry FEC parity)
+// Modified: 2026-02-15 (multi-channel frequency plan)
+// Modified: 2026-02-15 (receive window after telemetry)
+// Modified: 2026-02-15 (flight event trailer and ACKs)
+// Modified: 2026-02-15 (command request IDs and replies)
+// Modified: 2026-02-15 (telemetry profiles and recovery beacon)
+// Modified: 2026-02-15 (link benchmark)
+// Modified: 2026-02-15 (shared protocol header)
+// Modified: 2026-02-16 (wire formats moved to lora_protocol.h)
 //----------------------------------------------
 
 #pragma once
@@ -13,6 +27,7 @@
 #include <stdint.h>
 #include <stdbool.h>
 #include "imu.h"
+#include "lora_protocol.h"
 
 //----------------------------------------------
 // Flight States
@@ -77,101 +92,39 @@ typedef struct
 } FlightResults ;
 
 //----------------------------------------------
-// LoRa Telemetry Packet (binary, 55 bytes)
-// Sent at 10 Hz during flight
+// LoRa Packet Layout
+// Frame header, packet types, command IDs, flags
+// and LoRaTelemetryPacket live in lora_protocol.h
+// (firmware_common), shared with the gateway,
+// with the compact and batch frames, telemetry
+// profiles, recovery beacon, ACK summary,
+// receive window, command replies and the
+// flight event trailer
 //----------------------------------------------
-typedef struct __attribute__((packed))
+
+// Frames between slow sections in flight
+#define kCompactSlowInterval    10
+
+// High-rate sample ring for batch frames
+#define kBatchRingSize          32    // 320 ms at 100 Hz
+#define kBatchSnapshotInterval  5     // Every 5th frame is a snapshot
+
+// Longest gap between receive windows
+#define kRxWindowMaxGapMs       1000
+
+// Requests remembered, to answer a repeat again
+// without carrying it out twice
+#define kRequestHistory         4
+#define kRequestRepeatMs        15000
+
+// One high-rate sample, in frame units
+typedef struct
 {
-  // Header (5 bytes)
-  uint8_t pMagic ;                // 0xAF (Avionics Flight)
-  uint8_t pPacketType ;           // 0x01 = telemetry
-  uint8_t pRocketId ;             // Rocket ID (0-15 for multi-rocket support)
-  uint16_t pSequence ;            // Packet sequence number
-
-  // Time (4 bytes)
-  uint32_t pTimeMs ;              // Mission time (ms)
-
-  // Barometric data (12 bytes)
-  int32_t pAltitudeCm ;           // Barometric altitude in centimeters
-  int16_t pVelocityCmps ;         // Vertical velocity in cm/s
-  uint32_t pPressurePa ;          // Pressure (Pa)
-  int16_t pTemperatureC10 ;       // Temperature * 10 (0.1C resolution)
-
-  // GPS data (13 bytes)
-  int32_t pGpsLatitude ;          // Latitude in microdegrees (deg * 1e6)
-  int32_t pGpsLongitude ;         // Longitude in microdegrees (deg * 1e6)
-  int16_t pGpsSpeedCmps ;         // GPS ground speed in cm/s
-  uint16_t pGpsHeadingDeg10 ;     // Heading * 10 (0-3600 = 0-360.0 deg)
-  uint8_t pGpsSatellites ;        // Number of satellites in use
-
-  // Accelerometer (6 bytes) - values in milli-g (mg)
-  int16_t pAccelX ;               // Accelerometer X
-  int16_t pAccelY ;               // Accelerometer Y
-  int16_t pAccelZ ;               // Accelerometer Z
-
-  // Gyroscope (6 bytes) - values in 0.1 degrees/second
-  int16_t pGyroX ;                // Gyroscope X
-  int16_t pGyroY ;                // Gyroscope Y
-  int16_t pGyroZ ;                // Gyroscope Z
-
-  // Magnetometer (6 bytes) - values in milligauss
-  int16_t pMagX ;                 // Magnetometer X
-  int16_t pMagY ;                 // Magnetometer Y
-  int16_t pMagZ ;                 // Magnetometer Z
-
-  // Status (3 bytes)
-  uint8_t pState ;                // Flight state enum
-  uint8_t pFlags ;                // Status flags
-  uint8_t pCrc ;                  // CRC-8
-} LoRaTelemetryPacket ;
-
-// Telemetry magic byte
-#define kLoRaMagic              0xAF
-
-// Packet types
-#define kLoRaPacketTelemetry    0x01
-#define kLoRaPacketStatus       0x02
-#define kLoRaPacketCommand      0x03
-#define kLoRaPacketAck          0x04
-#define kLoRaPacketData         0x05
-#define kLoRaPacketStorageList  0x06  // Storage list response
-#define kLoRaPacketStorageData  0x07  // Storage data chunk
-#define kLoRaPacketInfo         0x08  // Device info response
-#define kLoRaPacketBaroCompare  0x09  // Baro sensor comparison (debug)
-
-// Command IDs (sent in kLoRaPacketCommand)
-#define kCmdArm             0x01
-#define kCmdDisarm          0x02
-#define kCmdStatus          0x03
-#define kCmdReset           0x04
-#define kCmdDownload        0x05
-#define kCmdPing            0x06
-#define kCmdInfo            0x07  // Request device info
-
-// Mode commands
-#define kCmdOrientationMode 0x08  // Enable/disable high-rate orientation testing
-#define kCmdSetRocketName   0x09  // Set rocket name (followed by null-terminated string)
-
-// Debug commands
-#define kCmdBaroCompare     0x0A  // Start/stop baro comparison stream
-
-// Storage commands
-#define kCmdSdList          0x10
-#define kCmdSdRead          0x11
-#define kCmdSdDelete        0x12
-#define kCmdFlashList       0x20
-#define kCmdFlashRead       0x21
-#define kCmdFlashDelete     0x22
-
-// Flags byte bit definitions
-#define kFlagPyro1Continuity    0x01
-#define kFlagPyro2Continuity    0x02
-#define kFlagSdLogging          0x04
-#define kFlagLowBattery         0x08
-#define kFlagGpsFix             0x10  // GPS has valid fix
-#define kFlagSensorOk           0x20
-#define kFlagLoRaLink           0x40  // LoRa link active (received ack recently)
-#define kFlagOrientationMode    0x80  // Orientation testing mode active
+  uint32_t pTimeMs ;              // System time
+  int32_t pAltitudeDm ;           // Altitude, dm
+  int16_t pVelocityDms ;          // Vertical velocity, dm/s
+  int16_t pAccelDms2 ;            // Vertical accel less gravity, 0.1 m/s^2
+} BatchSample ;
 
 //----------------------------------------------
 // Flight Controller State
@@ -204,6 +157,22 @@ typedef struct
   // LoRa telemetry
   uint16_t pTelemetrySequence ;   // Packet sequence counter
   uint32_t pLastTelemetryTimeMs ; // Last telemetry send time
+  uint8_t pTelemetryFormat ;      // kTelemetryFormat*
+  uint16_t pProfileIntervalMs[kTelemetryProfileCount] ;
+
+  // Compact frame GPS origin
+  bool pGpsOriginValid ;          // Origin set from a fix
+  bool pGpsOriginLatched ;        // Re-latched at arming
+  uint8_t pGpsOriginEpoch ;       // Bumped on every move (2 bits sent)
+  int32_t pGpsOriginLat ;         // Microdegrees
+  int32_t pGpsOriginLon ;         // Microdegrees
+
+  // Batched telemetry (high-rate sample ring)
+  bool pTelemetryBatch ;          // Batch frames enabled in flight
+  float pVerticalAccelMps2 ;      // Latest gravity-removed accel
+  BatchSample pBatchRing[kBatchRingSize] ;
+  uint8_t pBatchHead ;            // Next slot to write
+  uint8_t pBatchPending ;         // Samples not yet sent
 
   // Apogee detection
   float pApogeeAltitudeM ;        // Recorded apogee altitude
@@ -344,6 +313,131 @@ uint8_t FlightControl_BuildTelemetryPacket(
   uint8_t inRocketId,
   LoRaTelemetryPacket * outPacket) ;
 
+//----------------------------------------------
+// Function: FlightControl_BuildCompactTelemetryPacket
+// Purpose: Build a bit-packed compact telemetry frame
+// Parameters:
+//   ioController - Controller (GPS origin state)
+//   inImuData - IMU data (can be NULL)
+//   inRocketId - Rocket ID (0-15)
+//   outPacket - Buffer of kCompactTelemetryMaxLen bytes
+// Returns: Frame size in bytes
+//----------------------------------------------
+uint8_t FlightControl_BuildCompactTelemetryPacket(
+  FlightController * ioController,
+  const ImuData * inImuData,
+  uint8_t inRocketId,
+  uint8_t * outPacket) ;
+
+//----------------------------------------------
+// Function: FlightControl_SetTelemetryFormat
+// Purpose: Select the LoRa telemetry frame format
+// Parameters:
+//   ioController - Controller
+//   inFormat - kTelemetryFormatFull or
+//     kTelemetryFormatCompact
+// Returns: false if the format is unknown
+//----------------------------------------------
+bool FlightControl_SetTelemetryFormat(
+  FlightController * ioController,
+  uint8_t inFormat) ;
+
+//----------------------------------------------
+// Function: FlightControl_BuildBatchTelemetryPacket
+// Purpose: Build a batch frame from the unsent
+//   high-rate samples, oldest first
+// Parameters:
+//   ioController - Controller (sample ring)
+//   inRocketId - Rocket ID (0-15)
+//   inMaxLen - Largest frame to build (at most
+//     kBatchFrameMaxLen)
+//   outPacket - Buffer of inMaxLen bytes
+// Returns: Frame size in bytes, 0 if no samples
+//   or inMaxLen is below one sample
+// Notes: Samples that do not fit stay queued for
+//   the next frame
+//----------------------------------------------
+uint8_t FlightControl_BuildBatchTelemetryPacket(
+  FlightController * ioController,
+  uint8_t inRocketId,
+  uint8_t inMaxLen,
+  uint8_t * outPacket) ;
+
+//----------------------------------------------
+// Function: FlightControl_ShouldSendBatch
+// Purpose: Check whether the next telemetry frame
+//   should be a batch frame rather than a snapshot
+// Parameters:
+//   inController - Controller
+// Returns: true in flight with batching enabled,
+//   except on snapshot frames
+//----------------------------------------------
+bool FlightControl_ShouldSendBatch(const FlightController * inController) ;
+
+//----------------------------------------------
+// Function: FlightControl_SetTelemetryBatch
+// Purpose: Enable/disable batched telemetry
+// Parameters:
+//   ioController - Controller
+//   inEnabled - true to send batch frames in flight
+//----------------------------------------------
+void FlightControl_SetTelemetryBatch(
+  FlightController * ioController,
+  bool inEnabled) ;
+
+//----------------------------------------------
+// Function: FlightControl_GetTelemetryIntervalMs
+// Purpose: Telemetry period for the current state
+// Parameters:
+//   inController - Controller
+// Returns: Milliseconds between frames
+//----------------------------------------------
+uint32_t FlightControl_GetTelemetryIntervalMs(const FlightController * inController) ;
+
+//----------------------------------------------
+// Function: FlightControl_GetTelemetryProfile
+// Purpose: Telemetry profile of the current state
+// Parameters:
+//   inController - Controller
+// Returns: kTelemetryProfile*
+//----------------------------------------------
+uint8_t FlightControl_GetTelemetryProfile(const FlightController * inController) ;
+
+//----------------------------------------------
+// Function: FlightControl_SetTelemetryProfile
+// Purpose: Set the telemetry interval of one
+//   profile, or restore the defaults
+// Parameters:
+//   ioController - Controller
+//   inProfile - kTelemetryProfile*, or
+//     kTelemetryProfileDefaults
+//   inIntervalMs - Interval (ignored for
+//     kTelemetryProfileDefaults)
+// Returns: false if the profile is unknown or
+//   the interval is outside kTelemetryProfileMinMs
+//   to kTelemetryProfileMaxMs
+//----------------------------------------------
+bool FlightControl_SetTelemetryProfile(
+  FlightController * ioController,
+  uint8_t inProfile,
+  uint16_t inIntervalMs) ;
+
+//----------------------------------------------
+// Function: FlightControl_BuildRecoveryPacket
+// Purpose: Build a GPS recovery beacon
+// Parameters:
+//   inController - Controller
+//   inRocketId - Rocket ID (0-15)
+//   inCurrentTimeMs - Current time
+//   outPacket - Buffer of kRecoveryPacketLen bytes
+// Returns: Packet size in bytes
+//----------------------------------------------
+uint8_t FlightControl_BuildRecoveryPacket(
+  const FlightController * inController,
+  uint8_t inRocketId,
+  uint32_t inCurrentTimeMs,
+  uint8_t * outPacket) ;
+
 //----------------------------------------------
 // Function: FlightControl_ShouldSendTelemetry
 // Purpose: Check if telemetry should be sent
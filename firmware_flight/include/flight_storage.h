@@ -51,9 +51,19 @@
 // Magic Numbers and Version
 //----------------------------------------------
 #define kFlightMagic            0x54484746  // "FGHT" (Flight)
-#define kFlightVersion          1
+#define kFlightVersion          2           // 2 = CRC32 header and sample blocks
+#define kFlightVersionLegacy    1           // Byte-sum header, no sample check
 #define kFlightIndexMagic       0x58444E49  // "INDX"
 
+//----------------------------------------------
+// Sample Block Integrity
+//----------------------------------------------
+// Sample data is protected by one CRC32 per 4KB
+// block. The block CRC table is stored in the
+// header page, directly after the FlightHeader.
+#define kFlightBlockSize        4096        // Bytes of sample data per CRC
+#define kMaxFlightBlocks        16          // Covers a full 64KB slot
+
 //----------------------------------------------
 // Flight Sample Structure (52 bytes)
 // Logged at 100 Hz during flight
@@ -121,11 +131,27 @@ typedef struct __attribute__((packed))
   int32_t pLaunchLatitude ;       // Launch latitude (microdegrees)
   int32_t pLaunchLongitude ;      // Launch longitude (microdegrees)
 
+  // Sample integrity (version 2)
+  uint32_t pBlockTableCrc ;       // CRC32 of the block CRC table
+  uint16_t pBlockCount ;          // Number of block CRCs in table
+
   // Padding and checksum
-  uint8_t pReserved[20] ;         // Reserved for future use
-  uint32_t pChecksum ;            // Header checksum
+  uint8_t pReserved[14] ;         // Reserved for future use
+  uint32_t pChecksum ;            // CRC32 of preceding bytes (v1: byte sum)
 } FlightHeader ;                  // 80 bytes
 
+//----------------------------------------------
+// Slot Verification Status
+//----------------------------------------------
+typedef enum
+{
+  kFlightSlotEmpty = 0,           // No flight stored
+  kFlightSlotUnverified,          // Not checked (boot budget exceeded)
+  kFlightSlotValid,               // Header and all blocks verified
+  kFlightSlotLegacy,              // Version 1 header, samples unprotected
+  kFlightSlotCorrupt              // Header or block CRC mismatch
+} FlightSlotStatus ;
+
 //----------------------------------------------
 // Function: FlightStorage_Init
 // Purpose: Initialize flight storage system
@@ -133,6 +159,33 @@ typedef struct __attribute__((packed))
 //----------------------------------------------
 bool FlightStorage_Init(void) ;
 
+//----------------------------------------------
+// Function: FlightStorage_VerifyFlights
+// Purpose: Check header and sample block CRCs of
+//   all stored flights
+// Parameters:
+//   inBudgetUs - time budget; remaining slots are
+//     left unverified once it is exceeded
+// Returns: Number of corrupt flights found
+//----------------------------------------------
+uint8_t FlightStorage_VerifyFlights(uint32_t inBudgetUs) ;
+
+//----------------------------------------------
+// Function: FlightStorage_GetVerifyTimeUs
+// Purpose: Get duration of the last verification
+// Returns: Elapsed time in microseconds
+//----------------------------------------------
+uint32_t FlightStorage_GetVerifyTimeUs(void) ;
+
+//----------------------------------------------
+// Function: FlightStorage_GetSlotStatus
+// Purpose: Get verification status of a slot
+// Parameters:
+//   inSlotIndex - Slot index
+// Returns: Slot status
+//----------------------------------------------
+FlightSlotStatus FlightStorage_GetSlotStatus(uint8_t inSlotIndex) ;
+
 //----------------------------------------------
 // Function: FlightStorage_GetFlightCount
 // Purpose: Get number of stored flights
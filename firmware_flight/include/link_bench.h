@@ -0,0 +1,172 @@
+//----------------------------------------------
+// Module: link_bench.h
+// Description: LoRa link benchmark (flight side:
+//   sender)
+// Author: Mark Gavin
+// Created: 2026-02-15
+// Copyright: (c) 2025-2026 by Mark Gavin
+// License: Proprietary - All Rights Reserved
+//
+// One kCmdBenchmark from the gateway, on the
+// ground, starts a run through a matrix of radio
+// settings. Every data rate, coding rate, TX
+// power and frame length picked in the command
+// makes a point, in that nesting order (data
+// rate outermost, table order; length innermost,
+// command order):
+//
+//   4      session
+//   5      data rates: bit n = lora_radio.h table
+//          index n
+//   6      coding rates: bit 0 = 4/5 .. bit 3 = 4/8
+//   7      frames per point (1 to kBenchMaxFrames)
+//   8-10   TX powers, dBm (0: unused; all 0: the
+//          power in use)
+//   11-13  frame lengths, bytes (0: unused)
+//
+// Both ends work out the same schedule from the
+// command, with no handshake between points. It
+// runs from the command's RxDone here and its
+// TxDone at the gateway:
+//
+//   kBenchStartMs     base settings: the answer
+//                     goes out
+//   point 0 .. n-1    kBenchGuardMs to switch,
+//                     the frames back-to-back
+//                     (each kBenchFrameGapUs apart
+//                     at most), kBenchGuardMs
+//
+// then both return to their own settings. The
+// rocket sends nothing else meanwhile and the
+// gateway holds its beacons, ACKs and commands.
+// A frame that would run into the closing guard
+// is not sent.
+//
+// Frame (kLoRaPacketBenchmark, flight to gateway):
+//   0      magic (kLoRaMagic)
+//   1      type (kLoRaPacketBenchmark)
+//   2      rocket ID
+//   3      session
+//   4      point (kBenchPointAnswer: the answer)
+//   5      frame index (answer: 1 accepted, 0
+//          refused)
+//   6..    frame index repeated (answer: number of
+//          points, one byte)
+//   last   CRC-8 of the bytes before it
+//----------------------------------------------
+
+#pragma once
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "lora_protocol.h"
+#include "lora_radio.h"
+
+//----------------------------------------------
+// Constants
+// Frame layout and run limits: lora_protocol.h
+//----------------------------------------------
+// LinkBench_GetPoint, outside the points
+#define kBenchPointStart        0xFF
+#define kBenchPointDone         0xFE
+
+//----------------------------------------------
+// Matrix Point
+//----------------------------------------------
+typedef struct
+{
+  uint8_t pRate ;                 // Data rate index
+  uint8_t pCodingRate ;           // LoRa_CodingRate
+  int8_t pPowerDbm ;              // 0: the power in use
+  uint8_t pLen ;
+  uint32_t pAirUs ;               // One frame
+  uint32_t pStartMs ;             // From the end of kBenchStartMs
+  uint32_t pDurationMs ;
+} BenchPoint ;
+
+//----------------------------------------------
+// Sender State
+//----------------------------------------------
+typedef struct
+{
+  bool pActive ;
+  bool pAnswered ;                // Answer sent
+  uint8_t pSession ;
+  uint8_t pFrames ;               // Per point
+  uint8_t pPointCount ;
+  uint8_t pApplied ;              // Point the radio is set for
+  uint8_t pPoint ;                // Point pNextFrame counts for
+  uint8_t pNextFrame ;
+  uint32_t pAnchorUs ;            // Command RxDone
+  BenchPoint pPoints[kBenchMaxPoints] ;
+
+  // Statistics
+  uint32_t pFramesSent ;
+} LinkBench ;
+
+//----------------------------------------------
+// Function: LinkBench_Start
+// Purpose: Lay out the schedule for a
+//   kCmdBenchmark
+// Parameters:
+//   outBench - Sender state
+//   inParams - Command bytes from 4
+//   inLen - Their length
+//   inRxUs - RxDone time of the command
+// Returns: false if the plan is invalid, has more
+//   than kBenchMaxPoints points or runs longer
+//   than kBenchMaxMs (outBench is left inactive)
+//----------------------------------------------
+bool LinkBench_Start(
+  LinkBench * outBench,
+  const uint8_t * inParams,
+  uint8_t inLen,
+  uint32_t inRxUs) ;
+
+//----------------------------------------------
+// Function: LinkBench_GetPoint
+// Purpose: Point the schedule is at
+// Parameters:
+//   inBench - Sender state
+//   inNowUs - Current time (time_us_32)
+// Returns: Point index, kBenchPointStart before
+//   the first or kBenchPointDone after the last
+//----------------------------------------------
+uint8_t LinkBench_GetPoint(const LinkBench * inBench, uint32_t inNowUs) ;
+
+//----------------------------------------------
+// Function: LinkBench_NextFrame
+// Purpose: Build the point's next frame when one
+//   is due
+// Parameters:
+//   ioBench - Sender state
+//   inPoint - Current point (LinkBench_GetPoint)
+//   inNowUs - Current time (time_us_32)
+//   inRocketId - This rocket
+//   outFrame - Output (kLoRaMaxPacketLen)
+// Returns: Frame length, 0 if none is due
+//----------------------------------------------
+uint8_t LinkBench_NextFrame(
+  LinkBench * ioBench,
+  uint8_t inPoint,
+  uint32_t inNowUs,
+  uint8_t inRocketId,
+  uint8_t * outFrame) ;
+
+//----------------------------------------------
+// Function: LinkBench_BuildAnswer
+// Purpose: Build the answer to a kCmdBenchmark
+// Parameters:
+//   inRocketId - This rocket
+//   inSession - Session from the command
+//   inPointCount - Points in the schedule
+//   inAccepted - false if refused
+//   outFrame - Output (kBenchAnswerLen)
+// Returns: Frame length
+//----------------------------------------------
+uint8_t LinkBench_BuildAnswer(
+  uint8_t inRocketId,
+  uint8_t inSession,
+  uint8_t inPointCount,
+  bool inAccepted,
+  uint8_t * outFrame) ;
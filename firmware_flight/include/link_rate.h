@@ -0,0 +1,136 @@
+//----------------------------------------------
+// Module: link_rate.h
+// Description: Adaptive LoRa data rate (flight
+//   side of the gateway-led handshake)
+// Author: Mark Gavin
+// Created: 2026-02-14
+// Copyright: (c) 2025-2026 by Mark Gavin
+// License: Proprietary - All Rights Reserved
+// Modified: 2026-02-14 (ACK summary interval)
+//
+// The gateway picks one data rate (an index into
+// the lora_radio.h table) for every rocket it
+// serves, since it can only listen at one. It
+// changes rate in two steps, both sent as
+// kCmdDataRate at the rate in use:
+//
+//   4      phase (kRatePropose, kRateCommit)
+//   5      token (new for each change)
+//   6      data rate index
+//
+// A proposal is answered with a confirm; the
+// gateway commits only once every active rocket
+// has confirmed, then switches after the commit
+// has gone out. A rocket switches on the commit
+// alone, so the gateway can also repeat it at
+// the base rate to pull in a rocket that fell
+// back or has just booted.
+//
+// Confirm (kLoRaPacketRateAck, flight to gateway):
+//   0      magic (kLoRaMagic)
+//   1      type (kLoRaPacketRateAck)
+//   2      rocket ID
+//   3      token
+//   4      data rate proposed
+//   5      1 accepted, 0 refused
+//   6      SNR of the proposal here, dB (int8)
+//   7      data rate in use
+//
+// Fallback: away from the base rate, each frame
+// sent while nothing is heard from the gateway
+// is a miss, once the gateway's ACK interval has
+// passed without a word. kLinkRateMaxMisses in
+// a row return the radio to kLoRaDataRateBase,
+// where the gateway also ends up once it misses
+// this rocket's frames. Frames sent in TDMA
+// slots are not counted: a lost beacon drops
+// sync first.
+//----------------------------------------------
+
+#pragma once
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "lora_protocol.h"
+
+//----------------------------------------------
+// Constants
+//----------------------------------------------
+#define kLinkRateMaxMisses      8       // Unanswered frames before falling back
+
+//----------------------------------------------
+// Rate State
+//----------------------------------------------
+typedef struct
+{
+  uint8_t pRate ;                 // Data rate the radio should be at
+  uint8_t pMisses ;               // Frames since the gateway was last heard
+  uint16_t pAckIntervalMs ;       // Gateway's ACK summary interval (0: per frame)
+  uint32_t pLastHeardMs ;
+
+  // Statistics
+  uint32_t pSwitches ;            // Commits followed
+  uint32_t pFallbacks ;           // Returns to the base rate on misses
+} LinkRateState ;
+
+//----------------------------------------------
+// Function: LinkRate_Init
+// Purpose: Start at the base rate
+// Parameters:
+//   outState - State to initialize
+//----------------------------------------------
+void LinkRate_Init(LinkRateState * outState) ;
+
+//----------------------------------------------
+// Function: LinkRate_ProcessCommand
+// Purpose: Apply a kCmdDataRate from the gateway
+// Parameters:
+//   ioState - Rate state
+//   inParams - Command parameters (from byte 4)
+//   inLen - Parameter length
+//   inSnr - SNR the command was received at
+//   inRocketId - This rocket's ID
+//   outConfirm - Confirm packet, for a proposal
+//   inMaxLen - Buffer size (kRateConfirmLen)
+// Returns: Confirm length to send, 0 if none
+//----------------------------------------------
+uint8_t LinkRate_ProcessCommand(
+  LinkRateState * ioState,
+  const uint8_t * inParams,
+  uint8_t inLen,
+  int8_t inSnr,
+  uint8_t inRocketId,
+  uint8_t * outConfirm,
+  uint8_t inMaxLen) ;
+
+//----------------------------------------------
+// Function: LinkRate_GatewayHeard
+// Purpose: Clear the miss count on any packet
+//   from the gateway
+// Parameters:
+//   ioState - Rate state
+//   inNowMs - Current time (ms since boot)
+//----------------------------------------------
+void LinkRate_GatewayHeard(LinkRateState * ioState, uint32_t inNowMs) ;
+
+//----------------------------------------------
+// Function: LinkRate_SetAckInterval
+// Purpose: Note how often the gateway ACKs, from
+//   its last ACK summary
+// Parameters:
+//   ioState - Rate state
+//   inIntervalMs - Summary interval
+//----------------------------------------------
+void LinkRate_SetAckInterval(LinkRateState * ioState, uint16_t inIntervalMs) ;
+
+//----------------------------------------------
+// Function: LinkRate_FrameSent
+// Purpose: Count a frame that expects an answer
+//   and fall back after too many misses
+// Parameters:
+//   ioState - Rate state
+//   inNowMs - Current time (ms since boot)
+// Returns: true if this frame made the rate fall
+//   back
+//----------------------------------------------
+bool LinkRate_FrameSent(LinkRateState * ioState, uint32_t inNowMs) ;
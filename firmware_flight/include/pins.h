@@ -50,7 +50,10 @@
 #define kPinSpiMosi         15  // GP15 - SPI1 TX/MOSI
 #define kPinSpiMiso         8   // GP8 - SPI1 RX/MISO
 #define kSpiPort            spi1
-#define kSpiLoRaBaudrate    1000000   // 1 MHz for LoRa
+// 8 MHz leaves margin under the RFM95 limit with the
+// SD card also on SPI1. LoRa_Init checks it with a
+// FIFO loopback at boot.
+#define kSpiLoRaBaudrate    8000000   // 8 MHz for LoRa (RFM95 max 10 MHz)
 
 //----------------------------------------------
 // LoRa Radio (RFM95 built into Feather RP2040 RFM95)
@@ -60,6 +63,18 @@
 #define kPinLoRaDio0        21  // GP21 - RFM95 DIO0 (RX Done interrupt)
 #define kPinLoRaDio1        22  // GP22 - RFM95 DIO1 (optional)
 
+//----------------------------------------------
+// SD Card (Adalogger FeatherWing, SD_LOGGER builds)
+// Shares SPI1 with the LoRa radio. The card runs
+// at kSpiSdBaudrate only while selected; the bus
+// is returned to kSpiLoRaBaudrate on deselect.
+// CS is D10, which the eInk Breakout Friend also
+// uses, so SD_LOGGER and DISPLAY_EINK are exclusive.
+//----------------------------------------------
+#define kPinSdCs            10  // GP10 - SD card Chip Select (D10)
+#define kSpiSdBaudrate      25000000  // 25 MHz for SD data transfer
+#define kSpiSdInitBaudrate  400000    // 400 kHz during card identification
+
 //----------------------------------------------
 // OLED FeatherWing Buttons
 // Active LOW (internal pull-up, grounded when pressed)
@@ -115,6 +130,7 @@
 #define kLoRaPreambleLen    8           // Preamble length
 #define kLoRaTxPower        20          // 20 dBm (100 mW)
 #define kLoRaSyncWord       0x14        // Private sync word
+#define kLoRaListenBeforeTalk 0         // Check for a clear channel before sending
 
 //----------------------------------------------
 // Telemetry Timing
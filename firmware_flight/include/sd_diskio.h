@@ -0,0 +1,77 @@
+//----------------------------------------------
+// Module: sd_diskio.h
+// Description: SD card driver extensions beyond
+//   the FatFs disk_* interface (asynchronous
+//   multi-block write)
+// Author: Mark Gavin
+// Created: 2026-02-06
+// Copyright: (c) 2025-2026 by Mark Gavin
+// License: Proprietary - All Rights Reserved
+//
+// Data phases of CMD17/18/24/25 move through two
+// DMA channels (SPI TX and RX) while the DMA
+// sniffer computes the block CRC16. Command,
+// token and CRC bytes stay on the CPU.
+//
+// An asynchronous write only holds the SPI bus
+// while a block is actually being clocked out.
+// The card is deselected while it is busy
+// programming, so the shared bus (LoRa) is free
+// between SdDisk_WritePoll calls.
+//----------------------------------------------
+
+#pragma once
+
+#include <stdint.h>
+#include <stdbool.h>
+
+//----------------------------------------------
+// Async Write State
+//----------------------------------------------
+typedef enum
+{
+  kSdDiskIdle = 0 ,       // No write in progress
+  kSdDiskBusy ,           // Call SdDisk_WritePoll again
+  kSdDiskDone ,           // Last write finished successfully
+  kSdDiskError            // Last write failed or timed out
+} SdDiskState ;
+
+//----------------------------------------------
+// Function: SdDisk_WriteStart
+// Purpose: Begin a multi-block write (CMD25)
+// Parameters:
+//   inBuff - Data, inCount * 512 bytes; must stay
+//     unchanged until the write completes
+//   inSector - First sector (LBA)
+//   inCount - Number of sectors
+// Returns: true if the card accepted the command
+// Notes: The card must already be initialized by
+//   FatFs (disk_initialize)
+//----------------------------------------------
+bool SdDisk_WriteStart(const uint8_t * inBuff, uint32_t inSector, uint32_t inCount) ;
+
+//----------------------------------------------
+// Function: SdDisk_WritePoll
+// Purpose: Advance an asynchronous write
+// Returns: kSdDiskBusy until finished, then
+//   kSdDiskDone or kSdDiskError (once)
+// Notes: Sends every block the card is ready for,
+//   then returns without waiting on card busy
+//----------------------------------------------
+SdDiskState SdDisk_WritePoll(void) ;
+
+//----------------------------------------------
+// Function: SdDisk_IsWriting
+// Purpose: Check for an asynchronous write
+// Returns: true until SdDisk_WritePoll reports
+//   completion
+//----------------------------------------------
+bool SdDisk_IsWriting(void) ;
+
+//----------------------------------------------
+// Function: SdDisk_IsDmaEnabled
+// Purpose: Check whether data phases use DMA
+// Returns: false if no DMA channels were free
+//   and the byte-at-a-time fallback is in use
+//----------------------------------------------
+bool SdDisk_IsDmaEnabled(void) ;
@@ -3,12 +3,24 @@
 // Description: SD card data logging
 // Author: Mark Gavin
 // Created: 2025-12-19
-// Copyright: (c) 2025 by Mark Gavin
+// Modified: 2026-02-06 (async direct writes)
+// Copyright: (c) 2025-2026 by Mark Gavin
 // License: Proprietary - All Rights Reserved
 //
 // Hardware:
 //   - Adafruit Adalogger FeatherWing
 //   - SPI interface with CS on GPIO10
+//
+// Flights are written as binary FLTnnnnn.BIN
+// files: one 512-byte header sector followed by
+// packed FlightSample records. The file is
+// preallocated as one contiguous extent when the
+// rocket is armed, so in-flight writes never touch
+// the FAT or directory. Samples are collected in a
+// double buffer and written as whole sectors,
+// straight to the extent through the async
+// driver (sd_diskio.h) while the card programs.
+// tools/sd_bin_to_csv.py converts logs to CSV.
 //----------------------------------------------
 
 #pragma once
@@ -16,17 +28,50 @@
 #include <stdint.h>
 #include <stdbool.h>
 
+#include "flight_storage.h"
+
 //----------------------------------------------
-// Flight Data Sample Structure
+// Log File Format
 //----------------------------------------------
-typedef struct
+#define kSdLogMagic             0x474C4453  // "SDLG" little-endian
+#define kSdLogVersion           1
+#define kSdSectorSize           512
+
+// Each half of the double buffer holds this many
+// sectors; a full half is written as one
+// multi-sector transfer.
+#define kSdBufferSectors        4
+#define kSdBufferSize           (kSdBufferSectors * kSdSectorSize)
+
+// Contiguous space reserved at arm time.
+// 100 Hz * 48 bytes = 4.8 KB/s, so 8 MB covers
+// about 29 minutes of recording.
+#define kSdPreallocBytes        (8UL * 1024UL * 1024UL)
+
+// Header sample count before the log is closed
+#define kSdSampleCountOpen      0xFFFFFFFF
+
+// SdLogger_Benchmark default transfer size
+#define kSdBenchmarkBytes       (1024UL * 1024UL)
+
+//----------------------------------------------
+// Log File Header (first sector of the file)
+//----------------------------------------------
+typedef struct __attribute__((packed))
 {
-  uint32_t timeMs ;        // Time since launch (ms)
-  float altitudeM ;        // Altitude AGL (meters)
-  float velocityMps ;      // Vertical velocity (m/s)
-  float pressurePa ;       // Raw pressure (Pascals)
-  float temperatureC ;     // Temperature (Celsius)
-} SdFlightSample ;
+  uint32_t pMagic ;               // kSdLogMagic
+  uint16_t pVersion ;             // kSdLogVersion
+  uint16_t pSampleSize ;          // sizeof(FlightSample)
+  uint32_t pFileNumber ;          // nnnnn in FLTnnnnn.BIN
+  uint32_t pSampleCount ;         // kSdSampleCountOpen until closed
+  uint32_t pDroppedSamples ;      // Samples lost to buffer overrun
+  uint32_t pSampleRateHz ;        // Nominal logging rate
+  float pMaxAltitudeM ;           // Peak altitude (meters)
+  float pMaxVelocityMps ;         // Peak velocity (m/s)
+  uint32_t pFlightTimeMs ;        // Total flight duration
+  uint32_t pMaxWriteUs ;          // Longest SdLogger_Service call
+  uint8_t pReserved[24] ;         // Pad to 64 bytes
+} SdLogHeader ;
 
 //----------------------------------------------
 // Function: SdLogger_Init
@@ -42,6 +87,13 @@ bool SdLogger_Init(void) ;
 //----------------------------------------------
 bool SdLogger_IsAvailable(void) ;
 
+//----------------------------------------------
+// Function: SdLogger_IsLogging
+// Purpose: Check if a flight log is open
+// Returns: true between StartFlight and EndFlight
+//----------------------------------------------
+bool SdLogger_IsLogging(void) ;
+
 //----------------------------------------------
 // Function: SdLogger_GetFreeSpace
 // Purpose: Get free space on SD card
@@ -51,25 +103,40 @@ uint32_t SdLogger_GetFreeSpace(void) ;
 
 //----------------------------------------------
 // Function: SdLogger_StartFlight
-// Purpose: Start a new flight log file
+// Purpose: Create and preallocate the next
+//   FLTnnnnn.BIN flight log
 // Parameters:
-//   inTimestamp - Unix timestamp for filename
+//   inSampleRateHz - Nominal logging rate, stored
+//     in the header for the converter
 // Returns: true if file opened successfully
+// Notes: Call at arm time; the allocation and
+//   directory update happen here, not in flight
 //----------------------------------------------
-bool SdLogger_StartFlight(uint32_t inTimestamp) ;
+bool SdLogger_StartFlight(uint32_t inSampleRateHz) ;
 
 //----------------------------------------------
 // Function: SdLogger_LogSample
-// Purpose: Log a single flight sample
+// Purpose: Queue a single flight sample
 // Parameters:
 //   inSample - Sample data to log
-// Returns: true if written successfully
+// Returns: true if buffered, false if dropped
+// Notes: Only copies into RAM; card I/O happens
+//   in SdLogger_Service
 //----------------------------------------------
-bool SdLogger_LogSample(const SdFlightSample * inSample) ;
+bool SdLogger_LogSample(const FlightSample * inSample) ;
+
+//----------------------------------------------
+// Function: SdLogger_Service
+// Purpose: Write a filled buffer half to the card
+// Returns: true if no write error has occurred
+// Notes: Call from the main loop. Writes at most
+//   one kSdBufferSize block per call.
+//----------------------------------------------
+bool SdLogger_Service(void) ;
 
 //----------------------------------------------
 // Function: SdLogger_EndFlight
-// Purpose: Finalize and close flight log file
+// Purpose: Flush, trim and close the flight log
 // Parameters:
 //   inMaxAltitudeM - Maximum altitude in meters
 //   inFlightTimeMs - Total flight time in ms
@@ -78,6 +145,36 @@ bool SdLogger_LogSample(const SdFlightSample * inSample) ;
 //----------------------------------------------
 bool SdLogger_EndFlight(float inMaxAltitudeM, uint32_t inFlightTimeMs, float inMaxVelocityMps) ;
 
+//----------------------------------------------
+// Function: SdLogger_AbortFlight
+// Purpose: Close and delete a log that never
+//   recorded a sample (e.g. disarmed on the pad)
+//----------------------------------------------
+void SdLogger_AbortFlight(void) ;
+
+//----------------------------------------------
+// Function: SdLogger_GetMaxWriteUs
+// Purpose: Get the longest SdLogger_Service call
+//   of the current (or last) flight
+// Returns: Worst-case main-loop stall in microseconds
+//----------------------------------------------
+uint32_t SdLogger_GetMaxWriteUs(void) ;
+
+//----------------------------------------------
+// Function: SdLogger_Benchmark
+// Purpose: Measure card throughput on target
+// Parameters:
+//   inBytes - Transfer size (e.g. kSdBenchmarkBytes)
+//   outWriteKBps - Write rate, async multi-block
+//     writes of kSdBufferSize like a flight
+//   outReadKBps - Read rate through FatFs (CMD18)
+// Returns: true if the test file was written and
+//   read back
+// Notes: Uses a temporary preallocated file in
+//   flights/, deleted afterwards. Not while logging.
+//----------------------------------------------
+bool SdLogger_Benchmark(uint32_t inBytes, uint32_t * outWriteKBps, uint32_t * outReadKBps) ;
+
 //----------------------------------------------
 // Function: SdLogger_ListFlights
 // Purpose: List all flight files on SD card
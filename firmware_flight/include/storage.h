@@ -1,7 +1,7 @@
 //----------------------------------------------
 // Module: storage.h
 // Description: Flash storage for calibration
-//   data persistence
+//   data and device settings persistence
 // Author: Mark Gavin
 // Created: 2025-11-29
 // Copyright: (c) 2025 by Mark Gavin
@@ -13,8 +13,28 @@
 #include <stdint.h>
 #include <stdbool.h>
 
+//----------------------------------------------
+// Settings Keys
+//----------------------------------------------
+// Settings are stored as records in an append-only
+// log; the newest record for a key wins. New
+// tunables get the next free key.
+#define kSettingKeyRocketId       0x01  // uint8_t (0-15)
+#define kSettingKeyRocketName     0x02  // char[], no terminator
+#define kSettingKeyCalibration    0x03  // int32_t offset, float scale
+#define kSettingKeyTelemetryFormat 0x04 // uint8_t (kTelemetryFormat*)
+#define kSettingKeyTelemetryBatch 0x05  // uint8_t (0 = off, 1 = on)
+#define kSettingKeyFecGroup       0x06  // uint8_t (0 = off, 2, 4 or 8)
+#define kSettingKeyChannelPlan    0x07  // uint8_t (0 = control channel, 1 = own channel)
+#define kSettingKeyTelemetryProfile 0x08 // uint16_t[kTelemetryProfileCount], ms
+
+#define kMaxSettingKeys           32    // Keys 0x00-0x1F
+#define kSettingMaxValueLen       32    // Max bytes per value
+
 //----------------------------------------------
 // Calibration Data Structure
+// Legacy single-sector format, imported into the
+// settings log on first boot
 //----------------------------------------------
 typedef struct
 {
@@ -22,14 +42,14 @@ typedef struct
   uint32_t pVersion ;       // Data format version
   int32_t pOffset ;         // Tare offset value
   float pScaleFactor ;      // Calibration scale factor
-  uint32_t pChecksum ;      // Data integrity check
+  uint32_t pChecksum ;      // CRC32 of preceding bytes
 } CalibrationData ;
 
 //----------------------------------------------
 // Magic number and version constants
 //----------------------------------------------
 #define kCalibrationMagic   0x43414C42  // "CALB"
-#define kCalibrationVersion 1
+#define kCalibrationVersion 2   // Bumped for CRC32 checksum
 
 //----------------------------------------------
 // Function: Storage_Init
@@ -38,6 +58,47 @@ typedef struct
 //----------------------------------------------
 bool Storage_Init(void) ;
 
+//----------------------------------------------
+// Function: Storage_WriteSetting
+// Purpose: Append a setting record to the log
+// Parameters:
+//   inKey - setting key (kSettingKey*)
+//   inValue - value bytes
+//   inLength - value length (0 deletes the key)
+// Returns: true if successful
+// Notes: Programs one flash page; a sector erase
+//   only happens when the log sector is full
+//----------------------------------------------
+bool Storage_WriteSetting(
+  uint8_t inKey ,
+  const void * inValue ,
+  uint8_t inLength) ;
+
+//----------------------------------------------
+// Function: Storage_ReadSetting
+// Purpose: Read the newest value for a key
+// Parameters:
+//   inKey - setting key (kSettingKey*)
+//   outValue - receives value bytes
+//   inMaxLength - size of outValue
+//   outLength - receives value length (may be NULL)
+// Returns: true if the key is present and fits
+//----------------------------------------------
+bool Storage_ReadSetting(
+  uint8_t inKey ,
+  void * outValue ,
+  uint8_t inMaxLength ,
+  uint8_t * outLength) ;
+
+//----------------------------------------------
+// Function: Storage_DeleteSetting
+// Purpose: Remove a key from the settings log
+// Parameters:
+//   inKey - setting key (kSettingKey*)
+// Returns: true if successful
+//----------------------------------------------
+bool Storage_DeleteSetting(uint8_t inKey) ;
+
 //----------------------------------------------
 // Function: Storage_SaveCalibration
 // Purpose: Save calibration data to flash
@@ -78,6 +139,8 @@ bool Storage_ClearCalibration(void) ;
 
 //----------------------------------------------
 // Device Settings Data Structure
+// Legacy single-sector format, imported into the
+// settings log on first boot
 //----------------------------------------------
 #define kRocketNameMaxLen  16  // Max rocket name length (including null)
 
@@ -88,14 +151,14 @@ typedef struct
   uint8_t pRocketId ;                    // Unique rocket ID (0-15)
   uint8_t pReserved[3] ;                 // Reserved for future use
   char pRocketName[kRocketNameMaxLen] ;  // Custom rocket name (null-terminated)
-  uint32_t pChecksum ;                   // Data integrity check
+  uint32_t pChecksum ;                   // CRC32 of preceding bytes
 } DeviceSettings ;
 
 //----------------------------------------------
 // Settings magic and version constants
 //----------------------------------------------
 #define kSettingsMagic   0x53455454  // "SETT"
-#define kSettingsVersion 2           // Bumped for rocket name support
+#define kSettingsVersion 3           // Bumped for CRC32 checksum (2 added rocket name)
 
 //----------------------------------------------
 // Function: Storage_SaveRocketId
@@ -0,0 +1,132 @@
+//----------------------------------------------
+// Module: tdma.h
+// Description: TDMA slot follower (gateway beacon
+//   and slot table)
+// Author: Mark Gavin
+// Created: 2026-02-12
+// Copyright: (c) 2025-2026 by Mark Gavin
+// License: Proprietary - All Rights Reserved
+//
+// The gateway opens every superframe with a
+// beacon. Times below run from the end of the
+// beacon (RxDone here, TxDone at the gateway):
+//
+//   beacon | downlink | slot 0 .. slot N-1 | contention | beacon
+//
+// The downlink window carries commands and ACKs
+// from the gateway. Data slot i belongs to the
+// rocket named in the slot table. A rocket that
+// is not in the table sends in the contention
+// slot (every other superframe on average); once
+// the gateway hears it, the next beacon gives it
+// slots.
+//
+// Beacon (kLoRaPacketBeacon, gateway to flight):
+//   0      magic (kLoRaMagic)
+//   1      type (kLoRaPacketBeacon)
+//   2      beacon sequence
+//   3      data slot count N (1-16)
+//   4-5    slot length, ms
+//   6-7    downlink window, ms
+//   8-9    superframe, ms (beacon end to next
+//          beacon end)
+//   10-11  heard mask: bit n set if rocket n was
+//          received in the previous superframe
+//   12..   N slot owners (rocket ID, 0xFF free)
+//
+// Missed beacons are bridged from the last one
+// for up to kTdmaMaxMissedBeacons superframes;
+// after that the rocket drops back to its own
+// telemetry timer until a beacon is heard again.
+//----------------------------------------------
+
+#pragma once
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "lora_protocol.h"
+
+//----------------------------------------------
+// Constants
+//----------------------------------------------
+#define kTdmaGuardUs            3000    // Kept clear at each end of a slot
+#define kTdmaMaxMissedBeacons   3
+
+//----------------------------------------------
+// Follower State
+//----------------------------------------------
+typedef struct
+{
+  bool pSynced ;                  // Beacon timing is valid
+  uint8_t pRocketId ;             // ID the slot table was read for
+  uint8_t pBeaconSeq ;
+  uint32_t pAnchorUs ;            // End of the last beacon (time_us_32)
+  uint32_t pSuperframeUs ;
+  uint32_t pDownlinkUs ;
+  uint32_t pSlotUs ;
+  uint8_t pSlotCount ;
+  uint8_t pSlots[kTdmaMaxSlots] ;
+  uint8_t pOwnSlots ;             // Slots assigned to this rocket
+  bool pHeard ;                   // Gateway heard us last superframe
+  uint32_t pRandom ;              // Contention draw (xorshift)
+
+  // Statistics
+  uint32_t pBeacons ;             // Valid beacons received
+  uint32_t pSyncLosses ;          // Fell back to free-running
+} TdmaState ;
+
+//----------------------------------------------
+// Function: Tdma_Init
+// Purpose: Start unsynchronized (free-running)
+// Parameters:
+//   outState - State to initialize
+//----------------------------------------------
+void Tdma_Init(TdmaState * outState) ;
+
+//----------------------------------------------
+// Function: Tdma_ProcessBeacon
+// Purpose: Take the timing and slot table from a
+//   received beacon
+// Parameters:
+//   ioState - Follower state
+//   inPacket - Received packet (magic, type, ...)
+//   inLen - Packet length
+//   inRxUs - RxDone time of the packet
+//   inRocketId - This rocket's ID
+// Returns: false if the beacon is malformed
+//----------------------------------------------
+bool Tdma_ProcessBeacon(
+  TdmaState * ioState,
+  const uint8_t * inPacket,
+  uint8_t inLen,
+  uint32_t inRxUs,
+  uint8_t inRocketId) ;
+
+//----------------------------------------------
+// Function: Tdma_IsSynced
+// Purpose: Check whether slot timing applies
+// Parameters:
+//   ioState - Follower state
+//   inNowUs - Current time (time_us_32)
+// Returns: false if no beacon was heard, or the
+//   last one is too old to bridge
+//----------------------------------------------
+bool Tdma_IsSynced(TdmaState * ioState, uint32_t inNowUs) ;
+
+//----------------------------------------------
+// Function: Tdma_GetTxWindow
+// Purpose: Find the current or next slot this
+//   rocket may transmit in
+// Parameters:
+//   inState - Follower state
+//   inNowUs - Current time (time_us_32)
+//   outStartUs - Window start, guard applied
+//   outEndUs - Window end, guard applied
+// Returns: false if there is no usable slot
+//   before sync would be lost
+//----------------------------------------------
+bool Tdma_GetTxWindow(
+  const TdmaState * inState,
+  uint32_t inNowUs,
+  uint32_t * outStartUs,
+  uint32_t * outEndUs) ;
@@ -0,0 +1,117 @@
+//----------------------------------------------
+// Module: telemetry_fec.h
+// Description: Packet-level forward error
+//   correction for telemetry (XOR parity frame
+//   every K frames)
+// Author: Mark Gavin
+// Created: 2026-02-14
+// Copyright: (c) 2025-2026 by Mark Gavin
+// License: Proprietary - All Rights Reserved
+//
+// Telemetry frames are grouped by sequence: with
+// a group size K (2, 4 or 8, which divide the
+// 8-bit sequence space) a group is the K frames
+// from a sequence that is a multiple of K. After
+// the last frame of a group, or when a frame
+// from a later group is sent first, a parity
+// frame goes out holding the XOR of every frame
+// sent in the group, each zero-padded to the
+// longest. The gateway rebuilds any one missing
+// frame of a group from it. The cost is one
+// frame's airtime in K + 1.
+//
+// Parity frame (kLoRaPacketParity):
+//   0      magic (kLoRaMagic)
+//   1      type (kLoRaPacketParity)
+//   2      rocket ID
+//   3      first sequence of the group (low byte)
+//   4      group size K
+//   5      sent mask: bit n set if sequence
+//          first + n is in the parity
+//   6      XOR of the frame lengths
+//   7..    XOR of the frames (on-air bytes,
+//          compact and batch frames included)
+//----------------------------------------------
+
+#pragma once
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "lora_protocol.h"
+
+//----------------------------------------------
+// Constants
+//----------------------------------------------
+#define kFecParityMaxLen        (kFecHeaderLen + kFecMaxFrameLen)
+
+//----------------------------------------------
+// Encoder State
+//----------------------------------------------
+typedef struct
+{
+  uint8_t pGroup ;                // K; 0 when off
+  bool pOpen ;                    // A group has frames in it
+  uint8_t pBase ;                 // First sequence of the open group
+  uint8_t pMask ;
+  uint8_t pLenXor ;
+  uint8_t pMaxLen ;
+  uint8_t pXor[kFecMaxFrameLen] ;
+  uint8_t pParity[kFecParityMaxLen] ;
+  uint8_t pParityLen ;            // Waiting to go out (0: none)
+
+  // Statistics
+  uint32_t pParitySent ;
+  uint32_t pParityDropped ;       // Replaced before it could go out
+} TelemetryFec ;
+
+//----------------------------------------------
+// Function: TelemetryFec_Init
+// Purpose: Start with no open group
+// Parameters:
+//   outFec - Encoder to initialize
+//   inGroup - Group size K (0: off)
+//----------------------------------------------
+void TelemetryFec_Init(TelemetryFec * outFec, uint8_t inGroup) ;
+
+//----------------------------------------------
+// Function: TelemetryFec_SetGroup
+// Purpose: Change the group size
+// Parameters:
+//   ioFec - Encoder
+//   inGroup - 0 (off), 2, 4 or 8
+// Returns: false if the size is not allowed
+// Notes: Drops the open group and any parity
+//   still waiting
+//----------------------------------------------
+bool TelemetryFec_SetGroup(TelemetryFec * ioFec, uint8_t inGroup) ;
+
+//----------------------------------------------
+// Function: TelemetryFec_AddFrame
+// Purpose: Fold a telemetry frame that has been
+//   queued into its group's parity
+// Parameters:
+//   ioFec - Encoder
+//   inFrame - Frame as sent
+//   inLen - Frame length
+//   inSequence - Its sequence (low byte)
+//   inRocketId - This rocket's ID
+// Returns: true if a parity frame is now waiting
+//----------------------------------------------
+bool TelemetryFec_AddFrame(
+  TelemetryFec * ioFec,
+  const uint8_t * inFrame,
+  uint8_t inLen,
+  uint8_t inSequence,
+  uint8_t inRocketId) ;
+
+//----------------------------------------------
+// Function: TelemetryFec_TakeParity
+// Purpose: Collect the waiting parity frame
+// Parameters:
+//   ioFec - Encoder
+//   outPacket - Output buffer
+//   inMaxLen - Buffer size; a parity frame
+//     longer than this is dropped
+// Returns: Frame length, 0 if none is waiting
+//----------------------------------------------
+uint8_t TelemetryFec_TakeParity(TelemetryFec * ioFec, uint8_t * outPacket, uint8_t inMaxLen) ;
@@ -0,0 +1,56 @@
+//----------------------------------------------
+// Module: tusb_config.h
+// Description: TinyUSB configuration for the
+//   CDC (stdio) + MSC (flight drive) composite
+//   device
+// Author: Mark Gavin
+// Created: 2026-02-03
+// Copyright: (c) 2025-2026 by Mark Gavin
+// License: Proprietary - All Rights Reserved
+// Modified: 2026-02-16 (tud_task background IRQ)
+//
+// Only used when built with -DUSB_MSC=ON.
+// Linking tinyusb_device directly turns off
+// stdio_usb's background task by default; the
+// build sets PICO_STDIO_USB_ENABLE_IRQ_BACKGROUND_TASK
+// so its low-priority IRQ still runs tud_task.
+//----------------------------------------------
+
+#pragma once
+
+//----------------------------------------------
+// Common Configuration
+//----------------------------------------------
+#ifndef CFG_TUSB_MCU
+#define CFG_TUSB_MCU                OPT_MCU_RP2040
+#endif
+
+#define CFG_TUSB_RHPORT0_MODE       OPT_MODE_DEVICE
+#define CFG_TUSB_OS                 OPT_OS_PICO
+
+#ifndef CFG_TUSB_MEM_SECTION
+#define CFG_TUSB_MEM_SECTION
+#endif
+
+#ifndef CFG_TUSB_MEM_ALIGN
+#define CFG_TUSB_MEM_ALIGN          __attribute__ ((aligned(4)))
+#endif
+
+//----------------------------------------------
+// Device Configuration
+//----------------------------------------------
+#define CFG_TUD_ENABLED             1
+#define CFG_TUD_ENDPOINT0_SIZE      64
+
+#define CFG_TUD_CDC                 1
+#define CFG_TUD_MSC                 1
+#define CFG_TUD_HID                 0
+#define CFG_TUD_MIDI                0
+#define CFG_TUD_VENDOR              0
+
+// CDC FIFO sizes (match Pico SDK stdio_usb defaults)
+#define CFG_TUD_CDC_RX_BUFSIZE      256
+#define CFG_TUD_CDC_TX_BUFSIZE      256
+
+// MSC buffer: eight 512-byte sectors per read callback
+#define CFG_TUD_MSC_EP_BUFSIZE      4096
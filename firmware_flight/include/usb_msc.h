@@ -0,0 +1,54 @@
+//----------------------------------------------
+// Module: usb_msc.h
+// Description: USB mass-storage view of stored
+//   flights (read-only virtual FAT12 volume)
+// Author: Mark Gavin
+// Created: 2026-02-03
+// Copyright: (c) 2025-2026 by Mark Gavin
+// License: Proprietary - All Rights Reserved
+//
+// Each stored flight appears as two files that
+// are synthesised on the fly from flash:
+//   FLTnnnnn.BIN - raw slot (header page + samples)
+//   FLTnnnnn.CSV - fixed-width CSV, one row/sample
+// Nothing is copied into RAM; sectors are built
+// as the host reads them.
+//----------------------------------------------
+
+#pragma once
+
+#include <stdint.h>
+#include <stdbool.h>
+
+//----------------------------------------------
+// Volume Geometry
+//----------------------------------------------
+#define kMscSectorSize          512
+#define kMscSectorCount         16384       // 8MB volume
+
+//----------------------------------------------
+// CSV Row Format
+//----------------------------------------------
+// Every row has the same length so a byte offset
+// maps directly to a sample index.
+#define kMscCsvRowLen           157
+
+//----------------------------------------------
+// Function: UsbMsc_Init
+// Purpose: Initialize TinyUSB with the CDC + MSC
+//   composite descriptors
+// Returns: true if successful
+// Notes: Must be called before stdio_init_all()
+//----------------------------------------------
+bool UsbMsc_Init(void) ;
+
+//----------------------------------------------
+// Function: UsbMsc_Update
+// Purpose: Refresh the file list from the flight
+//   store and signal a media change to the host
+// Parameters:
+//   inAvailable - false while recording or writing
+//     flash; the drive then reports "not ready"
+// Notes: Call from the main loop
+//----------------------------------------------
+void UsbMsc_Update(bool inAvailable) ;
@@ -0,0 +1,154 @@
+//----------------------------------------------
+// Module: crc32.c
+// Description: CRC32 computed by the RP2040 DMA
+//   sniffer while data moves through a DMA channel
+// Author: Mark Gavin
+// Created: 2026-02-02
+// Copyright: (c) 2025-2026 by Mark Gavin
+// License: Proprietary - All Rights Reserved
+//----------------------------------------------
+
+#include "crc32.h"
+
+#include "pico/stdlib.h"
+#include "hardware/dma.h"
+
+#include <string.h>
+
+//----------------------------------------------
+// Module Constants
+//----------------------------------------------
+#define kCrc32Polynomial    0x04C11DB7
+
+//----------------------------------------------
+// Module State
+//----------------------------------------------
+static int sDmaChannel = -1 ;
+
+// Write target for checksum-only transfers
+static uint8_t sDmaSink ;
+
+//----------------------------------------------
+// Internal: Software CRC (fallback)
+//----------------------------------------------
+static uint32_t SoftwareCrc(
+  uint32_t inCrc,
+  const void * inData,
+  size_t inSize)
+{
+  const uint8_t * theBytes = (const uint8_t *)inData ;
+  uint32_t theCrc = inCrc ;
+
+  for (size_t i = 0 ; i < inSize ; i++)
+  {
+    theCrc ^= (uint32_t)theBytes[i] << 24 ;
+    for (uint8_t theBit = 0 ; theBit < 8 ; theBit++)
+    {
+      if (theCrc & 0x80000000)
+      {
+        theCrc = (theCrc << 1) ^ kCrc32Polynomial ;
+      }
+      else
+      {
+        theCrc <<= 1 ;
+      }
+    }
+  }
+
+  return theCrc ;
+}
+
+//----------------------------------------------
+// Internal: Run DMA Transfer with Sniffer
+// Byte transfers keep the sniffer input in
+// memory order, so the result matches SoftwareCrc.
+//----------------------------------------------
+static uint32_t SnifferTransfer(
+  uint32_t inCrc,
+  void * outDest,
+  const void * inSource,
+  size_t inSize)
+{
+  if (inSize == 0)
+  {
+    return inCrc ;
+  }
+
+  if (sDmaChannel < 0)
+  {
+    if (outDest != NULL)
+    {
+      memcpy(outDest, inSource, inSize) ;
+    }
+    return SoftwareCrc(inCrc, inSource, inSize) ;
+  }
+
+  dma_channel_config theConfig = dma_channel_get_default_config((uint)sDmaChannel) ;
+  channel_config_set_transfer_data_size(&theConfig, DMA_SIZE_8) ;
+  channel_config_set_read_increment(&theConfig, true) ;
+  channel_config_set_write_increment(&theConfig, outDest != NULL) ;
+  channel_config_set_sniff_enable(&theConfig, true) ;
+
+  // Seed the accumulator and attach the sniffer to our channel
+  dma_hw->sniff_data = inCrc ;
+  dma_sniffer_enable((uint)sDmaChannel, DMA_SNIFF_CTRL_CALC_VALUE_CRC32, true) ;
+
+  dma_channel_configure(
+    (uint)sDmaChannel,
+    &theConfig,
+    (outDest != NULL) ? outDest : (void *)&sDmaSink,
+    inSource,
+    inSize,
+    true) ;
+
+  dma_channel_wait_for_finish_blocking((uint)sDmaChannel) ;
+
+  uint32_t theCrc = dma_hw->sniff_data ;
+  dma_sniffer_disable() ;
+
+  return theCrc ;
+}
+
+//----------------------------------------------
+// Function: Crc32_Init
+//----------------------------------------------
+bool Crc32_Init(void)
+{
+  if (sDmaChannel < 0)
+  {
+    sDmaChannel = dma_claim_unused_channel(false) ;
+  }
+
+  return sDmaChannel >= 0 ;
+}
+
+//----------------------------------------------
+// Function: Crc32_Update
+//----------------------------------------------
+uint32_t Crc32_Update(
+  uint32_t inCrc,
+  const void * inData,
+  size_t inSize)
+{
+  return SnifferTransfer(inCrc, NULL, inData, inSize) ;
+}
+
+//----------------------------------------------
+// Function: Crc32_Copy
+//----------------------------------------------
+uint32_t Crc32_Copy(
+  uint32_t inCrc,
+  void * outDest,
+  const void * inSource,
+  size_t inSize)
+{
+  return SnifferTransfer(inCrc, outDest, inSource, inSize) ;
+}
+
+//----------------------------------------------
+// Function: Crc32_Compute
+//----------------------------------------------
+uint32_t Crc32_Compute(const void * inData, size_t inSize)
+{
+  return SnifferTransfer(kCrc32Initial, NULL, inData, inSize) ;
+}
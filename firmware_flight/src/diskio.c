@@ -3,17 +3,21 @@
 // Description: FatFs disk I/O layer for SD card
 // Author: Mark Gavin
 // Created: 2025-12-20
-// Copyright: (c) 2025 by Mark Gavin
+// Modified: 2026-02-06 (DMA data phases, async write)
+// Modified: 2026-02-16 (bounded block DMA wait)
+// Copyright: (c) 2025-2026 by Mark Gavin
 // License: Proprietary - All Rights Reserved
 //----------------------------------------------
 
 #include "ff.h"
 #include "diskio.h"
+#include "sd_diskio.h"
 #include "pins.h"
 
 #include "pico/stdlib.h"
 #include "hardware/spi.h"
 #include "hardware/gpio.h"
+#include "hardware/dma.h"
 
 #include <stdio.h>
 
@@ -36,6 +40,7 @@
 #define CMD25   (25)          // WRITE_MULTIPLE_BLOCK
 #define CMD55   (55)          // APP_CMD
 #define CMD58   (58)          // READ_OCR
+#define CMD59   (59)          // CRC_ON_OFF
 #define ACMD23  (0x80 + 23)   // SET_WR_BLK_ERASE_COUNT
 #define ACMD41  (0x80 + 41)   // SD_SEND_OP_COND
 
@@ -48,11 +53,52 @@
 #define CT_SD2      4
 #define CT_SDHC     8
 
+//----------------------------------------------
+// Data Tokens
+//----------------------------------------------
+#define kTokenStartBlock    0xFE    // CMD17/18/24 data
+#define kTokenStartMulti    0xFC    // CMD25 data
+#define kTokenStopTran      0xFD    // CMD25 end
+
+//----------------------------------------------
+// Module Constants
+//----------------------------------------------
+#define kSdBlockSize        512
+#define kSdBusyTimeoutMs    500     // Max card busy per block
+#define kSdDmaTimeoutMs     50      // One block by DMA: 10 ms at 400 kHz
+#define kSdUseCrc           1       // CMD59: card checks CRC on every transfer
+
+//----------------------------------------------
+// Async Write Phases
+//----------------------------------------------
+typedef enum
+{
+  kPhaseIdle = 0 ,        // No CMD25 open
+  kPhaseBlock ,           // Next data block due when card is ready
+  kPhaseStop ,            // Stop token due when card is ready
+  kPhaseFinish            // Waiting for busy after the stop token
+} WritePhase ;
+
 //----------------------------------------------
 // Module State
 //----------------------------------------------
 static DSTATUS sStatus = STA_NOINIT ;
 static BYTE sCardType = CT_NONE ;
+static uint32_t sSdBaudrate = kSpiSdInitBaudrate ;
+
+// DMA channels for the data phase (-1 = CPU loop)
+static int sDmaTx = -1 ;
+static int sDmaRx = -1 ;
+static const BYTE sDmaFill = 0xFF ;
+static BYTE sDmaSink ;
+
+// Asynchronous CMD25 state
+static WritePhase sWritePhase = kPhaseIdle ;
+static const BYTE * sWriteBuff = NULL ;
+static UINT sWriteRemaining = 0 ;
+static bool sWriteError = false ;
+static absolute_time_t sWriteDeadline ;
+static SdDiskState sWriteResult = kSdDiskIdle ;
 
 //----------------------------------------------
 // Internal: SPI Transfer
@@ -64,11 +110,134 @@ static BYTE SpiXfer(BYTE inData)
   return theResult ;
 }
 
+//----------------------------------------------
+// Internal: Command CRC7 (with end bit)
+//----------------------------------------------
+static BYTE Crc7(const BYTE * inData, UINT inLen)
+{
+  BYTE theCrc = 0 ;
+
+  for (UINT i = 0 ; i < inLen ; i++)
+  {
+    BYTE theByte = inData[i] ;
+    for (int theBit = 0 ; theBit < 8 ; theBit++)
+    {
+      theCrc <<= 1 ;
+      if ((theByte ^ theCrc) & 0x80)
+      {
+        theCrc ^= 0x09 ;
+      }
+      theByte <<= 1 ;
+    }
+  }
+
+  return (BYTE)((theCrc << 1) | 0x01) ;
+}
+
+//----------------------------------------------
+// Internal: Data CRC16 (CCITT, software fallback)
+//----------------------------------------------
+static WORD Crc16(const BYTE * inData, UINT inLen)
+{
+  WORD theCrc = 0 ;
+
+  for (UINT i = 0 ; i < inLen ; i++)
+  {
+    theCrc ^= (WORD)inData[i] << 8 ;
+    for (int theBit = 0 ; theBit < 8 ; theBit++)
+    {
+      theCrc = (theCrc & 0x8000) ? (WORD)((theCrc << 1) ^ 0x1021) : (WORD)(theCrc << 1) ;
+    }
+  }
+
+  return theCrc ;
+}
+
+//----------------------------------------------
+// Internal: Block Data Phase
+// Clocks inLen bytes through SPI. inTx == NULL
+// sends 0xFF; outRx == NULL discards. The sniffer
+// watches the memory-side channel, so the block
+// CRC16 comes for free. Returns 0 if the DMA has
+// not finished within kSdDmaTimeoutMs; both
+// channels are then aborted, as the LoRa driver
+// does, so a stuck bus fails the block instead of
+// hanging the main loop.
+//----------------------------------------------
+static int DataPhase(const BYTE * inTx, BYTE * outRx, UINT inLen, WORD * outCrc)
+{
+  if (sDmaTx < 0)
+  {
+    for (UINT i = 0 ; i < inLen ; i++)
+    {
+      BYTE theIn = SpiXfer(inTx != NULL ? inTx[i] : 0xFF) ;
+      if (outRx != NULL) outRx[i] = theIn ;
+    }
+    *outCrc = Crc16(inTx != NULL ? inTx : outRx, inLen) ;
+    return 1 ;
+  }
+
+  spi_hw_t * theSpi = spi_get_hw(kSpiPort) ;
+
+  dma_channel_config theTxConfig = dma_channel_get_default_config((uint)sDmaTx) ;
+  channel_config_set_transfer_data_size(&theTxConfig, DMA_SIZE_8) ;
+  channel_config_set_dreq(&theTxConfig, spi_get_dreq(kSpiPort, true)) ;
+  channel_config_set_read_increment(&theTxConfig, inTx != NULL) ;
+  channel_config_set_write_increment(&theTxConfig, false) ;
+  channel_config_set_sniff_enable(&theTxConfig, inTx != NULL) ;
+
+  dma_channel_config theRxConfig = dma_channel_get_default_config((uint)sDmaRx) ;
+  channel_config_set_transfer_data_size(&theRxConfig, DMA_SIZE_8) ;
+  channel_config_set_dreq(&theRxConfig, spi_get_dreq(kSpiPort, false)) ;
+  channel_config_set_read_increment(&theRxConfig, false) ;
+  channel_config_set_write_increment(&theRxConfig, outRx != NULL) ;
+  channel_config_set_sniff_enable(&theRxConfig, inTx == NULL) ;
+
+  // CRC16 seed is zero for SD data blocks
+  dma_hw->sniff_data = 0 ;
+  dma_sniffer_enable((uint)(inTx != NULL ? sDmaTx : sDmaRx), DMA_SNIFF_CTRL_CALC_VALUE_CRC16, true) ;
+
+  dma_channel_configure((uint)sDmaTx, &theTxConfig, &theSpi->dr,
+    (inTx != NULL) ? inTx : &sDmaFill, inLen, false) ;
+  dma_channel_configure((uint)sDmaRx, &theRxConfig,
+    (outRx != NULL) ? (void *)outRx : (void *)&sDmaSink, &theSpi->dr, inLen, false) ;
+
+  // Start both together; RX paces TX so the FIFO never overflows
+  absolute_time_t theDeadline = make_timeout_time_ms(kSdDmaTimeoutMs) ;
+  dma_start_channel_mask((1u << sDmaTx) | (1u << sDmaRx)) ;
+
+  while (dma_channel_is_busy((uint)sDmaRx))
+  {
+    if (time_reached(theDeadline))
+    {
+      dma_channel_abort((uint)sDmaTx) ;
+      dma_channel_abort((uint)sDmaRx) ;
+      dma_sniffer_disable() ;
+
+      // Drop what the aborted transfer left in the FIFOs
+      while (spi_is_busy(kSpiPort)) ;
+      while (spi_is_readable(kSpiPort))
+      {
+        (void)theSpi->dr ;
+      }
+      printf("diskio: Block DMA timed out\n") ;
+      return 0 ;
+    }
+  }
+
+  *outCrc = (WORD)dma_hw->sniff_data ;
+  dma_sniffer_disable() ;
+
+  return 1 ;
+}
+
 //----------------------------------------------
 // Internal: Select Card
 //----------------------------------------------
 static void SelectCard(void)
 {
+  // SPI1 is shared with the LoRa radio
+  spi_set_baudrate(kSpiPort, sSdBaudrate) ;
   gpio_put(kPinSdCs, 0) ;
   SpiXfer(0xFF) ; // Dummy clock
 }
@@ -80,6 +249,7 @@ static void DeselectCard(void)
 {
   gpio_put(kPinSdCs, 1) ;
   SpiXfer(0xFF) ; // Extra clock for card release
+  spi_set_baudrate(kSpiPort, kSpiLoRaBaudrate) ;
 }
 
 //----------------------------------------------
@@ -117,18 +287,19 @@ static BYTE SendCmd(BYTE inCmd, DWORD inArg)
   SelectCard() ;
   if (!WaitReady(500)) return 0xFF ;
 
-  // Send command packet
-  SpiXfer(0x40 | theActualCmd) ;
-  SpiXfer((BYTE)(inArg >> 24)) ;
-  SpiXfer((BYTE)(inArg >> 16)) ;
-  SpiXfer((BYTE)(inArg >> 8)) ;
-  SpiXfer((BYTE)inArg) ;
-
-  // CRC
-  BYTE theCrc = 0x01 ;  // Dummy CRC + stop bit
-  if (theActualCmd == CMD0) theCrc = 0x95 ;
-  if (theActualCmd == CMD8) theCrc = 0x87 ;
-  SpiXfer(theCrc) ;
+  // Send command packet (valid CRC7 for every command,
+  // required once CRC checking is on)
+  BYTE thePacket[6] ;
+  thePacket[0] = 0x40 | theActualCmd ;
+  thePacket[1] = (BYTE)(inArg >> 24) ;
+  thePacket[2] = (BYTE)(inArg >> 16) ;
+  thePacket[3] = (BYTE)(inArg >> 8) ;
+  thePacket[4] = (BYTE)inArg ;
+  thePacket[5] = Crc7(thePacket, 5) ;
+  for (int i = 0 ; i < 6 ; i++)
+  {
+    SpiXfer(thePacket[i]) ;
+  }
 
   // Wait for response
   if (theActualCmd == CMD12) SpiXfer(0xFF) ; // Skip stuff byte
@@ -153,17 +324,45 @@ static int ReceiveDataBlock(BYTE * outBuff, UINT inLen)
     theToken = SpiXfer(0xFF) ;
   } while (theToken == 0xFF && !time_reached(theEnd)) ;
 
-  if (theToken != 0xFE) return 0 ; // Invalid token
+  if (theToken != kTokenStartBlock) return 0 ; // Invalid token
 
   // Receive data
-  for (UINT i = 0 ; i < inLen ; i++)
+  WORD theCrc ;
+  if (!DataPhase(NULL, outBuff, inLen, &theCrc)) return 0 ;
+
+  // Check CRC
+  WORD theCardCrc = (WORD)(SpiXfer(0xFF) << 8) ;
+  theCardCrc |= SpiXfer(0xFF) ;
+  if (kSdUseCrc && theCrc != theCardCrc)
   {
-    outBuff[i] = SpiXfer(0xFF) ;
+    printf("diskio: Read CRC mismatch\n") ;
+    return 0 ;
   }
 
-  // Discard CRC
-  SpiXfer(0xFF) ;
-  SpiXfer(0xFF) ;
+  return 1 ;
+}
+
+//----------------------------------------------
+// Internal: Transmit Data Block
+// Card must already be ready (not busy)
+//----------------------------------------------
+static int TransmitBlock(const BYTE * inBuff, BYTE inToken)
+{
+  // Send token
+  SpiXfer(inToken) ;
+
+  if (inToken != kTokenStopTran)
+  {
+    // Send data, then its CRC
+    WORD theCrc ;
+    if (!DataPhase(inBuff, NULL, kSdBlockSize, &theCrc)) return 0 ;
+    SpiXfer((BYTE)(theCrc >> 8)) ;
+    SpiXfer((BYTE)theCrc) ;
+
+    // Check response (0x0B = CRC error, 0x0D = write error)
+    BYTE theResp = SpiXfer(0xFF) ;
+    if ((theResp & 0x1F) != 0x05) return 0 ;
+  }
 
   return 1 ;
 }
@@ -173,29 +372,110 @@ static int ReceiveDataBlock(BYTE * outBuff, UINT inLen)
 //----------------------------------------------
 static int SendDataBlock(const BYTE * inBuff, BYTE inToken)
 {
-  if (!WaitReady(500)) return 0 ;
+  if (!WaitReady(kSdBusyTimeoutMs)) return 0 ;
+  return TransmitBlock(inBuff, inToken) ;
+}
 
-  // Send token
-  SpiXfer(inToken) ;
+//----------------------------------------------
+// Internal: Advance Async Write
+// Sends every block the card is ready for, then
+// deselects so the bus is free while it programs.
+//----------------------------------------------
+static void StepAsyncWrite(void)
+{
+  SelectCard() ;
 
-  if (inToken != 0xFD) // Not stop token
+  while (sWritePhase != kPhaseIdle)
   {
-    // Send data
-    for (UINT i = 0 ; i < 512 ; i++)
+    // Card still programming the previous block
+    if (SpiXfer(0xFF) != 0xFF)
     {
-      SpiXfer(inBuff[i]) ;
+      if (time_reached(sWriteDeadline))
+      {
+        printf("diskio: Async write timeout\n") ;
+        sWritePhase = kPhaseIdle ;
+        sWriteResult = kSdDiskError ;
+      }
+      break ;
     }
+    sWriteDeadline = make_timeout_time_ms(kSdBusyTimeoutMs) ;
 
-    // Send dummy CRC
-    SpiXfer(0xFF) ;
-    SpiXfer(0xFF) ;
+    if (sWritePhase == kPhaseBlock)
+    {
+      if (!TransmitBlock(sWriteBuff, kTokenStartMulti))
+      {
+        // Rejected block: close the transfer
+        sWriteError = true ;
+        sWritePhase = kPhaseStop ;
+      }
+      else
+      {
+        sWriteBuff += kSdBlockSize ;
+        if (--sWriteRemaining == 0)
+        {
+          sWritePhase = kPhaseStop ;
+        }
+      }
+    }
+    else if (sWritePhase == kPhaseStop)
+    {
+      SpiXfer(kTokenStopTran) ;
+      SpiXfer(0xFF) ; // One byte before busy starts
+      sWritePhase = kPhaseFinish ;
+    }
+    else
+    {
+      // Ready after the stop token: all blocks programmed
+      sWritePhase = kPhaseIdle ;
+      sWriteResult = sWriteError ? kSdDiskError : kSdDiskDone ;
+    }
+  }
 
-    // Check response
-    BYTE theResp = SpiXfer(0xFF) ;
-    if ((theResp & 0x1F) != 0x05) return 0 ;
+  DeselectCard() ;
+}
+
+//----------------------------------------------
+// Internal: Start Async Write
+// inAddr is already converted for the card type
+//----------------------------------------------
+static bool StartAsyncWrite(const BYTE * inBuff, DWORD inAddr, UINT inCount)
+{
+  // Predefine block count (SD only) so the card can pre-erase
+  if (sCardType & (CT_SD1 | CT_SD2))
+  {
+    SendCmd(ACMD23, inCount) ;
   }
 
-  return 1 ;
+  if (SendCmd(CMD25, inAddr) != 0)
+  {
+    DeselectCard() ;
+    return false ;
+  }
+
+  sWriteBuff = inBuff ;
+  sWriteRemaining = inCount ;
+  sWriteError = false ;
+  sWriteResult = kSdDiskIdle ;
+  sWriteDeadline = make_timeout_time_ms(kSdBusyTimeoutMs) ;
+  sWritePhase = kPhaseBlock ;
+
+  // Send what the card will take right away
+  StepAsyncWrite() ;
+  return true ;
+}
+
+//----------------------------------------------
+// Internal: Finish Async Write
+// Synchronous FatFs calls wait for any
+// outstanding write before using the card. The
+// result stays available to SdDisk_WritePoll.
+//----------------------------------------------
+static void FinishAsyncWrite(void)
+{
+  while (sWritePhase != kPhaseIdle)
+  {
+    StepAsyncWrite() ;
+  }
 }
 
 //----------------------------------------------
@@ -207,8 +487,10 @@ DSTATUS disk_initialize(BYTE inDrive)
 
   printf("diskio: Initializing SD card...\n") ;
 
-  // Initialize SPI at slow speed
-  spi_init(kSpiPort, 400000) ;
+  // SPI1 is already set up for LoRa; identify the
+  // card at slow speed
+  sSdBaudrate = kSpiSdInitBaudrate ;
+  spi_set_baudrate(kSpiPort, sSdBaudrate) ;
   gpio_set_function(kPinSpiSck, GPIO_FUNC_SPI) ;
   gpio_set_function(kPinSpiMosi, GPIO_FUNC_SPI) ;
   gpio_set_function(kPinSpiMiso, GPIO_FUNC_SPI) ;
@@ -231,11 +513,32 @@ DSTATUS disk_initialize(BYTE inDrive)
 
   sCardType = CT_NONE ;
 
+  // DMA channels for the 512-byte data phases
+  if (sDmaTx < 0 && sDmaRx < 0)
+  {
+    sDmaTx = dma_claim_unused_channel(false) ;
+    sDmaRx = dma_claim_unused_channel(false) ;
+    if (sDmaTx < 0 || sDmaRx < 0)
+    {
+      // Need both; fall back to the CPU loop
+      if (sDmaTx >= 0) dma_channel_unclaim((uint)sDmaTx) ;
+      if (sDmaRx >= 0) dma_channel_unclaim((uint)sDmaRx) ;
+      sDmaTx = -1 ;
+      sDmaRx = -1 ;
+    }
+  }
+
   // CMD0 - Enter SPI mode
   if (SendCmd(CMD0, 0) == 0x01)
   {
     absolute_time_t theTimeout = make_timeout_time_ms(1000) ;
 
+    // CMD59 - Card checks command and data CRCs
+    if (kSdUseCrc)
+    {
+      SendCmd(CMD59, 1) ;
+    }
+
     // CMD8 - Check for SDv2
     if (SendCmd(CMD8, 0x1AA) == 0x01)
     {
@@ -291,8 +594,8 @@ DSTATUS disk_initialize(BYTE inDrive)
 
   if (sCardType != CT_NONE)
   {
-    // Increase SPI speed
-    spi_set_baudrate(kSpiPort, 25000000) ; // 25 MHz
+    // Increase SPI speed (applied on each select)
+    sSdBaudrate = kSpiSdBaudrate ;
 
     sStatus &= ~STA_NOINIT ;
     printf("diskio: SD card initialized (type=%d)\n", sCardType) ;
@@ -322,6 +625,8 @@ DRESULT disk_read(BYTE inDrive, BYTE * outBuff, LBA_t inSector, UINT inCount)
   if (inDrive != 0 || !inCount) return RES_PARERR ;
   if (sStatus & STA_NOINIT) return RES_NOTRDY ;
 
+  FinishAsyncWrite() ;
+
   // Convert to byte address if not SDHC
   if (!(sCardType & CT_SDHC)) inSector *= 512 ;
 
@@ -360,38 +665,32 @@ DRESULT disk_write(BYTE inDrive, const BYTE * inBuff, LBA_t inSector, UINT inCou
   if (sStatus & STA_NOINIT) return RES_NOTRDY ;
   if (sStatus & STA_PROTECT) return RES_WRPRT ;
 
+  FinishAsyncWrite() ;
+
   // Convert to byte address if not SDHC
   if (!(sCardType & CT_SDHC)) inSector *= 512 ;
 
   if (inCount == 1)
   {
     // Single block write
-    if (SendCmd(CMD24, inSector) == 0 && SendDataBlock(inBuff, 0xFE))
+    if (SendCmd(CMD24, inSector) == 0 && SendDataBlock(inBuff, kTokenStartBlock))
     {
       inCount = 0 ;
     }
+    DeselectCard() ;
   }
   else
   {
-    // Multiple block write
-    if (sCardType & (CT_SD1 | CT_SD2))
-    {
-      SendCmd(ACMD23, inCount) ; // Predefine block count
-    }
-
-    if (SendCmd(CMD25, inSector) == 0)
+    // Multiple block write: same engine as the async
+    // path, run to completion
+    if (StartAsyncWrite(inBuff, inSector, inCount))
     {
-      do {
-        if (!SendDataBlock(inBuff, 0xFC)) break ;
-        inBuff += 512 ;
-      } while (--inCount) ;
-
-      if (!SendDataBlock(0, 0xFD)) inCount = 1 ; // Stop token
+      FinishAsyncWrite() ;
+      if (sWriteResult == kSdDiskDone) inCount = 0 ;
+      sWriteResult = kSdDiskIdle ;
     }
   }
 
-  DeselectCard() ;
-
   return inCount ? RES_ERROR : RES_OK ;
 }
 
@@ -409,6 +708,7 @@ DRESULT disk_ioctl(BYTE inDrive, BYTE inCmd, void * ioBuff)
   {
     case CTRL_SYNC:
       // Wait for card to be ready
+      FinishAsyncWrite() ;
       SelectCard() ;
       if (WaitReady(500)) theResult = RES_OK ;
       DeselectCard() ;
@@ -431,3 +731,51 @@ DRESULT disk_ioctl(BYTE inDrive, BYTE inCmd, void * ioBuff)
 
   return theResult ;
 }
+
+//----------------------------------------------
+// Function: SdDisk_WriteStart
+//----------------------------------------------
+bool SdDisk_WriteStart(const uint8_t * inBuff, uint32_t inSector, uint32_t inCount)
+{
+  if (inBuff == NULL || inCount == 0) return false ;
+  if (sStatus & (STA_NOINIT | STA_PROTECT)) return false ;
+  if (sWritePhase != kPhaseIdle) return false ;
+
+  // Convert to byte address if not SDHC
+  if (!(sCardType & CT_SDHC)) inSector *= 512 ;
+
+  return StartAsyncWrite(inBuff, inSector, inCount) ;
+}
+
+//----------------------------------------------
+// Function: SdDisk_WritePoll
+//----------------------------------------------
+SdDiskState SdDisk_WritePoll(void)
+{
+  if (sWritePhase != kPhaseIdle)
+  {
+    StepAsyncWrite() ;
+    if (sWritePhase != kPhaseIdle) return kSdDiskBusy ;
+  }
+
+  // Report the result once
+  SdDiskState theResult = sWriteResult ;
+  sWriteResult = kSdDiskIdle ;
+  return theResult ;
+}
+
+//----------------------------------------------
+// Function: SdDisk_IsWriting
+//----------------------------------------------
+bool SdDisk_IsWriting(void)
+{
+  return sWritePhase != kPhaseIdle ;
+}
+
+//----------------------------------------------
+// Function: SdDisk_IsDmaEnabled
+//----------------------------------------------
+bool SdDisk_IsDmaEnabled(void)
+{
+  return sDmaTx >= 0 ;
+}
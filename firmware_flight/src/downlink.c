@@ -0,0 +1,301 @@
+//----------------------------------------------
+// Module: downlink.c
+// Description: Priority downlink scheduler with
+//   an airtime budget
+// Author: Mark Gavin
+// Created: 2026-02-15
+// Copyright: (c) 2025-2026 by Mark Gavin
+// License: Proprietary - All Rights Reserved
+//----------------------------------------------
+
+#include "downlink.h"
+
+#include <string.h>
+
+//----------------------------------------------
+// Internal: Top up the bucket for time passed
+//----------------------------------------------
+static void Refill(DownlinkQueue * ioQueue, uint32_t inNowUs)
+{
+  uint32_t theElapsedUs = inNowUs - ioQueue->pLastRefillUs ;
+  ioQueue->pLastRefillUs = inNowUs ;
+
+  // Anything past two bucket depths fills it
+  // anyway; the cap keeps the product in range
+  if (theElapsedUs > 2 * kDownlinkBurstUs)
+  {
+    theElapsedUs = 2 * kDownlinkBurstUs ;
+  }
+
+  int32_t theTokensUs = ioQueue->pTokensUs +
+    (int32_t)(theElapsedUs * kDownlinkDutyPercent / 100) ;
+  if (theTokensUs > kDownlinkBurstUs)
+  {
+    theTokensUs = kDownlinkBurstUs ;
+  }
+  ioQueue->pTokensUs = theTokensUs ;
+}
+
+//----------------------------------------------
+// Internal: Drop frames queued too long
+//----------------------------------------------
+static void Expire(DownlinkQueue * ioQueue, uint32_t inNowUs)
+{
+  for (int i = 0 ; i < kDownlinkQueueSize ; i++)
+  {
+    DownlinkFrame * theFrame = &ioQueue->pFrames[i] ;
+    if (theFrame->pUsed &&
+        inNowUs - theFrame->pQueuedUs > kDownlinkExpireMs * 1000u)
+    {
+      theFrame->pUsed = false ;
+      ioQueue->pStats[theFrame->pClass].pDropped++ ;
+    }
+  }
+}
+
+//----------------------------------------------
+// Internal: Next frame to send (highest class,
+// oldest within it), -1 if empty
+//----------------------------------------------
+static int PickNext(const DownlinkQueue * inQueue)
+{
+  int theBest = -1 ;
+
+  for (int i = 0 ; i < kDownlinkQueueSize ; i++)
+  {
+    const DownlinkFrame * theFrame = &inQueue->pFrames[i] ;
+    if (!theFrame->pUsed)
+    {
+      continue ;
+    }
+
+    if (theBest < 0)
+    {
+      theBest = i ;
+      continue ;
+    }
+
+    const DownlinkFrame * theBestFrame = &inQueue->pFrames[theBest] ;
+    if (theFrame->pClass < theBestFrame->pClass ||
+        (theFrame->pClass == theBestFrame->pClass &&
+         (int32_t)(theFrame->pQueuedUs - theBestFrame->pQueuedUs) < 0))
+    {
+      theBest = i ;
+    }
+  }
+
+  return theBest ;
+}
+
+//----------------------------------------------
+// Function: Downlink_Init
+//----------------------------------------------
+void Downlink_Init(DownlinkQueue * outQueue, uint32_t inNowUs)
+{
+  memset(outQueue, 0, sizeof(*outQueue)) ;
+  outQueue->pTokensUs = kDownlinkBurstUs ;
+  outQueue->pLastRefillUs = inNowUs ;
+}
+
+//----------------------------------------------
+// Function: Downlink_Queue
+//----------------------------------------------
+bool Downlink_Queue(
+  DownlinkQueue * ioQueue,
+  uint8_t inClass,
+  const uint8_t * inData,
+  uint8_t inLen,
+  uint32_t inRxWindowUs,
+  uint32_t inNowUs)
+{
+  if (inClass >= kDownlinkClassCount || inLen == 0)
+  {
+    return false ;
+  }
+
+  int theSlot = -1 ;
+  for (int i = 0 ; i < kDownlinkQueueSize ; i++)
+  {
+    if (!ioQueue->pFrames[i].pUsed)
+    {
+      theSlot = i ;
+      break ;
+    }
+  }
+
+  if (theSlot < 0)
+  {
+    // Full: push out the newest frame of the
+    // lowest class that is below this one
+    for (int i = 0 ; i < kDownlinkQueueSize ; i++)
+    {
+      const DownlinkFrame * theFrame = &ioQueue->pFrames[i] ;
+      if (theFrame->pClass <= inClass)
+      {
+        continue ;
+      }
+
+      if (theSlot < 0)
+      {
+        theSlot = i ;
+        continue ;
+      }
+
+      const DownlinkFrame * theVictim = &ioQueue->pFrames[theSlot] ;
+      if (theFrame->pClass > theVictim->pClass ||
+          (theFrame->pClass == theVictim->pClass &&
+           (int32_t)(theFrame->pQueuedUs - theVictim->pQueuedUs) > 0))
+      {
+        theSlot = i ;
+      }
+    }
+
+    if (theSlot < 0)
+    {
+      ioQueue->pStats[inClass].pDropped++ ;
+      return false ;
+    }
+
+    ioQueue->pStats[ioQueue->pFrames[theSlot].pClass].pDropped++ ;
+  }
+
+  DownlinkFrame * theFrame = &ioQueue->pFrames[theSlot] ;
+  theFrame->pUsed = true ;
+  theFrame->pHeld = false ;
+  theFrame->pClass = inClass ;
+  theFrame->pLen = inLen ;
+  theFrame->pRxWindowUs = inRxWindowUs ;
+  theFrame->pQueuedUs = inNowUs ;
+  memcpy(theFrame->pData, inData, inLen) ;
+
+  return true ;
+}
+
+//----------------------------------------------
+// Function: Downlink_IsQueued
+//----------------------------------------------
+bool Downlink_IsQueued(const DownlinkQueue * inQueue, uint8_t inClass)
+{
+  for (int i = 0 ; i < kDownlinkQueueSize ; i++)
+  {
+    if (inQueue->pFrames[i].pUsed && inQueue->pFrames[i].pClass == inClass)
+    {
+      return true ;
+    }
+  }
+
+  return false ;
+}
+
+//----------------------------------------------
+// Function: Downlink_Service
+//----------------------------------------------
+bool Downlink_Service(
+  DownlinkQueue * ioQueue,
+  LoRa_Radio * ioRadio,
+  uint32_t inNowUs,
+  uint32_t inMaxAirUs)
+{
+  Refill(ioQueue, inNowUs) ;
+  Expire(ioQueue, inNowUs) ;
+
+  // One frame at a time in the radio, so the
+  // order here is the order on air
+  if (LoRa_IsTransmitting(ioRadio))
+  {
+    return false ;
+  }
+
+  int theNext = PickNext(ioQueue) ;
+  if (theNext < 0)
+  {
+    return false ;
+  }
+
+  DownlinkFrame * theFrame = &ioQueue->pFrames[theNext] ;
+  DownlinkStats * theStats = &ioQueue->pStats[theFrame->pClass] ;
+  uint32_t theAirUs = LoRa_GetTimeOnAirUs(ioRadio, theFrame->pLen) ;
+
+  if (theAirUs > inMaxAirUs)
+  {
+    return false ;
+  }
+
+  // A frame longer than the bucket goes once the
+  // bucket is full
+  int32_t theNeedUs = (theAirUs > kDownlinkBurstUs) ? kDownlinkBurstUs : (int32_t)theAirUs ;
+  if (theFrame->pClass >= kDownlinkResponse && ioQueue->pTokensUs < theNeedUs)
+  {
+    if (!theFrame->pHeld)
+    {
+      theFrame->pHeld = true ;
+      theStats->pHeld++ ;
+    }
+    return false ;
+  }
+
+  bool theQueued ;
+  if (theFrame->pRxWindowUs > 0)
+  {
+    theQueued = LoRa_SendWithRxWindow(ioRadio, theFrame->pData, theFrame->pLen, theFrame->pRxWindowUs) ;
+  }
+  else
+  {
+    theQueued = LoRa_Send(ioRadio, theFrame->pData, theFrame->pLen) ;
+  }
+
+  theFrame->pUsed = false ;
+  if (!theQueued)
+  {
+    theStats->pDropped++ ;
+    return false ;
+  }
+
+  // Events and telemetry may overdraw, but only
+  // by one bucket, so the lower classes recover
+  int32_t theTokensUs = ioQueue->pTokensUs - (int32_t)theAirUs ;
+  if (theTokensUs < -kDownlinkBurstUs)
+  {
+    theTokensUs = -kDownlinkBurstUs ;
+  }
+  ioQueue->pTokensUs = theTokensUs ;
+
+  uint32_t theDelayUs = inNowUs - theFrame->pQueuedUs ;
+  theStats->pSent++ ;
+  theStats->pDelayTotalUs += theDelayUs ;
+  if (theDelayUs > theStats->pDelayMaxUs)
+  {
+    theStats->pDelayMaxUs = theDelayUs ;
+  }
+
+  return true ;
+}
+
+//----------------------------------------------
+// Function: Downlink_GetDelayMs
+//----------------------------------------------
+void Downlink_GetDelayMs(
+  const DownlinkQueue * inQueue,
+  uint8_t inClass,
+  uint16_t * outAverageMs,
+  uint16_t * outMaxMs)
+{
+  *outAverageMs = 0 ;
+  *outMaxMs = 0 ;
+
+  if (inClass >= kDownlinkClassCount)
+  {
+    return ;
+  }
+
+  const DownlinkStats * theStats = &inQueue->pStats[inClass] ;
+  uint32_t theAverageMs = 0 ;
+  if (theStats->pSent > 0)
+  {
+    theAverageMs = (uint32_t)(theStats->pDelayTotalUs / theStats->pSent / 1000) ;
+  }
+  uint32_t theMaxMs = theStats->pDelayMaxUs / 1000 ;
+
+  *outAverageMs = (theAverageMs > 0xFFFF) ? 0xFFFF : (uint16_t)theAverageMs ;
+  *outMaxMs = (theMaxMs > 0xFFFF) ? 0xFFFF : (uint16_t)theMaxMs ;
+}
@@ -0,0 +1,342 @@
+//----------------------------------------------
+// Module: event_journal.c
+// Description: Flash-backed journal of flight
+//   events, resent on telemetry until ACKed
+// Author: Mark Gavin
+// Created: 2026-02-15
+// Copyright: (c) 2025-2026 by Mark Gavin
+// License: Proprietary - All Rights Reserved
+//----------------------------------------------
+
+#include "event_journal.h"
+#include "flight_control.h"
+#include "crc32.h"
+
+#include "pico/stdlib.h"
+#include "hardware/flash.h"
+#include "hardware/sync.h"
+
+#include <string.h>
+
+#define kJournalRecords         (FLASH_SECTOR_SIZE / kJournalRecordSize)
+#define kRecordCrcOffset        20
+
+//----------------------------------------------
+// Internal: Record pointer (memory-mapped)
+//----------------------------------------------
+static const uint8_t * RecordPtr(uint16_t inRecord)
+{
+  return (const uint8_t *)(XIP_BASE + kEventJournalOffset + inRecord * kJournalRecordSize) ;
+}
+
+//----------------------------------------------
+// Internal: Record CRC
+// Covers every byte before the CRC except the
+// ACK mark, which is programmed later.
+//----------------------------------------------
+static uint32_t RecordCrc(const uint8_t * inRecord)
+{
+  uint8_t theCopy[kRecordCrcOffset] ;
+  memcpy(theCopy, inRecord, sizeof(theCopy)) ;
+  theCopy[1] = 0xFF ;
+  return Crc32_Compute(theCopy, sizeof(theCopy)) ;
+}
+
+//----------------------------------------------
+// Internal: Program part of one page
+// Bytes outside the range stay 0xFF, which
+// leaves the flash under them unchanged.
+//----------------------------------------------
+static void ProgramInPage(uint32_t inFlashOffset, const uint8_t * inData, uint32_t inSize)
+{
+  uint8_t thePage[FLASH_PAGE_SIZE] ;
+  uint32_t thePageOffset = inFlashOffset & ~(FLASH_PAGE_SIZE - 1) ;
+
+  memset(thePage, 0xFF, sizeof(thePage)) ;
+  memcpy(thePage + (inFlashOffset - thePageOffset), inData, inSize) ;
+
+  uint32_t theInterrupts = save_and_disable_interrupts() ;
+  flash_range_program(thePageOffset, thePage, FLASH_PAGE_SIZE) ;
+  restore_interrupts(theInterrupts) ;
+}
+
+//----------------------------------------------
+// Internal: Write an event as the next record
+//----------------------------------------------
+static void WriteRecord(EventJournal * ioJournal, JournalEvent * ioEvent)
+{
+  uint8_t theRecord[kJournalRecordSize] ;
+  memset(theRecord, 0xFF, sizeof(theRecord)) ;
+
+  theRecord[0] = kJournalRecordMarker ;
+  theRecord[1] = ioEvent->pAcked ? 0x00 : 0xFF ;
+  theRecord[2] = ioEvent->pSequence ;
+  theRecord[3] = ioEvent->pType ;
+  theRecord[4] = ioEvent->pState ;
+  memcpy(&theRecord[8], &ioEvent->pTimeMs, 4) ;
+  memcpy(&theRecord[12], &ioEvent->pAltitudeDm, 4) ;
+  memcpy(&theRecord[16], &ioEvent->pVelocityDms, 2) ;
+  uint32_t theCrc = RecordCrc(theRecord) ;
+  memcpy(&theRecord[kRecordCrcOffset], &theCrc, 4) ;
+
+  ProgramInPage(kEventJournalOffset + ioJournal->pNextRecord * kJournalRecordSize,
+    theRecord, sizeof(theRecord)) ;
+
+  ioEvent->pRecord = ioJournal->pNextRecord++ ;
+  ioEvent->pStored = true ;
+  ioEvent->pAckStored = ioEvent->pAcked ;
+}
+
+//----------------------------------------------
+// Internal: Compact the sector
+// Erases it and writes back the events in RAM.
+//----------------------------------------------
+static void Compact(EventJournal * ioJournal)
+{
+  stdio_flush() ;
+
+  uint32_t theInterrupts = save_and_disable_interrupts() ;
+  flash_range_erase(kEventJournalOffset, FLASH_SECTOR_SIZE) ;
+  restore_interrupts(theInterrupts) ;
+
+  ioJournal->pNextRecord = 0 ;
+  for (uint8_t i = 0 ; i < ioJournal->pCount ; i++)
+  {
+    WriteRecord(ioJournal, &ioJournal->pEvents[(ioJournal->pHead + i) % kJournalSize]) ;
+  }
+}
+
+//----------------------------------------------
+// Internal: Add an event after the newest
+// Returns: The new slot (the oldest is pushed
+//   out when the journal is full)
+//----------------------------------------------
+static JournalEvent * Append(EventJournal * ioJournal)
+{
+  if (ioJournal->pCount == kJournalSize)
+  {
+    if (!ioJournal->pEvents[ioJournal->pHead].pAcked)
+    {
+      ioJournal->pDropped++ ;
+    }
+    ioJournal->pHead = (uint8_t)((ioJournal->pHead + 1) % kJournalSize) ;
+    ioJournal->pCount-- ;
+  }
+
+  JournalEvent * theEvent = &ioJournal->pEvents[(ioJournal->pHead + ioJournal->pCount) % kJournalSize] ;
+  memset(theEvent, 0, sizeof(JournalEvent)) ;
+  ioJournal->pCount++ ;
+  return theEvent ;
+}
+
+//----------------------------------------------
+// Internal: Event type for a state change
+//----------------------------------------------
+static uint8_t EventType(uint8_t inFrom, uint8_t inTo)
+{
+  switch (inTo)
+  {
+    case kFlightIdle:     return inFrom == kFlightArmed ? kEventDisarmed : kEventReset ;
+    case kFlightArmed:    return kEventArmed ;
+    case kFlightBoost:    return kEventLaunch ;
+    case kFlightCoast:    return kEventBurnout ;
+    case kFlightApogee:   return kEventApogee ;
+    case kFlightDescent:  return kEventDescent ;
+    case kFlightLanded:   return kEventLanded ;
+    default:              return kEventComplete ;
+  }
+}
+
+//----------------------------------------------
+// Function: EventJournal_Init
+//----------------------------------------------
+bool EventJournal_Init(EventJournal * outJournal)
+{
+  memset(outJournal, 0, sizeof(EventJournal)) ;
+
+  // Load every good record; the newest kJournalSize
+  // stay in RAM
+  bool theAny = false ;
+  uint16_t theRecord = 0 ;
+  for ( ; theRecord < kJournalRecords ; theRecord++)
+  {
+    const uint8_t * thePtr = RecordPtr(theRecord) ;
+    if (thePtr[0] == 0xFF)
+    {
+      break ;
+    }
+
+    uint32_t theCrc ;
+    memcpy(&theCrc, &thePtr[kRecordCrcOffset], 4) ;
+    if (thePtr[0] != kJournalRecordMarker || theCrc != RecordCrc(thePtr))
+    {
+      continue ;  // Torn record
+    }
+
+    JournalEvent * theEvent = Append(outJournal) ;
+    theEvent->pSequence = thePtr[2] ;
+    theEvent->pType = thePtr[3] ;
+    theEvent->pState = thePtr[4] ;
+    memcpy(&theEvent->pTimeMs, &thePtr[8], 4) ;
+    memcpy(&theEvent->pAltitudeDm, &thePtr[12], 4) ;
+    memcpy(&theEvent->pVelocityDms, &thePtr[16], 2) ;
+    theEvent->pAcked = thePtr[1] != 0xFF ;
+    theEvent->pStored = true ;
+    theEvent->pAckStored = theEvent->pAcked ;
+    theEvent->pRecord = theRecord ;
+    outJournal->pNextSequence = (uint8_t)(thePtr[2] + 1) ;
+    theAny = true ;
+  }
+  outJournal->pNextRecord = theRecord ;
+  outJournal->pDropped = 0 ;
+
+  // A sector that is filling up, or that was never
+  // erased for the journal, starts over now rather
+  // than on the pad
+  if (outJournal->pNextRecord > kJournalCompactRecords ||
+      (!theAny && outJournal->pNextRecord > 0))
+  {
+    Compact(outJournal) ;
+  }
+
+  outJournal->pFlashOk = outJournal->pNextRecord < kJournalRecords ;
+  return outJournal->pFlashOk ;
+}
+
+//----------------------------------------------
+// Function: EventJournal_NoteState
+//----------------------------------------------
+bool EventJournal_NoteState(
+  EventJournal * ioJournal,
+  uint8_t inState,
+  uint32_t inTimeMs,
+  float inAltitudeM,
+  float inVelocityMps)
+{
+  if (!ioJournal->pStateValid || inState == ioJournal->pLastState)
+  {
+    ioJournal->pStateValid = true ;
+    ioJournal->pLastState = inState ;
+    return false ;
+  }
+
+  JournalEvent * theEvent = Append(ioJournal) ;
+  theEvent->pSequence = ioJournal->pNextSequence++ ;
+  theEvent->pType = EventType(ioJournal->pLastState, inState) ;
+  theEvent->pState = inState ;
+  theEvent->pTimeMs = inTimeMs ;
+  theEvent->pAltitudeDm = (int32_t)(inAltitudeM * 10.0f) ;
+
+  float theVelocityDms = inVelocityMps * 10.0f ;
+  theEvent->pVelocityDms = theVelocityDms > INT16_MAX ? INT16_MAX :
+    theVelocityDms < INT16_MIN ? INT16_MIN : (int16_t)theVelocityDms ;
+
+  ioJournal->pLastState = inState ;
+  ioJournal->pRecorded++ ;
+  return true ;
+}
+
+//----------------------------------------------
+// Function: EventJournal_Flush
+//----------------------------------------------
+void EventJournal_Flush(EventJournal * ioJournal)
+{
+  if (!ioJournal->pFlashOk)
+  {
+    return ;
+  }
+
+  for (uint8_t i = 0 ; i < ioJournal->pCount ; i++)
+  {
+    JournalEvent * theEvent = &ioJournal->pEvents[(ioJournal->pHead + i) % kJournalSize] ;
+    if (!theEvent->pStored)
+    {
+      if (ioJournal->pNextRecord >= kJournalRecords)
+      {
+        Compact(ioJournal) ;
+        return ;
+      }
+      WriteRecord(ioJournal, theEvent) ;
+    }
+    else if (theEvent->pAcked && !theEvent->pAckStored)
+    {
+      uint8_t theMark = 0x00 ;
+      ProgramInPage(kEventJournalOffset + theEvent->pRecord * kJournalRecordSize + 1, &theMark, 1) ;
+      theEvent->pAckStored = true ;
+    }
+  }
+}
+
+//----------------------------------------------
+// Function: EventJournal_GetPending
+//----------------------------------------------
+const JournalEvent * EventJournal_GetPending(const EventJournal * inJournal)
+{
+  for (uint8_t i = 0 ; i < inJournal->pCount ; i++)
+  {
+    const JournalEvent * theEvent = &inJournal->pEvents[(inJournal->pHead + i) % kJournalSize] ;
+    if (!theEvent->pAcked)
+    {
+      return theEvent ;
+    }
+  }
+  return NULL ;
+}
+
+//----------------------------------------------
+// Function: EventJournal_BuildTrailer
+//----------------------------------------------
+uint8_t EventJournal_BuildTrailer(
+  EventJournal * ioJournal,
+  uint8_t * outTrailer,
+  uint8_t inMaxLen)
+{
+  const JournalEvent * theEvent = EventJournal_GetPending(ioJournal) ;
+  if (theEvent == NULL || inMaxLen < kEventTrailerLen)
+  {
+    return 0 ;
+  }
+
+  outTrailer[0] = theEvent->pSequence ;
+  outTrailer[1] = theEvent->pType ;
+  outTrailer[2] = theEvent->pState ;
+  outTrailer[3] = theEvent->pTimeMs & 0xFF ;
+  outTrailer[4] = (theEvent->pTimeMs >> 8) & 0xFF ;
+  outTrailer[5] = (theEvent->pTimeMs >> 16) & 0xFF ;
+  outTrailer[6] = (theEvent->pTimeMs >> 24) & 0xFF ;
+  outTrailer[7] = theEvent->pAltitudeDm & 0xFF ;
+  outTrailer[8] = (theEvent->pAltitudeDm >> 8) & 0xFF ;
+  outTrailer[9] = (theEvent->pAltitudeDm >> 16) & 0xFF ;
+  outTrailer[10] = (theEvent->pAltitudeDm >> 24) & 0xFF ;
+  outTrailer[11] = theEvent->pVelocityDms & 0xFF ;
+  outTrailer[12] = (theEvent->pVelocityDms >> 8) & 0xFF ;
+  outTrailer[13] = LoRaProtocol_Crc8(outTrailer, 13) ;
+  outTrailer[14] = kEventTrailerTag ;
+
+  ioJournal->pTrailersSent++ ;
+  return kEventTrailerLen ;
+}
+
+//----------------------------------------------
+// Function: EventJournal_Acknowledge
+//----------------------------------------------
+uint8_t EventJournal_Acknowledge(EventJournal * ioJournal, uint8_t inSequence)
+{
+  // Only the oldest unacknowledged event has been on
+  // air; any other sequence is a stale ACK, not ours
+  for (uint8_t i = 0 ; i < ioJournal->pCount ; i++)
+  {
+    JournalEvent * theEvent = &ioJournal->pEvents[(ioJournal->pHead + i) % kJournalSize] ;
+    if (!theEvent->pAcked)
+    {
+      if (theEvent->pSequence != inSequence)
+      {
+        return 0 ;
+      }
+      theEvent->pAcked = true ;
+      ioJournal->pAcked++ ;
+      return 1 ;
+    }
+  }
+  return 0 ;
+}
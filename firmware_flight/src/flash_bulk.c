@@ -0,0 +1,316 @@
+//----------------------------------------------
+// Module: flash_bulk.c
+// Description: Sliding-window bulk download of a
+//   stored flight over LoRa (sender side)
+// Author: Mark Gavin
+// Created: 2026-02-13
+// Copyright: (c) 2025-2026 by Mark Gavin
+// License: Proprietary - All Rights Reserved
+// Modified: 2026-02-16 (delta-coded runs, transfer rate)
+//----------------------------------------------
+
+#include "flash_bulk.h"
+#include "flight_control.h"
+
+#include <string.h>
+
+_Static_assert(kBulkChunkMaxLen <= 255, "Chunk must fit one LoRa packet") ;
+_Static_assert(kBulkHeaderLen + kBulkSampleLen + (kBulkSamplesPerChunk - 1) * 68 <= kBulkChunkMaxLen,
+  "A chunk must fit delta-coded at its worst") ;
+
+//----------------------------------------------
+// Internal: Has Chunk To Send
+// A resend is pending, or the window has room
+// for a new chunk
+//----------------------------------------------
+static bool HasChunkToSend(const FlashBulkState * inState)
+{
+  return inState->pMissing != 0 ||
+    (inState->pNext < inState->pChunkCount &&
+     inState->pNext - inState->pBase < kBulkWindowChunks) ;
+}
+
+//----------------------------------------------
+// Internal: Build Packet
+// Put up to inMaxRun chunks from inFirst into one
+// packet, as many as fit whole. Returns the
+// length (0 on a flash read error) and the
+// chunks it holds.
+//----------------------------------------------
+static uint8_t BuildPacket(
+  const FlashBulkState * inState,
+  uint8_t inRocketId,
+  uint16_t inFirst,
+  uint8_t inMaxRun,
+  uint8_t * outPacket,
+  uint8_t * outRun)
+{
+  outPacket[0] = kLoRaMagic ;
+  outPacket[1] = kLoRaPacketFlashBulk ;
+  outPacket[2] = inRocketId ;
+  outPacket[3] = inState->pSlot ;
+  outPacket[4] = inState->pSession ;
+  outPacket[5] = 0 ;
+  outPacket[6] = inFirst & 0xFF ;
+  outPacket[7] = (inFirst >> 8) & 0xFF ;
+  outPacket[8] = inState->pSampleCount & 0xFF ;
+  outPacket[9] = (inState->pSampleCount >> 8) & 0xFF ;
+
+  FlightSample theSample ;
+  FlightSample thePrevious ;
+  uint8_t theLen = kBulkHeaderLen ;
+  uint8_t theRun = 0 ;
+
+  while (theRun < inMaxRun)
+  {
+    uint32_t theStart = (uint32_t)(inFirst + theRun) * kBulkSamplesPerChunk ;
+    uint32_t theCount = inState->pSampleCount - theStart ;
+    if (theCount > kBulkSamplesPerChunk)
+    {
+      theCount = kBulkSamplesPerChunk ;
+    }
+
+    // A chunk goes whole or not at all
+    uint8_t theChunkLen = theLen ;
+    for (uint32_t i = 0 ; i < theCount && theChunkLen != 0 ; i++)
+    {
+      if (!FlightStorage_GetSample(inState->pSlot, theStart + i, &theSample))
+      {
+        return 0 ;
+      }
+
+      if (theChunkLen == kBulkHeaderLen)
+      {
+        memcpy(&outPacket[theChunkLen], &theSample, sizeof(FlightSample)) ;
+        theChunkLen += sizeof(FlightSample) ;
+      }
+      else
+      {
+        theChunkLen = LoRaProtocol_PutSampleDelta(outPacket, theChunkLen, kBulkChunkMaxLen,
+          (const uint8_t *)&thePrevious, (const uint8_t *)&theSample) ;
+      }
+      thePrevious = theSample ;
+    }
+    if (theChunkLen == 0)
+    {
+      break ;
+    }
+
+    theLen = theChunkLen ;
+    theRun++ ;
+  }
+
+  outPacket[10] = theRun ;
+  *outRun = theRun ;
+  return theLen ;
+}
+
+//----------------------------------------------
+// Function: FlashBulk_Start
+//----------------------------------------------
+bool FlashBulk_Start(
+  FlashBulkState * outState,
+  uint8_t inSlot,
+  uint8_t inSession,
+  uint32_t inSampleCount,
+  uint8_t inRate)
+{
+  memset(outState, 0, sizeof(FlashBulkState)) ;
+
+  if (inSampleCount == 0 || inSampleCount > 0xFFFF)
+  {
+    return false ;
+  }
+
+  outState->pActive = true ;
+  outState->pSlot = inSlot ;
+  outState->pSession = inSession ;
+  outState->pSampleCount = (uint16_t)inSampleCount ;
+  outState->pChunkCount = (uint16_t)((inSampleCount + kBulkSamplesPerChunk - 1) / kBulkSamplesPerChunk) ;
+  outState->pBurstLeft = kBulkBurstChunks ;
+  outState->pRate = inRate ;
+  return true ;
+}
+
+//----------------------------------------------
+// Function: FlashBulk_ProcessAck
+//----------------------------------------------
+bool FlashBulk_ProcessAck(
+  FlashBulkState * ioState,
+  const uint8_t * inParams,
+  uint8_t inLen)
+{
+  if (!ioState->pActive || !ioState->pAwaitingAck || inLen < 8 ||
+      inParams[0] != ioState->pSlot || inParams[1] != ioState->pSession)
+  {
+    return false ;
+  }
+
+  uint16_t theBase = (uint16_t)(inParams[2] | (inParams[3] << 8)) ;
+  uint32_t theBitmap = (uint32_t)inParams[4] |
+    ((uint32_t)inParams[5] << 8) |
+    ((uint32_t)inParams[6] << 16) |
+    ((uint32_t)inParams[7] << 24) ;
+
+  // The gateway cannot be ahead of what was sent
+  // or behind what it acknowledged before
+  if (theBase < ioState->pBase || theBase > ioState->pNext)
+  {
+    return false ;
+  }
+
+  ioState->pBase = theBase ;
+  ioState->pAwaitingAck = false ;
+  ioState->pPolls = 0 ;
+  ioState->pBurstLeft = kBulkBurstChunks ;
+
+  if (theBase >= ioState->pChunkCount)
+  {
+    ioState->pActive = false ;
+    return true ;
+  }
+
+  // Every chunk sent was on air before the poll
+  // was answered, so any gap in the bitmap is lost
+  ioState->pMissing = 0 ;
+  for (uint16_t theChunk = theBase ; theChunk < ioState->pNext ; theChunk++)
+  {
+    uint32_t theBit = 1u << (theChunk - theBase) ;
+    if ((theBitmap & theBit) == 0)
+    {
+      ioState->pMissing |= theBit ;
+    }
+  }
+
+  return true ;
+}
+
+//----------------------------------------------
+// Function: FlashBulk_NextPacket
+//----------------------------------------------
+uint8_t FlashBulk_NextPacket(
+  FlashBulkState * ioState,
+  uint8_t inRocketId,
+  uint32_t inNowMs,
+  uint8_t * outPacket,
+  uint8_t inMaxLen)
+{
+  if (!ioState->pActive || inMaxLen < kBulkChunkMaxLen)
+  {
+    return 0 ;
+  }
+
+  uint16_t theFirst ;
+  uint8_t theMaxRun ;
+  bool theRepeat = false ;
+  bool theResend = false ;
+
+  if (ioState->pAwaitingAck)
+  {
+    // Poll outstanding: wait, then repeat it
+    if ((inNowMs - ioState->pPollMs) < kBulkAckTimeoutMs)
+    {
+      return 0 ;
+    }
+
+    if (ioState->pPolls >= kBulkMaxPolls)
+    {
+      ioState->pActive = false ;
+      return 0 ;
+    }
+
+    ioState->pPolls++ ;
+    ioState->pPollMs = inNowMs ;
+    theFirst = ioState->pPolledChunk ;
+    theMaxRun = ioState->pPolledRun ;
+    theRepeat = true ;
+  }
+  else if (ioState->pMissing != 0)
+  {
+    // Lost chunks first, a run of them together
+    uint8_t theBit = 0 ;
+    while ((ioState->pMissing & (1u << theBit)) == 0)
+    {
+      theBit++ ;
+    }
+    theFirst = ioState->pBase + theBit ;
+    theMaxRun = 0 ;
+    while (theMaxRun < kBulkMaxRun && theBit + theMaxRun < kBulkWindowChunks &&
+           (ioState->pMissing & (1u << (theBit + theMaxRun))) != 0)
+    {
+      theMaxRun++ ;
+    }
+    theResend = true ;
+  }
+  else if (HasChunkToSend(ioState))
+  {
+    theFirst = ioState->pNext ;
+    uint16_t theRoom = kBulkWindowChunks - (ioState->pNext - ioState->pBase) ;
+    if (theRoom > ioState->pChunkCount - ioState->pNext)
+    {
+      theRoom = ioState->pChunkCount - ioState->pNext ;
+    }
+    theMaxRun = theRoom < kBulkMaxRun ? (uint8_t)theRoom : kBulkMaxRun ;
+  }
+  else
+  {
+    // Window full and nothing lost: only a poll
+    // can move it on
+    theFirst = ioState->pNext - 1 ;
+    theMaxRun = 1 ;
+    theResend = true ;
+    ioState->pBurstLeft = 1 ;
+  }
+
+  if (!theRepeat && theMaxRun > ioState->pBurstLeft)
+  {
+    theMaxRun = ioState->pBurstLeft ;
+  }
+
+  uint8_t theRun = 0 ;
+  uint8_t theLen = BuildPacket(ioState, inRocketId, theFirst, theMaxRun, outPacket, &theRun) ;
+  if (theLen == 0)
+  {
+    ioState->pActive = false ;
+    return 0 ;
+  }
+
+  ioState->pChunksSent += theRun ;
+  ioState->pPacketsSent++ ;
+  if (theRepeat)
+  {
+    ioState->pRetransmits += theRun ;
+    outPacket[5] |= kBulkFlagPoll ;
+    return theLen ;
+  }
+
+  if (theResend)
+  {
+    for (uint8_t i = 0 ; i < theRun ; i++)
+    {
+      uint16_t theBit = theFirst + i - ioState->pBase ;
+      if (theBit < kBulkWindowChunks)
+      {
+        ioState->pMissing &= ~(1u << theBit) ;
+      }
+    }
+    ioState->pRetransmits += theRun ;
+  }
+  else
+  {
+    ioState->pNext += theRun ;
+  }
+
+  ioState->pBurstLeft -= theRun ;
+  if (ioState->pBurstLeft == 0 || !HasChunkToSend(ioState))
+  {
+    ioState->pAwaitingAck = true ;
+    ioState->pPolledChunk = theFirst ;
+    ioState->pPolledRun = theRun ;
+    ioState->pPollMs = inNowMs ;
+    ioState->pPolls = 1 ;
+    outPacket[5] |= kBulkFlagPoll ;
+  }
+
+  return theLen ;
+}
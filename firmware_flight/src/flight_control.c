@@ -5,6 +5,10 @@
 // Created: 2026-01-10
 // Copyright: (c) 2025-2026 by Mark Gavin
 // License: Proprietary - All Rights Reserved
+// Modified: 2026-02-10 (compact telemetry frame)
+// Modified: 2026-02-11 (batched high-rate telemetry)
+// Modified: 2026-02-15 (telemetry profiles and recovery beacon)
+// Modified: 2026-02-15 (shared table CRC-8)
 //----------------------------------------------
 
 #include "flight_control.h"
@@ -45,6 +49,19 @@
 #define kApogeeDescendCount     3           // Consecutive descending samples for apogee
 #define kLandingStationaryCount 50          // 5 seconds at 10 Hz
 
+// Worst-case encoded size of one batch sample
+// (time step, altitude, velocity, accel varints)
+#define kBatchSampleMaxLen      16
+
+//----------------------------------------------
+// Compact Frame Bit Writer
+//----------------------------------------------
+typedef struct
+{
+  uint8_t * pData ;               // Zeroed output buffer
+  uint16_t pBitPos ;              // Next bit to write
+} BitWriter ;
+
 //----------------------------------------------
 // State Name Table
 //----------------------------------------------
@@ -112,29 +129,133 @@ static float CalculateVelocity(
 }
 
 //----------------------------------------------
-// Internal: CRC-8 Calculation
+// Internal: PutBits
+// Append the low inBits of inValue, LSB first
 //----------------------------------------------
-static uint8_t CalculateCrc8(const uint8_t * inData, size_t inLen)
+static void PutBits(BitWriter * ioWriter, uint32_t inValue, uint8_t inBits)
 {
-  uint8_t theCrc = 0xFF ;
-
-  for (size_t i = 0 ; i < inLen ; i++)
+  for (uint8_t i = 0 ; i < inBits ; i++)
   {
-    theCrc ^= inData[i] ;
-    for (int j = 0 ; j < 8 ; j++)
+    if (inValue & (1UL << i))
     {
-      if (theCrc & 0x80)
-      {
-        theCrc = (theCrc << 1) ^ 0x31 ;
-      }
-      else
-      {
-        theCrc <<= 1 ;
-      }
+      ioWriter->pData[ioWriter->pBitPos >> 3] |= (uint8_t)(1 << (ioWriter->pBitPos & 7)) ;
     }
+    ioWriter->pBitPos++ ;
+  }
+}
+
+//----------------------------------------------
+// Internal: PutUnsigned
+// Append a value saturated to 0..2^inBits-1
+//----------------------------------------------
+static void PutUnsigned(BitWriter * ioWriter, int32_t inValue, uint8_t inBits)
+{
+  int32_t theMax = (int32_t)((1UL << inBits) - 1) ;
+
+  if (inValue < 0)
+  {
+    inValue = 0 ;
+  }
+  else if (inValue > theMax)
+  {
+    inValue = theMax ;
+  }
+  PutBits(ioWriter, (uint32_t)inValue, inBits) ;
+}
+
+//----------------------------------------------
+// Internal: PutSigned
+// Append a two's complement value saturated to
+// the range of inBits
+//----------------------------------------------
+static void PutSigned(BitWriter * ioWriter, int32_t inValue, uint8_t inBits)
+{
+  int32_t theMax = (int32_t)((1UL << (inBits - 1)) - 1) ;
+
+  if (inValue > theMax)
+  {
+    inValue = theMax ;
   }
+  else if (inValue < -theMax - 1)
+  {
+    inValue = -theMax - 1 ;
+  }
+  PutBits(ioWriter, (uint32_t)inValue & ((1UL << inBits) - 1), inBits) ;
+}
+
+//----------------------------------------------
+// Internal: BuildStatusFlags
+// Flags byte shared by both telemetry formats
+//----------------------------------------------
+static uint8_t BuildStatusFlags(const FlightController * inController, const GpsData * inGps)
+{
+  uint8_t theFlags = inController->pStatusFlags ;
+
+  if (inGps != NULL && inGps->pValid)
+  {
+    theFlags |= kFlagGpsFix ;
+  }
+  if (inController->pOrientationMode)
+  {
+    theFlags |= kFlagOrientationMode ;
+  }
+  return theFlags ;
+}
+
+//----------------------------------------------
+// Internal: PutVarint
+// Append an unsigned varint, returns new length
+//----------------------------------------------
+static uint8_t PutVarint(uint8_t * outData, uint8_t inLen, uint32_t inValue)
+{
+  while (inValue >= 0x80)
+  {
+    outData[inLen++] = (uint8_t)(inValue | 0x80) ;
+    inValue >>= 7 ;
+  }
+  outData[inLen++] = (uint8_t)inValue ;
+  return inLen ;
+}
+
+//----------------------------------------------
+// Internal: ZigZag
+// Map a signed delta so small magnitudes of either
+// sign become small unsigned values
+//----------------------------------------------
+static uint32_t ZigZag(int32_t inValue)
+{
+  return ((uint32_t)inValue << 1) ^ (uint32_t)(inValue >> 31) ;
+}
 
-  return theCrc ;
+//----------------------------------------------
+// Internal: ClampInt16
+//----------------------------------------------
+static int16_t ClampInt16(float inValue)
+{
+  if (inValue > 32767.0f) return 32767 ;
+  if (inValue < -32768.0f) return -32768 ;
+  return (int16_t)inValue ;
+}
+
+//----------------------------------------------
+// Internal: RecordBatchSample
+// Append the current estimate to the sample ring,
+// overwriting the oldest unsent sample when full
+//----------------------------------------------
+static void RecordBatchSample(FlightController * ioController, uint32_t inCurrentTimeMs)
+{
+  BatchSample * theSample = &ioController->pBatchRing[ioController->pBatchHead] ;
+
+  theSample->pTimeMs = inCurrentTimeMs ;
+  theSample->pAltitudeDm = (int32_t)(ioController->pCurrentAltitudeM * 10.0f) ;
+  theSample->pVelocityDms = ClampInt16(ioController->pCurrentVelocityMps * 10.0f) ;
+  theSample->pAccelDms2 = ClampInt16(ioController->pVerticalAccelMps2 * 10.0f) ;
+
+  ioController->pBatchHead = (ioController->pBatchHead + 1) % kBatchRingSize ;
+  if (ioController->pBatchPending < kBatchRingSize)
+  {
+    ioController->pBatchPending++ ;
+  }
 }
 
 //----------------------------------------------
@@ -154,6 +275,7 @@ void FlightControl_Init(
   ioController->pSamples = inSampleBuffer ;
   ioController->pMaxSamples = inMaxSamples ;
   ioController->pSampleCount = 0 ;
+  FlightControl_SetTelemetryProfile(ioController, kTelemetryProfileDefaults, 0) ;
 }
 
 //----------------------------------------------
@@ -251,6 +373,8 @@ void FlightControl_UpdateSensors(
     }
   }
 
+  RecordBatchSample(ioController, inCurrentTimeMs) ;
+
   ioController->pLastSampleTimeMs = inCurrentTimeMs ;
 }
 
@@ -292,6 +416,7 @@ void FlightControl_UpdateImu(
   // Then subtract learned bias to cancel sensor offset
   float theVerticalAccelMps2 = (inImuData->pAccelZ - 1.0f) * kGravityMps2
                                - ioController->pCfAccelBiasMps2 ;
+  ioController->pVerticalAccelMps2 = theVerticalAccelMps2 ;
 
   // Integrate: velocity += accel * dt, altitude += velocity * dt
   ioController->pCfVelocityMps += theVerticalAccelMps2 * theDtS ;
@@ -635,61 +760,392 @@ uint8_t FlightControl_BuildTelemetryPacket(
   }
 
   outPacket->pState = (uint8_t)inController->pState ;
-
-  // Build status flags
-  uint8_t theFlags = inController->pStatusFlags ;
-  if (theGps != NULL && theGps->pValid)
-  {
-    theFlags |= kFlagGpsFix ;
-  }
-  if (inController->pOrientationMode)
-  {
-    theFlags |= kFlagOrientationMode ;
-  }
-  outPacket->pFlags = theFlags ;
+  outPacket->pFlags = BuildStatusFlags(inController, theGps) ;
 
   // Calculate CRC (excluding CRC field itself)
-  outPacket->pCrc = CalculateCrc8((const uint8_t *)outPacket, sizeof(LoRaTelemetryPacket) - 1) ;
+  outPacket->pCrc = LoRaProtocol_Crc8((const uint8_t *)outPacket, sizeof(LoRaTelemetryPacket) - 1) ;
 
   return sizeof(LoRaTelemetryPacket) ;
 }
 
 //----------------------------------------------
-// Function: FlightControl_ShouldSendTelemetry
+// Function: FlightControl_BuildCompactTelemetryPacket
 //----------------------------------------------
-bool FlightControl_ShouldSendTelemetry(
-  const FlightController * inController,
-  uint32_t inCurrentTimeMs)
+uint8_t FlightControl_BuildCompactTelemetryPacket(
+  FlightController * ioController,
+  const ImuData * inImuData,
+  uint8_t inRocketId,
+  uint8_t * outPacket)
 {
-  // During active flight: send at full rate (10 Hz)
-  if (inController->pState >= kFlightBoost && inController->pState <= kFlightDescent)
+  memset(outPacket, 0, kCompactTelemetryMaxLen) ;
+
+  BitWriter theWriter = { outPacket, 0 } ;
+  const GpsData * theGps = GPS_GetData() ;
+  bool theHasFix = (theGps != NULL && theGps->pValid) ;
+  bool theOriginMoved = false ;
+  int32_t theDeltaLat = 0 ;
+  int32_t theDeltaLon = 0 ;
+
+  // Track the GPS origin: first fix, then the launch
+  // position once armed, then only on offset overflow
+  if (ioController->pState == kFlightIdle)
+  {
+    ioController->pGpsOriginLatched = false ;
+  }
+  if (theHasFix)
+  {
+    int32_t theLat = (int32_t)(theGps->pLatitude * 1000000.0f) ;
+    int32_t theLon = (int32_t)(theGps->pLongitude * 1000000.0f) ;
+    bool theMove = !ioController->pGpsOriginValid ||
+      (ioController->pState != kFlightIdle && !ioController->pGpsOriginLatched) ;
+
+    if (!theMove)
+    {
+      theDeltaLat = (theLat - ioController->pGpsOriginLat) / 10 ;
+      theDeltaLon = (theLon - ioController->pGpsOriginLon) / 10 ;
+      theMove = (theDeltaLat < INT16_MIN || theDeltaLat > INT16_MAX ||
+                 theDeltaLon < INT16_MIN || theDeltaLon > INT16_MAX) ;
+    }
+
+    if (theMove)
+    {
+      ioController->pGpsOriginLat = theLat ;
+      ioController->pGpsOriginLon = theLon ;
+      ioController->pGpsOriginEpoch++ ;
+      ioController->pGpsOriginValid = true ;
+      ioController->pGpsOriginLatched = (ioController->pState != kFlightIdle) ;
+      theOriginMoved = true ;
+      theDeltaLat = 0 ;
+      theDeltaLon = 0 ;
+    }
+  }
+
+  // Choose sections
+  bool theHighRate = ioController->pOrientationMode ||
+    (ioController->pState >= kFlightBoost && ioController->pState <= kFlightDescent) ;
+  uint8_t theSections = 0 ;
+  if (theHasFix)
+  {
+    theSections |= kCompactHasGps ;
+  }
+  if (ioController->pOrientationMode && inImuData != NULL)
+  {
+    theSections |= kCompactHasOrientation ;
+  }
+  if (theOriginMoved || !theHighRate ||
+      (ioController->pTelemetrySequence % kCompactSlowInterval) == 0)
+  {
+    theSections |= kCompactHasSlow ;
+  }
+
+  // Core
+  uint32_t theTimeMs = 0 ;
+  if (ioController->pLaunchTimeMs > 0)
   {
-    return (inCurrentTimeMs - inController->pLastTelemetryTimeMs) >= kTelemetryIntervalMs ;
+    theTimeMs = ioController->pLastSampleTimeMs - ioController->pLaunchTimeMs ;
   }
 
-  // When armed: send at 2 Hz (ready for launch, conserve battery)
-  if (inController->pState == kFlightArmed)
+  PutBits(&theWriter, kLoRaMagicCompact, 8) ;
+  PutBits(&theWriter, inRocketId, 4) ;
+  PutBits(&theWriter, ioController->pTelemetrySequence, 8) ;
+  PutBits(&theWriter, (uint32_t)ioController->pState, 3) ;
+  PutBits(&theWriter, BuildStatusFlags(ioController, theGps), 8) ;
+  PutBits(&theWriter, theSections, 3) ;
+  PutUnsigned(&theWriter, (int32_t)(theTimeMs / 10), 18) ;
+  PutSigned(&theWriter, (int32_t)(ioController->pCurrentAltitudeM * 10.0f), 19) ;
+  PutSigned(&theWriter, (int32_t)(ioController->pCurrentVelocityMps * 10.0f), 15) ;
+  PutUnsigned(&theWriter, (int32_t)ioController->pCurrentPressurePa, 17) ;
+
+  // Accelerometer: g to 20 mg steps
+  if (inImuData != NULL)
   {
-    return (inCurrentTimeMs - inController->pLastTelemetryTimeMs) >= 500 ;
+    PutSigned(&theWriter, (int32_t)(inImuData->pAccelX * 50.0f), 12) ;
+    PutSigned(&theWriter, (int32_t)(inImuData->pAccelY * 50.0f), 12) ;
+    PutSigned(&theWriter, (int32_t)(inImuData->pAccelZ * 50.0f), 12) ;
+  }
+  else
+  {
+    theWriter.pBitPos += 36 ;
   }
 
-  // In idle: rate depends on orientation mode
-  if (inController->pState == kFlightIdle)
+  // GPS offset from the origin (1e-5 deg)
+  if (theSections & kCompactHasGps)
   {
-    if (inController->pOrientationMode)
+    PutBits(&theWriter, ioController->pGpsOriginEpoch, 2) ;
+    PutSigned(&theWriter, theDeltaLat, 16) ;
+    PutSigned(&theWriter, theDeltaLon, 16) ;
+  }
+
+  // Orientation: gyro in dps, mag in milligauss
+  if (theSections & kCompactHasOrientation)
+  {
+    PutSigned(&theWriter, (int32_t)inImuData->pGyroX, 12) ;
+    PutSigned(&theWriter, (int32_t)inImuData->pGyroY, 12) ;
+    PutSigned(&theWriter, (int32_t)inImuData->pGyroZ, 12) ;
+    PutSigned(&theWriter, (int32_t)(inImuData->pMagX * 1000.0f), 12) ;
+    PutSigned(&theWriter, (int32_t)(inImuData->pMagY * 1000.0f), 12) ;
+    PutSigned(&theWriter, (int32_t)(inImuData->pMagZ * 1000.0f), 12) ;
+  }
+
+  // Slowly changing fields
+  if (theSections & kCompactHasSlow)
+  {
+    PutBits(&theWriter, ioController->pGpsOriginEpoch, 2) ;
+    PutBits(&theWriter, (uint32_t)ioController->pGpsOriginLat, 32) ;
+    PutBits(&theWriter, (uint32_t)ioController->pGpsOriginLon, 32) ;
+    PutUnsigned(&theWriter, (int32_t)((ioController->pCurrentTemperatureC + 40.0f) * 2.0f), 8) ;
+    if (theGps != NULL)
     {
-      // Orientation testing: 10 Hz for real-time display
-      return (inCurrentTimeMs - inController->pLastTelemetryTimeMs) >= 100 ;
+      PutUnsigned(&theWriter, theGps->pSatellites, 5) ;
+      PutUnsigned(&theWriter, (int32_t)theGps->pSpeedMps, 9) ;
+      PutBits(&theWriter, (uint32_t)(theGps->pHeadingDeg * (256.0f / 360.0f)) & 0xFF, 8) ;
     }
     else
     {
-      // Normal idle: 0.5 Hz (conserve battery)
-      return (inCurrentTimeMs - inController->pLastTelemetryTimeMs) >= 2000 ;
+      theWriter.pBitPos += 22 ;
     }
   }
 
-  // Landed or complete: send at 1 Hz (conserve battery while allowing data download)
-  return (inCurrentTimeMs - inController->pLastTelemetryTimeMs) >= 1000 ;
+  // Pad to a byte and append the CRC
+  uint8_t theLen = (uint8_t)((theWriter.pBitPos + 7) / 8) ;
+  outPacket[theLen] = LoRaProtocol_Crc8(outPacket, theLen) ;
+
+  return theLen + 1 ;
+}
+
+//----------------------------------------------
+// Function: FlightControl_SetTelemetryFormat
+//----------------------------------------------
+bool FlightControl_SetTelemetryFormat(
+  FlightController * ioController,
+  uint8_t inFormat)
+{
+  if (inFormat != kTelemetryFormatFull && inFormat != kTelemetryFormatCompact)
+  {
+    return false ;
+  }
+
+  ioController->pTelemetryFormat = inFormat ;
+  return true ;
+}
+
+//----------------------------------------------
+// Function: FlightControl_BuildBatchTelemetryPacket
+//----------------------------------------------
+uint8_t FlightControl_BuildBatchTelemetryPacket(
+  FlightController * ioController,
+  uint8_t inRocketId,
+  uint8_t inMaxLen,
+  uint8_t * outPacket)
+{
+  uint8_t thePending = ioController->pBatchPending ;
+  if (thePending == 0 || inMaxLen <= kBatchHeaderLen)
+  {
+    return 0 ;
+  }
+
+  uint8_t theFirst = (uint8_t)((ioController->pBatchHead + kBatchRingSize - thePending) % kBatchRingSize) ;
+  const BatchSample * thePrevious = &ioController->pBatchRing[theFirst] ;
+  const GpsData * theGps = GPS_GetData() ;
+
+  // Header and first sample in full
+  int32_t theTimeMs = (int32_t)(thePrevious->pTimeMs - ioController->pLaunchTimeMs) ;
+  if (ioController->pLaunchTimeMs == 0)
+  {
+    theTimeMs = 0 ;
+  }
+
+  outPacket[0] = kLoRaMagic ;
+  outPacket[1] = kLoRaPacketTelemetryBatch ;
+  outPacket[2] = inRocketId ;
+  outPacket[3] = ioController->pTelemetrySequence & 0xFF ;
+  outPacket[4] = (ioController->pTelemetrySequence >> 8) & 0xFF ;
+  outPacket[5] = (uint8_t)ioController->pState ;
+  outPacket[6] = BuildStatusFlags(ioController, theGps) ;
+  memcpy(&outPacket[8], &theTimeMs, 4) ;
+  memcpy(&outPacket[12], &thePrevious->pAltitudeDm, 4) ;
+  memcpy(&outPacket[16], &thePrevious->pVelocityDms, 2) ;
+  memcpy(&outPacket[18], &thePrevious->pAccelDms2, 2) ;
+
+  // Remaining samples as deltas while they fit
+  uint8_t theLen = kBatchHeaderLen ;
+  uint8_t theCount = 1 ;
+  while (theCount < thePending && theLen + kBatchSampleMaxLen < inMaxLen)
+  {
+    const BatchSample * theSample =
+      &ioController->pBatchRing[(theFirst + theCount) % kBatchRingSize] ;
+
+    theLen = PutVarint(outPacket, theLen, theSample->pTimeMs - thePrevious->pTimeMs) ;
+    theLen = PutVarint(outPacket, theLen, ZigZag(theSample->pAltitudeDm - thePrevious->pAltitudeDm)) ;
+    theLen = PutVarint(outPacket, theLen, ZigZag(theSample->pVelocityDms - thePrevious->pVelocityDms)) ;
+    theLen = PutVarint(outPacket, theLen, ZigZag(theSample->pAccelDms2 - thePrevious->pAccelDms2)) ;
+
+    thePrevious = theSample ;
+    theCount++ ;
+  }
+
+  outPacket[7] = theCount ;
+  ioController->pBatchPending -= theCount ;
+
+  outPacket[theLen] = LoRaProtocol_Crc8(outPacket, theLen) ;
+  return theLen + 1 ;
+}
+
+//----------------------------------------------
+// Function: FlightControl_ShouldSendBatch
+//----------------------------------------------
+bool FlightControl_ShouldSendBatch(const FlightController * inController)
+{
+  return inController->pTelemetryBatch &&
+    inController->pState >= kFlightBoost && inController->pState <= kFlightDescent &&
+    inController->pBatchPending > 0 &&
+    (inController->pTelemetrySequence % kBatchSnapshotInterval) != 0 ;
+}
+
+//----------------------------------------------
+// Function: FlightControl_SetTelemetryBatch
+//----------------------------------------------
+void FlightControl_SetTelemetryBatch(
+  FlightController * ioController,
+  bool inEnabled)
+{
+  ioController->pTelemetryBatch = inEnabled ;
+}
+
+//----------------------------------------------
+// Function: FlightControl_GetTelemetryProfile
+//----------------------------------------------
+uint8_t FlightControl_GetTelemetryProfile(const FlightController * inController)
+{
+  switch (inController->pState)
+  {
+    case kFlightIdle:
+      return kTelemetryProfileIdle ;
+
+    case kFlightArmed:
+      return kTelemetryProfileArmed ;
+
+    case kFlightBoost:
+    case kFlightCoast:
+    case kFlightApogee:
+      return kTelemetryProfileAscent ;
+
+    case kFlightDescent:
+      return kTelemetryProfileDescent ;
+
+    default:
+      return kTelemetryProfileLanded ;
+  }
+}
+
+//----------------------------------------------
+// Function: FlightControl_SetTelemetryProfile
+//----------------------------------------------
+bool FlightControl_SetTelemetryProfile(
+  FlightController * ioController,
+  uint8_t inProfile,
+  uint16_t inIntervalMs)
+{
+  if (inProfile == kTelemetryProfileDefaults)
+  {
+    // Full rate in flight, 4 Hz under canopy, 2 Hz
+    // armed; a sparse beacon once landed and 0.5 Hz
+    // on the pad conserve battery
+    ioController->pProfileIntervalMs[kTelemetryProfileIdle] = 2000 ;
+    ioController->pProfileIntervalMs[kTelemetryProfileArmed] = 500 ;
+    ioController->pProfileIntervalMs[kTelemetryProfileAscent] = kTelemetryIntervalMs ;
+    ioController->pProfileIntervalMs[kTelemetryProfileDescent] = 250 ;
+    ioController->pProfileIntervalMs[kTelemetryProfileLanded] = 5000 ;
+    return true ;
+  }
+
+  if (inProfile >= kTelemetryProfileCount ||
+      inIntervalMs < kTelemetryProfileMinMs || inIntervalMs > kTelemetryProfileMaxMs)
+  {
+    return false ;
+  }
+
+  ioController->pProfileIntervalMs[inProfile] = inIntervalMs ;
+  return true ;
+}
+
+//----------------------------------------------
+// Function: FlightControl_GetTelemetryIntervalMs
+//----------------------------------------------
+uint32_t FlightControl_GetTelemetryIntervalMs(const FlightController * inController)
+{
+  // Orientation testing: 10 Hz for real-time display
+  if (inController->pState == kFlightIdle && inController->pOrientationMode)
+  {
+    return 100 ;
+  }
+
+  return inController->pProfileIntervalMs[FlightControl_GetTelemetryProfile(inController)] ;
+}
+
+//----------------------------------------------
+// Function: FlightControl_BuildRecoveryPacket
+//----------------------------------------------
+uint8_t FlightControl_BuildRecoveryPacket(
+  const FlightController * inController,
+  uint8_t inRocketId,
+  uint32_t inCurrentTimeMs,
+  uint8_t * outPacket)
+{
+  const GpsData * theGps = GPS_GetData() ;
+  int32_t theLatitude = 0 ;
+  int32_t theLongitude = 0 ;
+  uint8_t theSatellites = 0 ;
+  if (theGps != NULL)
+  {
+    theLatitude = (int32_t)(theGps->pLatitude * 1000000.0f) ;
+    theLongitude = (int32_t)(theGps->pLongitude * 1000000.0f) ;
+    theSatellites = theGps->pSatellites ;
+  }
+
+  float theMaxAltitudeM = inController->pResults.pMaxAltitudeM ;
+  uint16_t theMaxAltitude = theMaxAltitudeM <= 0.0f ? 0 :
+    (theMaxAltitudeM >= 65535.0f ? 65535 : (uint16_t)theMaxAltitudeM) ;
+
+  // Landing time is launch plus the recorded flight time
+  uint32_t theLandedS = 0 ;
+  if (inController->pLaunchTimeMs > 0 && inController->pResults.pFlightTimeMs > 0)
+  {
+    theLandedS = (inCurrentTimeMs - inController->pLaunchTimeMs - inController->pResults.pFlightTimeMs) / 1000 ;
+    if (theLandedS > 0xFFFF)
+    {
+      theLandedS = 0xFFFF ;
+    }
+  }
+
+  outPacket[0] = kLoRaMagic ;
+  outPacket[1] = kLoRaPacketRecovery ;
+  outPacket[2] = inRocketId ;
+  outPacket[3] = inController->pTelemetrySequence & 0xFF ;
+  outPacket[4] = (inController->pTelemetrySequence >> 8) & 0xFF ;
+  outPacket[5] = (uint8_t)inController->pState ;
+  outPacket[6] = BuildStatusFlags(inController, theGps) ;
+  outPacket[7] = theSatellites ;
+  memcpy(&outPacket[8], &theLatitude, 4) ;
+  memcpy(&outPacket[12], &theLongitude, 4) ;
+  outPacket[16] = theMaxAltitude & 0xFF ;
+  outPacket[17] = (theMaxAltitude >> 8) & 0xFF ;
+  outPacket[18] = theLandedS & 0xFF ;
+  outPacket[19] = (theLandedS >> 8) & 0xFF ;
+  outPacket[20] = LoRaProtocol_Crc8(outPacket, kRecoveryPacketLen - 1) ;
+
+  return kRecoveryPacketLen ;
+}
+
+//----------------------------------------------
+// Function: FlightControl_ShouldSendTelemetry
+//----------------------------------------------
+bool FlightControl_ShouldSendTelemetry(
+  const FlightController * inController,
+  uint32_t inCurrentTimeMs)
+{
+  return (inCurrentTimeMs - inController->pLastTelemetryTimeMs) >=
+    FlightControl_GetTelemetryIntervalMs(inController) ;
 }
 
 //----------------------------------------------
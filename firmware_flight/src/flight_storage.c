@@ -8,6 +8,7 @@
 //----------------------------------------------
 
 #include "flight_storage.h"
+#include "crc32.h"
 #include "pico/stdlib.h"
 #include "hardware/flash.h"
 #include "hardware/sync.h"
@@ -23,6 +24,9 @@
 //----------------------------------------------
 #define kMaxSamplesPerFlight    1200    // ~120 seconds at 10 Hz
 #define kSampleBufferSize       (kMaxSamplesPerFlight * sizeof(FlightSample))
+#define kFlightIndexVersion     2       // 2 = CRC32 over index fields
+#define kIndexChecksumOffset    (12 + kMaxStoredFlights)
+#define kFlightVerifyBudgetUs   100000  // Boot-time verification budget
 
 //----------------------------------------------
 // Module State
@@ -32,6 +36,8 @@ static bool sRecording = false ;
 static uint32_t sNextFlightId = 1 ;
 static uint8_t sSlotUsed[kMaxStoredFlights] ;
 static int8_t sCurrentSlot = -1 ;
+static uint8_t sSlotStatus[kMaxStoredFlights] ;
+static uint32_t sVerifyTimeUs = 0 ;
 
 // RAM buffer for samples during flight
 static FlightSample sSampleBuffer[kMaxSamplesPerFlight] ;
@@ -41,9 +47,10 @@ static uint32_t sSampleCount = 0 ;
 static FlightHeader sCurrentHeader ;
 
 //----------------------------------------------
-// Internal: Calculate Checksum
+// Internal: Calculate Legacy Checksum
+// Byte sum used by version 1 headers and index
 //----------------------------------------------
-static uint32_t CalculateChecksum(const void * inData, size_t inSize)
+static uint32_t CalculateLegacyChecksum(const void * inData, size_t inSize)
 {
   const uint8_t * theBytes = (const uint8_t *)inData ;
   uint32_t theSum = 0 ;
@@ -72,15 +79,27 @@ static bool LoadIndex(void)
     return false ;
   }
 
-  // Read version
+  // Read version (version 1 index had an unchecked byte sum)
   uint32_t theVersion = *(const uint32_t *)(theIndexPtr + 4) ;
-  if (theVersion != kFlightVersion)
+  if (theVersion != kFlightIndexVersion && theVersion != 1)
   {
     printf("FlightStorage: Index version mismatch (%lu vs %d)\n",
-      (unsigned long)theVersion, kFlightVersion) ;
+      (unsigned long)theVersion, kFlightIndexVersion) ;
     return false ;
   }
 
+  // Verify CRC (stored unaligned after the slot flags)
+  if (theVersion == kFlightIndexVersion)
+  {
+    uint32_t theStoredCrc ;
+    memcpy(&theStoredCrc, theIndexPtr + kIndexChecksumOffset, sizeof(theStoredCrc)) ;
+    if (Crc32_Compute(theIndexPtr, kIndexChecksumOffset) != theStoredCrc)
+    {
+      printf("FlightStorage: Index CRC mismatch\n") ;
+      return false ;
+    }
+  }
+
   // Read next flight ID
   sNextFlightId = *(const uint32_t *)(theIndexPtr + 8) ;
 
@@ -102,15 +121,15 @@ static bool SaveIndex(void)
 
   // Magic, version, next ID
   *(uint32_t *)(theBuffer + 0) = kFlightIndexMagic ;
-  *(uint32_t *)(theBuffer + 4) = kFlightVersion ;
+  *(uint32_t *)(theBuffer + 4) = kFlightIndexVersion ;
   *(uint32_t *)(theBuffer + 8) = sNextFlightId ;
 
   // Slot usage
   memcpy(theBuffer + 12, sSlotUsed, kMaxStoredFlights) ;
 
-  // Checksum
-  uint32_t theChecksum = CalculateChecksum(theBuffer, 12 + kMaxStoredFlights) ;
-  *(uint32_t *)(theBuffer + 12 + kMaxStoredFlights) = theChecksum ;
+  // CRC (unaligned offset, so copy rather than store as uint32_t)
+  uint32_t theChecksum = Crc32_Compute(theBuffer, kIndexChecksumOffset) ;
+  memcpy(theBuffer + kIndexChecksumOffset, &theChecksum, sizeof(theChecksum)) ;
 
   // Write to flash
   uint32_t theInterrupts = save_and_disable_interrupts() ;
@@ -122,6 +141,107 @@ static bool SaveIndex(void)
   return true ;
 }
 
+//----------------------------------------------
+// Internal: Verify Slot
+// Checks the header CRC, the block table CRC and
+// every sample block against flash contents.
+//----------------------------------------------
+static FlightSlotStatus VerifySlot(uint8_t inSlot)
+{
+  uint32_t theSlotOffset = kFlightSlotsOffset + (inSlot * kFlightSlotSize) ;
+  const uint8_t * theSlotPtr = (const uint8_t *)(XIP_BASE + theSlotOffset) ;
+
+  FlightHeader theHeader ;
+  memcpy(&theHeader, theSlotPtr, sizeof(theHeader)) ;
+
+  if (theHeader.pMagic != kFlightMagic)
+  {
+    return kFlightSlotCorrupt ;
+  }
+
+  // Version 1 flights only have a byte-sum header checksum
+  if (theHeader.pVersion == kFlightVersionLegacy)
+  {
+    if (CalculateLegacyChecksum(&theHeader, offsetof(FlightHeader, pChecksum)) !=
+        theHeader.pChecksum)
+    {
+      return kFlightSlotCorrupt ;
+    }
+    return kFlightSlotLegacy ;
+  }
+
+  if (theHeader.pVersion != kFlightVersion ||
+      Crc32_Compute(&theHeader, offsetof(FlightHeader, pChecksum)) != theHeader.pChecksum)
+  {
+    printf("FlightStorage: Header CRC mismatch in slot %d\n", inSlot) ;
+    return kFlightSlotCorrupt ;
+  }
+
+  // Block table must match the sample count
+  uint32_t theDataSize = theHeader.pSampleCount * sizeof(FlightSample) ;
+  uint32_t theBlockCount = (theDataSize + kFlightBlockSize - 1) / kFlightBlockSize ;
+  if (theDataSize > (kFlightSlotSize - FLASH_PAGE_SIZE) ||
+      theBlockCount > kMaxFlightBlocks ||
+      theHeader.pBlockCount != theBlockCount)
+  {
+    return kFlightSlotCorrupt ;
+  }
+
+  uint32_t theBlockCrcs[kMaxFlightBlocks] ;
+  memcpy(theBlockCrcs, theSlotPtr + sizeof(FlightHeader), theBlockCount * sizeof(uint32_t)) ;
+  if (Crc32_Compute(theBlockCrcs, theBlockCount * sizeof(uint32_t)) != theHeader.pBlockTableCrc)
+  {
+    printf("FlightStorage: Block table CRC mismatch in slot %d\n", inSlot) ;
+    return kFlightSlotCorrupt ;
+  }
+
+  // Sample blocks (DMA reads straight from XIP flash)
+  const uint8_t * theDataPtr = theSlotPtr + FLASH_PAGE_SIZE ;
+  for (uint32_t theBlock = 0 ; theBlock < theBlockCount ; theBlock++)
+  {
+    uint32_t theBlockStart = theBlock * kFlightBlockSize ;
+    uint32_t theBlockSize = theDataSize - theBlockStart ;
+    if (theBlockSize > kFlightBlockSize)
+    {
+      theBlockSize = kFlightBlockSize ;
+    }
+
+    if (Crc32_Compute(theDataPtr + theBlockStart, theBlockSize) != theBlockCrcs[theBlock])
+    {
+      printf("FlightStorage: Block %lu CRC mismatch in slot %d\n",
+        (unsigned long)theBlock, inSlot) ;
+      return kFlightSlotCorrupt ;
+    }
+  }
+
+  return kFlightSlotValid ;
+}
+
+//----------------------------------------------
+// Internal: Rebuild Index from Slot Headers
+// Used when the index is missing or fails its
+// CRC, so stored flights are not orphaned.
+//----------------------------------------------
+static void RebuildIndex(void)
+{
+  sNextFlightId = 1 ;
+
+  for (uint8_t i = 0 ; i < kMaxStoredFlights ; i++)
+  {
+    uint32_t theSlotOffset = kFlightSlotsOffset + (i * kFlightSlotSize) ;
+    const FlightHeader * theHeaderPtr = (const FlightHeader *)(XIP_BASE + theSlotOffset) ;
+
+    sSlotUsed[i] = (theHeaderPtr->pMagic == kFlightMagic) ? 1 : 0 ;
+
+    if (sSlotUsed[i] && theHeaderPtr->pFlightId >= sNextFlightId)
+    {
+      sNextFlightId = theHeaderPtr->pFlightId + 1 ;
+    }
+  }
+
+  printf("FlightStorage: Rebuilt index, next ID=%lu\n", (unsigned long)sNextFlightId) ;
+}
+
 //----------------------------------------------
 // Internal: Find Free Slot
 //----------------------------------------------
@@ -154,8 +274,8 @@ static bool WriteFlightToFlash(uint8_t inSlot)
   printf("  Samples: %lu, Header: %lu bytes\n",
     (unsigned long)sSampleCount, (unsigned long)sizeof(FlightHeader)) ;
 
-  // Calculate number of sectors to erase
-  uint32_t theDataSize = sizeof(FlightHeader) + (sSampleCount * sizeof(FlightSample)) ;
+  // Calculate number of sectors to erase (samples start at the second page)
+  uint32_t theDataSize = FLASH_PAGE_SIZE + (sSampleCount * sizeof(FlightSample)) ;
   uint32_t theSectorsNeeded = (theDataSize + FLASH_SECTOR_SIZE - 1) / FLASH_SECTOR_SIZE ;
   if (theSectorsNeeded > (kFlightSlotSize / FLASH_SECTOR_SIZE))
   {
@@ -172,13 +292,14 @@ static bool WriteFlightToFlash(uint8_t inSlot)
   flash_range_erase(theSlotOffset, theSectorsNeeded * FLASH_SECTOR_SIZE) ;
   watchdog_update() ;  // Feed watchdog after long erase
 
-  // Write header (first page)
+  // Write samples in pages. Each page is moved into the page buffer
+  // by DMA and the sniffer accumulates the CRC of the current block.
   uint8_t thePageBuffer[FLASH_PAGE_SIZE] ;
-  memset(thePageBuffer, 0xFF, sizeof(thePageBuffer)) ;
-  memcpy(thePageBuffer, &sCurrentHeader, sizeof(FlightHeader)) ;
-  flash_range_program(theSlotOffset, thePageBuffer, FLASH_PAGE_SIZE) ;
+  uint32_t theBlockCrcs[kMaxFlightBlocks] ;
+  uint16_t theBlockCount = 0 ;
+  uint32_t theBlockCrc = kCrc32Initial ;
+  uint32_t theBlockBytes = 0 ;
 
-  // Write samples in pages
   uint32_t theSampleOffset = theSlotOffset + FLASH_PAGE_SIZE ;
   const uint8_t * theSamplePtr = (const uint8_t *)sSampleBuffer ;
   uint32_t theBytesRemaining = sSampleCount * sizeof(FlightSample) ;
@@ -189,7 +310,8 @@ static bool WriteFlightToFlash(uint8_t inSlot)
       theBytesRemaining : FLASH_PAGE_SIZE ;
 
     memset(thePageBuffer, 0xFF, sizeof(thePageBuffer)) ;
-    memcpy(thePageBuffer, theSamplePtr, theBytesToWrite) ;
+    theBlockCrc = Crc32_Copy(theBlockCrc, thePageBuffer, theSamplePtr, theBytesToWrite) ;
+    theBlockBytes += theBytesToWrite ;
 
     flash_range_program(theSampleOffset, thePageBuffer, FLASH_PAGE_SIZE) ;
     watchdog_update() ;  // Feed watchdog between page writes
@@ -197,8 +319,29 @@ static bool WriteFlightToFlash(uint8_t inSlot)
     theSampleOffset += FLASH_PAGE_SIZE ;
     theSamplePtr += theBytesToWrite ;
     theBytesRemaining -= theBytesToWrite ;
+
+    // Close the block on a 4KB boundary or at the end of the data
+    if (theBlockBytes == kFlightBlockSize || theBytesRemaining == 0)
+    {
+      theBlockCrcs[theBlockCount++] = theBlockCrc ;
+      theBlockCrc = kCrc32Initial ;
+      theBlockBytes = 0 ;
+    }
   }
 
+  // Header goes last so a torn write never leaves a valid-looking flight
+  sCurrentHeader.pBlockCount = theBlockCount ;
+  sCurrentHeader.pBlockTableCrc = Crc32_Compute(theBlockCrcs,
+    theBlockCount * sizeof(uint32_t)) ;
+  sCurrentHeader.pChecksum = Crc32_Compute(&sCurrentHeader,
+    offsetof(FlightHeader, pChecksum)) ;
+
+  memset(thePageBuffer, 0xFF, sizeof(thePageBuffer)) ;
+  memcpy(thePageBuffer, &sCurrentHeader, sizeof(FlightHeader)) ;
+  memcpy(thePageBuffer + sizeof(FlightHeader), theBlockCrcs,
+    theBlockCount * sizeof(uint32_t)) ;
+  flash_range_program(theSlotOffset, thePageBuffer, FLASH_PAGE_SIZE) ;
+
   restore_interrupts(theInterrupts) ;
 
   printf("FlightStorage: Flight written successfully\n") ;
@@ -216,13 +359,15 @@ bool FlightStorage_Init(void)
     kFlightSlotsOffset, kMaxStoredFlights, kFlightSlotSize / 1024) ;
   printf("  Max samples per flight: %d\n", kMaxSamplesPerFlight) ;
 
+  // DMA sniffer for CRC32 (software fallback if no channel)
+  Crc32_Init() ;
+
   // Try to load existing index
   if (!LoadIndex())
   {
-    // Initialize fresh index
+    // Recover slot usage from the flight headers
     printf("FlightStorage: Creating new index\n") ;
-    sNextFlightId = 1 ;
-    memset(sSlotUsed, 0, sizeof(sSlotUsed)) ;
+    RebuildIndex() ;
     SaveIndex() ;
   }
 
@@ -240,9 +385,69 @@ bool FlightStorage_Init(void)
     theUsedCount, kMaxStoredFlights - theUsedCount, (unsigned long)sNextFlightId) ;
 
   sInitialized = true ;
+
+  // Verify stored flights within the boot budget
+  FlightStorage_VerifyFlights(kFlightVerifyBudgetUs) ;
+  printf("FlightStorage: Verified in %lu us\n", (unsigned long)sVerifyTimeUs) ;
+
   return true ;
 }
 
+//----------------------------------------------
+// Function: FlightStorage_VerifyFlights
+//----------------------------------------------
+uint8_t FlightStorage_VerifyFlights(uint32_t inBudgetUs)
+{
+  uint32_t theStartUs = time_us_32() ;
+  uint8_t theCorruptCount = 0 ;
+
+  for (uint8_t i = 0 ; i < kMaxStoredFlights ; i++)
+  {
+    if (!sSlotUsed[i])
+    {
+      sSlotStatus[i] = kFlightSlotEmpty ;
+      continue ;
+    }
+
+    // Leave remaining slots unverified once over budget
+    if ((time_us_32() - theStartUs) >= inBudgetUs)
+    {
+      sSlotStatus[i] = kFlightSlotUnverified ;
+      continue ;
+    }
+
+    sSlotStatus[i] = (uint8_t)VerifySlot(i) ;
+    if (sSlotStatus[i] == kFlightSlotCorrupt)
+    {
+      theCorruptCount++ ;
+    }
+    watchdog_update() ;
+  }
+
+  sVerifyTimeUs = time_us_32() - theStartUs ;
+  return theCorruptCount ;
+}
+
+//----------------------------------------------
+// Function: FlightStorage_GetVerifyTimeUs
+//----------------------------------------------
+uint32_t FlightStorage_GetVerifyTimeUs(void)
+{
+  return sVerifyTimeUs ;
+}
+
+//----------------------------------------------
+// Function: FlightStorage_GetSlotStatus
+//----------------------------------------------
+FlightSlotStatus FlightStorage_GetSlotStatus(uint8_t inSlotIndex)
+{
+  if (inSlotIndex >= kMaxStoredFlights)
+  {
+    return kFlightSlotEmpty ;
+  }
+  return (FlightSlotStatus)sSlotStatus[inSlotIndex] ;
+}
+
 //----------------------------------------------
 // Function: FlightStorage_GetFlightCount
 //----------------------------------------------
@@ -360,10 +565,7 @@ bool FlightStorage_EndFlight(
   sCurrentHeader.pApogeeTimeMs = inApogeeTimeMs ;
   sCurrentHeader.pFlightTimeMs = inFlightTimeMs ;
 
-  // Calculate header checksum
-  sCurrentHeader.pChecksum = CalculateChecksum(&sCurrentHeader,
-    offsetof(FlightHeader, pChecksum)) ;
-
+  // Header CRCs are filled in by WriteFlightToFlash
   printf("FlightStorage: Ending flight - %lu samples, max alt %.1f m\n",
     (unsigned long)sSampleCount, inMaxAltitudeM) ;
 
@@ -374,6 +576,7 @@ bool FlightStorage_EndFlight(
   {
     // Update index
     sSlotUsed[sCurrentSlot] = 1 ;
+    sSlotStatus[sCurrentSlot] = (uint8_t)VerifySlot((uint8_t)sCurrentSlot) ;
     sNextFlightId++ ;
     SaveIndex() ;
   }
@@ -487,6 +690,7 @@ bool FlightStorage_DeleteFlight(uint8_t inSlotIndex)
 
   // Update index
   sSlotUsed[inSlotIndex] = 0 ;
+  sSlotStatus[inSlotIndex] = kFlightSlotEmpty ;
   SaveIndex() ;
 
   return true ;
@@ -517,6 +721,7 @@ uint8_t FlightStorage_DeleteAllFlights(void)
       restore_interrupts(theInterrupts) ;
 
       sSlotUsed[i] = 0 ;
+      sSlotStatus[i] = kFlightSlotEmpty ;
       theDeletedCount++ ;
     }
   }
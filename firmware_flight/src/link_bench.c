@@ -0,0 +1,223 @@
+//----------------------------------------------
+// Module: link_bench.c
+// Description: LoRa link benchmark (flight side:
+//   sender)
+// Author: Mark Gavin
+// Created: 2026-02-15
+// Copyright: (c) 2025-2026 by Mark Gavin
+// License: Proprietary - All Rights Reserved
+//----------------------------------------------
+
+#include "link_bench.h"
+#include "flight_control.h"
+
+#include <string.h>
+
+//----------------------------------------------
+// Internal: Point start and end, us from the
+// anchor (end: the closing guard begins)
+//----------------------------------------------
+static void PointSpan(const BenchPoint * inPoint, uint32_t * outStartUs, uint32_t * outEndUs)
+{
+  uint32_t theStartMs = kBenchStartMs + inPoint->pStartMs ;
+  *outStartUs = (theStartMs + kBenchGuardMs) * 1000 ;
+  *outEndUs = (theStartMs + inPoint->pDurationMs - kBenchGuardMs) * 1000 ;
+}
+
+//----------------------------------------------
+// Function: LinkBench_Start
+//----------------------------------------------
+bool LinkBench_Start(
+  LinkBench * outBench,
+  const uint8_t * inParams,
+  uint8_t inLen,
+  uint32_t inRxUs)
+{
+  memset(outBench, 0, sizeof(*outBench)) ;
+  if (inLen < kBenchParamsLen)
+  {
+    return false ;
+  }
+
+  uint8_t theRates = inParams[1] & ((1 << kLoRaDataRateCount) - 1) ;
+  uint8_t theCodingRates = inParams[2] & 0x0F ;
+  uint8_t theFrames = inParams[3] ;
+  if (theRates == 0 || theCodingRates == 0 || theFrames == 0 || theFrames > kBenchMaxFrames)
+  {
+    return false ;
+  }
+
+  // Powers and lengths in command order; no
+  // powers at all means the one in use
+  int8_t thePowers[kBenchMaxChoices] ;
+  uint8_t theLens[kBenchMaxChoices] ;
+  uint8_t thePowerCount = 0 ;
+  uint8_t theLenCount = 0 ;
+  for (int i = 0 ; i < kBenchMaxChoices ; i++)
+  {
+    int8_t thePower = (int8_t)inParams[4 + i] ;
+    uint8_t theLen = inParams[4 + kBenchMaxChoices + i] ;
+    if (thePower != 0)
+    {
+      if (thePower < 2 || thePower > 20)
+      {
+        return false ;
+      }
+      thePowers[thePowerCount++] = thePower ;
+    }
+    if (theLen != 0)
+    {
+      if (theLen < kBenchMinLen)
+      {
+        return false ;
+      }
+      theLens[theLenCount++] = theLen ;
+    }
+  }
+  if (thePowerCount == 0)
+  {
+    thePowers[thePowerCount++] = 0 ;
+  }
+  if (theLenCount == 0)
+  {
+    return false ;
+  }
+
+  uint32_t theElapsedMs = 0 ;
+  uint8_t theCount = 0 ;
+  for (uint8_t theRate = 0 ; theRate < kLoRaDataRateCount ; theRate++)
+  {
+    if ((theRates & (1 << theRate)) == 0) continue ;
+    for (uint8_t theCr = LORA_CR_4_5 ; theCr <= LORA_CR_4_8 ; theCr++)
+    {
+      if ((theCodingRates & (1 << (theCr - LORA_CR_4_5))) == 0) continue ;
+      for (uint8_t p = 0 ; p < thePowerCount ; p++)
+      {
+        for (uint8_t l = 0 ; l < theLenCount ; l++)
+        {
+          if (theCount >= kBenchMaxPoints)
+          {
+            return false ;
+          }
+
+          BenchPoint * thePoint = &outBench->pPoints[theCount++] ;
+          thePoint->pRate = theRate ;
+          thePoint->pCodingRate = theCr ;
+          thePoint->pPowerDbm = thePowers[p] ;
+          thePoint->pLen = theLens[l] ;
+          thePoint->pAirUs = LoRa_GetConfigTimeOnAirUs(theRate, (LoRa_CodingRate)theCr, theLens[l]) ;
+          thePoint->pStartMs = theElapsedMs ;
+          thePoint->pDurationMs = 2 * kBenchGuardMs +
+            (uint32_t)(((uint64_t)theFrames * (thePoint->pAirUs + kBenchFrameGapUs) + 999) / 1000) ;
+          theElapsedMs += thePoint->pDurationMs ;
+        }
+      }
+    }
+  }
+
+  if (kBenchStartMs + theElapsedMs > kBenchMaxMs)
+  {
+    return false ;
+  }
+
+  outBench->pActive = true ;
+  outBench->pSession = inParams[0] ;
+  outBench->pFrames = theFrames ;
+  outBench->pPointCount = theCount ;
+  outBench->pApplied = kBenchPointStart ;
+  outBench->pPoint = kBenchPointStart ;
+  outBench->pAnchorUs = inRxUs ;
+  return true ;
+}
+
+//----------------------------------------------
+// Function: LinkBench_GetPoint
+//----------------------------------------------
+uint8_t LinkBench_GetPoint(const LinkBench * inBench, uint32_t inNowUs)
+{
+  uint32_t theMs = (inNowUs - inBench->pAnchorUs) / 1000 ;
+  if (theMs < kBenchStartMs)
+  {
+    return kBenchPointStart ;
+  }
+
+  theMs -= kBenchStartMs ;
+  for (uint8_t i = 0 ; i < inBench->pPointCount ; i++)
+  {
+    const BenchPoint * thePoint = &inBench->pPoints[i] ;
+    if (theMs < thePoint->pStartMs + thePoint->pDurationMs)
+    {
+      return i ;
+    }
+  }
+
+  return kBenchPointDone ;
+}
+
+//----------------------------------------------
+// Function: LinkBench_NextFrame
+//----------------------------------------------
+uint8_t LinkBench_NextFrame(
+  LinkBench * ioBench,
+  uint8_t inPoint,
+  uint32_t inNowUs,
+  uint8_t inRocketId,
+  uint8_t * outFrame)
+{
+  if (inPoint >= ioBench->pPointCount)
+  {
+    return 0 ;
+  }
+
+  if (inPoint != ioBench->pPoint)
+  {
+    ioBench->pPoint = inPoint ;
+    ioBench->pNextFrame = 0 ;
+  }
+
+  const BenchPoint * thePoint = &ioBench->pPoints[inPoint] ;
+  uint32_t theStartUs ;
+  uint32_t theEndUs ;
+  PointSpan(thePoint, &theStartUs, &theEndUs) ;
+
+  uint32_t theIntoUs = inNowUs - ioBench->pAnchorUs ;
+  if (ioBench->pNextFrame >= ioBench->pFrames || theIntoUs < theStartUs ||
+      theIntoUs + thePoint->pAirUs > theEndUs)
+  {
+    return 0 ;
+  }
+
+  uint8_t theLen = thePoint->pLen ;
+  outFrame[0] = kLoRaMagic ;
+  outFrame[1] = kLoRaPacketBenchmark ;
+  outFrame[2] = inRocketId ;
+  outFrame[3] = ioBench->pSession ;
+  outFrame[4] = inPoint ;
+  memset(&outFrame[5], ioBench->pNextFrame, theLen - 6) ;
+  outFrame[theLen - 1] = LoRaProtocol_Crc8(outFrame, theLen - 1) ;
+
+  ioBench->pNextFrame++ ;
+  ioBench->pFramesSent++ ;
+  return theLen ;
+}
+
+//----------------------------------------------
+// Function: LinkBench_BuildAnswer
+//----------------------------------------------
+uint8_t LinkBench_BuildAnswer(
+  uint8_t inRocketId,
+  uint8_t inSession,
+  uint8_t inPointCount,
+  bool inAccepted,
+  uint8_t * outFrame)
+{
+  outFrame[0] = kLoRaMagic ;
+  outFrame[1] = kLoRaPacketBenchmark ;
+  outFrame[2] = inRocketId ;
+  outFrame[3] = inSession ;
+  outFrame[4] = kBenchPointAnswer ;
+  outFrame[5] = inAccepted ? 1 : 0 ;
+  outFrame[6] = inPointCount ;
+  outFrame[7] = LoRaProtocol_Crc8(outFrame, kBenchAnswerLen - 1) ;
+  return kBenchAnswerLen ;
+}
@@ -0,0 +1,120 @@
+//----------------------------------------------
+// Module: link_rate.c
+// Description: Adaptive LoRa data rate (flight
+//   side of the gateway-led handshake)
+// Author: Mark Gavin
+// Created: 2026-02-14
+// Copyright: (c) 2025-2026 by Mark Gavin
+// License: Proprietary - All Rights Reserved
+// Modified: 2026-02-14 (ACK summary interval)
+//----------------------------------------------
+
+#include "link_rate.h"
+#include "flight_control.h"
+#include "lora_radio.h"
+
+#include <string.h>
+
+//----------------------------------------------
+// Function: LinkRate_Init
+//----------------------------------------------
+void LinkRate_Init(LinkRateState * outState)
+{
+  memset(outState, 0, sizeof(LinkRateState)) ;
+  outState->pRate = kLoRaDataRateBase ;
+}
+
+//----------------------------------------------
+// Function: LinkRate_ProcessCommand
+//----------------------------------------------
+uint8_t LinkRate_ProcessCommand(
+  LinkRateState * ioState,
+  const uint8_t * inParams,
+  uint8_t inLen,
+  int8_t inSnr,
+  uint8_t inRocketId,
+  uint8_t * outConfirm,
+  uint8_t inMaxLen)
+{
+  if (inLen < 3)
+  {
+    return 0 ;
+  }
+
+  uint8_t thePhase = inParams[0] ;
+  uint8_t theToken = inParams[1] ;
+  uint8_t theRate = inParams[2] ;
+  bool theValid = LoRa_GetDataRate(theRate) != NULL ;
+
+  // Commit: follow the gateway, which switches
+  // once the commit is off the air
+  if (thePhase == kRateCommit)
+  {
+    if (theValid && theRate != ioState->pRate)
+    {
+      ioState->pRate = theRate ;
+      ioState->pMisses = 0 ;
+      ioState->pSwitches++ ;
+    }
+    return 0 ;
+  }
+
+  if (thePhase != kRatePropose || inMaxLen < kRateConfirmLen)
+  {
+    return 0 ;
+  }
+
+  outConfirm[0] = kLoRaMagic ;
+  outConfirm[1] = kLoRaPacketRateAck ;
+  outConfirm[2] = inRocketId ;
+  outConfirm[3] = theToken ;
+  outConfirm[4] = theRate ;
+  outConfirm[5] = theValid ? 1 : 0 ;
+  outConfirm[6] = (uint8_t)inSnr ;
+  outConfirm[7] = ioState->pRate ;
+  return kRateConfirmLen ;
+}
+
+//----------------------------------------------
+// Function: LinkRate_GatewayHeard
+//----------------------------------------------
+void LinkRate_GatewayHeard(LinkRateState * ioState, uint32_t inNowMs)
+{
+  ioState->pMisses = 0 ;
+  ioState->pLastHeardMs = inNowMs ;
+}
+
+//----------------------------------------------
+// Function: LinkRate_SetAckInterval
+//----------------------------------------------
+void LinkRate_SetAckInterval(LinkRateState * ioState, uint16_t inIntervalMs)
+{
+  ioState->pAckIntervalMs = inIntervalMs ;
+}
+
+//----------------------------------------------
+// Function: LinkRate_FrameSent
+//----------------------------------------------
+bool LinkRate_FrameSent(LinkRateState * ioState, uint32_t inNowMs)
+{
+  if (ioState->pRate == kLoRaDataRateBase)
+  {
+    return false ;
+  }
+
+  // The next ACK summary is not late yet
+  if ((inNowMs - ioState->pLastHeardMs) <= ioState->pAckIntervalMs)
+  {
+    return false ;
+  }
+
+  if (++ioState->pMisses < kLinkRateMaxMisses)
+  {
+    return false ;
+  }
+
+  ioState->pRate = kLoRaDataRateBase ;
+  ioState->pMisses = 0 ;
+  ioState->pFallbacks++ ;
+  return true ;
+}
@@ -22,6 +22,13 @@
 #include "bmp390.h"
 #include "bmp581.h"
 #include "lora_radio.h"
+#include "tdma.h"
+#include "flash_bulk.h"
+#include "link_rate.h"
+#include "telemetry_fec.h"
+#include "event_journal.h"
+#include "downlink.h"
+#include "link_bench.h"
 #ifdef DISPLAY_EINK
 #include "uc8151d.h"
 #include "framebuffer.h"
@@ -32,6 +39,12 @@
 #include "heartbeat_led.h"
 #include "imu.h"
 #include "gps.h"
+#ifdef USB_MSC
+#include "usb_msc.h"
+#endif
+#ifdef SD_LOGGER
+#include "sd_logger.h"
+#endif
 
 #include "pico/stdlib.h"
 #include "pico/multicore.h"
@@ -58,6 +71,14 @@
 #define kStartupDelayMs         1000
 #define kSplashDisplayMs        2000
 
+// Settings changed over LoRa, written to flash
+// once the rocket is on the ground
+#define kSettingTelemetryFormat 0x01
+#define kSettingTelemetryBatch  0x02
+#define kSettingFecGroup        0x04
+#define kSettingChannelPlan     0x08
+#define kSettingProfile         0x10
+
 //----------------------------------------------
 // Debug Configuration
 // Set to 0 to disable debug output for production
@@ -71,6 +92,10 @@
   #define DEBUG_PRINT(...)  ((void)0)
 #endif
 
+// Set to 1 to measure SD card throughput at boot
+// (writes and deletes a 1 MB file, SD_LOGGER builds)
+#define kSdBenchmarkAtBoot      0
+
 //----------------------------------------------
 // Telemetry Sample Buffer
 //----------------------------------------------
@@ -83,6 +108,13 @@ static FlightController sFlightController ;
 static BMP390 sBmp390 ;
 static BMP581 sBmp581 ;
 static LoRa_Radio sLoRaRadio ;
+static TdmaState sTdma ;
+static FlashBulkState sFlashBulk ;
+static LinkRateState sLinkRate ;
+static TelemetryFec sFec ;
+static EventJournal sJournal ;
+static DownlinkQueue sDownlink ;
+static LinkBench sBench ;
 static Imu sImu ;
 
 // Hardware status
@@ -94,6 +126,11 @@ static bool sImuOk = false ;
 static bool sDisplayOk = false ;
 static bool sGpsOk = false ;
 static bool sFlashOk = false ;
+#ifdef SD_LOGGER
+static bool sSdOk = false ;
+static uint32_t sSdWriteKBps = 0 ;      // Boot benchmark, 0 if not run
+static uint32_t sSdReadKBps = 0 ;
+#endif
 
 // Timing
 static uint32_t sLastSensorReadMs = 0 ;
@@ -103,7 +140,27 @@ static uint32_t sLastDisplayUpdateMs = 0 ;
 #endif
 static uint32_t sLastLoRaRxMs = 0 ;
 static uint32_t sLastLoRaTxMs = 0 ;  // Last successful telemetry TX
+static uint32_t sTdmaSlotUsedUs = 0 ; // Start of the last slot telemetry went out in
+static uint32_t sLastRxWindowMs = 0 ; // Last frame followed by a receive window
+static uint8_t sLastTelemetryLen = sizeof(LoRaTelemetryPacket) ;
+
+// Recent command requests, for answering a repeat
+// without carrying it out again
+typedef struct
+{
+  bool pValid ;
+  uint8_t pRequestId ;
+  uint8_t pCommand ;
+  uint8_t pStatus ;
+  uint32_t pTimeMs ;
+} RequestRecord ;
+
+static RequestRecord sRequests[kRequestHistory] ;
+static uint8_t sNextRequest = 0 ;
 static uint32_t sLastFlashLogMs = 0 ;  // Last flash logging time
+#ifdef SD_LOGGER
+static uint32_t sLastSdLogMs = 0 ;     // Last SD logging time
+#endif
 
 // Gateway signal quality (from ACK packets)
 static int16_t sGatewayRssi = 0 ;
@@ -125,6 +182,13 @@ static uint32_t sCurrentFlightId = 0 ;
 // Rocket ID and name (loaded from flash, can be edited via display)
 static uint8_t sRocketId = 0 ;
 static bool sRocketIdEditing = false ;  // True when editing rocket ID
+static bool sChannelPlan = false ;      // Send on the uplink channel for the ID
+static uint8_t sSettingsPending = 0 ;   // kSetting* applied but not yet stored
+
+// Link benchmark: the link's own settings, put
+// back once it ends
+static LoRa_CodingRate sBenchCodingRate = LORA_CR_4_5 ;
+static int8_t sBenchPowerDbm = kLoRaTxPower ;
 
 // Baro comparison streaming
 static bool sBaroCompareEnabled = false ;
@@ -144,9 +208,25 @@ static void ProcessButtons(uint32_t inCurrentMs) ;
 #ifndef DISPLAY_EINK
 static void UpdateDisplay(uint32_t inCurrentMs) ;
 #endif
-static void SendTelemetry(uint32_t inCurrentMs) ;
+static void BuildFlightSample(uint32_t inCurrentMs, FlightState inState, FlightSample * outSample) ;
+static bool SendTelemetry(uint32_t inCurrentMs, uint8_t inMaxLen, bool inRxWindow) ;
+static uint32_t GetRxWindowUs(void) ;
+static bool WantRxWindow(uint32_t inCurrentMs) ;
+static bool SendParity(uint8_t inMaxLen) ;
+static void ServiceTelemetry(uint32_t inCurrentMs) ;
+static void ServiceFlashBulk(uint32_t inCurrentMs) ;
+static void ServiceLinkRate(void) ;
+static void ServiceDownlink(void) ;
+static void ServiceBenchmark(uint32_t inCurrentMs) ;
+static void EndBenchmark(uint32_t inCurrentMs) ;
+static bool QueueFrame(uint8_t inClass, const uint8_t * inData, uint8_t inLen) ;
+static void ApplyChannelPlan(void) ;
+static void SaveSettings(void) ;
 static void SendBaroCompare(void) ;
 static void ProcessLoRaCommands(void) ;
+static void ProcessAckSummary(const uint8_t * inPacket, uint8_t inLen) ;
+static const RequestRecord * FindRequest(uint8_t inRequestId, uint8_t inCommand, uint32_t inCurrentMs) ;
+static void SendCommandReply(uint8_t inRequestId, uint8_t inCommand, uint8_t inStatus, uint32_t inCurrentMs) ;
 
 //----------------------------------------------
 // Core1 Display Data (shared between cores)
@@ -235,6 +315,11 @@ static void Core1_DisplayLoop(void) ;
 //----------------------------------------------
 int main(void)
 {
+#ifdef USB_MSC
+  // TinyUSB composite (CDC + flight drive) must be up before stdio_usb
+  UsbMsc_Init() ;
+#endif
+
   // Initialize stdio (USB serial for debug)
   stdio_init_all() ;
   sleep_ms(kStartupDelayMs) ;
@@ -269,7 +354,36 @@ int main(void)
   // Initialize flight controller
   printf("Initializing flight controller...\n") ;
   FlightControl_Init(&sFlightController, sSampleBuffer, kMaxSamples) ;
-  printf("Flight controller initialized\n") ;
+
+  uint8_t theFormat = kTelemetryFormatFull ;
+  if (Storage_ReadSetting(kSettingKeyTelemetryFormat, &theFormat, 1, NULL))
+  {
+    FlightControl_SetTelemetryFormat(&sFlightController, theFormat) ;
+  }
+  uint8_t theBatch = 0 ;
+  if (Storage_ReadSetting(kSettingKeyTelemetryBatch, &theBatch, 1, NULL))
+  {
+    FlightControl_SetTelemetryBatch(&sFlightController, theBatch != 0) ;
+  }
+  uint8_t theFecGroup = 0 ;
+  Storage_ReadSetting(kSettingKeyFecGroup, &theFecGroup, 1, NULL) ;
+  TelemetryFec_Init(&sFec, theFecGroup) ;
+  uint8_t theChannelPlan = 0 ;
+  Storage_ReadSetting(kSettingKeyChannelPlan, &theChannelPlan, 1, NULL) ;
+  sChannelPlan = theChannelPlan != 0 ;
+  ApplyChannelPlan() ;
+  uint16_t theProfiles[kTelemetryProfileCount] ;
+  if (Storage_ReadSetting(kSettingKeyTelemetryProfile, theProfiles, sizeof(theProfiles), NULL))
+  {
+    for (uint8_t i = 0 ; i < kTelemetryProfileCount ; i++)
+    {
+      FlightControl_SetTelemetryProfile(&sFlightController, i, theProfiles[i]) ;
+    }
+  }
+  printf("Flight controller initialized (%s telemetry%s, FEC %s)\n",
+    sFlightController.pTelemetryFormat == kTelemetryFormatCompact ? "compact" : "full",
+    sFlightController.pTelemetryBatch ? ", batched in flight" : "",
+    sFec.pGroup != 0 ? "on" : "off") ;
 
   // Show splash screen
   if (sDisplayOk)
@@ -301,10 +415,18 @@ int main(void)
   if (!sBmp390Ok && !sBmp581Ok)
     printf("  Baro:    NONE (FAIL)\n") ;
   printf("  LoRa:    %s\n", sLoRaOk ? "OK" : "FAIL") ;
+  if (sLoRaOk)
+  {
+    printf("  LoRa SPI: %lu us per 255B FIFO burst (%lu us at 1 MHz)\n",
+      (unsigned long)sLoRaRadio.pSpiBurstUs, (unsigned long)sLoRaRadio.pSpiBaselineUs) ;
+  }
   printf("  IMU:     %s\n", sImuOk ? "OK" : "FAIL") ;
   printf("  Display: %s\n", sDisplayOk ? "OK" : "FAIL") ;
   printf("  GPS:     %s\n", sGpsOk ? "OK" : "FAIL") ;
   printf("  Flash:   %s\n", sFlashOk ? "OK" : "FAIL") ;
+#ifdef SD_LOGGER
+  printf("  SD:      %s\n", sSdOk ? "OK" : "FAIL") ;
+#endif
   printf("\nEntering main loop...\n\n") ;
 
 #ifdef DISPLAY_EINK
@@ -442,7 +564,69 @@ int main(void)
         FlightControl_GetStateName(sPreviousFlightState),
         FlightControl_GetStateName(theCurrentState)) ;
       puts(theBuf) ;
+
+      // A link benchmark or bulk download never
+      // outlasts the ground: the link gets its
+      // settings and telemetry back
+      bool theOnGround = theCurrentState == kFlightIdle ||
+        theCurrentState == kFlightLanded || theCurrentState == kFlightComplete ;
+      if (!theOnGround && sBench.pActive)
+      {
+        EndBenchmark(theCurrentMs) ;
+      }
+      if (!theOnGround && sFlashBulk.pActive)
+      {
+        sFlashBulk.pActive = false ;
+        DEBUG_PRINT("Bulk: Dropped, left the ground states\n") ;
+      }
+    }
+
+    // Journal the change for the ground, and store
+    // events only while nothing is in flight
+    if (EventJournal_NoteState(&sJournal, (uint8_t)theCurrentState, theCurrentMs,
+          sFlightController.pCurrentAltitudeM, sFlightController.pCurrentVelocityMps))
+    {
+      DEBUG_PRINT("Event: seq %u state %s\n", (uint8_t)(sJournal.pNextSequence - 1),
+        FlightControl_GetStateName(theCurrentState)) ;
+    }
+    if (theCurrentState < kFlightBoost || theCurrentState > kFlightDescent)
+    {
+      EventJournal_Flush(&sJournal) ;
+    }
+
+    // Settings changed over LoRa take effect at
+    // once; the flash erase waits for the ground
+    if (sSettingsPending != 0 && (theCurrentState == kFlightIdle ||
+        theCurrentState == kFlightLanded || theCurrentState == kFlightComplete))
+    {
+      SaveSettings() ;
+    }
+#ifdef SD_LOGGER
+    // SD log: preallocate on arming so the flight
+    // itself never allocates clusters
+    if (sSdOk && theCurrentState != sPreviousFlightState)
+    {
+      if (theCurrentState == kFlightArmed && !SdLogger_IsLogging())
+      {
+        SdLogger_StartFlight(1000 / kSensorSampleIntervalMs) ;
+      }
+      else if (theCurrentState == kFlightIdle && SdLogger_IsLogging())
+      {
+        // Disarmed on the pad
+        SdLogger_AbortFlight() ;
+      }
+      else if (theCurrentState == kFlightLanded && SdLogger_IsLogging())
+      {
+        SdLogger_EndFlight(
+          sFlightController.pResults.pMaxAltitudeM,
+          sFlightController.pResults.pFlightTimeMs,
+          sFlightController.pResults.pMaxVelocityMps) ;
+        DEBUG_PRINT("SD: Flight saved (max write %lu us)\n",
+          (unsigned long)SdLogger_GetMaxWriteUs()) ;
+      }
     }
+#endif
+
     if (sFlashOk && theCurrentState != sPreviousFlightState)
     {
       // State changed - check for recording start/stop
@@ -518,77 +702,62 @@ int main(void)
     {
       sLastFlashLogMs = theCurrentMs ;
 
-      // Build sample from current sensor data
       FlightSample theSample ;
-      theSample.pTimeMs = theCurrentMs - sFlightController.pLaunchTimeMs ;
-      theSample.pAltitudeCm = (int32_t)(sFlightController.pCurrentAltitudeM * 100.0f) ;
-      theSample.pVelocityCmps = (int16_t)(sFlightController.pCurrentVelocityMps * 100.0f) ;
-      theSample.pPressurePa = (uint32_t)sFlightController.pCurrentPressurePa ;
-      theSample.pTemperatureC10 = (int16_t)(sFlightController.pCurrentTemperatureC * 10.0f) ;
-
-      // GPS data
-      const GpsData * theGps = sGpsOk ? GPS_GetData() : NULL ;
-      if (theGps != NULL && theGps->pValid)
-      {
-        theSample.pGpsLatitude = (int32_t)(theGps->pLatitude * 1000000.0f) ;
-        theSample.pGpsLongitude = (int32_t)(theGps->pLongitude * 1000000.0f) ;
-        theSample.pGpsSpeedCmps = (int16_t)(theGps->pSpeedMps * 100.0f) ;
-        theSample.pGpsHeadingDeg10 = (uint16_t)(theGps->pHeadingDeg * 10.0f) ;
-        theSample.pGpsSatellites = theGps->pSatellites ;
-      }
-      else
-      {
-        theSample.pGpsLatitude = 0 ;
-        theSample.pGpsLongitude = 0 ;
-        theSample.pGpsSpeedCmps = 0 ;
-        theSample.pGpsHeadingDeg10 = 0 ;
-        theSample.pGpsSatellites = 0 ;
-      }
-
-      // IMU data
-      const ImuData * theImuData = sImuOk ? IMU_GetData(&sImu) : NULL ;
-      if (theImuData != NULL)
-      {
-        // Accelerometer: convert from g to milli-g
-        theSample.pAccelX = (int16_t)(theImuData->pAccelX * 1000.0f) ;
-        theSample.pAccelY = (int16_t)(theImuData->pAccelY * 1000.0f) ;
-        theSample.pAccelZ = (int16_t)(theImuData->pAccelZ * 1000.0f) ;
-
-        // Gyroscope: convert from dps to 0.1 dps
-        theSample.pGyroX = (int16_t)(theImuData->pGyroX * 10.0f) ;
-        theSample.pGyroY = (int16_t)(theImuData->pGyroY * 10.0f) ;
-        theSample.pGyroZ = (int16_t)(theImuData->pGyroZ * 10.0f) ;
-
-        // Magnetometer: convert from gauss to milligauss
-        theSample.pMagX = (int16_t)(theImuData->pMagX * 1000.0f) ;
-        theSample.pMagY = (int16_t)(theImuData->pMagY * 1000.0f) ;
-        theSample.pMagZ = (int16_t)(theImuData->pMagZ * 1000.0f) ;
-      }
-      else
-      {
-        theSample.pAccelX = 0 ;
-        theSample.pAccelY = 0 ;
-        theSample.pAccelZ = 0 ;
-        theSample.pGyroX = 0 ;
-        theSample.pGyroY = 0 ;
-        theSample.pGyroZ = 0 ;
-        theSample.pMagX = 0 ;
-        theSample.pMagY = 0 ;
-        theSample.pMagZ = 0 ;
-      }
+      BuildFlightSample(theCurrentMs, theCurrentState, &theSample) ;
+      FlightStorage_LogSample(&theSample) ;
+    }
 
-      theSample.pState = (uint8_t)theCurrentState ;
+#ifdef SD_LOGGER
+    //------------------------------------------
+    // 3c. Stream samples to SD (100 Hz during flight)
+    // LogSample only copies into RAM; Service writes
+    // at most one multi-sector block per pass.
+    //------------------------------------------
+    if (sSdOk && SdLogger_IsLogging() &&
+        theCurrentState >= kFlightBoost && theCurrentState < kFlightLanded &&
+        (theCurrentMs - sLastSdLogMs) >= kSensorSampleIntervalMs)
+    {
+      sLastSdLogMs = theCurrentMs ;
 
-      FlightStorage_LogSample(&theSample) ;
+      FlightSample theSample ;
+      BuildFlightSample(theCurrentMs, theCurrentState, &theSample) ;
+      SdLogger_LogSample(&theSample) ;
     }
+    if (sSdOk)
+    {
+      SdLogger_Service() ;
+    }
+#endif
 
 
     //------------------------------------------
-    // 4. Send LoRa telemetry (10 Hz) — PRIORITY
+    // 4. Service LoRa radio events (DIO0), then
+    //    queue telemetry (10 Hz, or in the gateway's
+    //    TDMA slots) — PRIORITY — and hand the
+    //    downlink queue's next frame to the radio.
+    //    A bulk flash download has the channel to
+    //    itself; a link benchmark has the radio.
     //------------------------------------------
-    if (sLoRaOk && FlightControl_ShouldSendTelemetry(&sFlightController, theCurrentMs))
+    if (sLoRaOk)
     {
-      SendTelemetry(theCurrentMs) ;
+      LoRa_Service(&sLoRaRadio) ;
+      if (sBench.pActive)
+      {
+        ServiceBenchmark(theCurrentMs) ;
+      }
+      else
+      {
+        ServiceLinkRate() ;
+        if (sFlashBulk.pActive)
+        {
+          ServiceFlashBulk(theCurrentMs) ;
+        }
+        else
+        {
+          ServiceTelemetry(theCurrentMs) ;
+        }
+        ServiceDownlink() ;
+      }
     }
 
     //------------------------------------------
@@ -698,6 +867,19 @@ int main(void)
       theCurrentMs) ;
 
 
+#ifdef USB_MSC
+    //------------------------------------------
+    // 8b. USB flight drive: only on the ground and
+    // never while a flight is buffered or written
+    //------------------------------------------
+    {
+      FlightState theUsbState = FlightControl_GetState(&sFlightController) ;
+      UsbMsc_Update(sFlashOk && !FlightStorage_IsRecording() &&
+        (theUsbState == kFlightIdle || theUsbState == kFlightLanded ||
+         theUsbState == kFlightComplete)) ;
+    }
+#endif
+
     //------------------------------------------
     // 9. Process button inputs
     // Skipped in eInk builds: GP9/GP6/GP5 are eInk SPI
@@ -817,11 +999,13 @@ static void InitializeHardware(void)
   {
     // Configure for flight telemetry
     LoRa_SetFrequency(&sLoRaRadio, kLoRaFrequency) ;
-    LoRa_SetSpreadingFactor(&sLoRaRadio, kLoRaSpreadFactor) ;
-    LoRa_SetBandwidth(&sLoRaRadio, LORA_BW_125) ;
+    LoRa_SetDataRate(&sLoRaRadio, kLoRaDataRateBase) ;  // SF7, 125 kHz
     LoRa_SetCodingRate(&sLoRaRadio, LORA_CR_4_5) ;
     LoRa_SetTxPower(&sLoRaRadio, kLoRaTxPower) ;
     LoRa_SetSyncWord(&sLoRaRadio, kLoRaSyncWord) ;
+    Tdma_Init(&sTdma) ;
+    LinkRate_Init(&sLinkRate) ;
+    Downlink_Init(&sDownlink, time_us_32()) ;
     sLoRaOk = true ;
     printf("LoRa radio initialized\n") ;
   }
@@ -840,8 +1024,38 @@ static void InitializeHardware(void)
   if (FlightStorage_Init())
   {
     sFlashOk = true ;
+    printf("Flash: %u flights verified in %lu us\n",
+      FlightStorage_GetFlightCount(), (unsigned long)FlightStorage_GetVerifyTimeUs()) ;
+  }
+
+  // Flight event journal (pending events are resent)
+  if (!EventJournal_Init(&sJournal))
+  {
+    printf("WARNING: Event journal sector unusable\n") ;
   }
 
+#ifdef SD_LOGGER
+  // Mount SD card (SPI1 and the LoRa CS are already set up)
+  if (SdLogger_Init())
+  {
+    sSdOk = true ;
+
+#if kSdBenchmarkAtBoot
+    if (SdLogger_Benchmark(kSdBenchmarkBytes, &sSdWriteKBps, &sSdReadKBps))
+    {
+      DEBUG_PRINT("SD: write %lu.%03lu MB/s, read %lu.%03lu MB/s\n",
+        (unsigned long)(sSdWriteKBps / 1000), (unsigned long)(sSdWriteKBps % 1000),
+        (unsigned long)(sSdReadKBps / 1000), (unsigned long)(sSdReadKBps % 1000)) ;
+    }
+    else
+    {
+      sSdWriteKBps = 0 ;
+      sSdReadKBps = 0 ;
+    }
+#endif
+  }
+#endif
+
   // Load rocket ID and name from settings storage
   Storage_Init() ;
   sRocketId = Storage_LoadRocketId() ;
@@ -1132,6 +1346,7 @@ static void ProcessButtons(uint32_t inCurrentMs)
           sRocketId = (sRocketId + 1) % 16 ;
           DEBUG_PRINT("Button B: Rocket ID changed to %u\n", sRocketId) ;
           Storage_SaveRocketId(sRocketId) ;
+          ApplyChannelPlan() ;
           sRocketIdEditing = true ;
           sBtnEditRocket = true ;
         }
@@ -1156,6 +1371,7 @@ static void ProcessButtons(uint32_t inCurrentMs)
         sRocketIdEditing = false ;
         StatusDisplay_SetMode(kDisplayModeLive) ;
       }
+      ApplyChannelPlan() ;
 #endif
     }
   }
@@ -1418,29 +1634,540 @@ static void UpdateDisplay(uint32_t inCurrentMs)
 
 #endif // !DISPLAY_EINK
 
+//----------------------------------------------
+// Function: BuildFlightSample
+// Purpose: Pack current sensor data into a
+//   FlightSample for flash or SD logging
+//----------------------------------------------
+static void BuildFlightSample(uint32_t inCurrentMs, FlightState inState, FlightSample * outSample)
+{
+  outSample->pTimeMs = inCurrentMs - sFlightController.pLaunchTimeMs ;
+  outSample->pAltitudeCm = (int32_t)(sFlightController.pCurrentAltitudeM * 100.0f) ;
+  outSample->pVelocityCmps = (int16_t)(sFlightController.pCurrentVelocityMps * 100.0f) ;
+  outSample->pPressurePa = (uint32_t)sFlightController.pCurrentPressurePa ;
+  outSample->pTemperatureC10 = (int16_t)(sFlightController.pCurrentTemperatureC * 10.0f) ;
+
+  // GPS data
+  const GpsData * theGps = sGpsOk ? GPS_GetData() : NULL ;
+  if (theGps != NULL && theGps->pValid)
+  {
+    outSample->pGpsLatitude = (int32_t)(theGps->pLatitude * 1000000.0f) ;
+    outSample->pGpsLongitude = (int32_t)(theGps->pLongitude * 1000000.0f) ;
+    outSample->pGpsSpeedCmps = (int16_t)(theGps->pSpeedMps * 100.0f) ;
+    outSample->pGpsHeadingDeg10 = (uint16_t)(theGps->pHeadingDeg * 10.0f) ;
+    outSample->pGpsSatellites = theGps->pSatellites ;
+  }
+  else
+  {
+    outSample->pGpsLatitude = 0 ;
+    outSample->pGpsLongitude = 0 ;
+    outSample->pGpsSpeedCmps = 0 ;
+    outSample->pGpsHeadingDeg10 = 0 ;
+    outSample->pGpsSatellites = 0 ;
+  }
+
+  // IMU data
+  const ImuData * theImuData = sImuOk ? IMU_GetData(&sImu) : NULL ;
+  if (theImuData != NULL)
+  {
+    // Accelerometer: convert from g to milli-g
+    outSample->pAccelX = (int16_t)(theImuData->pAccelX * 1000.0f) ;
+    outSample->pAccelY = (int16_t)(theImuData->pAccelY * 1000.0f) ;
+    outSample->pAccelZ = (int16_t)(theImuData->pAccelZ * 1000.0f) ;
+
+    // Gyroscope: convert from dps to 0.1 dps
+    outSample->pGyroX = (int16_t)(theImuData->pGyroX * 10.0f) ;
+    outSample->pGyroY = (int16_t)(theImuData->pGyroY * 10.0f) ;
+    outSample->pGyroZ = (int16_t)(theImuData->pGyroZ * 10.0f) ;
+
+    // Magnetometer: convert from gauss to milligauss
+    outSample->pMagX = (int16_t)(theImuData->pMagX * 1000.0f) ;
+    outSample->pMagY = (int16_t)(theImuData->pMagY * 1000.0f) ;
+    outSample->pMagZ = (int16_t)(theImuData->pMagZ * 1000.0f) ;
+  }
+  else
+  {
+    outSample->pAccelX = 0 ;
+    outSample->pAccelY = 0 ;
+    outSample->pAccelZ = 0 ;
+    outSample->pGyroX = 0 ;
+    outSample->pGyroY = 0 ;
+    outSample->pGyroZ = 0 ;
+    outSample->pMagX = 0 ;
+    outSample->pMagY = 0 ;
+    outSample->pMagZ = 0 ;
+  }
+
+  outSample->pState = (uint8_t)inState ;
+}
+
+//----------------------------------------------
+// Function: ServiceTelemetry
+// Purpose: Send telemetry when it is due. While
+//   beacons are heard every transmission is held
+//   to this rocket's slots and frames are sized
+//   to fit one; otherwise the telemetry timer
+//   alone decides, as without a TDMA gateway.
+//----------------------------------------------
+static void ServiceTelemetry(uint32_t inCurrentMs)
+{
+  uint32_t theNowUs = time_us_32() ;
+  uint32_t theStartUs ;
+  uint32_t theEndUs ;
+
+  if (!Tdma_IsSynced(&sTdma, theNowUs))
+  {
+    LoRa_ClearTxWindow(&sLoRaRadio) ;
+
+    // A group's parity follows its last frame at once
+    if (SendParity(kFecParityMaxLen))
+    {
+      return ;
+    }
+
+    if (FlightControl_ShouldSendTelemetry(&sFlightController, inCurrentMs) &&
+        SendTelemetry(inCurrentMs, kBatchFrameMaxLen, WantRxWindow(inCurrentMs)))
+    {
+      // Free-running frames are ACKed; a run of
+      // unanswered ones means the rate has failed
+      if (LinkRate_FrameSent(&sLinkRate, inCurrentMs))
+      {
+        DEBUG_PRINT("Rate: %u frames unanswered, back to base rate\n", kLinkRateMaxMisses) ;
+      }
+    }
+    return ;
+  }
+
+  if (!Tdma_GetTxWindow(&sTdma, theNowUs, &theStartUs, &theEndUs))
+  {
+    LoRa_SetTxWindow(&sLoRaRadio, theNowUs, theNowUs) ;
+    return ;
+  }
+  LoRa_SetTxWindow(&sLoRaRadio, theStartUs, theEndUs) ;
+
+  // One frame per slot, built as the slot opens; a
+  // waiting parity frame takes the slot
+  if ((int32_t)(theNowUs - theStartUs) < 0 || theStartUs == sTdmaSlotUsedUs ||
+      (sFec.pParityLen == 0 && !FlightControl_ShouldSendTelemetry(&sFlightController, inCurrentMs)))
+  {
+    return ;
+  }
+  sTdmaSlotUsedUs = theStartUs ;
+
+  uint8_t theMaxLen = kBatchFrameMaxLen + (sFec.pGroup != 0 ? kFecHeaderLen : 0) ;
+  while (theMaxLen > kBatchHeaderLen &&
+         LoRa_GetTimeOnAirUs(&sLoRaRadio, theMaxLen) > theEndUs - theNowUs)
+  {
+    theMaxLen-- ;
+  }
+
+  if (SendParity(theMaxLen) ||
+      !FlightControl_ShouldSendTelemetry(&sFlightController, inCurrentMs))
+  {
+    return ;
+  }
+
+  // Leave room for the parity frame in a later slot
+  if (sFec.pGroup != 0)
+  {
+    theMaxLen = theMaxLen > kBatchHeaderLen + kFecHeaderLen ?
+      theMaxLen - kFecHeaderLen : kBatchHeaderLen ;
+  }
+  if (theMaxLen > kBatchFrameMaxLen)
+  {
+    theMaxLen = kBatchFrameMaxLen ;
+  }
+  SendTelemetry(inCurrentMs, theMaxLen, false) ;
+}
+
+//----------------------------------------------
+// Function: ServiceFlashBulk
+// Purpose: Stream the next bulk download chunk
+//   once the previous one has gone out
+// Parameters:
+//   inCurrentMs - Current time (ms since boot)
+//----------------------------------------------
+static void ServiceFlashBulk(uint32_t inCurrentMs)
+{
+  // Chunks are too long for a TDMA slot; the
+  // gateway holds its beacons during the transfer
+  LoRa_ClearTxWindow(&sLoRaRadio) ;
+  if (LoRa_IsTransmitting(&sLoRaRadio) || Downlink_IsQueued(&sDownlink, kDownlinkBulk))
+  {
+    return ;
+  }
+
+  uint8_t thePacket[kBulkChunkMaxLen] ;
+  uint8_t theLen = FlashBulk_NextPacket(&sFlashBulk, sRocketId, inCurrentMs, thePacket, sizeof(thePacket)) ;
+  if (theLen == 0)
+  {
+    if (!sFlashBulk.pActive)
+    {
+      DEBUG_PRINT("Bulk: Ended, %lu chunks in %lu packets, %lu again\n",
+        (unsigned long)sFlashBulk.pChunksSent, (unsigned long)sFlashBulk.pPacketsSent,
+        (unsigned long)sFlashBulk.pRetransmits) ;
+    }
+    return ;
+  }
+
+  QueueFrame(kDownlinkBulk, thePacket, theLen) ;
+}
+
+//----------------------------------------------
+// Function: ApplyChannelPlan
+// Purpose: Send on the uplink channel assigned to
+//   this rocket's ID, or on the control channel
+//   with the plan off; receive stays on the
+//   control channel
+//----------------------------------------------
+static void ApplyChannelPlan(void)
+{
+  if (!sLoRaOk)
+  {
+    return ;
+  }
+
+  LoRa_SetTxFrequency(&sLoRaRadio, sChannelPlan ?
+    LoRa_GetChannelFrequency(LoRa_GetRocketChannel(sRocketId)) : 0) ;
+  DEBUG_PRINT("LoRa: sending on channel %u (%lu Hz)\n",
+    sChannelPlan ? LoRa_GetRocketChannel(sRocketId) : 0,
+    (unsigned long)(sChannelPlan ? sLoRaRadio.pTxFrequencyHz : sLoRaRadio.pFrequencyHz)) ;
+}
+
+//----------------------------------------------
+// Function: SaveSettings
+// Purpose: Store the settings changed over LoRa,
+//   as they stand now
+// Notes: A write programs flash with interrupts
+//   off, and erases a sector when the log is
+//   full, so it is called only on the ground
+//----------------------------------------------
+static void SaveSettings(void)
+{
+  if ((sSettingsPending & kSettingTelemetryFormat) != 0)
+  {
+    Storage_WriteSetting(kSettingKeyTelemetryFormat, &sFlightController.pTelemetryFormat, 1) ;
+  }
+  if ((sSettingsPending & kSettingTelemetryBatch) != 0)
+  {
+    uint8_t theEnabled = sFlightController.pTelemetryBatch ? 1 : 0 ;
+    Storage_WriteSetting(kSettingKeyTelemetryBatch, &theEnabled, 1) ;
+  }
+  if ((sSettingsPending & kSettingFecGroup) != 0)
+  {
+    Storage_WriteSetting(kSettingKeyFecGroup, &sFec.pGroup, 1) ;
+  }
+  if ((sSettingsPending & kSettingChannelPlan) != 0)
+  {
+    uint8_t theEnabled = sChannelPlan ? 1 : 0 ;
+    Storage_WriteSetting(kSettingKeyChannelPlan, &theEnabled, 1) ;
+  }
+  if ((sSettingsPending & kSettingProfile) != 0)
+  {
+    Storage_WriteSetting(kSettingKeyTelemetryProfile, sFlightController.pProfileIntervalMs,
+      sizeof(sFlightController.pProfileIntervalMs)) ;
+  }
+  sSettingsPending = 0 ;
+}
+
+//----------------------------------------------
+// Function: ServiceLinkRate
+// Purpose: Move the radio to the data rate the
+//   gateway committed to (or the fallback rate),
+//   or to the one a bulk download asked for while
+//   it runs, once nothing is on air
+//----------------------------------------------
+static void ServiceLinkRate(void)
+{
+  uint8_t theRate = sFlashBulk.pActive ? sFlashBulk.pRate : sLinkRate.pRate ;
+  if (theRate == sLoRaRadio.pDataRate)
+  {
+    return ;
+  }
+
+  if (LoRa_SetDataRate(&sLoRaRadio, theRate))
+  {
+    DEBUG_PRINT("Rate: Now %u (SF%u, bw %u)\n", theRate,
+      sLoRaRadio.pSpreadFactor, sLoRaRadio.pBandwidth) ;
+  }
+}
+
+//----------------------------------------------
+// Function: ServiceDownlink
+// Purpose: Hand the next queued frame to the
+//   radio. While beacons are heard it goes only
+//   inside this rocket's slot and only if it fits
+//   what is left of it; a frame longer than any
+//   slot may start just after the slot opens, as
+//   the radio allows.
+//----------------------------------------------
+static void ServiceDownlink(void)
+{
+  uint32_t theNowUs = time_us_32() ;
+  uint32_t theMaxAirUs = UINT32_MAX ;
+  uint32_t theStartUs ;
+  uint32_t theEndUs ;
+
+  if (!sFlashBulk.pActive && Tdma_IsSynced(&sTdma, theNowUs))
+  {
+    if (!Tdma_GetTxWindow(&sTdma, theNowUs, &theStartUs, &theEndUs) ||
+        (int32_t)(theNowUs - theStartUs) < 0)
+    {
+      return ;
+    }
+    if (theNowUs - theStartUs > kLoRaTxWindowLateUs)
+    {
+      theMaxAirUs = (int32_t)(theEndUs - theNowUs) > 0 ? theEndUs - theNowUs : 0 ;
+    }
+  }
+
+  Downlink_Service(&sDownlink, &sLoRaRadio, theNowUs, theMaxAirUs) ;
+}
+
+//----------------------------------------------
+// Function: ServiceBenchmark
+// Purpose: Run the link benchmark schedule: the
+//   answer at the base settings, then each point's
+//   settings and frames, straight to the radio.
+//   The downlink queue waits (its frames may
+//   expire) and the data rate comes back through
+//   ServiceLinkRate once the run ends.
+//----------------------------------------------
+static void ServiceBenchmark(uint32_t inCurrentMs)
+{
+  uint32_t theNowUs = time_us_32() ;
+
+  LoRa_ClearTxWindow(&sLoRaRadio) ;
+  if (LoRa_IsTransmitting(&sLoRaRadio))
+  {
+    return ;
+  }
+
+  uint8_t thePoint = LinkBench_GetPoint(&sBench, theNowUs) ;
+  if (thePoint == kBenchPointDone)
+  {
+    EndBenchmark(inCurrentMs) ;
+    return ;
+  }
+
+  uint8_t theFrame[kLoRaMaxPacketLen] ;
+  uint8_t theLen = 0 ;
+  if (thePoint == kBenchPointStart)
+  {
+    if (!sBench.pAnswered)
+    {
+      sBench.pAnswered = true ;
+      theLen = LinkBench_BuildAnswer(sRocketId, sBench.pSession, sBench.pPointCount, true, theFrame) ;
+    }
+  }
+  else
+  {
+    if (thePoint != sBench.pApplied)
+    {
+      // Coding rate first: the data rate change
+      // takes the radio through standby
+      const BenchPoint * theSettings = &sBench.pPoints[thePoint] ;
+      LoRa_SetCodingRate(&sLoRaRadio, (LoRa_CodingRate)theSettings->pCodingRate) ;
+      if (!LoRa_SetDataRate(&sLoRaRadio, theSettings->pRate))
+      {
+        return ;
+      }
+      LoRa_SetTxPower(&sLoRaRadio, theSettings->pPowerDbm != 0 ? theSettings->pPowerDbm : sBenchPowerDbm) ;
+      sBench.pApplied = thePoint ;
+      DEBUG_PRINT("Bench: Point %u rate=%u cr=4/%u len=%u\n", thePoint, theSettings->pRate,
+        theSettings->pCodingRate + 4, theSettings->pLen) ;
+    }
+    theLen = LinkBench_NextFrame(&sBench, thePoint, theNowUs, sRocketId, theFrame) ;
+  }
+
+  if (theLen > 0)
+  {
+    LoRa_Send(&sLoRaRadio, theFrame, theLen) ;
+  }
+}
+
+//----------------------------------------------
+// Function: EndBenchmark
+// Purpose: End a link benchmark run, finished or
+//   not, and give the link its coding rate and
+//   power back; the data rate follows through
+//   ServiceLinkRate
+// Parameters:
+//   inCurrentMs - Current time (ms since boot)
+//----------------------------------------------
+static void EndBenchmark(uint32_t inCurrentMs)
+{
+  LoRa_SetCodingRate(&sLoRaRadio, sBenchCodingRate) ;
+  LoRa_SetTxPower(&sLoRaRadio, sBenchPowerDbm) ;
+  sBench.pActive = false ;
+
+  // The gateway was silent by arrangement
+  LinkRate_GatewayHeard(&sLinkRate, inCurrentMs) ;
+  DEBUG_PRINT("Bench: Ended, %lu frames sent\n", (unsigned long)sBench.pFramesSent) ;
+}
+
+//----------------------------------------------
+// Function: QueueFrame
+// Purpose: Queue a frame for the downlink with
+//   no receive window after it
+// Returns: false if it was dropped
+//----------------------------------------------
+static bool QueueFrame(uint8_t inClass, const uint8_t * inData, uint8_t inLen)
+{
+  return Downlink_Queue(&sDownlink, inClass, inData, inLen, 0, time_us_32()) ;
+}
+
+//----------------------------------------------
+// Function: GetRxWindowUs
+// Purpose: Length of the receive window after a
+//   frame at the current data rate
+//----------------------------------------------
+static uint32_t GetRxWindowUs(void)
+{
+  return kRxWindowGuardMs * 1000 + LoRa_GetTimeOnAirUs(&sLoRaRadio, kRxWindowCommandLen) ;
+}
+
+//----------------------------------------------
+// Function: WantRxWindow
+// Purpose: Decide whether the next free-running
+//   frame opens a receive window: when the frame
+//   and window fit before the one after, or when
+//   the last window was kRxWindowMaxGapMs ago
+//----------------------------------------------
+static bool WantRxWindow(uint32_t inCurrentMs)
+{
+  uint32_t theNeedUs = LoRa_GetTimeOnAirUs(&sLoRaRadio, sLastTelemetryLen) + GetRxWindowUs() ;
+  return theNeedUs <= FlightControl_GetTelemetryIntervalMs(&sFlightController) * 1000 ||
+    (inCurrentMs - sLastRxWindowMs) >= kRxWindowMaxGapMs ;
+}
+
 //----------------------------------------------
 // Function: SendTelemetry
+// Purpose: Build and queue one telemetry frame
+//   of at most inMaxLen bytes (a full packet
+//   that does not fit goes out compact; once
+//   landed, the recovery beacon); with
+//   inRxWindow the frame says so and nothing
+//   else is sent until the window has passed
+// Returns: true if a frame was queued
 //----------------------------------------------
-static void SendTelemetry(uint32_t inCurrentMs)
+static bool SendTelemetry(uint32_t inCurrentMs, uint8_t inMaxLen, bool inRxWindow)
 {
-  // Build telemetry packet with IMU data
-  LoRaTelemetryPacket thePacket ;
+  // Previous packet still on air (SF7/125kHz 42-byte packet takes
+  // ~80ms) or a frame still waiting its turn: try again next pass
+  // rather than queue stale telemetry
+  if (LoRa_IsTransmitting(&sLoRaRadio) ||
+      Downlink_IsQueued(&sDownlink, kDownlinkEvent) ||
+      Downlink_IsQueued(&sDownlink, kDownlinkTelemetry))
+  {
+    return false ;
+  }
+
+  // Build telemetry packet with IMU data in the selected format;
+  // in flight a batch of the 100 Hz samples replaces most snapshots
+  union
+  {
+    LoRaTelemetryPacket pFull ;
+    uint8_t pCompact[kCompactTelemetryMaxLen] ;
+    uint8_t pBatch[kBatchFrameMaxLen] ;
+    uint8_t pRecovery[kRecoveryPacketLen] ;
+  } thePacket ;
   const ImuData * theImuData = sImuOk ? IMU_GetData(&sImu) : NULL ;
-  uint8_t theLen = FlightControl_BuildTelemetryPacket(&sFlightController, theImuData, sRocketId, &thePacket) ;
+  uint8_t theLen = 0 ;
+
+  // A pending flight event rides after the frame
+  uint8_t theFrameMax = inMaxLen ;
+  if (EventJournal_GetPending(&sJournal) != NULL && inMaxLen >= kBatchHeaderLen + kEventTrailerLen)
+  {
+    theFrameMax = inMaxLen - kEventTrailerLen ;
+  }
+  if (inRxWindow)
+  {
+    sFlightController.pStatusFlags |= kFlagRxWindow ;
+  }
+  else
+  {
+    sFlightController.pStatusFlags &= (uint8_t)~kFlagRxWindow ;
+  }
+  if (FlightControl_ShouldSendBatch(&sFlightController))
+  {
+    theLen = FlightControl_BuildBatchTelemetryPacket(&sFlightController, sRocketId, theFrameMax, thePacket.pBatch) ;
+  }
+  else if (FlightControl_GetTelemetryProfile(&sFlightController) == kTelemetryProfileLanded &&
+           theFrameMax >= kRecoveryPacketLen)
+  {
+    // Once landed only the recovery beacon goes out
+    theLen = FlightControl_BuildRecoveryPacket(&sFlightController, sRocketId, inCurrentMs, thePacket.pRecovery) ;
+  }
 
-  // Send via LoRa (blocking to ensure packet completes)
-  // SF7/125kHz 42-byte packet takes ~80ms airtime
-  if (LoRa_SendBlocking(&sLoRaRadio, (uint8_t *)&thePacket, theLen, 200))
+  // Snapshot otherwise; a full packet too long for
+  // the TDMA slot goes out compact instead
+  if (theLen == 0)
   {
+    if (sFlightController.pTelemetryFormat == kTelemetryFormatCompact ||
+        theFrameMax < sizeof(LoRaTelemetryPacket))
+    {
+      theLen = FlightControl_BuildCompactTelemetryPacket(&sFlightController, theImuData, sRocketId, thePacket.pCompact) ;
+    }
+    else
+    {
+      theLen = FlightControl_BuildTelemetryPacket(&sFlightController, theImuData, sRocketId, &thePacket.pFull) ;
+    }
+  }
+  uint8_t theTrailerLen = 0 ;
+  if (theLen < inMaxLen)
+  {
+    theTrailerLen = EventJournal_BuildTrailer(&sJournal, (uint8_t *)&thePacket + theLen, inMaxLen - theLen) ;
+    if (theTrailerLen > 0)
+    {
+      LoRaProtocol_MarkEventTrailer((uint8_t *)&thePacket) ;
+    }
+    theLen += theTrailerLen ;
+  }
+
+  // Queue for transmission, ahead of everything else when it
+  // carries an event; the radio returns to receive mode for
+  // commands on its own after TxDone
+  bool theQueued = Downlink_Queue(&sDownlink,
+    theTrailerLen > 0 ? kDownlinkEvent : kDownlinkTelemetry,
+    (const uint8_t *)&thePacket, theLen, inRxWindow ? GetRxWindowUs() : 0, time_us_32()) ;
+  if (theQueued)
+  {
+    TelemetryFec_AddFrame(&sFec, (const uint8_t *)&thePacket, theLen,
+      (uint8_t)sFlightController.pTelemetrySequence, sRocketId) ;
+    sLastTelemetryLen = theLen ;
+    if (inRxWindow)
+    {
+      sLastRxWindowMs = inCurrentMs ;
+    }
+
     // Mark telemetry as sent (updates timestamp and sequence number)
     FlightControl_MarkTelemetrySent(&sFlightController, inCurrentMs) ;
+    sLastLoRaTxMs = inCurrentMs ;
+    return true ;
+  }
+
+  return false ;
+}
+
+//----------------------------------------------
+// Function: SendParity
+// Purpose: Send the waiting FEC parity frame once
+//   the last frame of its group is off the air
+// Parameters:
+//   inMaxLen - Longest frame that fits now
+// Returns: true if a parity frame was queued
+//----------------------------------------------
+static bool SendParity(uint8_t inMaxLen)
+{
+  if (sFec.pParityLen == 0 || LoRa_IsTransmitting(&sLoRaRadio))
+  {
+    return false ;
   }
-  // Always update TX timestamp — packets transmit even when TX_DONE
-  // doesn't fire (200ms timeout expires but gateway receives packet).
-  sLastLoRaTxMs = inCurrentMs ;
 
-  // Return to receive mode for commands
-  LoRa_StartReceive(&sLoRaRadio) ;
+  uint8_t theParity[kFecParityMaxLen] ;
+  uint8_t theLen = TelemetryFec_TakeParity(&sFec, theParity, inMaxLen) ;
+  return theLen > 0 && QueueFrame(kDownlinkTelemetry, theParity, theLen) ;
 }
 
 //----------------------------------------------
@@ -1480,8 +2207,7 @@ static void SendBaroCompare(void)
   thePacket[12] = theT581 & 0xFF ;
   thePacket[13] = (theT581 >> 8) & 0xFF ;
 
-  LoRa_SendBlocking(&sLoRaRadio, thePacket, 14, 200) ;
-  LoRa_StartReceive(&sLoRaRadio) ;
+  QueueFrame(kDownlinkResponse, thePacket, 14) ;
 }
 
 //----------------------------------------------
@@ -1490,8 +2216,9 @@ static void SendBaroCompare(void)
 //----------------------------------------------
 static void SendDeviceInfo(void)
 {
-  // Build info packet with device details
-  uint8_t thePacket[128] ;
+  // Build info packet with device details (about
+  // 135 bytes with the longest names)
+  uint8_t thePacket[kLoRaMaxPacketLen] ;
   int theOffset = 0 ;
 
   thePacket[theOffset++] = kLoRaMagic ;
@@ -1557,8 +2284,81 @@ static void SendDeviceInfo(void)
   memcpy(&thePacket[theOffset], theImuType, theImuTypeLen) ;
   theOffset += theImuTypeLen ;
 
+  // Uplink channel (0: the control channel)
+  thePacket[theOffset++] = sChannelPlan ? LoRa_GetRocketChannel(sRocketId) : 0 ;
+
+  // Channel access: listen before talk deferrals,
+  // sends forced past the cap and CRC errors
+  // (collisions heard by the rocket)
+  uint16_t theCounts[3] ;
+  theCounts[0] = (uint16_t)(sLoRaRadio.pLbtDeferrals > 0xFFFF ? 0xFFFF : sLoRaRadio.pLbtDeferrals) ;
+  theCounts[1] = (uint16_t)(sLoRaRadio.pLbtForced > 0xFFFF ? 0xFFFF : sLoRaRadio.pLbtForced) ;
+  theCounts[2] = (uint16_t)(sLoRaRadio.pRxCrcErrors > 0xFFFF ? 0xFFFF : sLoRaRadio.pRxCrcErrors) ;
+  for (int i = 0 ; i < 3 ; i++)
+  {
+    thePacket[theOffset++] = theCounts[i] & 0xFF ;
+    thePacket[theOffset++] = (theCounts[i] >> 8) & 0xFF ;
+  }
+
+  // Downlink queueing delay per class (average
+  // then longest, ms), then frames held for the
+  // airtime budget and frames dropped
+  uint32_t theHeld = 0 ;
+  uint32_t theDropped = 0 ;
+  for (uint8_t i = 0 ; i < kDownlinkClassCount ; i++)
+  {
+    uint16_t theAverageMs ;
+    uint16_t theMaxMs ;
+    Downlink_GetDelayMs(&sDownlink, i, &theAverageMs, &theMaxMs) ;
+    thePacket[theOffset++] = theAverageMs & 0xFF ;
+    thePacket[theOffset++] = (theAverageMs >> 8) & 0xFF ;
+    thePacket[theOffset++] = theMaxMs & 0xFF ;
+    thePacket[theOffset++] = (theMaxMs >> 8) & 0xFF ;
+    theHeld += sDownlink.pStats[i].pHeld ;
+    theDropped += sDownlink.pStats[i].pDropped ;
+  }
+  theCounts[0] = (uint16_t)(theHeld > 0xFFFF ? 0xFFFF : theHeld) ;
+  theCounts[1] = (uint16_t)(theDropped > 0xFFFF ? 0xFFFF : theDropped) ;
+  for (int i = 0 ; i < 2 ; i++)
+  {
+    thePacket[theOffset++] = theCounts[i] & 0xFF ;
+    thePacket[theOffset++] = (theCounts[i] >> 8) & 0xFF ;
+  }
+
+  // Radio SPI time of the last send (queue entry to
+  // keyed up) and receive (RxDone to packet queued), us
+  theCounts[0] = (uint16_t)(sLoRaRadio.pLastTxSpiUs > 0xFFFF ? 0xFFFF : sLoRaRadio.pLastTxSpiUs) ;
+  theCounts[1] = (uint16_t)(sLoRaRadio.pLastRxSpiUs > 0xFFFF ? 0xFFFF : sLoRaRadio.pLastRxSpiUs) ;
+  for (int i = 0 ; i < 2 ; i++)
+  {
+    thePacket[theOffset++] = theCounts[i] & 0xFF ;
+    thePacket[theOffset++] = (theCounts[i] >> 8) & 0xFF ;
+  }
+
+  // Boot verification time of the stored flights (us)
+  uint32_t theVerifyUs = sFlashOk ? FlightStorage_GetVerifyTimeUs() : 0 ;
+  thePacket[theOffset++] = theVerifyUs & 0xFF ;
+  thePacket[theOffset++] = (theVerifyUs >> 8) & 0xFF ;
+  thePacket[theOffset++] = (theVerifyUs >> 16) & 0xFF ;
+  thePacket[theOffset++] = (theVerifyUs >> 24) & 0xFF ;
+
+  // SD card write and read rate from the boot
+  // benchmark (KB/s, 0 if not run)
+#ifdef SD_LOGGER
+  theCounts[0] = (uint16_t)(sSdWriteKBps > 0xFFFF ? 0xFFFF : sSdWriteKBps) ;
+  theCounts[1] = (uint16_t)(sSdReadKBps > 0xFFFF ? 0xFFFF : sSdReadKBps) ;
+#else
+  theCounts[0] = 0 ;
+  theCounts[1] = 0 ;
+#endif
+  for (int i = 0 ; i < 2 ; i++)
+  {
+    thePacket[theOffset++] = theCounts[i] & 0xFF ;
+    thePacket[theOffset++] = (theCounts[i] >> 8) & 0xFF ;
+  }
+
   DEBUG_PRINT("LoRa: Sending device info (%d bytes)\n", theOffset) ;
-  LoRa_SendBlocking(&sLoRaRadio, thePacket, theOffset, 500) ;
+  QueueFrame(kDownlinkResponse, thePacket, theOffset) ;
 }
 
 //----------------------------------------------
@@ -1574,22 +2374,24 @@ static void SendFlashList(void)
   }
 
   // Build flight list packet
-  // Format: magic, type, count, then for each flight: slot, flightId, maxAlt, flightTime, sampleCount
-  uint8_t thePacket[128] ;
+  // Format: magic, type, count, then for each flight: slot, flightId, maxAlt, flightTime, sampleCount,
+  // then the boot verification status of each (FlightSlotStatus)
+  uint8_t thePacket[kLoRaMaxPacketLen] ;
   int theOffset = 0 ;
 
   thePacket[theOffset++] = kLoRaMagic ;
   thePacket[theOffset++] = kLoRaPacketStorageList ;
-
-  uint8_t theFlightCount = FlightStorage_GetFlightCount() ;
-  thePacket[theOffset++] = theFlightCount ;
+  thePacket[theOffset++] = 0 ;
 
   // Add summary for each stored flight
-  for (uint8_t i = 0 ; i < kMaxStoredFlights && theOffset < 120 ; i++)
+  uint8_t theFlightCount = 0 ;
+  uint8_t theStatus[kMaxStoredFlights] ;
+  for (uint8_t i = 0 ; i < kMaxStoredFlights ; i++)
   {
     FlightHeader theHeader ;
     if (FlightStorage_GetHeader(i, &theHeader))
     {
+      theStatus[theFlightCount++] = (uint8_t)FlightStorage_GetSlotStatus(i) ;
       thePacket[theOffset++] = i ;  // Slot index
 
       // Flight ID (4 bytes)
@@ -1619,8 +2421,14 @@ static void SendFlashList(void)
     }
   }
 
+  // The count is of the flights listed, so the
+  // status bytes can be found after them
+  thePacket[2] = theFlightCount ;
+  memcpy(&thePacket[theOffset], theStatus, theFlightCount) ;
+  theOffset += theFlightCount ;
+
   DEBUG_PRINT("LoRa: Sending flash list (%d flights, %d bytes)\n", theFlightCount, theOffset) ;
-  LoRa_SendBlocking(&sLoRaRadio, thePacket, theOffset, 500) ;
+  QueueFrame(kDownlinkResponse, thePacket, theOffset) ;
 }
 
 //----------------------------------------------
@@ -1695,7 +2503,7 @@ static void SendFlashData(uint8_t inSlotIndex, uint32_t inStartSample)
 
   DEBUG_PRINT("LoRa: Sending flash data slot=%u start=%lu count=%u (%d bytes)\n",
     inSlotIndex, (unsigned long)inStartSample, theSamplesToSend, theOffset) ;
-  LoRa_SendBlocking(&sLoRaRadio, thePacket, theOffset, 500) ;
+  QueueFrame(kDownlinkResponse, thePacket, theOffset) ;
 }
 
 //----------------------------------------------
@@ -1736,7 +2544,113 @@ static void SendFlashHeader(uint8_t inSlotIndex)
   theOffset += sizeof(FlightHeader) ;
 
   DEBUG_PRINT("LoRa: Sending flash header slot=%u (%d bytes)\n", inSlotIndex, theOffset) ;
-  LoRa_SendBlocking(&sLoRaRadio, thePacket, theOffset, 500) ;
+  QueueFrame(kDownlinkResponse, thePacket, theOffset) ;
+}
+
+//----------------------------------------------
+// Function: ProcessAckSummary
+// Purpose: Take this rocket's entry from a
+//   gateway ACK summary: the gateway's averaged
+//   signal quality stands in for a per-frame ACK.
+//   Its event ACK, if any, delivers journaled
+//   events.
+//----------------------------------------------
+static void ProcessAckSummary(const uint8_t * inPacket, uint8_t inLen)
+{
+  if (inLen < kAckSummaryHeaderLen)
+  {
+    return ;
+  }
+
+  LinkRate_SetAckInterval(&sLinkRate, (uint16_t)(inPacket[3] | (inPacket[4] << 8))) ;
+
+  uint8_t theCount = inPacket[5] ;
+  for (uint8_t i = 0 ; i < theCount ; i++)
+  {
+    int theOffset = kAckSummaryHeaderLen + i * kAckSummaryEntryLen ;
+    if (theOffset + kAckSummaryEntryLen > inLen)
+    {
+      return ;
+    }
+
+    const uint8_t * theEntry = &inPacket[theOffset] ;
+    if (theEntry[0] != sRocketId)
+    {
+      continue ;
+    }
+
+    sGatewaySnr = (int8_t)theEntry[5] ;
+    sGatewayRssi = (int16_t)(theEntry[6] | (theEntry[7] << 8)) ;
+    sHasAckData = true ;
+    DEBUG_PRINT("ACK summary: seq=%u bitmap=0x%04X frames=%u RSSI=%d SNR=%d\n",
+      theEntry[1], theEntry[2] | (theEntry[3] << 8), theEntry[4], sGatewayRssi, sGatewaySnr) ;
+  }
+
+  // Event ACKs follow the entries
+  int theOffset = kAckSummaryHeaderLen + theCount * kAckSummaryEntryLen ;
+  if (theOffset >= inLen)
+  {
+    return ;
+  }
+  uint8_t theEvents = inPacket[theOffset++] ;
+  for (uint8_t i = 0 ; i < theEvents && theOffset + kAckEventEntryLen <= inLen ; i++)
+  {
+    if (inPacket[theOffset] == sRocketId &&
+        EventJournal_Acknowledge(&sJournal, inPacket[theOffset + 1]) > 0)
+    {
+      DEBUG_PRINT("Event ACK: through seq %u\n", inPacket[theOffset + 1]) ;
+    }
+    theOffset += kAckEventEntryLen ;
+  }
+}
+
+//----------------------------------------------
+// Function: FindRequest
+// Purpose: Look up a request carried out in the
+//   last kRequestRepeatMs
+// Returns: Its record, NULL if it is new
+//----------------------------------------------
+static const RequestRecord * FindRequest(uint8_t inRequestId, uint8_t inCommand, uint32_t inCurrentMs)
+{
+  for (int i = 0 ; i < kRequestHistory ; i++)
+  {
+    const RequestRecord * theRecord = &sRequests[i] ;
+    if (theRecord->pValid && theRecord->pRequestId == inRequestId &&
+        theRecord->pCommand == inCommand &&
+        (inCurrentMs - theRecord->pTimeMs) < kRequestRepeatMs)
+    {
+      return theRecord ;
+    }
+  }
+  return NULL ;
+}
+
+//----------------------------------------------
+// Function: SendCommandReply
+// Purpose: Answer a request with its outcome and
+//   remember it in case the answer is lost
+//----------------------------------------------
+static void SendCommandReply(uint8_t inRequestId, uint8_t inCommand, uint8_t inStatus, uint32_t inCurrentMs)
+{
+  if (FindRequest(inRequestId, inCommand, inCurrentMs) == NULL)
+  {
+    RequestRecord * theRecord = &sRequests[sNextRequest] ;
+    theRecord->pValid = true ;
+    theRecord->pRequestId = inRequestId ;
+    theRecord->pCommand = inCommand ;
+    theRecord->pStatus = inStatus ;
+    theRecord->pTimeMs = inCurrentMs ;
+    sNextRequest = (uint8_t)((sNextRequest + 1) % kRequestHistory) ;
+  }
+
+  uint8_t thePacket[kCommandReplyLen] ;
+  thePacket[0] = kLoRaMagic ;
+  thePacket[1] = kLoRaPacketCommandReply ;
+  thePacket[2] = sRocketId ;
+  thePacket[3] = inRequestId ;
+  thePacket[4] = inCommand ;
+  thePacket[5] = inStatus ;
+  QueueFrame(kDownlinkResponse, thePacket, sizeof(thePacket)) ;
 }
 
 //----------------------------------------------
@@ -1764,8 +2678,45 @@ static void ProcessLoRaCommands(void)
   // Update last receive time for link status
   sLastLoRaRxMs = to_ms_since_boot(get_absolute_time()) ;
 
+  // A request is a command with an ID in front of
+  // the command byte; without it, it is handled
+  // exactly like one
+  bool theRequest = false ;
+  uint8_t theRequestId = 0 ;
+  if (thePacketType == kLoRaPacketRequest && theLen >= 5)
+  {
+    theRequest = true ;
+    theRequestId = theBuffer[3] ;
+    memmove(&theBuffer[3], &theBuffer[4], theLen - 4) ;
+    theLen-- ;
+    thePacketType = kLoRaPacketCommand ;
+  }
+
+  // Only the gateway sends these; other rockets'
+  // frames say nothing about our link
+  if (thePacketType == kLoRaPacketBeacon || thePacketType == kLoRaPacketAck ||
+      thePacketType == kLoRaPacketAckSummary || thePacketType == kLoRaPacketCommand)
+  {
+    LinkRate_GatewayHeard(&sLinkRate, sLastLoRaRxMs) ;
+  }
+
+  // TDMA beacon: slot timing runs from its RxDone time.
+  // Scheduled rockets get no per-packet ACKs; being in
+  // the heard mask stands in for one, with the beacon's
+  // own signal quality as the link figure.
+  if (thePacketType == kLoRaPacketBeacon)
+  {
+    if (Tdma_ProcessBeacon(&sTdma, theBuffer, theLen, sLoRaRadio.pLastRxUs, sRocketId) &&
+        sTdma.pHeard)
+    {
+      sGatewayRssi = LoRa_GetRssi(&sLoRaRadio) ;
+      sGatewaySnr = LoRa_GetSnr(&sLoRaRadio) ;
+      sHasAckData = true ;
+    }
+    DEBUG_PRINT("Beacon: seq=%u slots=%u heard=%d\n", sTdma.pBeaconSeq, sTdma.pOwnSlots, sTdma.pHeard) ;
+  }
   // Handle ACK packets from gateway (contains signal quality info)
-  if (thePacketType == kLoRaPacketAck && theLen >= 5)
+  else if (thePacketType == kLoRaPacketAck && theLen >= 5)
   {
     // Extract RSSI and SNR from ACK packet
     // These represent how well the gateway received our telemetry
@@ -1774,6 +2725,11 @@ static void ProcessLoRaCommands(void)
     sHasAckData = true ;  // We have valid signal quality data from gateway
     DEBUG_PRINT("ACK: RSSI=%d SNR=%d\n", sGatewayRssi, sGatewaySnr) ;
   }
+  // Periodic ACK summary covering every rocket heard
+  else if (thePacketType == kLoRaPacketAckSummary)
+  {
+    ProcessAckSummary(theBuffer, theLen) ;
+  }
   else if (thePacketType == kLoRaPacketCommand)
   {
     // Command format: magic, type, targetRocketId, commandId, ...params
@@ -1790,22 +2746,47 @@ static void ProcessLoRaCommands(void)
     if (theTargetId != sRocketId && theTargetId != 0xFF)
     {
       DEBUG_PRINT("LoRa: Command for rocket %u (we are %u), ignoring\n", theTargetId, sRocketId) ;
-      LoRa_StartReceive(&sLoRaRadio) ;
       return ;
     }
 
     DEBUG_PRINT("LoRa: Command 0x%02X for rocket %u\n", theCommand, theTargetId) ;
 
+    // A repeat means our reply was lost: answer it
+    // again, and serve a read again since its data
+    // was probably lost with it
+    bool theReply = theRequest && theTargetId == sRocketId ;
+    const RequestRecord * theRepeat = theReply ?
+      FindRequest(theRequestId, theCommand, sLastLoRaRxMs) : NULL ;
+    bool theRead = theCommand == kCmdInfo || theCommand == kCmdStatus || theCommand == kCmdPing ||
+      theCommand == kCmdFlashList || theCommand == kCmdFlashRead ||
+      theCommand == kCmdSdList || theCommand == kCmdSdRead ;
+    if (theRepeat != NULL && !theRead)
+    {
+      DEBUG_PRINT("LoRa: Request %u repeated\n", theRequestId) ;
+      SendCommandReply(theRequestId, theCommand, theRepeat->pStatus, sLastLoRaRxMs) ;
+      return ;
+    }
+
+    uint8_t theStatus = kReplyOk ;
     switch (theCommand)
     {
       case kCmdArm:
         puts("*** ARM COMMAND RECEIVED ***") ;
-        FlightControl_Arm(&sFlightController) ;
+        // A link benchmark or bulk download has the radio
+        // off the link's settings and telemetry stopped
+        if (sBench.pActive || sFlashBulk.pActive ||
+            FlightControl_Arm(&sFlightController) != kFlightErrorNone)
+        {
+          theStatus = kReplyRejected ;
+        }
         break ;
 
       case kCmdDisarm:
         DEBUG_PRINT("LoRa: Disarm command received\n") ;
-        FlightControl_Disarm(&sFlightController) ;
+        if (FlightControl_Disarm(&sFlightController) != kFlightErrorNone)
+        {
+          theStatus = kReplyRejected ;
+        }
         break ;
 
       case kCmdStatus:
@@ -1813,6 +2794,11 @@ static void ProcessLoRaCommands(void)
         // Send status response
         break ;
 
+      case kCmdPing:
+        // The request reply is the answer
+        DEBUG_PRINT("LoRa: Ping\n") ;
+        break ;
+
       case kCmdReset:
         DEBUG_PRINT("LoRa: Reset command received\n") ;
         FlightControl_Reset(&sFlightController) ;
@@ -1831,6 +2817,70 @@ static void ProcessLoRaCommands(void)
         }
         break ;
 
+      case kCmdTelemetryFormat:
+        {
+          uint8_t theFormat = (theLen > 4) ? theBuffer[4] : kTelemetryFormatFull ;
+          if (FlightControl_SetTelemetryFormat(&sFlightController, theFormat))
+          {
+            DEBUG_PRINT("LoRa: Telemetry format %s\n",
+              theFormat == kTelemetryFormatCompact ? "compact" : "full") ;
+            sSettingsPending |= kSettingTelemetryFormat ;
+          }
+          else
+          {
+            theStatus = kReplyRejected ;
+          }
+        }
+        break ;
+
+      case kCmdTelemetryBatch:
+        {
+          bool theEnabled = theLen > 4 && theBuffer[4] != 0 ;
+          DEBUG_PRINT("LoRa: Batched telemetry %s\n", theEnabled ? "enabled" : "disabled") ;
+          FlightControl_SetTelemetryBatch(&sFlightController, theEnabled) ;
+          sSettingsPending |= kSettingTelemetryBatch ;
+        }
+        break ;
+
+      case kCmdFec:
+        {
+          uint8_t theGroup = theLen > 4 ? theBuffer[4] : 0 ;
+          if (TelemetryFec_SetGroup(&sFec, theGroup))
+          {
+            DEBUG_PRINT("LoRa: FEC group %u\n", theGroup) ;
+            sSettingsPending |= kSettingFecGroup ;
+          }
+          else
+          {
+            theStatus = kReplyRejected ;
+          }
+        }
+        break ;
+
+      case kCmdChannelPlan:
+        {
+          sChannelPlan = theLen > 4 && theBuffer[4] != 0 ;
+          sSettingsPending |= kSettingChannelPlan ;
+          ApplyChannelPlan() ;
+        }
+        break ;
+
+      case kCmdTelemetryProfile:
+        {
+          uint8_t theProfile = theLen > 4 ? theBuffer[4] : kTelemetryProfileDefaults ;
+          uint16_t theIntervalMs = theLen > 6 ? (uint16_t)(theBuffer[5] | (theBuffer[6] << 8)) : 0 ;
+          if (FlightControl_SetTelemetryProfile(&sFlightController, theProfile, theIntervalMs))
+          {
+            DEBUG_PRINT("LoRa: Telemetry profile %u, %u ms\n", theProfile, theIntervalMs) ;
+            sSettingsPending |= kSettingProfile ;
+          }
+          else
+          {
+            theStatus = kReplyRejected ;
+          }
+        }
+        break ;
+
       case kCmdBaroCompare:
         sBaroCompareEnabled = !sBaroCompareEnabled ;
         printf("Baro compare streaming %s\n", sBaroCompareEnabled ? "ON" : "OFF") ;
@@ -1870,8 +2920,7 @@ static void ProcessLoRaCommands(void)
             theDiag[13] = 0 ;
             printf("Baro diag: 390ok=%d 581ok=%d err=%d addr=0x%02X chipId=0x%02X\n",
               sBmp390Ok, sBmp581Ok, sBmp581.pLastError, sBmp581.pI2cAddr, theChipId) ;
-            LoRa_SendBlocking(&sLoRaRadio, theDiag, 14, 200) ;
-            LoRa_StartReceive(&sLoRaRadio) ;
+            QueueFrame(kDownlinkResponse, theDiag, 14) ;
           }
         }
         break ;
@@ -1897,6 +2946,14 @@ static void ProcessLoRaCommands(void)
               // Reload name into static variable
               Storage_LoadRocketName(sRocketName) ;
             }
+            else
+            {
+              theStatus = kReplyRejected ;
+            }
+          }
+          else
+          {
+            theStatus = kReplyRejected ;
           }
         }
         break ;
@@ -1935,10 +2992,85 @@ static void ProcessLoRaCommands(void)
           else
           {
             DEBUG_PRINT("LoRa: Invalid flash read request (len=%u)\n", theLen) ;
+            theStatus = kReplyRejected ;
           }
         }
         break ;
 
+      case kCmdFlashBulkRead:
+        {
+          // Format: magic, type, targetId, cmd, slot, session
+          // and (optional) the data rate for the transfer.
+          // Telemetry stops while streaming, so not armed or in flight.
+          FlightState theState = sFlightController.pState ;
+          bool theOnGround = theState == kFlightIdle ||
+            theState == kFlightLanded || theState == kFlightComplete ;
+          uint8_t theRate = (theLen >= kBulkRequestLen && theBuffer[6] < kLoRaDataRateCount) ?
+            theBuffer[6] : sLinkRate.pRate ;
+          FlightHeader theHeader ;
+          if (theLen >= 6 && sFlashOk && theOnGround && !sBench.pActive &&
+              FlightStorage_GetHeader(theBuffer[4], &theHeader) &&
+              FlashBulk_Start(&sFlashBulk, theBuffer[4], theBuffer[5], theHeader.pSampleCount, theRate))
+          {
+            DEBUG_PRINT("LoRa: Bulk read slot=%u session=%u chunks=%u rate=%u\n",
+              theBuffer[4], theBuffer[5], sFlashBulk.pChunkCount, theRate) ;
+          }
+          else
+          {
+            DEBUG_PRINT("LoRa: Invalid bulk read request (len=%u)\n", theLen) ;
+            theStatus = kReplyRejected ;
+          }
+        }
+        break ;
+
+      case kCmdBenchmark:
+        {
+          // Format: magic, type, targetId, cmd, plan
+          // (link_bench.h). The radio leaves the link's
+          // settings for the run, so on the ground only,
+          // and only when addressed to this rocket.
+          FlightState theState = sFlightController.pState ;
+          bool theOnGround = theState == kFlightIdle ||
+            theState == kFlightLanded || theState == kFlightComplete ;
+          if (theLen > 4 && theTargetId == sRocketId && theOnGround && !sFlashBulk.pActive &&
+              !sBench.pActive && LinkBench_Start(&sBench, &theBuffer[4], theLen - 4, sLoRaRadio.pLastRxUs))
+          {
+            sBenchCodingRate = sLoRaRadio.pCodingRate ;
+            sBenchPowerDbm = sLoRaRadio.pTxPowerDbm ;
+            DEBUG_PRINT("LoRa: Benchmark session=%u points=%u\n", sBench.pSession, sBench.pPointCount) ;
+          }
+          else
+          {
+            uint8_t theAnswer[kBenchAnswerLen] ;
+            LinkBench_BuildAnswer(sRocketId, theLen > 4 ? theBuffer[4] : 0, 0, false, theAnswer) ;
+            QueueFrame(kDownlinkResponse, theAnswer, sizeof(theAnswer)) ;
+            DEBUG_PRINT("LoRa: Benchmark refused (len=%u)\n", theLen) ;
+            theStatus = kReplyRejected ;
+          }
+        }
+        break ;
+
+      case kCmdFlashBulkAck:
+        if (theLen > 4)
+        {
+          FlashBulk_ProcessAck(&sFlashBulk, &theBuffer[4], theLen - 4) ;
+        }
+        break ;
+
+      case kCmdDataRate:
+        if (theLen > 4)
+        {
+          uint8_t theConfirm[kRateConfirmLen] ;
+          uint8_t theConfirmLen = LinkRate_ProcessCommand(&sLinkRate, &theBuffer[4], theLen - 4,
+            LoRa_GetSnr(&sLoRaRadio), sRocketId, theConfirm, sizeof(theConfirm)) ;
+          if (theConfirmLen > 0)
+          {
+            QueueFrame(kDownlinkEvent, theConfirm, theConfirmLen) ;
+          }
+          DEBUG_PRINT("LoRa: Data rate phase=%u rate=%u\n", theBuffer[4], theLen > 6 ? theBuffer[6] : 0) ;
+        }
+        break ;
+
       case kCmdFlashDelete:
         {
           if (theLen >= 5)
@@ -1961,20 +3093,29 @@ static void ProcessLoRaCommands(void)
               else
               {
                 DEBUG_PRINT("Flash: Failed to delete slot %u\n", theSlot) ;
+                theStatus = kReplyRejected ;
               }
             }
           }
+          else
+          {
+            theStatus = kReplyRejected ;
+          }
         }
         break ;
 
       default:
         DEBUG_PRINT("LoRa: Unknown command 0x%02X\n", theCommand) ;
+        theStatus = kReplyUnknown ;
         break ;
     }
-  }
 
-  // Return to receive mode
-  LoRa_StartReceive(&sLoRaRadio) ;
+    // Queued after any packet the command sent
+    if (theReply)
+    {
+      SendCommandReply(theRequestId, theCommand, theStatus, sLastLoRaRxMs) ;
+    }
+  }
 }
 
 //----------------------------------------------
@@ -3,12 +3,13 @@
 // Description: SD card flight data logging using FatFs
 // Author: Mark Gavin
 // Created: 2025-12-19
-// Modified: 2026-01-10 (Rocket Avionics)
+// Modified: 2026-02-06 (async direct writes)
 // Copyright: (c) 2025-2026 by Mark Gavin
 // License: Proprietary - All Rights Reserved
 //----------------------------------------------
 
 #include "sd_logger.h"
+#include "sd_diskio.h"
 #include "pins.h"
 #include "ff.h"
 
@@ -17,6 +18,7 @@
 #include <stdio.h>
 #include <string.h>
 #include <stdlib.h>
+#include <ctype.h>
 
 #define printf(...) ((void)0)
 
@@ -27,15 +29,72 @@ static bool sSdAvailable = false ;
 static bool sFlightInProgress = false ;
 static char sCurrentFilename[64] = "" ;
 static char sLastFilename[64] = "" ;
+static uint32_t sNextFileNumber = 1 ;
 
 // FatFs objects
 static FATFS sFatFs ;
 static FIL sFile ;
 static bool sFileOpen = false ;
 
+// Log header (rewritten on close)
+static SdLogHeader sHeader ;
+
 // Sample counter for file
 static uint32_t sSampleCount = 0 ;
 
+// Double buffer: samples fill one half while the
+// other waits for SdLogger_Service. Records may
+// straddle the two halves.
+static uint8_t sBuffer[2][kSdBufferSize] __attribute__((aligned(4))) ;
+static uint8_t sFillHalf = 0 ;
+static uint32_t sFillBytes = 0 ;
+static bool sHalfPending[2] = { false, false } ;
+
+// Bytes written to the file so far (header included)
+static uint32_t sFileBytes = 0 ;
+static bool sPreallocated = false ;
+static bool sWriteError = false ;
+static uint32_t sMaxWriteUs = 0 ;
+
+// Preallocated extent: first sector of the file on
+// the card. Buffer halves go there directly through
+// the async driver, bypassing FatFs.
+static LBA_t sDataSector = 0 ;
+static bool sHalfWriting = false ;
+
+//----------------------------------------------
+// Internal: Check for a FLTnnnnn.BIN name
+// Returns the file number, or 0 if not a log
+//----------------------------------------------
+static uint32_t ParseFlightFilename(const char * inName)
+{
+  if (toupper((unsigned char)inName[0]) != 'F' ||
+      toupper((unsigned char)inName[1]) != 'L' ||
+      toupper((unsigned char)inName[2]) != 'T')
+  {
+    return 0 ;
+  }
+
+  uint32_t theNumber = 0 ;
+  int i = 3 ;
+  while (isdigit((unsigned char)inName[i]))
+  {
+    theNumber = theNumber * 10 + (uint32_t)(inName[i] - '0') ;
+    i++ ;
+  }
+
+  if (i == 3 || inName[i] != '.' ||
+      toupper((unsigned char)inName[i + 1]) != 'B' ||
+      toupper((unsigned char)inName[i + 2]) != 'I' ||
+      toupper((unsigned char)inName[i + 3]) != 'N' ||
+      inName[i + 4] != '\0')
+  {
+    return 0 ;
+  }
+
+  return theNumber ;
+}
+
 //----------------------------------------------
 // Function: SdLogger_Init
 //----------------------------------------------
@@ -62,6 +121,24 @@ bool SdLogger_Init(void)
     printf("SD: Warning - could not create flights directory (error %d)\n", theResult) ;
   }
 
+  // Continue numbering after the highest existing log
+  DIR theDir ;
+  FILINFO theFileInfo ;
+  if (f_opendir(&theDir, "flights") == FR_OK)
+  {
+    while (f_readdir(&theDir, &theFileInfo) == FR_OK && theFileInfo.fname[0] != 0)
+    {
+      if (theFileInfo.fattrib & AM_DIR) continue ;
+
+      uint32_t theNumber = ParseFlightFilename(theFileInfo.fname) ;
+      if (theNumber >= sNextFileNumber)
+      {
+        sNextFileNumber = theNumber + 1 ;
+      }
+    }
+    f_closedir(&theDir) ;
+  }
+
   sSdAvailable = true ;
   return true ;
 }
@@ -74,6 +151,14 @@ bool SdLogger_IsAvailable(void)
   return sSdAvailable ;
 }
 
+//----------------------------------------------
+// Function: SdLogger_IsLogging
+//----------------------------------------------
+bool SdLogger_IsLogging(void)
+{
+  return sFlightInProgress ;
+}
+
 //----------------------------------------------
 // Function: SdLogger_GetFreeSpace
 //----------------------------------------------
@@ -94,19 +179,33 @@ uint32_t SdLogger_GetFreeSpace(void)
 }
 
 //----------------------------------------------
-// Internal: Write string to file
+// Internal: Write a buffer to the log file
+// Full-sector writes at sector-aligned offsets go
+// straight to disk_write as one multi-block
+// transfer; FatFs does not copy them.
 //----------------------------------------------
-static bool WriteString(const char * inStr)
+static bool WriteBlock(const uint8_t * inData, uint32_t inLen)
 {
+  if (sWriteError) return false ;
+
   UINT theBytesWritten ;
-  FRESULT theResult = f_write(&sFile, inStr, strlen(inStr), &theBytesWritten) ;
-  return (theResult == FR_OK && theBytesWritten == strlen(inStr)) ;
+  FRESULT theResult = f_write(&sFile, inData, inLen, &theBytesWritten) ;
+
+  if (theResult != FR_OK || theBytesWritten != inLen)
+  {
+    printf("SD: Write failed (error %d)\n", theResult) ;
+    sWriteError = true ;
+    return false ;
+  }
+
+  sFileBytes += inLen ;
+  return true ;
 }
 
 //----------------------------------------------
 // Function: SdLogger_StartFlight
 //----------------------------------------------
-bool SdLogger_StartFlight(uint32_t inTimestamp)
+bool SdLogger_StartFlight(uint32_t inSampleRateHz)
 {
   if (!sSdAvailable) return false ;
 
@@ -116,9 +215,9 @@ bool SdLogger_StartFlight(uint32_t inTimestamp)
     SdLogger_EndFlight(0, 0, 0) ;
   }
 
-  // Create filename from timestamp
+  // Create filename from the next file number
   snprintf(sCurrentFilename, sizeof(sCurrentFilename),
-           "flights/flight_%lu.csv", (unsigned long)inTimestamp) ;
+           "flights/FLT%05lu.BIN", (unsigned long)sNextFileNumber) ;
 
   printf("SD: Creating file: %s\n", sCurrentFilename) ;
 
@@ -132,10 +231,60 @@ bool SdLogger_StartFlight(uint32_t inTimestamp)
 
   sFileOpen = true ;
 
-  // Write CSV header
-  WriteString("time_ms,altitude_m,velocity_mps,pressure_pa,temperature_c\n") ;
+  // Reserve one contiguous extent now so the flight
+  // never allocates clusters. Without it logging
+  // still works, just with FAT updates in flight.
+  theResult = f_expand(&sFile, kSdPreallocBytes, 1) ;
+  sPreallocated = (theResult == FR_OK) ;
+  if (sPreallocated)
+  {
+    // The extent is contiguous, so file offset N is
+    // card sector sDataSector + N / 512
+    sDataSector = sFatFs.database + (LBA_t)(sFile.obj.sclust - 2) * sFatFs.csize ;
+  }
+  else
+  {
+    printf("SD: Warning - preallocation failed (error %d)\n", theResult) ;
+  }
+
+  // Header occupies the whole first sector so samples
+  // start sector-aligned
+  memset(&sHeader, 0, sizeof(sHeader)) ;
+  sHeader.pMagic = kSdLogMagic ;
+  sHeader.pVersion = kSdLogVersion ;
+  sHeader.pSampleSize = sizeof(FlightSample) ;
+  sHeader.pFileNumber = sNextFileNumber ;
+  sHeader.pSampleCount = kSdSampleCountOpen ;
+  sHeader.pSampleRateHz = inSampleRateHz ;
+
+  memset(sBuffer[0], 0, kSdSectorSize) ;
+  memcpy(sBuffer[0], &sHeader, sizeof(sHeader)) ;
+
+  sFileBytes = 0 ;
+  sWriteError = false ;
+  sMaxWriteUs = 0 ;
+
+  // Commit the directory entry (start cluster and
+  // full size) now; a log cut short by power loss
+  // is still recoverable up to the last write
+  if (!WriteBlock(sBuffer[0], kSdSectorSize) || f_sync(&sFile) != FR_OK)
+  {
+    printf("SD: Failed to write header\n") ;
+    f_close(&sFile) ;
+    f_unlink(sCurrentFilename) ;
+    sFileOpen = false ;
+    sCurrentFilename[0] = '\0' ;
+    return false ;
+  }
 
+  sNextFileNumber++ ;
   sSampleCount = 0 ;
+  sHeader.pDroppedSamples = 0 ;
+  sFillHalf = 0 ;
+  sFillBytes = 0 ;
+  sHalfPending[0] = false ;
+  sHalfPending[1] = false ;
+  sHalfWriting = false ;
   sFlightInProgress = true ;
 
   printf("SD: Started flight log\n") ;
@@ -145,29 +294,111 @@ bool SdLogger_StartFlight(uint32_t inTimestamp)
 //----------------------------------------------
 // Function: SdLogger_LogSample
 //----------------------------------------------
-bool SdLogger_LogSample(const SdFlightSample * inSample)
+bool SdLogger_LogSample(const FlightSample * inSample)
 {
   if (!sFlightInProgress || !sFileOpen || inSample == NULL) return false ;
 
-  // Format and write sample to file
-  char theBuffer[128] ;
-  snprintf(theBuffer, sizeof(theBuffer), "%lu,%.2f,%.2f,%.1f,%.2f\n",
-           (unsigned long)inSample->timeMs,
-           inSample->altitudeM,
-           inSample->velocityMps,
-           inSample->pressurePa,
-           inSample->temperatureC) ;
-  WriteString(theBuffer) ;
+  const uint8_t * theSrc = (const uint8_t *)inSample ;
+  uint32_t theLen = sizeof(FlightSample) ;
+  uint32_t theRoom = kSdBufferSize - sFillBytes ;
+
+  // Drop rather than block if the sample would spill
+  // into a half that has not been written yet, or
+  // past the preallocated extent
+  bool theSpills = (theLen >= theRoom) ;
+  bool theFull = sPreallocated &&
+    (sFileBytes + (sHalfPending[sFillHalf ^ 1] ? kSdBufferSize : 0) +
+     sFillBytes + theLen > kSdPreallocBytes) ;
+  if ((theSpills && sHalfPending[sFillHalf ^ 1]) || theFull || sWriteError)
+  {
+    sHeader.pDroppedSamples++ ;
+    return false ;
+  }
+
+  if (theSpills)
+  {
+    // Fill the current half, hand it to Service and
+    // continue in the other one
+    memcpy(&sBuffer[sFillHalf][sFillBytes], theSrc, theRoom) ;
+    sHalfPending[sFillHalf] = true ;
+    sFillHalf ^= 1 ;
+    sFillBytes = theLen - theRoom ;
+    memcpy(sBuffer[sFillHalf], theSrc + theRoom, sFillBytes) ;
+  }
+  else
+  {
+    memcpy(&sBuffer[sFillHalf][sFillBytes], theSrc, theLen) ;
+    sFillBytes += theLen ;
+  }
 
   sSampleCount++ ;
+  return true ;
+}
+
+//----------------------------------------------
+// Function: SdLogger_Service
+//----------------------------------------------
+bool SdLogger_Service(void)
+{
+  if (!sFlightInProgress) return !sWriteError ;
 
-  // Sync periodically (every 100 samples) to prevent data loss
-  if ((sSampleCount % 100) == 0)
+  // Only the half not being filled can be pending
+  uint8_t theHalf = sFillHalf ^ 1 ;
+  if (!sHalfPending[theHalf])
   {
-    f_sync(&sFile) ;
+    return !sWriteError ;
   }
 
-  return true ;
+  uint32_t theStartUs = time_us_32() ;
+
+  if (!sPreallocated)
+  {
+    // Cluster allocation needed: synchronous FatFs write
+    WriteBlock(sBuffer[theHalf], kSdBufferSize) ;
+    sHalfPending[theHalf] = false ;
+  }
+  else if (!sHalfWriting)
+  {
+    // Kick off the multi-block write; the card
+    // programs while the main loop carries on
+    uint32_t theSector = sDataSector + sFileBytes / kSdSectorSize ;
+    if (SdDisk_WriteStart(sBuffer[theHalf], theSector, kSdBufferSectors))
+    {
+      sHalfWriting = true ;
+    }
+    else
+    {
+      sWriteError = true ;
+      sHalfPending[theHalf] = false ;
+    }
+  }
+  else
+  {
+    SdDiskState theState = SdDisk_WritePoll() ;
+    if (theState != kSdDiskBusy)
+    {
+      if (theState == kSdDiskDone)
+      {
+        sFileBytes += kSdBufferSize ;
+      }
+      else
+      {
+        printf("SD: Direct write failed\n") ;
+        sWriteError = true ;
+      }
+      sHalfWriting = false ;
+      sHalfPending[theHalf] = false ;
+    }
+  }
+
+  // Longest time the main loop spent in here
+  uint32_t theElapsedUs = time_us_32() - theStartUs ;
+  if (theElapsedUs > sMaxWriteUs)
+  {
+    sMaxWriteUs = theElapsedUs ;
+  }
+
+  return !sWriteError ;
 }
 
 //----------------------------------------------
@@ -177,37 +408,150 @@ bool SdLogger_EndFlight(float inMaxAltitudeM, uint32_t inFlightTimeMs, float inM
 {
   if (!sFlightInProgress) return false ;
 
-  // Write summary comment at end of file
+  bool theOk = false ;
+
   if (sFileOpen)
   {
-    char theBuffer[64] ;
+    // Flush the pending half, then the partial one.
+    // Direct writes bypass FatFs, so reposition it.
+    while (sHalfPending[sFillHalf ^ 1] && !sWriteError)
+    {
+      SdLogger_Service() ;
+    }
+    f_lseek(&sFile, sFileBytes) ;
+    if (sFillBytes > 0)
+    {
+      WriteBlock(sBuffer[sFillHalf], sFillBytes) ;
+    }
 
-    WriteString("# Summary\n") ;
+    // Give back the unused part of the preallocation
+    f_truncate(&sFile) ;
 
-    snprintf(theBuffer, sizeof(theBuffer), "# Samples: %lu\n", (unsigned long)sSampleCount) ;
-    WriteString(theBuffer) ;
+    sHeader.pSampleCount = sSampleCount ;
+    sHeader.pMaxAltitudeM = inMaxAltitudeM ;
+    sHeader.pMaxVelocityMps = inMaxVelocityMps ;
+    sHeader.pFlightTimeMs = inFlightTimeMs ;
+    sHeader.pMaxWriteUs = sMaxWriteUs ;
 
-    snprintf(theBuffer, sizeof(theBuffer), "# Max Altitude: %.2f m\n", inMaxAltitudeM) ;
-    WriteString(theBuffer) ;
+    UINT theBytesWritten = 0 ;
+    theOk = !sWriteError &&
+      f_lseek(&sFile, 0) == FR_OK &&
+      f_write(&sFile, &sHeader, sizeof(sHeader), &theBytesWritten) == FR_OK &&
+      theBytesWritten == sizeof(sHeader) ;
 
-    snprintf(theBuffer, sizeof(theBuffer), "# Max Velocity: %.2f m/s\n", inMaxVelocityMps) ;
-    WriteString(theBuffer) ;
+    // Close file
+    if (f_close(&sFile) != FR_OK)
+    {
+      theOk = false ;
+    }
+    sFileOpen = false ;
 
-    snprintf(theBuffer, sizeof(theBuffer), "# Flight Time: %lu ms\n", (unsigned long)inFlightTimeMs) ;
-    WriteString(theBuffer) ;
+    printf("SD: Flight complete - %lu samples saved to %s (max write %lu us)\n",
+           (unsigned long)sSampleCount, sCurrentFilename, (unsigned long)sMaxWriteUs) ;
+  }
 
-    // Close file
+  sFlightInProgress = false ;
+  strcpy(sLastFilename, sCurrentFilename) ;
+  sCurrentFilename[0] = '\0' ;
+
+  return theOk ;
+}
+
+//----------------------------------------------
+// Function: SdLogger_AbortFlight
+//----------------------------------------------
+void SdLogger_AbortFlight(void)
+{
+  if (!sFlightInProgress) return ;
+
+  if (sFileOpen)
+  {
     f_close(&sFile) ;
     sFileOpen = false ;
+  }
 
-    printf("SD: Flight complete - %lu samples saved to %s\n",
-           (unsigned long)sSampleCount, sCurrentFilename) ;
+  if (sSampleCount == 0)
+  {
+    f_unlink(sCurrentFilename) ;
+    sNextFileNumber-- ;
+    printf("SD: Discarded empty log %s\n", sCurrentFilename) ;
+  }
+  else
+  {
+    strcpy(sLastFilename, sCurrentFilename) ;
   }
 
   sFlightInProgress = false ;
-  strcpy(sLastFilename, sCurrentFilename) ;
   sCurrentFilename[0] = '\0' ;
+}
+
+//----------------------------------------------
+// Function: SdLogger_GetMaxWriteUs
+//----------------------------------------------
+uint32_t SdLogger_GetMaxWriteUs(void)
+{
+  return sMaxWriteUs ;
+}
+
+//----------------------------------------------
+// Function: SdLogger_Benchmark
+//----------------------------------------------
+bool SdLogger_Benchmark(uint32_t inBytes, uint32_t * outWriteKBps, uint32_t * outReadKBps)
+{
+  if (!sSdAvailable || sFlightInProgress || outWriteKBps == NULL || outReadKBps == NULL)
+  {
+    return false ;
+  }
+
+  const char * thePath = "flights/BENCH.TMP" ;
+  uint32_t theBytes = (inBytes / kSdBufferSize) * kSdBufferSize ;
+  if (theBytes == 0) return false ;
+
+  if (f_open(&sFile, thePath, FA_WRITE | FA_READ | FA_CREATE_ALWAYS) != FR_OK)
+  {
+    return false ;
+  }
+
+  bool theOk = (f_expand(&sFile, theBytes, 1) == FR_OK) ;
+  LBA_t theSector = sFatFs.database + (LBA_t)(sFile.obj.sclust - 2) * sFatFs.csize ;
+
+  // Write: same path and block size as a flight
+  memset(sBuffer, 0xA5, sizeof(sBuffer)) ;
+  uint32_t theStartUs = time_us_32() ;
+  for (uint32_t theOffset = 0 ; theOk && theOffset < theBytes ; theOffset += kSdBufferSize)
+  {
+    theOk = SdDisk_WriteStart(sBuffer[0], theSector + theOffset / kSdSectorSize, kSdBufferSectors) ;
+    SdDiskState theState = kSdDiskBusy ;
+    while (theOk && (theState = SdDisk_WritePoll()) == kSdDiskBusy)
+    {
+      tight_loop_contents() ;
+    }
+    theOk = theOk && (theState == kSdDiskDone) ;
+  }
+  uint32_t theWriteUs = time_us_32() - theStartUs ;
+
+  // Read: whole-buffer f_read goes straight to CMD18
+  theOk = theOk && (f_lseek(&sFile, 0) == FR_OK) ;
+  theStartUs = time_us_32() ;
+  for (uint32_t theOffset = 0 ; theOk && theOffset < theBytes ; theOffset += sizeof(sBuffer))
+  {
+    UINT theBytesRead = 0 ;
+    theOk = (f_read(&sFile, sBuffer, sizeof(sBuffer), &theBytesRead) == FR_OK) && theBytesRead > 0 ;
+  }
+  uint32_t theReadUs = time_us_32() - theStartUs ;
+
+  f_close(&sFile) ;
+  f_unlink(thePath) ;
+
+  if (!theOk || theWriteUs == 0 || theReadUs == 0) return false ;
+
+  // bytes/us == MB/s, so bytes * 1000 / us == KB/s
+  *outWriteKBps = (uint32_t)(((uint64_t)theBytes * 1000) / theWriteUs) ;
+  *outReadKBps = (uint32_t)(((uint64_t)theBytes * 1000) / theReadUs) ;
 
+  printf("SD: Benchmark %lu KB/s write, %lu KB/s read (DMA %s)\n",
+         (unsigned long)*outWriteKBps, (unsigned long)*outReadKBps,
+         SdDisk_IsDmaEnabled() ? "on" : "off") ;
   return true ;
 }
 
@@ -233,11 +577,11 @@ int SdLogger_ListFlights(char ** outFilenames, int inMaxCount)
     // Skip directories
     if (theFileInfo.fattrib & AM_DIR) continue ;
 
-    // Check for .csv extension
-    size_t theLen = strlen(theFileInfo.fname) ;
-    if (theLen > 4 && strcmp(&theFileInfo.fname[theLen - 4], ".csv") == 0)
+    // Only FLTnnnnn.BIN flight logs
+    if (ParseFlightFilename(theFileInfo.fname) != 0)
     {
       // Copy filename
+      size_t theLen = strlen(theFileInfo.fname) ;
       outFilenames[theCount] = malloc(theLen + 1) ;
       if (outFilenames[theCount] != NULL)
       {
@@ -296,9 +640,8 @@ int SdLogger_GetFlightCount(void)
     // Skip directories
     if (theFileInfo.fattrib & AM_DIR) continue ;
 
-    // Check for .csv extension
-    size_t theLen = strlen(theFileInfo.fname) ;
-    if (theLen > 4 && strcmp(&theFileInfo.fname[theLen - 4], ".csv") == 0)
+    // Only FLTnnnnn.BIN flight logs
+    if (ParseFlightFilename(theFileInfo.fname) != 0)
     {
       theCount++ ;
     }
@@ -330,9 +673,8 @@ int SdLogger_GetFileList(SdFileInfo * outFiles, int inMaxCount)
     // Skip directories
     if (theFileInfo.fattrib & AM_DIR) continue ;
 
-    // Check for .csv extension
-    size_t theLen = strlen(theFileInfo.fname) ;
-    if (theLen > 4 && strcmp(&theFileInfo.fname[theLen - 4], ".csv") == 0)
+    // Only FLTnnnnn.BIN flight logs
+    if (ParseFlightFilename(theFileInfo.fname) != 0)
     {
       strncpy(outFiles[theCount].pFilename, theFileInfo.fname, sizeof(outFiles[theCount].pFilename) - 1) ;
       outFiles[theCount].pFilename[sizeof(outFiles[theCount].pFilename) - 1] = '\0' ;
@@ -1,7 +1,8 @@
 //----------------------------------------------
 // Module: storage.c
 // Description: Flash storage implementation for
-//   calibration data persistence
+//   calibration data and device settings
+//   (append-only key/value record log)
 // Author: Mark Gavin
 // Created: 2025-11-29
 // Copyright: (c) 2025 by Mark Gavin
@@ -9,6 +10,7 @@
 //----------------------------------------------
 
 #include "storage.h"
+#include "crc32.h"
 
 #include "pico/stdlib.h"
 #include "hardware/flash.h"
@@ -24,198 +26,520 @@
 //----------------------------------------------
 // Adafruit Feather RP2040 has 8MB (0x800000) flash
 // Layout (from end of flash):
-//   0x7FF000 - Calibration (last sector) - used by storage.c
+//   0x7FF000 - Legacy calibration (read once for migration)
 //   0x7FE000 - Flight index - used by flight_storage.c
-//   0x7FD000 - Device settings (rocket ID, etc.) - used by storage.c
-//   0x780000-0x7FCFFF - Flight data slots - used by flight_storage.c
+//   0x7FD000 - Legacy device settings (read once for migration)
+//   0x7FC000 - Settings log sector B - used by storage.c
+//   0x7FB000 - Settings log sector A - used by storage.c
+//   0x7FA000 - Event journal - used by event_journal.c
+//   0x780000-0x7EFFFF - Flight data slots - used by flight_storage.c
 #define kFeatherFlashSize     0x800000    // 8MB
 #define kFlashTargetOffset    (kFeatherFlashSize - FLASH_SECTOR_SIZE)           // 0x7FF000
 #define kFlashSettingsOffset  (kFeatherFlashSize - (3 * FLASH_SECTOR_SIZE))     // 0x7FD000
+#define kSettingsLogOffsetA   (kFeatherFlashSize - (5 * FLASH_SECTOR_SIZE))     // 0x7FB000
+#define kSettingsLogOffsetB   (kFeatherFlashSize - (4 * FLASH_SECTOR_SIZE))     // 0x7FC000
 
 // Pointer to flash storage location (read as memory-mapped)
 #define kFlashStoragePtr ((const CalibrationData *)(XIP_BASE + kFlashTargetOffset))
 #define kFlashSettingsPtr ((const DeviceSettings *)(XIP_BASE + kFlashSettingsOffset))
 
 //----------------------------------------------
-// Function: Storage_Init
+// Settings Log Format
 //----------------------------------------------
-bool Storage_Init(void)
-{
-  // Flash is always available on Pico
-  // Print storage addresses for debugging
-  printf("Flash storage: calibration at 0x%08X (offset 0x%08X)\n",
-         (unsigned int)(XIP_BASE + kFlashTargetOffset),
-         (unsigned int)kFlashTargetOffset) ;
+// Each log sector starts with an 8-byte header
+// (magic, generation). Records follow back to back:
+//   key(1), length(1), value(length), crc32(4)
+// padded to a 4-byte boundary. The CRC covers key,
+// length and value. A key byte of 0xFF marks the
+// end of the log (erased flash). The newest record
+// for a key wins; length 0 marks a deleted key.
+//
+// Appending only programs the page(s) holding the
+// new record. When the active sector is full, the
+// latest record for each key is copied into the
+// other sector, whose header is written last.
+#define kSettingsLogMagic     0x474F4C53  // "SLOG"
+#define kLogHeaderSize        8
+#define kRecordOverhead       6           // key + length + crc32
+#define kMaxRecordSize        ((kRecordOverhead + kSettingMaxValueLen + 3) & ~3)
+
+#define RecordSize(inLength)  ((kRecordOverhead + (inLength) + 3) & ~3u)
 
-  return true ;
-} // end Storage_Init
+//----------------------------------------------
+// Module State
+//----------------------------------------------
+static bool sInitialized = false ;
+static uint32_t sActiveOffset = kSettingsLogOffsetA ;
+static uint32_t sGeneration = 0 ;
+static uint32_t sWriteOffset = kLogHeaderSize ;
+
+// Offset of the newest record for each key (0 = none)
+static uint16_t sKeyOffset[kMaxSettingKeys] ;
 
 //----------------------------------------------
-// Function: Storage_SaveCalibration
+// Internal: Log sector pointer (memory-mapped)
 //----------------------------------------------
-bool Storage_SaveCalibration(
-  int32_t inOffset ,
-  float inScaleFactor)
+static const uint8_t * LogPtr(uint32_t inSectorOffset)
 {
-  printf("Storage: Saving calibration (offset=%ld, scale=%.4f)...\n",
-         (long)inOffset, inScaleFactor) ;
+  return (const uint8_t *)(XIP_BASE + inSectorOffset) ;
+} // end LogPtr
 
-  // Prepare calibration data
-  CalibrationData theData ;
-  theData.pMagic = kCalibrationMagic ;
-  theData.pVersion = kCalibrationVersion ;
-  theData.pOffset = inOffset ;
-  theData.pScaleFactor = inScaleFactor ;
-
-  // Calculate checksum (simple sum of all bytes)
-  uint32_t theChecksum = 0 ;
-  const uint8_t * theBytes = (const uint8_t *)&theData ;
-  for (size_t theIndex = 0 ; theIndex < offsetof(CalibrationData, pChecksum) ; theIndex++)
-  {
-    theChecksum += theBytes[theIndex] ;
-  } // end for checksum
-  theData.pChecksum = theChecksum ;
+//----------------------------------------------
+// Internal: Program bytes into erased flash
+// Bytes outside the range are programmed as 0xFF,
+// which leaves existing flash contents unchanged.
+//----------------------------------------------
+static void ProgramBytes(
+  uint32_t inFlashOffset ,
+  const uint8_t * inData ,
+  uint32_t inSize)
+{
+  uint8_t thePage[FLASH_PAGE_SIZE] ;
 
-  // Prepare buffer aligned to flash page size
-  uint8_t theBuffer[FLASH_PAGE_SIZE] ;
-  memset(theBuffer, 0xFF, sizeof(theBuffer)) ;
-  memcpy(theBuffer, &theData, sizeof(CalibrationData)) ;
+  while (inSize > 0)
+  {
+    uint32_t thePageOffset = inFlashOffset & ~(FLASH_PAGE_SIZE - 1) ;
+    uint32_t theInPage = inFlashOffset - thePageOffset ;
+    uint32_t theChunk = FLASH_PAGE_SIZE - theInPage ;
+    if (theChunk > inSize)
+    {
+      theChunk = inSize ;
+    } // end if partial page
+
+    memset(thePage, 0xFF, sizeof(thePage)) ;
+    memcpy(thePage + theInPage, inData, theChunk) ;
+
+    // A page program takes well under a millisecond
+    uint32_t theInterrupts = save_and_disable_interrupts() ;
+    flash_range_program(thePageOffset, thePage, FLASH_PAGE_SIZE) ;
+    restore_interrupts(theInterrupts) ;
+
+    inFlashOffset += theChunk ;
+    inData += theChunk ;
+    inSize -= theChunk ;
+  } // end while bytes remain
+} // end ProgramBytes
 
+//----------------------------------------------
+// Internal: Erase a log sector
+//----------------------------------------------
+static void EraseSector(uint32_t inSectorOffset)
+{
   // Flush stdio before flash operations (USB CDC may stall)
   stdio_flush() ;
 
-  // Disable interrupts during flash operations
   uint32_t theInterrupts = save_and_disable_interrupts() ;
+  flash_range_erase(inSectorOffset, FLASH_SECTOR_SIZE) ;
+  restore_interrupts(theInterrupts) ;
+} // end EraseSector
 
-  // Erase the sector
-  flash_range_erase(kFlashTargetOffset, FLASH_SECTOR_SIZE) ;
+//----------------------------------------------
+// Internal: Write a log sector header
+//----------------------------------------------
+static void WriteHeader(uint32_t inSectorOffset , uint32_t inGeneration)
+{
+  uint32_t theHeader[2] = { kSettingsLogMagic, inGeneration } ;
+  ProgramBytes(inSectorOffset, (const uint8_t *)theHeader, kLogHeaderSize) ;
+} // end WriteHeader
 
-  // Program the data
-  flash_range_program(kFlashTargetOffset, theBuffer, FLASH_PAGE_SIZE) ;
+//----------------------------------------------
+// Internal: Build a record in RAM
+// Returns: record size in bytes
+//----------------------------------------------
+static uint32_t BuildRecord(
+  uint8_t * outRecord ,
+  uint8_t inKey ,
+  const void * inValue ,
+  uint8_t inLength)
+{
+  uint32_t theSize = RecordSize(inLength) ;
+  memset(outRecord, 0xFF, theSize) ;
 
-  restore_interrupts(theInterrupts) ;
+  outRecord[0] = inKey ;
+  outRecord[1] = inLength ;
+  if (inLength > 0)
+  {
+    memcpy(outRecord + 2, inValue, inLength) ;
+  } // end if value
 
-  printf("Storage: Calibration saved\n") ;
+  uint32_t theCrc = Crc32_Compute(outRecord, 2 + inLength) ;
+  memcpy(outRecord + 2 + inLength, &theCrc, sizeof(theCrc)) ;
 
-  // Verify write
-  return Storage_HasCalibration() ;
-} // end Storage_SaveCalibration
+  return theSize ;
+} // end BuildRecord
 
 //----------------------------------------------
-// Function: Storage_LoadCalibration
+// Internal: Scan the active sector
+// Rebuilds the key table and finds the end of log.
 //----------------------------------------------
-bool Storage_LoadCalibration(
-  int32_t * outOffset ,
-  float * outScaleFactor)
+static void ScanLog(void)
 {
-  if (outOffset == NULL || outScaleFactor == NULL)
+  const uint8_t * theLog = LogPtr(sActiveOffset) ;
+
+  memset(sKeyOffset, 0, sizeof(sKeyOffset)) ;
+  sWriteOffset = kLogHeaderSize ;
+
+  while (sWriteOffset + kRecordOverhead <= FLASH_SECTOR_SIZE)
   {
-    return false ;
-  } // end if null
+    const uint8_t * theRecord = theLog + sWriteOffset ;
+    uint8_t theKey = theRecord[0] ;
+    uint8_t theLength = theRecord[1] ;
+
+    if (theKey == 0xFF)
+    {
+      break ;  // Erased flash - end of log
+    } // end if end of log
+
+    // A torn record leaves garbage; force compaction on next write
+    uint32_t theSize = RecordSize(theLength) ;
+    if (theLength > kSettingMaxValueLen || sWriteOffset + theSize > FLASH_SECTOR_SIZE)
+    {
+      sWriteOffset = FLASH_SECTOR_SIZE ;
+      break ;
+    } // end if bad length
+
+    uint32_t theStoredCrc ;
+    memcpy(&theStoredCrc, theRecord + 2 + theLength, sizeof(theStoredCrc)) ;
+
+    if (theKey < kMaxSettingKeys &&
+        Crc32_Compute(theRecord, 2 + theLength) == theStoredCrc)
+    {
+      sKeyOffset[theKey] = (uint16_t)sWriteOffset ;
+    } // end if valid record
+
+    sWriteOffset += theSize ;
+  } // end while records
+
+  printf("Storage: Log at 0x%08lX gen %lu, %lu bytes used\n",
+         (unsigned long)sActiveOffset, (unsigned long)sGeneration,
+         (unsigned long)sWriteOffset) ;
+} // end ScanLog
 
-  // Check if valid calibration exists
-  if (!Storage_HasCalibration())
+//----------------------------------------------
+// Internal: Compact into the other sector
+// Copies the newest record of every key, replacing
+// inKey with the new value, then writes the header.
+//----------------------------------------------
+static bool CompactLog(
+  uint8_t inKey ,
+  const void * inValue ,
+  uint8_t inLength)
+{
+  uint32_t theTarget = (sActiveOffset == kSettingsLogOffsetA) ?
+    kSettingsLogOffsetB : kSettingsLogOffsetA ;
+  const uint8_t * theLog = LogPtr(sActiveOffset) ;
+
+  printf("Storage: Compacting settings log\n") ;
+
+  EraseSector(theTarget) ;
+
+  uint8_t theRecord[kMaxRecordSize] ;
+  uint32_t theWriteOffset = kLogHeaderSize ;
+  uint16_t theNewOffsets[kMaxSettingKeys] ;
+  memset(theNewOffsets, 0, sizeof(theNewOffsets)) ;
+
+  for (uint8_t theKey = 0 ; theKey < kMaxSettingKeys ; theKey++)
   {
-    return false ;
-  } // end if no calibration
+    uint32_t theSize = 0 ;
+
+    if (theKey == inKey)
+    {
+      if (inLength > 0)
+      {
+        theSize = BuildRecord(theRecord, inKey, inValue, inLength) ;
+      } // end if not a delete
+    }
+    else if (sKeyOffset[theKey] != 0)
+    {
+      // Copy out of XIP before programming
+      const uint8_t * theSource = theLog + sKeyOffset[theKey] ;
+      if (theSource[1] > 0)
+      {
+        theSize = RecordSize(theSource[1]) ;
+        memcpy(theRecord, theSource, theSize) ;
+      } // end if not deleted
+    } // end if key present
+
+    if (theSize > 0)
+    {
+      ProgramBytes(theTarget + theWriteOffset, theRecord, theSize) ;
+      theNewOffsets[theKey] = (uint16_t)theWriteOffset ;
+      theWriteOffset += theSize ;
+    } // end if record to copy
+  } // end for keys
+
+  // Header last: an interrupted compaction leaves the old sector active
+  WriteHeader(theTarget, sGeneration + 1) ;
+
+  sActiveOffset = theTarget ;
+  sGeneration++ ;
+  sWriteOffset = theWriteOffset ;
+  memcpy(sKeyOffset, theNewOffsets, sizeof(sKeyOffset)) ;
+
+  return true ;
+} // end CompactLog
 
-  // Read from flash (memory-mapped)
-  *outOffset = kFlashStoragePtr->pOffset ;
-  *outScaleFactor = kFlashStoragePtr->pScaleFactor ;
+//----------------------------------------------
+// Internal: Import legacy sectors into the log
+//----------------------------------------------
+static void MigrateLegacy(void)
+{
+  // Legacy calibration (version 1 byte sum, version 2 CRC32)
+  const CalibrationData * theCal = kFlashStoragePtr ;
+  if (theCal->pMagic == kCalibrationMagic)
+  {
+    uint32_t theChecksum = 0 ;
+    if (theCal->pVersion == kCalibrationVersion)
+    {
+      theChecksum = Crc32_Compute(theCal, offsetof(CalibrationData, pChecksum)) ;
+    }
+    else
+    {
+      const uint8_t * theBytes = (const uint8_t *)theCal ;
+      for (size_t theIndex = 0 ; theIndex < offsetof(CalibrationData, pChecksum) ; theIndex++)
+      {
+        theChecksum += theBytes[theIndex] ;
+      } // end for checksum
+    } // end if version
+
+    if (theChecksum == theCal->pChecksum)
+    {
+      Storage_SaveCalibration(theCal->pOffset, theCal->pScaleFactor) ;
+    } // end if valid
+  } // end if calibration
+
+  // Legacy device settings (checksum never verified for these)
+  const DeviceSettings * theSettings = kFlashSettingsPtr ;
+  if (theSettings->pMagic == kSettingsMagic &&
+      theSettings->pVersion >= 1 && theSettings->pVersion <= kSettingsVersion)
+  {
+    if (theSettings->pRocketId <= 15)
+    {
+      Storage_SaveRocketId(theSettings->pRocketId) ;
+    } // end if valid ID
+
+    if (theSettings->pVersion >= 2 && theSettings->pRocketName[0] != '\0' &&
+        (uint8_t)theSettings->pRocketName[0] != 0xFF)
+    {
+      char theName[kRocketNameMaxLen] ;
+      strncpy(theName, theSettings->pRocketName, kRocketNameMaxLen - 1) ;
+      theName[kRocketNameMaxLen - 1] = '\0' ;
+      Storage_SaveRocketName(theName) ;
+    } // end if name
+  } // end if settings
+} // end MigrateLegacy
 
+//----------------------------------------------
+// Function: Storage_Init
+//----------------------------------------------
+bool Storage_Init(void)
+{
+  if (sInitialized)
+  {
+    return true ;
+  } // end if already initialized
+
+  // DMA sniffer for CRC32 (software fallback if no channel)
+  Crc32_Init() ;
+
+  // Pick the valid log sector with the newest generation
+  const uint32_t * theHeaderA = (const uint32_t *)LogPtr(kSettingsLogOffsetA) ;
+  const uint32_t * theHeaderB = (const uint32_t *)LogPtr(kSettingsLogOffsetB) ;
+  bool theValidA = (theHeaderA[0] == kSettingsLogMagic) ;
+  bool theValidB = (theHeaderB[0] == kSettingsLogMagic) ;
+
+  sInitialized = true ;
+
+  if (theValidA && (!theValidB || (int32_t)(theHeaderA[1] - theHeaderB[1]) >= 0))
+  {
+    sActiveOffset = kSettingsLogOffsetA ;
+    sGeneration = theHeaderA[1] ;
+  }
+  else if (theValidB)
+  {
+    sActiveOffset = kSettingsLogOffsetB ;
+    sGeneration = theHeaderB[1] ;
+  }
+  else
+  {
+    // First boot with the log: format sector A and import old settings
+    printf("Storage: Creating settings log\n") ;
+    EraseSector(kSettingsLogOffsetA) ;
+    WriteHeader(kSettingsLogOffsetA, 1) ;
+    sActiveOffset = kSettingsLogOffsetA ;
+    sGeneration = 1 ;
+    ScanLog() ;
+    MigrateLegacy() ;
+    return true ;
+  } // end if sector selection
+
+  ScanLog() ;
   return true ;
-} // end Storage_LoadCalibration
+} // end Storage_Init
 
 //----------------------------------------------
-// Function: Storage_HasCalibration
+// Function: Storage_WriteSetting
 //----------------------------------------------
-bool Storage_HasCalibration(void)
+bool Storage_WriteSetting(
+  uint8_t inKey ,
+  const void * inValue ,
+  uint8_t inLength)
 {
-  // Check magic number
-  if (kFlashStoragePtr->pMagic != kCalibrationMagic)
+  if (inKey >= kMaxSettingKeys || inLength > kSettingMaxValueLen ||
+      (inLength > 0 && inValue == NULL))
   {
     return false ;
-  } // end if wrong magic
+  } // end if invalid
+
+  Storage_Init() ;
+
+  // Skip the write if the newest record already holds this value
+  if (sKeyOffset[inKey] != 0)
+  {
+    const uint8_t * theRecord = LogPtr(sActiveOffset) + sKeyOffset[inKey] ;
+    if (theRecord[1] == inLength &&
+        (inLength == 0 || memcmp(theRecord + 2, inValue, inLength) == 0))
+    {
+      return true ;
+    } // end if unchanged
+  }
+  else if (inLength == 0)
+  {
+    return true ;  // Deleting a key that is not present
+  } // end if existing record
 
-  // Check version
-  if (kFlashStoragePtr->pVersion != kCalibrationVersion)
+  uint32_t theSize = RecordSize(inLength) ;
+  if (sWriteOffset + theSize > FLASH_SECTOR_SIZE)
+  {
+    return CompactLog(inKey, inValue, inLength) ;
+  } // end if sector full
+
+  uint8_t theRecord[kMaxRecordSize] ;
+  BuildRecord(theRecord, inKey, inValue, inLength) ;
+  ProgramBytes(sActiveOffset + sWriteOffset, theRecord, theSize) ;
+
+  sKeyOffset[inKey] = (uint16_t)sWriteOffset ;
+  sWriteOffset += theSize ;
+
+  return true ;
+} // end Storage_WriteSetting
+
+//----------------------------------------------
+// Function: Storage_ReadSetting
+//----------------------------------------------
+bool Storage_ReadSetting(
+  uint8_t inKey ,
+  void * outValue ,
+  uint8_t inMaxLength ,
+  uint8_t * outLength)
+{
+  if (inKey >= kMaxSettingKeys || outValue == NULL)
   {
     return false ;
-  } // end if wrong version
+  } // end if invalid
 
-  // Verify checksum
-  uint32_t theChecksum = 0 ;
-  const uint8_t * theBytes = (const uint8_t *)kFlashStoragePtr ;
-  for (size_t theIndex = 0 ; theIndex < offsetof(CalibrationData, pChecksum) ; theIndex++)
+  Storage_Init() ;
+
+  if (sKeyOffset[inKey] == 0)
   {
-    theChecksum += theBytes[theIndex] ;
-  } // end for checksum
+    return false ;
+  } // end if not present
 
-  if (theChecksum != kFlashStoragePtr->pChecksum)
+  const uint8_t * theRecord = LogPtr(sActiveOffset) + sKeyOffset[inKey] ;
+  uint8_t theLength = theRecord[1] ;
+  if (theLength == 0 || theLength > inMaxLength)
   {
     return false ;
-  } // end if checksum mismatch
+  } // end if deleted or too large
+
+  memcpy(outValue, theRecord + 2, theLength) ;
+  if (outLength != NULL)
+  {
+    *outLength = theLength ;
+  } // end if length wanted
 
   return true ;
-} // end Storage_HasCalibration
+} // end Storage_ReadSetting
 
 //----------------------------------------------
-// Function: Storage_ClearCalibration
+// Function: Storage_DeleteSetting
 //----------------------------------------------
-bool Storage_ClearCalibration(void)
+bool Storage_DeleteSetting(uint8_t inKey)
 {
-  // Disable interrupts during flash operations
-  uint32_t theInterrupts = save_and_disable_interrupts() ;
+  return Storage_WriteSetting(inKey, NULL, 0) ;
+} // end Storage_DeleteSetting
+
+//----------------------------------------------
+// Function: Storage_SaveCalibration
+//----------------------------------------------
+bool Storage_SaveCalibration(
+  int32_t inOffset ,
+  float inScaleFactor)
+{
+  printf("Storage: Saving calibration (offset=%ld, scale=%.4f)...\n",
+         (long)inOffset, inScaleFactor) ;
 
-  // Erase the sector (sets all bytes to 0xFF)
-  flash_range_erase(kFlashTargetOffset, FLASH_SECTOR_SIZE) ;
+  uint8_t theValue[8] ;
+  memcpy(theValue, &inOffset, sizeof(inOffset)) ;
+  memcpy(theValue + 4, &inScaleFactor, sizeof(inScaleFactor)) ;
 
-  restore_interrupts(theInterrupts) ;
+  if (!Storage_WriteSetting(kSettingKeyCalibration, theValue, sizeof(theValue)))
+  {
+    return false ;
+  } // end if write failed
 
-  // Verify erase
-  return !Storage_HasCalibration() ;
-} // end Storage_ClearCalibration
+  printf("Storage: Calibration saved\n") ;
+
+  // Verify write
+  return Storage_HasCalibration() ;
+} // end Storage_SaveCalibration
 
 //----------------------------------------------
-// Internal: Save complete settings structure
+// Function: Storage_LoadCalibration
 //----------------------------------------------
-static bool Storage_SaveSettings(const DeviceSettings * inSettings)
+bool Storage_LoadCalibration(
+  int32_t * outOffset ,
+  float * outScaleFactor)
 {
-  // Prepare a copy with calculated checksum
-  DeviceSettings theData = *inSettings ;
-  theData.pMagic = kSettingsMagic ;
-  theData.pVersion = kSettingsVersion ;
-
-  // Calculate checksum (simple sum of all bytes before checksum)
-  uint32_t theChecksum = 0 ;
-  const uint8_t * theBytes = (const uint8_t *)&theData ;
-  for (size_t theIndex = 0 ; theIndex < offsetof(DeviceSettings, pChecksum) ; theIndex++)
+  if (outOffset == NULL || outScaleFactor == NULL)
   {
-    theChecksum += theBytes[theIndex] ;
-  }
-  theData.pChecksum = theChecksum ;
-
-  // Prepare buffer aligned to flash page size
-  uint8_t theBuffer[FLASH_PAGE_SIZE] ;
-  memset(theBuffer, 0xFF, sizeof(theBuffer)) ;
-  memcpy(theBuffer, &theData, sizeof(DeviceSettings)) ;
+    return false ;
+  } // end if null
 
-  // Flush stdio before flash operations
-  stdio_flush() ;
+  uint8_t theValue[8] ;
+  uint8_t theLength = 0 ;
+  if (!Storage_ReadSetting(kSettingKeyCalibration, theValue, sizeof(theValue), &theLength) ||
+      theLength != sizeof(theValue))
+  {
+    return false ;
+  } // end if no calibration
 
-  // Disable interrupts during flash operations
-  uint32_t theInterrupts = save_and_disable_interrupts() ;
+  memcpy(outOffset, theValue, sizeof(*outOffset)) ;
+  memcpy(outScaleFactor, theValue + 4, sizeof(*outScaleFactor)) ;
 
-  // Erase the sector
-  flash_range_erase(kFlashSettingsOffset, FLASH_SECTOR_SIZE) ;
+  return true ;
+} // end Storage_LoadCalibration
 
-  // Program the data
-  flash_range_program(kFlashSettingsOffset, theBuffer, FLASH_PAGE_SIZE) ;
+//----------------------------------------------
+// Function: Storage_HasCalibration
+//----------------------------------------------
+bool Storage_HasCalibration(void)
+{
+  int32_t theOffset ;
+  float theScale ;
+  return Storage_LoadCalibration(&theOffset, &theScale) ;
+} // end Storage_HasCalibration
 
-  restore_interrupts(theInterrupts) ;
+//----------------------------------------------
+// Function: Storage_ClearCalibration
+//----------------------------------------------
+bool Storage_ClearCalibration(void)
+{
+  Storage_DeleteSetting(kSettingKeyCalibration) ;
 
-  return Storage_HasSettings() ;
-}
+  // Verify delete
+  return !Storage_HasCalibration() ;
+} // end Storage_ClearCalibration
 
 //----------------------------------------------
 // Function: Storage_SaveRocketId
@@ -231,19 +555,7 @@ bool Storage_SaveRocketId(uint8_t inRocketId)
 
   printf("Storage: Saving rocket ID %u...\n", inRocketId) ;
 
-  // Prepare settings data, preserving existing name if any
-  DeviceSettings theData ;
-  memset(&theData, 0, sizeof(theData)) ;
-  theData.pRocketId = inRocketId ;
-
-  // Load existing name if available
-  if (Storage_HasSettings())
-  {
-    strncpy(theData.pRocketName, kFlashSettingsPtr->pRocketName, kRocketNameMaxLen - 1) ;
-    theData.pRocketName[kRocketNameMaxLen - 1] = '\0' ;
-  }
-
-  if (Storage_SaveSettings(&theData))
+  if (Storage_WriteSetting(kSettingKeyRocketId, &inRocketId, 1))
   {
     printf("Storage: Rocket ID saved\n") ;
     return true ;
@@ -257,12 +569,15 @@ bool Storage_SaveRocketId(uint8_t inRocketId)
 //----------------------------------------------
 uint8_t Storage_LoadRocketId(void)
 {
-  if (!Storage_HasSettings())
+  uint8_t theRocketId = 0 ;
+
+  if (!Storage_ReadSetting(kSettingKeyRocketId, &theRocketId, 1, NULL) ||
+      theRocketId > 15)
   {
     return 0 ;  // Default to ID 0 if not set
   }
 
-  return kFlashSettingsPtr->pRocketId ;
+  return theRocketId ;
 } // end Storage_LoadRocketId
 
 //----------------------------------------------
@@ -270,25 +585,10 @@ uint8_t Storage_LoadRocketId(void)
 //----------------------------------------------
 bool Storage_HasSettings(void)
 {
-  // Check magic number
-  if (kFlashSettingsPtr->pMagic != kSettingsMagic)
-  {
-    return false ;
-  }
+  uint8_t theValue[kRocketNameMaxLen] ;
 
-  // Check version (accept current and previous versions)
-  if (kFlashSettingsPtr->pVersion != kSettingsVersion &&
-      kFlashSettingsPtr->pVersion != 1)
-  {
-    return false ;
-  }
-
-  // Verify checksum - note: checksum position depends on version
-  // For version 1, checksum was at a different offset
-  // For simplicity, just validate the magic and version
-  // The checksum calculation changed with the struct size
-
-  return true ;
+  return Storage_ReadSetting(kSettingKeyRocketId, theValue, sizeof(theValue), NULL) ||
+    Storage_ReadSetting(kSettingKeyRocketName, theValue, sizeof(theValue), NULL) ;
 } // end Storage_HasSettings
 
 //----------------------------------------------
@@ -304,21 +604,14 @@ bool Storage_SaveRocketName(const char * inName)
 
   printf("Storage: Saving rocket name '%s'...\n", inName) ;
 
-  // Prepare settings data, preserving existing rocket ID
-  DeviceSettings theData ;
-  memset(&theData, 0, sizeof(theData)) ;
-
-  // Load existing rocket ID if available
-  if (Storage_HasSettings())
+  // Stored without the terminator; empty name deletes the key
+  size_t theLength = strlen(inName) ;
+  if (theLength > kRocketNameMaxLen - 1)
   {
-    theData.pRocketId = kFlashSettingsPtr->pRocketId ;
+    theLength = kRocketNameMaxLen - 1 ;
   }
 
-  // Copy name with bounds checking
-  strncpy(theData.pRocketName, inName, kRocketNameMaxLen - 1) ;
-  theData.pRocketName[kRocketNameMaxLen - 1] = '\0' ;
-
-  if (Storage_SaveSettings(&theData))
+  if (Storage_WriteSetting(kSettingKeyRocketName, inName, (uint8_t)theLength))
   {
     printf("Storage: Rocket name saved\n") ;
     return true ;
@@ -340,20 +633,13 @@ bool Storage_LoadRocketName(char * outName)
   // Default to empty string
   outName[0] = '\0' ;
 
-  if (!Storage_HasSettings())
-  {
-    return false ;
-  }
-
-  // Version 1 didn't have name, return empty
-  if (kFlashSettingsPtr->pVersion < 2)
+  uint8_t theLength = 0 ;
+  if (!Storage_ReadSetting(kSettingKeyRocketName, outName, kRocketNameMaxLen - 1, &theLength))
   {
     return false ;
   }
 
-  // Copy name safely
-  strncpy(outName, kFlashSettingsPtr->pRocketName, kRocketNameMaxLen - 1) ;
-  outName[kRocketNameMaxLen - 1] = '\0' ;
+  outName[theLength] = '\0' ;
 
   return outName[0] != '\0' ;
 } // end Storage_LoadRocketName
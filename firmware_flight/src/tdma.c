@@ -0,0 +1,180 @@
+//----------------------------------------------
+// Module: tdma.c
+// Description: TDMA slot follower (gateway beacon
+//   and slot table)
+// Author: Mark Gavin
+// Created: 2026-02-12
+// Copyright: (c) 2025-2026 by Mark Gavin
+// License: Proprietary - All Rights Reserved
+//----------------------------------------------
+
+#include "tdma.h"
+#include "flight_control.h"
+
+#include <string.h>
+
+//----------------------------------------------
+// Internal: Read Little-Endian 16-bit
+//----------------------------------------------
+static uint16_t GetU16(const uint8_t * inData)
+{
+  return (uint16_t)(inData[0] | (inData[1] << 8)) ;
+}
+
+//----------------------------------------------
+// Internal: Contend In Superframe
+// Coin flip for the contention slot of the
+// superframe inAhead after the last beacon. The
+// draw is seeded from the beacon arrival time in
+// microseconds, so rockets waiting to join do not
+// pick the same superframes.
+//----------------------------------------------
+static bool ContendInSuperframe(const TdmaState * inState, uint32_t inAhead)
+{
+  uint32_t theHash = inState->pRandom ^ ((inState->pBeaconSeq + inAhead) * 0x9E3779B1u) ;
+  theHash ^= theHash >> 16 ;
+  theHash *= 0x85EBCA6Bu ;
+  theHash ^= theHash >> 13 ;
+  return (theHash & 1) != 0 ;
+}
+
+//----------------------------------------------
+// Function: Tdma_Init
+//----------------------------------------------
+void Tdma_Init(TdmaState * outState)
+{
+  memset(outState, 0, sizeof(TdmaState)) ;
+  memset(outState->pSlots, kTdmaSlotFree, sizeof(outState->pSlots)) ;
+}
+
+//----------------------------------------------
+// Function: Tdma_ProcessBeacon
+//----------------------------------------------
+bool Tdma_ProcessBeacon(
+  TdmaState * ioState,
+  const uint8_t * inPacket,
+  uint8_t inLen,
+  uint32_t inRxUs,
+  uint8_t inRocketId)
+{
+  if (inLen < kTdmaBeaconHeaderLen ||
+      inPacket[0] != kLoRaMagic || inPacket[1] != kLoRaPacketBeacon)
+  {
+    return false ;
+  }
+
+  uint8_t theSlotCount = inPacket[3] ;
+  uint16_t theSlotMs = GetU16(&inPacket[4]) ;
+  uint16_t theDownlinkMs = GetU16(&inPacket[6]) ;
+  uint16_t theSuperframeMs = GetU16(&inPacket[8]) ;
+
+  // The superframe must hold the downlink window,
+  // the data slots and the contention slot
+  if (theSlotCount == 0 || theSlotCount > kTdmaMaxSlots ||
+      inLen < kTdmaBeaconHeaderLen + theSlotCount ||
+      (uint32_t)theSlotMs * 1000 <= kTdmaGuardUs * 2 ||
+      theSuperframeMs < theDownlinkMs + (theSlotCount + 1) * theSlotMs)
+  {
+    return false ;
+  }
+
+  ioState->pSynced = true ;
+  ioState->pRocketId = inRocketId ;
+  ioState->pBeaconSeq = inPacket[2] ;
+  ioState->pAnchorUs = inRxUs ;
+  ioState->pSlotCount = theSlotCount ;
+  ioState->pSlotUs = (uint32_t)theSlotMs * 1000 ;
+  ioState->pDownlinkUs = (uint32_t)theDownlinkMs * 1000 ;
+  ioState->pSuperframeUs = (uint32_t)theSuperframeMs * 1000 ;
+  ioState->pHeard = inRocketId < 16 && (GetU16(&inPacket[10]) & (1u << inRocketId)) != 0 ;
+
+  ioState->pOwnSlots = 0 ;
+  for (uint8_t i = 0 ; i < theSlotCount ; i++)
+  {
+    ioState->pSlots[i] = inPacket[kTdmaBeaconHeaderLen + i] ;
+    if (ioState->pSlots[i] == inRocketId)
+    {
+      ioState->pOwnSlots++ ;
+    }
+  }
+
+  ioState->pRandom = (inRxUs * 2654435761u) ^ ((uint32_t)inRocketId << 24) ^ ioState->pRandom ;
+  ioState->pBeacons++ ;
+  return true ;
+}
+
+//----------------------------------------------
+// Function: Tdma_IsSynced
+//----------------------------------------------
+bool Tdma_IsSynced(TdmaState * ioState, uint32_t inNowUs)
+{
+  if (!ioState->pSynced)
+  {
+    return false ;
+  }
+
+  // Half a superframe of slack past the last
+  // bridged beacon absorbs a late one
+  uint32_t theLimitUs = ioState->pSuperframeUs * kTdmaMaxMissedBeacons + ioState->pSuperframeUs / 2 ;
+  if ((inNowUs - ioState->pAnchorUs) > theLimitUs)
+  {
+    ioState->pSynced = false ;
+    ioState->pSyncLosses++ ;
+    return false ;
+  }
+
+  return true ;
+}
+
+//----------------------------------------------
+// Function: Tdma_GetTxWindow
+//----------------------------------------------
+bool Tdma_GetTxWindow(
+  const TdmaState * inState,
+  uint32_t inNowUs,
+  uint32_t * outStartUs,
+  uint32_t * outEndUs)
+{
+  if (!inState->pSynced)
+  {
+    return false ;
+  }
+
+  uint32_t theElapsedUs = inNowUs - inState->pAnchorUs ;
+  uint32_t theFirst = theElapsedUs / inState->pSuperframeUs ;
+
+  for (uint32_t theAhead = theFirst ; theAhead <= kTdmaMaxMissedBeacons ; theAhead++)
+  {
+    uint32_t theBaseUs = inState->pAnchorUs + theAhead * inState->pSuperframeUs + inState->pDownlinkUs ;
+
+    // Data slots, then the contention slot at index N
+    for (uint8_t i = 0 ; i <= inState->pSlotCount ; i++)
+    {
+      bool theOwn ;
+      if (i < inState->pSlotCount)
+      {
+        theOwn = inState->pSlots[i] == inState->pRocketId ;
+      }
+      else
+      {
+        theOwn = inState->pOwnSlots == 0 && ContendInSuperframe(inState, theAhead) ;
+      }
+
+      if (!theOwn)
+      {
+        continue ;
+      }
+
+      uint32_t theStartUs = theBaseUs + i * inState->pSlotUs + kTdmaGuardUs ;
+      uint32_t theEndUs = theBaseUs + (i + 1) * inState->pSlotUs - kTdmaGuardUs ;
+      if ((int32_t)(theEndUs - inNowUs) > 0)
+      {
+        *outStartUs = theStartUs ;
+        *outEndUs = theEndUs ;
+        return true ;
+      }
+    }
+  }
+
+  return false ;
+}
@@ -0,0 +1,139 @@
+//----------------------------------------------
+// Module: telemetry_fec.c
+// Description: Packet-level forward error
+//   correction for telemetry (XOR parity frame
+//   every K frames)
+// Author: Mark Gavin
+// Created: 2026-02-14
+// Copyright: (c) 2025-2026 by Mark Gavin
+// License: Proprietary - All Rights Reserved
+//----------------------------------------------
+
+#include "telemetry_fec.h"
+#include "flight_control.h"
+
+#include <string.h>
+
+//----------------------------------------------
+// Internal: Close the open group into a parity
+//   frame waiting to go out
+//----------------------------------------------
+static void CloseGroup(TelemetryFec * ioFec, uint8_t inRocketId)
+{
+  if (ioFec->pParityLen != 0)
+  {
+    ioFec->pParityDropped++ ;
+  }
+
+  uint8_t * theParity = ioFec->pParity ;
+  theParity[0] = kLoRaMagic ;
+  theParity[1] = kLoRaPacketParity ;
+  theParity[2] = inRocketId ;
+  theParity[3] = ioFec->pBase ;
+  theParity[4] = ioFec->pGroup ;
+  theParity[5] = ioFec->pMask ;
+  theParity[6] = ioFec->pLenXor ;
+  memcpy(&theParity[kFecHeaderLen], ioFec->pXor, ioFec->pMaxLen) ;
+  ioFec->pParityLen = (uint8_t)(kFecHeaderLen + ioFec->pMaxLen) ;
+  ioFec->pOpen = false ;
+}
+
+//----------------------------------------------
+// Function: TelemetryFec_Init
+//----------------------------------------------
+void TelemetryFec_Init(TelemetryFec * outFec, uint8_t inGroup)
+{
+  memset(outFec, 0, sizeof(TelemetryFec)) ;
+  TelemetryFec_SetGroup(outFec, inGroup) ;
+}
+
+//----------------------------------------------
+// Function: TelemetryFec_SetGroup
+//----------------------------------------------
+bool TelemetryFec_SetGroup(TelemetryFec * ioFec, uint8_t inGroup)
+{
+  if (inGroup != 0 && inGroup != 2 && inGroup != 4 && inGroup != kFecMaxGroup)
+  {
+    return false ;
+  }
+
+  ioFec->pGroup = inGroup ;
+  ioFec->pOpen = false ;
+  ioFec->pParityLen = 0 ;
+  return true ;
+}
+
+//----------------------------------------------
+// Function: TelemetryFec_AddFrame
+//----------------------------------------------
+bool TelemetryFec_AddFrame(
+  TelemetryFec * ioFec,
+  const uint8_t * inFrame,
+  uint8_t inLen,
+  uint8_t inSequence,
+  uint8_t inRocketId)
+{
+  if (ioFec->pGroup == 0 || inLen == 0 || inLen > kFecMaxFrameLen)
+  {
+    return false ;
+  }
+
+  // A frame from a later group closes the open one
+  uint8_t theBase = (uint8_t)(inSequence & ~(ioFec->pGroup - 1)) ;
+  if (ioFec->pOpen && theBase != ioFec->pBase)
+  {
+    CloseGroup(ioFec, inRocketId) ;
+  }
+
+  if (!ioFec->pOpen)
+  {
+    ioFec->pOpen = true ;
+    ioFec->pBase = theBase ;
+    ioFec->pMask = 0 ;
+    ioFec->pLenXor = 0 ;
+    ioFec->pMaxLen = 0 ;
+    memset(ioFec->pXor, 0, sizeof(ioFec->pXor)) ;
+  }
+
+  for (uint8_t i = 0 ; i < inLen ; i++)
+  {
+    ioFec->pXor[i] ^= inFrame[i] ;
+  }
+  ioFec->pLenXor ^= inLen ;
+  if (inLen > ioFec->pMaxLen)
+  {
+    ioFec->pMaxLen = inLen ;
+  }
+  uint8_t theOffset = (uint8_t)(inSequence - theBase) ;
+  ioFec->pMask |= (uint8_t)(1u << theOffset) ;
+
+  if (theOffset == ioFec->pGroup - 1)
+  {
+    CloseGroup(ioFec, inRocketId) ;
+  }
+
+  return ioFec->pParityLen != 0 ;
+}
+
+//----------------------------------------------
+// Function: TelemetryFec_TakeParity
+//----------------------------------------------
+uint8_t TelemetryFec_TakeParity(TelemetryFec * ioFec, uint8_t * outPacket, uint8_t inMaxLen)
+{
+  uint8_t theLen = ioFec->pParityLen ;
+  if (theLen == 0)
+  {
+    return 0 ;
+  }
+
+  ioFec->pParityLen = 0 ;
+  if (theLen > inMaxLen)
+  {
+    ioFec->pParityDropped++ ;
+    return 0 ;
+  }
+
+  memcpy(outPacket, ioFec->pParity, theLen) ;
+  ioFec->pParitySent++ ;
+  return theLen ;
+}
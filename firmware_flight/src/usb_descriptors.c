@@ -0,0 +1,312 @@
+//----------------------------------------------
+// Module: usb_descriptors.c
+// Description: USB descriptors for the CDC (stdio)
+//   + MSC (flight drive) composite device, and its
+//   picotool reset interface
+// Author: Mark Gavin
+// Created: 2026-02-03
+// Copyright: (c) 2025-2026 by Mark Gavin
+// License: Proprietary - All Rights Reserved
+// Modified: 2026-02-16 (own PID, reset interface and 1200 baud reset)
+//
+// Linking tinyusb_device directly turns off the
+// Pico SDK's own descriptors and with them its
+// reset interface and 1200 baud BOOTSEL reset, so
+// both are provided here: `picotool reboot` and
+// IDE uploads keep working.
+//----------------------------------------------
+
+#include "tusb.h"
+#include "device/usbd_pvt.h"
+#include "pico/unique_id.h"
+#include "pico/bootrom.h"
+#include "pico/usb_reset_interface.h"
+#include "hardware/watchdog.h"
+
+#include <string.h>
+
+//----------------------------------------------
+// Module Constants
+//----------------------------------------------
+#define kUsbVid                 0x2E8A  // Raspberry Pi
+
+// Not 0x000A (Pico SDK CDC stdio): hosts cache the
+// interface layout per VID/PID. Set from CMake
+// (USB_MSC_PID).
+#ifndef kUsbPid
+#define kUsbPid                 0x10F1  // CDC + MSC + reset layout
+#endif
+#define kUsbBcdDevice           0x0100
+
+#define kUsbResetBaudRate       1200    // Host opens the port at this rate: reboot to BOOTSEL
+#define kUsbResetFlashDelayMs   100
+
+#define kUsbMaxPowerMa          250
+
+// Interface numbers
+enum
+{
+  kItfNumCdc = 0,
+  kItfNumCdcData,
+  kItfNumMsc,
+  kItfNumReset,
+  kItfNumTotal
+} ;
+
+// Endpoint numbers
+#define kEpCdcNotify            0x81
+#define kEpCdcOut               0x02
+#define kEpCdcIn                0x82
+#define kEpMscOut               0x03
+#define kEpMscIn                0x83
+
+// Reset interface: vendor class, no endpoints
+// (same as the Pico SDK's stdio_usb descriptors)
+#define kResetDescLen           9
+#define kConfigTotalLen         (TUD_CONFIG_DESC_LEN + TUD_CDC_DESC_LEN + TUD_MSC_DESC_LEN + kResetDescLen)
+
+// String indices
+enum
+{
+  kStrLanguage = 0,
+  kStrManufacturer,
+  kStrProduct,
+  kStrSerial,
+  kStrCdc,
+  kStrMsc,
+  kStrReset,
+  kStrCount
+} ;
+
+//----------------------------------------------
+// Device Descriptor
+//----------------------------------------------
+static const tusb_desc_device_t kDeviceDescriptor =
+{
+  .bLength = sizeof(tusb_desc_device_t),
+  .bDescriptorType = TUSB_DESC_DEVICE,
+  .bcdUSB = 0x0200,
+
+  // IAD required for CDC in a composite device
+  .bDeviceClass = TUSB_CLASS_MISC,
+  .bDeviceSubClass = MISC_SUBCLASS_COMMON,
+  .bDeviceProtocol = MISC_PROTOCOL_IAD,
+  .bMaxPacketSize0 = CFG_TUD_ENDPOINT0_SIZE,
+
+  .idVendor = kUsbVid,
+  .idProduct = kUsbPid,
+  .bcdDevice = kUsbBcdDevice,
+
+  .iManufacturer = kStrManufacturer,
+  .iProduct = kStrProduct,
+  .iSerialNumber = kStrSerial,
+
+  .bNumConfigurations = 1
+} ;
+
+//----------------------------------------------
+// Configuration Descriptor
+//----------------------------------------------
+static const uint8_t kConfigDescriptor[] =
+{
+  TUD_CONFIG_DESCRIPTOR(1, kItfNumTotal, 0, kConfigTotalLen, 0x00, kUsbMaxPowerMa),
+  TUD_CDC_DESCRIPTOR(kItfNumCdc, kStrCdc, kEpCdcNotify, 8, kEpCdcOut, kEpCdcIn, 64),
+  TUD_MSC_DESCRIPTOR(kItfNumMsc, kStrMsc, kEpMscOut, kEpMscIn, 64),
+  kResetDescLen, TUSB_DESC_INTERFACE, kItfNumReset, 0, 0,
+    TUSB_CLASS_VENDOR_SPECIFIC, RESET_INTERFACE_SUBCLASS, RESET_INTERFACE_PROTOCOL, kStrReset,
+} ;
+
+//----------------------------------------------
+// String Descriptors
+//----------------------------------------------
+static const char * kStringTable[kStrCount] =
+{
+  NULL,                       // Language (handled below)
+  "Rocket Avionics",          // Manufacturer
+  "Flight Computer",          // Product
+  NULL,                       // Serial (unique board ID)
+  "Flight Computer Serial",   // CDC interface
+  "Flight Computer Drive",    // MSC interface
+  "Reset",                    // Reset interface
+} ;
+
+static uint8_t sResetItfNum = 0 ;
+
+static uint16_t sStringBuffer[32] ;
+
+//----------------------------------------------
+// Function: tud_descriptor_device_cb
+//----------------------------------------------
+const uint8_t * tud_descriptor_device_cb(void)
+{
+  return (const uint8_t *)&kDeviceDescriptor ;
+}
+
+//----------------------------------------------
+// Function: tud_descriptor_configuration_cb
+//----------------------------------------------
+const uint8_t * tud_descriptor_configuration_cb(uint8_t inIndex)
+{
+  (void)inIndex ;
+  return kConfigDescriptor ;
+}
+
+//----------------------------------------------
+// Function: tud_descriptor_string_cb
+//----------------------------------------------
+const uint16_t * tud_descriptor_string_cb(uint8_t inIndex, uint16_t inLangId)
+{
+  (void)inLangId ;
+  uint8_t theCount = 0 ;
+
+  if (inIndex == kStrLanguage)
+  {
+    sStringBuffer[1] = 0x0409 ;  // English (US)
+    theCount = 1 ;
+  }
+  else
+  {
+    if (inIndex >= kStrCount)
+    {
+      return NULL ;
+    }
+
+    char theSerial[2 * PICO_UNIQUE_BOARD_ID_SIZE_BYTES + 1] ;
+    const char * theString = kStringTable[inIndex] ;
+    if (inIndex == kStrSerial)
+    {
+      pico_get_unique_board_id_string(theSerial, sizeof(theSerial)) ;
+      theString = theSerial ;
+    }
+
+    theCount = (uint8_t)strlen(theString) ;
+    if (theCount > 31)
+    {
+      theCount = 31 ;
+    }
+
+    // Convert ASCII to UTF-16
+    for (uint8_t i = 0 ; i < theCount ; i++)
+    {
+      sStringBuffer[1 + i] = (uint8_t)theString[i] ;
+    }
+  }
+
+  // First word: length (bytes) and descriptor type
+  sStringBuffer[0] = (uint16_t)((TUSB_DESC_STRING << 8) | (2 * theCount + 2)) ;
+
+  return sStringBuffer ;
+}
+
+//----------------------------------------------
+// Internal: ResetInit
+//----------------------------------------------
+static void ResetInit(void)
+{
+}
+
+//----------------------------------------------
+// Internal: ResetReset (bus reset)
+//----------------------------------------------
+static void ResetReset(uint8_t inRhport)
+{
+  (void)inRhport ;
+  sResetItfNum = 0 ;
+}
+
+//----------------------------------------------
+// Internal: ResetOpen
+// Claims the reset interface when TinyUSB parses
+// the configuration
+//----------------------------------------------
+static uint16_t ResetOpen(uint8_t inRhport, const tusb_desc_interface_t * inItf, uint16_t inMaxLen)
+{
+  (void)inRhport ;
+  if (inItf->bInterfaceClass != TUSB_CLASS_VENDOR_SPECIFIC ||
+      inItf->bInterfaceSubClass != RESET_INTERFACE_SUBCLASS ||
+      inItf->bInterfaceProtocol != RESET_INTERFACE_PROTOCOL ||
+      inMaxLen < sizeof(tusb_desc_interface_t))
+  {
+    return 0 ;
+  }
+  sResetItfNum = inItf->bInterfaceNumber ;
+  return sizeof(tusb_desc_interface_t) ;
+}
+
+//----------------------------------------------
+// Internal: ResetControl
+// picotool's requests: to BOOTSEL, or restart
+//----------------------------------------------
+static bool ResetControl(uint8_t inRhport, uint8_t inStage, const tusb_control_request_t * inRequest)
+{
+  (void)inRhport ;
+  if (inStage != CONTROL_STAGE_SETUP)
+  {
+    return true ;
+  }
+  if (inRequest->wIndex != sResetItfNum)
+  {
+    return false ;
+  }
+
+  if (inRequest->bRequest == RESET_REQUEST_BOOTSEL)
+  {
+    // Low bits of wValue: interfaces to disable
+    reset_usb_boot(0, inRequest->wValue & 0x7F) ;
+  }
+  else if (inRequest->bRequest == RESET_REQUEST_FLASH)
+  {
+    watchdog_reboot(0, 0, kUsbResetFlashDelayMs) ;
+    return true ;
+  }
+  return false ;
+}
+
+//----------------------------------------------
+// Internal: ResetXfer
+//----------------------------------------------
+static bool ResetXfer(uint8_t inRhport, uint8_t inEp, xfer_result_t inResult, uint32_t inBytes)
+{
+  (void)inRhport ;
+  (void)inEp ;
+  (void)inResult ;
+  (void)inBytes ;
+  return true ;
+}
+
+static const usbd_class_driver_t kResetDriver =
+{
+#if CFG_TUSB_DEBUG >= 2
+  .name = "RESET",
+#endif
+  .init = ResetInit,
+  .reset = ResetReset,
+  .open = ResetOpen,
+  .control_xfer_cb = ResetControl,
+  .xfer_cb = ResetXfer,
+  .sof = NULL
+} ;
+
+//----------------------------------------------
+// Function: usbd_app_driver_get_cb
+// Adds the reset interface driver to TinyUSB's
+//----------------------------------------------
+const usbd_class_driver_t * usbd_app_driver_get_cb(uint8_t * outCount)
+{
+  *outCount = 1 ;
+  return &kResetDriver ;
+}
+
+//----------------------------------------------
+// Function: tud_cdc_line_coding_cb
+// Opening the port at 1200 baud reboots to BOOTSEL
+// (Arduino-style upload)
+//----------------------------------------------
+void tud_cdc_line_coding_cb(uint8_t inItf, const cdc_line_coding_t * inCoding)
+{
+  (void)inItf ;
+  if (inCoding->bit_rate == kUsbResetBaudRate)
+  {
+    reset_usb_boot(0, 0) ;
+  }
+}
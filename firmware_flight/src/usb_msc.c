@@ -0,0 +1,731 @@
+//----------------------------------------------
+// Module: usb_msc.c
+// Description: USB mass-storage view of stored
+//   flights (read-only virtual FAT12 volume)
+// Author: Mark Gavin
+// Created: 2026-02-03
+// Copyright: (c) 2025-2026 by Mark Gavin
+// License: Proprietary - All Rights Reserved
+//
+// Volume layout (512-byte sectors, 4KB clusters):
+//   Sector 0       Boot sector / BPB
+//   Sectors 1-12   Two copies of the FAT (6 each)
+//   Sectors 13-16  Root directory (64 entries)
+//   Sector 17+     Data clusters
+// Each flight slot owns a fixed run of clusters
+// for its BIN file and another for its CSV file,
+// so the FAT and directory are computed from the
+// flight headers rather than stored anywhere.
+//----------------------------------------------
+
+#include "usb_msc.h"
+#include "flight_storage.h"
+
+#include "tusb.h"
+#include "pico/stdlib.h"
+#include "hardware/sync.h"
+
+#include <stdio.h>
+#include <string.h>
+
+//----------------------------------------------
+// Module Constants
+//----------------------------------------------
+#define kSectorsPerCluster      8
+#define kClusterSize            (kMscSectorSize * kSectorsPerCluster)
+#define kReservedSectors        1
+#define kFatCount               2
+#define kSectorsPerFat          6
+#define kRootDirEntries         64
+#define kDirEntrySize           32
+#define kRootDirSectors         ((kRootDirEntries * kDirEntrySize) / kMscSectorSize)
+#define kFatStartSector         kReservedSectors
+#define kRootDirStartSector     (kFatStartSector + (kFatCount * kSectorsPerFat))
+#define kDataStartSector        (kRootDirStartSector + kRootDirSectors)
+#define kClusterCount           ((kMscSectorCount - kDataStartSector) / kSectorsPerCluster)
+
+#define kFatEndOfChain          0xFFF
+#define kFatMediaDescriptor     0xF8
+
+// Fixed file date 2026-01-01 (flights carry no wall-clock time)
+#define kFatFileDate            (((2026 - 1980) << 9) | (1 << 5) | 1)
+
+#define kDirAttrReadOnly        0x01
+#define kDirAttrVolumeLabel     0x08
+
+// Cluster regions: BIN files first, then CSV files
+#define kBinClusters            (kFlightSlotSize / kClusterSize)
+#define kMaxCsvRows             ((kFlightSlotSize - FLASH_PAGE_SIZE) / sizeof(FlightSample))
+#define kCsvHeaderLen           (sizeof(kCsvHeader) - 1)
+#define kCsvClusters            ((kCsvHeaderLen + (kMaxCsvRows * kMscCsvRowLen) + kClusterSize - 1) / kClusterSize)
+#define kBinRegionClusters      (kMaxStoredFlights * kBinClusters)
+#define kCsvRegionClusters      (kMaxStoredFlights * kCsvClusters)
+
+#define kRefreshIntervalMs      250
+
+static const char kCsvHeader[] =
+  "time_ms,alt_cm,vel_cmps,pressure_pa,temp_c10,lat_udeg,lon_udeg,"
+  "gps_speed_cmps,heading_deg10,sats,accel_x_mg,accel_y_mg,accel_z_mg,"
+  "gyro_x_dps10,gyro_y_dps10,gyro_z_dps10,mag_x_mgauss,mag_y_mgauss,"
+  "mag_z_mgauss,state\r\n" ;
+
+// Field widths fit the full range of each type, so every row is
+// exactly kMscCsvRowLen characters
+static const char kCsvRowFormat[] =
+  "%10lu,%11ld,%6d,%10lu,%6d,%11ld,%11ld,%6d,%5u,%3u,"
+  "%6d,%6d,%6d,%6d,%6d,%6d,%6d,%6d,%6d,%3u\r\n" ;
+
+_Static_assert(kClusterCount < 4085, "Volume must stay FAT12") ;
+_Static_assert((kClusterCount + 2) * 3 / 2 <= kSectorsPerFat * kMscSectorSize,
+  "FAT too small for cluster count") ;
+_Static_assert(kBinRegionClusters + kCsvRegionClusters <= kClusterCount,
+  "Flight files do not fit the volume") ;
+
+//----------------------------------------------
+// Types
+//----------------------------------------------
+typedef struct
+{
+  bool pUsed ;
+  uint32_t pFlightId ;
+  uint32_t pSampleCount ;
+  uint32_t pBinSize ;
+  uint32_t pCsvSize ;
+} MscFlightFile ;
+
+typedef struct __attribute__((packed))
+{
+  char pName[11] ;                // 8.3 name, space padded
+  uint8_t pAttributes ;
+  uint8_t pReserved ;
+  uint8_t pCreateTimeTenths ;
+  uint16_t pCreateTime ;
+  uint16_t pCreateDate ;
+  uint16_t pAccessDate ;
+  uint16_t pClusterHigh ;
+  uint16_t pWriteTime ;
+  uint16_t pWriteDate ;
+  uint16_t pClusterLow ;
+  uint32_t pFileSize ;
+} FatDirEntry ;                   // 32 bytes
+
+//----------------------------------------------
+// Module State
+//----------------------------------------------
+static MscFlightFile sFiles[kMaxStoredFlights] ;
+static volatile bool sAvailable = false ;
+static volatile bool sMediaChanged = false ;
+static uint32_t sLastRefreshMs = 0 ;
+
+// Scratch sector for partial reads (kept off the IRQ stack)
+static uint8_t sScratchSector[kMscSectorSize] ;
+
+//----------------------------------------------
+// Internal: Put 16/32-bit little-endian values
+//----------------------------------------------
+static void PutLe16(uint8_t * outBytes, uint16_t inValue)
+{
+  outBytes[0] = (uint8_t)(inValue & 0xFF) ;
+  outBytes[1] = (uint8_t)(inValue >> 8) ;
+}
+
+static void PutLe32(uint8_t * outBytes, uint32_t inValue)
+{
+  PutLe16(outBytes, (uint16_t)(inValue & 0xFFFF)) ;
+  PutLe16(outBytes + 2, (uint16_t)(inValue >> 16)) ;
+}
+
+//----------------------------------------------
+// Internal: First cluster of a flight file
+//----------------------------------------------
+static uint32_t BinFirstCluster(uint8_t inSlot)
+{
+  return 2 + (inSlot * kBinClusters) ;
+}
+
+static uint32_t CsvFirstCluster(uint8_t inSlot)
+{
+  return 2 + kBinRegionClusters + (inSlot * kCsvClusters) ;
+}
+
+//----------------------------------------------
+// Internal: Locate a cluster in the file regions
+// Returns: true if the cluster belongs to a slot
+//----------------------------------------------
+static bool LocateCluster(
+  uint32_t inCluster,
+  uint8_t * outSlot,
+  bool * outIsCsv,
+  uint32_t * outClusterInFile)
+{
+  if (inCluster < 2)
+  {
+    return false ;
+  }
+
+  uint32_t theIndex = inCluster - 2 ;
+
+  if (theIndex < kBinRegionClusters)
+  {
+    *outSlot = (uint8_t)(theIndex / kBinClusters) ;
+    *outIsCsv = false ;
+    *outClusterInFile = theIndex % kBinClusters ;
+    return true ;
+  }
+
+  theIndex -= kBinRegionClusters ;
+  if (theIndex < kCsvRegionClusters)
+  {
+    *outSlot = (uint8_t)(theIndex / kCsvClusters) ;
+    *outIsCsv = true ;
+    *outClusterInFile = theIndex % kCsvClusters ;
+    return true ;
+  }
+
+  return false ;
+}
+
+//----------------------------------------------
+// Internal: FAT12 entry for a cluster
+//----------------------------------------------
+static uint16_t FatEntry(uint32_t inCluster)
+{
+  if (inCluster == 0)
+  {
+    return 0xF00 | kFatMediaDescriptor ;
+  }
+  if (inCluster == 1)
+  {
+    return kFatEndOfChain ;
+  }
+
+  uint8_t theSlot ;
+  bool theIsCsv ;
+  uint32_t theClusterInFile ;
+  if (!LocateCluster(inCluster, &theSlot, &theIsCsv, &theClusterInFile) ||
+      !sFiles[theSlot].pUsed)
+  {
+    return 0 ;  // Free
+  }
+
+  uint32_t theFileSize = theIsCsv ? sFiles[theSlot].pCsvSize : sFiles[theSlot].pBinSize ;
+  uint32_t theClustersUsed = (theFileSize + kClusterSize - 1) / kClusterSize ;
+
+  if (theClusterInFile >= theClustersUsed)
+  {
+    return 0 ;
+  }
+
+  return (theClusterInFile == theClustersUsed - 1) ?
+    kFatEndOfChain : (uint16_t)(inCluster + 1) ;
+}
+
+//----------------------------------------------
+// Internal: Render boot sector
+//----------------------------------------------
+static void RenderBootSector(uint8_t * outSector)
+{
+  memset(outSector, 0, kMscSectorSize) ;
+
+  outSector[0] = 0xEB ;                               // Jump
+  outSector[1] = 0x3C ;
+  outSector[2] = 0x90 ;
+  memcpy(outSector + 3, "MSWIN4.1", 8) ;              // OEM name
+  PutLe16(outSector + 11, kMscSectorSize) ;           // Bytes per sector
+  outSector[13] = kSectorsPerCluster ;
+  PutLe16(outSector + 14, kReservedSectors) ;
+  outSector[16] = kFatCount ;
+  PutLe16(outSector + 17, kRootDirEntries) ;
+  PutLe16(outSector + 19, kMscSectorCount) ;          // Total sectors (16-bit)
+  outSector[21] = kFatMediaDescriptor ;
+  PutLe16(outSector + 22, kSectorsPerFat) ;
+  PutLe16(outSector + 24, 1) ;                        // Sectors per track
+  PutLe16(outSector + 26, 1) ;                        // Heads
+  outSector[36] = 0x80 ;                              // Drive number
+  outSector[38] = 0x29 ;                              // Extended boot signature
+  PutLe32(outSector + 39, 0x52414654) ;               // Volume ID
+  memcpy(outSector + 43, "ROCKET FC  ", 11) ;         // Volume label
+  memcpy(outSector + 54, "FAT12   ", 8) ;             // File system type
+  outSector[510] = 0x55 ;
+  outSector[511] = 0xAA ;
+}
+
+//----------------------------------------------
+// Internal: Render one FAT sector
+//----------------------------------------------
+static void RenderFatSector(uint32_t inFatSector, uint8_t * outSector)
+{
+  uint32_t theFirstByte = inFatSector * kMscSectorSize ;
+
+  for (uint32_t i = 0 ; i < kMscSectorSize ; i++)
+  {
+    // Two 12-bit entries pack into three bytes
+    uint32_t theByte = theFirstByte + i ;
+    uint32_t thePair = theByte / 3 ;
+    uint16_t theEven = FatEntry(thePair * 2) ;
+    uint16_t theOdd = FatEntry((thePair * 2) + 1) ;
+
+    switch (theByte % 3)
+    {
+      case 0:
+        outSector[i] = (uint8_t)(theEven & 0xFF) ;
+        break ;
+      case 1:
+        outSector[i] = (uint8_t)((theEven >> 8) | ((theOdd & 0x0F) << 4)) ;
+        break ;
+      default:
+        outSector[i] = (uint8_t)(theOdd >> 4) ;
+        break ;
+    }
+  }
+}
+
+//----------------------------------------------
+// Internal: Fill a directory entry
+//----------------------------------------------
+static void FillDirEntry(
+  FatDirEntry * outEntry,
+  const char * inName,
+  uint8_t inAttributes,
+  uint32_t inFirstCluster,
+  uint32_t inFileSize)
+{
+  memset(outEntry, 0, sizeof(FatDirEntry)) ;
+  memcpy(outEntry->pName, inName, sizeof(outEntry->pName)) ;
+  outEntry->pAttributes = inAttributes ;
+  outEntry->pCreateDate = kFatFileDate ;
+  outEntry->pAccessDate = kFatFileDate ;
+  outEntry->pWriteDate = kFatFileDate ;
+  outEntry->pClusterLow = (uint16_t)inFirstCluster ;
+  outEntry->pFileSize = inFileSize ;
+}
+
+//----------------------------------------------
+// Internal: Build a root directory entry
+// Entry 0 is the volume label, then a BIN and a
+// CSV entry for each stored flight.
+// Returns: false past the last entry
+//----------------------------------------------
+static bool BuildDirEntry(uint32_t inIndex, FatDirEntry * outEntry)
+{
+  if (inIndex == 0)
+  {
+    FillDirEntry(outEntry, "ROCKET FC  ", kDirAttrVolumeLabel, 0, 0) ;
+    return true ;
+  }
+
+  uint32_t theIndex = 1 ;
+  for (uint8_t theSlot = 0 ; theSlot < kMaxStoredFlights ; theSlot++)
+  {
+    if (!sFiles[theSlot].pUsed)
+    {
+      continue ;
+    }
+
+    if (inIndex == theIndex || inIndex == theIndex + 1)
+    {
+      bool theIsCsv = (inIndex == theIndex + 1) ;
+      char theName[16] ;
+      snprintf(theName, sizeof(theName), "FLT%05lu%s",
+        (unsigned long)(sFiles[theSlot].pFlightId % 100000),
+        theIsCsv ? "CSV" : "BIN") ;
+
+      if (theIsCsv)
+      {
+        FillDirEntry(outEntry, theName, kDirAttrReadOnly,
+          CsvFirstCluster(theSlot), sFiles[theSlot].pCsvSize) ;
+      }
+      else
+      {
+        FillDirEntry(outEntry, theName, kDirAttrReadOnly,
+          BinFirstCluster(theSlot), sFiles[theSlot].pBinSize) ;
+      }
+      return true ;
+    }
+
+    theIndex += 2 ;
+  }
+
+  return false ;
+}
+
+//----------------------------------------------
+// Internal: Render one root directory sector
+//----------------------------------------------
+static void RenderRootDirSector(uint32_t inDirSector, uint8_t * outSector)
+{
+  memset(outSector, 0, kMscSectorSize) ;
+
+  uint32_t theEntriesPerSector = kMscSectorSize / kDirEntrySize ;
+  uint32_t theFirst = inDirSector * theEntriesPerSector ;
+
+  for (uint32_t i = 0 ; i < theEntriesPerSector ; i++)
+  {
+    FatDirEntry theEntry ;
+    if (!BuildDirEntry(theFirst + i, &theEntry))
+    {
+      break ;
+    }
+    memcpy(outSector + (i * kDirEntrySize), &theEntry, kDirEntrySize) ;
+  }
+}
+
+//----------------------------------------------
+// Internal: Render BIN file bytes (raw slot)
+//----------------------------------------------
+static void RenderBin(
+  uint8_t inSlot,
+  uint32_t inOffset,
+  uint8_t * outBuffer,
+  uint32_t inLength)
+{
+  uint32_t theFileSize = sFiles[inSlot].pBinSize ;
+  uint32_t theCount = 0 ;
+
+  if (inOffset < theFileSize)
+  {
+    theCount = theFileSize - inOffset ;
+    if (theCount > inLength)
+    {
+      theCount = inLength ;
+    }
+
+    // Straight from memory-mapped flash
+    const uint8_t * theSlotPtr = (const uint8_t *)(XIP_BASE + kFlightSlotsOffset +
+      (inSlot * kFlightSlotSize)) ;
+    memcpy(outBuffer, theSlotPtr + inOffset, theCount) ;
+  }
+
+  memset(outBuffer + theCount, 0, inLength - theCount) ;
+}
+
+//----------------------------------------------
+// Internal: Format one CSV row
+//----------------------------------------------
+static void FormatCsvRow(uint8_t inSlot, uint32_t inRow, char * outRow)
+{
+  FlightSample theSample ;
+  if (!FlightStorage_GetSample(inSlot, inRow, &theSample))
+  {
+    memset(&theSample, 0, sizeof(theSample)) ;
+  }
+
+  snprintf(outRow, kMscCsvRowLen + 1, kCsvRowFormat,
+    (unsigned long)theSample.pTimeMs,
+    (long)theSample.pAltitudeCm,
+    (int)theSample.pVelocityCmps,
+    (unsigned long)theSample.pPressurePa,
+    (int)theSample.pTemperatureC10,
+    (long)theSample.pGpsLatitude,
+    (long)theSample.pGpsLongitude,
+    (int)theSample.pGpsSpeedCmps,
+    (unsigned)theSample.pGpsHeadingDeg10,
+    (unsigned)theSample.pGpsSatellites,
+    (int)theSample.pAccelX, (int)theSample.pAccelY, (int)theSample.pAccelZ,
+    (int)theSample.pGyroX, (int)theSample.pGyroY, (int)theSample.pGyroZ,
+    (int)theSample.pMagX, (int)theSample.pMagY, (int)theSample.pMagZ,
+    (unsigned)theSample.pState) ;
+}
+
+//----------------------------------------------
+// Internal: Render CSV file bytes
+//----------------------------------------------
+static void RenderCsv(
+  uint8_t inSlot,
+  uint32_t inOffset,
+  uint8_t * outBuffer,
+  uint32_t inLength)
+{
+  uint32_t theFileSize = sFiles[inSlot].pCsvSize ;
+  char theRow[kMscCsvRowLen + 1] ;
+
+  while (inLength > 0)
+  {
+    if (inOffset >= theFileSize)
+    {
+      memset(outBuffer, 0, inLength) ;
+      return ;
+    }
+
+    const char * theSource ;
+    uint32_t theAvailable ;
+
+    if (inOffset < kCsvHeaderLen)
+    {
+      theSource = kCsvHeader + inOffset ;
+      theAvailable = kCsvHeaderLen - inOffset ;
+    }
+    else
+    {
+      // Fixed row length maps the offset to a sample
+      uint32_t theRowOffset = inOffset - kCsvHeaderLen ;
+      uint32_t theInRow = theRowOffset % kMscCsvRowLen ;
+      FormatCsvRow(inSlot, theRowOffset / kMscCsvRowLen, theRow) ;
+      theSource = theRow + theInRow ;
+      theAvailable = kMscCsvRowLen - theInRow ;
+    }
+
+    uint32_t theCount = theAvailable ;
+    if (theCount > inLength)
+    {
+      theCount = inLength ;
+    }
+    if (theCount > theFileSize - inOffset)
+    {
+      theCount = theFileSize - inOffset ;
+    }
+
+    memcpy(outBuffer, theSource, theCount) ;
+    outBuffer += theCount ;
+    inOffset += theCount ;
+    inLength -= theCount ;
+  }
+}
+
+//----------------------------------------------
+// Internal: Render any sector of the volume
+//----------------------------------------------
+static void RenderSector(uint32_t inLba, uint8_t * outSector)
+{
+  if (inLba < kFatStartSector)
+  {
+    RenderBootSector(outSector) ;
+  }
+  else if (inLba < kRootDirStartSector)
+  {
+    // Both FAT copies are identical
+    RenderFatSector((inLba - kFatStartSector) % kSectorsPerFat, outSector) ;
+  }
+  else if (inLba < kDataStartSector)
+  {
+    RenderRootDirSector(inLba - kRootDirStartSector, outSector) ;
+  }
+  else
+  {
+    uint32_t theDataSector = inLba - kDataStartSector ;
+    uint32_t theCluster = 2 + (theDataSector / kSectorsPerCluster) ;
+    uint8_t theSlot ;
+    bool theIsCsv ;
+    uint32_t theClusterInFile ;
+
+    if (!LocateCluster(theCluster, &theSlot, &theIsCsv, &theClusterInFile) ||
+        !sFiles[theSlot].pUsed)
+    {
+      memset(outSector, 0, kMscSectorSize) ;
+      return ;
+    }
+
+    uint32_t theFileOffset = (theClusterInFile * kClusterSize) +
+      ((theDataSector % kSectorsPerCluster) * kMscSectorSize) ;
+
+    if (theIsCsv)
+    {
+      RenderCsv(theSlot, theFileOffset, outSector, kMscSectorSize) ;
+    }
+    else
+    {
+      RenderBin(theSlot, theFileOffset, outSector, kMscSectorSize) ;
+    }
+  }
+}
+
+//----------------------------------------------
+// Function: UsbMsc_Init
+//----------------------------------------------
+bool UsbMsc_Init(void)
+{
+  memset(sFiles, 0, sizeof(sFiles)) ;
+  return tusb_init() ;
+}
+
+//----------------------------------------------
+// Function: UsbMsc_Update
+//----------------------------------------------
+void UsbMsc_Update(bool inAvailable)
+{
+  uint32_t theCurrentMs = to_ms_since_boot(get_absolute_time()) ;
+
+  if (!inAvailable)
+  {
+    sAvailable = false ;
+    return ;
+  }
+
+  if (sAvailable && (theCurrentMs - sLastRefreshMs) < kRefreshIntervalMs)
+  {
+    return ;
+  }
+  sLastRefreshMs = theCurrentMs ;
+
+  // Build the file list from the flight headers
+  MscFlightFile theFiles[kMaxStoredFlights] ;
+  memset(theFiles, 0, sizeof(theFiles)) ;
+
+  for (uint8_t i = 0 ; i < kMaxStoredFlights ; i++)
+  {
+    FlightHeader theHeader ;
+    if (FlightStorage_GetHeader(i, &theHeader))
+    {
+      uint32_t theSamples = theHeader.pSampleCount ;
+      if (theSamples > kMaxCsvRows)
+      {
+        theSamples = kMaxCsvRows ;
+      }
+
+      theFiles[i].pUsed = true ;
+      theFiles[i].pFlightId = theHeader.pFlightId ;
+      theFiles[i].pSampleCount = theSamples ;
+      theFiles[i].pBinSize = FLASH_PAGE_SIZE + (theSamples * sizeof(FlightSample)) ;
+      theFiles[i].pCsvSize = kCsvHeaderLen + (theSamples * kMscCsvRowLen) ;
+    }
+  }
+
+  // Swap in the new list; the host re-reads FAT and directory
+  // after a UNIT ATTENTION
+  if (memcmp(theFiles, sFiles, sizeof(sFiles)) != 0)
+  {
+    uint32_t theInterrupts = save_and_disable_interrupts() ;
+    memcpy(sFiles, theFiles, sizeof(sFiles)) ;
+    sMediaChanged = true ;
+    restore_interrupts(theInterrupts) ;
+  }
+
+  sAvailable = true ;
+}
+
+//----------------------------------------------
+// TinyUSB MSC Callbacks
+//----------------------------------------------
+
+void tud_msc_inquiry_cb(
+  uint8_t inLun,
+  uint8_t outVendorId[8],
+  uint8_t outProductId[16],
+  uint8_t outProductRev[4])
+{
+  (void)inLun ;
+  memcpy(outVendorId, "ROCKET  ", 8) ;
+  memcpy(outProductId, "Flight Data     ", 16) ;
+  memcpy(outProductRev, "1.0 ", 4) ;
+}
+
+bool tud_msc_test_unit_ready_cb(uint8_t inLun)
+{
+  if (!sAvailable)
+  {
+    tud_msc_set_sense(inLun, SCSI_SENSE_NOT_READY, 0x04, 0x01) ;  // Becoming ready
+    return false ;
+  }
+
+  if (sMediaChanged)
+  {
+    sMediaChanged = false ;
+    tud_msc_set_sense(inLun, SCSI_SENSE_UNIT_ATTENTION, 0x28, 0x00) ;  // Medium changed
+    return false ;
+  }
+
+  return true ;
+}
+
+void tud_msc_capacity_cb(uint8_t inLun, uint32_t * outBlockCount, uint16_t * outBlockSize)
+{
+  (void)inLun ;
+  *outBlockCount = kMscSectorCount ;
+  *outBlockSize = kMscSectorSize ;
+}
+
+bool tud_msc_start_stop_cb(uint8_t inLun, uint8_t inPowerCondition, bool inStart, bool inLoadEject)
+{
+  (void)inLun ;
+  (void)inPowerCondition ;
+  (void)inStart ;
+  (void)inLoadEject ;
+  return true ;
+}
+
+bool tud_msc_is_writable_cb(uint8_t inLun)
+{
+  (void)inLun ;
+  return false ;
+}
+
+int32_t tud_msc_read10_cb(
+  uint8_t inLun,
+  uint32_t inLba,
+  uint32_t inOffset,
+  void * outBuffer,
+  uint32_t inBufferSize)
+{
+  if (!sAvailable)
+  {
+    tud_msc_set_sense(inLun, SCSI_SENSE_NOT_READY, 0x04, 0x01) ;
+    return -1 ;
+  }
+
+  uint8_t * theOut = (uint8_t *)outBuffer ;
+  uint32_t thePosition = (inLba * kMscSectorSize) + inOffset ;
+  uint32_t theRemaining = inBufferSize ;
+
+  while (theRemaining > 0)
+  {
+    uint32_t theLba = thePosition / kMscSectorSize ;
+    uint32_t theInSector = thePosition % kMscSectorSize ;
+    uint32_t theCount = kMscSectorSize - theInSector ;
+    if (theCount > theRemaining)
+    {
+      theCount = theRemaining ;
+    }
+
+    if (theCount == kMscSectorSize)
+    {
+      RenderSector(theLba, theOut) ;
+    }
+    else
+    {
+      RenderSector(theLba, sScratchSector) ;
+      memcpy(theOut, sScratchSector + theInSector, theCount) ;
+    }
+
+    theOut += theCount ;
+    thePosition += theCount ;
+    theRemaining -= theCount ;
+  }
+
+  return (int32_t)inBufferSize ;
+}
+
+int32_t tud_msc_write10_cb(
+  uint8_t inLun,
+  uint32_t inLba,
+  uint32_t inOffset,
+  uint8_t * inBuffer,
+  uint32_t inBufferSize)
+{
+  (void)inLba ;
+  (void)inOffset ;
+  (void)inBuffer ;
+  (void)inBufferSize ;
+
+  // Read-only volume
+  tud_msc_set_sense(inLun, SCSI_SENSE_DATA_PROTECT, 0x27, 0x00) ;
+  return -1 ;
+}
+
+int32_t tud_msc_scsi_cb(
+  uint8_t inLun,
+  const uint8_t inScsiCmd[16],
+  void * ioBuffer,
+  uint16_t inBufferSize)
+{
+  (void)ioBuffer ;
+  (void)inBufferSize ;
+
+  if (inScsiCmd[0] == SCSI_CMD_PREVENT_ALLOW_MEDIUM_REMOVAL)
+  {
+    return 0 ;
+  }
+
+  // Invalid command operation code
+  tud_msc_set_sense(inLun, SCSI_SENSE_ILLEGAL_REQUEST, 0x20, 0x00) ;
+  return -1 ;
+}
@@ -10,6 +10,7 @@
 // Created: 2026-02-01
 // Copyright: (c) 2025-2026 by Mark Gavin
 // License: Proprietary - All Rights Reserved
+// Modified: 2026-02-15 (shared telemetry layout and framing)
 //----------------------------------------------
 
 #include <RadioLib.h>
@@ -177,35 +178,69 @@ const char* flightStateNames[] = {
 };
 
 //----------------------------------------------
-// Telemetry Packet Structure (55 bytes)
+// LoRa Protocol (must match lora_protocol.h)
+// The RP2040 firmwares share one header in
+// firmware_common; a sketch cannot include from
+// outside its folder, so the layout is copied
+// here and pinned by the asserts below.
 //----------------------------------------------
+#define LORA_MAGIC              0xAF
+#define LORA_PACKET_TELEMETRY   0x01
+#define LORA_PACKET_COMMAND     0x03
+#define LORA_PACKET_INFO        0x08
+#define LORA_PACKET_SIZE        55
+
+// Status flags (telemetry byte 53)
+#define FLAG_PYRO1_CONTINUITY   0x01
+#define FLAG_PYRO2_CONTINUITY   0x02
+#define FLAG_GPS_FIX            0x10
+#define FLAG_SENSOR_OK          0x20
+
+// Flight states on air (the RP2040 enum has one
+// descent state for drogue and main)
+#define TELEMETRY_STATE_DESCENT 5
+#define TELEMETRY_STATE_LANDED  6
+#define TELEMETRY_STATE_COMPLETE 7
+
 typedef struct __attribute__((packed)) {
-    uint8_t  magic;         // 0xAA
-    uint8_t  type;          // 0x01 = telemetry
-    uint8_t  rocketId;      // 0-15
-    uint16_t sequence;      // Packet counter
-    uint8_t  state;         // Flight state
-    int32_t  altitudeCm;    // Altitude in cm
-    int16_t  velocityCmS;   // Velocity in cm/s
-    int16_t  accelMg;       // Acceleration in milli-g
-    int32_t  maxAltCm;      // Max altitude in cm
-    int32_t  latitude;      // Lat * 1e7
-    int32_t  longitude;     // Lon * 1e7
-    uint8_t  gpsSats;       // Satellites in view
-    uint8_t  gpsValid;      // GPS fix valid
-    int16_t  gyroX;         // Gyro X (deg/s * 10)
-    int16_t  gyroY;         // Gyro Y
-    int16_t  gyroZ;         // Gyro Z
-    int16_t  magX;          // Mag X
-    int16_t  magY;          // Mag Y
-    int16_t  magZ;          // Mag Z
-    uint8_t  pyro1Cont;     // Pyro 1 continuity
-    uint8_t  pyro2Cont;     // Pyro 2 continuity
-    uint8_t  armed;         // Arm switch state
-    int16_t  tempC10;       // Temperature * 10
-    uint16_t battMv;        // Battery voltage mV
-    uint8_t  checksum;      // XOR checksum
-} TelemetryPacket;
+    uint8_t  magic;             // 0xAF
+    uint8_t  packetType;        // 0x01 = telemetry
+    uint8_t  rocketId;          // Rocket ID (0-15)
+    uint16_t sequence;          // Packet counter
+    uint32_t timeMs;            // Time since boot (ms)
+    int32_t  altitudeCm;        // Altitude in cm
+    int16_t  velocityCmps;      // Velocity in cm/s
+    uint32_t pressurePa;        // Pressure (Pa)
+    int16_t  temperatureC10;    // Temperature * 10
+    int32_t  gpsLatitude;       // Lat * 1e6
+    int32_t  gpsLongitude;      // Lon * 1e6
+    int16_t  gpsSpeedCmps;      // Ground speed in cm/s
+    uint16_t gpsHeadingDeg10;   // Heading * 10
+    uint8_t  gpsSatellites;     // Satellites in use
+    int16_t  accelX;            // Accel in milli-g
+    int16_t  accelY;
+    int16_t  accelZ;
+    int16_t  gyroX;             // Gyro in deg/s * 10
+    int16_t  gyroY;
+    int16_t  gyroZ;
+    int16_t  magX;              // Mag in milligauss
+    int16_t  magY;
+    int16_t  magZ;
+    uint8_t  state;             // Flight state (TELEMETRY_STATE_*)
+    uint8_t  flags;             // Status flags (FLAG_*)
+    uint8_t  crc;               // CRC-8
+} LoRaTelemetryPacket;
+
+static_assert(sizeof(LoRaTelemetryPacket) == LORA_PACKET_SIZE, "telemetry packet size");
+static_assert(offsetof(LoRaTelemetryPacket, rocketId) == 2, "telemetry rocket ID offset");
+static_assert(offsetof(LoRaTelemetryPacket, sequence) == 3, "telemetry sequence offset");
+static_assert(offsetof(LoRaTelemetryPacket, timeMs) == 5, "telemetry time offset");
+static_assert(offsetof(LoRaTelemetryPacket, altitudeCm) == 9, "telemetry altitude offset");
+static_assert(offsetof(LoRaTelemetryPacket, gpsLatitude) == 21, "telemetry GPS offset");
+static_assert(offsetof(LoRaTelemetryPacket, accelX) == 34, "telemetry accel offset");
+static_assert(offsetof(LoRaTelemetryPacket, state) == 52, "telemetry state offset");
+static_assert(offsetof(LoRaTelemetryPacket, flags) == 53, "telemetry flags offset");
+static_assert(offsetof(LoRaTelemetryPacket, crc) == LORA_PACKET_SIZE - 1, "telemetry CRC offset");
 
 //----------------------------------------------
 // BMP390 Calibration Data
@@ -235,6 +270,7 @@ float altitudeM = 0;
 float velocityMps = 0;
 float maxAltitudeM = 0;
 float groundPressurePa = 101325;
+float pressurePa = 0;
 float temperatureC = 25;
 
 // Acceleration
@@ -984,45 +1020,93 @@ bool initLoRa() {
     return true;
 }
 
-void buildTelemetryPacket(TelemetryPacket* pkt) {
-    memset(pkt, 0, sizeof(TelemetryPacket));
+// CRC-8, polynomial 0x31, init 0xFF (table as lora_protocol.c)
+static const uint8_t CRC8_TABLE[256] = {
+    0x00, 0x31, 0x62, 0x53, 0xC4, 0xF5, 0xA6, 0x97, 0xB9, 0x88, 0xDB, 0xEA, 0x7D, 0x4C, 0x1F, 0x2E,
+    0x43, 0x72, 0x21, 0x10, 0x87, 0xB6, 0xE5, 0xD4, 0xFA, 0xCB, 0x98, 0xA9, 0x3E, 0x0F, 0x5C, 0x6D,
+    0x86, 0xB7, 0xE4, 0xD5, 0x42, 0x73, 0x20, 0x11, 0x3F, 0x0E, 0x5D, 0x6C, 0xFB, 0xCA, 0x99, 0xA8,
+    0xC5, 0xF4, 0xA7, 0x96, 0x01, 0x30, 0x63, 0x52, 0x7C, 0x4D, 0x1E, 0x2F, 0xB8, 0x89, 0xDA, 0xEB,
+    0x3D, 0x0C, 0x5F, 0x6E, 0xF9, 0xC8, 0x9B, 0xAA, 0x84, 0xB5, 0xE6, 0xD7, 0x40, 0x71, 0x22, 0x13,
+    0x7E, 0x4F, 0x1C, 0x2D, 0xBA, 0x8B, 0xD8, 0xE9, 0xC7, 0xF6, 0xA5, 0x94, 0x03, 0x32, 0x61, 0x50,
+    0xBB, 0x8A, 0xD9, 0xE8, 0x7F, 0x4E, 0x1D, 0x2C, 0x02, 0x33, 0x60, 0x51, 0xC6, 0xF7, 0xA4, 0x95,
+    0xF8, 0xC9, 0x9A, 0xAB, 0x3C, 0x0D, 0x5E, 0x6F, 0x41, 0x70, 0x23, 0x12, 0x85, 0xB4, 0xE7, 0xD6,
+    0x7A, 0x4B, 0x18, 0x29, 0xBE, 0x8F, 0xDC, 0xED, 0xC3, 0xF2, 0xA1, 0x90, 0x07, 0x36, 0x65, 0x54,
+    0x39, 0x08, 0x5B, 0x6A, 0xFD, 0xCC, 0x9F, 0xAE, 0x80, 0xB1, 0xE2, 0xD3, 0x44, 0x75, 0x26, 0x17,
+    0xFC, 0xCD, 0x9E, 0xAF, 0x38, 0x09, 0x5A, 0x6B, 0x45, 0x74, 0x27, 0x16, 0x81, 0xB0, 0xE3, 0xD2,
+    0xBF, 0x8E, 0xDD, 0xEC, 0x7B, 0x4A, 0x19, 0x28, 0x06, 0x37, 0x64, 0x55, 0xC2, 0xF3, 0xA0, 0x91,
+    0x47, 0x76, 0x25, 0x14, 0x83, 0xB2, 0xE1, 0xD0, 0xFE, 0xCF, 0x9C, 0xAD, 0x3A, 0x0B, 0x58, 0x69,
+    0x04, 0x35, 0x66, 0x57, 0xC0, 0xF1, 0xA2, 0x93, 0xBD, 0x8C, 0xDF, 0xEE, 0x79, 0x48, 0x1B, 0x2A,
+    0xC1, 0xF0, 0xA3, 0x92, 0x05, 0x34, 0x67, 0x56, 0x78, 0x49, 0x1A, 0x2B, 0xBC, 0x8D, 0xDE, 0xEF,
+    0x82, 0xB3, 0xE0, 0xD1, 0x46, 0x77, 0x24, 0x15, 0x3B, 0x0A, 0x59, 0x68, 0xFF, 0xCE, 0x9D, 0xAC
+};
+
+uint8_t crc8(const uint8_t* data, int len) {
+    uint8_t crc = 0xFF;
+    for (int i = 0; i < len; i++) {
+        crc = CRC8_TABLE[crc ^ data[i]];
+    }
+    return crc;
+}
 
-    pkt->magic = 0xAA;
-    pkt->type = 0x01;
+// Flight state as the gateways decode it
+uint8_t telemetryState() {
+    switch (flightState) {
+        case FLIGHT_STATE_DROGUE:
+        case FLIGHT_STATE_MAIN:
+            return TELEMETRY_STATE_DESCENT;
+        case FLIGHT_STATE_LANDED:
+            return TELEMETRY_STATE_LANDED;
+        case FLIGHT_STATE_COMPLETE:
+            return TELEMETRY_STATE_COMPLETE;
+        default:
+            return (uint8_t)flightState;
+    }
+}
+
+void buildTelemetryPacket(LoRaTelemetryPacket* pkt) {
+    memset(pkt, 0, sizeof(LoRaTelemetryPacket));
+
+    pkt->magic = LORA_MAGIC;
+    pkt->packetType = LORA_PACKET_TELEMETRY;
     pkt->rocketId = rocketId;
     pkt->sequence = telemetrySeq++;
-    pkt->state = (uint8_t)flightState;
+    pkt->timeMs = millis();
     pkt->altitudeCm = (int32_t)(altitudeM * 100);
-    pkt->velocityCmS = (int16_t)(velocityMps * 100);
-    pkt->accelMg = (int16_t)(accelMagnitude * 1000);
-    pkt->maxAltCm = (int32_t)(maxAltitudeM * 100);
-    pkt->latitude = (int32_t)(gpsLatitude * 1e7);
-    pkt->longitude = (int32_t)(gpsLongitude * 1e7);
-    pkt->gpsSats = gpsSatellites;
-    pkt->gpsValid = gpsValid ? 1 : 0;
+    pkt->velocityCmps = (int16_t)(velocityMps * 100);
+    pkt->pressurePa = (uint32_t)pressurePa;
+    pkt->temperatureC10 = (int16_t)(temperatureC * 10);
+    pkt->gpsLatitude = (int32_t)(gpsLatitude * 1e6);
+    pkt->gpsLongitude = (int32_t)(gpsLongitude * 1e6);
+    if (gps.speed.isValid()) {
+        pkt->gpsSpeedCmps = (int16_t)(gps.speed.mps() * 100);
+    }
+    if (gps.course.isValid()) {
+        pkt->gpsHeadingDeg10 = (uint16_t)(gps.course.deg() * 10);
+    }
+    pkt->gpsSatellites = gpsSatellites;
+    pkt->accelX = (int16_t)(accelX * 1000);
+    pkt->accelY = (int16_t)(accelY * 1000);
+    pkt->accelZ = (int16_t)(accelZ * 1000);
     pkt->gyroX = (int16_t)(gyroX * 10);
     pkt->gyroY = (int16_t)(gyroY * 10);
     pkt->gyroZ = (int16_t)(gyroZ * 10);
     pkt->magX = (int16_t)(magX * 1000);
     pkt->magY = (int16_t)(magY * 1000);
     pkt->magZ = (int16_t)(magZ * 1000);
-    pkt->pyro1Cont = pyro1Continuity ? 1 : 0;
-    pkt->pyro2Cont = pyro2Continuity ? 1 : 0;
-    pkt->armed = isArmed ? 1 : 0;
-    pkt->tempC10 = (int16_t)(temperatureC * 10);
-    pkt->battMv = 3700;  // TODO: Read battery
-
-    // Calculate checksum
-    uint8_t* data = (uint8_t*)pkt;
-    uint8_t checksum = 0;
-    for (int i = 0; i < sizeof(TelemetryPacket) - 1; i++) {
-        checksum ^= data[i];
-    }
-    pkt->checksum = checksum;
+    pkt->state = telemetryState();
+
+    uint8_t flags = 0;
+    if (pyro1Continuity) flags |= FLAG_PYRO1_CONTINUITY;
+    if (pyro2Continuity) flags |= FLAG_PYRO2_CONTINUITY;
+    if (gpsValid) flags |= FLAG_GPS_FIX;
+    if (baroInitialized && imuInitialized) flags |= FLAG_SENSOR_OK;
+    pkt->flags = flags;
+
+    pkt->crc = crc8((const uint8_t*)pkt, sizeof(LoRaTelemetryPacket) - 1);
 }
 
 void transmitTelemetry() {
-    TelemetryPacket pkt;
+    LoRaTelemetryPacket pkt;
     buildTelemetryPacket(&pkt);
 
     int state = radio.transmit((uint8_t*)&pkt, sizeof(pkt));
@@ -1043,8 +1127,8 @@ void handleLoRaReceive() {
     if (len > 0 && len <= sizeof(buffer)) {
         int state = radio.readData(buffer, len);
         if (state == RADIOLIB_ERR_NONE) {
-            // Parse command packet
-            if (len >= 4 && buffer[0] == 0xAA && buffer[1] == 0x02) {
+            // Parse command packet: magic, type, target, command, params
+            if (len >= 4 && buffer[0] == LORA_MAGIC && buffer[1] == LORA_PACKET_COMMAND) {
                 uint8_t targetId = buffer[2];
                 uint8_t cmdId = buffer[3];
 
@@ -1106,8 +1190,8 @@ void sendDeviceInfo() {
     int idx = 0;
 
     // Header
-    packet[idx++] = 0xAA;           // Magic
-    packet[idx++] = 0x08;           // Type: fc_info response
+    packet[idx++] = LORA_MAGIC;             // Magic
+    packet[idx++] = LORA_PACKET_INFO;       // Type: fc_info response
 
     // Version string
     const char* version = FIRMWARE_VERSION_STRING;
@@ -1412,9 +1496,8 @@ void loop() {
 
         // Read barometer
         if (baroInitialized) {
-            float pressure;
-            if (readBarometer(&pressure, &temperatureC)) {
-                altitudeM = pressureToAltitude(pressure, groundPressurePa);
+            if (readBarometer(&pressurePa, &temperatureC)) {
+                altitudeM = pressureToAltitude(pressurePa, groundPressurePa);
                 updateVelocity();
             }
         }
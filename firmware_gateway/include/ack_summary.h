@@ -0,0 +1,191 @@
+//----------------------------------------------
+// Module: ack_summary.h
+// Description: Aggregated telemetry ACKs (one
+//   summary per interval for every rocket heard)
+// Author: Mark Gavin
+// Created: 2026-02-14
+// Copyright: (c) 2025-2026 by Mark Gavin
+// License: Proprietary - All Rights Reserved
+// Modified: 2026-02-15 (flight event ACKs)
+//
+// The packet layout is in lora_protocol.h
+// (kLoRaPacketAckSummary). In
+// place of a kLoRaPacketAck after every frame,
+// each rocket heard since the last summary gets
+// one entry: its latest sequence, a bitmap of the
+// 16 before it, and the average signal of the
+// frames it sent since. A summary goes out every
+// pIntervalMs, or at once on request.
+//
+// With the interval at 0 the gateway goes back to
+// one kLoRaPacketAck per frame, for flight
+// computers that predate the summary.
+//
+// A flight event carried on telemetry asks for a
+// summary at once, whatever the interval; after
+// the entries it names the latest event sequence
+// heard from each rocket with one still owed.
+//----------------------------------------------
+
+#pragma once
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "lora_protocol.h"
+
+//----------------------------------------------
+// Constants
+// Summary layout: lora_protocol.h
+//----------------------------------------------
+#define kAckSummaryMaxLen       (kAckSummaryHeaderLen + kAckSummaryMaxEntries * kAckSummaryEntryLen + \
+                                 1 + kAckEventMaxEntries * kAckEventEntryLen)
+
+//----------------------------------------------
+// Constants
+//----------------------------------------------
+#define kAckMaxRockets          16
+#define kAckMinIntervalMs       100
+#define kAckMaxIntervalMs       4000    // Under the flight link timeout (5 s)
+
+//----------------------------------------------
+// Per-Rocket Record
+//----------------------------------------------
+typedef struct
+{
+  bool pPending ;                 // Heard since the last summary
+  bool pSequenceValid ;
+  uint8_t pLastSequence ;
+  uint16_t pBitmap ;              // Bit n: pLastSequence - 1 - n received
+  uint8_t pFrames ;               // Since the last summary
+  int32_t pRssiSum ;
+  int16_t pSnrSum ;
+
+  // Flight events
+  bool pEventValid ;
+  uint8_t pEventSequence ;        // Latest heard
+  bool pEventPending ;            // ACK owed
+} AckRocket ;
+
+//----------------------------------------------
+// Summary State
+//----------------------------------------------
+typedef struct
+{
+  uint16_t pIntervalMs ;          // 0: one ACK per frame
+  bool pRequested ;               // Send at the next chance
+  uint8_t pSequence ;
+  uint8_t pNextRocket ;           // First entry of the next summary
+  uint32_t pLastSentMs ;
+  AckRocket pRockets[kAckMaxRockets] ;
+
+  // Statistics
+  uint32_t pFrames ;              // Telemetry frames acknowledged
+  uint32_t pSummaries ;
+  uint32_t pEntries ;
+  uint32_t pAirUs ;               // Airtime of the summaries sent
+  uint32_t pEvents ;              // Flight events heard (first copy)
+  uint32_t pEventRepeats ;        // Sent again before our ACK got through
+  uint32_t pEventAcks ;
+} AckSummary ;
+
+//----------------------------------------------
+// Function: AckSummary_Init
+// Purpose: Start with no rockets heard
+// Parameters:
+//   outSummary - State to initialize
+//   inIntervalMs - Summary interval (0: one ACK
+//     per frame)
+//----------------------------------------------
+void AckSummary_Init(AckSummary * outSummary, uint16_t inIntervalMs) ;
+
+//----------------------------------------------
+// Function: AckSummary_Configure
+// Purpose: Change the interval or ask for a
+//   summary now
+// Parameters:
+//   ioSummary - State
+//   inIntervalMs - New interval (-1: keep; 0, or
+//     kAckMinIntervalMs to kAckMaxIntervalMs)
+//   inNow - Send a summary at the next chance
+// Returns: false if the interval is out of range
+//   (nothing is changed)
+//----------------------------------------------
+bool AckSummary_Configure(AckSummary * ioSummary, int inIntervalMs, bool inNow) ;
+
+//----------------------------------------------
+// Function: AckSummary_RecordFrame
+// Purpose: Note a telemetry frame for the next
+//   summary
+// Parameters:
+//   ioSummary - State
+//   inRocketId - Sender
+//   inSequence - Low byte of its sequence number
+//   inRssi - Received RSSI
+//   inSnr - Received SNR
+//----------------------------------------------
+void AckSummary_RecordFrame(
+  AckSummary * ioSummary,
+  uint8_t inRocketId,
+  uint8_t inSequence,
+  int16_t inRssi,
+  int8_t inSnr) ;
+
+//----------------------------------------------
+// Function: AckSummary_RecordEvent
+// Purpose: Note a flight event for the next
+//   summary, which is asked for at once
+// Parameters:
+//   ioSummary - State
+//   inRocketId - Sender
+//   inSequence - Event sequence
+// Returns: true the first time the event is heard
+//   (false for a repeat)
+//----------------------------------------------
+bool AckSummary_RecordEvent(AckSummary * ioSummary, uint8_t inRocketId, uint8_t inSequence) ;
+
+//----------------------------------------------
+// Function: AckSummary_IsDue
+// Purpose: Check whether a summary should go out
+// Parameters:
+//   inSummary - State
+//   inNowMs - Current time (ms since boot)
+// Returns: true if one was asked for, or a rocket
+//   has been heard and the interval has passed
+//----------------------------------------------
+bool AckSummary_IsDue(const AckSummary * inSummary, uint32_t inNowMs) ;
+
+//----------------------------------------------
+// Function: AckSummary_Build
+// Purpose: Build the next summary packet
+// Parameters:
+//   ioSummary - State (listed rockets are
+//     cleared for the next interval)
+//   inNowMs - Current time (ms since boot)
+//   outPacket - Output buffer
+//   inMaxLen - Buffer size (kAckSummaryMaxLen)
+// Returns: Packet length, 0 on error
+// Notes: With more rockets pending than fit, the
+//   rest lead the next summary
+//----------------------------------------------
+int AckSummary_Build(
+  AckSummary * ioSummary,
+  uint32_t inNowMs,
+  uint8_t * outPacket,
+  int inMaxLen) ;
+
+//----------------------------------------------
+// Function: AckSummary_StatsToJson
+// Purpose: Report the settings and counters
+// Parameters:
+//   inSummary - State
+//   inAckAirUs - Airtime of one per-frame ACK,
+//     for the comparison figure
+//   outJson - Output buffer
+//   inMaxLen - Buffer size
+// Returns: JSON length, 0 on error
+//----------------------------------------------
+int AckSummary_StatsToJson(
+  const AckSummary * inSummary,
+  uint32_t inAckAirUs,
+  char * outJson,
+  int inMaxLen) ;
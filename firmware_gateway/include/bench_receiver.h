@@ -0,0 +1,204 @@
+//----------------------------------------------
+// Module: bench_receiver.h
+// Description: LoRa link benchmark (gateway side:
+//   receiver and results)
+// Author: Mark Gavin
+// Created: 2026-02-15
+// Copyright: (c) 2025-2026 by Mark Gavin
+// License: Proprietary - All Rights Reserved
+//
+// The command, the schedule and the frame layout
+// are in the flight firmware's link_bench.h. The
+// gateway sends kCmdBenchmark, starts the clock
+// when it is off the air and follows the same
+// schedule: base settings until the rocket's
+// answer, then each point's data rate and coding
+// rate, then back to its own.
+//
+// For each point it keeps the frames heard out
+// of those sent, RSSI and SNR (lowest, mean,
+// highest and spread), frames lost to a payload
+// CRC error, the airtime of one frame and the
+// goodput: bits delivered per second of airtime
+// spent. Points are reported as they end, then
+// the run as a whole.
+//----------------------------------------------
+
+#pragma once
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "lora_protocol.h"
+#include "lora_radio.h"
+
+//----------------------------------------------
+// Constants
+// Frame layout and run limits: lora_protocol.h
+//----------------------------------------------
+// BenchReceiver_GetPoint, outside the points
+#define kBenchPointStart        0xFF
+#define kBenchPointDone         0xFE
+
+//----------------------------------------------
+// Received Frame Kinds
+//----------------------------------------------
+typedef enum
+{
+  kBenchRxNone = 0 ,              // Not for this run
+  kBenchRxAccepted ,
+  kBenchRxRefused ,
+  kBenchRxFrame
+} BenchRxKind ;
+
+//----------------------------------------------
+// Matrix Point and its Results
+//----------------------------------------------
+typedef struct
+{
+  uint8_t pRate ;                 // Data rate index
+  uint8_t pCodingRate ;           // LoRa_CodingRate
+  int8_t pPowerDbm ;              // 0: the rocket's power in use
+  uint8_t pLen ;
+  uint32_t pAirUs ;
+  uint32_t pStartMs ;             // From the end of kBenchStartMs
+  uint32_t pDurationMs ;
+
+  uint8_t pReceived ;
+  uint8_t pDuplicates ;
+  uint16_t pCrcErrors ;
+  int16_t pRssiMin ;
+  int16_t pRssiMax ;
+  int32_t pRssiSum ;
+  uint32_t pRssiSquares ;
+  int8_t pSnrMin ;
+  int8_t pSnrMax ;
+  int32_t pSnrSum ;
+  uint32_t pSnrSquares ;
+} BenchPoint ;
+
+//----------------------------------------------
+// Receiver State
+//----------------------------------------------
+typedef struct
+{
+  bool pActive ;                  // Run open: beacons, ACKs, commands held
+  bool pAnchored ;                // Command off the air, clock running
+  bool pAccepted ;                // Rocket's answer heard
+  uint8_t pRocketId ;
+  uint8_t pSession ;
+  uint8_t pFrames ;               // Per point
+  uint8_t pPointCount ;
+  uint8_t pPoint ;                // Point results go to
+  uint32_t pAnchorUs ;
+  uint32_t pStartMs ;
+  uint32_t pSeen[(kBenchMaxFrames + 31) / 32] ;  // Frames of pPoint heard
+  uint32_t pCrcErrorsBase ;       // Radio CRC errors as pPoint began
+  BenchPoint pPoints[kBenchMaxPoints] ;
+} BenchReceiver ;
+
+//----------------------------------------------
+// Function: BenchReceiver_Start
+// Purpose: Open a run before sending kCmdBenchmark
+// Parameters:
+//   outBench - Receiver state
+//   inParams - Command bytes from 4 (session
+//     first; GatewayProtocol_ParseBenchmarkParams)
+//   inRocketId - Rocket asked
+//   inNowMs - Current time (ms since boot)
+// Returns: false if the plan is invalid, has more
+//   than kBenchMaxPoints points or runs longer
+//   than kBenchMaxMs (outBench is left inactive)
+//----------------------------------------------
+bool BenchReceiver_Start(
+  BenchReceiver * outBench,
+  const uint8_t * inParams,
+  uint8_t inRocketId,
+  uint32_t inNowMs) ;
+
+//----------------------------------------------
+// Function: BenchReceiver_SetAnchor
+// Purpose: Start the schedule
+// Parameters:
+//   ioBench - Receiver state
+//   inNowUs - TxDone of the command (time_us_32)
+//----------------------------------------------
+void BenchReceiver_SetAnchor(BenchReceiver * ioBench, uint32_t inNowUs) ;
+
+//----------------------------------------------
+// Function: BenchReceiver_GetPoint
+// Purpose: Point the schedule is at
+// Parameters:
+//   inBench - Receiver state
+//   inNowUs - Current time (time_us_32)
+// Returns: Point index, kBenchPointStart before
+//   the first (or the anchor) or kBenchPointDone
+//   after the last
+//----------------------------------------------
+uint8_t BenchReceiver_GetPoint(const BenchReceiver * inBench, uint32_t inNowUs) ;
+
+//----------------------------------------------
+// Function: BenchReceiver_EnterPoint
+// Purpose: Close the current point and gather
+//   results for another
+// Parameters:
+//   ioBench - Receiver state
+//   inPoint - Point now running (or
+//     kBenchPointDone)
+//   inCrcErrors - Radio's payload CRC error count
+//----------------------------------------------
+void BenchReceiver_EnterPoint(BenchReceiver * ioBench, uint8_t inPoint, uint32_t inCrcErrors) ;
+
+//----------------------------------------------
+// Function: BenchReceiver_ProcessFrame
+// Purpose: Count a received benchmark frame
+// Parameters:
+//   ioBench - Receiver state
+//   inPacket - Received packet (magic, type, ...)
+//   inLen - Packet length
+//   inRssi - Its RSSI, dBm
+//   inSnr - Its SNR, dB
+// Returns: What it was (BenchRxKind)
+//----------------------------------------------
+BenchRxKind BenchReceiver_ProcessFrame(
+  BenchReceiver * ioBench,
+  const uint8_t * inPacket,
+  int inLen,
+  int16_t inRssi,
+  int8_t inSnr) ;
+
+//----------------------------------------------
+// Function: BenchReceiver_PointToJson
+// Purpose: Report one point's results
+// Parameters:
+//   inBench - Receiver state
+//   inPoint - Point index
+//   outJson - Output buffer
+//   inMaxLen - Buffer size
+// Returns: JSON length, 0 on error
+//----------------------------------------------
+int BenchReceiver_PointToJson(
+  const BenchReceiver * inBench,
+  uint8_t inPoint,
+  char * outJson,
+  int inMaxLen) ;
+
+//----------------------------------------------
+// Function: BenchReceiver_StatusToJson
+// Purpose: Report the run
+// Parameters:
+//   inBench - Receiver state
+//   inStatus - "started", "refused", "failed" or
+//     "done"
+//   inNowMs - Current time (ms since boot)
+//   outJson - Output buffer
+//   inMaxLen - Buffer size
+// Returns: JSON length, 0 on error
+// Notes: "done" adds the totals and the point
+//   with the best goodput
+//----------------------------------------------
+int BenchReceiver_StatusToJson(
+  const BenchReceiver * inBench,
+  const char * inStatus,
+  uint32_t inNowMs,
+  char * outJson,
+  int inMaxLen) ;
@@ -0,0 +1,193 @@
+//----------------------------------------------
+// Module: bulk_download.h
+// Description: Sliding-window bulk download of a
+//   stored flight over LoRa (receiver side)
+// Author: Mark Gavin
+// Created: 2026-02-13
+// Copyright: (c) 2025-2026 by Mark Gavin
+// License: Proprietary - All Rights Reserved
+// Modified: 2026-02-16 (delta-coded runs, transfer rate)
+// Modified: 2026-02-16 (host ID on delivered chunks)
+//
+// Packet layouts and the window rules are in the
+// flight firmware's flash_bulk.h. The flight
+// streams chunks of two samples back-to-back,
+// a delta-coded run of them per packet; each
+// packet with the poll flag is answered with a
+// kCmdFlashBulkAck naming the first missing
+// chunk and a bitmap of the 32 after it. The
+// radio stays at the transfer's data rate while
+// the session is open.
+//
+// Chunks may arrive out of order after a loss.
+// They are held here and delivered to the host
+// strictly in order, as the same flash_data JSON
+// (or, for binary clients, the same storage data
+// packet) that kCmdFlashRead produces, so clients
+// append them as before.
+//----------------------------------------------
+
+#pragma once
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "lora_protocol.h"
+
+//----------------------------------------------
+// Constants
+// Chunk and ACK layout: lora_protocol.h
+//----------------------------------------------
+#define kBulkIdleTimeoutMs      10000   // No chunk: transfer failed
+#define kBulkLingerMs           3000    // Keep answering polls once done
+#define kBulkPacketMaxLen       (12 + kBulkSamplesPerChunk * kBulkSampleLen)  // Rebuilt storage data packet
+
+//----------------------------------------------
+// Receiver State
+//----------------------------------------------
+typedef struct
+{
+  bool pActive ;                  // Session open; TDMA beacons held
+  bool pComplete ;                // Every chunk delivered
+  uint8_t pRocketId ;
+  uint8_t pSlot ;
+  uint8_t pSession ;
+  uint8_t pRate ;                 // Data rate for the transfer
+  uint32_t pCommandId ;           // Host command ID, on every message
+  uint16_t pSampleCount ;         // From the first chunk (0 until then)
+  uint16_t pChunkCount ;
+  uint16_t pBase ;                // Next chunk to deliver
+  uint32_t pReceived ;            // Held chunks: bit n = pBase + n
+  uint8_t pChunkLen[kBulkWindowChunks] ;  // Sample bytes, by chunk % window
+  uint8_t pChunks[kBulkWindowChunks][kBulkSamplesPerChunk * kBulkSampleLen] ;
+  uint32_t pStartMs ;
+  uint32_t pLastRxMs ;
+
+  // Statistics
+  uint32_t pPacketsReceived ;
+  uint32_t pChunksReceived ;      // New chunks
+  uint32_t pDuplicates ;
+  uint32_t pAcksSent ;
+} BulkDownload ;
+
+//----------------------------------------------
+// Function: BulkDownload_Start
+// Purpose: Open a session before sending
+//   kCmdFlashBulkRead
+// Parameters:
+//   outDownload - Receiver state (any earlier
+//     session is dropped)
+//   inRocketId - Rocket asked (0xFF: the first
+//     to answer)
+//   inSlot - Flight slot
+//   inSession - Session number in the request
+//   inRate - Data rate in the request
+//   inCommandId - Host command ID (0: none)
+//   inNowMs - Current time (ms since boot)
+//----------------------------------------------
+void BulkDownload_Start(
+  BulkDownload * outDownload,
+  uint8_t inRocketId,
+  uint8_t inSlot,
+  uint8_t inSession,
+  uint8_t inRate,
+  uint32_t inCommandId,
+  uint32_t inNowMs) ;
+
+//----------------------------------------------
+// Function: BulkDownload_ProcessChunk
+// Purpose: Hold the chunks of a received packet
+//   for delivery
+// Parameters:
+//   ioDownload - Receiver state
+//   inPacket - Received packet (magic, type, ...)
+//   inLen - Packet length
+//   inNowMs - Current time (ms since boot)
+//   outPoll - Set if the sender wants an ACK
+// Returns: false if the packet is not for the
+//   open session
+//----------------------------------------------
+bool BulkDownload_ProcessChunk(
+  BulkDownload * ioDownload,
+  const uint8_t * inPacket,
+  int inLen,
+  uint32_t inNowMs,
+  bool * outPoll) ;
+
+//----------------------------------------------
+// Function: BulkDownload_NextPacket
+// Purpose: Deliver the next chunk in order as the
+//   kLoRaPacketStorageData packet a kCmdFlashRead
+//   reply would have been
+// Parameters:
+//   ioDownload - Receiver state
+//   outPacket - Output buffer
+//   inMaxLen - Buffer size (kBulkPacketMaxLen)
+// Returns: Packet length, 0 when the next chunk
+//   has not arrived
+// Notes: Binary clients get the packet as it is;
+//   BulkDownload_NextToJson wraps it for JSON ones
+//----------------------------------------------
+int BulkDownload_NextPacket(
+  BulkDownload * ioDownload,
+  uint8_t * outPacket,
+  int inMaxLen) ;
+
+//----------------------------------------------
+// Function: BulkDownload_NextToJson
+// Purpose: Deliver the next chunk in order
+// Parameters:
+//   ioDownload - Receiver state
+//   outJson - Output buffer
+//   inMaxLen - Buffer size (1024)
+// Returns: flash_data JSON length, 0 when the
+//   next chunk has not arrived
+// Notes: Call until it returns 0 after every
+//   chunk received, before building the ACK
+//----------------------------------------------
+int BulkDownload_NextToJson(
+  BulkDownload * ioDownload,
+  char * outJson,
+  int inMaxLen) ;
+
+//----------------------------------------------
+// Function: BulkDownload_BuildAck
+// Purpose: Build the kCmdFlashBulkAck command
+// Parameters:
+//   inDownload - Receiver state
+//   outPacket - Output buffer
+//   inMaxLen - Buffer size (kBulkAckLen)
+// Returns: Packet length, 0 on error
+//----------------------------------------------
+int BulkDownload_BuildAck(
+  const BulkDownload * inDownload,
+  uint8_t * outPacket,
+  int inMaxLen) ;
+
+//----------------------------------------------
+// Function: BulkDownload_CheckTimeout
+// Purpose: Close a session that has gone quiet
+// Parameters:
+//   ioDownload - Receiver state
+//   inNowMs - Current time (ms since boot)
+// Returns: true if an unfinished transfer was
+//   given up (report it as failed)
+//----------------------------------------------
+bool BulkDownload_CheckTimeout(BulkDownload * ioDownload, uint32_t inNowMs) ;
+
+//----------------------------------------------
+// Function: BulkDownload_StatusToJson
+// Purpose: Report a transfer's progress
+// Parameters:
+//   inDownload - Receiver state
+//   inStatus - "started", "done" or "failed"
+//   inNowMs - Current time (ms since boot)
+//   outJson - Output buffer
+//   inMaxLen - Buffer size
+// Returns: JSON length, 0 on error
+//----------------------------------------------
+int BulkDownload_StatusToJson(
+  const BulkDownload * inDownload,
+  const char * inStatus,
+  uint32_t inNowMs,
+  char * outJson,
+  int inMaxLen) ;
@@ -0,0 +1,170 @@
+//----------------------------------------------
+// Module: channel_plan.h
+// Description: Receive channel selection for the
+//   multi-channel frequency plan
+// Author: Mark Gavin
+// Created: 2026-02-15
+// Copyright: (c) 2025-2026 by Mark Gavin
+// License: Proprietary - All Rights Reserved
+//
+// The plan itself (kLoRaChannelCount channels from
+// kLoRaFrequency) is in lora_radio.h. Everything
+// the gateway sends goes out on the control
+// channel (0), which every rocket listens on.
+// Rockets with the plan on send on the uplink
+// channel for their ID, so the one radio here has
+// to be on that channel to hear them:
+//
+//   - A rocket the host is talking to (command
+//     reply, bulk download) has the radio until
+//     its focus time runs out.
+//   - Under TDMA the radio follows the owner of
+//     each data slot.
+//   - Otherwise it dwells kChannelDwellMs on each
+//     channel a rocket was heard on lately, and
+//     every kChannelScanEvery hops spends
+//     kChannelScanMs on the next quiet channel to
+//     find rockets it has not heard yet.
+//
+// A rocket's channel is learned from where its
+// frames come in; until then it is taken to be
+// its assigned channel.
+//----------------------------------------------
+
+#pragma once
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "lora_radio.h"
+
+//----------------------------------------------
+// Constants
+//----------------------------------------------
+#define kChannelMaxRockets      16
+#define kChannelUnknown         0xFF
+#define kChannelDwellMs         1000    // On a channel with rockets
+#define kChannelScanMs          300     // On a quiet channel
+#define kChannelScanEvery       8       // Hops between scans
+#define kChannelActiveMs        10000   // Heard this recently: in the hop set
+#define kChannelFocusMs         3000    // After a command to one rocket
+
+//----------------------------------------------
+// Plan State
+//----------------------------------------------
+typedef struct
+{
+  bool pEnabled ;                 // Hop; off stays on the control channel
+  uint8_t pChannel ;              // Listening on
+  uint8_t pHopChannel ;           // Where hopping has got to
+  uint32_t pDwellStartMs ;
+  uint32_t pDwellMs ;             // Of the current dwell
+  uint8_t pHops ;                 // Since the last scan
+  uint8_t pScanNext ;             // Next channel to scan
+  uint8_t pFocusRocket ;          // kChannelUnknown: none
+  uint32_t pFocusUntilMs ;
+  uint32_t pLastHeardMs[kLoRaChannelCount] ;
+  uint8_t pRocketChannel[kChannelMaxRockets] ;  // Learned (kChannelUnknown: not yet)
+
+  // Statistics
+  uint32_t pRetunes ;
+  uint32_t pFrames[kLoRaChannelCount] ;
+} ChannelPlan ;
+
+//----------------------------------------------
+// Function: ChannelPlan_Init
+// Purpose: Start on the control channel with no
+//   rockets heard
+// Parameters:
+//   outPlan - State to initialize
+//   inEnabled - Hop across the plan
+//----------------------------------------------
+void ChannelPlan_Init(ChannelPlan * outPlan, bool inEnabled) ;
+
+//----------------------------------------------
+// Function: ChannelPlan_GetRocketChannel
+// Purpose: Channel a rocket is expected to send on
+// Parameters:
+//   inPlan - State
+//   inRocketId - Rocket ID
+// Returns: Where it was last heard, else its
+//   assigned channel
+//----------------------------------------------
+uint8_t ChannelPlan_GetRocketChannel(const ChannelPlan * inPlan, uint8_t inRocketId) ;
+
+//----------------------------------------------
+// Function: ChannelPlan_SetRocketChannel
+// Purpose: Note where a rocket will send after a
+//   channel plan command
+// Parameters:
+//   ioPlan - State
+//   inRocketId - Rocket ID (0xFF: every rocket
+//     heard so far)
+//   inOwnChannel - true: its assigned channel,
+//     false: the control channel
+//----------------------------------------------
+void ChannelPlan_SetRocketChannel(ChannelPlan * ioPlan, uint8_t inRocketId, bool inOwnChannel) ;
+
+//----------------------------------------------
+// Function: ChannelPlan_RecordFrame
+// Purpose: Note a packet and the channel it came
+//   in on
+// Parameters:
+//   ioPlan - State
+//   inFrequencyHz - Receive frequency of the packet
+//   inRocketId - Sender, kChannelUnknown if the
+//     packet does not say
+//   inNowMs - Current time (ms since boot)
+//----------------------------------------------
+void ChannelPlan_RecordFrame(
+  ChannelPlan * ioPlan,
+  uint32_t inFrequencyHz,
+  uint8_t inRocketId,
+  uint32_t inNowMs) ;
+
+//----------------------------------------------
+// Function: ChannelPlan_Focus
+// Purpose: Stay on one rocket's channel for a
+//   while (command replies, downloads)
+// Parameters:
+//   ioPlan - State
+//   inRocketId - Rocket ID (0xFF: no focus)
+//   inNowMs - Current time (ms since boot)
+//   inDurationMs - How long
+//----------------------------------------------
+void ChannelPlan_Focus(
+  ChannelPlan * ioPlan,
+  uint8_t inRocketId,
+  uint32_t inNowMs,
+  uint32_t inDurationMs) ;
+
+//----------------------------------------------
+// Function: ChannelPlan_Select
+// Purpose: Pick the channel to listen on now
+// Parameters:
+//   ioPlan - State
+//   inNowMs - Current time (ms since boot)
+//   inSlotRocket - Owner of the TDMA data slot in
+//     progress, kChannelUnknown outside one or
+//     with TDMA off
+// Returns: Channel (the radio should be retuned
+//   if it differs from pChannel)
+//----------------------------------------------
+uint8_t ChannelPlan_Select(ChannelPlan * ioPlan, uint32_t inNowMs, uint8_t inSlotRocket) ;
+
+//----------------------------------------------
+// Function: ChannelPlan_ToJson
+// Purpose: Report the plan, the channel in use and
+//   each rocket's channel
+// Parameters:
+//   inPlan - State
+//   inNowMs - Current time (ms since boot)
+//   outJson - Output buffer
+//   inMaxLen - Buffer size (kJsonChannelBufferSize)
+// Returns: JSON length, 0 on error
+//----------------------------------------------
+int ChannelPlan_ToJson(
+  const ChannelPlan * inPlan,
+  uint32_t inNowMs,
+  char * outJson,
+  int inMaxLen) ;
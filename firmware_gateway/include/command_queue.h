@@ -0,0 +1,311 @@
+//----------------------------------------------
+// Module: command_queue.h
+// Description: Per-rocket command queue released
+//   into each rocket's receive window
+// Author: Mark Gavin
+// Created: 2026-02-15
+// Copyright: (c) 2025-2026 by Mark Gavin
+// License: Proprietary - All Rights Reserved
+// Modified: 2026-02-15 (request IDs, outstanding commands and retries)
+// Modified: 2026-02-16 (host ID for a response)
+//
+// The window itself is described in
+// lora_protocol.h (kFlagRxWindow).
+// Host commands for one rocket wait here. While
+// the rocket announces windows, each telemetry
+// frame with kFlagRxWindow releases the oldest
+// command into the window after it. A rocket that
+// has not announced one for kCmdWindowStaleMs
+// (TDMA, older firmware) gets its commands at
+// once, as before. A command that finds no
+// window in kCmdExpireMs is dropped.
+//
+// Each queued command goes out as a
+// kLoRaPacketRequest with a request ID of its
+// own, which the rocket's kLoRaPacketCommandReply
+// echoes. Up to kCmdOutstandingMax commands per
+// rocket may be on air unanswered; one not
+// answered in kCmdReplyTimeoutMs goes back to
+// the head of the queue to be sent again, up to
+// kCmdMaxAttempts sends in all.
+//
+// Latency is measured from the host line to the
+// release (queue time) and from the last send to
+// the reply (round trip). Broadcast commands are
+// not queued and get no reply.
+//----------------------------------------------
+
+#pragma once
+
+#include <stdint.h>
+#include <stdbool.h>
+
+//----------------------------------------------
+// Constants
+//----------------------------------------------
+#define kCmdQueueMaxRockets     16
+#define kCmdQueueDepth          4       // Per rocket
+#define kCmdQueueMaxLen         48
+#define kCmdWindowStaleMs       3000    // No window this long: send at once
+#define kCmdExpireMs            10000   // Queued this long: dropped
+#define kCmdOutstandingMax      4       // Sent and unanswered, per rocket
+#define kCmdReplyTimeoutMs      3000    // No reply this long: sent again
+#define kCmdMaxAttempts         3
+
+//----------------------------------------------
+// Queued Command
+//----------------------------------------------
+typedef struct
+{
+  uint8_t pLen ;
+  uint8_t pData[kCmdQueueMaxLen] ;  // LoRa request packet
+  uint32_t pCommandId ;           // Host command ID
+  uint8_t pRequestId ;            // LoRa request ID (byte 3)
+  uint8_t pAttempts ;             // Sends so far
+  uint8_t pStatus ;               // Reply status (kReply*)
+  uint32_t pQueuedMs ;            // Host line
+  uint32_t pSentMs ;              // Last send
+  bool pInWindow ;                // Released into a receive window
+} QueuedCommand ;
+
+//----------------------------------------------
+// Per-Rocket Queue
+//----------------------------------------------
+typedef struct
+{
+  QueuedCommand pEntries[kCmdQueueDepth] ;
+  uint8_t pHead ;
+  uint8_t pCount ;
+  bool pWindowSeen ;
+  uint32_t pLastWindowMs ;        // Last frame announcing a window
+  uint8_t pNextRequestId ;
+
+  // Sent, waiting for their replies (oldest first)
+  QueuedCommand pOutstanding[kCmdOutstandingMax] ;
+  uint8_t pOutstandingCount ;
+
+  // Statistics
+  uint32_t pCommands ;            // Sent at least once
+  uint32_t pSent ;                // Sends, retries included
+  uint32_t pInWindow ;
+  uint32_t pExpired ;
+  uint32_t pRetries ;
+  uint32_t pTimeouts ;            // Unanswered after kCmdMaxAttempts
+  uint32_t pWindows ;             // Windows announced
+  uint32_t pQueueMsSum ;
+  uint32_t pQueueMsMax ;
+  uint32_t pReplies ;
+  uint32_t pRttMsSum ;
+  uint32_t pRttMsMin ;
+  uint32_t pRttMsMax ;
+} CommandRocket ;
+
+//----------------------------------------------
+// Queue State
+//----------------------------------------------
+typedef struct
+{
+  CommandRocket pRockets[kCmdQueueMaxRockets] ;
+} CommandQueue ;
+
+//----------------------------------------------
+// Function: CommandQueue_Init
+// Purpose: Start with nothing queued
+// Parameters:
+//   outQueue - State to initialize
+//----------------------------------------------
+void CommandQueue_Init(CommandQueue * outQueue) ;
+
+//----------------------------------------------
+// Function: CommandQueue_Push
+// Purpose: Queue a command for its target rocket
+//   as a request with the next request ID
+// Parameters:
+//   ioQueue - State
+//   inPacket - LoRa command packet (target at
+//     byte 2, 0-15)
+//   inLen - Packet length
+//   inCommandId - Host command ID
+//   inNowMs - Current time (ms since boot)
+// Returns: false if the target is not a single
+//   rocket, the request would be too long or its
+//   queue is full
+//----------------------------------------------
+bool CommandQueue_Push(
+  CommandQueue * ioQueue,
+  const uint8_t * inPacket,
+  uint8_t inLen,
+  uint32_t inCommandId,
+  uint32_t inNowMs) ;
+
+//----------------------------------------------
+// Function: CommandQueue_RecordWindow
+// Purpose: Note a frame that announced a receive
+//   window
+// Parameters:
+//   ioQueue - State
+//   inRocketId - Sender
+//   inNowMs - Current time (ms since boot)
+//----------------------------------------------
+void CommandQueue_RecordWindow(CommandQueue * ioQueue, uint8_t inRocketId, uint32_t inNowMs) ;
+
+//----------------------------------------------
+// Function: CommandQueue_IsWindowed
+// Purpose: Check whether a rocket's commands wait
+//   for its windows
+// Parameters:
+//   inQueue - State
+//   inRocketId - Rocket ID
+//   inNowMs - Current time (ms since boot)
+// Returns: true if it announced a window in the
+//   last kCmdWindowStaleMs
+//----------------------------------------------
+bool CommandQueue_IsWindowed(const CommandQueue * inQueue, uint8_t inRocketId, uint32_t inNowMs) ;
+
+//----------------------------------------------
+// Function: CommandQueue_Peek
+// Purpose: Oldest command waiting for a rocket
+// Parameters:
+//   inQueue - State
+//   inRocketId - Rocket ID
+// Returns: The command, NULL if none, or if
+//   kCmdOutstandingMax are already unanswered
+//----------------------------------------------
+const QueuedCommand * CommandQueue_Peek(const CommandQueue * inQueue, uint8_t inRocketId) ;
+
+//----------------------------------------------
+// Function: CommandQueue_MarkSent
+// Purpose: Move the oldest command to the
+//   outstanding list once it has been handed to
+//   the radio
+// Parameters:
+//   ioQueue - State
+//   inRocketId - Rocket ID
+//   inNowMs - Current time (ms since boot)
+//   inInWindow - Sent into a receive window
+//   outCommand - The command as sent (may be NULL)
+//----------------------------------------------
+void CommandQueue_MarkSent(
+  CommandQueue * ioQueue,
+  uint8_t inRocketId,
+  uint32_t inNowMs,
+  bool inInWindow,
+  QueuedCommand * outCommand) ;
+
+//----------------------------------------------
+// Function: CommandQueue_TakeExpired
+// Purpose: Drop the oldest command if it has
+//   waited kCmdExpireMs
+// Parameters:
+//   ioQueue - State
+//   inRocketId - Rocket ID
+//   inNowMs - Current time (ms since boot)
+//   outCommand - The dropped command
+// Returns: true if one was dropped
+//----------------------------------------------
+bool CommandQueue_TakeExpired(
+  CommandQueue * ioQueue,
+  uint8_t inRocketId,
+  uint32_t inNowMs,
+  QueuedCommand * outCommand) ;
+
+//----------------------------------------------
+// Function: CommandQueue_TakeOverdue
+// Purpose: Take an outstanding command whose
+//   reply is kCmdReplyTimeoutMs late
+// Parameters:
+//   ioQueue - State
+//   inRocketId - Rocket ID
+//   inNowMs - Current time (ms since boot)
+//   outCommand - The command
+//   outRetry - true if it went back to the head
+//     of the queue, false if it was given up
+// Returns: true if one was overdue
+//----------------------------------------------
+bool CommandQueue_TakeOverdue(
+  CommandQueue * ioQueue,
+  uint8_t inRocketId,
+  uint32_t inNowMs,
+  QueuedCommand * outCommand,
+  bool * outRetry) ;
+
+//----------------------------------------------
+// Function: CommandQueue_RecordReply
+// Purpose: Match a command reply to its request
+// Parameters:
+//   ioQueue - State
+//   inPacket - kLoRaPacketCommandReply packet
+//   inLen - Packet length
+//   inNowMs - Current time (ms since boot)
+//   outCommand - The command answered (pStatus
+//     set from the reply)
+// Returns: true if the request was outstanding,
+//   or queued again after a late reply
+//----------------------------------------------
+bool CommandQueue_RecordReply(
+  CommandQueue * ioQueue,
+  const uint8_t * inPacket,
+  uint8_t inLen,
+  uint32_t inNowMs,
+  QueuedCommand * outCommand) ;
+
+//----------------------------------------------
+// Function: CommandQueue_FindRequest
+// Purpose: Host command ID of the request a
+//   response answers (info, flash list, flash
+//   read)
+// Parameters:
+//   inQueue - State
+//   inRocketId - Rocket ID (0xFF: any rocket, for
+//     responses that do not carry it)
+//   inCommand - Command answered (kCmd*)
+//   outCommandId - Host command ID
+// Returns: true if such a request was sent and
+//   is not yet answered
+// Notes: The rocket sends a response ahead of its
+//   command reply, so the request is still
+//   outstanding; the oldest send matches
+//----------------------------------------------
+bool CommandQueue_FindRequest(
+  const CommandQueue * inQueue,
+  uint8_t inRocketId,
+  uint8_t inCommand,
+  uint32_t * outCommandId) ;
+
+//----------------------------------------------
+// Function: CommandQueue_EventToJson
+// Purpose: Report one command's progress
+// Parameters:
+//   inCommand - Command
+//   inEvent - "sent", "retry", "reply", "timeout"
+//     or "expired"
+//   inNowMs - Current time (ms since boot)
+//   inAirUs - Airtime of the command ("sent")
+//   outJson - Output buffer
+//   inMaxLen - Buffer size
+// Returns: JSON length, 0 on error
+//----------------------------------------------
+int CommandQueue_EventToJson(
+  const QueuedCommand * inCommand,
+  const char * inEvent,
+  uint32_t inNowMs,
+  uint32_t inAirUs,
+  char * outJson,
+  int inMaxLen) ;
+
+//----------------------------------------------
+// Function: CommandQueue_StatsToJson
+// Purpose: Report queue depth and latency per
+//   rocket
+// Parameters:
+//   inQueue - State
+//   inNowMs - Current time (ms since boot)
+//   outJson - Output buffer
+//   inMaxLen - Buffer size (kJsonCommandBufferSize)
+// Returns: JSON length, 0 on error
+//----------------------------------------------
+int CommandQueue_StatsToJson(
+  const CommandQueue * inQueue,
+  uint32_t inNowMs,
+  char * outJson,
+  int inMaxLen) ;
@@ -0,0 +1,148 @@
+//----------------------------------------------
+// Module: fec_decoder.h
+// Description: Telemetry loss recovery from the
+//   flight computer's FEC parity frames
+// Author: Mark Gavin
+// Created: 2026-02-14
+// Copyright: (c) 2025-2026 by Mark Gavin
+// License: Proprietary - All Rights Reserved
+//
+// The parity frame layout is in the flight
+// firmware's telemetry_fec.h (kLoRaPacketParity).
+// Every telemetry frame heard is folded into its
+// rocket's running XOR for the group it belongs
+// to. When the group's parity frame arrives, the
+// one frame it lists but that was not heard (if
+// exactly one) is rebuilt and handed back to the
+// receive path as if it had just come in.
+//
+// The group size K is learned from the first
+// parity frame of each rocket, so the group that
+// is open when FEC is turned on cannot be
+// repaired.
+//----------------------------------------------
+
+#pragma once
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "lora_protocol.h"
+
+//----------------------------------------------
+// Constants
+//----------------------------------------------
+#define kFecMaxRockets          16
+#define kFecStatsIntervalMs     10000
+
+//----------------------------------------------
+// Per-Rocket Group Accumulator
+//----------------------------------------------
+typedef struct
+{
+  uint8_t pGroup ;                // K from its parity frames; 0 until one is heard
+  bool pOpen ;                    // Frames of group pBase are folded in
+  uint8_t pBase ;
+  uint8_t pMask ;                 // Bit n: sequence pBase + n heard
+  uint8_t pLenXor ;
+  uint8_t pXor[kFecMaxFrameLen] ;
+} FecRocket ;
+
+//----------------------------------------------
+// Decoder State
+//----------------------------------------------
+typedef struct
+{
+  FecRocket pRockets[kFecMaxRockets] ;
+  uint8_t pRecovered[kFecMaxFrameLen] ;
+  uint8_t pRecoveredLen ;         // Waiting for the receive path (0: none)
+  uint32_t pLastStatsMs ;
+
+  // Statistics
+  uint32_t pFrames ;              // Telemetry frames heard
+  uint32_t pFrameBytes ;
+  uint32_t pParityFrames ;
+  uint32_t pParityBytes ;
+  uint32_t pCleanGroups ;         // Nothing missing
+  uint32_t pRecoveredFrames ;
+  uint32_t pUnrecoverable ;       // Frames lost in groups missing two or more
+} FecDecoder ;
+
+//----------------------------------------------
+// Function: FecDecoder_Init
+// Purpose: Start with no rockets heard
+// Parameters:
+//   outDecoder - State to initialize
+//----------------------------------------------
+void FecDecoder_Init(FecDecoder * outDecoder) ;
+
+//----------------------------------------------
+// Function: FecDecoder_RecordFrame
+// Purpose: Fold a received telemetry frame into
+//   its group
+// Parameters:
+//   ioDecoder - State
+//   inRocketId - Sender
+//   inSequence - Low byte of its sequence number
+//   inFrame - Frame as received (before compact
+//     expansion)
+//   inLen - Frame length
+//----------------------------------------------
+void FecDecoder_RecordFrame(
+  FecDecoder * ioDecoder,
+  uint8_t inRocketId,
+  uint8_t inSequence,
+  const uint8_t * inFrame,
+  uint8_t inLen) ;
+
+//----------------------------------------------
+// Function: FecDecoder_ProcessParity
+// Purpose: Close a group with its parity frame
+// Parameters:
+//   ioDecoder - State
+//   inPacket - kLoRaPacketParity frame
+//   inLen - Frame length
+// Returns: false if the frame is malformed
+// Notes: A rebuilt frame waits for
+//   FecDecoder_TakeRecovered
+//----------------------------------------------
+bool FecDecoder_ProcessParity(FecDecoder * ioDecoder, const uint8_t * inPacket, uint8_t inLen) ;
+
+//----------------------------------------------
+// Function: FecDecoder_TakeRecovered
+// Purpose: Collect the frame rebuilt from the
+//   last parity frame
+// Parameters:
+//   ioDecoder - State
+//   outFrame - Output buffer
+//   inMaxLen - Buffer size
+// Returns: Frame length, 0 if none is waiting
+//----------------------------------------------
+uint8_t FecDecoder_TakeRecovered(FecDecoder * ioDecoder, uint8_t * outFrame, uint8_t inMaxLen) ;
+
+//----------------------------------------------
+// Function: FecDecoder_IsStatsDue
+// Purpose: Check for the periodic report
+// Parameters:
+//   inDecoder - State
+//   inNowMs - Current time (ms since boot)
+// Returns: true every kFecStatsIntervalMs once a
+//   parity frame has been heard
+//----------------------------------------------
+bool FecDecoder_IsStatsDue(const FecDecoder * inDecoder, uint32_t inNowMs) ;
+
+//----------------------------------------------
+// Function: FecDecoder_StatsToJson
+// Purpose: Report the recovery counters and the
+//   airtime overhead of the parity frames
+// Parameters:
+//   ioDecoder - State (restarts the report timer)
+//   inNowMs - Current time (ms since boot)
+//   outJson - Output buffer
+//   inMaxLen - Buffer size
+// Returns: JSON length, 0 on error
+//----------------------------------------------
+int FecDecoder_StatsToJson(
+  FecDecoder * ioDecoder,
+  uint32_t inNowMs,
+  char * outJson,
+  int inMaxLen) ;
@@ -6,6 +6,23 @@
 // Created: 2026-01-10
 // Copyright: (c) 2025-2026 by Mark Gavin
 // License: Proprietary - All Rights Reserved
+// Modified: 2026-02-10 (compact telemetry frame)
+// Modified: 2026-02-11 (batched high-rate telemetry)
+// Modified: 2026-02-12 (TDMA beacon and schedule command)
+// Modified: 2026-02-13 (bulk flash download)
+// Modified: 2026-02-14 (adaptive data rate)
+// Modified: 2026-02-14 (aggregated ACK summary)
+// Modified: 2026-02-14 (telemetry FEC parity)
+// Modified: 2026-02-15 (multi-channel frequency plan)
+// Modified: 2026-02-15 (receive window after telemetry)
+// Modified: 2026-02-15 (listen before talk statistics)
+// Modified: 2026-02-15 (flight event trailer)
+// Modified: 2026-02-15 (command request IDs and replies)
+// Modified: 2026-02-15 (telemetry profiles and recovery beacon)
+// Modified: 2026-02-15 (link benchmark command)
+// Modified: 2026-02-15 (shared protocol header, rocket ID in telemetry)
+// Modified: 2026-02-15 (binary output command)
+// Modified: 2026-02-16 (wire constants only in lora_protocol.h)
 //----------------------------------------------
 
 #pragma once
@@ -13,90 +30,31 @@
 #include <stdint.h>
 #include <stdbool.h>
 
-//----------------------------------------------
-// LoRa Packet Types (must match flight_control.h)
-//----------------------------------------------
-#define kLoRaMagic              0xAF
-#define kLoRaPacketTelemetry    0x01
-#define kLoRaPacketStatus       0x02
-#define kLoRaPacketCommand      0x03
-#define kLoRaPacketAck          0x04
-#define kLoRaPacketData         0x05
-#define kLoRaPacketStorageList  0x06  // Storage list response
-#define kLoRaPacketStorageData  0x07  // Storage data chunk
-#define kLoRaPacketInfo         0x08  // Device info response
+#include "lora_protocol.h"
 
 //----------------------------------------------
-// Command IDs (sent in kLoRaPacketCommand)
+// LoRa Packet Layout
+// Frame header, packet types, command IDs, flags,
+// every frame layout and their constants live in
+// lora_protocol.h (firmware_common), shared with
+// the flight computer
 //----------------------------------------------
-#define kCmdArm             0x01
-#define kCmdDisarm          0x02
-#define kCmdStatus          0x03
-#define kCmdReset           0x04
-#define kCmdDownload        0x05
-#define kCmdPing            0x06
-#define kCmdInfo            0x07  // Request device info
-#define kCmdOrientationMode 0x08  // Enable/disable high-rate orientation testing
 
-// Storage commands
-#define kCmdSdList          0x10
-#define kCmdSdRead          0x11
-#define kCmdSdDelete        0x12
-#define kCmdFlashList       0x20
-#define kCmdFlashRead       0x21
-#define kCmdFlashDelete     0x22
+// Host output formats (output command); binary
+// records are laid out in gateway_stream.h
+#define kOutputFormatJson       0
+#define kOutputFormatBinary     1
 
-//----------------------------------------------
-// LoRa Telemetry Packet (binary, 54 bytes)
-// Must match flight_control.h exactly!
-//----------------------------------------------
-typedef struct __attribute__((packed))
+// Flight event, decoded from a trailer
+typedef struct
 {
-  // Header (4 bytes)
-  uint8_t pMagic ;                // 0xAF (Avionics Flight)
-  uint8_t pPacketType ;           // 0x01 = telemetry
-  uint16_t pSequence ;            // Packet sequence number
-
-  // Time (4 bytes)
-  uint32_t pTimeMs ;              // Mission time (ms)
-
-  // Barometric data (12 bytes)
-  int32_t pAltitudeCm ;           // Barometric altitude in centimeters
-  int16_t pVelocityCmps ;         // Vertical velocity in cm/s
-  uint32_t pPressurePa ;          // Pressure (Pa)
-  int16_t pTemperatureC10 ;       // Temperature * 10 (0.1C resolution)
-
-  // GPS data (13 bytes)
-  int32_t pGpsLatitude ;          // Latitude in microdegrees (deg * 1e6)
-  int32_t pGpsLongitude ;         // Longitude in microdegrees (deg * 1e6)
-  int16_t pGpsSpeedCmps ;         // GPS ground speed in cm/s
-  uint16_t pGpsHeadingDeg10 ;     // Heading * 10 (0-3600 = 0-360.0 deg)
-  uint8_t pGpsSatellites ;        // Number of satellites in use
-
-  // Accelerometer (6 bytes) - values in milli-g (mg)
-  int16_t pAccelX ;               // Accelerometer X
-  int16_t pAccelY ;               // Accelerometer Y
-  int16_t pAccelZ ;               // Accelerometer Z
-
-  // Gyroscope (6 bytes) - values in 0.1 degrees/second
-  int16_t pGyroX ;                // Gyroscope X
-  int16_t pGyroY ;                // Gyroscope Y
-  int16_t pGyroZ ;                // Gyroscope Z
-
-  // Magnetometer (6 bytes) - values in milligauss
-  int16_t pMagX ;                 // Magnetometer X
-  int16_t pMagY ;                 // Magnetometer Y
-  int16_t pMagZ ;                 // Magnetometer Z
-
-  // Status (3 bytes)
-  uint8_t pState ;                // Flight state enum
-  uint8_t pFlags ;                // Status flags
-  uint8_t pCrc ;                  // CRC-8
-} LoRaTelemetryPacket ;
-
-// Flags byte bit definitions
-#define kFlagGpsFix             0x10  // GPS has valid fix
-#define kFlagOrientationMode    0x80  // Orientation testing mode active
+  uint8_t pSequence ;
+  uint8_t pType ;                 // kEvent*
+  uint8_t pState ;                // Flight state after the event
+  uint32_t pTimeMs ;              // Rocket clock, ms since boot
+  int32_t pAltitudeDm ;
+  int16_t pVelocityDms ;
+} FlightEvent ;
 
 //----------------------------------------------
 // USB Command Types (from desktop app)
@@ -119,13 +77,27 @@ typedef enum
   kUsbCmdFlashList = 20 ,
   kUsbCmdFlashRead ,
   kUsbCmdFlashDelete ,
+  kUsbCmdFlashBulk ,       // Sliding-window download of a whole flight
   // WiFi configuration commands (30+)
   kUsbCmdWifiList = 30 ,
   kUsbCmdWifiAdd ,
   kUsbCmdWifiRemove ,
   kUsbCmdWifiSave ,
   kUsbCmdWifiStatus ,
-  kUsbCmdWifiSetAp
+  kUsbCmdWifiSetAp ,
+  // Radio link commands (40+)
+  kUsbCmdCompactTelemetry = 40 ,
+  kUsbCmdTelemetryBatch ,
+  kUsbCmdTdma ,            // TDMA schedule settings and statistics
+  kUsbCmdDataRate ,        // Adaptive data rate settings and statistics
+  kUsbCmdAck ,             // ACK summary interval and statistics
+  kUsbCmdFec,              // Telemetry FEC group size and statistics
+  kUsbCmdChannelPlan,      // Per-rocket uplink channels and receive channel
+  kUsbCmdCommandQueue,     // Queued commands and their latency
+  kUsbCmdTelemetryProfile, // Telemetry interval per flight phase
+  kUsbCmdBenchmark ,       // Link benchmark run
+  // Host link commands (50+)
+  kUsbCmdOutput = 50       // JSON or binary output for this client
 } UsbCommandType ;
 
 //----------------------------------------------
@@ -140,6 +112,13 @@ typedef struct
   uint32_t pPacketsLost ;         // Packets lost (CRC errors, etc.)
   int16_t pLastRssi ;             // RSSI of last packet
   int8_t pLastSnr ;               // SNR of last packet
+  uint8_t pChannel ;              // Receive channel (channel plan)
+  uint32_t pCrcErrors ;           // Received with a bad CRC (mostly collisions)
+  bool pListenBeforeTalk ;        // Clear channel check before sending
+  uint32_t pCadChecks ;           // Channel checks run
+  uint32_t pLbtDeferrals ;        // Sends held for a busy channel
+  uint32_t pLbtForced ;           // Sent on a busy channel at the cap
+  uint32_t pLbtHoldMaxUs ;        // Longest hold for a clear channel
 } GatewayState ;
 
 //----------------------------------------------
@@ -236,6 +215,33 @@ int GatewayProtocol_BuildAckJson(
   char * outJson,
   int inMaxLen) ;
 
+//----------------------------------------------
+// Function: GatewayProtocol_ParseOutputParams
+// Purpose: Parse the output command
+// Parameters:
+//   inJson - JSON string to parse
+// Returns: kOutputFormat* from "format":"json"
+//   or "binary", -1 if absent (the command then
+//   only reports the current format)
+//----------------------------------------------
+int GatewayProtocol_ParseOutputParams(const char * inJson) ;
+
+//----------------------------------------------
+// Function: GatewayProtocol_BuildOutputJson
+// Purpose: Build the output command reply
+// Parameters:
+//   inCommandId - Command ID being answered
+//   inFormat - Client's format (kOutputFormat*)
+//   outJson - Buffer for JSON string
+//   inMaxLen - Maximum JSON length
+// Returns: Length of JSON string
+//----------------------------------------------
+int GatewayProtocol_BuildOutputJson(
+  uint32_t inCommandId,
+  int inFormat,
+  char * outJson,
+  int inMaxLen) ;
+
 //----------------------------------------------
 // Function: GatewayProtocol_GetStateName
 // Purpose: Get flight state name string
@@ -358,6 +364,354 @@ int GatewayProtocol_BuildOrientationModeCommand(
   uint8_t * outPacket,
   int inMaxLen) ;
 
+//----------------------------------------------
+// Function: GatewayProtocol_BuildTelemetryFormatCommand
+// Purpose: Build LoRa command selecting the full or
+//   compact telemetry frame
+// Parameters:
+//   inTargetRocketId - Rocket ID
+//   inCompact - true for the compact frame
+//   outPacket - Buffer for packet data
+//   inMaxLen - Maximum packet length
+// Returns: Packet length
+//----------------------------------------------
+int GatewayProtocol_BuildTelemetryFormatCommand(
+  uint8_t inTargetRocketId,
+  bool inCompact,
+  uint8_t * outPacket,
+  int inMaxLen) ;
+
+//----------------------------------------------
+// Function: GatewayProtocol_BuildTelemetryBatchCommand
+// Purpose: Build LoRa command enabling batched
+//   high-rate telemetry in flight
+// Parameters:
+//   inTargetRocketId - Rocket ID
+//   inEnabled - Enable or disable batching
+//   outPacket - Buffer for packet data
+//   inMaxLen - Maximum packet length
+// Returns: Packet length
+//----------------------------------------------
+int GatewayProtocol_BuildTelemetryBatchCommand(
+  uint8_t inTargetRocketId,
+  bool inEnabled,
+  uint8_t * outPacket,
+  int inMaxLen) ;
+
+//----------------------------------------------
+// Function: GatewayProtocol_TelemetryBatchToJson
+// Purpose: Expand a telemetry batch frame into
+//   per-sample JSON records
+// Parameters:
+//   inPacket - Binary packet data
+//   inLen - Packet length
+//   inRssi - RSSI of received packet
+//   inSnr - SNR of received packet
+//   outJson - Buffer for JSON string
+//   inMaxLen - Maximum JSON length
+//   outAltitudeM - Last sample altitude (can be NULL)
+//   outVelocityMps - Last sample velocity (can be NULL)
+// Returns: Length of JSON string, 0 if the frame
+//   is malformed or fails its CRC
+// Notes: Layout is in lora_protocol.h
+//----------------------------------------------
+int GatewayProtocol_TelemetryBatchToJson(
+  const uint8_t * inPacket,
+  int inLen,
+  int16_t inRssi,
+  int8_t inSnr,
+  char * outJson,
+  int inMaxLen,
+  float * outAltitudeM,
+  float * outVelocityMps) ;
+
+//----------------------------------------------
+// Function: GatewayProtocol_DecodeCompactTelemetry
+// Purpose: Expand a compact telemetry frame
+//   (kLoRaMagicCompact) into a full packet
+// Parameters:
+//   inData - Received frame
+//   inLen - Frame length
+//   outPacket - Full packet to fill
+// Returns: true if the frame is valid
+// Notes: Keeps the GPS origin and slow fields of
+//   each rocket between frames. Until a frame with
+//   the matching origin has been seen, the GPS fix
+//   flag is cleared and position reads as zero.
+//----------------------------------------------
+bool GatewayProtocol_DecodeCompactTelemetry(
+  const uint8_t * inData,
+  int inLen,
+  LoRaTelemetryPacket * outPacket) ;
+
+//----------------------------------------------
+// Function: GatewayProtocol_GetTelemetrySource
+// Purpose: Read sender and sequence from a raw
+//   telemetry frame (full, compact, batch
+//   or recovery beacon)
+// Parameters:
+//   inData - Received frame, before expansion
+//   inLen - Frame length
+//   outRocketId - Sender rocket ID
+//   outSequence - Low byte of the sequence number
+// Returns: false if the frame is not telemetry
+// Notes: The frame is not validated here
+//----------------------------------------------
+bool GatewayProtocol_GetTelemetrySource(
+  const uint8_t * inData,
+  int inLen,
+  uint8_t * outRocketId,
+  uint8_t * outSequence) ;
+
+//----------------------------------------------
+// Function: GatewayProtocol_GetTelemetryFlags
+// Purpose: Read the status flags from a raw
+//   telemetry frame (full, compact, batch
+//   or recovery beacon)
+// Parameters:
+//   inData - Received frame, before expansion
+//   inLen - Frame length
+//   outFlags - Flags byte (kFlag*)
+// Returns: false if the frame is not telemetry
+// Notes: The frame is not validated here
+//----------------------------------------------
+bool GatewayProtocol_GetTelemetryFlags(
+  const uint8_t * inData,
+  int inLen,
+  uint8_t * outFlags) ;
+
+//----------------------------------------------
+// Function: GatewayProtocol_TakeEventTrailer
+// Purpose: Split a flight event trailer off a
+//   raw telemetry frame
+// Parameters:
+//   ioData - Received frame, before expansion;
+//     its event trailer mark is cleared
+//   ioLen - Frame length; shortened by the
+//     trailer when the frame is marked
+//   outEvent - The event
+// Returns: true if the frame carried a valid
+//   event
+//----------------------------------------------
+bool GatewayProtocol_TakeEventTrailer(
+  uint8_t * ioData,
+  uint8_t * ioLen,
+  FlightEvent * outEvent) ;
+
+//----------------------------------------------
+// Function: GatewayProtocol_EventToJson
+// Purpose: Convert a flight event to JSON
+// Parameters:
+//   inRocketId - Sender
+//   inEvent - Event
+//   inRssi - Signal strength of its frame
+//   inSnr - SNR of its frame
+//   outJson - Output buffer
+//   inMaxLen - Buffer size
+// Returns: JSON length, 0 on error
+//----------------------------------------------
+int GatewayProtocol_EventToJson(
+  uint8_t inRocketId,
+  const FlightEvent * inEvent,
+  int16_t inRssi,
+  int8_t inSnr,
+  char * outJson,
+  int inMaxLen) ;
+
+//----------------------------------------------
+// Function: GatewayProtocol_RecoveryToJson
+// Purpose: Convert a recovery beacon to JSON
+// Parameters:
+//   inPacket - Beacon (trailer removed)
+//   inLen - Beacon length
+//   inRssi - RSSI of received packet
+//   inSnr - SNR of received packet
+//   inGwGpsValid - Gateway GPS has valid fix
+//   inGwGpsLat - Gateway GPS latitude
+//   inGwGpsLon - Gateway GPS longitude
+//   outJson - Output buffer
+//   inMaxLen - Buffer size
+// Returns: JSON length, 0 on a bad beacon
+//----------------------------------------------
+int GatewayProtocol_RecoveryToJson(
+  const uint8_t * inPacket,
+  int inLen,
+  int16_t inRssi,
+  int8_t inSnr,
+  bool inGwGpsValid,
+  float inGwGpsLat,
+  float inGwGpsLon,
+  char * outJson,
+  int inMaxLen) ;
+
+//----------------------------------------------
+// Function: GatewayProtocol_ParseTdmaParams
+// Purpose: Parse the tdma command
+// Parameters:
+//   inJson - JSON string to parse
+//   ioEnabled - "enabled":true/false if present
+//   outSlotMs - "slot_ms":N, or 0 if absent
+// Notes: Both fields are optional; a command
+//   with neither only reports statistics
+//----------------------------------------------
+void GatewayProtocol_ParseTdmaParams(
+  const char * inJson,
+  bool * ioEnabled,
+  uint16_t * outSlotMs) ;
+
+//----------------------------------------------
+// Function: GatewayProtocol_ParseDataRateParams
+// Purpose: Parse the data_rate command
+// Parameters:
+//   inJson - JSON string to parse
+//   ioAuto - "enabled":true/false if present
+//   outRate - "rate":N, or -1 if absent
+//   outAttenDb - "atten_db":N, or -1 if absent
+//   outReset - "reset":true present
+// Notes: Every field is optional; a command with
+//   none only reports statistics
+//----------------------------------------------
+void GatewayProtocol_ParseDataRateParams(
+  const char * inJson,
+  bool * ioAuto,
+  int * outRate,
+  int * outAttenDb,
+  bool * outReset) ;
+
+//----------------------------------------------
+// Function: GatewayProtocol_ParseAckParams
+// Purpose: Parse the ack command
+// Parameters:
+//   inJson - JSON string to parse
+//   outIntervalMs - "interval_ms":N, or -1 if
+//     absent
+//   outNow - "now":true present
+//----------------------------------------------
+void GatewayProtocol_ParseAckParams(
+  const char * inJson,
+  int * outIntervalMs,
+  bool * outNow) ;
+
+//----------------------------------------------
+// Function: GatewayProtocol_ParseFecParams
+// Purpose: Parse the fec command
+// Parameters:
+//   inJson - JSON string to parse
+// Returns: "group":N, or -1 if absent (the
+//   command then only reports statistics)
+//----------------------------------------------
+int GatewayProtocol_ParseFecParams(const char * inJson) ;
+
+//----------------------------------------------
+// Function: GatewayProtocol_BuildFecCommand
+// Purpose: Build LoRa command setting the
+//   telemetry FEC group size
+// Parameters:
+//   inTargetRocketId - Rocket ID
+//   inGroup - Group size (0 = off, 2, 4 or 8)
+//   outPacket - Buffer for packet data
+//   inMaxLen - Maximum packet length
+// Returns: Packet length
+//----------------------------------------------
+int GatewayProtocol_BuildFecCommand(
+  uint8_t inTargetRocketId,
+  uint8_t inGroup,
+  uint8_t * outPacket,
+  int inMaxLen) ;
+
+//----------------------------------------------
+// Function: GatewayProtocol_ParseTelemetryProfileParams
+// Purpose: Parse the telemetry_profile command
+// Parameters:
+//   inJson - JSON string to parse
+//   outProfile - "profile":N, or
+//     kTelemetryProfileDefaults with
+//     "defaults":true
+//   outIntervalMs - "interval_ms":N
+// Returns: true with "defaults":true, or with
+//   both a profile and an interval
+//----------------------------------------------
+bool GatewayProtocol_ParseTelemetryProfileParams(
+  const char * inJson,
+  uint8_t * outProfile,
+  uint16_t * outIntervalMs) ;
+
+//----------------------------------------------
+// Function: GatewayProtocol_BuildTelemetryProfileCommand
+// Purpose: Build LoRa command setting the
+//   telemetry interval of one flight phase
+// Parameters:
+//   inTargetRocketId - Rocket ID
+//   inProfile - kTelemetryProfile*, or
+//     kTelemetryProfileDefaults
+//   inIntervalMs - Interval, ms
+//   outPacket - Buffer for packet data
+//   inMaxLen - Maximum packet length
+// Returns: Packet length
+//----------------------------------------------
+int GatewayProtocol_BuildTelemetryProfileCommand(
+  uint8_t inTargetRocketId,
+  uint8_t inProfile,
+  uint16_t inIntervalMs,
+  uint8_t * outPacket,
+  int inMaxLen) ;
+
+//----------------------------------------------
+// Function: GatewayProtocol_ParseBenchmarkParams
+// Purpose: Parse the benchmark command into the
+//   plan bytes of kCmdBenchmark (link_bench.h)
+// Parameters:
+//   inJson - JSON string to parse
+//   inSession - Session number for the run
+//   outParams - kBenchParamsLen bytes
+// Returns: false if a list has a value out of
+//   range or too many entries
+// Notes: "rates":[..] table indexes (default
+//   all), "cr":[5..8] (default [5]), "power":[..]
+//   dBm (default the rocket's own), "len":[..]
+//   bytes (default [16,64,200]), "frames":N
+//   (default 20)
+//----------------------------------------------
+bool GatewayProtocol_ParseBenchmarkParams(
+  const char * inJson,
+  uint8_t inSession,
+  uint8_t * outParams) ;
+
+//----------------------------------------------
+// Function: GatewayProtocol_BuildBenchmarkCommand
+// Purpose: Build LoRa command starting a link
+//   benchmark
+// Parameters:
+//   inTargetRocketId - Rocket ID
+//   inParams - Plan (GatewayProtocol_ParseBenchmarkParams)
+//   outPacket - Buffer for packet data
+//   inMaxLen - Maximum packet length
+// Returns: Packet length
+//----------------------------------------------
+int GatewayProtocol_BuildBenchmarkCommand(
+  uint8_t inTargetRocketId,
+  const uint8_t * inParams,
+  uint8_t * outPacket,
+  int inMaxLen) ;
+
+//----------------------------------------------
+// Function: GatewayProtocol_BuildChannelPlanCommand
+// Purpose: Build LoRa command moving a rocket's
+//   uplink to its own channel or back to the
+//   control channel
+// Parameters:
+//   inTargetRocketId - Rocket ID
+//   inOwnChannel - true: own channel
+//   outPacket - Buffer for packet data
+//   inMaxLen - Maximum packet length
+// Returns: Packet length
+//----------------------------------------------
+int GatewayProtocol_BuildChannelPlanCommand(
+  uint8_t inTargetRocketId,
+  bool inOwnChannel,
+  uint8_t * outPacket,
+  int inMaxLen) ;
+
 //----------------------------------------------
 // Function: GatewayProtocol_ParseFlashParams
 // Purpose: Parse slot and sample offset from JSON command
@@ -389,6 +743,25 @@ int GatewayProtocol_BuildFlashReadCommand(
   uint8_t * outPacket,
   int inMaxLen) ;
 
+//----------------------------------------------
+// Function: GatewayProtocol_BuildFlashBulkReadCommand
+// Purpose: Build LoRa command for flash_bulk
+// Parameters:
+//   inSlot - Flight slot (0-6)
+//   inSession - Session number echoed in every chunk
+//   inRate - Data rate for the transfer
+//   outPacket - Buffer for packet data
+//   inMaxLen - Maximum packet length
+// Returns: Packet length
+//----------------------------------------------
+int GatewayProtocol_BuildFlashBulkReadCommand(
+  uint8_t inTargetRocketId,
+  uint8_t inSlot,
+  uint8_t inSession,
+  uint8_t inRate,
+  uint8_t * outPacket,
+  int inMaxLen) ;
+
 //----------------------------------------------
 // Function: GatewayProtocol_BuildFlashDeleteCommand
 // Purpose: Build LoRa command for flash_delete
@@ -410,6 +783,7 @@ int GatewayProtocol_BuildFlashDeleteCommand(
 // Parameters:
 //   inPacket - Binary packet data
 //   inLen - Packet length
+//   inCommandId - Host command ID answered (0: none)
 //   outJson - Buffer for JSON string
 //   inMaxLen - Maximum JSON length
 // Returns: Length of JSON string
@@ -417,6 +791,7 @@ int GatewayProtocol_BuildFlashDeleteCommand(
 int GatewayProtocol_FlashListToJson(
   const uint8_t * inPacket,
   int inLen,
+  uint32_t inCommandId,
   char * outJson,
   int inMaxLen) ;
 
@@ -426,6 +801,7 @@ int GatewayProtocol_FlashListToJson(
 // Parameters:
 //   inPacket - Binary packet data
 //   inLen - Packet length
+//   inCommandId - Host command ID answered (0: none)
 //   outJson - Buffer for JSON string
 //   inMaxLen - Maximum JSON length
 // Returns: Length of JSON string
@@ -433,6 +809,7 @@ int GatewayProtocol_FlashListToJson(
 int GatewayProtocol_FlashDataToJson(
   const uint8_t * inPacket,
   int inLen,
+  uint32_t inCommandId,
   char * outJson,
   int inMaxLen) ;
 
@@ -0,0 +1,150 @@
+//----------------------------------------------
+// Module: json_writer.h
+// Description: JSON message builder over a
+//   caller's buffer
+// Author: Mark Gavin
+// Created: 2026-02-16
+// Copyright: (c) 2025-2026 by Mark Gavin
+// License: Proprietary - All Rights Reserved
+//
+// Builds the gateway's JSON lines without printf
+// and without allocating. Numbers are written
+// from integers: packet fields are already scaled
+// (centimeters, microdegrees, tenths), so
+// JsonWriter_Fixed places the decimal point
+// instead of dividing into a float that snprintf
+// then formats in soft float. JsonWriter_Float is
+// for the few values that are computed as floats;
+// it rounds once and writes the result the same
+// way.
+//
+// Commas are placed by the writer. Keys are
+// written as given (they are literals); string
+// values are escaped.
+//
+// Usage:
+//   JsonWriter theWriter ;
+//   JsonWriter_Init(&theWriter, outJson, inMaxLen) ;
+//   JsonWriter_BeginObject(&theWriter, NULL) ;
+//   JsonWriter_String(&theWriter, "type", "event") ;
+//   JsonWriter_Fixed(&theWriter, "alt", theAltitudeDm, 1) ;
+//   JsonWriter_EndObject(&theWriter) ;
+//   return JsonWriter_Finish(&theWriter) ;
+//----------------------------------------------
+
+#pragma once
+
+#include <stdint.h>
+#include <stdbool.h>
+
+//----------------------------------------------
+// Writer State
+//----------------------------------------------
+typedef struct
+{
+  char * pBuffer ;
+  int pMaxLen ;
+  int pLen ;
+  bool pFirst ;                   // Nothing yet in the open object or array
+  bool pOverflow ;                // Something did not fit; Finish returns 0
+} JsonWriter ;
+
+//----------------------------------------------
+// Function: JsonWriter_Init
+// Purpose: Start a message in a buffer
+// Parameters:
+//   outWriter - Writer to initialize
+//   outBuffer - Buffer for the message
+//   inMaxLen - Buffer size
+//----------------------------------------------
+void JsonWriter_Init(JsonWriter * outWriter, char * outBuffer, int inMaxLen) ;
+
+//----------------------------------------------
+// Function: JsonWriter_BeginObject
+// Purpose: Open an object
+// Parameters:
+//   ioWriter - Writer
+//   inKey - Its key, or NULL at the top level and
+//     in arrays
+//----------------------------------------------
+void JsonWriter_BeginObject(JsonWriter * ioWriter, const char * inKey) ;
+
+//----------------------------------------------
+// Function: JsonWriter_EndObject
+//----------------------------------------------
+void JsonWriter_EndObject(JsonWriter * ioWriter) ;
+
+//----------------------------------------------
+// Function: JsonWriter_BeginArray
+// Purpose: Open an array
+// Parameters:
+//   ioWriter - Writer
+//   inKey - Its key, or NULL in arrays
+//----------------------------------------------
+void JsonWriter_BeginArray(JsonWriter * ioWriter, const char * inKey) ;
+
+//----------------------------------------------
+// Function: JsonWriter_EndArray
+//----------------------------------------------
+void JsonWriter_EndArray(JsonWriter * ioWriter) ;
+
+//----------------------------------------------
+// Values
+// Each takes the key, or NULL for an array
+// element.
+//----------------------------------------------
+void JsonWriter_String(JsonWriter * ioWriter, const char * inKey, const char * inValue) ;
+void JsonWriter_Bool(JsonWriter * ioWriter, const char * inKey, bool inValue) ;
+void JsonWriter_Int(JsonWriter * ioWriter, const char * inKey, int32_t inValue) ;
+void JsonWriter_Uint(JsonWriter * ioWriter, const char * inKey, uint32_t inValue) ;
+
+//----------------------------------------------
+// Function: JsonWriter_Fixed
+// Purpose: Write a scaled integer as a decimal
+// Parameters:
+//   ioWriter - Writer
+//   inKey - Key, or NULL
+//   inValue - Value times 10^inDecimals
+//   inDecimals - Digits after the point (0-9)
+// Notes: JsonWriter_Fixed(w, "alt", 12345, 2)
+//   writes "alt":123.45
+//----------------------------------------------
+void JsonWriter_Fixed(JsonWriter * ioWriter, const char * inKey, int32_t inValue, uint8_t inDecimals) ;
+
+//----------------------------------------------
+// Function: JsonWriter_Float
+// Purpose: Write a float to a fixed number of
+//   decimals
+// Parameters:
+//   ioWriter - Writer
+//   inKey - Key, or NULL
+//   inValue - Value
+//   inDecimals - Digits after the point (0-9)
+// Notes: Rounds half away from zero. Values whose
+//   scaled form is past the int32 range are
+//   clamped to it.
+//----------------------------------------------
+void JsonWriter_Float(JsonWriter * ioWriter, const char * inKey, float inValue, uint8_t inDecimals) ;
+
+//----------------------------------------------
+// Function: JsonWriter_Hex
+// Purpose: Write bytes as a string of upper-case
+//   hex pairs
+// Parameters:
+//   ioWriter - Writer
+//   inKey - Key, or NULL
+//   inData - Bytes
+//   inLen - Their number
+//----------------------------------------------
+void JsonWriter_Hex(JsonWriter * ioWriter, const char * inKey, const uint8_t * inData, int inLen) ;
+
+//----------------------------------------------
+// Function: JsonWriter_Finish
+// Purpose: End the message with a newline
+// Parameters:
+//   ioWriter - Writer
+// Returns: Message length with the newline, 0 if
+//   it did not fit
+// Notes: The buffer is always NUL-terminated
+//----------------------------------------------
+int JsonWriter_Finish(JsonWriter * ioWriter) ;
@@ -46,7 +46,10 @@
 #define kPinSpiMosi         15  // GP15 - SPI1 TX/MOSI
 #define kPinSpiMiso         8   // GP8 - SPI1 RX/MISO
 #define kSpiPort            spi1
-#define kSpiLoRaBaudrate    1000000   // 1 MHz for LoRa
+// 8 MHz leaves margin under the RFM95 limit with the
+// TFT and WiFi also on SPI1. LoRa_Init checks it with a
+// FIFO loopback at boot.
+#define kSpiLoRaBaudrate    8000000   // 8 MHz for LoRa (RFM95 max 10 MHz)
 
 //----------------------------------------------
 // LoRa Radio (RFM95 built into Feather RP2040 RFM95)
@@ -86,6 +89,31 @@
 #define kLoRaPreambleLen    8           // Preamble length
 #define kLoRaTxPower        20          // 20 dBm (100 mW)
 #define kLoRaSyncWord       0x14        // Private sync word (must match!)
+#define kLoRaListenBeforeTalk 1         // Check for a clear channel before sending
+
+//----------------------------------------------
+// TDMA Multi-Rocket Schedule (tdma_scheduler.h)
+// Set kEnableTdma to 0 to leave flight computers
+// free-running with an ACK per packet
+//----------------------------------------------
+#define kEnableTdma         1   // Send beacons from boot
+#define kTdmaSlotMs         130 // Fits a 55-byte packet (108 ms at SF7/125 kHz)
+#define kTdmaDownlinkMs     150 // Commands and ACKs after each beacon
+
+//----------------------------------------------
+// Telemetry ACKs (ack_summary.h)
+// One summary per interval covers every rocket
+// heard; 0 sends an ACK after every frame
+//----------------------------------------------
+#define kAckIntervalMs      1000
+
+//----------------------------------------------
+// Channel Plan (channel_plan.h)
+// Set kEnableChannelPlan to 0 to stay on the
+// control channel; rockets must then have the
+// plan off to be heard
+//----------------------------------------------
+#define kEnableChannelPlan  1   // Follow rockets onto their uplink channels
 
 //----------------------------------------------
 // GPS (Adafruit Ultimate GPS FeatherWing - PA1616D)
@@ -138,7 +166,12 @@
 // Protocol Constants
 //----------------------------------------------
 #define kJsonBufferSize     512
-#define kLoRaPacketMaxSize  64
+#define kJsonBatchBufferSize 1024   // Telemetry batch (up to ~30 samples)
+#define kJsonTdmaBufferSize 1280    // TDMA statistics (16 rockets)
+#define kJsonRateBufferSize 1280    // Data rate statistics (6 rates)
+#define kJsonChannelBufferSize 1280 // Channel plan (8 channels, 16 rockets)
+#define kJsonCommandBufferSize 5632 // Command queue statistics (16 rockets)
+#define kLoRaPacketMaxSize  255     // Largest frame: bulk flash chunk (250)
 
 //----------------------------------------------
 // Display Constants (SSD1306/SH1107 128x64)
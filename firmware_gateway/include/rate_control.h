@@ -0,0 +1,302 @@
+//----------------------------------------------
+// Module: rate_control.h
+// Description: Adaptive LoRa data rate (gateway
+//   side: margin estimate, handshake, fallback)
+// Author: Mark Gavin
+// Created: 2026-02-14
+// Copyright: (c) 2025-2026 by Mark Gavin
+// License: Proprietary - All Rights Reserved
+//
+// Command and confirm layouts are in the flight
+// firmware's link_rate.h. The gateway listens at
+// one rate, so every rocket is moved together:
+//
+//   1. The SNR of each rocket's last frames gives
+//      its margin over the demodulation floor of
+//      each rate in the lora_radio.h table. The
+//      worst rocket decides.
+//   2. A proposal goes to all rockets. Once every
+//      active rocket has confirmed, a commit
+//      follows and the gateway switches when it
+//      is off the air. A refusal, or no confirm
+//      after kRateMaxProposals tries, drops the
+//      change.
+//   3. A rocket silent for kRateMaxMisses of its
+//      usual frame spacings returns the gateway
+//      to kLoRaDataRateBase without a handshake;
+//      the rocket falls back on its own.
+//   4. Away from the base rate the commit is
+//      repeated at the base rate every
+//      kRateAnnounceMs for rockets left there.
+//
+// Slowing down is immediate, by as many steps as
+// the margin needs. Speeding up is one step at a
+// time after kRateHoldMs at a rate.
+//
+// For link-budget tests an extra path loss can
+// be simulated: received SNR and RSSI are cut by
+// it, and frames that would then fall below the
+// floor of the rate in use are dropped as lost.
+// Throughput and loss are kept per rate.
+//----------------------------------------------
+
+#pragma once
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "lora_protocol.h"
+#include "lora_radio.h"
+
+//----------------------------------------------
+// Constants
+//----------------------------------------------
+#define kRateMaxRockets         16
+#define kRateSnrWindow          8       // Frames in each rocket's SNR average
+#define kRateDownSamples        3       // Frames needed before slowing down
+#define kRateMarginUpDb         10      // Margin needed at a faster rate
+#define kRateMarginDownDb       3       // Below this at the current rate: slow down
+#define kRateHoldMs             10000   // At a rate before stepping up
+#define kRateFallbackHoldMs     60000   // After a fallback or a dropped change
+#define kRateMaxMisses          8       // Frame spacings silent: back to base
+#define kRateMinIntervalMs      50
+#define kRateMaxIntervalMs      5000    // Also the spacing assumed until measured
+#define kRateActiveMs           30000   // Silent longer: the rocket has left
+#define kRateConfirmWaitMs      1500    // Proposal to confirms, without TDMA
+#define kRateMaxProposals       3
+#define kRateAnnounceMs         10000
+#define kRateMaxAttenDb         60
+#define kRateStatsIntervalMs    10000
+
+//----------------------------------------------
+// Handshake Phase
+//----------------------------------------------
+typedef enum
+{
+  kRatePhaseIdle = 0 ,
+  kRatePhaseProposing
+} RatePhase ;
+
+//----------------------------------------------
+// Per-Rocket Record
+//----------------------------------------------
+typedef struct
+{
+  bool pActive ;                  // Heard in the last kRateActiveMs
+  uint32_t pLastHeardMs ;
+  uint32_t pIntervalMs ;          // Smoothed frame spacing (0 until measured)
+  bool pSequenceValid ;
+  uint8_t pLastSequence ;
+  int8_t pSnr[kRateSnrWindow] ;   // At the rate in use
+  uint8_t pSnrCount ;
+  uint8_t pSnrNext ;
+  bool pConfirmed ;               // Confirmed the open proposal
+  int8_t pDownlinkSnr ;           // Reported in the last confirm
+} RateRocket ;
+
+//----------------------------------------------
+// Per-Rate Statistics
+//----------------------------------------------
+typedef struct
+{
+  uint32_t pMs ;                  // Time at this rate
+  uint32_t pFrames ;              // Telemetry frames received
+  uint32_t pLost ;                // Sequence gaps
+  uint32_t pDropped ;             // Of those, below the simulated budget
+  uint32_t pBytes ;               // On-air bytes of the frames received
+} RateStats ;
+
+//----------------------------------------------
+// Controller State
+//----------------------------------------------
+typedef struct
+{
+  bool pAuto ;                    // Follow the link margin
+  uint8_t pManualRate ;           // Rate held when not automatic
+  uint8_t pRate ;                 // Rate in use (radio follows)
+  uint8_t pTarget ;               // Rate being proposed
+  RatePhase pPhase ;
+  uint8_t pToken ;
+  uint8_t pProposals ;            // Sent for the open change
+  uint32_t pProposeMs ;           // Last proposal sent
+  uint32_t pNextChangeMs ;        // No new proposal before this
+  uint32_t pRateSinceMs ;
+  uint32_t pAnnounceMs ;
+  int8_t pAttenDb ;               // Simulated extra path loss
+
+  // Statistics
+  uint32_t pSwitches ;
+  uint32_t pFallbacks ;
+  uint32_t pAborted ;             // Changes dropped in the handshake
+  uint32_t pStatsStartMs ;
+  uint32_t pLastStatsMs ;
+  uint32_t pAccountedMs ;         // Time counted into pStats so far
+  RateRocket pRockets[kRateMaxRockets] ;
+  RateStats pStats[kLoRaDataRateCount] ;
+} RateControl ;
+
+//----------------------------------------------
+// Function: RateControl_Init
+// Purpose: Start at the base rate, adapting
+// Parameters:
+//   outControl - Controller to initialize
+//   inNowMs - Current time (ms since boot)
+//----------------------------------------------
+void RateControl_Init(RateControl * outControl, uint32_t inNowMs) ;
+
+//----------------------------------------------
+// Function: RateControl_Configure
+// Purpose: Change the mode at run time
+// Parameters:
+//   ioControl - Controller
+//   inAuto - Follow the link margin
+//   inRate - Rate to move to and hold (-1: none;
+//     turns automatic mode off)
+//   inAttenDb - Simulated path loss (-1: keep)
+//   inReset - Clear the statistics
+//   inNowMs - Current time (ms since boot)
+// Returns: false if a value is out of range
+//   (nothing is changed)
+//----------------------------------------------
+bool RateControl_Configure(
+  RateControl * ioControl,
+  bool inAuto,
+  int inRate,
+  int inAttenDb,
+  bool inReset,
+  uint32_t inNowMs) ;
+
+//----------------------------------------------
+// Function: RateControl_ApplyLinkBudget
+// Purpose: Apply the simulated path loss to a
+//   received packet
+// Parameters:
+//   ioControl - Controller
+//   ioRssi - Packet RSSI, reduced in place
+//   ioSnr - Packet SNR, reduced in place
+// Returns: false if the packet would not have
+//   been received (drop it)
+//----------------------------------------------
+bool RateControl_ApplyLinkBudget(
+  RateControl * ioControl,
+  int16_t * ioRssi,
+  int8_t * ioSnr) ;
+
+//----------------------------------------------
+// Function: RateControl_RecordFrame
+// Purpose: Count a telemetry frame and add its
+//   SNR to the sender's margin estimate
+// Parameters:
+//   ioControl - Controller
+//   inRocketId - Sender
+//   inSequence - Low byte of its sequence number
+//   inLen - On-air length in bytes
+//   inSnr - Received SNR
+//   inNowMs - Current time (ms since boot)
+//----------------------------------------------
+void RateControl_RecordFrame(
+  RateControl * ioControl,
+  uint8_t inRocketId,
+  uint8_t inSequence,
+  uint8_t inLen,
+  int8_t inSnr,
+  uint32_t inNowMs) ;
+
+//----------------------------------------------
+// Function: RateControl_ProcessConfirm
+// Purpose: Take a rocket's answer to a proposal
+// Parameters:
+//   ioControl - Controller
+//   inPacket - Received packet (magic, type, ...)
+//   inLen - Packet length
+//   inNowMs - Current time (ms since boot)
+// Returns: false if malformed
+//----------------------------------------------
+bool RateControl_ProcessConfirm(
+  RateControl * ioControl,
+  const uint8_t * inPacket,
+  int inLen,
+  uint32_t inNowMs) ;
+
+//----------------------------------------------
+// Function: RateControl_CheckSilence
+// Purpose: Retire rockets that have left and
+//   fall back if one has gone quiet
+// Parameters:
+//   ioControl - Controller
+//   inNowMs - Current time (ms since boot)
+//   inPaused - Rockets are busy elsewhere (bulk
+//     download): silence is not a miss
+// Returns: true if the rate fell back
+//----------------------------------------------
+bool RateControl_CheckSilence(RateControl * ioControl, uint32_t inNowMs, bool inPaused) ;
+
+//----------------------------------------------
+// Function: RateControl_NextCommand
+// Purpose: Build the next kCmdDataRate to send,
+//   if any
+// Parameters:
+//   ioControl - Controller
+//   inNowMs - Current time (ms since boot)
+//   inConfirmWaitMs - Proposal to confirms (one
+//     superframe under TDMA)
+//   outPacket - Output buffer
+//   inMaxLen - Buffer size (kRateCommandLen)
+//   outAnnounce - Send it at kLoRaDataRateBase,
+//     then return to the rate in use
+// Returns: Packet length, 0 if nothing to send
+// Notes: Call only when the packet can go out at
+//   once. A commit moves pRate to the new rate;
+//   switch the radio after it has been sent.
+//----------------------------------------------
+int RateControl_NextCommand(
+  RateControl * ioControl,
+  uint32_t inNowMs,
+  uint32_t inConfirmWaitMs,
+  uint8_t * outPacket,
+  int inMaxLen,
+  bool * outAnnounce) ;
+
+//----------------------------------------------
+// Function: RateControl_GetBulkRate
+// Purpose: Pick the data rate for a bulk download
+// Parameters:
+//   inControl - Controller
+//   inRocketId - Rocket asked (0xFF: any)
+// Returns: The fastest rate the rocket's margin
+//   allows (kRateMarginUpDb), never slower than
+//   the rate in use. The rate in use when another
+//   rocket is active (it would go unheard), when
+//   not automatic, during a handshake, or before
+//   a full SNR window.
+//----------------------------------------------
+uint8_t RateControl_GetBulkRate(const RateControl * inControl, uint8_t inRocketId) ;
+
+//----------------------------------------------
+// Function: RateControl_IsStatsDue
+// Purpose: Check for the periodic report
+// Parameters:
+//   inControl - Controller
+//   inNowMs - Current time (ms since boot)
+// Returns: true if a rocket is active and the
+//   report interval has passed
+//----------------------------------------------
+bool RateControl_IsStatsDue(const RateControl * inControl, uint32_t inNowMs) ;
+
+//----------------------------------------------
+// Function: RateControl_StatsToJson
+// Purpose: Report the rate and per-rate figures
+// Parameters:
+//   ioControl - Controller
+//   inEvent - "stats", "switch", "fallback" or
+//     "aborted"
+//   inNowMs - Current time (ms since boot)
+//   outJson - Output buffer
+//   inMaxLen - Buffer size (kJsonRateBufferSize)
+// Returns: JSON length, 0 on error
+//----------------------------------------------
+int RateControl_StatsToJson(
+  RateControl * ioControl,
+  const char * inEvent,
+  uint32_t inNowMs,
+  char * outJson,
+  int inMaxLen) ;
@@ -0,0 +1,245 @@
+//----------------------------------------------
+// Module: tdma_scheduler.h
+// Description: TDMA beacon and slot scheduler for
+//   multi-rocket operation
+// Author: Mark Gavin
+// Created: 2026-02-12
+// Modified: 2026-02-15 (slot owner lookup for the channel plan)
+// Copyright: (c) 2025-2026 by Mark Gavin
+// License: Proprietary - All Rights Reserved
+//
+// Every superframe opens with a beacon (layout
+// in the flight firmware's tdma.h). Times run
+// from the end of the beacon:
+//
+//   beacon | downlink | slot 0 .. slot 15 | contention | beacon
+//
+// Gateway transmissions are held to the beacon
+// and the downlink window that follows it. The
+// 16 data slots are dealt round-robin to the
+// rockets heard in the last kTdmaJoinTimeoutMs,
+// so one rocket gets all 16 and sixteen get one
+// each. A rocket not yet in the table joins by
+// being heard in the contention slot.
+//
+// Rockets sending in their own slots get no ACK
+// per packet: the heard mask in the next beacon
+// replaces it. Frames from anywhere else (free-
+// running flight computers, contention) are
+// still ACKed.
+//
+// Delivered-rate statistics are kept per rocket
+// whether or not the schedule is enabled, so the
+// two can be compared.
+//----------------------------------------------
+
+#pragma once
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "lora_protocol.h"
+
+//----------------------------------------------
+// Constants
+//----------------------------------------------
+#define kTdmaMaxRockets         16
+#define kTdmaSlotCount          kTdmaMaxSlots   // Every beacon lists them all
+#define kTdmaBeaconLen          (kTdmaBeaconHeaderLen + kTdmaSlotCount)
+#define kTdmaMinSlotMs          20
+#define kTdmaMaxSlotMs          1000
+#define kTdmaTailGuardMs        2     // After the contention slot
+#define kTdmaJoinTimeoutMs      10000 // Silent rocket gives up its slots
+#define kTdmaStatsIntervalMs    5000
+
+//----------------------------------------------
+// Per-Rocket Record
+//----------------------------------------------
+typedef struct
+{
+  bool pJoined ;                  // Heard recently; gets slots
+  uint32_t pLastHeardMs ;
+  bool pSequenceValid ;
+  uint8_t pLastSequence ;         // Low byte of the telemetry sequence
+  uint8_t pSlots ;                // Slots in the current superframe
+  int16_t pLastRssi ;
+  int8_t pLastSnr ;
+
+  // Totals
+  uint32_t pFrames ;              // Telemetry frames received
+  uint32_t pLost ;                // Sequence gaps
+  uint32_t pOutOfSlot ;           // Received outside the rocket's slots
+
+  // Since the last statistics report
+  uint32_t pIntervalFrames ;
+  uint32_t pIntervalLost ;
+} TdmaRocket ;
+
+//----------------------------------------------
+// Scheduler State
+//----------------------------------------------
+typedef struct
+{
+  bool pEnabled ;
+  bool pStarted ;                 // First beacon sent
+  uint16_t pSlotMs ;
+  uint16_t pDownlinkMs ;
+  uint16_t pSuperframeMs ;        // Beacon end to next beacon end
+  uint8_t pBeaconSeq ;
+  uint32_t pBeaconsSent ;
+  uint32_t pNextBeaconUs ;        // time_us_32
+  uint32_t pAnchorUs ;            // End of the current beacon
+  uint32_t pDownlinkEndUs ;       // End of the current downlink window
+  uint8_t pSlots[kTdmaSlotCount] ;
+  uint8_t pNextRocket ;           // Round-robin start for the next table
+  uint16_t pHeardMask ;           // Rockets heard this superframe
+  uint32_t pStatsStartMs ;
+  TdmaRocket pRockets[kTdmaMaxRockets] ;
+} TdmaScheduler ;
+
+//----------------------------------------------
+// Function: TdmaScheduler_Init
+// Purpose: Initialize the scheduler
+// Parameters:
+//   outScheduler - Scheduler to initialize
+//   inEnabled - Send beacons
+//   inSlotMs - Data slot length
+//   inDownlinkMs - Downlink window after a beacon
+//----------------------------------------------
+void TdmaScheduler_Init(
+  TdmaScheduler * outScheduler,
+  bool inEnabled,
+  uint16_t inSlotMs,
+  uint16_t inDownlinkMs) ;
+
+//----------------------------------------------
+// Function: TdmaScheduler_Configure
+// Purpose: Change the schedule at run time
+// Parameters:
+//   ioScheduler - Scheduler
+//   inEnabled - Send beacons
+//   inSlotMs - Data slot length (0 keeps the
+//     current length)
+// Returns: false if the slot length is out of
+//   range (nothing is changed)
+// Notes: Takes effect with the next beacon
+//----------------------------------------------
+bool TdmaScheduler_Configure(
+  TdmaScheduler * ioScheduler,
+  bool inEnabled,
+  uint16_t inSlotMs) ;
+
+//----------------------------------------------
+// Function: TdmaScheduler_SetTiming
+// Purpose: Change slot and downlink lengths for
+//   a new data rate
+// Parameters:
+//   ioScheduler - Scheduler
+//   inSlotMs - Data slot length (kTdmaMinSlotMs
+//     to kTdmaMaxSlotMs)
+//   inDownlinkMs - Downlink window after a beacon
+// Notes: When enabled, a fresh superframe starts
+//   at once so rockets get the new timing
+//----------------------------------------------
+void TdmaScheduler_SetTiming(
+  TdmaScheduler * ioScheduler,
+  uint16_t inSlotMs,
+  uint16_t inDownlinkMs) ;
+
+//----------------------------------------------
+// Function: TdmaScheduler_IsBeaconDue
+// Purpose: Check whether the next superframe
+//   should start
+// Parameters:
+//   inScheduler - Scheduler
+//   inNowUs - Current time (time_us_32)
+// Returns: true if enabled and the previous
+//   superframe has ended
+//----------------------------------------------
+bool TdmaScheduler_IsBeaconDue(const TdmaScheduler * inScheduler, uint32_t inNowUs) ;
+
+//----------------------------------------------
+// Function: TdmaScheduler_BuildBeacon
+// Purpose: Start a superframe: drop silent
+//   rockets, deal the slots and build the beacon
+// Parameters:
+//   ioScheduler - Scheduler
+//   inNowUs - Beacon start (time_us_32)
+//   inNowMs - Current time (ms since boot)
+//   inBeaconAirUs - Time on air of the beacon
+//   outPacket - Output buffer
+//   inMaxLen - Buffer size (kTdmaBeaconLen)
+// Returns: Beacon length, 0 on error
+// Notes: Sets pAnchorUs and pDownlinkEndUs; the
+//   beacon must be queued at once
+//----------------------------------------------
+int TdmaScheduler_BuildBeacon(
+  TdmaScheduler * ioScheduler,
+  uint32_t inNowUs,
+  uint32_t inNowMs,
+  uint32_t inBeaconAirUs,
+  uint8_t * outPacket,
+  int inMaxLen) ;
+
+//----------------------------------------------
+// Function: TdmaScheduler_RecordFrame
+// Purpose: Count a telemetry frame and decide
+//   whether it needs an ACK
+// Parameters:
+//   ioScheduler - Scheduler
+//   inRocketId - Sender (0-15)
+//   inSequence - Low byte of its sequence number
+//   inRxUs - RxDone time (time_us_32)
+//   inNowMs - Current time (ms since boot)
+//   inRssi - Packet RSSI (dBm)
+//   inSnr - Packet SNR (dB)
+// Returns: true if the frame arrived in one of
+//   the sender's slots (no ACK needed)
+//----------------------------------------------
+bool TdmaScheduler_RecordFrame(
+  TdmaScheduler * ioScheduler,
+  uint8_t inRocketId,
+  uint8_t inSequence,
+  uint32_t inRxUs,
+  uint32_t inNowMs,
+  int16_t inRssi,
+  int8_t inSnr) ;
+
+//----------------------------------------------
+// Function: TdmaScheduler_GetSlotOwner
+// Purpose: Find whose data slot is in progress
+// Parameters:
+//   inScheduler - Scheduler
+//   inNowUs - Current time (time_us_32)
+// Returns: Rocket ID, kTdmaSlotFree in the
+//   downlink window, a free slot, or with TDMA
+//   off
+//----------------------------------------------
+uint8_t TdmaScheduler_GetSlotOwner(const TdmaScheduler * inScheduler, uint32_t inNowUs) ;
+
+//----------------------------------------------
+// Function: TdmaScheduler_IsStatsDue
+// Purpose: Check for a periodic statistics report
+// Parameters:
+//   inScheduler - Scheduler
+//   inNowMs - Current time (ms since boot)
+// Returns: true every kTdmaStatsIntervalMs while
+//   any rocket is being heard
+//----------------------------------------------
+bool TdmaScheduler_IsStatsDue(const TdmaScheduler * inScheduler, uint32_t inNowMs) ;
+
+//----------------------------------------------
+// Function: TdmaScheduler_StatsToJson
+// Purpose: Report delivered rate per rocket and
+//   start a new interval
+// Parameters:
+//   ioScheduler - Scheduler
+//   inNowMs - Current time (ms since boot)
+//   outJson - Output buffer
+//   inMaxLen - Buffer size (kJsonTdmaBufferSize)
+// Returns: JSON length, 0 on error
+//----------------------------------------------
+int TdmaScheduler_StatsToJson(
+  TdmaScheduler * ioScheduler,
+  uint32_t inNowMs,
+  char * outJson,
+  int inMaxLen) ;
@@ -0,0 +1,275 @@
+//----------------------------------------------
+// Module: ack_summary.c
+// Description: Aggregated telemetry ACKs (one
+//   summary per interval for every rocket heard)
+// Author: Mark Gavin
+// Created: 2026-02-14
+// Copyright: (c) 2025-2026 by Mark Gavin
+// License: Proprietary - All Rights Reserved
+// Modified: 2026-02-15 (flight event ACKs)
+// Modified: 2026-02-16 (JSON writer)
+//----------------------------------------------
+
+#include "ack_summary.h"
+#include "gateway_protocol.h"
+#include "json_writer.h"
+
+#include <string.h>
+
+//----------------------------------------------
+// Function: AckSummary_Init
+//----------------------------------------------
+void AckSummary_Init(AckSummary * outSummary, uint16_t inIntervalMs)
+{
+  memset(outSummary, 0, sizeof(AckSummary)) ;
+  outSummary->pIntervalMs = inIntervalMs ;
+}
+
+//----------------------------------------------
+// Function: AckSummary_Configure
+//----------------------------------------------
+bool AckSummary_Configure(AckSummary * ioSummary, int inIntervalMs, bool inNow)
+{
+  if (inIntervalMs > kAckMaxIntervalMs ||
+      (inIntervalMs > 0 && inIntervalMs < kAckMinIntervalMs))
+  {
+    return false ;
+  }
+
+  if (inIntervalMs >= 0)
+  {
+    ioSummary->pIntervalMs = (uint16_t)inIntervalMs ;
+  }
+  ioSummary->pRequested = ioSummary->pRequested || inNow ;
+  return true ;
+}
+
+//----------------------------------------------
+// Function: AckSummary_RecordFrame
+//----------------------------------------------
+void AckSummary_RecordFrame(
+  AckSummary * ioSummary,
+  uint8_t inRocketId,
+  uint8_t inSequence,
+  int16_t inRssi,
+  int8_t inSnr)
+{
+  if (inRocketId >= kAckMaxRockets)
+  {
+    return ;
+  }
+
+  AckRocket * theRocket = &ioSummary->pRockets[inRocketId] ;
+  uint8_t theStep = (uint8_t)(inSequence - theRocket->pLastSequence) ;
+  uint8_t theBack = (uint8_t)(theRocket->pLastSequence - inSequence) ;
+
+  if (theRocket->pSequenceValid && theStep >= 1 && theStep < 128)
+  {
+    // Newer: the old latest moves into the bitmap
+    theRocket->pBitmap = theStep > 16 ? 0 :
+      (uint16_t)((theRocket->pBitmap << theStep) | (1u << (theStep - 1))) ;
+    theRocket->pLastSequence = inSequence ;
+  }
+  else if (theRocket->pSequenceValid && theBack >= 1 && theBack <= 16)
+  {
+    // A late frame fills its gap
+    theRocket->pBitmap |= (uint16_t)(1u << (theBack - 1)) ;
+  }
+  else if (!theRocket->pSequenceValid || theStep != 0)
+  {
+    // First frame, or a restart
+    theRocket->pSequenceValid = true ;
+    theRocket->pLastSequence = inSequence ;
+    theRocket->pBitmap = 0 ;
+  }
+
+  theRocket->pPending = true ;
+  if (theRocket->pFrames < UINT8_MAX)
+  {
+    theRocket->pFrames++ ;
+    theRocket->pRssiSum += inRssi ;
+    theRocket->pSnrSum += inSnr ;
+  }
+  ioSummary->pFrames++ ;
+}
+
+//----------------------------------------------
+// Function: AckSummary_RecordEvent
+//----------------------------------------------
+bool AckSummary_RecordEvent(AckSummary * ioSummary, uint8_t inRocketId, uint8_t inSequence)
+{
+  if (inRocketId >= kAckMaxRockets)
+  {
+    return false ;
+  }
+
+  // The rocket always sends its oldest event not
+  // yet ACKed, so a different sequence is new
+  AckRocket * theRocket = &ioSummary->pRockets[inRocketId] ;
+  bool theNew = !theRocket->pEventValid || theRocket->pEventSequence != inSequence ;
+  theRocket->pEventValid = true ;
+  theRocket->pEventSequence = inSequence ;
+  theRocket->pEventPending = true ;
+  ioSummary->pRequested = true ;
+
+  if (theNew)
+  {
+    ioSummary->pEvents++ ;
+  }
+  else
+  {
+    ioSummary->pEventRepeats++ ;
+  }
+  return theNew ;
+}
+
+//----------------------------------------------
+// Function: AckSummary_IsDue
+//----------------------------------------------
+bool AckSummary_IsDue(const AckSummary * inSummary, uint32_t inNowMs)
+{
+  if (inSummary->pRequested)
+  {
+    return true ;
+  }
+
+  if (inSummary->pIntervalMs == 0 ||
+      (inNowMs - inSummary->pLastSentMs) < inSummary->pIntervalMs)
+  {
+    return false ;
+  }
+
+  for (int i = 0 ; i < kAckMaxRockets ; i++)
+  {
+    if (inSummary->pRockets[i].pPending)
+    {
+      return true ;
+    }
+  }
+  return false ;
+}
+
+//----------------------------------------------
+// Function: AckSummary_Build
+//----------------------------------------------
+int AckSummary_Build(
+  AckSummary * ioSummary,
+  uint32_t inNowMs,
+  uint8_t * outPacket,
+  int inMaxLen)
+{
+  if (outPacket == NULL || inMaxLen < kAckSummaryHeaderLen) return 0 ;
+
+  outPacket[0] = kLoRaMagic ;
+  outPacket[1] = kLoRaPacketAckSummary ;
+  outPacket[2] = ioSummary->pSequence ;
+  outPacket[3] = (uint8_t)(ioSummary->pIntervalMs & 0xFF) ;
+  outPacket[4] = (uint8_t)(ioSummary->pIntervalMs >> 8) ;
+
+  // Round robin from where the last summary
+  // stopped, so no rocket is left out for long
+  int theLen = kAckSummaryHeaderLen ;
+  uint8_t theCount = 0 ;
+  uint8_t theNext = ioSummary->pNextRocket ;
+  for (int i = 0 ; i < kAckMaxRockets ; i++)
+  {
+    uint8_t theId = (uint8_t)((ioSummary->pNextRocket + i) % kAckMaxRockets) ;
+    AckRocket * theRocket = &ioSummary->pRockets[theId] ;
+    if (!theRocket->pPending)
+    {
+      continue ;
+    }
+    if (theCount >= kAckSummaryMaxEntries || theLen + kAckSummaryEntryLen > inMaxLen)
+    {
+      break ;
+    }
+
+    int16_t theRssi = (int16_t)(theRocket->pRssiSum / theRocket->pFrames) ;
+    uint8_t * theEntry = &outPacket[theLen] ;
+    theEntry[0] = theId ;
+    theEntry[1] = theRocket->pLastSequence ;
+    theEntry[2] = (uint8_t)(theRocket->pBitmap & 0xFF) ;
+    theEntry[3] = (uint8_t)(theRocket->pBitmap >> 8) ;
+    theEntry[4] = theRocket->pFrames ;
+    theEntry[5] = (uint8_t)(int8_t)(theRocket->pSnrSum / theRocket->pFrames) ;
+    theEntry[6] = (uint8_t)(theRssi & 0xFF) ;
+    theEntry[7] = (uint8_t)((theRssi >> 8) & 0xFF) ;
+    theLen += kAckSummaryEntryLen ;
+    theCount++ ;
+
+    theRocket->pPending = false ;
+    theRocket->pFrames = 0 ;
+    theRocket->pRssiSum = 0 ;
+    theRocket->pSnrSum = 0 ;
+    theNext = (uint8_t)((theId + 1) % kAckMaxRockets) ;
+  }
+
+  outPacket[5] = theCount ;
+
+  // Event ACKs, when any are owed and there is room
+  int theEventsAt = theLen ;
+  uint8_t theEvents = 0 ;
+  for (int i = 0 ; i < kAckMaxRockets && theEvents < kAckEventMaxEntries ; i++)
+  {
+    AckRocket * theRocket = &ioSummary->pRockets[i] ;
+    if (!theRocket->pEventPending)
+    {
+      continue ;
+    }
+    if (theEventsAt + 1 + (theEvents + 1) * kAckEventEntryLen > inMaxLen)
+    {
+      break ;
+    }
+
+    outPacket[theEventsAt + 1 + theEvents * kAckEventEntryLen] = (uint8_t)i ;
+    outPacket[theEventsAt + 2 + theEvents * kAckEventEntryLen] = theRocket->pEventSequence ;
+    theRocket->pEventPending = false ;
+    theEvents++ ;
+  }
+  if (theEvents > 0)
+  {
+    outPacket[theEventsAt] = theEvents ;
+    theLen = theEventsAt + 1 + theEvents * kAckEventEntryLen ;
+    ioSummary->pEventAcks += theEvents ;
+  }
+
+  ioSummary->pNextRocket = theNext ;
+  ioSummary->pSequence++ ;
+  ioSummary->pRequested = false ;
+  ioSummary->pLastSentMs = inNowMs ;
+  ioSummary->pSummaries++ ;
+  ioSummary->pEntries += theCount ;
+  return theLen ;
+}
+
+//----------------------------------------------
+// Function: AckSummary_StatsToJson
+//----------------------------------------------
+int AckSummary_StatsToJson(
+  const AckSummary * inSummary,
+  uint32_t inAckAirUs,
+  char * outJson,
+  int inMaxLen)
+{
+  if (outJson == NULL || inMaxLen <= 0) return 0 ;
+
+  // What one ACK per frame would have cost
+  uint64_t thePerFrameUs = (uint64_t)inSummary->pFrames * inAckAirUs ;
+
+  JsonWriter theWriter ;
+  JsonWriter_Init(&theWriter, outJson, inMaxLen) ;
+  JsonWriter_BeginObject(&theWriter, NULL) ;
+  JsonWriter_String(&theWriter, "type", "ack_stats") ;
+  JsonWriter_Uint(&theWriter, "interval_ms", inSummary->pIntervalMs) ;
+  JsonWriter_Uint(&theWriter, "frames", inSummary->pFrames) ;
+  JsonWriter_Uint(&theWriter, "summaries", inSummary->pSummaries) ;
+  JsonWriter_Uint(&theWriter, "entries", inSummary->pEntries) ;
+  JsonWriter_Uint(&theWriter, "air_ms", (uint32_t)(inSummary->pAirUs / 1000)) ;
+  JsonWriter_Uint(&theWriter, "per_frame_air_ms", (uint32_t)(thePerFrameUs / 1000)) ;
+  JsonWriter_Uint(&theWriter, "events", inSummary->pEvents) ;
+  JsonWriter_Uint(&theWriter, "event_repeats", inSummary->pEventRepeats) ;
+  JsonWriter_Uint(&theWriter, "event_acks", inSummary->pEventAcks) ;
+  JsonWriter_EndObject(&theWriter) ;
+
+  return JsonWriter_Finish(&theWriter) ;
+}
@@ -0,0 +1,406 @@
+//----------------------------------------------
+// Module: bench_receiver.c
+// Description: LoRa link benchmark (gateway side:
+//   receiver and results)
+// Author: Mark Gavin
+// Created: 2026-02-15
+// Copyright: (c) 2025-2026 by Mark Gavin
+// License: Proprietary - All Rights Reserved
+// Modified: 2026-02-16 (JSON writer)
+//----------------------------------------------
+
+#include "bench_receiver.h"
+#include "lora_protocol.h"
+#include "json_writer.h"
+
+#include <string.h>
+#include <math.h>
+
+//----------------------------------------------
+// Internal: Bandwidth in kHz (table rates only)
+//----------------------------------------------
+static uint16_t BandwidthKhz(LoRa_Bandwidth inBW)
+{
+  switch (inBW)
+  {
+    case LORA_BW_125: return 125 ;
+    case LORA_BW_250: return 250 ;
+    case LORA_BW_500: return 500 ;
+    default: return 0 ;
+  }
+}
+
+//----------------------------------------------
+// Internal: Standard deviation from a count, sum
+// and sum of squares
+//----------------------------------------------
+static float Spread(uint32_t inCount, int32_t inSum, uint32_t inSquares)
+{
+  if (inCount < 2)
+  {
+    return 0.0f ;
+  }
+
+  float theMean = (float)inSum / inCount ;
+  float theVariance = (float)inSquares / inCount - theMean * theMean ;
+  return theVariance > 0.0f ? sqrtf(theVariance) : 0.0f ;
+}
+
+//----------------------------------------------
+// Internal: Goodput, bits delivered per second of
+// airtime spent on the point
+//----------------------------------------------
+static uint32_t Goodput(const BenchPoint * inPoint, uint8_t inFrames)
+{
+  uint64_t theAirUs = (uint64_t)inFrames * inPoint->pAirUs ;
+  if (theAirUs == 0)
+  {
+    return 0 ;
+  }
+
+  return (uint32_t)((uint64_t)inPoint->pReceived * inPoint->pLen * 8 * 1000000 / theAirUs) ;
+}
+
+//----------------------------------------------
+// Function: BenchReceiver_Start
+//----------------------------------------------
+bool BenchReceiver_Start(
+  BenchReceiver * outBench,
+  const uint8_t * inParams,
+  uint8_t inRocketId,
+  uint32_t inNowMs)
+{
+  memset(outBench, 0, sizeof(*outBench)) ;
+
+  uint8_t theRates = inParams[1] & ((1 << kLoRaDataRateCount) - 1) ;
+  uint8_t theCodingRates = inParams[2] & 0x0F ;
+  uint8_t theFrames = inParams[3] ;
+  if (theRates == 0 || theCodingRates == 0 || theFrames == 0 || theFrames > kBenchMaxFrames)
+  {
+    return false ;
+  }
+
+  // Same expansion as LinkBench_Start
+  int8_t thePowers[kBenchMaxChoices] ;
+  uint8_t theLens[kBenchMaxChoices] ;
+  uint8_t thePowerCount = 0 ;
+  uint8_t theLenCount = 0 ;
+  for (int i = 0 ; i < kBenchMaxChoices ; i++)
+  {
+    int8_t thePower = (int8_t)inParams[4 + i] ;
+    uint8_t theLen = inParams[4 + kBenchMaxChoices + i] ;
+    if (thePower != 0)
+    {
+      if (thePower < 2 || thePower > 20)
+      {
+        return false ;
+      }
+      thePowers[thePowerCount++] = thePower ;
+    }
+    if (theLen != 0)
+    {
+      if (theLen < kBenchMinLen)
+      {
+        return false ;
+      }
+      theLens[theLenCount++] = theLen ;
+    }
+  }
+  if (thePowerCount == 0)
+  {
+    thePowers[thePowerCount++] = 0 ;
+  }
+  if (theLenCount == 0)
+  {
+    return false ;
+  }
+
+  uint32_t theElapsedMs = 0 ;
+  uint8_t theCount = 0 ;
+  for (uint8_t theRate = 0 ; theRate < kLoRaDataRateCount ; theRate++)
+  {
+    if ((theRates & (1 << theRate)) == 0) continue ;
+    for (uint8_t theCr = LORA_CR_4_5 ; theCr <= LORA_CR_4_8 ; theCr++)
+    {
+      if ((theCodingRates & (1 << (theCr - LORA_CR_4_5))) == 0) continue ;
+      for (uint8_t p = 0 ; p < thePowerCount ; p++)
+      {
+        for (uint8_t l = 0 ; l < theLenCount ; l++)
+        {
+          if (theCount >= kBenchMaxPoints)
+          {
+            return false ;
+          }
+
+          BenchPoint * thePoint = &outBench->pPoints[theCount++] ;
+          thePoint->pRate = theRate ;
+          thePoint->pCodingRate = theCr ;
+          thePoint->pPowerDbm = thePowers[p] ;
+          thePoint->pLen = theLens[l] ;
+          thePoint->pAirUs = LoRa_GetConfigTimeOnAirUs(theRate, (LoRa_CodingRate)theCr, theLens[l]) ;
+          thePoint->pStartMs = theElapsedMs ;
+          thePoint->pDurationMs = 2 * kBenchGuardMs +
+            (uint32_t)(((uint64_t)theFrames * (thePoint->pAirUs + kBenchFrameGapUs) + 999) / 1000) ;
+          theElapsedMs += thePoint->pDurationMs ;
+        }
+      }
+    }
+  }
+
+  if (kBenchStartMs + theElapsedMs > kBenchMaxMs)
+  {
+    return false ;
+  }
+
+  outBench->pActive = true ;
+  outBench->pRocketId = inRocketId ;
+  outBench->pSession = inParams[0] ;
+  outBench->pFrames = theFrames ;
+  outBench->pPointCount = theCount ;
+  outBench->pPoint = kBenchPointStart ;
+  outBench->pStartMs = inNowMs ;
+  return true ;
+}
+
+//----------------------------------------------
+// Function: BenchReceiver_SetAnchor
+//----------------------------------------------
+void BenchReceiver_SetAnchor(BenchReceiver * ioBench, uint32_t inNowUs)
+{
+  ioBench->pAnchorUs = inNowUs ;
+  ioBench->pAnchored = true ;
+}
+
+//----------------------------------------------
+// Function: BenchReceiver_GetPoint
+//----------------------------------------------
+uint8_t BenchReceiver_GetPoint(const BenchReceiver * inBench, uint32_t inNowUs)
+{
+  if (!inBench->pAnchored)
+  {
+    return kBenchPointStart ;
+  }
+
+  uint32_t theMs = (inNowUs - inBench->pAnchorUs) / 1000 ;
+  if (theMs < kBenchStartMs)
+  {
+    return kBenchPointStart ;
+  }
+
+  theMs -= kBenchStartMs ;
+  for (uint8_t i = 0 ; i < inBench->pPointCount ; i++)
+  {
+    const BenchPoint * thePoint = &inBench->pPoints[i] ;
+    if (theMs < thePoint->pStartMs + thePoint->pDurationMs)
+    {
+      return i ;
+    }
+  }
+
+  return kBenchPointDone ;
+}
+
+//----------------------------------------------
+// Function: BenchReceiver_EnterPoint
+//----------------------------------------------
+void BenchReceiver_EnterPoint(BenchReceiver * ioBench, uint8_t inPoint, uint32_t inCrcErrors)
+{
+  if (ioBench->pPoint < ioBench->pPointCount)
+  {
+    uint32_t theErrors = inCrcErrors - ioBench->pCrcErrorsBase ;
+    ioBench->pPoints[ioBench->pPoint].pCrcErrors = theErrors > 0xFFFF ? 0xFFFF : (uint16_t)theErrors ;
+  }
+
+  ioBench->pPoint = inPoint ;
+  ioBench->pCrcErrorsBase = inCrcErrors ;
+  memset(ioBench->pSeen, 0, sizeof(ioBench->pSeen)) ;
+}
+
+//----------------------------------------------
+// Function: BenchReceiver_ProcessFrame
+//----------------------------------------------
+BenchRxKind BenchReceiver_ProcessFrame(
+  BenchReceiver * ioBench,
+  const uint8_t * inPacket,
+  int inLen,
+  int16_t inRssi,
+  int8_t inSnr)
+{
+  if (!ioBench->pActive || inLen < kBenchMinLen ||
+      inPacket[2] != ioBench->pRocketId || inPacket[3] != ioBench->pSession ||
+      LoRaProtocol_Crc8(inPacket, inLen - 1) != inPacket[inLen - 1])
+  {
+    return kBenchRxNone ;
+  }
+
+  uint8_t thePointIndex = inPacket[4] ;
+  if (thePointIndex == kBenchPointAnswer)
+  {
+    if (inPacket[5] == 0)
+    {
+      return kBenchRxRefused ;
+    }
+    ioBench->pAccepted = true ;
+    return kBenchRxAccepted ;
+  }
+
+  // Frames count for the point the gateway is
+  // set for; one heard from another is late
+  uint8_t theFrame = inPacket[5] ;
+  if (thePointIndex != ioBench->pPoint || thePointIndex >= ioBench->pPointCount ||
+      theFrame >= ioBench->pFrames)
+  {
+    return kBenchRxNone ;
+  }
+
+  BenchPoint * thePoint = &ioBench->pPoints[thePointIndex] ;
+  if (inLen != thePoint->pLen)
+  {
+    return kBenchRxNone ;
+  }
+
+  uint32_t theBit = 1u << (theFrame % 32) ;
+  if (ioBench->pSeen[theFrame / 32] & theBit)
+  {
+    thePoint->pDuplicates++ ;
+    return kBenchRxFrame ;
+  }
+  ioBench->pSeen[theFrame / 32] |= theBit ;
+
+  if (thePoint->pReceived == 0)
+  {
+    thePoint->pRssiMin = inRssi ;
+    thePoint->pRssiMax = inRssi ;
+    thePoint->pSnrMin = inSnr ;
+    thePoint->pSnrMax = inSnr ;
+  }
+  if (inRssi < thePoint->pRssiMin) thePoint->pRssiMin = inRssi ;
+  if (inRssi > thePoint->pRssiMax) thePoint->pRssiMax = inRssi ;
+  if (inSnr < thePoint->pSnrMin) thePoint->pSnrMin = inSnr ;
+  if (inSnr > thePoint->pSnrMax) thePoint->pSnrMax = inSnr ;
+
+  thePoint->pReceived++ ;
+  thePoint->pRssiSum += inRssi ;
+  thePoint->pRssiSquares += (uint32_t)((int32_t)inRssi * inRssi) ;
+  thePoint->pSnrSum += inSnr ;
+  thePoint->pSnrSquares += (uint32_t)((int32_t)inSnr * inSnr) ;
+
+  return kBenchRxFrame ;
+}
+
+//----------------------------------------------
+// Function: BenchReceiver_PointToJson
+//----------------------------------------------
+int BenchReceiver_PointToJson(
+  const BenchReceiver * inBench,
+  uint8_t inPoint,
+  char * outJson,
+  int inMaxLen)
+{
+  if (outJson == NULL || inMaxLen <= 0 || inPoint >= inBench->pPointCount) return 0 ;
+
+  const BenchPoint * thePoint = &inBench->pPoints[inPoint] ;
+  const LoRa_DataRate * theRate = LoRa_GetDataRate(thePoint->pRate) ;
+  uint32_t theCount = thePoint->pReceived ;
+  uint32_t theRawBps = thePoint->pAirUs > 0 ?
+    (uint32_t)((uint64_t)thePoint->pLen * 8 * 1000000 / thePoint->pAirUs) : 0 ;
+
+  JsonWriter theWriter ;
+  JsonWriter_Init(&theWriter, outJson, inMaxLen) ;
+  JsonWriter_BeginObject(&theWriter, NULL) ;
+  JsonWriter_String(&theWriter, "type", "bench_point") ;
+  JsonWriter_Uint(&theWriter, "rocket_id", inBench->pRocketId) ;
+  JsonWriter_Uint(&theWriter, "session", inBench->pSession) ;
+  JsonWriter_Uint(&theWriter, "point", inPoint) ;
+  JsonWriter_Uint(&theWriter, "points", inBench->pPointCount) ;
+  JsonWriter_Uint(&theWriter, "rate", thePoint->pRate) ;
+  JsonWriter_Uint(&theWriter, "sf", theRate != NULL ? theRate->pSpreadFactor : 0) ;
+  JsonWriter_Uint(&theWriter, "bw_khz", theRate != NULL ? BandwidthKhz(theRate->pBandwidth) : 0) ;
+  JsonWriter_Uint(&theWriter, "cr", 4 + thePoint->pCodingRate) ;
+  JsonWriter_Int(&theWriter, "power_dbm", thePoint->pPowerDbm) ;
+  JsonWriter_Uint(&theWriter, "len", thePoint->pLen) ;
+  JsonWriter_Uint(&theWriter, "frames", inBench->pFrames) ;
+  JsonWriter_Uint(&theWriter, "received", theCount) ;
+  JsonWriter_Uint(&theWriter, "duplicates", thePoint->pDuplicates) ;
+  JsonWriter_Uint(&theWriter, "crc_errors", thePoint->pCrcErrors) ;
+  JsonWriter_Float(&theWriter, "delivery", (float)theCount / inBench->pFrames, 3) ;
+
+  if (theCount > 0)
+  {
+    JsonWriter_Int(&theWriter, "rssi_min", thePoint->pRssiMin) ;
+    JsonWriter_Float(&theWriter, "rssi_avg", (float)thePoint->pRssiSum / theCount, 1) ;
+    JsonWriter_Int(&theWriter, "rssi_max", thePoint->pRssiMax) ;
+    JsonWriter_Float(&theWriter, "rssi_sd", Spread(theCount, thePoint->pRssiSum, thePoint->pRssiSquares), 1) ;
+    JsonWriter_Int(&theWriter, "snr_min", thePoint->pSnrMin) ;
+    JsonWriter_Float(&theWriter, "snr_avg", (float)thePoint->pSnrSum / theCount, 1) ;
+    JsonWriter_Int(&theWriter, "snr_max", thePoint->pSnrMax) ;
+    JsonWriter_Float(&theWriter, "snr_sd", Spread(theCount, thePoint->pSnrSum, thePoint->pSnrSquares), 1) ;
+  }
+
+  JsonWriter_Uint(&theWriter, "airtime_us", thePoint->pAirUs) ;
+  JsonWriter_Uint(&theWriter, "raw_bps", theRawBps) ;
+  JsonWriter_Uint(&theWriter, "goodput_bps", Goodput(thePoint, inBench->pFrames)) ;
+  JsonWriter_EndObject(&theWriter) ;
+
+  return JsonWriter_Finish(&theWriter) ;
+}
+
+//----------------------------------------------
+// Function: BenchReceiver_StatusToJson
+//----------------------------------------------
+int BenchReceiver_StatusToJson(
+  const BenchReceiver * inBench,
+  const char * inStatus,
+  uint32_t inNowMs,
+  char * outJson,
+  int inMaxLen)
+{
+  if (outJson == NULL || inStatus == NULL || inMaxLen <= 0) return 0 ;
+
+  uint32_t theTotalMs = kBenchStartMs ;
+  for (uint8_t i = 0 ; i < inBench->pPointCount ; i++)
+  {
+    theTotalMs += inBench->pPoints[i].pDurationMs ;
+  }
+
+  JsonWriter theWriter ;
+  JsonWriter_Init(&theWriter, outJson, inMaxLen) ;
+  JsonWriter_BeginObject(&theWriter, NULL) ;
+  JsonWriter_String(&theWriter, "type", "benchmark") ;
+  JsonWriter_String(&theWriter, "status", inStatus) ;
+  JsonWriter_Uint(&theWriter, "rocket_id", inBench->pRocketId) ;
+  JsonWriter_Uint(&theWriter, "session", inBench->pSession) ;
+  JsonWriter_Uint(&theWriter, "points", inBench->pPointCount) ;
+  JsonWriter_Uint(&theWriter, "frames", inBench->pFrames) ;
+  JsonWriter_Uint(&theWriter, "duration_ms", theTotalMs) ;
+
+  if (strcmp(inStatus, "done") == 0)
+  {
+    uint32_t theSent = (uint32_t)inBench->pPointCount * inBench->pFrames ;
+    uint32_t theReceived = 0 ;
+    uint32_t theBestGoodput = 0 ;
+    int theBest = -1 ;
+    for (uint8_t i = 0 ; i < inBench->pPointCount ; i++)
+    {
+      const BenchPoint * thePoint = &inBench->pPoints[i] ;
+      uint32_t theGoodput = Goodput(thePoint, inBench->pFrames) ;
+      theReceived += thePoint->pReceived ;
+      if (theGoodput > theBestGoodput)
+      {
+        theBestGoodput = theGoodput ;
+        theBest = i ;
+      }
+    }
+
+    JsonWriter_Uint(&theWriter, "sent", theSent) ;
+    JsonWriter_Uint(&theWriter, "received", theReceived) ;
+    JsonWriter_Float(&theWriter, "delivery", theSent > 0 ? (float)theReceived / theSent : 0.0f, 3) ;
+    JsonWriter_Int(&theWriter, "best_point", theBest) ;
+    JsonWriter_Uint(&theWriter, "best_goodput_bps", theBestGoodput) ;
+    JsonWriter_Uint(&theWriter, "ms", inNowMs - inBench->pStartMs) ;
+  }
+
+  JsonWriter_EndObject(&theWriter) ;
+
+  return JsonWriter_Finish(&theWriter) ;
+}
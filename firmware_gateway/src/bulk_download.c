@@ -0,0 +1,342 @@
+//----------------------------------------------
+// Module: bulk_download.c
+// Description: Sliding-window bulk download of a
+//   stored flight over LoRa (receiver side)
+// Author: Mark Gavin
+// Created: 2026-02-13
+// Copyright: (c) 2025-2026 by Mark Gavin
+// License: Proprietary - All Rights Reserved
+// Modified: 2026-02-16 (JSON writer)
+// Modified: 2026-02-16 (delta-coded runs, transfer rate)
+//----------------------------------------------
+
+#include "bulk_download.h"
+#include "gateway_protocol.h"
+#include "json_writer.h"
+
+#include <string.h>
+
+//----------------------------------------------
+// Internal: Read Little-Endian 16-bit
+//----------------------------------------------
+static uint16_t GetU16(const uint8_t * inData)
+{
+  return (uint16_t)(inData[0] | (inData[1] << 8)) ;
+}
+
+//----------------------------------------------
+// Function: BulkDownload_Start
+//----------------------------------------------
+void BulkDownload_Start(
+  BulkDownload * outDownload,
+  uint8_t inRocketId,
+  uint8_t inSlot,
+  uint8_t inSession,
+  uint8_t inRate,
+  uint32_t inCommandId,
+  uint32_t inNowMs)
+{
+  memset(outDownload, 0, sizeof(BulkDownload)) ;
+  outDownload->pActive = true ;
+  outDownload->pRocketId = inRocketId ;
+  outDownload->pSlot = inSlot ;
+  outDownload->pSession = inSession ;
+  outDownload->pRate = inRate ;
+  outDownload->pCommandId = inCommandId ;
+  outDownload->pStartMs = inNowMs ;
+  outDownload->pLastRxMs = inNowMs ;
+}
+
+//----------------------------------------------
+// Internal: Hold Chunk
+// Keep a chunk's samples until it is delivered,
+// unless it already was or is held
+//----------------------------------------------
+static void HoldChunk(BulkDownload * ioDownload, uint16_t inChunk, const uint8_t * inData, int inLen)
+{
+  // Already delivered, or (sender error) past the window
+  if (inChunk < ioDownload->pBase || inChunk - ioDownload->pBase >= kBulkWindowChunks)
+  {
+    ioDownload->pDuplicates++ ;
+    return ;
+  }
+
+  uint32_t theBit = 1u << (inChunk - ioDownload->pBase) ;
+  if ((ioDownload->pReceived & theBit) != 0)
+  {
+    ioDownload->pDuplicates++ ;
+    return ;
+  }
+
+  uint8_t theIndex = inChunk % kBulkWindowChunks ;
+  memcpy(ioDownload->pChunks[theIndex], inData, inLen) ;
+  ioDownload->pChunkLen[theIndex] = (uint8_t)inLen ;
+  ioDownload->pReceived |= theBit ;
+  ioDownload->pChunksReceived++ ;
+}
+
+//----------------------------------------------
+// Function: BulkDownload_ProcessChunk
+// A delta-coded packet is rebuilt a chunk at a
+// time, each sample from the one before it.
+//----------------------------------------------
+bool BulkDownload_ProcessChunk(
+  BulkDownload * ioDownload,
+  const uint8_t * inPacket,
+  int inLen,
+  uint32_t inNowMs,
+  bool * outPoll)
+{
+  *outPoll = false ;
+
+  if (!ioDownload->pActive || inPacket == NULL || inLen < kBulkHeaderLen + kBulkSampleLen ||
+      inPacket[0] != kLoRaMagic || inPacket[1] != kLoRaPacketFlashBulk ||
+      inPacket[3] != ioDownload->pSlot || inPacket[4] != ioDownload->pSession)
+  {
+    return false ;
+  }
+
+  // A broadcast request is answered by the first
+  // rocket heard
+  if (ioDownload->pRocketId == 0xFF)
+  {
+    ioDownload->pRocketId = inPacket[2] ;
+  }
+  else if (inPacket[2] != ioDownload->pRocketId)
+  {
+    return false ;
+  }
+
+  uint16_t theChunk = GetU16(&inPacket[6]) ;
+  uint16_t theSampleCount = GetU16(&inPacket[8]) ;
+  uint8_t theRun = inPacket[10] ;
+
+  if (theSampleCount == 0 || theRun == 0 || theRun > kBulkMaxRun)
+  {
+    return false ;
+  }
+
+  // The first chunk heard sizes the transfer
+  if (ioDownload->pSampleCount == 0)
+  {
+    ioDownload->pSampleCount = theSampleCount ;
+    ioDownload->pChunkCount = (uint16_t)((theSampleCount + kBulkSamplesPerChunk - 1) / kBulkSamplesPerChunk) ;
+  }
+  else if (theSampleCount != ioDownload->pSampleCount)
+  {
+    return false ;
+  }
+
+  if ((uint32_t)theChunk + theRun > ioDownload->pChunkCount)
+  {
+    return false ;
+  }
+
+  ioDownload->pLastRxMs = inNowMs ;
+  ioDownload->pPacketsReceived++ ;
+  *outPoll = (inPacket[5] & kBulkFlagPoll) != 0 ;
+
+  uint8_t theSamples[kBulkSamplesPerChunk * kBulkSampleLen] ;
+  uint8_t thePrevious[kBulkSampleLen] ;
+  int theOffset = kBulkHeaderLen ;
+  for (uint8_t i = 0 ; i < theRun ; i++)
+  {
+    uint16_t theIndex = theChunk + i ;
+    uint32_t theCount = ioDownload->pSampleCount - (uint32_t)theIndex * kBulkSamplesPerChunk ;
+    if (theCount > kBulkSamplesPerChunk)
+    {
+      theCount = kBulkSamplesPerChunk ;
+    }
+
+    for (uint32_t j = 0 ; j < theCount ; j++)
+    {
+      uint8_t * theSample = &theSamples[j * kBulkSampleLen] ;
+      if (i == 0 && j == 0)
+      {
+        memcpy(theSample, &inPacket[theOffset], kBulkSampleLen) ;
+        theOffset += kBulkSampleLen ;
+      }
+      else if (!LoRaProtocol_GetSampleDelta(inPacket, inLen, &theOffset, thePrevious, theSample))
+      {
+        // Chunks before this one were whole
+        return true ;
+      }
+      memcpy(thePrevious, theSample, kBulkSampleLen) ;
+    }
+
+    HoldChunk(ioDownload, theIndex, theSamples, (int)(theCount * kBulkSampleLen)) ;
+  }
+  return true ;
+}
+
+//----------------------------------------------
+// Function: BulkDownload_NextPacket
+//----------------------------------------------
+int BulkDownload_NextPacket(
+  BulkDownload * ioDownload,
+  uint8_t * outPacket,
+  int inMaxLen)
+{
+  if (!ioDownload->pActive || ioDownload->pComplete ||
+      (ioDownload->pReceived & 1) == 0)
+  {
+    return 0 ;
+  }
+
+  uint8_t theIndex = ioDownload->pBase % kBulkWindowChunks ;
+  uint8_t theDataLen = ioDownload->pChunkLen[theIndex] ;
+  if (outPacket == NULL || inMaxLen < 12 + theDataLen)
+  {
+    return 0 ;
+  }
+
+  // Rebuild the chunk as a kCmdFlashRead reply so
+  // the host sees the usual flash_data message
+  uint32_t theStart = (uint32_t)ioDownload->pBase * kBulkSamplesPerChunk ;
+
+  outPacket[0] = kLoRaMagic ;
+  outPacket[1] = kLoRaPacketStorageData ;
+  outPacket[2] = ioDownload->pSlot ;
+  outPacket[3] = (uint8_t)(theStart & 0xFF) ;
+  outPacket[4] = (uint8_t)((theStart >> 8) & 0xFF) ;
+  outPacket[5] = (uint8_t)((theStart >> 16) & 0xFF) ;
+  outPacket[6] = (uint8_t)((theStart >> 24) & 0xFF) ;
+  outPacket[7] = (uint8_t)(ioDownload->pSampleCount & 0xFF) ;
+  outPacket[8] = (uint8_t)((ioDownload->pSampleCount >> 8) & 0xFF) ;
+  outPacket[9] = 0 ;
+  outPacket[10] = 0 ;
+  outPacket[11] = theDataLen / kBulkSampleLen ;
+  memcpy(&outPacket[12], ioDownload->pChunks[theIndex], theDataLen) ;
+
+  ioDownload->pReceived >>= 1 ;
+  ioDownload->pBase++ ;
+  if (ioDownload->pBase >= ioDownload->pChunkCount)
+  {
+    ioDownload->pComplete = true ;
+  }
+
+  return 12 + theDataLen ;
+}
+
+//----------------------------------------------
+// Function: BulkDownload_NextToJson
+//----------------------------------------------
+int BulkDownload_NextToJson(
+  BulkDownload * ioDownload,
+  char * outJson,
+  int inMaxLen)
+{
+  uint8_t thePacket[kBulkPacketMaxLen] ;
+  int theLen = BulkDownload_NextPacket(ioDownload, thePacket, sizeof(thePacket)) ;
+  if (theLen <= 0)
+  {
+    return 0 ;
+  }
+
+  return GatewayProtocol_FlashDataToJson(thePacket, theLen, ioDownload->pCommandId, outJson, inMaxLen) ;
+}
+
+//----------------------------------------------
+// Function: BulkDownload_BuildAck
+//----------------------------------------------
+int BulkDownload_BuildAck(
+  const BulkDownload * inDownload,
+  uint8_t * outPacket,
+  int inMaxLen)
+{
+  if (outPacket == NULL || inMaxLen < kBulkAckLen) return 0 ;
+
+  outPacket[0] = kLoRaMagic ;
+  outPacket[1] = kLoRaPacketCommand ;
+  outPacket[2] = inDownload->pRocketId ;
+  outPacket[3] = kCmdFlashBulkAck ;
+  outPacket[4] = inDownload->pSlot ;
+  outPacket[5] = inDownload->pSession ;
+  outPacket[6] = (uint8_t)(inDownload->pBase & 0xFF) ;
+  outPacket[7] = (uint8_t)((inDownload->pBase >> 8) & 0xFF) ;
+  outPacket[8] = (uint8_t)(inDownload->pReceived & 0xFF) ;
+  outPacket[9] = (uint8_t)((inDownload->pReceived >> 8) & 0xFF) ;
+  outPacket[10] = (uint8_t)((inDownload->pReceived >> 16) & 0xFF) ;
+  outPacket[11] = (uint8_t)((inDownload->pReceived >> 24) & 0xFF) ;
+
+  return kBulkAckLen ;
+}
+
+//----------------------------------------------
+// Function: BulkDownload_CheckTimeout
+//----------------------------------------------
+bool BulkDownload_CheckTimeout(BulkDownload * ioDownload, uint32_t inNowMs)
+{
+  if (!ioDownload->pActive)
+  {
+    return false ;
+  }
+
+  uint32_t theQuietMs = inNowMs - ioDownload->pLastRxMs ;
+
+  // Done: stay long enough to answer a repeated
+  // final poll if the last ACK was lost
+  if (ioDownload->pComplete)
+  {
+    if (theQuietMs >= kBulkLingerMs)
+    {
+      ioDownload->pActive = false ;
+    }
+    return false ;
+  }
+
+  if (theQuietMs >= kBulkIdleTimeoutMs)
+  {
+    ioDownload->pActive = false ;
+    return true ;
+  }
+
+  return false ;
+}
+
+//----------------------------------------------
+// Function: BulkDownload_StatusToJson
+//----------------------------------------------
+int BulkDownload_StatusToJson(
+  const BulkDownload * inDownload,
+  const char * inStatus,
+  uint32_t inNowMs,
+  char * outJson,
+  int inMaxLen)
+{
+  if (outJson == NULL || inStatus == NULL || inMaxLen < 64) return 0 ;
+
+  uint32_t theElapsedMs = inNowMs - inDownload->pStartMs ;
+  uint32_t theDelivered = (uint32_t)inDownload->pBase * kBulkSamplesPerChunk ;
+  if (theDelivered > inDownload->pSampleCount)
+  {
+    theDelivered = inDownload->pSampleCount ;
+  }
+  uint32_t theBytesPerSec = theElapsedMs > 0 ?
+    (uint32_t)((uint64_t)theDelivered * kBulkSampleLen * 1000 / theElapsedMs) : 0 ;
+
+  JsonWriter theWriter ;
+  JsonWriter_Init(&theWriter, outJson, inMaxLen) ;
+  JsonWriter_BeginObject(&theWriter, NULL) ;
+  JsonWriter_String(&theWriter, "type", "flash_bulk") ;
+  if (inDownload->pCommandId != 0)
+  {
+    JsonWriter_Uint(&theWriter, "id", inDownload->pCommandId) ;
+  }
+  JsonWriter_Uint(&theWriter, "rocket", inDownload->pRocketId) ;
+  JsonWriter_Uint(&theWriter, "slot", inDownload->pSlot) ;
+  JsonWriter_Uint(&theWriter, "session", inDownload->pSession) ;
+  JsonWriter_String(&theWriter, "status", inStatus) ;
+  JsonWriter_Uint(&theWriter, "samples", inDownload->pSampleCount) ;
+  JsonWriter_Uint(&theWriter, "delivered", theDelivered) ;
+  JsonWriter_Uint(&theWriter, "chunks", inDownload->pChunkCount) ;
+  JsonWriter_Uint(&theWriter, "packets", inDownload->pPacketsReceived) ;
+  JsonWriter_Uint(&theWriter, "rate", inDownload->pRate) ;
+  JsonWriter_Uint(&theWriter, "duplicates", inDownload->pDuplicates) ;
+  JsonWriter_Uint(&theWriter, "acks", inDownload->pAcksSent) ;
+  JsonWriter_Uint(&theWriter, "ms", theElapsedMs) ;
+  JsonWriter_Uint(&theWriter, "bytes_per_s", theBytesPerSec) ;
+  JsonWriter_EndObject(&theWriter) ;
+
+  return JsonWriter_Finish(&theWriter) ;
+}
@@ -0,0 +1,244 @@
+//----------------------------------------------
+// Module: channel_plan.c
+// Description: Receive channel selection for the
+//   multi-channel frequency plan
+// Author: Mark Gavin
+// Created: 2026-02-15
+// Copyright: (c) 2025-2026 by Mark Gavin
+// License: Proprietary - All Rights Reserved
+// Modified: 2026-02-16 (JSON writer)
+//----------------------------------------------
+
+#include "channel_plan.h"
+#include "json_writer.h"
+
+#include <string.h>
+
+//----------------------------------------------
+// Internal: Check whether a rocket has been
+//   heard on a channel lately
+//----------------------------------------------
+static bool IsActive(const ChannelPlan * inPlan, uint8_t inChannel, uint32_t inNowMs)
+{
+  return inPlan->pFrames[inChannel] > 0 &&
+    (inNowMs - inPlan->pLastHeardMs[inChannel]) < kChannelActiveMs ;
+}
+
+//----------------------------------------------
+// Internal: Next active channel after inFrom
+//   (inFrom itself last), kLoRaChannelCount if
+//   none
+//----------------------------------------------
+static uint8_t NextActive(const ChannelPlan * inPlan, uint8_t inFrom, uint32_t inNowMs)
+{
+  for (uint8_t i = 1 ; i <= kLoRaChannelCount ; i++)
+  {
+    uint8_t theChannel = (uint8_t)((inFrom + i) % kLoRaChannelCount) ;
+    if (IsActive(inPlan, theChannel, inNowMs))
+    {
+      return theChannel ;
+    }
+  }
+  return kLoRaChannelCount ;
+}
+
+//----------------------------------------------
+// Internal: Next quiet channel to scan,
+//   kLoRaChannelCount if every one is active
+//----------------------------------------------
+static uint8_t NextQuiet(ChannelPlan * ioPlan, uint32_t inNowMs)
+{
+  for (uint8_t i = 0 ; i < kLoRaChannelCount ; i++)
+  {
+    uint8_t theChannel = (uint8_t)((ioPlan->pScanNext + i) % kLoRaChannelCount) ;
+    if (!IsActive(ioPlan, theChannel, inNowMs))
+    {
+      ioPlan->pScanNext = (uint8_t)((theChannel + 1) % kLoRaChannelCount) ;
+      return theChannel ;
+    }
+  }
+  return kLoRaChannelCount ;
+}
+
+//----------------------------------------------
+// Function: ChannelPlan_Init
+//----------------------------------------------
+void ChannelPlan_Init(ChannelPlan * outPlan, bool inEnabled)
+{
+  memset(outPlan, 0, sizeof(ChannelPlan)) ;
+  outPlan->pEnabled = inEnabled ;
+  outPlan->pDwellMs = kChannelScanMs ;
+  outPlan->pFocusRocket = kChannelUnknown ;
+  memset(outPlan->pRocketChannel, kChannelUnknown, sizeof(outPlan->pRocketChannel)) ;
+}
+
+//----------------------------------------------
+// Function: ChannelPlan_GetRocketChannel
+//----------------------------------------------
+uint8_t ChannelPlan_GetRocketChannel(const ChannelPlan * inPlan, uint8_t inRocketId)
+{
+  if (inRocketId >= kChannelMaxRockets)
+  {
+    return 0 ;
+  }
+
+  uint8_t theChannel = inPlan->pRocketChannel[inRocketId] ;
+  return theChannel != kChannelUnknown ? theChannel : LoRa_GetRocketChannel(inRocketId) ;
+}
+
+//----------------------------------------------
+// Function: ChannelPlan_SetRocketChannel
+//----------------------------------------------
+void ChannelPlan_SetRocketChannel(ChannelPlan * ioPlan, uint8_t inRocketId, bool inOwnChannel)
+{
+  for (uint8_t i = 0 ; i < kChannelMaxRockets ; i++)
+  {
+    if (inRocketId == i ||
+        (inRocketId == 0xFF && ioPlan->pRocketChannel[i] != kChannelUnknown))
+    {
+      ioPlan->pRocketChannel[i] = inOwnChannel ? LoRa_GetRocketChannel(i) : 0 ;
+    }
+  }
+}
+
+//----------------------------------------------
+// Function: ChannelPlan_RecordFrame
+//----------------------------------------------
+void ChannelPlan_RecordFrame(
+  ChannelPlan * ioPlan,
+  uint32_t inFrequencyHz,
+  uint8_t inRocketId,
+  uint32_t inNowMs)
+{
+  uint8_t theChannel = LoRa_GetChannel(inFrequencyHz) ;
+  if (theChannel >= kLoRaChannelCount)
+  {
+    return ;
+  }
+
+  ioPlan->pLastHeardMs[theChannel] = inNowMs ;
+  ioPlan->pFrames[theChannel]++ ;
+  if (inRocketId < kChannelMaxRockets)
+  {
+    ioPlan->pRocketChannel[inRocketId] = theChannel ;
+  }
+}
+
+//----------------------------------------------
+// Function: ChannelPlan_Focus
+//----------------------------------------------
+void ChannelPlan_Focus(
+  ChannelPlan * ioPlan,
+  uint8_t inRocketId,
+  uint32_t inNowMs,
+  uint32_t inDurationMs)
+{
+  ioPlan->pFocusRocket = inRocketId < kChannelMaxRockets ? inRocketId : kChannelUnknown ;
+  ioPlan->pFocusUntilMs = inNowMs + inDurationMs ;
+}
+
+//----------------------------------------------
+// Function: ChannelPlan_Select
+//----------------------------------------------
+uint8_t ChannelPlan_Select(ChannelPlan * ioPlan, uint32_t inNowMs, uint8_t inSlotRocket)
+{
+  if (!ioPlan->pEnabled)
+  {
+    ioPlan->pChannel = 0 ;
+    return 0 ;
+  }
+
+  // Hopping runs on underneath a focus or a slot,
+  // so it picks up where the clock says
+  if ((inNowMs - ioPlan->pDwellStartMs) >= ioPlan->pDwellMs)
+  {
+    ioPlan->pDwellStartMs = inNowMs ;
+    ioPlan->pDwellMs = kChannelDwellMs ;
+    ioPlan->pHops++ ;
+
+    uint8_t theNext = NextActive(ioPlan, ioPlan->pHopChannel, inNowMs) ;
+    if (theNext >= kLoRaChannelCount || ioPlan->pHops >= kChannelScanEvery)
+    {
+      uint8_t theQuiet = NextQuiet(ioPlan, inNowMs) ;
+      if (theQuiet < kLoRaChannelCount)
+      {
+        theNext = theQuiet ;
+        ioPlan->pDwellMs = kChannelScanMs ;
+      }
+      ioPlan->pHops = 0 ;
+    }
+    ioPlan->pHopChannel = theNext ;
+  }
+
+  uint8_t theChannel = ioPlan->pHopChannel ;
+  if (ioPlan->pFocusRocket != kChannelUnknown &&
+      (int32_t)(ioPlan->pFocusUntilMs - inNowMs) > 0)
+  {
+    theChannel = ChannelPlan_GetRocketChannel(ioPlan, ioPlan->pFocusRocket) ;
+  }
+  else if (inSlotRocket < kChannelMaxRockets)
+  {
+    theChannel = ChannelPlan_GetRocketChannel(ioPlan, inSlotRocket) ;
+  }
+
+  if (theChannel != ioPlan->pChannel)
+  {
+    ioPlan->pChannel = theChannel ;
+    ioPlan->pRetunes++ ;
+  }
+  return theChannel ;
+}
+
+//----------------------------------------------
+// Function: ChannelPlan_ToJson
+//----------------------------------------------
+int ChannelPlan_ToJson(
+  const ChannelPlan * inPlan,
+  uint32_t inNowMs,
+  char * outJson,
+  int inMaxLen)
+{
+  if (outJson == NULL || inMaxLen <= 0) return 0 ;
+
+  JsonWriter theWriter ;
+  JsonWriter_Init(&theWriter, outJson, inMaxLen) ;
+  JsonWriter_BeginObject(&theWriter, NULL) ;
+  JsonWriter_String(&theWriter, "type", "channels") ;
+  JsonWriter_Bool(&theWriter, "enabled", inPlan->pEnabled) ;
+  JsonWriter_Uint(&theWriter, "channel", inPlan->pChannel) ;
+  JsonWriter_Uint(&theWriter, "freq_hz", LoRa_GetChannelFrequency(inPlan->pChannel)) ;
+  JsonWriter_Uint(&theWriter, "spacing_hz", kLoRaChannelSpacingHz) ;
+  JsonWriter_Uint(&theWriter, "retunes", inPlan->pRetunes) ;
+
+  JsonWriter_BeginArray(&theWriter, "channels") ;
+  for (uint8_t i = 0 ; i < kLoRaChannelCount ; i++)
+  {
+    JsonWriter_BeginObject(&theWriter, NULL) ;
+    JsonWriter_Uint(&theWriter, "ch", i) ;
+    JsonWriter_Uint(&theWriter, "freq_hz", LoRa_GetChannelFrequency(i)) ;
+    JsonWriter_Uint(&theWriter, "frames", inPlan->pFrames[i]) ;
+    JsonWriter_Bool(&theWriter, "active", IsActive(inPlan, i, inNowMs)) ;
+    JsonWriter_EndObject(&theWriter) ;
+  }
+  JsonWriter_EndArray(&theWriter) ;
+
+  // Rockets heard so far: where they send, and
+  // the channel their ID is assigned
+  JsonWriter_BeginArray(&theWriter, "rockets") ;
+  for (uint8_t i = 0 ; i < kChannelMaxRockets ; i++)
+  {
+    if (inPlan->pRocketChannel[i] == kChannelUnknown)
+    {
+      continue ;
+    }
+    JsonWriter_BeginObject(&theWriter, NULL) ;
+    JsonWriter_Uint(&theWriter, "id", i) ;
+    JsonWriter_Uint(&theWriter, "channel", inPlan->pRocketChannel[i]) ;
+    JsonWriter_Uint(&theWriter, "assigned", LoRa_GetRocketChannel(i)) ;
+    JsonWriter_EndObject(&theWriter) ;
+  }
+  JsonWriter_EndArray(&theWriter) ;
+  JsonWriter_EndObject(&theWriter) ;
+
+  return JsonWriter_Finish(&theWriter) ;
+}
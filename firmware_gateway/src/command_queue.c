@@ -0,0 +1,502 @@
+//----------------------------------------------
+// Module: command_queue.c
+// Description: Per-rocket command queue released
+//   into each rocket's receive window
+// Author: Mark Gavin
+// Created: 2026-02-15
+// Copyright: (c) 2025-2026 by Mark Gavin
+// License: Proprietary - All Rights Reserved
+// Modified: 2026-02-15 (request IDs, outstanding commands and retries)
+// Modified: 2026-02-16 (JSON writer)
+// Modified: 2026-02-16 (host ID for a response)
+//----------------------------------------------
+
+#include "command_queue.h"
+#include "gateway_protocol.h"
+#include "json_writer.h"
+
+#include <string.h>
+
+// Reply status names (kReply*)
+static const char * sStatusNames[] =
+{
+  "ok",
+  "rejected",
+  "unknown"
+} ;
+
+//----------------------------------------------
+// Internal: Put a command back at the head of a
+//   rocket's queue
+//----------------------------------------------
+static bool Requeue(CommandRocket * ioRocket, const QueuedCommand * inCommand)
+{
+  if (ioRocket->pCount >= kCmdQueueDepth)
+  {
+    return false ;
+  }
+
+  ioRocket->pHead = (uint8_t)((ioRocket->pHead + kCmdQueueDepth - 1) % kCmdQueueDepth) ;
+  ioRocket->pEntries[ioRocket->pHead] = *inCommand ;
+  ioRocket->pCount++ ;
+  return true ;
+}
+
+//----------------------------------------------
+// Internal: Remove an outstanding command
+//----------------------------------------------
+static void RemoveOutstanding(CommandRocket * ioRocket, uint8_t inIndex)
+{
+  for (uint8_t i = inIndex ; i + 1 < ioRocket->pOutstandingCount ; i++)
+  {
+    ioRocket->pOutstanding[i] = ioRocket->pOutstanding[i + 1] ;
+  }
+  ioRocket->pOutstandingCount-- ;
+}
+
+//----------------------------------------------
+// Internal: Remove a queued command (a request
+//   answered late, after it was queued again)
+//----------------------------------------------
+static void RemoveQueued(CommandRocket * ioRocket, uint8_t inPosition)
+{
+  for (uint8_t i = inPosition ; i + 1 < ioRocket->pCount ; i++)
+  {
+    ioRocket->pEntries[(ioRocket->pHead + i) % kCmdQueueDepth] =
+      ioRocket->pEntries[(ioRocket->pHead + i + 1) % kCmdQueueDepth] ;
+  }
+  ioRocket->pCount-- ;
+}
+
+//----------------------------------------------
+// Function: CommandQueue_Init
+//----------------------------------------------
+void CommandQueue_Init(CommandQueue * outQueue)
+{
+  memset(outQueue, 0, sizeof(CommandQueue)) ;
+}
+
+//----------------------------------------------
+// Function: CommandQueue_Push
+//----------------------------------------------
+bool CommandQueue_Push(
+  CommandQueue * ioQueue,
+  const uint8_t * inPacket,
+  uint8_t inLen,
+  uint32_t inCommandId,
+  uint32_t inNowMs)
+{
+  if (inLen < 4 || inLen + 1 > kCmdQueueMaxLen || inPacket[2] >= kCmdQueueMaxRockets)
+  {
+    return false ;
+  }
+
+  CommandRocket * theRocket = &ioQueue->pRockets[inPacket[2]] ;
+  if (theRocket->pCount >= kCmdQueueDepth)
+  {
+    return false ;
+  }
+
+  // The request: the command with its ID before
+  // the command byte
+  uint8_t theSlot = (uint8_t)((theRocket->pHead + theRocket->pCount) % kCmdQueueDepth) ;
+  QueuedCommand * theCommand = &theRocket->pEntries[theSlot] ;
+  theCommand->pData[0] = inPacket[0] ;
+  theCommand->pData[1] = kLoRaPacketRequest ;
+  theCommand->pData[2] = inPacket[2] ;
+  theCommand->pData[3] = theRocket->pNextRequestId++ ;
+  memcpy(&theCommand->pData[4], &inPacket[3], inLen - 3) ;
+  theCommand->pLen = (uint8_t)(inLen + 1) ;
+  theCommand->pCommandId = inCommandId ;
+  theCommand->pRequestId = theCommand->pData[3] ;
+  theCommand->pAttempts = 0 ;
+  theCommand->pStatus = kReplyOk ;
+  theCommand->pQueuedMs = inNowMs ;
+  theCommand->pSentMs = 0 ;
+  theCommand->pInWindow = false ;
+  theRocket->pCount++ ;
+  return true ;
+}
+
+//----------------------------------------------
+// Function: CommandQueue_RecordWindow
+//----------------------------------------------
+void CommandQueue_RecordWindow(CommandQueue * ioQueue, uint8_t inRocketId, uint32_t inNowMs)
+{
+  if (inRocketId >= kCmdQueueMaxRockets)
+  {
+    return ;
+  }
+
+  CommandRocket * theRocket = &ioQueue->pRockets[inRocketId] ;
+  theRocket->pWindowSeen = true ;
+  theRocket->pLastWindowMs = inNowMs ;
+  theRocket->pWindows++ ;
+}
+
+//----------------------------------------------
+// Function: CommandQueue_IsWindowed
+//----------------------------------------------
+bool CommandQueue_IsWindowed(const CommandQueue * inQueue, uint8_t inRocketId, uint32_t inNowMs)
+{
+  if (inRocketId >= kCmdQueueMaxRockets)
+  {
+    return false ;
+  }
+
+  const CommandRocket * theRocket = &inQueue->pRockets[inRocketId] ;
+  return theRocket->pWindowSeen && (inNowMs - theRocket->pLastWindowMs) < kCmdWindowStaleMs ;
+}
+
+//----------------------------------------------
+// Function: CommandQueue_Peek
+//----------------------------------------------
+const QueuedCommand * CommandQueue_Peek(const CommandQueue * inQueue, uint8_t inRocketId)
+{
+  if (inRocketId >= kCmdQueueMaxRockets || inQueue->pRockets[inRocketId].pCount == 0 ||
+      inQueue->pRockets[inRocketId].pOutstandingCount >= kCmdOutstandingMax)
+  {
+    return NULL ;
+  }
+
+  const CommandRocket * theRocket = &inQueue->pRockets[inRocketId] ;
+  return &theRocket->pEntries[theRocket->pHead] ;
+}
+
+//----------------------------------------------
+// Function: CommandQueue_MarkSent
+//----------------------------------------------
+void CommandQueue_MarkSent(
+  CommandQueue * ioQueue,
+  uint8_t inRocketId,
+  uint32_t inNowMs,
+  bool inInWindow,
+  QueuedCommand * outCommand)
+{
+  if (inRocketId >= kCmdQueueMaxRockets || ioQueue->pRockets[inRocketId].pCount == 0)
+  {
+    return ;
+  }
+
+  CommandRocket * theRocket = &ioQueue->pRockets[inRocketId] ;
+  if (theRocket->pOutstandingCount >= kCmdOutstandingMax)
+  {
+    return ;
+  }
+
+  QueuedCommand * theCommand = &theRocket->pOutstanding[theRocket->pOutstandingCount++] ;
+  *theCommand = theRocket->pEntries[theRocket->pHead] ;
+  theCommand->pSentMs = inNowMs ;
+  theCommand->pInWindow = inInWindow ;
+  theCommand->pAttempts++ ;
+  theRocket->pHead = (uint8_t)((theRocket->pHead + 1) % kCmdQueueDepth) ;
+  theRocket->pCount-- ;
+
+  // Queue time counts once, to the first send
+  theRocket->pSent++ ;
+  theRocket->pInWindow += inInWindow ? 1 : 0 ;
+  if (theCommand->pAttempts == 1)
+  {
+    theRocket->pCommands++ ;
+    uint32_t theQueueMs = inNowMs - theCommand->pQueuedMs ;
+    theRocket->pQueueMsSum += theQueueMs ;
+    if (theQueueMs > theRocket->pQueueMsMax)
+    {
+      theRocket->pQueueMsMax = theQueueMs ;
+    }
+  }
+
+  if (outCommand != NULL)
+  {
+    *outCommand = *theCommand ;
+  }
+}
+
+//----------------------------------------------
+// Function: CommandQueue_TakeExpired
+//----------------------------------------------
+bool CommandQueue_TakeExpired(
+  CommandQueue * ioQueue,
+  uint8_t inRocketId,
+  uint32_t inNowMs,
+  QueuedCommand * outCommand)
+{
+  if (inRocketId >= kCmdQueueMaxRockets || ioQueue->pRockets[inRocketId].pCount == 0)
+  {
+    return false ;
+  }
+
+  CommandRocket * theRocket = &ioQueue->pRockets[inRocketId] ;
+  const QueuedCommand * theHead = &theRocket->pEntries[theRocket->pHead] ;
+  if ((inNowMs - theHead->pQueuedMs) < kCmdExpireMs)
+  {
+    return false ;
+  }
+
+  *outCommand = *theHead ;
+  theRocket->pHead = (uint8_t)((theRocket->pHead + 1) % kCmdQueueDepth) ;
+  theRocket->pCount-- ;
+  theRocket->pExpired++ ;
+  return true ;
+}
+
+//----------------------------------------------
+// Function: CommandQueue_TakeOverdue
+//----------------------------------------------
+bool CommandQueue_TakeOverdue(
+  CommandQueue * ioQueue,
+  uint8_t inRocketId,
+  uint32_t inNowMs,
+  QueuedCommand * outCommand,
+  bool * outRetry)
+{
+  if (inRocketId >= kCmdQueueMaxRockets)
+  {
+    return false ;
+  }
+
+  // Newest first, so that several overdue at once
+  // end up at the head of the queue in their order
+  CommandRocket * theRocket = &ioQueue->pRockets[inRocketId] ;
+  for (uint8_t i = theRocket->pOutstandingCount ; i-- > 0 ; )
+  {
+    QueuedCommand * theCommand = &theRocket->pOutstanding[i] ;
+    if ((inNowMs - theCommand->pSentMs) < kCmdReplyTimeoutMs)
+    {
+      continue ;
+    }
+
+    *outCommand = *theCommand ;
+    RemoveOutstanding(theRocket, i) ;
+
+    // Sent again ahead of newer commands; it keeps
+    // its request ID so the rocket knows a repeat
+    *outRetry = outCommand->pAttempts < kCmdMaxAttempts && Requeue(theRocket, outCommand) ;
+    if (*outRetry)
+    {
+      theRocket->pRetries++ ;
+    }
+    else
+    {
+      theRocket->pTimeouts++ ;
+    }
+    return true ;
+  }
+  return false ;
+}
+
+//----------------------------------------------
+// Function: CommandQueue_RecordReply
+//----------------------------------------------
+bool CommandQueue_RecordReply(
+  CommandQueue * ioQueue,
+  const uint8_t * inPacket,
+  uint8_t inLen,
+  uint32_t inNowMs,
+  QueuedCommand * outCommand)
+{
+  if (inLen < kCommandReplyLen || inPacket[2] >= kCmdQueueMaxRockets)
+  {
+    return false ;
+  }
+
+  CommandRocket * theRocket = &ioQueue->pRockets[inPacket[2]] ;
+  uint8_t theRequestId = inPacket[3] ;
+  bool theFound = false ;
+  for (uint8_t i = 0 ; i < theRocket->pOutstandingCount && !theFound ; i++)
+  {
+    if (theRocket->pOutstanding[i].pRequestId == theRequestId)
+    {
+      *outCommand = theRocket->pOutstanding[i] ;
+      RemoveOutstanding(theRocket, i) ;
+      theFound = true ;
+    }
+  }
+
+  // Answered after it was queued to go again
+  for (uint8_t i = 0 ; i < theRocket->pCount && !theFound ; i++)
+  {
+    QueuedCommand * theCommand = &theRocket->pEntries[(theRocket->pHead + i) % kCmdQueueDepth] ;
+    if (theCommand->pAttempts > 0 && theCommand->pRequestId == theRequestId)
+    {
+      *outCommand = *theCommand ;
+      RemoveQueued(theRocket, i) ;
+      theFound = true ;
+    }
+  }
+
+  if (!theFound)
+  {
+    return false ;
+  }
+
+  outCommand->pStatus = inPacket[5] ;
+  uint32_t theRttMs = inNowMs - outCommand->pSentMs ;
+  if (theRocket->pReplies == 0 || theRttMs < theRocket->pRttMsMin)
+  {
+    theRocket->pRttMsMin = theRttMs ;
+  }
+  if (theRttMs > theRocket->pRttMsMax)
+  {
+    theRocket->pRttMsMax = theRttMs ;
+  }
+  theRocket->pRttMsSum += theRttMs ;
+  theRocket->pReplies++ ;
+  return true ;
+}
+
+//----------------------------------------------
+// Function: CommandQueue_FindRequest
+// A request queued to go again after a timeout
+// still counts: its response may just be late.
+//----------------------------------------------
+bool CommandQueue_FindRequest(
+  const CommandQueue * inQueue,
+  uint8_t inRocketId,
+  uint8_t inCommand,
+  uint32_t * outCommandId)
+{
+  const QueuedCommand * theOldest = NULL ;
+  for (uint8_t r = 0 ; r < kCmdQueueMaxRockets ; r++)
+  {
+    if (inRocketId != 0xFF && r != inRocketId)
+    {
+      continue ;
+    }
+
+    const CommandRocket * theRocket = &inQueue->pRockets[r] ;
+    for (uint8_t i = 0 ; i < theRocket->pOutstandingCount ; i++)
+    {
+      const QueuedCommand * theCommand = &theRocket->pOutstanding[i] ;
+      if (theCommand->pLen > 4 && theCommand->pData[4] == inCommand &&
+          (theOldest == NULL || (int32_t)(theCommand->pSentMs - theOldest->pSentMs) < 0))
+      {
+        theOldest = theCommand ;
+      }
+    }
+    for (uint8_t i = 0 ; i < theRocket->pCount ; i++)
+    {
+      const QueuedCommand * theCommand = &theRocket->pEntries[(theRocket->pHead + i) % kCmdQueueDepth] ;
+      if (theCommand->pAttempts > 0 && theCommand->pLen > 4 && theCommand->pData[4] == inCommand &&
+          (theOldest == NULL || (int32_t)(theCommand->pSentMs - theOldest->pSentMs) < 0))
+      {
+        theOldest = theCommand ;
+      }
+    }
+  }
+
+  if (theOldest == NULL)
+  {
+    return false ;
+  }
+
+  *outCommandId = theOldest->pCommandId ;
+  return true ;
+}
+
+//----------------------------------------------
+// Function: CommandQueue_EventToJson
+//----------------------------------------------
+int CommandQueue_EventToJson(
+  const QueuedCommand * inCommand,
+  const char * inEvent,
+  uint32_t inNowMs,
+  uint32_t inAirUs,
+  char * outJson,
+  int inMaxLen)
+{
+  if (outJson == NULL || inMaxLen <= 0 || inCommand->pLen < 5) return 0 ;
+
+  JsonWriter theWriter ;
+  JsonWriter_Init(&theWriter, outJson, inMaxLen) ;
+  JsonWriter_BeginObject(&theWriter, NULL) ;
+  JsonWriter_String(&theWriter, "type", "cmd") ;
+  JsonWriter_String(&theWriter, "event", inEvent) ;
+  JsonWriter_Uint(&theWriter, "id", inCommand->pCommandId) ;
+  JsonWriter_Uint(&theWriter, "rocket", inCommand->pData[2]) ;
+  JsonWriter_Uint(&theWriter, "cmd", inCommand->pData[4]) ;
+  JsonWriter_Uint(&theWriter, "req", inCommand->pRequestId) ;
+  JsonWriter_Uint(&theWriter, "attempt", inCommand->pAttempts) ;
+  JsonWriter_Bool(&theWriter, "window", inCommand->pInWindow) ;
+
+  if (strcmp(inEvent, "sent") == 0)
+  {
+    JsonWriter_Uint(&theWriter, "queue_ms", inCommand->pSentMs - inCommand->pQueuedMs) ;
+    JsonWriter_Uint(&theWriter, "air_ms", (inAirUs + 500) / 1000) ;
+  }
+  else if (strcmp(inEvent, "reply") == 0)
+  {
+    JsonWriter_String(&theWriter, "status",
+      inCommand->pStatus <= kReplyUnknown ? sStatusNames[inCommand->pStatus] : "error") ;
+    JsonWriter_Uint(&theWriter, "queue_ms", inCommand->pSentMs - inCommand->pQueuedMs) ;
+    JsonWriter_Uint(&theWriter, "rtt_ms", inNowMs - inCommand->pSentMs) ;
+  }
+  else
+  {
+    JsonWriter_Uint(&theWriter, "queue_ms", inNowMs - inCommand->pQueuedMs) ;
+  }
+  JsonWriter_EndObject(&theWriter) ;
+
+  return JsonWriter_Finish(&theWriter) ;
+}
+
+//----------------------------------------------
+// Function: CommandQueue_StatsToJson
+//----------------------------------------------
+int CommandQueue_StatsToJson(
+  const CommandQueue * inQueue,
+  uint32_t inNowMs,
+  char * outJson,
+  int inMaxLen)
+{
+  if (outJson == NULL || inMaxLen <= 0) return 0 ;
+
+  JsonWriter theWriter ;
+  JsonWriter_Init(&theWriter, outJson, inMaxLen) ;
+  JsonWriter_BeginObject(&theWriter, NULL) ;
+  JsonWriter_String(&theWriter, "type", "cmd_stats") ;
+  JsonWriter_Int(&theWriter, "depth", kCmdQueueDepth) ;
+  JsonWriter_Int(&theWriter, "expire_ms", kCmdExpireMs) ;
+  JsonWriter_Int(&theWriter, "outstanding_max", kCmdOutstandingMax) ;
+  JsonWriter_Int(&theWriter, "reply_timeout_ms", kCmdReplyTimeoutMs) ;
+  JsonWriter_Int(&theWriter, "attempts", kCmdMaxAttempts) ;
+
+  // Rockets that have had a command or announced
+  // a window
+  JsonWriter_BeginArray(&theWriter, "rockets") ;
+  for (int i = 0 ; i < kCmdQueueMaxRockets ; i++)
+  {
+    const CommandRocket * theRocket = &inQueue->pRockets[i] ;
+    if (!theRocket->pWindowSeen && theRocket->pSent == 0 &&
+        theRocket->pCount == 0 && theRocket->pExpired == 0 && theRocket->pOutstandingCount == 0)
+    {
+      continue ;
+    }
+
+    JsonWriter_BeginObject(&theWriter, NULL) ;
+    JsonWriter_Int(&theWriter, "id", i) ;
+    JsonWriter_Bool(&theWriter, "windowed", CommandQueue_IsWindowed(inQueue, (uint8_t)i, inNowMs)) ;
+    JsonWriter_Uint(&theWriter, "windows", theRocket->pWindows) ;
+    JsonWriter_Uint(&theWriter, "queued", theRocket->pCount) ;
+    JsonWriter_Uint(&theWriter, "outstanding", theRocket->pOutstandingCount) ;
+    JsonWriter_Uint(&theWriter, "commands", theRocket->pCommands) ;
+    JsonWriter_Uint(&theWriter, "sent", theRocket->pSent) ;
+    JsonWriter_Uint(&theWriter, "in_window", theRocket->pInWindow) ;
+    JsonWriter_Uint(&theWriter, "expired", theRocket->pExpired) ;
+    JsonWriter_Uint(&theWriter, "retries", theRocket->pRetries) ;
+    JsonWriter_Uint(&theWriter, "timeouts", theRocket->pTimeouts) ;
+    JsonWriter_Uint(&theWriter, "queue_ms_avg",
+      theRocket->pCommands > 0 ? theRocket->pQueueMsSum / theRocket->pCommands : 0) ;
+    JsonWriter_Uint(&theWriter, "queue_ms_max", theRocket->pQueueMsMax) ;
+    JsonWriter_Uint(&theWriter, "replies", theRocket->pReplies) ;
+    JsonWriter_Uint(&theWriter, "rtt_ms_min", theRocket->pRttMsMin) ;
+    JsonWriter_Uint(&theWriter, "rtt_ms_avg",
+      theRocket->pReplies > 0 ? theRocket->pRttMsSum / theRocket->pReplies : 0) ;
+    JsonWriter_Uint(&theWriter, "rtt_ms_max", theRocket->pRttMsMax) ;
+    JsonWriter_EndObject(&theWriter) ;
+  }
+  JsonWriter_EndArray(&theWriter) ;
+  JsonWriter_EndObject(&theWriter) ;
+
+  return JsonWriter_Finish(&theWriter) ;
+}
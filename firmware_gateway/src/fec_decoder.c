@@ -0,0 +1,223 @@
+//----------------------------------------------
+// Module: fec_decoder.c
+// Description: Telemetry loss recovery from the
+//   flight computer's FEC parity frames
+// Author: Mark Gavin
+// Created: 2026-02-14
+// Copyright: (c) 2025-2026 by Mark Gavin
+// License: Proprietary - All Rights Reserved
+// Modified: 2026-02-16 (JSON writer)
+//----------------------------------------------
+
+#include "fec_decoder.h"
+#include "gateway_protocol.h"
+#include "json_writer.h"
+
+#include <string.h>
+
+//----------------------------------------------
+// Internal: Count the set bits of a group mask
+//----------------------------------------------
+static uint8_t CountBits(uint8_t inMask)
+{
+  uint8_t theCount = 0 ;
+  while (inMask != 0)
+  {
+    inMask &= (uint8_t)(inMask - 1) ;
+    theCount++ ;
+  }
+  return theCount ;
+}
+
+//----------------------------------------------
+// Function: FecDecoder_Init
+//----------------------------------------------
+void FecDecoder_Init(FecDecoder * outDecoder)
+{
+  memset(outDecoder, 0, sizeof(FecDecoder)) ;
+}
+
+//----------------------------------------------
+// Function: FecDecoder_RecordFrame
+//----------------------------------------------
+void FecDecoder_RecordFrame(
+  FecDecoder * ioDecoder,
+  uint8_t inRocketId,
+  uint8_t inSequence,
+  const uint8_t * inFrame,
+  uint8_t inLen)
+{
+  if (inRocketId >= kFecMaxRockets || inLen == 0 || inLen > kFecMaxFrameLen)
+  {
+    return ;
+  }
+
+  ioDecoder->pFrames++ ;
+  ioDecoder->pFrameBytes += inLen ;
+
+  FecRocket * theRocket = &ioDecoder->pRockets[inRocketId] ;
+  if (theRocket->pGroup == 0)
+  {
+    return ;
+  }
+
+  // A frame from another group starts over; that
+  // group's parity would have come before it
+  uint8_t theBase = (uint8_t)(inSequence & ~(theRocket->pGroup - 1)) ;
+  if (!theRocket->pOpen || theBase != theRocket->pBase)
+  {
+    theRocket->pOpen = true ;
+    theRocket->pBase = theBase ;
+    theRocket->pMask = 0 ;
+    theRocket->pLenXor = 0 ;
+    memset(theRocket->pXor, 0, sizeof(theRocket->pXor)) ;
+  }
+
+  // A repeat would cancel itself out
+  uint8_t theBit = (uint8_t)(1u << (inSequence - theBase)) ;
+  if (theRocket->pMask & theBit)
+  {
+    return ;
+  }
+
+  for (uint8_t i = 0 ; i < inLen ; i++)
+  {
+    theRocket->pXor[i] ^= inFrame[i] ;
+  }
+  theRocket->pLenXor ^= inLen ;
+  theRocket->pMask |= theBit ;
+}
+
+//----------------------------------------------
+// Function: FecDecoder_ProcessParity
+// Frame: magic, type, rocketId, base seq, K,
+//   sent mask, length XOR, then the XOR bytes
+//----------------------------------------------
+bool FecDecoder_ProcessParity(FecDecoder * ioDecoder, const uint8_t * inPacket, uint8_t inLen)
+{
+  if (inPacket == NULL || inLen <= kFecHeaderLen ||
+      inLen - kFecHeaderLen > kFecMaxFrameLen)
+  {
+    return false ;
+  }
+
+  uint8_t theRocketId = inPacket[2] ;
+  uint8_t theBase = inPacket[3] ;
+  uint8_t theGroup = inPacket[4] ;
+  uint8_t theSent = inPacket[5] ;
+  if (theRocketId >= kFecMaxRockets ||
+      (theGroup != 2 && theGroup != 4 && theGroup != kFecMaxGroup) ||
+      (theBase & (theGroup - 1)) != 0)
+  {
+    return false ;
+  }
+
+  ioDecoder->pParityFrames++ ;
+  ioDecoder->pParityBytes += inLen ;
+
+  // The first parity frame at a group size only
+  // teaches it; its group was not being folded
+  FecRocket * theRocket = &ioDecoder->pRockets[theRocketId] ;
+  if (theRocket->pGroup != theGroup)
+  {
+    theRocket->pGroup = theGroup ;
+    theRocket->pOpen = false ;
+    return true ;
+  }
+
+  // Nothing folded in counts as nothing heard
+  bool theMatch = theRocket->pOpen && theRocket->pBase == theBase ;
+  uint8_t theHeard = theMatch ? theRocket->pMask : 0 ;
+  uint8_t theMissing = (uint8_t)(theSent & ~theHeard) ;
+  uint8_t theCount = CountBits(theMissing) ;
+
+  if (theCount == 0)
+  {
+    ioDecoder->pCleanGroups++ ;
+  }
+  else if (theCount > 1)
+  {
+    ioDecoder->pUnrecoverable += theCount ;
+  }
+  else
+  {
+    // The lost frame is what the parity holds
+    // beyond the frames that were heard
+    uint8_t theDataLen = (uint8_t)(inLen - kFecHeaderLen) ;
+    uint8_t theLen = inPacket[6] ^ (theMatch ? theRocket->pLenXor : 0) ;
+    if (theLen == 0 || theLen > theDataLen)
+    {
+      ioDecoder->pUnrecoverable++ ;
+    }
+    else
+    {
+      for (uint8_t i = 0 ; i < theLen ; i++)
+      {
+        ioDecoder->pRecovered[i] = inPacket[kFecHeaderLen + i] ^
+                                   (theMatch ? theRocket->pXor[i] : 0) ;
+      }
+      ioDecoder->pRecoveredLen = theLen ;
+      ioDecoder->pRecoveredFrames++ ;
+    }
+  }
+
+  theRocket->pOpen = false ;
+  return true ;
+}
+
+//----------------------------------------------
+// Function: FecDecoder_TakeRecovered
+//----------------------------------------------
+uint8_t FecDecoder_TakeRecovered(FecDecoder * ioDecoder, uint8_t * outFrame, uint8_t inMaxLen)
+{
+  uint8_t theLen = ioDecoder->pRecoveredLen ;
+  if (theLen == 0 || theLen > inMaxLen)
+  {
+    return 0 ;
+  }
+
+  memcpy(outFrame, ioDecoder->pRecovered, theLen) ;
+  ioDecoder->pRecoveredLen = 0 ;
+  return theLen ;
+}
+
+//----------------------------------------------
+// Function: FecDecoder_IsStatsDue
+//----------------------------------------------
+bool FecDecoder_IsStatsDue(const FecDecoder * inDecoder, uint32_t inNowMs)
+{
+  return inDecoder->pParityFrames > 0 &&
+    (inNowMs - inDecoder->pLastStatsMs) >= kFecStatsIntervalMs ;
+}
+
+//----------------------------------------------
+// Function: FecDecoder_StatsToJson
+//----------------------------------------------
+int FecDecoder_StatsToJson(
+  FecDecoder * ioDecoder,
+  uint32_t inNowMs,
+  char * outJson,
+  int inMaxLen)
+{
+  if (outJson == NULL || inMaxLen <= 0) return 0 ;
+
+  ioDecoder->pLastStatsMs = inNowMs ;
+
+  // Parity bytes per 1000 telemetry bytes heard
+  uint32_t theOverhead = ioDecoder->pFrameBytes == 0 ? 0 :
+    (uint32_t)((uint64_t)ioDecoder->pParityBytes * 1000 / ioDecoder->pFrameBytes) ;
+
+  JsonWriter theWriter ;
+  JsonWriter_Init(&theWriter, outJson, inMaxLen) ;
+  JsonWriter_BeginObject(&theWriter, NULL) ;
+  JsonWriter_String(&theWriter, "type", "fec_stats") ;
+  JsonWriter_Uint(&theWriter, "frames", ioDecoder->pFrames) ;
+  JsonWriter_Uint(&theWriter, "parity", ioDecoder->pParityFrames) ;
+  JsonWriter_Uint(&theWriter, "clean_groups", ioDecoder->pCleanGroups) ;
+  JsonWriter_Uint(&theWriter, "recovered", ioDecoder->pRecoveredFrames) ;
+  JsonWriter_Uint(&theWriter, "unrecoverable", ioDecoder->pUnrecoverable) ;
+  JsonWriter_Fixed(&theWriter, "overhead_pct", (int32_t)theOverhead, 1) ;
+  JsonWriter_EndObject(&theWriter) ;
+
+  return JsonWriter_Finish(&theWriter) ;
+}
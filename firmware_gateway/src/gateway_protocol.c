@@ -5,15 +5,36 @@
 // Created: 2026-01-10
 // Copyright: (c) 2025-2026 by Mark Gavin
 // License: Proprietary - All Rights Reserved
+// Modified: 2026-02-10 (compact telemetry decoder)
+// Modified: 2026-02-11 (telemetry batch expansion)
+// Modified: 2026-02-12 (TDMA command, telemetry source)
+// Modified: 2026-02-13 (bulk flash read command)
+// Modified: 2026-02-14 (data_rate command)
+// Modified: 2026-02-14 (ack command)
+// Modified: 2026-02-14 (fec command)
+// Modified: 2026-02-15 (cmd_queue command, telemetry flags)
+// Modified: 2026-02-15 (link collision and deferral counts in status)
+// Modified: 2026-02-15 (flight event trailer)
+// Modified: 2026-02-15 (recovery beacon, telemetry_profile command)
+// Modified: 2026-02-15 (benchmark command)
+// Modified: 2026-02-15 (output command)
+// Modified: 2026-02-16 (JSON writer instead of snprintf)
+// Modified: 2026-02-16 (bulk read transfer rate)
+// Modified: 2026-02-16 (host ID on flash responses)
+// Modified: 2026-02-16 (stored flight status in flash_list)
 //----------------------------------------------
 
 #include "gateway_protocol.h"
+#include "bench_receiver.h"
+#include "gateway_stream.h"
+#include "json_writer.h"
 #include "pins.h"
 
 #include <stdio.h>
 #include <string.h>
 #include <stdlib.h>
 #include <stdbool.h>
+#include <stddef.h>
 #include <math.h>
 
 //----------------------------------------------
@@ -26,6 +47,110 @@
 #define kMolarMass              0.0289644f  // Molar mass of air (kg/mol)
 #define kGravity                9.80665f    // Gravitational acceleration (m/s^2)
 
+//----------------------------------------------
+// Compact Telemetry Decoder State
+//----------------------------------------------
+#define kCompactMaxRockets      16
+
+// Per-rocket fields carried only in slow sections
+typedef struct
+{
+  bool pOriginValid ;             // Slow section received
+  uint8_t pOriginEpoch ;          // 2-bit origin epoch
+  int32_t pOriginLat ;            // Microdegrees
+  int32_t pOriginLon ;            // Microdegrees
+  int16_t pTemperatureC10 ;
+  uint8_t pSatellites ;
+  int16_t pGpsSpeedCmps ;
+  uint16_t pGpsHeadingDeg10 ;
+  uint16_t pSequence ;            // Last full sequence number
+} CompactRocketState ;
+
+static CompactRocketState sCompactState[kCompactMaxRockets] ;
+
+// Bit reader over a received frame
+typedef struct
+{
+  const uint8_t * pData ;
+  uint16_t pBitPos ;
+} BitReader ;
+
+//----------------------------------------------
+// Internal: GetBits
+// Read inBits, LSB first
+//----------------------------------------------
+static uint32_t GetBits(BitReader * ioReader, uint8_t inBits)
+{
+  uint32_t theValue = 0 ;
+
+  for (uint8_t i = 0 ; i < inBits ; i++)
+  {
+    if (ioReader->pData[ioReader->pBitPos >> 3] & (1 << (ioReader->pBitPos & 7)))
+    {
+      theValue |= (1UL << i) ;
+    }
+    ioReader->pBitPos++ ;
+  }
+  return theValue ;
+}
+
+//----------------------------------------------
+// Internal: GetSigned
+// Read and sign-extend a two's complement field
+//----------------------------------------------
+static int32_t GetSigned(BitReader * ioReader, uint8_t inBits)
+{
+  uint32_t theValue = GetBits(ioReader, inBits) ;
+
+  if (theValue & (1UL << (inBits - 1)))
+  {
+    theValue |= ~((1UL << inBits) - 1) ;
+  }
+  return (int32_t)theValue ;
+}
+
+//----------------------------------------------
+// Internal: ClampInt16
+//----------------------------------------------
+static int16_t ClampInt16(int32_t inValue)
+{
+  if (inValue > INT16_MAX) return INT16_MAX ;
+  if (inValue < INT16_MIN) return INT16_MIN ;
+  return (int16_t)inValue ;
+}
+
+//----------------------------------------------
+// Internal: GetVarint
+// Read an unsigned varint (7 bits per byte, low
+// group first); false if it runs off the end
+//----------------------------------------------
+static bool GetVarint(const uint8_t * inData, int inLen, int * ioOffset, uint32_t * outValue)
+{
+  uint32_t theValue = 0 ;
+
+  for (int theShift = 0 ; theShift < 35 ; theShift += 7)
+  {
+    if (*ioOffset >= inLen) return false ;
+
+    uint8_t theByte = inData[(*ioOffset)++] ;
+    theValue |= (uint32_t)(theByte & 0x7F) << theShift ;
+    if ((theByte & 0x80) == 0)
+    {
+      *outValue = theValue ;
+      return true ;
+    }
+  }
+  return false ;
+}
+
+//----------------------------------------------
+// Internal: UnZigZag
+//----------------------------------------------
+static int32_t UnZigZag(uint32_t inValue)
+{
+  return (int32_t)(inValue >> 1) ^ -(int32_t)(inValue & 1) ;
+}
+
 //----------------------------------------------
 // Internal: Calculate altitude from pressure
 //----------------------------------------------
@@ -58,6 +183,31 @@ static const char * sFlightStateNames[] =
   "complete"
 } ;
 
+// Flight event names (kEvent*, from 1)
+static const char * sEventNames[] =
+{
+  "armed",
+  "disarmed",
+  "launch",
+  "burnout",
+  "apogee",
+  "descent",
+  "landed",
+  "complete",
+  "reset"
+} ;
+
+// Stored flight status (must match FlightSlotStatus
+// in flight_storage.h)
+static const char * sSlotStatusNames[] =
+{
+  "empty",
+  "unverified",
+  "valid",
+  "legacy",
+  "corrupt"
+} ;
+
 //----------------------------------------------
 // Function: GatewayProtocol_Init
 //----------------------------------------------
@@ -72,6 +222,13 @@ void GatewayProtocol_Init(GatewayState * ioState)
   ioState->pPacketsLost = 0 ;
   ioState->pLastRssi = 0 ;
   ioState->pLastSnr = 0 ;
+  ioState->pChannel = 0 ;
+  ioState->pCrcErrors = 0 ;
+  ioState->pListenBeforeTalk = false ;
+  ioState->pCadChecks = 0 ;
+  ioState->pLbtDeferrals = 0 ;
+  ioState->pLbtForced = 0 ;
+  ioState->pLbtHoldMaxUs = 0 ;
 }
 
 //----------------------------------------------
@@ -93,117 +250,61 @@ int GatewayProtocol_TelemetryToJson(
   // Validate magic byte
   if (inPacket->pMagic != kLoRaMagic) return 0 ;
 
-  // Convert barometric units
-  float theAltitudeM = inPacket->pAltitudeCm / 100.0f ;
-  float theVelocityMps = inPacket->pVelocityCmps / 100.0f ;
-  float theTemperatureC = inPacket->pTemperatureC10 / 10.0f ;
-
-  // Convert GPS units
-  float theLatitude = inPacket->pGpsLatitude / 1000000.0f ;
-  float theLongitude = inPacket->pGpsLongitude / 1000000.0f ;
-  float theGpsSpeedMps = inPacket->pGpsSpeedCmps / 100.0f ;
-  float theHeadingDeg = inPacket->pGpsHeadingDeg10 / 10.0f ;
-  bool theHasGpsFix = (inPacket->pFlags & kFlagGpsFix) != 0 ;
-
-  // Convert IMU units
-  // Accelerometer: milli-g to g
-  float theAccelX = inPacket->pAccelX / 1000.0f ;
-  float theAccelY = inPacket->pAccelY / 1000.0f ;
-  float theAccelZ = inPacket->pAccelZ / 1000.0f ;
-
-  // Gyroscope: 0.1 dps to dps
-  float theGyroX = inPacket->pGyroX / 10.0f ;
-  float theGyroY = inPacket->pGyroY / 10.0f ;
-  float theGyroZ = inPacket->pGyroZ / 10.0f ;
-
-  // Magnetometer: already in milligauss, send as-is
-  int16_t theMagX = inPacket->pMagX ;
-  int16_t theMagY = inPacket->pMagY ;
-  int16_t theMagZ = inPacket->pMagZ ;
-
-  // Get state name
-  const char * theStateName = GatewayProtocol_GetStateName(inPacket->pState) ;
-
-  // Calculate ground altitude (using sea level reference) and differential altitude
+  // Ground altitude (against sea level) and the
+  // flight computer's altitude above the gateway;
+  // the only values not already integers
   float theGroundAltitudeM = CalculateAltitude(inGroundPressurePa, kSeaLevelPressurePa) ;
-
-  // Calculate differential altitude: flight computer relative to ground station
-  // This is more accurate than the flight computer's self-referenced altitude
   float theDiffAltitudeM = 0.0f ;
   if (inGroundPressurePa > 0.0f && inPacket->pPressurePa > 0)
   {
     theDiffAltitudeM = CalculateAltitude((float)inPacket->pPressurePa, inGroundPressurePa) ;
   }
 
-  // Build JSON telemetry message with GPS, IMU data, ground reference, and gateway GPS
-  int theLen = snprintf(outJson, inMaxLen,
-    "{\"type\":\"tel\","
-    "\"seq\":%u,"
-    "\"t\":%lu,"
-    "\"alt\":%.2f,"
-    "\"dalt\":%.2f,"
-    "\"vel\":%.2f,"
-    "\"pres\":%lu,"
-    "\"gpres\":%.0f,"
-    "\"galt\":%.1f,"
-    "\"temp\":%.1f,"
-    "\"lat\":%.6f,"
-    "\"lon\":%.6f,"
-    "\"gspd\":%.2f,"
-    "\"hdg\":%.1f,"
-    "\"sat\":%u,"
-    "\"gps\":%s,"
-    "\"ax\":%.3f,"
-    "\"ay\":%.3f,"
-    "\"az\":%.3f,"
-    "\"gx\":%.1f,"
-    "\"gy\":%.1f,"
-    "\"gz\":%.1f,"
-    "\"mx\":%d,"
-    "\"my\":%d,"
-    "\"mz\":%d,"
-    "\"state\":\"%s\","
-    "\"flags\":%u,"
-    "\"rssi\":%d,"
-    "\"snr\":%d,"
-    "\"gw_gps\":%s,"
-    "\"gw_lat\":%.6f,"
-    "\"gw_lon\":%.6f}\n",
-    inPacket->pSequence,
-    (unsigned long)inPacket->pTimeMs,
-    theAltitudeM,
-    theDiffAltitudeM,
-    theVelocityMps,
-    (unsigned long)inPacket->pPressurePa,
-    inGroundPressurePa,
-    theGroundAltitudeM,
-    theTemperatureC,
-    theLatitude,
-    theLongitude,
-    theGpsSpeedMps,
-    theHeadingDeg,
-    inPacket->pGpsSatellites,
-    theHasGpsFix ? "true" : "false",
-    theAccelX,
-    theAccelY,
-    theAccelZ,
-    theGyroX,
-    theGyroY,
-    theGyroZ,
-    theMagX,
-    theMagY,
-    theMagZ,
-    theStateName,
-    inPacket->pFlags,
-    inRssi,
-    inSnr,
-    inGwGpsValid ? "true" : "false",
-    inGwGpsValid ? inGwGpsLat : 0.0f,
-    inGwGpsValid ? inGwGpsLon : 0.0f) ;
-
-  return theLen ;
+  // Packet fields go out at their own scale: cm and
+  // cm/s as m and m/s, microdegrees as degrees, mg
+  // as g, tenths as units; magnetometer as-is (mG)
+  JsonWriter theWriter ;
+  JsonWriter_Init(&theWriter, outJson, inMaxLen) ;
+  JsonWriter_BeginObject(&theWriter, NULL) ;
+  JsonWriter_String(&theWriter, "type", "tel") ;
+  JsonWriter_Uint(&theWriter, "id", inPacket->pRocketId) ;
+  JsonWriter_Uint(&theWriter, "seq", inPacket->pSequence) ;
+  JsonWriter_Uint(&theWriter, "t", inPacket->pTimeMs) ;
+  JsonWriter_Fixed(&theWriter, "alt", inPacket->pAltitudeCm, 2) ;
+  JsonWriter_Float(&theWriter, "dalt", theDiffAltitudeM, 2) ;
+  JsonWriter_Fixed(&theWriter, "vel", inPacket->pVelocityCmps, 2) ;
+  JsonWriter_Uint(&theWriter, "pres", inPacket->pPressurePa) ;
+  JsonWriter_Float(&theWriter, "gpres", inGroundPressurePa, 0) ;
+  JsonWriter_Float(&theWriter, "galt", theGroundAltitudeM, 1) ;
+  JsonWriter_Fixed(&theWriter, "temp", inPacket->pTemperatureC10, 1) ;
+  JsonWriter_Fixed(&theWriter, "lat", inPacket->pGpsLatitude, 6) ;
+  JsonWriter_Fixed(&theWriter, "lon", inPacket->pGpsLongitude, 6) ;
+  JsonWriter_Fixed(&theWriter, "gspd", inPacket->pGpsSpeedCmps, 2) ;
+  JsonWriter_Fixed(&theWriter, "hdg", inPacket->pGpsHeadingDeg10, 1) ;
+  JsonWriter_Uint(&theWriter, "sat", inPacket->pGpsSatellites) ;
+  JsonWriter_Bool(&theWriter, "gps", (inPacket->pFlags & kFlagGpsFix) != 0) ;
+  JsonWriter_Fixed(&theWriter, "ax", inPacket->pAccelX, 3) ;
+  JsonWriter_Fixed(&theWriter, "ay", inPacket->pAccelY, 3) ;
+  JsonWriter_Fixed(&theWriter, "az", inPacket->pAccelZ, 3) ;
+  JsonWriter_Fixed(&theWriter, "gx", inPacket->pGyroX, 1) ;
+  JsonWriter_Fixed(&theWriter, "gy", inPacket->pGyroY, 1) ;
+  JsonWriter_Fixed(&theWriter, "gz", inPacket->pGyroZ, 1) ;
+  JsonWriter_Int(&theWriter, "mx", inPacket->pMagX) ;
+  JsonWriter_Int(&theWriter, "my", inPacket->pMagY) ;
+  JsonWriter_Int(&theWriter, "mz", inPacket->pMagZ) ;
+  JsonWriter_String(&theWriter, "state", GatewayProtocol_GetStateName(inPacket->pState)) ;
+  JsonWriter_Uint(&theWriter, "flags", inPacket->pFlags) ;
+  JsonWriter_Int(&theWriter, "rssi", inRssi) ;
+  JsonWriter_Int(&theWriter, "snr", inSnr) ;
+  JsonWriter_Bool(&theWriter, "gw_gps", inGwGpsValid) ;
+  JsonWriter_Float(&theWriter, "gw_lat", inGwGpsValid ? inGwGpsLat : 0.0f, 6) ;
+  JsonWriter_Float(&theWriter, "gw_lon", inGwGpsValid ? inGwGpsLon : 0.0f, 6) ;
+  JsonWriter_EndObject(&theWriter) ;
+
+  return JsonWriter_Finish(&theWriter) ;
 }
 
+
 //----------------------------------------------
 // Function: GatewayProtocol_ParseCommand
 //----------------------------------------------
@@ -285,6 +386,10 @@ bool GatewayProtocol_ParseCommand(
   {
     *outCommandType = kUsbCmdFlashRead ;
   }
+  else if (strncmp(theCmdStart, "flash_bulk", theCmdLen) == 0)
+  {
+    *outCommandType = kUsbCmdFlashBulk ;
+  }
   else if (strncmp(theCmdStart, "flash_delete", theCmdLen) == 0)
   {
     *outCommandType = kUsbCmdFlashDelete ;
@@ -293,6 +398,50 @@ bool GatewayProtocol_ParseCommand(
   {
     *outCommandType = kUsbCmdOrientationMode ;
   }
+  else if (strncmp(theCmdStart, "compact_telemetry", theCmdLen) == 0)
+  {
+    *outCommandType = kUsbCmdCompactTelemetry ;
+  }
+  else if (strncmp(theCmdStart, "telemetry_batch", theCmdLen) == 0)
+  {
+    *outCommandType = kUsbCmdTelemetryBatch ;
+  }
+  else if (strncmp(theCmdStart, "tdma", theCmdLen) == 0)
+  {
+    *outCommandType = kUsbCmdTdma ;
+  }
+  else if (strncmp(theCmdStart, "data_rate", theCmdLen) == 0)
+  {
+    *outCommandType = kUsbCmdDataRate ;
+  }
+  else if (strncmp(theCmdStart, "ack", theCmdLen) == 0)
+  {
+    *outCommandType = kUsbCmdAck ;
+  }
+  else if (strncmp(theCmdStart, "fec", theCmdLen) == 0)
+  {
+    *outCommandType = kUsbCmdFec ;
+  }
+  else if (strncmp(theCmdStart, "channel_plan", theCmdLen) == 0)
+  {
+    *outCommandType = kUsbCmdChannelPlan ;
+  }
+  else if (strncmp(theCmdStart, "cmd_queue", theCmdLen) == 0)
+  {
+    *outCommandType = kUsbCmdCommandQueue ;
+  }
+  else if (strncmp(theCmdStart, "telemetry_profile", theCmdLen) == 0)
+  {
+    *outCommandType = kUsbCmdTelemetryProfile ;
+  }
+  else if (strncmp(theCmdStart, "benchmark", theCmdLen) == 0)
+  {
+    *outCommandType = kUsbCmdBenchmark ;
+  }
+  else if (strncmp(theCmdStart, "output", theCmdLen) == 0)
+  {
+    *outCommandType = kUsbCmdOutput ;
+  }
   // WiFi configuration commands
   else if (strncmp(theCmdStart, "wifi_list", theCmdLen) == 0)
   {
@@ -496,24 +645,29 @@ int GatewayProtocol_BuildStatusJson(
 {
   if (inState == NULL || outJson == NULL || inMaxLen < 64) return 0 ;
 
-  int theLen = snprintf(outJson, inMaxLen,
-    "{\"type\":\"status\","
-    "\"id\":%lu,"
-    "\"connected\":%s,"
-    "\"rx\":%lu,"
-    "\"tx\":%lu,"
-    "\"rssi\":%d,"
-    "\"snr\":%d}\n",
-    (unsigned long)inCommandId,
-    inState->pConnected ? "true" : "false",
-    (unsigned long)inState->pPacketsReceived,
-    (unsigned long)inState->pPacketsSent,
-    inState->pLastRssi,
-    inState->pLastSnr) ;
-
-  return theLen ;
+  JsonWriter theWriter ;
+  JsonWriter_Init(&theWriter, outJson, inMaxLen) ;
+  JsonWriter_BeginObject(&theWriter, NULL) ;
+  JsonWriter_String(&theWriter, "type", "status") ;
+  JsonWriter_Uint(&theWriter, "id", inCommandId) ;
+  JsonWriter_Bool(&theWriter, "connected", inState->pConnected) ;
+  JsonWriter_Uint(&theWriter, "rx", inState->pPacketsReceived) ;
+  JsonWriter_Uint(&theWriter, "tx", inState->pPacketsSent) ;
+  JsonWriter_Int(&theWriter, "rssi", inState->pLastRssi) ;
+  JsonWriter_Int(&theWriter, "snr", inState->pLastSnr) ;
+  JsonWriter_Uint(&theWriter, "channel", inState->pChannel) ;
+  JsonWriter_Uint(&theWriter, "crc_errors", inState->pCrcErrors) ;
+  JsonWriter_Bool(&theWriter, "lbt", inState->pListenBeforeTalk) ;
+  JsonWriter_Uint(&theWriter, "cad_checks", inState->pCadChecks) ;
+  JsonWriter_Uint(&theWriter, "lbt_deferrals", inState->pLbtDeferrals) ;
+  JsonWriter_Uint(&theWriter, "lbt_forced", inState->pLbtForced) ;
+  JsonWriter_Uint(&theWriter, "lbt_hold_max_ms", inState->pLbtHoldMaxUs / 1000) ;
+  JsonWriter_EndObject(&theWriter) ;
+
+  return JsonWriter_Finish(&theWriter) ;
 }
 
+
 //----------------------------------------------
 // Function: GatewayProtocol_BuildAckJson
 //----------------------------------------------
@@ -525,14 +679,68 @@ int GatewayProtocol_BuildAckJson(
 {
   if (outJson == NULL || inMaxLen < 32) return 0 ;
 
-  int theLen = snprintf(outJson, inMaxLen,
-    "{\"type\":\"ack\",\"id\":%lu,\"ok\":%s}\n",
-    (unsigned long)inCommandId,
-    inSuccess ? "true" : "false") ;
+  JsonWriter theWriter ;
+  JsonWriter_Init(&theWriter, outJson, inMaxLen) ;
+  JsonWriter_BeginObject(&theWriter, NULL) ;
+  JsonWriter_String(&theWriter, "type", "ack") ;
+  JsonWriter_Uint(&theWriter, "id", inCommandId) ;
+  JsonWriter_Bool(&theWriter, "ok", inSuccess) ;
+  JsonWriter_EndObject(&theWriter) ;
 
-  return theLen ;
+  return JsonWriter_Finish(&theWriter) ;
+}
+
+
+//----------------------------------------------
+// Function: GatewayProtocol_ParseOutputParams
+//----------------------------------------------
+int GatewayProtocol_ParseOutputParams(const char * inJson)
+{
+  if (inJson == NULL) return -1 ;
+
+  // Find format: "format":"json" or "binary"
+  const char * theFormatStart = strstr(inJson, "\"format\":") ;
+  if (theFormatStart == NULL) return -1 ;
+
+  theFormatStart += 9 ;  // Skip past "format":
+  while (*theFormatStart == ' ') theFormatStart++ ;
+
+  if (strncmp(theFormatStart, "\"binary\"", 8) == 0)
+  {
+    return kOutputFormatBinary ;
+  }
+  if (strncmp(theFormatStart, "\"json\"", 6) == 0)
+  {
+    return kOutputFormatJson ;
+  }
+
+  return -1 ;
 }
 
+//----------------------------------------------
+// Function: GatewayProtocol_BuildOutputJson
+//----------------------------------------------
+int GatewayProtocol_BuildOutputJson(
+  uint32_t inCommandId,
+  int inFormat,
+  char * outJson,
+  int inMaxLen)
+{
+  if (outJson == NULL || inMaxLen < 80) return 0 ;
+
+  JsonWriter theWriter ;
+  JsonWriter_Init(&theWriter, outJson, inMaxLen) ;
+  JsonWriter_BeginObject(&theWriter, NULL) ;
+  JsonWriter_String(&theWriter, "type", "output") ;
+  JsonWriter_Uint(&theWriter, "id", inCommandId) ;
+  JsonWriter_String(&theWriter, "format", inFormat == kOutputFormatBinary ? "binary" : "json") ;
+  JsonWriter_Int(&theWriter, "version", kStreamVersion) ;
+  JsonWriter_EndObject(&theWriter) ;
+
+  return JsonWriter_Finish(&theWriter) ;
+}
+
+
 //----------------------------------------------
 // Function: GatewayProtocol_GetStateName
 //----------------------------------------------
@@ -598,10 +806,11 @@ int GatewayProtocol_StorageListToJson(
   uint8_t theCount = inPacket[2] ;
   int theOffset = 3 ;
 
-  // Start JSON array
-  int theJsonLen = snprintf(outJson, inMaxLen,
-    "{\"type\":\"%s_list\",\"files\":[",
-    inIsSd ? "sd" : "flash") ;
+  JsonWriter theWriter ;
+  JsonWriter_Init(&theWriter, outJson, inMaxLen) ;
+  JsonWriter_BeginObject(&theWriter, NULL) ;
+  JsonWriter_String(&theWriter, "type", inIsSd ? "sd_list" : "flash_list") ;
+  JsonWriter_BeginArray(&theWriter, "files") ;
 
   // Parse each file entry
   for (uint8_t i = 0 ; i < theCount && theOffset < inLen ; i++)
@@ -632,21 +841,26 @@ int GatewayProtocol_StorageListToJson(
     uint8_t theHour = inPacket[theOffset++] ;
     uint8_t theMinute = inPacket[theOffset++] ;
 
-    // Add file entry to JSON
-    if (i > 0) theJsonLen += snprintf(outJson + theJsonLen, inMaxLen - theJsonLen, ",") ;
-    theJsonLen += snprintf(outJson + theJsonLen, inMaxLen - theJsonLen,
-      "{\"name\":\"%s\",\"size\":%lu,\"date\":\"%04u-%02u-%02u %02u:%02u\"}",
-      theName,
-      (unsigned long)theSize,
+    // Date as text (integers only)
+    char theDate[24] ;
+    snprintf(theDate, sizeof(theDate), "%04u-%02u-%02u %02u:%02u",
       theYear, theMonth, theDay, theHour, theMinute) ;
+
+    // Add file entry to JSON
+    JsonWriter_BeginObject(&theWriter, NULL) ;
+    JsonWriter_String(&theWriter, "name", theName) ;
+    JsonWriter_Uint(&theWriter, "size", theSize) ;
+    JsonWriter_String(&theWriter, "date", theDate) ;
+    JsonWriter_EndObject(&theWriter) ;
   }
 
-  // Close JSON
-  theJsonLen += snprintf(outJson + theJsonLen, inMaxLen - theJsonLen, "]}\n") ;
+  JsonWriter_EndArray(&theWriter) ;
+  JsonWriter_EndObject(&theWriter) ;
 
-  return theJsonLen ;
+  return JsonWriter_Finish(&theWriter) ;
 }
 
+
 //----------------------------------------------
 // Function: GatewayProtocol_StorageDataToJson
 // Packet format: magic, type, offset(4), total(4), chunk_len(2), data(n)
@@ -676,27 +890,21 @@ int GatewayProtocol_StorageDataToJson(
   // Verify chunk length matches packet
   if (theChunkLen > inLen - 12) theChunkLen = inLen - 12 ;
 
-  // Base64 encode the chunk data (for JSON transport)
-  // For simplicity, output as hex string
-  int theJsonLen = snprintf(outJson, inMaxLen,
-    "{\"type\":\"%s_data\",\"offset\":%lu,\"total\":%lu,\"len\":%u,\"data\":\"",
-    inIsSd ? "sd" : "flash",
-    (unsigned long)theOffset,
-    (unsigned long)theTotal,
-    theChunkLen) ;
-
-  // Encode data as hex
-  const uint8_t * theData = &inPacket[12] ;
-  for (uint16_t i = 0 ; i < theChunkLen && theJsonLen < inMaxLen - 10 ; i++)
-  {
-    theJsonLen += snprintf(outJson + theJsonLen, inMaxLen - theJsonLen, "%02X", theData[i]) ;
-  }
-
-  theJsonLen += snprintf(outJson + theJsonLen, inMaxLen - theJsonLen, "\"}\n") ;
-
-  return theJsonLen ;
+  // Chunk data as a hex string (for JSON transport)
+  JsonWriter theWriter ;
+  JsonWriter_Init(&theWriter, outJson, inMaxLen) ;
+  JsonWriter_BeginObject(&theWriter, NULL) ;
+  JsonWriter_String(&theWriter, "type", inIsSd ? "sd_data" : "flash_data") ;
+  JsonWriter_Uint(&theWriter, "offset", theOffset) ;
+  JsonWriter_Uint(&theWriter, "total", theTotal) ;
+  JsonWriter_Uint(&theWriter, "len", theChunkLen) ;
+  JsonWriter_Hex(&theWriter, "data", &inPacket[12], theChunkLen) ;
+  JsonWriter_EndObject(&theWriter) ;
+
+  return JsonWriter_Finish(&theWriter) ;
 }
 
+
 //----------------------------------------------
 // Function: GatewayProtocol_ParseOrientationModeEnabled
 //----------------------------------------------
@@ -749,6 +957,758 @@ int GatewayProtocol_BuildOrientationModeCommand(
   return 5 ;
 }
 
+//----------------------------------------------
+// Function: GatewayProtocol_BuildTelemetryFormatCommand
+//----------------------------------------------
+int GatewayProtocol_BuildTelemetryFormatCommand(
+  uint8_t inTargetRocketId,
+  bool inCompact,
+  uint8_t * outPacket,
+  int inMaxLen)
+{
+  if (outPacket == NULL || inMaxLen < 5) return 0 ;
+
+  outPacket[0] = kLoRaMagic ;
+  outPacket[1] = kLoRaPacketCommand ;
+  outPacket[2] = inTargetRocketId ;
+  outPacket[3] = kCmdTelemetryFormat ;
+  outPacket[4] = inCompact ? kTelemetryFormatCompact : kTelemetryFormatFull ;
+
+  return 5 ;
+}
+
+//----------------------------------------------
+// Function: GatewayProtocol_BuildTelemetryBatchCommand
+//----------------------------------------------
+int GatewayProtocol_BuildTelemetryBatchCommand(
+  uint8_t inTargetRocketId,
+  bool inEnabled,
+  uint8_t * outPacket,
+  int inMaxLen)
+{
+  if (outPacket == NULL || inMaxLen < 5) return 0 ;
+
+  outPacket[0] = kLoRaMagic ;
+  outPacket[1] = kLoRaPacketCommand ;
+  outPacket[2] = inTargetRocketId ;
+  outPacket[3] = kCmdTelemetryBatch ;
+  outPacket[4] = inEnabled ? 1 : 0 ;
+
+  return 5 ;
+}
+
+//----------------------------------------------
+// Function: GatewayProtocol_TelemetryBatchToJson
+// Frame: magic, type, rocketId, seq(2), state,
+//   flags, count, then the first sample in full
+//   (time ms, alt dm, vel dm/s, accel 0.1 m/s^2)
+//   and varint deltas for the rest, then CRC-8
+//----------------------------------------------
+int GatewayProtocol_TelemetryBatchToJson(
+  const uint8_t * inPacket,
+  int inLen,
+  int16_t inRssi,
+  int8_t inSnr,
+  char * outJson,
+  int inMaxLen,
+  float * outAltitudeM,
+  float * outVelocityMps)
+{
+  if (inPacket == NULL || outJson == NULL || inLen < 21 || inMaxLen < 128) return 0 ;
+  if (LoRaProtocol_Crc8(inPacket, inLen - 1) != inPacket[inLen - 1]) return 0 ;
+
+  uint16_t theSequence = inPacket[3] | (inPacket[4] << 8) ;
+  uint8_t theCount = inPacket[7] ;
+
+  int32_t theTimeMs ;
+  int32_t theAltitudeDm ;
+  int16_t theVelocityDms ;
+  int16_t theAccelDms2 ;
+  memcpy(&theTimeMs, &inPacket[8], 4) ;
+  memcpy(&theAltitudeDm, &inPacket[12], 4) ;
+  memcpy(&theVelocityDms, &inPacket[16], 2) ;
+  memcpy(&theAccelDms2, &inPacket[18], 2) ;
+
+  JsonWriter theWriter ;
+  JsonWriter_Init(&theWriter, outJson, inMaxLen) ;
+  JsonWriter_BeginObject(&theWriter, NULL) ;
+  JsonWriter_String(&theWriter, "type", "tel_batch") ;
+  JsonWriter_Uint(&theWriter, "id", inPacket[2]) ;
+  JsonWriter_Uint(&theWriter, "seq", theSequence) ;
+  JsonWriter_String(&theWriter, "state", GatewayProtocol_GetStateName(inPacket[5])) ;
+  JsonWriter_Uint(&theWriter, "flags", inPacket[6]) ;
+  JsonWriter_Int(&theWriter, "rssi", inRssi) ;
+  JsonWriter_Int(&theWriter, "snr", inSnr) ;
+  JsonWriter_BeginArray(&theWriter, "s") ;
+
+  // Each sample: [t ms, alt m, vel m/s, accel m/s^2]
+  int theOffset = 20 ;
+  int theDataEnd = inLen - 1 ;
+  for (uint8_t i = 0 ; i < theCount ; i++)
+  {
+    if (i > 0)
+    {
+      uint32_t theStep, theAlt, theVel, theAccel ;
+      if (!GetVarint(inPacket, theDataEnd, &theOffset, &theStep) ||
+          !GetVarint(inPacket, theDataEnd, &theOffset, &theAlt) ||
+          !GetVarint(inPacket, theDataEnd, &theOffset, &theVel) ||
+          !GetVarint(inPacket, theDataEnd, &theOffset, &theAccel))
+      {
+        return 0 ;
+      }
+      theTimeMs += (int32_t)theStep ;
+      theAltitudeDm += UnZigZag(theAlt) ;
+      theVelocityDms += (int16_t)UnZigZag(theVel) ;
+      theAccelDms2 += (int16_t)UnZigZag(theAccel) ;
+    }
+
+    JsonWriter_BeginArray(&theWriter, NULL) ;
+    JsonWriter_Int(&theWriter, NULL, theTimeMs) ;
+    JsonWriter_Fixed(&theWriter, NULL, theAltitudeDm, 1) ;
+    JsonWriter_Fixed(&theWriter, NULL, theVelocityDms, 1) ;
+    JsonWriter_Fixed(&theWriter, NULL, theAccelDms2, 1) ;
+    JsonWriter_EndArray(&theWriter) ;
+  }
+
+  JsonWriter_EndArray(&theWriter) ;
+  JsonWriter_EndObject(&theWriter) ;
+
+  if (outAltitudeM != NULL) *outAltitudeM = theAltitudeDm / 10.0f ;
+  if (outVelocityMps != NULL) *outVelocityMps = theVelocityDms / 10.0f ;
+
+  return JsonWriter_Finish(&theWriter) ;
+}
+
+//----------------------------------------------
+// Function: GatewayProtocol_DecodeCompactTelemetry
+// Layout: see lora_protocol.h (compact frame)
+//----------------------------------------------
+bool GatewayProtocol_DecodeCompactTelemetry(
+  const uint8_t * inData,
+  int inLen,
+  LoRaTelemetryPacket * outPacket)
+{
+  if (inData == NULL || outPacket == NULL || inLen < kCompactTelemetryMinLen) return false ;
+  if (inData[0] != kLoRaMagicCompact) return false ;
+  if (LoRaProtocol_Crc8(inData, inLen - 1) != inData[inLen - 1]) return false ;
+
+  BitReader theReader = { inData, 8 } ;
+  uint8_t theRocketId = (uint8_t)GetBits(&theReader, 4) ;
+  uint8_t theSeqLow = (uint8_t)GetBits(&theReader, 8) ;
+  uint8_t theState = (uint8_t)GetBits(&theReader, 3) ;
+  uint8_t theFlags = (uint8_t)GetBits(&theReader, 8) ;
+  uint8_t theSections = (uint8_t)GetBits(&theReader, 3) ;
+
+  // Check the sections fit before reading them
+  int theBits = 139 ;
+  if (theSections & kCompactHasGps) theBits += 34 ;
+  if (theSections & kCompactHasOrientation) theBits += 72 ;
+  if (theSections & kCompactHasSlow) theBits += 96 ;
+  if ((theBits + 7) / 8 + 1 != inLen) return false ;
+
+  CompactRocketState * theRocket = &sCompactState[theRocketId] ;
+
+  memset(outPacket, 0, sizeof(LoRaTelemetryPacket)) ;
+  outPacket->pMagic = kLoRaMagic ;
+  outPacket->pPacketType = kLoRaPacketTelemetry ;
+  outPacket->pRocketId = theRocketId ;
+
+  // Extend the 8-bit sequence from the last one seen
+  uint16_t theSequence = (theRocket->pSequence & 0xFF00) | theSeqLow ;
+  if (theSequence < theRocket->pSequence)
+  {
+    theSequence += 0x100 ;
+  }
+  theRocket->pSequence = theSequence ;
+  outPacket->pSequence = theSequence ;
+
+  outPacket->pTimeMs = GetBits(&theReader, 18) * 10 ;
+  outPacket->pAltitudeCm = GetSigned(&theReader, 19) * 10 ;
+  outPacket->pVelocityCmps = ClampInt16(GetSigned(&theReader, 15) * 10) ;
+  outPacket->pPressurePa = GetBits(&theReader, 17) ;
+  outPacket->pAccelX = (int16_t)(GetSigned(&theReader, 12) * 20) ;
+  outPacket->pAccelY = (int16_t)(GetSigned(&theReader, 12) * 20) ;
+  outPacket->pAccelZ = (int16_t)(GetSigned(&theReader, 12) * 20) ;
+
+  uint8_t theGpsEpoch = 0 ;
+  int32_t theDeltaLat = 0 ;
+  int32_t theDeltaLon = 0 ;
+  if (theSections & kCompactHasGps)
+  {
+    theGpsEpoch = (uint8_t)GetBits(&theReader, 2) ;
+    theDeltaLat = GetSigned(&theReader, 16) ;
+    theDeltaLon = GetSigned(&theReader, 16) ;
+  }
+
+  if (theSections & kCompactHasOrientation)
+  {
+    outPacket->pGyroX = (int16_t)(GetSigned(&theReader, 12) * 10) ;
+    outPacket->pGyroY = (int16_t)(GetSigned(&theReader, 12) * 10) ;
+    outPacket->pGyroZ = (int16_t)(GetSigned(&theReader, 12) * 10) ;
+    outPacket->pMagX = (int16_t)GetSigned(&theReader, 12) ;
+    outPacket->pMagY = (int16_t)GetSigned(&theReader, 12) ;
+    outPacket->pMagZ = (int16_t)GetSigned(&theReader, 12) ;
+  }
+
+  if (theSections & kCompactHasSlow)
+  {
+    theRocket->pOriginEpoch = (uint8_t)GetBits(&theReader, 2) ;
+    theRocket->pOriginLat = (int32_t)GetBits(&theReader, 32) ;
+    theRocket->pOriginLon = (int32_t)GetBits(&theReader, 32) ;
+    theRocket->pTemperatureC10 = (int16_t)(GetBits(&theReader, 8) * 5) - 400 ;
+    theRocket->pSatellites = (uint8_t)GetBits(&theReader, 5) ;
+    theRocket->pGpsSpeedCmps = (int16_t)(GetBits(&theReader, 9) * 100) ;
+    theRocket->pGpsHeadingDeg10 = (uint16_t)(GetBits(&theReader, 8) * 3600 / 256) ;
+    theRocket->pOriginValid = true ;
+  }
+
+  outPacket->pTemperatureC10 = theRocket->pTemperatureC10 ;
+  outPacket->pGpsSatellites = theRocket->pSatellites ;
+  outPacket->pGpsSpeedCmps = theRocket->pGpsSpeedCmps ;
+  outPacket->pGpsHeadingDeg10 = theRocket->pGpsHeadingDeg10 ;
+
+  // Position only against the origin it was measured from
+  if ((theSections & kCompactHasGps) && theRocket->pOriginValid &&
+      theRocket->pOriginEpoch == theGpsEpoch)
+  {
+    outPacket->pGpsLatitude = theRocket->pOriginLat + theDeltaLat * 10 ;
+    outPacket->pGpsLongitude = theRocket->pOriginLon + theDeltaLon * 10 ;
+  }
+  else
+  {
+    theFlags &= ~kFlagGpsFix ;
+  }
+
+  outPacket->pState = theState ;
+  outPacket->pFlags = theFlags ;
+
+  return true ;
+}
+
+//----------------------------------------------
+// Function: GatewayProtocol_GetTelemetrySource
+// Compact frames carry the rocket ID in the 4 bits
+// after the magic byte, then the sequence byte;
+// full, batch and recovery frames have ID then
+// sequence from byte 2. The event trailer mark
+// is ignored, so frames read the same as sent.
+//----------------------------------------------
+bool GatewayProtocol_GetTelemetrySource(
+  const uint8_t * inData,
+  int inLen,
+  uint8_t * outRocketId,
+  uint8_t * outSequence)
+{
+  if (inData == NULL || outRocketId == NULL || outSequence == NULL) return false ;
+
+  if (inLen >= kCompactTelemetryMinLen &&
+      (inData[0] == kLoRaMagicCompact || inData[0] == kLoRaMagicCompactEvent))
+  {
+    *outRocketId = inData[1] & 0x0F ;
+    *outSequence = (uint8_t)((inData[1] >> 4) | (inData[2] << 4)) ;
+    return true ;
+  }
+
+  uint8_t theType = (inLen >= 2) ? (uint8_t)(inData[1] & ~kLoRaPacketEventFlag) : 0 ;
+  if (inLen >= 5 && inData[0] == kLoRaMagic &&
+      (theType == kLoRaPacketTelemetry || theType == kLoRaPacketTelemetryBatch ||
+       theType == kLoRaPacketRecovery))
+  {
+    *outRocketId = inData[2] ;
+    *outSequence = inData[3] ;
+    return true ;
+  }
+
+  return false ;
+}
+
+//----------------------------------------------
+// Function: GatewayProtocol_GetTelemetryFlags
+// Compact frames carry the flags in the 8 bits
+// after the state (bit 23 on); full frames at
+// byte 53; batch and recovery frames at byte 6.
+//----------------------------------------------
+bool GatewayProtocol_GetTelemetryFlags(
+  const uint8_t * inData,
+  int inLen,
+  uint8_t * outFlags)
+{
+  if (inData == NULL || outFlags == NULL) return false ;
+
+  if (inLen >= kCompactTelemetryMinLen && inData[0] == kLoRaMagicCompact)
+  {
+    *outFlags = (uint8_t)((inData[2] >> 7) | ((inData[3] & 0x7F) << 1)) ;
+    return true ;
+  }
+
+  if (inLen == kLoRaTelemetryLen && inData[0] == kLoRaMagic &&
+      inData[1] == kLoRaPacketTelemetry)
+  {
+    *outFlags = LoRaProtocol_GetU8(inData, offsetof(LoRaTelemetryPacket, pFlags)) ;
+    return true ;
+  }
+
+  if (inLen >= 7 && inData[0] == kLoRaMagic &&
+      (inData[1] == kLoRaPacketTelemetryBatch || inData[1] == kLoRaPacketRecovery))
+  {
+    *outFlags = inData[6] ;
+    return true ;
+  }
+
+  return false ;
+}
+
+//----------------------------------------------
+// Function: GatewayProtocol_TakeEventTrailer
+// Only a frame its sender marked carries one; an
+// unmarked frame is never searched. A marked
+// frame loses its last kEventTrailerLen bytes
+// even when the tag or CRC is wrong, so the
+// frame's own CRC still decides whether the rest
+// is good.
+//----------------------------------------------
+bool GatewayProtocol_TakeEventTrailer(
+  uint8_t * ioData,
+  uint8_t * ioLen,
+  FlightEvent * outEvent)
+{
+  if (ioData == NULL || ioLen == NULL || outEvent == NULL) return false ;
+
+  int theLen = *ioLen ;
+  uint8_t theSourceId ;
+  uint8_t theSequence ;
+  if (!GatewayProtocol_GetTelemetrySource(ioData, theLen, &theSourceId, &theSequence)) return false ;
+  if (!LoRaProtocol_TakeEventMark(ioData, theLen)) return false ;
+  if (theLen < kEventTrailerLen) return false ;
+  *ioLen = (uint8_t)(theLen - kEventTrailerLen) ;
+
+  const uint8_t * theTrailer = &ioData[theLen - kEventTrailerLen] ;
+  if (theTrailer[14] != kEventTrailerTag || LoRaProtocol_Crc8(theTrailer, 13) != theTrailer[13])
+  {
+    return false ;
+  }
+
+  outEvent->pSequence = theTrailer[0] ;
+  outEvent->pType = theTrailer[1] ;
+  outEvent->pState = theTrailer[2] ;
+  outEvent->pTimeMs = (uint32_t)theTrailer[3] | ((uint32_t)theTrailer[4] << 8) |
+                      ((uint32_t)theTrailer[5] << 16) | ((uint32_t)theTrailer[6] << 24) ;
+  outEvent->pAltitudeDm = (int32_t)((uint32_t)theTrailer[7] | ((uint32_t)theTrailer[8] << 8) |
+                      ((uint32_t)theTrailer[9] << 16) | ((uint32_t)theTrailer[10] << 24)) ;
+  outEvent->pVelocityDms = (int16_t)(theTrailer[11] | (theTrailer[12] << 8)) ;
+  return true ;
+}
+
+//----------------------------------------------
+// Function: GatewayProtocol_EventToJson
+//----------------------------------------------
+int GatewayProtocol_EventToJson(
+  uint8_t inRocketId,
+  const FlightEvent * inEvent,
+  int16_t inRssi,
+  int8_t inSnr,
+  char * outJson,
+  int inMaxLen)
+{
+  if (inEvent == NULL || outJson == NULL || inMaxLen <= 0) return 0 ;
+
+  const char * theName = (inEvent->pType >= kEventArmed && inEvent->pType <= kEventReset) ?
+    sEventNames[inEvent->pType - kEventArmed] : "unknown" ;
+
+  JsonWriter theWriter ;
+  JsonWriter_Init(&theWriter, outJson, inMaxLen) ;
+  JsonWriter_BeginObject(&theWriter, NULL) ;
+  JsonWriter_String(&theWriter, "type", "event") ;
+  JsonWriter_Uint(&theWriter, "rocket_id", inRocketId) ;
+  JsonWriter_Uint(&theWriter, "seq", inEvent->pSequence) ;
+  JsonWriter_String(&theWriter, "event", theName) ;
+  JsonWriter_String(&theWriter, "state", GatewayProtocol_GetStateName(inEvent->pState)) ;
+  JsonWriter_Uint(&theWriter, "time_ms", inEvent->pTimeMs) ;
+  JsonWriter_Fixed(&theWriter, "alt", inEvent->pAltitudeDm, 1) ;
+  JsonWriter_Fixed(&theWriter, "vel", inEvent->pVelocityDms, 1) ;
+  JsonWriter_Int(&theWriter, "rssi", inRssi) ;
+  JsonWriter_Int(&theWriter, "snr", inSnr) ;
+  JsonWriter_EndObject(&theWriter) ;
+
+  return JsonWriter_Finish(&theWriter) ;
+}
+
+//----------------------------------------------
+// Function: GatewayProtocol_RecoveryToJson
+//----------------------------------------------
+int GatewayProtocol_RecoveryToJson(
+  const uint8_t * inPacket,
+  int inLen,
+  int16_t inRssi,
+  int8_t inSnr,
+  bool inGwGpsValid,
+  float inGwGpsLat,
+  float inGwGpsLon,
+  char * outJson,
+  int inMaxLen)
+{
+  if (inPacket == NULL || outJson == NULL || inLen != kRecoveryPacketLen || inMaxLen <= 0) return 0 ;
+  if (LoRaProtocol_Crc8(inPacket, inLen - 1) != inPacket[inLen - 1]) return 0 ;
+
+  uint16_t theSequence = inPacket[3] | (inPacket[4] << 8) ;
+  int32_t theLatitude ;
+  int32_t theLongitude ;
+  memcpy(&theLatitude, &inPacket[8], 4) ;
+  memcpy(&theLongitude, &inPacket[12], 4) ;
+  uint16_t theMaxAltitudeM = inPacket[16] | (inPacket[17] << 8) ;
+  uint16_t theLandedS = inPacket[18] | (inPacket[19] << 8) ;
+
+  JsonWriter theWriter ;
+  JsonWriter_Init(&theWriter, outJson, inMaxLen) ;
+  JsonWriter_BeginObject(&theWriter, NULL) ;
+  JsonWriter_String(&theWriter, "type", "recovery") ;
+  JsonWriter_Uint(&theWriter, "id", inPacket[2]) ;
+  JsonWriter_Uint(&theWriter, "seq", theSequence) ;
+  JsonWriter_String(&theWriter, "state", GatewayProtocol_GetStateName(inPacket[5])) ;
+  JsonWriter_Uint(&theWriter, "flags", inPacket[6]) ;
+  JsonWriter_Bool(&theWriter, "gps", (inPacket[6] & kFlagGpsFix) != 0) ;
+  JsonWriter_Uint(&theWriter, "sat", inPacket[7]) ;
+  JsonWriter_Fixed(&theWriter, "lat", theLatitude, 6) ;
+  JsonWriter_Fixed(&theWriter, "lon", theLongitude, 6) ;
+  JsonWriter_Uint(&theWriter, "max_alt", theMaxAltitudeM) ;
+  JsonWriter_Uint(&theWriter, "landed_s", theLandedS) ;
+  JsonWriter_Int(&theWriter, "rssi", inRssi) ;
+  JsonWriter_Int(&theWriter, "snr", inSnr) ;
+  JsonWriter_Bool(&theWriter, "gw_gps", inGwGpsValid) ;
+  JsonWriter_Float(&theWriter, "gw_lat", inGwGpsLat, 6) ;
+  JsonWriter_Float(&theWriter, "gw_lon", inGwGpsLon, 6) ;
+  JsonWriter_EndObject(&theWriter) ;
+
+  return JsonWriter_Finish(&theWriter) ;
+}
+
+//----------------------------------------------
+// Function: GatewayProtocol_ParseTdmaParams
+//----------------------------------------------
+void GatewayProtocol_ParseTdmaParams(
+  const char * inJson,
+  bool * ioEnabled,
+  uint16_t * outSlotMs)
+{
+  *outSlotMs = 0 ;
+  if (inJson == NULL) return ;
+
+  bool theEnabled ;
+  if (GatewayProtocol_ParseOrientationModeEnabled(inJson, &theEnabled))
+  {
+    *ioEnabled = theEnabled ;
+  }
+
+  // Find slot length: "slot_ms":N
+  const char * theSlotStart = strstr(inJson, "\"slot_ms\":") ;
+  if (theSlotStart != NULL)
+  {
+    theSlotStart += 10 ;  // Skip past "slot_ms":
+    unsigned long theSlotMs = strtoul(theSlotStart, NULL, 10) ;
+    *outSlotMs = theSlotMs > 0xFFFF ? 0xFFFF : (uint16_t)theSlotMs ;
+  }
+}
+
+//----------------------------------------------
+// Function: GatewayProtocol_ParseDataRateParams
+//----------------------------------------------
+void GatewayProtocol_ParseDataRateParams(
+  const char * inJson,
+  bool * ioAuto,
+  int * outRate,
+  int * outAttenDb,
+  bool * outReset)
+{
+  *outRate = -1 ;
+  *outAttenDb = -1 ;
+  *outReset = false ;
+  if (inJson == NULL) return ;
+
+  bool theEnabled ;
+  if (GatewayProtocol_ParseOrientationModeEnabled(inJson, &theEnabled))
+  {
+    *ioAuto = theEnabled ;
+  }
+
+  // Find fixed rate: "rate":N
+  const char * theRateStart = strstr(inJson, "\"rate\":") ;
+  if (theRateStart != NULL)
+  {
+    theRateStart += 7 ;  // Skip past "rate":
+    unsigned long theRate = strtoul(theRateStart, NULL, 10) ;
+    *outRate = theRate > 0xFF ? 0xFF : (int)theRate ;
+  }
+
+  // Find simulated path loss: "atten_db":N
+  const char * theAttenStart = strstr(inJson, "\"atten_db\":") ;
+  if (theAttenStart != NULL)
+  {
+    theAttenStart += 11 ;  // Skip past "atten_db":
+    unsigned long theAtten = strtoul(theAttenStart, NULL, 10) ;
+    *outAttenDb = theAtten > 0xFF ? 0xFF : (int)theAtten ;
+  }
+
+  *outReset = strstr(inJson, "\"reset\":true") != NULL ;
+}
+
+//----------------------------------------------
+// Function: GatewayProtocol_ParseAckParams
+//----------------------------------------------
+void GatewayProtocol_ParseAckParams(
+  const char * inJson,
+  int * outIntervalMs,
+  bool * outNow)
+{
+  *outIntervalMs = -1 ;
+  *outNow = false ;
+  if (inJson == NULL) return ;
+
+  // Find interval: "interval_ms":N
+  const char * theIntervalStart = strstr(inJson, "\"interval_ms\":") ;
+  if (theIntervalStart != NULL)
+  {
+    theIntervalStart += 14 ;  // Skip past "interval_ms":
+    unsigned long theInterval = strtoul(theIntervalStart, NULL, 10) ;
+    *outIntervalMs = theInterval > 0xFFFF ? 0xFFFF : (int)theInterval ;
+  }
+
+  *outNow = strstr(inJson, "\"now\":true") != NULL ;
+}
+
+//----------------------------------------------
+// Function: GatewayProtocol_ParseFecParams
+//----------------------------------------------
+int GatewayProtocol_ParseFecParams(const char * inJson)
+{
+  if (inJson == NULL) return -1 ;
+
+  // Find group size: "group":N
+  const char * theGroupStart = strstr(inJson, "\"group\":") ;
+  if (theGroupStart == NULL) return -1 ;
+
+  theGroupStart += 8 ;  // Skip past "group":
+  unsigned long theGroup = strtoul(theGroupStart, NULL, 10) ;
+  return theGroup > 0xFF ? 0xFF : (int)theGroup ;
+}
+
+//----------------------------------------------
+// Function: GatewayProtocol_BuildFecCommand
+//----------------------------------------------
+int GatewayProtocol_BuildFecCommand(
+  uint8_t inTargetRocketId,
+  uint8_t inGroup,
+  uint8_t * outPacket,
+  int inMaxLen)
+{
+  if (outPacket == NULL || inMaxLen < 5) return 0 ;
+
+  outPacket[0] = kLoRaMagic ;
+  outPacket[1] = kLoRaPacketCommand ;
+  outPacket[2] = inTargetRocketId ;
+  outPacket[3] = kCmdFec ;
+  outPacket[4] = inGroup ;
+
+  return 5 ;
+}
+
+//----------------------------------------------
+// Function: GatewayProtocol_ParseTelemetryProfileParams
+//----------------------------------------------
+bool GatewayProtocol_ParseTelemetryProfileParams(
+  const char * inJson,
+  uint8_t * outProfile,
+  uint16_t * outIntervalMs)
+{
+  if (inJson == NULL || outProfile == NULL || outIntervalMs == NULL) return false ;
+
+  *outProfile = kTelemetryProfileDefaults ;
+  *outIntervalMs = 0 ;
+  if (strstr(inJson, "\"defaults\":true") != NULL) return true ;
+
+  // Find profile: "profile":N
+  const char * theProfileStart = strstr(inJson, "\"profile\":") ;
+  if (theProfileStart == NULL) return false ;
+  theProfileStart += 10 ;  // Skip past "profile":
+  unsigned long theProfile = strtoul(theProfileStart, NULL, 10) ;
+  if (theProfile >= kTelemetryProfileCount) return false ;
+
+  // Find interval: "interval_ms":N
+  const char * theIntervalStart = strstr(inJson, "\"interval_ms\":") ;
+  if (theIntervalStart == NULL) return false ;
+  theIntervalStart += 14 ;  // Skip past "interval_ms":
+  unsigned long theInterval = strtoul(theIntervalStart, NULL, 10) ;
+  if (theInterval > 0xFFFF) return false ;
+
+  *outProfile = (uint8_t)theProfile ;
+  *outIntervalMs = (uint16_t)theInterval ;
+  return true ;
+}
+
+//----------------------------------------------
+// Function: GatewayProtocol_BuildTelemetryProfileCommand
+//----------------------------------------------
+int GatewayProtocol_BuildTelemetryProfileCommand(
+  uint8_t inTargetRocketId,
+  uint8_t inProfile,
+  uint16_t inIntervalMs,
+  uint8_t * outPacket,
+  int inMaxLen)
+{
+  if (outPacket == NULL || inMaxLen < 7) return 0 ;
+
+  outPacket[0] = kLoRaMagic ;
+  outPacket[1] = kLoRaPacketCommand ;
+  outPacket[2] = inTargetRocketId ;
+  outPacket[3] = kCmdTelemetryProfile ;
+  outPacket[4] = inProfile ;
+  outPacket[5] = inIntervalMs & 0xFF ;
+  outPacket[6] = (inIntervalMs >> 8) & 0xFF ;
+
+  return 7 ;
+}
+
+//----------------------------------------------
+// Internal: Parse a list of numbers, "key":[a,b]
+// Returns: Entries read, 0 if the key is absent,
+//   -1 if a value is out of range or there are
+//   more than inMaxCount
+//----------------------------------------------
+static int ParseNumberList(
+  const char * inJson,
+  const char * inKey,
+  long inMin,
+  long inMax,
+  long * outValues,
+  int inMaxCount)
+{
+  const char * theStart = strstr(inJson, inKey) ;
+  if (theStart == NULL) return 0 ;
+
+  theStart += strlen(inKey) ;
+  if (*theStart != '[') return -1 ;
+  theStart++ ;
+
+  int theCount = 0 ;
+  while (*theStart != ']')
+  {
+    char * theEnd ;
+    long theValue = strtol(theStart, &theEnd, 10) ;
+    if (theEnd == theStart || theValue < inMin || theValue > inMax || theCount >= inMaxCount)
+    {
+      return -1 ;
+    }
+    outValues[theCount++] = theValue ;
+
+    theStart = theEnd ;
+    if (*theStart == ',') theStart++ ;
+  }
+
+  return theCount ;
+}
+
+//----------------------------------------------
+// Function: GatewayProtocol_ParseBenchmarkParams
+//----------------------------------------------
+bool GatewayProtocol_ParseBenchmarkParams(
+  const char * inJson,
+  uint8_t inSession,
+  uint8_t * outParams)
+{
+  if (inJson == NULL || outParams == NULL) return false ;
+
+  memset(outParams, 0, kBenchParamsLen) ;
+  outParams[0] = inSession ;
+
+  long theValues[kLoRaDataRateCount] ;
+  int theCount = ParseNumberList(inJson, "\"rates\":", 0, kLoRaDataRateCount - 1, theValues, kLoRaDataRateCount) ;
+  if (theCount < 0) return false ;
+  outParams[1] = (theCount == 0) ? (1 << kLoRaDataRateCount) - 1 : 0 ;
+  for (int i = 0 ; i < theCount ; i++)
+  {
+    outParams[1] |= 1 << theValues[i] ;
+  }
+
+  theCount = ParseNumberList(inJson, "\"cr\":", 5, 8, theValues, 4) ;
+  if (theCount < 0) return false ;
+  outParams[2] = (theCount == 0) ? 0x01 : 0 ;
+  for (int i = 0 ; i < theCount ; i++)
+  {
+    outParams[2] |= 1 << (theValues[i] - 5) ;
+  }
+
+  outParams[3] = 20 ;
+  const char * theFramesStart = strstr(inJson, "\"frames\":") ;
+  if (theFramesStart != NULL)
+  {
+    theFramesStart += 9 ;  // Skip past "frames":
+    unsigned long theFrames = strtoul(theFramesStart, NULL, 10) ;
+    if (theFrames == 0 || theFrames > kBenchMaxFrames) return false ;
+    outParams[3] = (uint8_t)theFrames ;
+  }
+
+  theCount = ParseNumberList(inJson, "\"power\":", 2, 20, theValues, kBenchMaxChoices) ;
+  if (theCount < 0) return false ;
+  for (int i = 0 ; i < theCount ; i++)
+  {
+    outParams[4 + i] = (uint8_t)(int8_t)theValues[i] ;
+  }
+
+  theCount = ParseNumberList(inJson, "\"len\":", kBenchMinLen, kLoRaMaxPacketLen, theValues, kBenchMaxChoices) ;
+  if (theCount < 0) return false ;
+  if (theCount == 0)
+  {
+    outParams[4 + kBenchMaxChoices] = 16 ;
+    outParams[5 + kBenchMaxChoices] = 64 ;
+    outParams[6 + kBenchMaxChoices] = 200 ;
+  }
+  for (int i = 0 ; i < theCount ; i++)
+  {
+    outParams[4 + kBenchMaxChoices + i] = (uint8_t)theValues[i] ;
+  }
+
+  return true ;
+}
+
+//----------------------------------------------
+// Function: GatewayProtocol_BuildBenchmarkCommand
+//----------------------------------------------
+int GatewayProtocol_BuildBenchmarkCommand(
+  uint8_t inTargetRocketId,
+  const uint8_t * inParams,
+  uint8_t * outPacket,
+  int inMaxLen)
+{
+  if (outPacket == NULL || inParams == NULL || inMaxLen < kBenchCommandLen) return 0 ;
+
+  outPacket[0] = kLoRaMagic ;
+  outPacket[1] = kLoRaPacketCommand ;
+  outPacket[2] = inTargetRocketId ;
+  outPacket[3] = kCmdBenchmark ;
+  memcpy(&outPacket[4], inParams, kBenchParamsLen) ;
+
+  return kBenchCommandLen ;
+}
+
+//----------------------------------------------
+// Function: GatewayProtocol_BuildChannelPlanCommand
+//----------------------------------------------
+int GatewayProtocol_BuildChannelPlanCommand(
+  uint8_t inTargetRocketId,
+  bool inOwnChannel,
+  uint8_t * outPacket,
+  int inMaxLen)
+{
+  if (outPacket == NULL || inMaxLen < 5) return 0 ;
+
+  outPacket[0] = kLoRaMagic ;
+  outPacket[1] = kLoRaPacketCommand ;
+  outPacket[2] = inTargetRocketId ;
+  outPacket[3] = kCmdChannelPlan ;
+  outPacket[4] = inOwnChannel ? 1 : 0 ;
+
+  return 5 ;
+}
+
 //----------------------------------------------
 // Function: GatewayProtocol_ParseFlashParams
 //----------------------------------------------
@@ -817,6 +1777,30 @@ int GatewayProtocol_BuildFlashReadCommand(
   return 9 ;
 }
 
+//----------------------------------------------
+// Function: GatewayProtocol_BuildFlashBulkReadCommand
+//----------------------------------------------
+int GatewayProtocol_BuildFlashBulkReadCommand(
+  uint8_t inTargetRocketId,
+  uint8_t inSlot,
+  uint8_t inSession,
+  uint8_t inRate,
+  uint8_t * outPacket,
+  int inMaxLen)
+{
+  if (outPacket == NULL || inMaxLen < kBulkRequestLen) return 0 ;
+
+  outPacket[0] = kLoRaMagic ;
+  outPacket[1] = kLoRaPacketCommand ;
+  outPacket[2] = inTargetRocketId ;
+  outPacket[3] = kCmdFlashBulkRead ;
+  outPacket[4] = inSlot ;
+  outPacket[5] = inSession ;
+  outPacket[6] = inRate ;
+
+  return kBulkRequestLen ;
+}
+
 //----------------------------------------------
 // Function: GatewayProtocol_BuildFlashDeleteCommand
 //----------------------------------------------
@@ -846,6 +1830,7 @@ int GatewayProtocol_BuildFlashDeleteCommand(
 int GatewayProtocol_FlashListToJson(
   const uint8_t * inPacket,
   int inLen,
+  uint32_t inCommandId,
   char * outJson,
   int inMaxLen)
 {
@@ -854,9 +1839,21 @@ int GatewayProtocol_FlashListToJson(
   uint8_t theCount = inPacket[2] ;
   int theOffset = 3 ;
 
-  // Start JSON
-  int theJsonLen = snprintf(outJson, inMaxLen,
-    "{\"type\":\"flash_list\",\"count\":%u,\"flights\":[", theCount) ;
+  // Boot verification status of each flight, after
+  // the entries (newer flight firmware)
+  int theStatusOffset = 3 + theCount * 17 ;
+  bool theHasStatus = inLen >= theStatusOffset + theCount ;
+
+  JsonWriter theWriter ;
+  JsonWriter_Init(&theWriter, outJson, inMaxLen) ;
+  JsonWriter_BeginObject(&theWriter, NULL) ;
+  JsonWriter_String(&theWriter, "type", "flash_list") ;
+  if (inCommandId != 0)
+  {
+    JsonWriter_Uint(&theWriter, "id", inCommandId) ;
+  }
+  JsonWriter_Uint(&theWriter, "count", theCount) ;
+  JsonWriter_BeginArray(&theWriter, "flights") ;
 
   // Parse each flight entry (17 bytes each)
   for (uint8_t i = 0 ; i < theCount && theOffset + 17 <= inLen ; i++)
@@ -887,21 +1884,27 @@ int GatewayProtocol_FlashListToJson(
                               (inPacket[theOffset + 3] << 24) ;
     theOffset += 4 ;
 
-    // Add flight entry to JSON
-    if (i > 0) theJsonLen += snprintf(outJson + theJsonLen, inMaxLen - theJsonLen, ",") ;
-    theJsonLen += snprintf(outJson + theJsonLen, inMaxLen - theJsonLen,
-      "{\"slot\":%u,\"id\":%lu,\"alt\":%.1f,\"time\":%lu,\"samples\":%lu}",
-      theSlot,
-      (unsigned long)theFlightId,
-      theMaxAltCm / 100.0f,
-      (unsigned long)theFlightTimeMs,
-      (unsigned long)theSampleCount) ;
+    // Add flight entry to JSON (altitude to 0.1 m)
+    JsonWriter_BeginObject(&theWriter, NULL) ;
+    JsonWriter_Uint(&theWriter, "slot", theSlot) ;
+    JsonWriter_Uint(&theWriter, "id", theFlightId) ;
+    JsonWriter_Fixed(&theWriter, "alt", (theMaxAltCm + (theMaxAltCm < 0 ? -5 : 5)) / 10, 1) ;
+    JsonWriter_Uint(&theWriter, "time", theFlightTimeMs) ;
+    JsonWriter_Uint(&theWriter, "samples", theSampleCount) ;
+    if (theHasStatus)
+    {
+      uint8_t theStatus = inPacket[theStatusOffset + i] ;
+      JsonWriter_String(&theWriter, "status",
+        theStatus < sizeof(sSlotStatusNames) / sizeof(sSlotStatusNames[0]) ?
+        sSlotStatusNames[theStatus] : "unknown") ;
+    }
+    JsonWriter_EndObject(&theWriter) ;
   }
 
-  // Close JSON
-  theJsonLen += snprintf(outJson + theJsonLen, inMaxLen - theJsonLen, "]}\n") ;
+  JsonWriter_EndArray(&theWriter) ;
+  JsonWriter_EndObject(&theWriter) ;
 
-  return theJsonLen ;
+  return JsonWriter_Finish(&theWriter) ;
 }
 
 //----------------------------------------------
@@ -913,6 +1916,7 @@ int GatewayProtocol_FlashListToJson(
 int GatewayProtocol_FlashDataToJson(
   const uint8_t * inPacket,
   int inLen,
+  uint32_t inCommandId,
   char * outJson,
   int inMaxLen)
 {
@@ -932,48 +1936,43 @@ int GatewayProtocol_FlashDataToJson(
 
   uint8_t theSampleCount = inPacket[11] ;
 
+  JsonWriter theWriter ;
+  JsonWriter_Init(&theWriter, outJson, inMaxLen) ;
+
   // Check if this is a header packet (startSample == 0xFFFFFFFF)
   if (theStartSample == 0xFFFFFFFF)
   {
     // Header packet - data is FlightHeader structure (80 bytes)
     // For simplicity, encode the raw header as hex
-    int theJsonLen = snprintf(outJson, inMaxLen,
-      "{\"type\":\"flash_header\",\"slot\":%u,\"data\":\"",
-      theSlot) ;
-
-    int theDataLen = inLen - 7 ;  // After magic, type, slot, startSample marker
-    const uint8_t * theData = &inPacket[7] ;
-
-    for (int i = 0 ; i < theDataLen && theJsonLen < inMaxLen - 10 ; i++)
+    // (after magic, type, slot, startSample marker)
+    JsonWriter_BeginObject(&theWriter, NULL) ;
+    JsonWriter_String(&theWriter, "type", "flash_header") ;
+    if (inCommandId != 0)
     {
-      theJsonLen += snprintf(outJson + theJsonLen, inMaxLen - theJsonLen, "%02X", theData[i]) ;
+      JsonWriter_Uint(&theWriter, "id", inCommandId) ;
     }
-
-    theJsonLen += snprintf(outJson + theJsonLen, inMaxLen - theJsonLen, "\"}\n") ;
-    return theJsonLen ;
+    JsonWriter_Uint(&theWriter, "slot", theSlot) ;
+    JsonWriter_Hex(&theWriter, "data", &inPacket[7], inLen - 7) ;
+    JsonWriter_EndObject(&theWriter) ;
+    return JsonWriter_Finish(&theWriter) ;
   }
 
-  // Sample data packet - encode samples as hex for transport
-  int theJsonLen = snprintf(outJson, inMaxLen,
-    "{\"type\":\"flash_data\",\"slot\":%u,\"start\":%lu,\"total\":%lu,\"count\":%u,\"data\":\"",
-    theSlot,
-    (unsigned long)theStartSample,
-    (unsigned long)theTotalSamples,
-    theSampleCount) ;
-
-  // Encode sample data as hex
-  int theDataOffset = 12 ;  // After header
-  int theDataLen = inLen - theDataOffset ;
-  const uint8_t * theData = &inPacket[theDataOffset] ;
-
-  for (int i = 0 ; i < theDataLen && theJsonLen < inMaxLen - 10 ; i++)
+  // Sample data packet - encode samples (after the
+  // 12-byte header) as hex for transport
+  JsonWriter_BeginObject(&theWriter, NULL) ;
+  JsonWriter_String(&theWriter, "type", "flash_data") ;
+  if (inCommandId != 0)
   {
-    theJsonLen += snprintf(outJson + theJsonLen, inMaxLen - theJsonLen, "%02X", theData[i]) ;
+    JsonWriter_Uint(&theWriter, "id", inCommandId) ;
   }
-
-  theJsonLen += snprintf(outJson + theJsonLen, inMaxLen - theJsonLen, "\"}\n") ;
-
-  return theJsonLen ;
+  JsonWriter_Uint(&theWriter, "slot", theSlot) ;
+  JsonWriter_Uint(&theWriter, "start", theStartSample) ;
+  JsonWriter_Uint(&theWriter, "total", theTotalSamples) ;
+  JsonWriter_Uint(&theWriter, "count", theSampleCount) ;
+  JsonWriter_Hex(&theWriter, "data", &inPacket[12], inLen - 12) ;
+  JsonWriter_EndObject(&theWriter) ;
+
+  return JsonWriter_Finish(&theWriter) ;
 }
 
 //----------------------------------------------
@@ -0,0 +1,321 @@
+//----------------------------------------------
+// Module: json_writer.c
+// Description: JSON message builder over a
+//   caller's buffer
+// Author: Mark Gavin
+// Created: 2026-02-16
+// Copyright: (c) 2025-2026 by Mark Gavin
+// License: Proprietary - All Rights Reserved
+//----------------------------------------------
+
+#include "json_writer.h"
+
+#include <string.h>
+
+//----------------------------------------------
+// Constants
+//----------------------------------------------
+#define kJsonReserve            2       // Newline and NUL added by Finish
+
+static const char sHexDigits[] = "0123456789ABCDEF" ;
+
+static const uint32_t sPowersOf10[] =
+{
+  1, 10, 100, 1000, 10000, 100000, 1000000, 10000000, 100000000, 1000000000
+} ;
+
+//----------------------------------------------
+// Internal: Room
+// Whether inCount more characters fit
+//----------------------------------------------
+static bool Room(JsonWriter * ioWriter, int inCount)
+{
+  if (ioWriter->pOverflow || ioWriter->pLen + inCount > ioWriter->pMaxLen - kJsonReserve)
+  {
+    ioWriter->pOverflow = true ;
+    return false ;
+  }
+  return true ;
+}
+
+//----------------------------------------------
+// Internal: PutChar
+//----------------------------------------------
+static void PutChar(JsonWriter * ioWriter, char inChar)
+{
+  if (Room(ioWriter, 1))
+  {
+    ioWriter->pBuffer[ioWriter->pLen++] = inChar ;
+  }
+}
+
+//----------------------------------------------
+// Internal: PutText
+//----------------------------------------------
+static void PutText(JsonWriter * ioWriter, const char * inText)
+{
+  int theLen = (int)strlen(inText) ;
+  if (Room(ioWriter, theLen))
+  {
+    memcpy(&ioWriter->pBuffer[ioWriter->pLen], inText, theLen) ;
+    ioWriter->pLen += theLen ;
+  }
+}
+
+//----------------------------------------------
+// Internal: PutDigits
+// inValue in decimal, at least inMinDigits long
+// (zero-padded)
+//----------------------------------------------
+static void PutDigits(JsonWriter * ioWriter, uint32_t inValue, uint8_t inMinDigits)
+{
+  char theDigits[10] ;
+  int theCount = 0 ;
+  do
+  {
+    theDigits[theCount++] = (char)('0' + inValue % 10) ;
+    inValue /= 10 ;
+  } while (inValue != 0) ;
+  while (theCount < inMinDigits)
+  {
+    theDigits[theCount++] = '0' ;
+  }
+
+  if (Room(ioWriter, theCount))
+  {
+    while (theCount > 0)
+    {
+      ioWriter->pBuffer[ioWriter->pLen++] = theDigits[--theCount] ;
+    }
+  }
+}
+
+//----------------------------------------------
+// Internal: PutKey
+// Comma if needed, then "key": unless in an array
+//----------------------------------------------
+static void PutKey(JsonWriter * ioWriter, const char * inKey)
+{
+  if (!ioWriter->pFirst)
+  {
+    PutChar(ioWriter, ',') ;
+  }
+  ioWriter->pFirst = false ;
+
+  if (inKey != NULL)
+  {
+    PutChar(ioWriter, '"') ;
+    PutText(ioWriter, inKey) ;
+    PutText(ioWriter, "\":") ;
+  }
+}
+
+//----------------------------------------------
+// Function: JsonWriter_Init
+//----------------------------------------------
+void JsonWriter_Init(JsonWriter * outWriter, char * outBuffer, int inMaxLen)
+{
+  outWriter->pBuffer = outBuffer ;
+  outWriter->pMaxLen = inMaxLen ;
+  outWriter->pLen = 0 ;
+  outWriter->pFirst = true ;
+  outWriter->pOverflow = outBuffer == NULL || inMaxLen < kJsonReserve ;
+}
+
+//----------------------------------------------
+// Function: JsonWriter_BeginObject
+//----------------------------------------------
+void JsonWriter_BeginObject(JsonWriter * ioWriter, const char * inKey)
+{
+  PutKey(ioWriter, inKey) ;
+  PutChar(ioWriter, '{') ;
+  ioWriter->pFirst = true ;
+}
+
+//----------------------------------------------
+// Function: JsonWriter_EndObject
+//----------------------------------------------
+void JsonWriter_EndObject(JsonWriter * ioWriter)
+{
+  PutChar(ioWriter, '}') ;
+  ioWriter->pFirst = false ;
+}
+
+//----------------------------------------------
+// Function: JsonWriter_BeginArray
+//----------------------------------------------
+void JsonWriter_BeginArray(JsonWriter * ioWriter, const char * inKey)
+{
+  PutKey(ioWriter, inKey) ;
+  PutChar(ioWriter, '[') ;
+  ioWriter->pFirst = true ;
+}
+
+//----------------------------------------------
+// Function: JsonWriter_EndArray
+//----------------------------------------------
+void JsonWriter_EndArray(JsonWriter * ioWriter)
+{
+  PutChar(ioWriter, ']') ;
+  ioWriter->pFirst = false ;
+}
+
+//----------------------------------------------
+// Function: JsonWriter_String
+//----------------------------------------------
+void JsonWriter_String(JsonWriter * ioWriter, const char * inKey, const char * inValue)
+{
+  PutKey(ioWriter, inKey) ;
+  PutChar(ioWriter, '"') ;
+  for (const char * theChar = inValue ; *theChar != '\0' ; theChar++)
+  {
+    uint8_t theByte = (uint8_t)*theChar ;
+    if (theByte == '"' || theByte == '\\')
+    {
+      PutChar(ioWriter, '\\') ;
+      PutChar(ioWriter, (char)theByte) ;
+    }
+    else if (theByte < 0x20)
+    {
+      PutText(ioWriter, "\\u00") ;
+      PutChar(ioWriter, sHexDigits[theByte >> 4]) ;
+      PutChar(ioWriter, sHexDigits[theByte & 0x0F]) ;
+    }
+    else
+    {
+      PutChar(ioWriter, (char)theByte) ;
+    }
+  }
+  PutChar(ioWriter, '"') ;
+}
+
+//----------------------------------------------
+// Function: JsonWriter_Bool
+//----------------------------------------------
+void JsonWriter_Bool(JsonWriter * ioWriter, const char * inKey, bool inValue)
+{
+  PutKey(ioWriter, inKey) ;
+  PutText(ioWriter, inValue ? "true" : "false") ;
+}
+
+//----------------------------------------------
+// Function: JsonWriter_Int
+//----------------------------------------------
+void JsonWriter_Int(JsonWriter * ioWriter, const char * inKey, int32_t inValue)
+{
+  JsonWriter_Fixed(ioWriter, inKey, inValue, 0) ;
+}
+
+//----------------------------------------------
+// Function: JsonWriter_Uint
+//----------------------------------------------
+void JsonWriter_Uint(JsonWriter * ioWriter, const char * inKey, uint32_t inValue)
+{
+  PutKey(ioWriter, inKey) ;
+  PutDigits(ioWriter, inValue, 1) ;
+}
+
+//----------------------------------------------
+// Function: JsonWriter_Fixed
+//----------------------------------------------
+void JsonWriter_Fixed(JsonWriter * ioWriter, const char * inKey, int32_t inValue, uint8_t inDecimals)
+{
+  if (inDecimals > 9)
+  {
+    inDecimals = 9 ;
+  }
+
+  PutKey(ioWriter, inKey) ;
+
+  // Magnitude as unsigned, so INT32_MIN is whole
+  uint32_t theMagnitude = (uint32_t)inValue ;
+  if (inValue < 0)
+  {
+    PutChar(ioWriter, '-') ;
+    theMagnitude = 0u - theMagnitude ;
+  }
+
+  if (inDecimals == 0)
+  {
+    PutDigits(ioWriter, theMagnitude, 1) ;
+    return ;
+  }
+
+  uint32_t theScale = sPowersOf10[inDecimals] ;
+  PutDigits(ioWriter, theMagnitude / theScale, 1) ;
+  PutChar(ioWriter, '.') ;
+  PutDigits(ioWriter, theMagnitude % theScale, inDecimals) ;
+}
+
+//----------------------------------------------
+// Function: JsonWriter_Float
+//----------------------------------------------
+void JsonWriter_Float(JsonWriter * ioWriter, const char * inKey, float inValue, uint8_t inDecimals)
+{
+  if (inDecimals > 9)
+  {
+    inDecimals = 9 ;
+  }
+
+  // Compared as floats first: the cast is only
+  // defined in range (NaN fails both and clamps low)
+  float theScaled = inValue * (float)sPowersOf10[inDecimals] ;
+  theScaled += theScaled < 0.0f ? -0.5f : 0.5f ;
+  int32_t theValue ;
+  if (theScaled >= 2147483520.0f)
+  {
+    theValue = INT32_MAX ;
+  }
+  else if (theScaled > -2147483520.0f)
+  {
+    theValue = (int32_t)theScaled ;
+  }
+  else
+  {
+    theValue = INT32_MIN ;
+  }
+
+  JsonWriter_Fixed(ioWriter, inKey, theValue, inDecimals) ;
+}
+
+//----------------------------------------------
+// Function: JsonWriter_Hex
+//----------------------------------------------
+void JsonWriter_Hex(JsonWriter * ioWriter, const char * inKey, const uint8_t * inData, int inLen)
+{
+  PutKey(ioWriter, inKey) ;
+  PutChar(ioWriter, '"') ;
+  if (inLen > 0 && Room(ioWriter, inLen * 2))
+  {
+    char * theOut = &ioWriter->pBuffer[ioWriter->pLen] ;
+    for (int i = 0 ; i < inLen ; i++)
+    {
+      *theOut++ = sHexDigits[inData[i] >> 4] ;
+      *theOut++ = sHexDigits[inData[i] & 0x0F] ;
+    }
+    ioWriter->pLen += inLen * 2 ;
+  }
+  PutChar(ioWriter, '"') ;
+}
+
+//----------------------------------------------
+// Function: JsonWriter_Finish
+//----------------------------------------------
+int JsonWriter_Finish(JsonWriter * ioWriter)
+{
+  if (ioWriter->pBuffer == NULL || ioWriter->pMaxLen <= 0)
+  {
+    return 0 ;
+  }
+
+  if (ioWriter->pOverflow)
+  {
+    ioWriter->pBuffer[ioWriter->pLen < ioWriter->pMaxLen ? ioWriter->pLen : 0] = '\0' ;
+    return 0 ;
+  }
+
+  // Room for both was held back from the start
+  ioWriter->pBuffer[ioWriter->pLen++] = '\n' ;
+  ioWriter->pBuffer[ioWriter->pLen] = '\0' ;
+  return ioWriter->pLen ;
+}
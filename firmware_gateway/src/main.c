@@ -5,6 +5,25 @@
 // Author: Mark Gavin
 // Created: 2026-01-10
 // Modified: 2026-01-13 (Switched to OLED display)
+// Modified: 2026-02-12 (TDMA beacon and slot schedule)
+// Modified: 2026-02-13 (bulk flash download)
+// Modified: 2026-02-14 (adaptive data rate)
+// Modified: 2026-02-14 (aggregated ACK summary)
+// Modified: 2026-02-14 (telemetry FEC recovery)
+// Modified: 2026-02-15 (multi-channel frequency plan)
+// Modified: 2026-02-15 (commands released into receive windows)
+// Modified: 2026-02-15 (listen before talk, link collision counts)
+// Modified: 2026-02-15 (flight events and their ACKs)
+// Modified: 2026-02-15 (command request IDs, retries and replies)
+// Modified: 2026-02-15 (recovery beacon, telemetry_profile command)
+// Modified: 2026-02-15 (downlink queueing delay in fc_info)
+// Modified: 2026-02-15 (link benchmark)
+// Modified: 2026-02-15 (rocket ID from full telemetry frames)
+// Modified: 2026-02-15 (binary output per client)
+// Modified: 2026-02-16 (host ID on fc_info and flash responses)
+// Modified: 2026-02-16 (rocket radio SPI times in fc_info)
+// Modified: 2026-02-16 (flight verification time in fc_info)
+// Modified: 2026-02-16 (SD card rates in fc_info)
 // Copyright: (c) 2025-2026 by Mark Gavin
 // License: Proprietary - All Rights Reserved
 //
@@ -19,6 +38,15 @@
 #include "lora_radio.h"
 #include "gateway_protocol.h"
 #include "gateway_display.h"
+#include "tdma_scheduler.h"
+#include "bulk_download.h"
+#include "rate_control.h"
+#include "ack_summary.h"
+#include "fec_decoder.h"
+#include "channel_plan.h"
+#include "command_queue.h"
+#include "bench_receiver.h"
+#include "gateway_stream.h"
 #include "bmp390.h"
 #include "bmp581.h"
 #include "neopixel.h"
@@ -68,20 +96,30 @@
 
 //----------------------------------------------
 // Output Helper (USB + optional WiFi)
+// Each client takes JSON lines or binary records
+// (gateway_stream.h); binary clients get JSON as
+// text records
 //----------------------------------------------
-#if kEnableWifi
-  // Forward declaration - implemented at end of file
-  static void OutputToAll(const char * inJson) ;
-  #define OUTPUT_JSON(json) OutputToAll(json)
-#else
-  #define OUTPUT_JSON(json) do { printf("%s", json); stdio_flush(); } while(0)
-#endif
+#define OUTPUT_JSON(json) OutputToAll(json)
 
 //----------------------------------------------
 // Module State
 //----------------------------------------------
 static LoRa_Radio sLoRaRadio ;
 static GatewayState sGatewayState ;
+static TdmaScheduler sTdma ;
+static BulkDownload sBulk ;
+static uint8_t sBulkSession = 0 ;
+static RateControl sRate ;
+static AckSummary sAck ;
+static FecDecoder sFec ;
+static ChannelPlan sChannels ;
+static CommandQueue sCommands ;
+static BenchReceiver sBench ;
+static uint8_t sBenchSession = 0 ;
+static LoRa_CodingRate sBenchCodingRate ;  // Restored after a benchmark
+static bool sRateAnnounce = false ;       // Radio at base rate for an announce
+static uint16_t sTdmaBaseSlotMs = kTdmaSlotMs ;  // Slot length at the base rate
 static BMP390 sBmp390 ;
 static BMP581 sBmp581 ;
 static bool sLoRaOk = false ;
@@ -117,6 +155,11 @@ static uint32_t sButtonCLastMs = 0 ;
 static char sUsbLineBuffer[kUsbLineBufferSize] ;
 static int sUsbLinePos = 0 ;
 
+// Host output format (output command); one frame
+// buffer holds the largest JSON as a text record
+static bool sUsbBinary = false ;
+static uint8_t sStreamFrame[GATEWAY_STREAM_FRAME_SIZE(kJsonCommandBufferSize)] ;
+
 // WiFi state (conditional)
 #if kEnableWifi
 static bool sWifiOk = false ;
@@ -124,6 +167,7 @@ static WifiMode_t sWifiMode = kWifiModeNone ;
 static int8_t sWifiServerSocket = -1 ;
 static int8_t sWifiClientSocket = -1 ;
 static bool sWifiClientConnected = false ;
+static bool sWifiBinary = false ;
 static char sWifiLineBuffer[kUsbLineBufferSize] ;
 static int sWifiLinePos = 0 ;
 #endif
@@ -136,15 +180,47 @@ static void InitializeI2C(void) ;
 static void InitializeSPI(void) ;
 static void InitializeButtons(void) ;
 static void ProcessLoRaPackets(uint32_t inCurrentMs) ;
+static void SendTelemetryAck(void) ;
+static void AckTelemetry(uint8_t inRocketId, uint8_t inSequence, uint8_t inAirLen, uint32_t inCurrentMs) ;
+static void ServiceTdma(uint32_t inCurrentMs) ;
+static void ReportTdma(uint32_t inCurrentMs) ;
+static bool StartBulkDownload(int8_t inRocketId, uint8_t inSlot, uint32_t inCommandId, uint32_t inCurrentMs) ;
+static void ServiceBulkDownload(uint32_t inCurrentMs) ;
+static void ReportBulk(const char * inStatus, uint32_t inCurrentMs) ;
+static void ServiceRateControl(uint32_t inCurrentMs) ;
+static void ApplyDataRate(uint8_t inRate) ;
+static void RetimeTdma(void) ;
+static void ReportRate(const char * inEvent, uint32_t inCurrentMs) ;
+static void ServiceAcks(uint32_t inCurrentMs) ;
+static void ReportAcks(void) ;
+static void ReportFec(uint32_t inCurrentMs) ;
+static void ServiceChannelPlan(uint32_t inCurrentMs) ;
+static void ReportChannels(uint32_t inCurrentMs) ;
+static bool SendCommand(const uint8_t * inPacket, int inLen, uint32_t inCommandId, uint32_t inCurrentMs) ;
+static bool ReleaseCommand(uint8_t inRocketId, bool inInWindow, uint32_t inCurrentMs) ;
+static void ServiceCommands(uint32_t inCurrentMs) ;
+static void ReportCommands(uint32_t inCurrentMs) ;
+static bool StartBenchmark(uint8_t inRocketId, const uint8_t * inParams, uint32_t inCurrentMs) ;
+static void ServiceBenchmark(uint32_t inCurrentMs) ;
+static void EndBenchmark(const char * inStatus, uint32_t inCurrentMs) ;
+static void UpdateLinkStats(void) ;
 static void ProcessUsbInput(uint32_t inCurrentMs) ;
 static void ProcessButtons(uint32_t inCurrentMs) ;
 static void UpdateLed(uint32_t inCurrentMs) ;
 static void UpdateDisplay(uint32_t inCurrentMs) ;
 static void ReadGroundBarometer(uint32_t inCurrentMs) ;
+static void OutputToAll(const char * inJson) ;
+static void OutputToUsb(const char * inJson) ;
+static void OutputToJsonClients(const char * inJson) ;
+static void OutputRecord(uint8_t inType, const uint8_t * inPayload, size_t inLen) ;
+static bool IsJsonWanted(void) ;
+static bool IsBinaryWanted(void) ;
+static void OutputFrameRecord(const uint8_t * inFrame, uint8_t inLen) ;
+static void SetOutputFormat(const char * inLine, bool inIsWifi, uint32_t inCommandId) ;
 #if kEnableWifi
 static void ProcessWifiInput(uint32_t inCurrentMs) ;
 static void ProcessCommandLine(const char * inLine, bool inIsWifi) ;
-static void OutputToAll(const char * inJson) ;
+static void OutputToWifi(const char * inJson) ;
 #endif
 
 //----------------------------------------------
@@ -168,6 +244,12 @@ int main(void)
 
   // Initialize gateway protocol
   GatewayProtocol_Init(&sGatewayState) ;
+  TdmaScheduler_Init(&sTdma, kEnableTdma, kTdmaSlotMs, kTdmaDownlinkMs) ;
+  RateControl_Init(&sRate, to_ms_since_boot(get_absolute_time())) ;
+  AckSummary_Init(&sAck, kAckIntervalMs) ;
+  FecDecoder_Init(&sFec) ;
+  ChannelPlan_Init(&sChannels, kEnableChannelPlan) ;
+  CommandQueue_Init(&sCommands) ;
 
   // Print startup status
   printf("Gateway ready:\n") ;
@@ -199,8 +281,23 @@ int main(void)
     printf("  WiFi Port: %d\n", kWifiServerPort) ;
   }
 #endif
+  if (sLoRaOk)
+  {
+    printf("  LoRa SPI: %lu us per 255B FIFO burst (%lu us at 1 MHz)\n",
+      (unsigned long)sLoRaRadio.pSpiBurstUs, (unsigned long)sLoRaRadio.pSpiBaselineUs) ;
+  }
   printf("  Frequency: %lu Hz\n", (unsigned long)kLoRaFrequency) ;
   printf("  Sync Word: 0x%02X\n", kLoRaSyncWord) ;
+  printf("  Channel Plan: %s (%u channels, %lu kHz apart)\n", sChannels.pEnabled ? "ON" : "OFF",
+    kLoRaChannelCount, (unsigned long)(kLoRaChannelSpacingHz / 1000)) ;
+  printf("  Listen Before Talk: %s\n", sLoRaRadio.pListenBeforeTalk ? "ON" : "OFF") ;
+  printf("  TDMA: %s (%u ms slots)\n", sTdma.pEnabled ? "ON" : "OFF", sTdma.pSlotMs) ;
+  printf("  Data Rate: %s (rate %u, SF%u)\n", sRate.pAuto ? "AUTO" : "FIXED",
+    sRate.pRate, LoRa_GetDataRate(sRate.pRate)->pSpreadFactor) ;
+  if (sAck.pIntervalMs != 0)
+    printf("  ACKs: summary every %u ms\n", sAck.pIntervalMs) ;
+  else
+    printf("  ACKs: every frame\n") ;
   printf("\nListening for telemetry...\n\n") ;
 
   // Show splash screen, then device info
@@ -232,10 +329,24 @@ int main(void)
   {
     uint32_t theCurrentMs = to_ms_since_boot(get_absolute_time()) ;
 
-    // Process incoming LoRa packets
+    // Service radio events (DIO0), then process incoming LoRa packets
     if (sLoRaOk)
     {
+      LoRa_Service(&sLoRaRadio) ;
       ProcessLoRaPackets(theCurrentMs) ;
+      ServiceTdma(theCurrentMs) ;
+      ServiceBulkDownload(theCurrentMs) ;
+      ServiceBenchmark(theCurrentMs) ;
+      ServiceChannelPlan(theCurrentMs) ;
+      ServiceRateControl(theCurrentMs) ;
+      ServiceCommands(theCurrentMs) ;
+      ServiceAcks(theCurrentMs) ;
+      UpdateLinkStats() ;
+
+      if (FecDecoder_IsStatsDue(&sFec, theCurrentMs))
+      {
+        ReportFec(theCurrentMs) ;
+      }
     }
 
     // Read ground barometer
@@ -267,10 +378,10 @@ int main(void)
         {
           sWifiClientSocket = theClient ;
           sWifiClientConnected = true ;
+          sWifiBinary = false ;
           sWifiLinePos = 0 ;
-          printf("{\"type\":\"link\",\"status\":\"wifi_connected\"}\n") ;
-          stdio_flush() ;
-          printf("WiFi: Client connected on socket %d\n", theClient) ;
+          OutputToUsb("{\"type\":\"link\",\"status\":\"wifi_connected\"}\n") ;
+          DEBUG_PRINT("WiFi: Client connected on socket %d\n", theClient) ;
         }
       }
       else
@@ -280,9 +391,9 @@ int main(void)
         {
           sWifiClientConnected = false ;
           sWifiClientSocket = -1 ;
+          sWifiBinary = false ;
           sWifiLinePos = 0 ;
-          printf("{\"type\":\"link\",\"status\":\"wifi_disconnected\"}\n") ;
-          stdio_flush() ;
+          OutputToUsb("{\"type\":\"link\",\"status\":\"wifi_disconnected\"}\n") ;
           DEBUG_PRINT("WiFi: Client disconnected\n") ;
         }
         else
@@ -315,8 +426,7 @@ int main(void)
       if ((theCurrentMs - sGatewayState.pLastPacketTimeMs) > kLinkTimeoutMs)
       {
         sGatewayState.pConnected = false ;
-        printf("{\"type\":\"link\",\"status\":\"lost\"}\n") ;
-        stdio_flush() ;
+        OutputToUsb("{\"type\":\"link\",\"status\":\"lost\"}\n") ;
 
         // Update display
         if (sDisplayOk)
@@ -401,8 +511,8 @@ static void InitializeHardware(void)
   {
     // Configure to match flight computer
     LoRa_SetFrequency(&sLoRaRadio, kLoRaFrequency) ;
-    LoRa_SetSpreadingFactor(&sLoRaRadio, kLoRaSpreadFactor) ;
-    LoRa_SetBandwidth(&sLoRaRadio, LORA_BW_125) ;
+    LoRa_SetTxFrequency(&sLoRaRadio, kLoRaFrequency) ;  // Always on the control channel
+    LoRa_SetDataRate(&sLoRaRadio, kLoRaDataRateBase) ;  // SF7, 125 kHz
     LoRa_SetCodingRate(&sLoRaRadio, LORA_CR_4_5) ;
     LoRa_SetTxPower(&sLoRaRadio, kLoRaTxPower) ;
     LoRa_SetSyncWord(&sLoRaRadio, kLoRaSyncWord) ;
@@ -686,228 +796,1228 @@ static void ReadGroundBarometer(uint32_t inCurrentMs)
 }
 
 //----------------------------------------------
-// Function: ProcessLoRaPackets
+// Function: SendTelemetryAck
+// Purpose: ACK telemetry with the signal quality
+//   it arrived at, so the flight computer knows
+//   the gateway is receiving it
 //----------------------------------------------
-static void ProcessLoRaPackets(uint32_t inCurrentMs)
+static void SendTelemetryAck(void)
 {
-  uint8_t theBuffer[kLoRaPacketMaxSize] ;
-  uint8_t theLen = LoRa_Receive(&sLoRaRadio, theBuffer, sizeof(theBuffer)) ;
-
-  if (theLen == 0) return ;
+  uint8_t theAckPacket[5] ;
+  theAckPacket[0] = kLoRaMagic ;
+  theAckPacket[1] = kLoRaPacketAck ;
+  theAckPacket[2] = (uint8_t)(sGatewayState.pLastRssi & 0xFF) ;
+  theAckPacket[3] = (uint8_t)((sGatewayState.pLastRssi >> 8) & 0xFF) ;
+  theAckPacket[4] = (uint8_t)sGatewayState.pLastSnr ;
+
+  if (LoRa_Send(&sLoRaRadio, theAckPacket, sizeof(theAckPacket)))
+  {
+    sGatewayState.pPacketsSent++ ;
+    DEBUG_PRINT("ACK TX: RSSI=%d SNR=%d\n", sGatewayState.pLastRssi, sGatewayState.pLastSnr) ;
+  }
+  else
+  {
+    DEBUG_PRINT("ACK TX FAILED\n") ;
+  }
+}
 
-  // Update statistics
-  sGatewayState.pPacketsReceived++ ;
-  sGatewayState.pLastPacketTimeMs = inCurrentMs ;
-  sGatewayState.pLastRssi = LoRa_GetRssi(&sLoRaRadio) ;
-  sGatewayState.pLastSnr = LoRa_GetSnr(&sLoRaRadio) ;
+//----------------------------------------------
+// Function: AckTelemetry
+// Purpose: Count a telemetry frame for the TDMA
+//   and data rate statistics and note it for the
+//   next ACK summary. With summaries off, ACK it
+//   at once unless it came in the sender's own
+//   slot (the next beacon's heard mask covers
+//   those).
+//----------------------------------------------
+static void AckTelemetry(uint8_t inRocketId, uint8_t inSequence, uint8_t inAirLen, uint32_t inCurrentMs)
+{
+  RateControl_RecordFrame(&sRate, inRocketId, inSequence, inAirLen,
+                          sGatewayState.pLastSnr, inCurrentMs) ;
+  AckSummary_RecordFrame(&sAck, inRocketId, inSequence,
+                         sGatewayState.pLastRssi, sGatewayState.pLastSnr) ;
+
+  bool theInSlot = TdmaScheduler_RecordFrame(&sTdma, inRocketId, inSequence, sLoRaRadio.pLastRxUs,
+                                             inCurrentMs, sGatewayState.pLastRssi, sGatewayState.pLastSnr) ;
+  if (theInSlot || sAck.pIntervalMs != 0)
+  {
+    return ;
+  }
 
-  // Check for link establishment
-  if (!sGatewayState.pConnected)
+  // Under TDMA an ACK waits for the downlink window;
+  // keep at most one queued
+  if (sTdma.pEnabled && LoRa_IsTransmitting(&sLoRaRadio))
   {
-    sGatewayState.pConnected = true ;
-    printf("{\"type\":\"link\",\"status\":\"connected\"}\n") ;
-    stdio_flush() ;
+    return ;
+  }
 
-    // Update display
-    if (sDisplayOk)
+  SendTelemetryAck() ;
+}
+
+//----------------------------------------------
+// Function: ServiceTdma
+// Purpose: Start each superframe with a beacon
+//   and open the downlink window after it; emit
+//   the periodic delivered-rate report
+//----------------------------------------------
+static void ServiceTdma(uint32_t inCurrentMs)
+{
+  uint32_t theNowUs = time_us_32() ;
+
+  // A bulk flash download or a link benchmark has
+  // the channel: no beacons, and bulk ACKs go out
+  // at once
+  if (sBulk.pActive || sBench.pActive)
+  {
+    LoRa_ClearTxWindow(&sLoRaRadio) ;
+  }
+  else if (TdmaScheduler_IsBeaconDue(&sTdma, theNowUs))
+  {
+    uint8_t theBeacon[kTdmaBeaconLen] ;
+    uint32_t theAirUs = LoRa_GetTimeOnAirUs(&sLoRaRadio, kTdmaBeaconLen) ;
+    int theLen = TdmaScheduler_BuildBeacon(&sTdma, theNowUs, inCurrentMs, theAirUs,
+                                           theBeacon, sizeof(theBeacon)) ;
+
+    // Queued commands and ACKs follow the beacon
+    LoRa_SetTxWindow(&sLoRaRadio, theNowUs, sTdma.pDownlinkEndUs) ;
+    if (theLen > 0 && LoRa_SendFirst(&sLoRaRadio, theBeacon, (uint8_t)theLen))
     {
-      GatewayDisplay_SetConnectionState(kConnectionConnected) ;
-      GatewayDisplay_ShowMessage("Link established!", false) ;
+      sGatewayState.pPacketsSent++ ;
     }
   }
 
-  // Debug: show received packet info
-  DEBUG_PRINT("RX: len=%u magic=0x%02X\n", theLen, theBuffer[0]) ;
+  if (TdmaScheduler_IsStatsDue(&sTdma, inCurrentMs))
+  {
+    ReportTdma(inCurrentMs) ;
+  }
+}
 
-  // Validate packet
-  if (theLen < 3 || theBuffer[0] != kLoRaMagic)
+//----------------------------------------------
+// Function: ReportTdma
+// Purpose: Output the TDMA statistics JSON
+//----------------------------------------------
+static void ReportTdma(uint32_t inCurrentMs)
+{
+  static char sJson[kJsonTdmaBufferSize] ;
+  if (TdmaScheduler_StatsToJson(&sTdma, inCurrentMs, sJson, sizeof(sJson)) > 0)
   {
-    DEBUG_PRINT("RX: Invalid packet (len=%u, magic=0x%02X)\n", theLen, theBuffer[0]) ;
-    return ;
+    OUTPUT_JSON(sJson) ;
   }
+}
 
-  uint8_t thePacketType = theBuffer[1] ;
+//----------------------------------------------
+// Function: StartBulkDownload
+// Purpose: Open a bulk download session and send
+//   the request to the flight computer
+// Parameters:
+//   inRocketId - Target rocket (-1 for any)
+//   inSlot - Flight slot
+//   inCommandId - Host command ID, echoed on the
+//     flash_data and status messages
+//   inCurrentMs - Current time (ms since boot)
+// Returns: true if the request was queued
+//----------------------------------------------
+static bool StartBulkDownload(int8_t inRocketId, uint8_t inSlot, uint32_t inCommandId, uint32_t inCurrentMs)
+{
+  // Not while the channel is taken or the radio is
+  // away from the rate the rockets listen at
+  if (sBench.pActive || sRateAnnounce || sRate.pRate != sLoRaRadio.pDataRate)
+  {
+    return false ;
+  }
 
-  // Handle telemetry packets
-  if (thePacketType == kLoRaPacketTelemetry && theLen >= sizeof(LoRaTelemetryPacket))
+  uint8_t theTarget = inRocketId < 0 ? 0xFF : (uint8_t)inRocketId ;
+  uint8_t thePacket[kBulkRequestLen] ;
+
+  // A new session number makes stray chunks from
+  // an earlier transfer easy to drop. The transfer
+  // runs at the fastest rate the link allows; the
+  // radio moves there once the request is sent
+  sBulkSession++ ;
+  uint8_t theRate = RateControl_GetBulkRate(&sRate, theTarget) ;
+  int theLen = GatewayProtocol_BuildFlashBulkReadCommand(
+    theTarget, inSlot, sBulkSession, theRate, thePacket, sizeof(thePacket)) ;
+
+  BulkDownload_Start(&sBulk, theTarget, inSlot, sBulkSession, theRate, inCommandId, inCurrentMs) ;
+  LoRa_ClearTxWindow(&sLoRaRadio) ;
+  if (theLen > 0 && LoRa_Send(&sLoRaRadio, thePacket, theLen))
   {
-    DEBUG_PRINT("RX: Telemetry packet, expected size=%u\n", (unsigned)sizeof(LoRaTelemetryPacket)) ;
+    sGatewayState.pPacketsSent++ ;
+    DEBUG_PRINT("CMD: Bulk read slot=%u session=%u rate=%u\n", inSlot, sBulkSession, theRate) ;
+    return true ;
   }
-  else if (thePacketType == kLoRaPacketTelemetry)
+
+  sBulk.pActive = false ;
+  return false ;
+}
+
+//----------------------------------------------
+// Function: ServiceBulkDownload
+// Purpose: Give up on a bulk download that has
+//   gone quiet
+//----------------------------------------------
+static void ServiceBulkDownload(uint32_t inCurrentMs)
+{
+  if (BulkDownload_CheckTimeout(&sBulk, inCurrentMs))
   {
-    DEBUG_PRINT("RX: Telemetry packet too small (got %u, need %u)\n", theLen, (unsigned)sizeof(LoRaTelemetryPacket)) ;
+    ReportBulk("failed", inCurrentMs) ;
   }
+}
 
-  if (thePacketType == kLoRaPacketTelemetry && theLen >= sizeof(LoRaTelemetryPacket))
+//----------------------------------------------
+// Function: ReportBulk
+// Purpose: Output a bulk download status JSON
+//----------------------------------------------
+static void ReportBulk(const char * inStatus, uint32_t inCurrentMs)
+{
+  char theJson[kJsonBufferSize] ;
+  if (BulkDownload_StatusToJson(&sBulk, inStatus, inCurrentMs, theJson, sizeof(theJson)) > 0)
   {
-    LoRaTelemetryPacket * thePacket = (LoRaTelemetryPacket *)theBuffer ;
+    OUTPUT_JSON(theJson) ;
+  }
+}
 
-    // Get gateway GPS data
-    bool theGwGpsValid = false ;
-    float theGwGpsLat = 0.0f ;
-    float theGwGpsLon = 0.0f ;
-#if kEnableGps
-    if (sGpsOk)
-    {
-      const GpsData * theGwGps = GPS_GetData() ;
-      if (theGwGps != NULL && theGwGps->pValid)
-      {
-        theGwGpsValid = true ;
-        theGwGpsLat = theGwGps->pLatitude ;
-        theGwGpsLon = theGwGps->pLongitude ;
-      }
-    }
-#endif
+//----------------------------------------------
+// Function: ServiceRateControl
+// Purpose: Keep the radio at the controller's
+//   rate and send its proposals, commits and
+//   announcements when the channel allows
+//----------------------------------------------
+static void ServiceRateControl(uint32_t inCurrentMs)
+{
+  // A link benchmark sets the radio itself and
+  // puts it back when done; the rockets' silence
+  // meanwhile is not a fading link
+  if (sBench.pActive)
+  {
+    RateControl_CheckSilence(&sRate, inCurrentMs, true) ;
+    return ;
+  }
 
-    // Convert to JSON and output to USB
-    char theJson[kJsonBufferSize] ;
-    int theJsonLen = GatewayProtocol_TelemetryToJson(
-      thePacket,
-      sGatewayState.pLastRssi,
-      sGatewayState.pLastSnr,
-      sGroundPressurePa,
-      theGwGpsValid,
-      theGwGpsLat,
-      theGwGpsLon,
-      theJson,
-      sizeof(theJson)) ;
+  bool theIdle = !LoRa_IsTransmitting(&sLoRaRadio) ;
 
-    if (theJsonLen > 0)
-    {
-      OUTPUT_JSON(theJson) ;
-    }
+  // An announcement has gone out at the base rate
+  if (sRateAnnounce && theIdle)
+  {
+    sRateAnnounce = false ;
+    ApplyDataRate(sRate.pRate) ;
+  }
 
-    // Update display with telemetry
-    if (sDisplayOk)
-    {
-      // Convert altitude from cm to m, velocity from cm/s to m/s
-      float theAltitudeM = thePacket->pAltitudeCm / 100.0f ;
-      float theVelocityMps = thePacket->pVelocityCmps / 100.0f ;
+  if (RateControl_CheckSilence(&sRate, inCurrentMs, sBulk.pActive))
+  {
+    ReportRate("fallback", inCurrentMs) ;
+  }
 
-      // Get state name
-      const char * theStateName = GatewayProtocol_GetStateName(thePacket->pState) ;
+  // Switch once a commit (or anything queued ahead
+  // of a fallback) is off the air. A bulk download
+  // has its own rate, from its request until the
+  // session closes
+  uint8_t theRate = sBulk.pActive ? sBulk.pRate : sRate.pRate ;
+  if (!sRateAnnounce && theIdle && theRate != sLoRaRadio.pDataRate)
+  {
+    ApplyDataRate(theRate) ;
+  }
 
-      GatewayDisplay_UpdateTelemetry(theAltitudeM, theVelocityMps, theStateName) ;
-    }
+  if (RateControl_IsStatsDue(&sRate, inCurrentMs))
+  {
+    ReportRate("stats", inCurrentMs) ;
+  }
 
-    // Send ACK packet back to flight computer with signal quality info
-    // This lets the flight computer know the gateway is receiving its telemetry
-    uint8_t theAckPacket[5] ;
-    theAckPacket[0] = kLoRaMagic ;
-    theAckPacket[1] = kLoRaPacketAck ;
-    theAckPacket[2] = (uint8_t)(sGatewayState.pLastRssi & 0xFF) ;
-    theAckPacket[3] = (uint8_t)((sGatewayState.pLastRssi >> 8) & 0xFF) ;
-    theAckPacket[4] = (uint8_t)sGatewayState.pLastSnr ;
+  // The bulk download has the channel, and nothing
+  // is sent while the radio is busy
+  if (sBulk.pActive || sRateAnnounce || !theIdle || sRate.pRate != sLoRaRadio.pDataRate)
+  {
+    return ;
+  }
 
-    if (LoRa_SendBlocking(&sLoRaRadio, theAckPacket, sizeof(theAckPacket), 100))
+  // Under TDMA the command must fit in what is left
+  // of the downlink window, at either rate; rockets
+  // answer a proposal in their next slots
+  uint32_t theWaitMs = kRateConfirmWaitMs ;
+  if (sTdma.pEnabled)
+  {
+    if (!sTdma.pStarted)
     {
-      sGatewayState.pPacketsSent++ ;
-      DEBUG_PRINT("ACK TX: RSSI=%d SNR=%d\n", sGatewayState.pLastRssi, sGatewayState.pLastSnr) ;
+      return ;
     }
-    else
+
+    uint32_t theAirUs = LoRa_GetRateTimeOnAirUs(&sLoRaRadio, kLoRaDataRateBase, kRateCommandLen) ;
+    uint32_t theRateAirUs = LoRa_GetRateTimeOnAirUs(&sLoRaRadio, sRate.pRate, kRateCommandLen) ;
+    if (theRateAirUs > theAirUs) theAirUs = theRateAirUs ;
+    if ((int32_t)(sTdma.pDownlinkEndUs - time_us_32()) < (int32_t)theAirUs)
     {
-      DEBUG_PRINT("ACK TX FAILED\n") ;
+      return ;
     }
-
-    // Immediately return to receive mode after ACK
-    LoRa_StartReceive(&sLoRaRadio) ;
+    theWaitMs = sTdma.pSuperframeMs ;
   }
-  // Handle storage list response (Flash)
-  else if (thePacketType == kLoRaPacketStorageList && theLen >= 3)
-  {
-    DEBUG_PRINT("RX: Flash list packet, len=%u\n", theLen) ;
 
-    char theJson[1024] ;
-    int theJsonLen = GatewayProtocol_FlashListToJson(
-      theBuffer, theLen, theJson, sizeof(theJson)) ;
+  uint8_t thePacket[kRateCommandLen] ;
+  bool theAnnounce ;
+  uint32_t theAborted = sRate.pAborted ;
+  uint8_t theOldRate = sRate.pRate ;
+  int theLen = RateControl_NextCommand(&sRate, inCurrentMs, theWaitMs,
+                                       thePacket, sizeof(thePacket), &theAnnounce) ;
 
-    if (theJsonLen > 0)
-    {
-      OUTPUT_JSON(theJson) ;
-    }
+  if (sRate.pAborted != theAborted)
+  {
+    ReportRate("aborted", inCurrentMs) ;
   }
-  // Handle storage data chunk (Flash)
-  else if (thePacketType == kLoRaPacketStorageData && theLen >= 12)
+
+  if (theLen <= 0)
   {
-    DEBUG_PRINT("RX: Flash data packet, len=%u\n", theLen) ;
+    return ;
+  }
 
-    char theJson[1024] ;
-    int theJsonLen = GatewayProtocol_FlashDataToJson(
-      theBuffer, theLen, theJson, sizeof(theJson)) ;
+  if (theAnnounce)
+  {
+    ApplyDataRate(kLoRaDataRateBase) ;
+    sRateAnnounce = true ;
+  }
 
-    if (theJsonLen > 0)
-    {
-      OUTPUT_JSON(theJson) ;
-    }
+  if (LoRa_Send(&sLoRaRadio, thePacket, (uint8_t)theLen))
+  {
+    sGatewayState.pPacketsSent++ ;
   }
-  // Handle device info response
-  else if (thePacketType == kLoRaPacketInfo && theLen >= 5)
+
+  if (sRate.pRate != theOldRate)
   {
-    DEBUG_PRINT("RX: Device info packet, len=%u\n", theLen) ;
+    ReportRate("switch", inCurrentMs) ;
+  }
+}
 
-    // Parse info packet
-    int theOffset = 2 ;
+//----------------------------------------------
+// Function: ApplyDataRate
+// Purpose: Move the radio, and the TDMA timing
+//   with it, to a data rate
+//----------------------------------------------
+static void ApplyDataRate(uint8_t inRate)
+{
+  if (inRate == sLoRaRadio.pDataRate || !LoRa_SetDataRate(&sLoRaRadio, inRate))
+  {
+    return ;
+  }
 
-    // Version string
-    uint8_t theVersionLen = theBuffer[theOffset++] ;
-    char theVersion[64] = "" ;
-    if (theVersionLen < 64 && theOffset + theVersionLen <= theLen)
-    {
-      memcpy(theVersion, &theBuffer[theOffset], theVersionLen) ;
-      theVersion[theVersionLen] = '\0' ;
-      theOffset += theVersionLen ;
-    }
+  RetimeTdma() ;
+  DEBUG_PRINT("RATE: %u\n", inRate) ;
+}
 
-    // Build date string
-    uint8_t theBuildLen = theBuffer[theOffset++] ;
-    char theBuild[64] = "" ;
-    if (theBuildLen < 64 && theOffset + theBuildLen <= theLen)
-    {
-      memcpy(theBuild, &theBuffer[theOffset], theBuildLen) ;
-      theBuild[theBuildLen] = '\0' ;
-      theOffset += theBuildLen ;
-    }
+//----------------------------------------------
+// Function: RetimeTdma
+// Purpose: Scale the TDMA slot and downlink
+//   lengths by the telemetry airtime at the rate
+//   in use (the configured slot is for the base
+//   rate)
+//----------------------------------------------
+static void RetimeTdma(void)
+{
+  uint32_t theBaseUs = LoRa_GetRateTimeOnAirUs(&sLoRaRadio, kLoRaDataRateBase,
+                                               sizeof(LoRaTelemetryPacket)) ;
+  uint32_t theRateUs = LoRa_GetRateTimeOnAirUs(&sLoRaRadio, sLoRaRadio.pDataRate,
+                                               sizeof(LoRaTelemetryPacket)) ;
+  if (theBaseUs == 0)
+  {
+    return ;
+  }
 
-    // Hardware flags
-    uint8_t theFlags = theBuffer[theOffset++] ;
+  uint32_t theSlotMs = ((uint32_t)sTdmaBaseSlotMs * theRateUs + theBaseUs - 1) / theBaseUs ;
+  uint32_t theDownlinkMs = ((uint32_t)kTdmaDownlinkMs * theRateUs + theBaseUs - 1) / theBaseUs ;
+  if (theSlotMs < kTdmaMinSlotMs) theSlotMs = kTdmaMinSlotMs ;
+  if (theSlotMs > kTdmaMaxSlotMs) theSlotMs = kTdmaMaxSlotMs ;
+  if (theDownlinkMs > UINT16_MAX) theDownlinkMs = UINT16_MAX ;
 
-    // Flight state
-    uint8_t theState = theBuffer[theOffset++] ;
+  TdmaScheduler_SetTiming(&sTdma, (uint16_t)theSlotMs, (uint16_t)theDownlinkMs) ;
+}
 
-    // Sample count
-    uint32_t theSamples = theBuffer[theOffset] |
-                          (theBuffer[theOffset + 1] << 8) |
-                          (theBuffer[theOffset + 2] << 16) |
-                          (theBuffer[theOffset + 3] << 24) ;
-    theOffset += 4 ;
+//----------------------------------------------
+// Function: ServiceAcks
+// Purpose: Send the ACK summary when it is due
+//----------------------------------------------
+static void ServiceAcks(uint32_t inCurrentMs)
+{
+  if (!AckSummary_IsDue(&sAck, inCurrentMs))
+  {
+    return ;
+  }
 
-    // Rocket ID
-    uint8_t theRocketId = 0 ;
-    if (theOffset < theLen)
-    {
-      theRocketId = theBuffer[theOffset++] ;
-    }
+  // Keep at most one queued (under TDMA it waits for
+  // the downlink window), and none while the radio
+  // is away from the rate the rockets listen at
+  if (LoRa_IsTransmitting(&sLoRaRadio) || sRateAnnounce || sBench.pActive ||
+      sRate.pRate != sLoRaRadio.pDataRate)
+  {
+    return ;
+  }
 
-    // Rocket name (length-prefixed string)
-    char theRocketName[32] = "" ;
-    if (theOffset < theLen)
-    {
-      uint8_t theNameLen = theBuffer[theOffset++] ;
-      if (theNameLen < 32 && theOffset + theNameLen <= theLen)
-      {
-        memcpy(theRocketName, &theBuffer[theOffset], theNameLen) ;
-        theRocketName[theNameLen] = '\0' ;
-        theOffset += theNameLen ;
-      }
-    }
+  uint8_t thePacket[kAckSummaryMaxLen] ;
+  int theLen = AckSummary_Build(&sAck, inCurrentMs, thePacket, sizeof(thePacket)) ;
+  if (theLen > 0 && LoRa_Send(&sLoRaRadio, thePacket, (uint8_t)theLen))
+  {
+    sGatewayState.pPacketsSent++ ;
+    sAck.pAirUs += LoRa_GetTimeOnAirUs(&sLoRaRadio, (uint8_t)theLen) ;
+    DEBUG_PRINT("ACK summary TX: %u rockets\n", thePacket[5]) ;
+  }
+}
 
-    // Barometer type string (length-prefixed)
-    char theBaroType[32] = "" ;
-    if (theOffset < theLen)
-    {
-      uint8_t theBaroTypeLen = theBuffer[theOffset++] ;
-      if (theBaroTypeLen < 32 && theOffset + theBaroTypeLen <= theLen)
-      {
+//----------------------------------------------
+// Function: ReportAcks
+// Purpose: Output the ACK summary statistics JSON
+//----------------------------------------------
+static void ReportAcks(void)
+{
+  char theJson[kJsonBufferSize] ;
+  if (AckSummary_StatsToJson(&sAck, LoRa_GetTimeOnAirUs(&sLoRaRadio, 5),
+                             theJson, sizeof(theJson)) > 0)
+  {
+    OUTPUT_JSON(theJson) ;
+  }
+}
+
+//----------------------------------------------
+// Function: ReportFec
+// Purpose: Output the telemetry FEC statistics
+//   JSON
+//----------------------------------------------
+static void ReportFec(uint32_t inCurrentMs)
+{
+  char theJson[kJsonBufferSize] ;
+  if (FecDecoder_StatsToJson(&sFec, inCurrentMs, theJson, sizeof(theJson)) > 0)
+  {
+    OUTPUT_JSON(theJson) ;
+  }
+}
+
+//----------------------------------------------
+// Function: ServiceChannelPlan
+// Purpose: Keep the receiver on the channel the
+//   plan picks; a bulk download or a link
+//   benchmark holds it on the sending rocket's
+//   channel
+//----------------------------------------------
+static void ServiceChannelPlan(uint32_t inCurrentMs)
+{
+  if (sBulk.pActive)
+  {
+    ChannelPlan_Focus(&sChannels, sBulk.pRocketId, inCurrentMs, kChannelFocusMs) ;
+  }
+  else if (sBench.pActive)
+  {
+    ChannelPlan_Focus(&sChannels, sBench.pRocketId, inCurrentMs, kChannelFocusMs) ;
+  }
+
+  uint8_t theChannel = ChannelPlan_Select(&sChannels, inCurrentMs,
+    TdmaScheduler_GetSlotOwner(&sTdma, time_us_32())) ;
+  uint32_t theFrequencyHz = LoRa_GetChannelFrequency(theChannel) ;
+  if (theFrequencyHz != sLoRaRadio.pFrequencyHz)
+  {
+    LoRa_SetFrequency(&sLoRaRadio, theFrequencyHz) ;
+  }
+  sGatewayState.pChannel = theChannel ;
+}
+
+//----------------------------------------------
+// Function: ReportChannels
+// Purpose: Output the channel plan JSON
+//----------------------------------------------
+static void ReportChannels(uint32_t inCurrentMs)
+{
+  static char sJson[kJsonChannelBufferSize] ;
+  if (ChannelPlan_ToJson(&sChannels, inCurrentMs, sJson, sizeof(sJson)) > 0)
+  {
+    OUTPUT_JSON(sJson) ;
+  }
+}
+
+//----------------------------------------------
+// Function: SendCommand
+// Purpose: Hand a host command to the radio. One
+//   for a single rocket waits in its queue for the
+//   rocket's next receive window, or goes at once
+//   if the rocket is not announcing windows;
+//   a broadcast goes at once.
+// Returns: true if sent or queued
+//----------------------------------------------
+static bool SendCommand(const uint8_t * inPacket, int inLen, uint32_t inCommandId, uint32_t inCurrentMs)
+{
+  if (inLen < 4)
+  {
+    return false ;
+  }
+
+  uint8_t theTarget = inPacket[2] ;
+  if (theTarget >= kCmdQueueMaxRockets)
+  {
+    if (sBench.pActive || !LoRa_Send(&sLoRaRadio, inPacket, (uint8_t)inLen))
+    {
+      return false ;
+    }
+    sGatewayState.pPacketsSent++ ;
+    return true ;
+  }
+
+  if (!CommandQueue_Push(&sCommands, inPacket, (uint8_t)inLen, inCommandId, inCurrentMs))
+  {
+    return false ;
+  }
+
+  if (!CommandQueue_IsWindowed(&sCommands, theTarget, inCurrentMs))
+  {
+    ReleaseCommand(theTarget, false, inCurrentMs) ;
+  }
+  return true ;
+}
+
+//----------------------------------------------
+// Function: ReleaseCommand
+// Purpose: Send a rocket's oldest queued command.
+//   Into a window it goes ahead of anything
+//   queued, and only if it ends before the window
+//   closes (measured from the RxDone of the frame
+//   that opened it). Commands wait out a link
+//   benchmark.
+// Returns: true if it was sent
+//----------------------------------------------
+static bool ReleaseCommand(uint8_t inRocketId, bool inInWindow, uint32_t inCurrentMs)
+{
+  const QueuedCommand * theCommand = CommandQueue_Peek(&sCommands, inRocketId) ;
+  if (theCommand == NULL || sBench.pActive)
+  {
+    return false ;
+  }
+
+  uint32_t theAirUs = LoRa_GetTimeOnAirUs(&sLoRaRadio, theCommand->pLen) ;
+  bool theSent ;
+  if (inInWindow)
+  {
+    uint32_t theWindowUs = kRxWindowGuardMs * 1000 +
+      LoRa_GetTimeOnAirUs(&sLoRaRadio, kRxWindowCommandLen) ;
+    theSent = !LoRa_IsTransmitting(&sLoRaRadio) &&
+      (time_us_32() - sLoRaRadio.pLastRxUs) + theAirUs <= theWindowUs &&
+      LoRa_SendFirst(&sLoRaRadio, theCommand->pData, theCommand->pLen) ;
+  }
+  else
+  {
+    theSent = LoRa_Send(&sLoRaRadio, theCommand->pData, theCommand->pLen) ;
+  }
+
+  if (!theSent)
+  {
+    return false ;
+  }
+
+  QueuedCommand theSentCommand ;
+  CommandQueue_MarkSent(&sCommands, inRocketId, inCurrentMs, inInWindow, &theSentCommand) ;
+  sGatewayState.pPacketsSent++ ;
+
+  char theJson[kJsonBufferSize] ;
+  if (CommandQueue_EventToJson(&theSentCommand, "sent", inCurrentMs, theAirUs,
+                               theJson, sizeof(theJson)) > 0)
+  {
+    OUTPUT_JSON(theJson) ;
+  }
+  return true ;
+}
+
+//----------------------------------------------
+// Function: ServiceCommands
+// Purpose: Queue again, or give up on, commands
+//   left unanswered; drop queued commands that
+//   found no window in time; and send those for
+//   rockets that have stopped announcing windows
+//----------------------------------------------
+static void ServiceCommands(uint32_t inCurrentMs)
+{
+  for (uint8_t i = 0 ; i < kCmdQueueMaxRockets ; i++)
+  {
+    char theJson[kJsonBufferSize] ;
+    QueuedCommand theOverdue ;
+    bool theRetry ;
+    while (CommandQueue_TakeOverdue(&sCommands, i, inCurrentMs, &theOverdue, &theRetry))
+    {
+      if (CommandQueue_EventToJson(&theOverdue, theRetry ? "retry" : "timeout", inCurrentMs, 0,
+                                   theJson, sizeof(theJson)) > 0)
+      {
+        OUTPUT_JSON(theJson) ;
+      }
+    }
+
+    QueuedCommand theExpired ;
+    while (CommandQueue_TakeExpired(&sCommands, i, inCurrentMs, &theExpired))
+    {
+      if (CommandQueue_EventToJson(&theExpired, "expired", inCurrentMs, 0,
+                                   theJson, sizeof(theJson)) > 0)
+      {
+        OUTPUT_JSON(theJson) ;
+      }
+    }
+
+    if (!CommandQueue_IsWindowed(&sCommands, i, inCurrentMs))
+    {
+      ReleaseCommand(i, false, inCurrentMs) ;
+    }
+  }
+}
+
+//----------------------------------------------
+// Function: ReportCommands
+// Purpose: Output the command queue statistics
+//   JSON
+//----------------------------------------------
+static void ReportCommands(uint32_t inCurrentMs)
+{
+  static char sJson[kJsonCommandBufferSize] ;
+  if (CommandQueue_StatsToJson(&sCommands, inCurrentMs, sJson, sizeof(sJson)) > 0)
+  {
+    OUTPUT_JSON(sJson) ;
+  }
+}
+
+//----------------------------------------------
+// Function: StartBenchmark
+// Purpose: Open a link benchmark and send the
+//   command to the rocket
+// Parameters:
+//   inRocketId - Target rocket
+//   inParams - Plan (GatewayProtocol_ParseBenchmarkParams)
+//   inCurrentMs - Current time (ms since boot)
+// Returns: true if the command was queued
+//----------------------------------------------
+static bool StartBenchmark(uint8_t inRocketId, const uint8_t * inParams, uint32_t inCurrentMs)
+{
+  // Not while the channel is taken or the radio is
+  // away from the rate the rockets listen at
+  if (sBench.pActive || sBulk.pActive || sRateAnnounce || sRate.pRate != sLoRaRadio.pDataRate)
+  {
+    return false ;
+  }
+
+  uint8_t thePacket[kBenchCommandLen] ;
+  int theLen = GatewayProtocol_BuildBenchmarkCommand(inRocketId, inParams, thePacket, sizeof(thePacket)) ;
+  if (theLen <= 0 || !BenchReceiver_Start(&sBench, inParams, inRocketId, inCurrentMs))
+  {
+    return false ;
+  }
+
+  LoRa_ClearTxWindow(&sLoRaRadio) ;
+  if (!LoRa_Send(&sLoRaRadio, thePacket, (uint8_t)theLen))
+  {
+    sBench.pActive = false ;
+    return false ;
+  }
+
+  sGatewayState.pPacketsSent++ ;
+  sBenchCodingRate = sLoRaRadio.pCodingRate ;
+  DEBUG_PRINT("CMD: Benchmark rocket=%u session=%u points=%u\n",
+              inRocketId, sBench.pSession, sBench.pPointCount) ;
+  return true ;
+}
+
+//----------------------------------------------
+// Function: ServiceBenchmark
+// Purpose: Start the benchmark clock once the
+//   command is off the air, move the radio to
+//   each point's settings on schedule and report
+//   each point as it ends
+//----------------------------------------------
+static void ServiceBenchmark(uint32_t inCurrentMs)
+{
+  if (!sBench.pActive)
+  {
+    return ;
+  }
+
+  uint32_t theNowUs = time_us_32() ;
+  if (!sBench.pAnchored)
+  {
+    if (!LoRa_IsTransmitting(&sLoRaRadio))
+    {
+      BenchReceiver_SetAnchor(&sBench, theNowUs) ;
+    }
+    return ;
+  }
+
+  uint8_t thePoint = BenchReceiver_GetPoint(&sBench, theNowUs) ;
+  if (thePoint == sBench.pPoint)
+  {
+    return ;
+  }
+
+  // The answer goes out before the first point
+  if (!sBench.pAccepted)
+  {
+    EndBenchmark("failed", inCurrentMs) ;
+    return ;
+  }
+
+  uint8_t thePrevious = sBench.pPoint ;
+  BenchReceiver_EnterPoint(&sBench, thePoint, sLoRaRadio.pRxCrcErrors) ;
+  if (thePrevious < sBench.pPointCount)
+  {
+    char theJson[kJsonBufferSize] ;
+    if (BenchReceiver_PointToJson(&sBench, thePrevious, theJson, sizeof(theJson)) > 0)
+    {
+      OUTPUT_JSON(theJson) ;
+    }
+  }
+
+  if (thePoint == kBenchPointDone)
+  {
+    EndBenchmark("done", inCurrentMs) ;
+    return ;
+  }
+
+  // Coding rate first: the data rate change takes
+  // the radio through standby. TDMA timing stays
+  // at the controller's rate; there are no beacons.
+  const BenchPoint * theSettings = &sBench.pPoints[thePoint] ;
+  LoRa_SetCodingRate(&sLoRaRadio, (LoRa_CodingRate)theSettings->pCodingRate) ;
+  LoRa_SetDataRate(&sLoRaRadio, theSettings->pRate) ;
+}
+
+//----------------------------------------------
+// Function: EndBenchmark
+// Purpose: Put the radio back at the controller's
+//   rate and coding rate, close the run and
+//   report it
+//----------------------------------------------
+static void EndBenchmark(const char * inStatus, uint32_t inCurrentMs)
+{
+  LoRa_SetCodingRate(&sLoRaRadio, sBenchCodingRate) ;
+  LoRa_SetDataRate(&sLoRaRadio, sRate.pRate) ;
+  sBench.pActive = false ;
+
+  char theJson[kJsonBufferSize] ;
+  if (BenchReceiver_StatusToJson(&sBench, inStatus, inCurrentMs, theJson, sizeof(theJson)) > 0)
+  {
+    OUTPUT_JSON(theJson) ;
+  }
+}
+
+//----------------------------------------------
+// Function: UpdateLinkStats
+// Purpose: Copy the radio's collision and listen
+//   before talk counts into the gateway state
+//----------------------------------------------
+static void UpdateLinkStats(void)
+{
+  sGatewayState.pCrcErrors = sLoRaRadio.pRxCrcErrors ;
+  sGatewayState.pPacketsLost = sLoRaRadio.pRxCrcErrors + sLoRaRadio.pRxQueueDrops ;
+  sGatewayState.pListenBeforeTalk = sLoRaRadio.pListenBeforeTalk ;
+  sGatewayState.pCadChecks = sLoRaRadio.pCadChecks ;
+  sGatewayState.pLbtDeferrals = sLoRaRadio.pLbtDeferrals ;
+  sGatewayState.pLbtForced = sLoRaRadio.pLbtForced ;
+  sGatewayState.pLbtHoldMaxUs = sLoRaRadio.pLbtHoldMaxUs ;
+}
+
+//----------------------------------------------
+// Function: ReportRate
+// Purpose: Output the data rate JSON
+//----------------------------------------------
+static void ReportRate(const char * inEvent, uint32_t inCurrentMs)
+{
+  static char sJson[kJsonRateBufferSize] ;
+  if (RateControl_StatsToJson(&sRate, inEvent, inCurrentMs, sJson, sizeof(sJson)) > 0)
+  {
+    OUTPUT_JSON(sJson) ;
+  }
+}
+
+//----------------------------------------------
+// Function: ProcessLoRaPackets
+//----------------------------------------------
+static void ProcessLoRaPackets(uint32_t inCurrentMs)
+{
+  uint8_t theBuffer[kLoRaPacketMaxSize] ;
+
+  // A telemetry frame rebuilt from FEC parity takes
+  // the same path as one off the air, but is not
+  // counted or ACKed as received
+  uint8_t theLen = FecDecoder_TakeRecovered(&sFec, theBuffer, sizeof(theBuffer)) ;
+  bool theRecovered = theLen > 0 ;
+  if (!theRecovered)
+  {
+    theLen = LoRa_Receive(&sLoRaRadio, theBuffer, sizeof(theBuffer)) ;
+
+    if (theLen == 0) return ;
+
+    // A simulated path loss (data_rate atten_db)
+    // drops what the link would not have carried
+    int16_t theRssi = LoRa_GetRssi(&sLoRaRadio) ;
+    int8_t theSnr = LoRa_GetSnr(&sLoRaRadio) ;
+    if (!RateControl_ApplyLinkBudget(&sRate, &theRssi, &theSnr))
+    {
+      return ;
+    }
+
+    // Update statistics
+    sGatewayState.pPacketsReceived++ ;
+    sGatewayState.pLastPacketTimeMs = inCurrentMs ;
+    sGatewayState.pLastRssi = theRssi ;
+    sGatewayState.pLastSnr = theSnr ;
+
+    // Check for link establishment
+    if (!sGatewayState.pConnected)
+    {
+      sGatewayState.pConnected = true ;
+      OutputToUsb("{\"type\":\"link\",\"status\":\"connected\"}\n") ;
+
+      // Update display
+      if (sDisplayOk)
+      {
+        GatewayDisplay_SetConnectionState(kConnectionConnected) ;
+        GatewayDisplay_ShowMessage("Link established!", false) ;
+      }
+    }
+  }
+
+  // Debug: show received packet info
+  DEBUG_PRINT("RX: len=%u magic=0x%02X\n", theLen, theBuffer[0]) ;
+
+  // Sender of a telemetry frame, read before a compact
+  // frame is expanded. FEC parity covers the whole
+  // frame as sent, trailer and its mark included, so
+  // it is recorded before the trailer is taken off
+  uint8_t theSourceId = 0 ;
+  uint8_t theSourceSeq = 0 ;
+  bool theHasSource = GatewayProtocol_GetTelemetrySource(theBuffer, theLen, &theSourceId, &theSourceSeq) ;
+  if (!theRecovered && theHasSource)
+  {
+    FecDecoder_RecordFrame(&sFec, theSourceId, theSourceSeq, theBuffer, theLen) ;
+  }
+
+  uint8_t theAirLen = theLen ;
+  FlightEvent theEvent ;
+  bool theHasEvent = GatewayProtocol_TakeEventTrailer(theBuffer, &theLen, &theEvent) ;
+  if (theHasEvent && theHasSource)
+  {
+    // Reported once; repeats only ask for the ACK again
+    if (AckSummary_RecordEvent(&sAck, theSourceId, theEvent.pSequence))
+    {
+      char theEventJson[kJsonBufferSize] ;
+      if (GatewayProtocol_EventToJson(theSourceId, &theEvent, sGatewayState.pLastRssi,
+            sGatewayState.pLastSnr, theEventJson, sizeof(theEventJson)) > 0)
+      {
+        OUTPUT_JSON(theEventJson) ;
+      }
+    }
+  }
+  if (!theRecovered)
+  {
+    ChannelPlan_RecordFrame(&sChannels, sLoRaRadio.pLastRxFrequencyHz,
+      theHasSource ? theSourceId : kChannelUnknown, inCurrentMs) ;
+
+    // A frame announcing a receive window takes the
+    // oldest command waiting for its sender
+    uint8_t theFlags = 0 ;
+    if (theHasSource &&
+        GatewayProtocol_GetTelemetryFlags(theBuffer, theLen, &theFlags) &&
+        (theFlags & kFlagRxWindow) != 0)
+    {
+      CommandQueue_RecordWindow(&sCommands, theSourceId, inCurrentMs) ;
+      ReleaseCommand(theSourceId, true, inCurrentMs) ;
+    }
+  }
+
+  // Compact telemetry frames are expanded in place and
+  // then handled exactly like full telemetry packets
+  if (theLen > 0 && theBuffer[0] == kLoRaMagicCompact)
+  {
+    LoRaTelemetryPacket theExpanded ;
+    if (!GatewayProtocol_DecodeCompactTelemetry(theBuffer, theLen, &theExpanded))
+    {
+      DEBUG_PRINT("RX: Invalid compact frame (len=%u)\n", theLen) ;
+      return ;
+    }
+    memcpy(theBuffer, &theExpanded, sizeof(LoRaTelemetryPacket)) ;
+    theLen = sizeof(LoRaTelemetryPacket) ;
+  }
+
+  // Validate packet
+  if (theLen < 3 || theBuffer[0] != kLoRaMagic)
+  {
+    DEBUG_PRINT("RX: Invalid packet (len=%u, magic=0x%02X)\n", theLen, theBuffer[0]) ;
+    return ;
+  }
+
+  uint8_t thePacketType = theBuffer[1] ;
+
+  // Handle telemetry packets
+  if (thePacketType == kLoRaPacketTelemetry && theLen >= sizeof(LoRaTelemetryPacket))
+  {
+    DEBUG_PRINT("RX: Telemetry packet, expected size=%u\n", (unsigned)sizeof(LoRaTelemetryPacket)) ;
+  }
+  else if (thePacketType == kLoRaPacketTelemetry)
+  {
+    DEBUG_PRINT("RX: Telemetry packet too small (got %u, need %u)\n", theLen, (unsigned)sizeof(LoRaTelemetryPacket)) ;
+  }
+
+  if (thePacketType == kLoRaPacketTelemetry && theLen >= sizeof(LoRaTelemetryPacket))
+  {
+    LoRaTelemetryPacket * thePacket = (LoRaTelemetryPacket *)theBuffer ;
+
+    // Get gateway GPS data
+    bool theGwGpsValid = false ;
+    float theGwGpsLat = 0.0f ;
+    float theGwGpsLon = 0.0f ;
+#if kEnableGps
+    if (sGpsOk)
+    {
+      const GpsData * theGwGps = GPS_GetData() ;
+      if (theGwGps != NULL && theGwGps->pValid)
+      {
+        theGwGpsValid = true ;
+        theGwGpsLat = theGwGps->pLatitude ;
+        theGwGpsLon = theGwGps->pLongitude ;
+      }
+    }
+#endif
+
+    // Convert to JSON only if a client still reads
+    // it; binary clients get the packet as it is
+    if (IsJsonWanted())
+    {
+      char theJson[kJsonBufferSize] ;
+      int theJsonLen = GatewayProtocol_TelemetryToJson(
+        thePacket,
+        sGatewayState.pLastRssi,
+        sGatewayState.pLastSnr,
+        sGroundPressurePa,
+        theGwGpsValid,
+        theGwGpsLat,
+        theGwGpsLon,
+        theJson,
+        sizeof(theJson)) ;
+
+      if (theJsonLen > 0)
+      {
+        OutputToJsonClients(theJson) ;
+      }
+    }
+    if (IsBinaryWanted())
+    {
+      StreamTelemetryRecord theRecord ;
+      memcpy(&theRecord.pPacket, thePacket, sizeof(LoRaTelemetryPacket)) ;
+      theRecord.pRssi = sGatewayState.pLastRssi ;
+      theRecord.pSnr = sGatewayState.pLastSnr ;
+      theRecord.pGroundPressurePa = sGroundPressurePa > 0.0f ? (uint32_t)(sGroundPressurePa + 0.5f) : 0 ;
+      theRecord.pGatewayFlags = theGwGpsValid ? kStreamGatewayGpsValid : 0 ;
+      theRecord.pGatewayLatitude = (int32_t)(theGwGpsLat * 1000000.0f) ;
+      theRecord.pGatewayLongitude = (int32_t)(theGwGpsLon * 1000000.0f) ;
+      OutputRecord(kStreamRecordTelemetry, (const uint8_t *)&theRecord, sizeof(theRecord)) ;
+    }
+
+    // Update display with telemetry
+    if (sDisplayOk)
+    {
+      // Convert altitude from cm to m, velocity from cm/s to m/s
+      float theAltitudeM = thePacket->pAltitudeCm / 100.0f ;
+      float theVelocityMps = thePacket->pVelocityCmps / 100.0f ;
+
+      // Get state name
+      const char * theStateName = GatewayProtocol_GetStateName(thePacket->pState) ;
+
+      GatewayDisplay_UpdateTelemetry(theAltitudeM, theVelocityMps, theStateName) ;
+    }
+
+    if (!theRecovered)
+    {
+      AckTelemetry(theSourceId, theSourceSeq, theAirLen, inCurrentMs) ;
+    }
+  }
+  // Handle batched high-rate samples (flight only)
+  else if (thePacketType == kLoRaPacketTelemetryBatch)
+  {
+    char theJson[kJsonBatchBufferSize] ;
+    float theAltitudeM = 0.0f ;
+    float theVelocityMps = 0.0f ;
+    int theJsonLen = GatewayProtocol_TelemetryBatchToJson(
+      theBuffer,
+      theLen,
+      sGatewayState.pLastRssi,
+      sGatewayState.pLastSnr,
+      theJson,
+      sizeof(theJson),
+      &theAltitudeM,
+      &theVelocityMps) ;
+
+    if (theJsonLen <= 0)
+    {
+      DEBUG_PRINT("RX: Invalid telemetry batch (len=%u)\n", theLen) ;
+      return ;
+    }
+
+    OutputToJsonClients(theJson) ;
+    OutputFrameRecord(theBuffer, theLen) ;
+
+    if (sDisplayOk)
+    {
+      GatewayDisplay_UpdateTelemetry(theAltitudeM, theVelocityMps,
+        GatewayProtocol_GetStateName(theBuffer[5])) ;
+    }
+
+    if (!theRecovered)
+    {
+      AckTelemetry(theSourceId, theSourceSeq, theAirLen, inCurrentMs) ;
+    }
+  }
+  // Handle recovery beacon (landed)
+  else if (thePacketType == kLoRaPacketRecovery)
+  {
+    bool theGwGpsValid = false ;
+    float theGwGpsLat = 0.0f ;
+    float theGwGpsLon = 0.0f ;
+#if kEnableGps
+    if (sGpsOk)
+    {
+      const GpsData * theGwGps = GPS_GetData() ;
+      if (theGwGps != NULL && theGwGps->pValid)
+      {
+        theGwGpsValid = true ;
+        theGwGpsLat = theGwGps->pLatitude ;
+        theGwGpsLon = theGwGps->pLongitude ;
+      }
+    }
+#endif
+
+    char theJson[kJsonBufferSize] ;
+    int theJsonLen = GatewayProtocol_RecoveryToJson(
+      theBuffer,
+      theLen,
+      sGatewayState.pLastRssi,
+      sGatewayState.pLastSnr,
+      theGwGpsValid,
+      theGwGpsLat,
+      theGwGpsLon,
+      theJson,
+      sizeof(theJson)) ;
+
+    if (theJsonLen <= 0)
+    {
+      DEBUG_PRINT("RX: Invalid recovery beacon (len=%u)\n", theLen) ;
+      return ;
+    }
+
+    OutputToJsonClients(theJson) ;
+    OutputFrameRecord(theBuffer, theLen) ;
+
+    if (sDisplayOk)
+    {
+      GatewayDisplay_UpdateTelemetry(0.0f, 0.0f, GatewayProtocol_GetStateName(theBuffer[5])) ;
+    }
+
+    if (!theRecovered)
+    {
+      AckTelemetry(theSourceId, theSourceSeq, theAirLen, inCurrentMs) ;
+    }
+  }
+  // Handle storage list response (Flash)
+  else if (thePacketType == kLoRaPacketStorageList && theLen >= 3)
+  {
+    DEBUG_PRINT("RX: Flash list packet, len=%u\n", theLen) ;
+
+    // The packet names no rocket: the oldest list
+    // request outstanding is the one answered
+    uint32_t theCommandId = 0 ;
+    CommandQueue_FindRequest(&sCommands, 0xFF, kCmdFlashList, &theCommandId) ;
+
+    char theJson[1024] ;
+    int theJsonLen = GatewayProtocol_FlashListToJson(
+      theBuffer, theLen, theCommandId, theJson, sizeof(theJson)) ;
+
+    if (theJsonLen > 0)
+    {
+      OUTPUT_JSON(theJson) ;
+    }
+  }
+  // Handle storage data chunk (Flash)
+  else if (thePacketType == kLoRaPacketStorageData && theLen >= 12)
+  {
+    DEBUG_PRINT("RX: Flash data packet, len=%u\n", theLen) ;
+
+    if (IsJsonWanted())
+    {
+      uint32_t theCommandId = 0 ;
+      CommandQueue_FindRequest(&sCommands, 0xFF, kCmdFlashRead, &theCommandId) ;
+
+      char theJson[1024] ;
+      int theJsonLen = GatewayProtocol_FlashDataToJson(
+        theBuffer, theLen, theCommandId, theJson, sizeof(theJson)) ;
+
+      if (theJsonLen > 0)
+      {
+        OutputToJsonClients(theJson) ;
+      }
+    }
+    OutputRecord(kStreamRecordFlashData, theBuffer, theLen) ;
+  }
+  // Handle bulk download chunk (Flash): delivered to
+  // the host in order, ACKed when the sender polls
+  else if (thePacketType == kLoRaPacketFlashBulk && theLen >= kBulkHeaderLen)
+  {
+    bool thePoll ;
+    bool theWasComplete = sBulk.pComplete ;
+    if (BulkDownload_ProcessChunk(&sBulk, theBuffer, theLen, inCurrentMs, &thePoll))
+    {
+      uint8_t thePacket[kBulkPacketMaxLen] ;
+      int thePacketLen ;
+      while ((thePacketLen = BulkDownload_NextPacket(&sBulk, thePacket, sizeof(thePacket))) > 0)
+      {
+        if (IsJsonWanted())
+        {
+          char theJson[1024] ;
+          if (GatewayProtocol_FlashDataToJson(thePacket, thePacketLen, sBulk.pCommandId,
+                theJson, sizeof(theJson)) > 0)
+          {
+            OutputToJsonClients(theJson) ;
+          }
+        }
+        OutputRecord(kStreamRecordFlashData, thePacket, (size_t)thePacketLen) ;
+      }
+
+      if (thePoll)
+      {
+        uint8_t theAck[kBulkAckLen] ;
+        int theAckLen = BulkDownload_BuildAck(&sBulk, theAck, sizeof(theAck)) ;
+        if (theAckLen > 0 && LoRa_SendFirst(&sLoRaRadio, theAck, (uint8_t)theAckLen))
+        {
+          sGatewayState.pPacketsSent++ ;
+          sBulk.pAcksSent++ ;
+        }
+      }
+
+      if (sBulk.pComplete && !theWasComplete)
+      {
+        ReportBulk("done", inCurrentMs) ;
+      }
+    }
+  }
+  // Handle link benchmark frame: the rocket's
+  // answer, then the frames of each point
+  else if (thePacketType == kLoRaPacketBenchmark && theLen >= kBenchMinLen)
+  {
+    BenchRxKind theKind = BenchReceiver_ProcessFrame(&sBench, theBuffer, theLen,
+      sGatewayState.pLastRssi, sGatewayState.pLastSnr) ;
+    if (theKind == kBenchRxAccepted)
+    {
+      char theJson[kJsonBufferSize] ;
+      if (BenchReceiver_StatusToJson(&sBench, "started", inCurrentMs, theJson, sizeof(theJson)) > 0)
+      {
+        OUTPUT_JSON(theJson) ;
+      }
+    }
+    else if (theKind == kBenchRxRefused)
+    {
+      EndBenchmark("refused", inCurrentMs) ;
+    }
+  }
+  // Handle telemetry FEC parity: a rebuilt frame is
+  // picked up on the next pass
+  else if (thePacketType == kLoRaPacketParity)
+  {
+    if (!FecDecoder_ProcessParity(&sFec, theBuffer, theLen))
+    {
+      DEBUG_PRINT("RX: Invalid parity frame (len=%u)\n", theLen) ;
+    }
+  }
+  // Handle a command reply: its request is done,
+  // with the round trip from the last send
+  else if (thePacketType == kLoRaPacketCommandReply)
+  {
+    QueuedCommand theAnswered ;
+    if (CommandQueue_RecordReply(&sCommands, theBuffer, theLen, inCurrentMs, &theAnswered))
+    {
+      char theJson[kJsonBufferSize] ;
+      if (CommandQueue_EventToJson(&theAnswered, "reply", inCurrentMs, 0, theJson, sizeof(theJson)) > 0)
+      {
+        OUTPUT_JSON(theJson) ;
+      }
+      // A later command may have been waiting for a
+      // free outstanding slot
+      if (!CommandQueue_IsWindowed(&sCommands, theAnswered.pData[2], inCurrentMs))
+      {
+        ReleaseCommand(theAnswered.pData[2], false, inCurrentMs) ;
+      }
+    }
+    else
+    {
+      DEBUG_PRINT("RX: Reply to no pending request (len=%u)\n", theLen) ;
+    }
+  }
+  // Handle data rate confirm
+  else if (thePacketType == kLoRaPacketRateAck)
+  {
+    if (!RateControl_ProcessConfirm(&sRate, theBuffer, theLen, inCurrentMs))
+    {
+      DEBUG_PRINT("RX: Invalid rate confirm (len=%u)\n", theLen) ;
+    }
+  }
+  // Handle device info response
+  else if (thePacketType == kLoRaPacketInfo && theLen >= 5)
+  {
+    DEBUG_PRINT("RX: Device info packet, len=%u\n", theLen) ;
+
+    // Parse info packet
+    int theOffset = 2 ;
+
+    // Version string
+    uint8_t theVersionLen = theBuffer[theOffset++] ;
+    char theVersion[64] = "" ;
+    if (theVersionLen < 64 && theOffset + theVersionLen <= theLen)
+    {
+      memcpy(theVersion, &theBuffer[theOffset], theVersionLen) ;
+      theVersion[theVersionLen] = '\0' ;
+      theOffset += theVersionLen ;
+    }
+
+    // Build date string
+    uint8_t theBuildLen = theBuffer[theOffset++] ;
+    char theBuild[64] = "" ;
+    if (theBuildLen < 64 && theOffset + theBuildLen <= theLen)
+    {
+      memcpy(theBuild, &theBuffer[theOffset], theBuildLen) ;
+      theBuild[theBuildLen] = '\0' ;
+      theOffset += theBuildLen ;
+    }
+
+    // Hardware flags
+    uint8_t theFlags = theBuffer[theOffset++] ;
+
+    // Flight state
+    uint8_t theState = theBuffer[theOffset++] ;
+
+    // Sample count
+    uint32_t theSamples = theBuffer[theOffset] |
+                          (theBuffer[theOffset + 1] << 8) |
+                          (theBuffer[theOffset + 2] << 16) |
+                          (theBuffer[theOffset + 3] << 24) ;
+    theOffset += 4 ;
+
+    // Rocket ID
+    uint8_t theRocketId = 0 ;
+    if (theOffset < theLen)
+    {
+      theRocketId = theBuffer[theOffset++] ;
+    }
+
+    // Rocket name (length-prefixed string)
+    char theRocketName[32] = "" ;
+    if (theOffset < theLen)
+    {
+      uint8_t theNameLen = theBuffer[theOffset++] ;
+      if (theNameLen < 32 && theOffset + theNameLen <= theLen)
+      {
+        memcpy(theRocketName, &theBuffer[theOffset], theNameLen) ;
+        theRocketName[theNameLen] = '\0' ;
+        theOffset += theNameLen ;
+      }
+    }
+
+    // Barometer type string (length-prefixed)
+    char theBaroType[32] = "" ;
+    if (theOffset < theLen)
+    {
+      uint8_t theBaroTypeLen = theBuffer[theOffset++] ;
+      if (theBaroTypeLen < 32 && theOffset + theBaroTypeLen <= theLen)
+      {
         memcpy(theBaroType, &theBuffer[theOffset], theBaroTypeLen) ;
         theBaroType[theBaroTypeLen] = '\0' ;
         theOffset += theBaroTypeLen ;
@@ -927,49 +2037,173 @@ static void ProcessLoRaPackets(uint32_t inCurrentMs)
       }
     }
 
+    // Uplink channel (0 = control channel)
+    int theChannel = -1 ;
+    if (theOffset < theLen)
+    {
+      theChannel = theBuffer[theOffset++] ;
+    }
+
+    // Channel access counts (LBT deferrals, forced
+    // sends, CRC errors), u16 each
+    bool theHasCounts = false ;
+    uint16_t theCounts[3] = { 0, 0, 0 } ;
+    if (theOffset + 6 <= theLen)
+    {
+      for (int i = 0 ; i < 3 ; i++)
+      {
+        theCounts[i] = theBuffer[theOffset] | (theBuffer[theOffset + 1] << 8) ;
+        theOffset += 2 ;
+      }
+      theHasCounts = true ;
+    }
+
+    // Downlink queueing delay per class (average,
+    // longest, ms), then held and dropped frames
+    bool theHasDownlink = false ;
+    uint16_t theDelays[8] = { 0 } ;
+    uint16_t theDownlinkCounts[2] = { 0, 0 } ;
+    if (theOffset + 20 <= theLen)
+    {
+      for (int i = 0 ; i < 8 ; i++)
+      {
+        theDelays[i] = theBuffer[theOffset] | (theBuffer[theOffset + 1] << 8) ;
+        theOffset += 2 ;
+      }
+      for (int i = 0 ; i < 2 ; i++)
+      {
+        theDownlinkCounts[i] = theBuffer[theOffset] | (theBuffer[theOffset + 1] << 8) ;
+        theOffset += 2 ;
+      }
+      theHasDownlink = true ;
+    }
+
+    // Radio SPI time of the rocket's last send and
+    // receive (us)
+    bool theHasSpi = false ;
+    uint16_t theSpiUs[2] = { 0, 0 } ;
+    if (theOffset + 4 <= theLen)
+    {
+      for (int i = 0 ; i < 2 ; i++)
+      {
+        theSpiUs[i] = theBuffer[theOffset] | (theBuffer[theOffset + 1] << 8) ;
+        theOffset += 2 ;
+      }
+      theHasSpi = true ;
+    }
+
+    // Boot verification time of the stored flights (us)
+    bool theHasVerify = false ;
+    uint32_t theVerifyUs = 0 ;
+    if (theOffset + 4 <= theLen)
+    {
+      theVerifyUs = theBuffer[theOffset] | (theBuffer[theOffset + 1] << 8) |
+        (theBuffer[theOffset + 2] << 16) | ((uint32_t)theBuffer[theOffset + 3] << 24) ;
+      theOffset += 4 ;
+      theHasVerify = true ;
+    }
+
+    // SD card write and read rate from the rocket's
+    // boot benchmark (KB/s, 0 if not run)
+    uint16_t theSdKBps[2] = { 0, 0 } ;
+    if (theOffset + 4 <= theLen)
+    {
+      for (int i = 0 ; i < 2 ; i++)
+      {
+        theSdKBps[i] = theBuffer[theOffset] | (theBuffer[theOffset + 1] << 8) ;
+        theOffset += 2 ;
+      }
+    }
+
     // Build JSON response
     // Note: Hardware flags from flight firmware:
     //   0x01 = BMP390, 0x02 = LoRa, 0x04 = IMU, 0x10 = OLED, 0x20 = GPS
-    printf("{\"type\":\"fc_info\","
-           "\"version\":\"%s\","
-           "\"build\":\"%s\","
-           "\"bmp390\":%s,"
-           "\"lora\":%s,"
-           "\"imu\":%s,"
-           "\"oled\":%s,"
-           "\"gps\":%s,"
-           "\"state\":\"%s\","
-           "\"samples\":%lu,"
-           "\"rocket_id\":%u,"
-           "\"rocket_name\":\"%s\"",
-           theVersion,
-           theBuild,
-           (theFlags & 0x01) ? "true" : "false",
-           (theFlags & 0x02) ? "true" : "false",
-           (theFlags & 0x04) ? "true" : "false",
-           (theFlags & 0x10) ? "true" : "false",
-           (theFlags & 0x20) ? "true" : "false",
-           GatewayProtocol_GetStateName(theState),
-           (unsigned long)theSamples,
-           theRocketId,
-           theRocketName) ;
+    char theJson[kJsonBufferSize] ;
+    int theJsonLen = snprintf(theJson, sizeof(theJson),
+      "{\"type\":\"fc_info\","
+      "\"version\":\"%s\","
+      "\"build\":\"%s\","
+      "\"bmp390\":%s,"
+      "\"lora\":%s,"
+      "\"imu\":%s,"
+      "\"oled\":%s,"
+      "\"gps\":%s,"
+      "\"state\":\"%s\","
+      "\"samples\":%lu,"
+      "\"rocket_id\":%u,"
+      "\"rocket_name\":\"%s\"",
+      theVersion,
+      theBuild,
+      (theFlags & 0x01) ? "true" : "false",
+      (theFlags & 0x02) ? "true" : "false",
+      (theFlags & 0x04) ? "true" : "false",
+      (theFlags & 0x10) ? "true" : "false",
+      (theFlags & 0x20) ? "true" : "false",
+      GatewayProtocol_GetStateName(theState),
+      (unsigned long)theSamples,
+      theRocketId,
+      theRocketName) ;
+
+    // The host command this answers, if it is still
+    // waiting for the rocket's reply
+    uint32_t theCommandId ;
+    if (CommandQueue_FindRequest(&sCommands, theRocketId, kCmdInfo, &theCommandId))
+    {
+      theJsonLen += snprintf(theJson + theJsonLen, sizeof(theJson) - theJsonLen,
+        ",\"id\":%lu", (unsigned long)theCommandId) ;
+    }
 
     // Add sensor type strings if present
     if (theBaroType[0] != '\0')
     {
-      printf(",\"baro_type\":\"%s\"", theBaroType) ;
+      theJsonLen += snprintf(theJson + theJsonLen, sizeof(theJson) - theJsonLen,
+        ",\"baro_type\":\"%s\"", theBaroType) ;
     }
     if (theImuType[0] != '\0')
     {
-      printf(",\"imu_type\":\"%s\"", theImuType) ;
+      theJsonLen += snprintf(theJson + theJsonLen, sizeof(theJson) - theJsonLen,
+        ",\"imu_type\":\"%s\"", theImuType) ;
+    }
+    if (theChannel >= 0)
+    {
+      theJsonLen += snprintf(theJson + theJsonLen, sizeof(theJson) - theJsonLen,
+        ",\"channel\":%d", theChannel) ;
+    }
+    if (theHasCounts)
+    {
+      theJsonLen += snprintf(theJson + theJsonLen, sizeof(theJson) - theJsonLen,
+        ",\"lbt_deferrals\":%u,\"lbt_forced\":%u,\"crc_errors\":%u",
+        theCounts[0], theCounts[1], theCounts[2]) ;
+    }
+    if (theHasDownlink)
+    {
+      theJsonLen += snprintf(theJson + theJsonLen, sizeof(theJson) - theJsonLen,
+        ",\"dl_delay_ms\":[%u,%u,%u,%u],\"dl_delay_max_ms\":[%u,%u,%u,%u],"
+        "\"dl_held\":%u,\"dl_dropped\":%u",
+        theDelays[0], theDelays[2], theDelays[4], theDelays[6],
+        theDelays[1], theDelays[3], theDelays[5], theDelays[7],
+        theDownlinkCounts[0], theDownlinkCounts[1]) ;
+    }
+    if (theHasSpi)
+    {
+      theJsonLen += snprintf(theJson + theJsonLen, sizeof(theJson) - theJsonLen,
+        ",\"spi_tx_us\":%u,\"spi_rx_us\":%u", theSpiUs[0], theSpiUs[1]) ;
+    }
+    if (theHasVerify)
+    {
+      theJsonLen += snprintf(theJson + theJsonLen, sizeof(theJson) - theJsonLen,
+        ",\"verify_us\":%lu", (unsigned long)theVerifyUs) ;
+    }
+    if (theSdKBps[0] != 0 || theSdKBps[1] != 0)
+    {
+      theJsonLen += snprintf(theJson + theJsonLen, sizeof(theJson) - theJsonLen,
+        ",\"sd_write_mbps\":%u.%03u,\"sd_read_mbps\":%u.%03u",
+        theSdKBps[0] / 1000, theSdKBps[0] % 1000, theSdKBps[1] / 1000, theSdKBps[1] % 1000) ;
     }
 
-    printf("}\n") ;
-    stdio_flush() ;
+    snprintf(theJson + theJsonLen, sizeof(theJson) - theJsonLen, "}\n") ;
+    OutputToUsb(theJson) ;
   }
-
-  // Return to receive mode
-  LoRa_StartReceive(&sLoRaRadio) ;
 }
 
 //----------------------------------------------
@@ -995,21 +2229,30 @@ static void ProcessUsbInput(uint32_t inCurrentMs)
 
         if (GatewayProtocol_ParseCommand(sUsbLineBuffer, &theCommandType, &theCommandId, &theRocketId))
         {
+          // The reply comes back on the target's channel
+          if (theRocketId >= 0)
+          {
+            ChannelPlan_Focus(&sChannels, (uint8_t)theRocketId, inCurrentMs, kChannelFocusMs) ;
+          }
+
           // Handle ping locally
           if (theCommandType == kUsbCmdPing)
           {
             char theResponse[64] ;
             GatewayProtocol_BuildAckJson(theCommandId, true, theResponse, sizeof(theResponse)) ;
-            printf("%s", theResponse) ;
-            stdio_flush() ;
+            OutputToUsb(theResponse) ;
           }
           // Handle status locally
           else if (theCommandType == kUsbCmdStatus)
           {
             char theResponse[kJsonBufferSize] ;
             GatewayProtocol_BuildStatusJson(&sGatewayState, theCommandId, theResponse, sizeof(theResponse)) ;
-            printf("%s", theResponse) ;
-            stdio_flush() ;
+            OutputToUsb(theResponse) ;
+          }
+          // Output format for this client
+          else if (theCommandType == kUsbCmdOutput)
+          {
+            SetOutputFormat(sUsbLineBuffer, false, theCommandId) ;
           }
           // Handle gateway info locally
           else if (theCommandType == kUsbCmdGatewayInfo)
@@ -1034,44 +2277,63 @@ static void ProcessUsbInput(uint32_t inCurrentMs)
 #endif
 
             // Build gateway device info JSON response
-            printf("{\"type\":\"gw_info\","
-                   "\"version\":\"%s\","
-                   "\"build\":\"%s %s\","
-                   "\"lora\":%s,"
-                   "\"baro\":%s,"
-                   "\"baro_type\":\"%s\","
-                   "\"gps\":%s,"
-                   "\"display\":%s,"
-                   "\"connected\":%s,"
-                   "\"rx\":%lu,"
-                   "\"tx\":%lu,"
-                   "\"rssi\":%d,"
-                   "\"snr\":%d,"
-                   "\"ground_pres\":%.0f,"
-                   "\"ground_temp\":%.1f,"
-                   "\"gps_fix\":%s,"
-                   "\"gps_lat\":%.6f,"
-                   "\"gps_lon\":%.6f,"
-                   "\"gps_sats\":%u}\n",
-                   FIRMWARE_VERSION_STRING,
-                   kBuildDate, kBuildTime,
-                   sLoRaOk ? "true" : "false",
-                   (sBmp581Ok || sBmp390Ok) ? "true" : "false",
-                   sBmp581Ok ? "BMP581" : (sBmp390Ok ? "BMP390" : "None"),
-                   sGpsOk ? "true" : "false",
-                   sDisplayOk ? "true" : "false",
-                   sGatewayState.pConnected ? "true" : "false",
-                   (unsigned long)sGatewayState.pPacketsReceived,
-                   (unsigned long)sGatewayState.pPacketsSent,
-                   sGatewayState.pLastRssi,
-                   sGatewayState.pLastSnr,
-                   sGroundPressurePa,
-                   sGroundTemperatureC,
-                   theGpsFix ? "true" : "false",
-                   theGpsLat,
-                   theGpsLon,
-                   theGpsSats) ;
-            stdio_flush() ;
+            char theJson[kJsonBufferSize] ;
+            snprintf(theJson, sizeof(theJson),
+              "{\"type\":\"gw_info\","
+              "\"version\":\"%s\","
+              "\"build\":\"%s %s\","
+              "\"lora\":%s,"
+              "\"baro\":%s,"
+              "\"baro_type\":\"%s\","
+              "\"gps\":%s,"
+              "\"display\":%s,"
+              "\"connected\":%s,"
+              "\"rx\":%lu,"
+              "\"tx\":%lu,"
+              "\"rssi\":%d,"
+              "\"snr\":%d,"
+              "\"ground_pres\":%.0f,"
+              "\"ground_temp\":%.1f,"
+              "\"gps_fix\":%s,"
+              "\"gps_lat\":%.6f,"
+              "\"gps_lon\":%.6f,"
+              "\"gps_sats\":%u}\n",
+              FIRMWARE_VERSION_STRING,
+              kBuildDate, kBuildTime,
+              sLoRaOk ? "true" : "false",
+              (sBmp581Ok || sBmp390Ok) ? "true" : "false",
+              sBmp581Ok ? "BMP581" : (sBmp390Ok ? "BMP390" : "None"),
+              sGpsOk ? "true" : "false",
+              sDisplayOk ? "true" : "false",
+              sGatewayState.pConnected ? "true" : "false",
+              (unsigned long)sGatewayState.pPacketsReceived,
+              (unsigned long)sGatewayState.pPacketsSent,
+              sGatewayState.pLastRssi,
+              sGatewayState.pLastSnr,
+              sGroundPressurePa,
+              sGroundTemperatureC,
+              theGpsFix ? "true" : "false",
+              theGpsLat,
+              theGpsLon,
+              theGpsSats) ;
+            OutputToUsb(theJson) ;
+          }
+          // Bulk flash download: the whole flight in one
+          // request, streamed back as flash_data messages
+          else if (theCommandType == kUsbCmdFlashBulk && sLoRaOk)
+          {
+            uint8_t theSlot = 0 ;
+            uint32_t theSample = 0 ;
+            bool theOk = GatewayProtocol_ParseFlashParams(sUsbLineBuffer, &theSlot, &theSample) &&
+              StartBulkDownload(theRocketId, theSlot, theCommandId, inCurrentMs) ;
+
+            char theResponse[64] ;
+            GatewayProtocol_BuildAckJson(theCommandId, theOk, theResponse, sizeof(theResponse)) ;
+            OutputToUsb(theResponse) ;
+            if (theOk)
+            {
+              ReportBulk("started", inCurrentMs) ;
+            }
           }
           // Handle flash read commands (slot and sample index)
           else if (theCommandType == kUsbCmdFlashRead && sLoRaOk)
@@ -1088,30 +2350,25 @@ static void ProcessUsbInput(uint32_t inCurrentMs)
 
               DEBUG_PRINT("CMD: Flash read slot=%u sample=%lu\n", theSlot, (unsigned long)theSample) ;
 
-              if (theLen > 0 && LoRa_SendBlocking(&sLoRaRadio, thePacket, theLen, 500))
+              if (theLen > 0 && SendCommand(thePacket, theLen, theCommandId, inCurrentMs))
               {
-                sGatewayState.pPacketsSent++ ;
                 char theResponse[64] ;
                 GatewayProtocol_BuildAckJson(theCommandId, true, theResponse, sizeof(theResponse)) ;
-                printf("%s", theResponse) ;
-                stdio_flush() ;
+                OutputToUsb(theResponse) ;
               }
               else
               {
                 char theResponse[64] ;
                 GatewayProtocol_BuildAckJson(theCommandId, false, theResponse, sizeof(theResponse)) ;
-                printf("%s", theResponse) ;
-                stdio_flush() ;
+                OutputToUsb(theResponse) ;
               }
-              LoRa_StartReceive(&sLoRaRadio) ;
             }
             else
             {
               DEBUG_PRINT("CMD: Flash read - failed to parse params\n") ;
               char theResponse[64] ;
               GatewayProtocol_BuildAckJson(theCommandId, false, theResponse, sizeof(theResponse)) ;
-              printf("%s", theResponse) ;
-              stdio_flush() ;
+              OutputToUsb(theResponse) ;
             }
           }
           // Handle flash delete commands (slot number)
@@ -1129,66 +2386,203 @@ static void ProcessUsbInput(uint32_t inCurrentMs)
 
               DEBUG_PRINT("CMD: Flash delete slot=%u\n", theSlot) ;
 
-              if (theLen > 0 && LoRa_SendBlocking(&sLoRaRadio, thePacket, theLen, 500))
+              if (theLen > 0 && SendCommand(thePacket, theLen, theCommandId, inCurrentMs))
+              {
+                char theResponse[64] ;
+                GatewayProtocol_BuildAckJson(theCommandId, true, theResponse, sizeof(theResponse)) ;
+                OutputToUsb(theResponse) ;
+              }
+              else
+              {
+                char theResponse[64] ;
+                GatewayProtocol_BuildAckJson(theCommandId, false, theResponse, sizeof(theResponse)) ;
+                OutputToUsb(theResponse) ;
+              }
+            }
+            else
+            {
+              DEBUG_PRINT("CMD: Flash delete - failed to parse params\n") ;
+              char theResponse[64] ;
+              GatewayProtocol_BuildAckJson(theCommandId, false, theResponse, sizeof(theResponse)) ;
+              OutputToUsb(theResponse) ;
+            }
+          }
+          // Handle orientation mode command (has enabled parameter)
+          else if ((theCommandType == kUsbCmdOrientationMode ||
+                    theCommandType == kUsbCmdCompactTelemetry ||
+                    theCommandType == kUsbCmdTelemetryBatch) && sLoRaOk)
+          {
+            bool theEnabled = false ;
+            if (GatewayProtocol_ParseOrientationModeEnabled(sUsbLineBuffer, &theEnabled))
+            {
+              uint8_t thePacket[8] ;
+              uint8_t theTarget = theRocketId < 0 ? 0xFF : (uint8_t)theRocketId ;
+              int theLen ;
+              if (theCommandType == kUsbCmdOrientationMode)
+              {
+                theLen = GatewayProtocol_BuildOrientationModeCommand(theTarget, theEnabled, thePacket, sizeof(thePacket)) ;
+              }
+              else if (theCommandType == kUsbCmdCompactTelemetry)
+              {
+                theLen = GatewayProtocol_BuildTelemetryFormatCommand(theTarget, theEnabled, thePacket, sizeof(thePacket)) ;
+              }
+              else
+              {
+                theLen = GatewayProtocol_BuildTelemetryBatchCommand(theTarget, theEnabled, thePacket, sizeof(thePacket)) ;
+              }
+
+              if (theLen > 0 && SendCommand(thePacket, theLen, theCommandId, inCurrentMs))
               {
-                sGatewayState.pPacketsSent++ ;
                 char theResponse[64] ;
                 GatewayProtocol_BuildAckJson(theCommandId, true, theResponse, sizeof(theResponse)) ;
-                printf("%s", theResponse) ;
-                stdio_flush() ;
+                OutputToUsb(theResponse) ;
               }
               else
               {
                 char theResponse[64] ;
                 GatewayProtocol_BuildAckJson(theCommandId, false, theResponse, sizeof(theResponse)) ;
-                printf("%s", theResponse) ;
-                stdio_flush() ;
+                OutputToUsb(theResponse) ;
               }
-              LoRa_StartReceive(&sLoRaRadio) ;
             }
             else
             {
-              DEBUG_PRINT("CMD: Flash delete - failed to parse params\n") ;
-              char theResponse[64] ;
-              GatewayProtocol_BuildAckJson(theCommandId, false, theResponse, sizeof(theResponse)) ;
-              printf("%s", theResponse) ;
-              stdio_flush() ;
+              char theResponse[64] ;
+              GatewayProtocol_BuildAckJson(theCommandId, false, theResponse, sizeof(theResponse)) ;
+              OutputToUsb(theResponse) ;
+            }
+          }
+          // TDMA schedule (handled locally): optional enable
+          // and slot length, answered with the statistics
+          else if (theCommandType == kUsbCmdTdma)
+          {
+            bool theEnabled = sTdma.pEnabled ;
+            uint16_t theSlotMs = 0 ;
+            GatewayProtocol_ParseTdmaParams(sUsbLineBuffer, &theEnabled, &theSlotMs) ;
+            bool theOk = TdmaScheduler_Configure(&sTdma, theEnabled, theSlotMs) ;
+            if (!sTdma.pEnabled)
+            {
+              LoRa_ClearTxWindow(&sLoRaRadio) ;
+            }
+
+            // slot_ms is for the base rate
+            if (theOk && theSlotMs != 0)
+            {
+              sTdmaBaseSlotMs = theSlotMs ;
+              RetimeTdma() ;
+            }
+
+            char theResponse[64] ;
+            GatewayProtocol_BuildAckJson(theCommandId, theOk, theResponse, sizeof(theResponse)) ;
+            OutputToUsb(theResponse) ;
+            ReportTdma(inCurrentMs) ;
+          }
+          else if (theCommandType == kUsbCmdDataRate)
+          {
+            bool theAuto = sRate.pAuto ;
+            int theRate = -1 ;
+            int theAttenDb = -1 ;
+            bool theReset = false ;
+            GatewayProtocol_ParseDataRateParams(sUsbLineBuffer, &theAuto, &theRate, &theAttenDb, &theReset) ;
+            bool theOk = RateControl_Configure(&sRate, theAuto, theRate, theAttenDb, theReset, inCurrentMs) ;
+
+            char theResponse[64] ;
+            GatewayProtocol_BuildAckJson(theCommandId, theOk, theResponse, sizeof(theResponse)) ;
+            OutputToUsb(theResponse) ;
+            ReportRate("stats", inCurrentMs) ;
+          }
+          else if (theCommandType == kUsbCmdAck)
+          {
+            int theIntervalMs = -1 ;
+            bool theNow = false ;
+            GatewayProtocol_ParseAckParams(sUsbLineBuffer, &theIntervalMs, &theNow) ;
+            bool theOk = AckSummary_Configure(&sAck, theIntervalMs, theNow) ;
+
+            char theResponse[64] ;
+            GatewayProtocol_BuildAckJson(theCommandId, theOk, theResponse, sizeof(theResponse)) ;
+            OutputToUsb(theResponse) ;
+            ReportAcks() ;
+          }
+          else if (theCommandType == kUsbCmdFec)
+          {
+            // Without a group size this only reports
+            bool theOk = true ;
+            int theGroup = GatewayProtocol_ParseFecParams(sUsbLineBuffer) ;
+            if (theGroup >= 0)
+            {
+              uint8_t thePacket[8] ;
+              uint8_t theTarget = theRocketId < 0 ? 0xFF : (uint8_t)theRocketId ;
+              int theLen = GatewayProtocol_BuildFecCommand(theTarget, (uint8_t)theGroup, thePacket, sizeof(thePacket)) ;
+              theOk = sLoRaOk && theLen > 0 && SendCommand(thePacket, theLen, theCommandId, inCurrentMs) ;
             }
+
+            char theResponse[64] ;
+            GatewayProtocol_BuildAckJson(theCommandId, theOk, theResponse, sizeof(theResponse)) ;
+            OutputToUsb(theResponse) ;
+            ReportFec(inCurrentMs) ;
           }
-          // Handle orientation mode command (has enabled parameter)
-          else if (theCommandType == kUsbCmdOrientationMode && sLoRaOk)
+          else if (theCommandType == kUsbCmdChannelPlan)
           {
-            bool theEnabled = false ;
+            // Without "enabled" this only reports
+            bool theOk = true ;
+            bool theEnabled ;
             if (GatewayProtocol_ParseOrientationModeEnabled(sUsbLineBuffer, &theEnabled))
             {
               uint8_t thePacket[8] ;
-              int theLen = GatewayProtocol_BuildOrientationModeCommand(theRocketId < 0 ? 0xFF : (uint8_t)theRocketId, theEnabled, thePacket, sizeof(thePacket)) ;
-
-              if (theLen > 0 && LoRa_SendBlocking(&sLoRaRadio, thePacket, theLen, 500))
-              {
-                sGatewayState.pPacketsSent++ ;
-                char theResponse[64] ;
-                GatewayProtocol_BuildAckJson(theCommandId, true, theResponse, sizeof(theResponse)) ;
-                printf("%s", theResponse) ;
-                stdio_flush() ;
-              }
-              else
+              uint8_t theTarget = theRocketId < 0 ? 0xFF : (uint8_t)theRocketId ;
+              int theLen = GatewayProtocol_BuildChannelPlanCommand(theTarget, theEnabled, thePacket, sizeof(thePacket)) ;
+              theOk = sLoRaOk && theLen > 0 && SendCommand(thePacket, theLen, theCommandId, inCurrentMs) ;
+              if (theOk)
               {
-                char theResponse[64] ;
-                GatewayProtocol_BuildAckJson(theCommandId, false, theResponse, sizeof(theResponse)) ;
-                printf("%s", theResponse) ;
-                stdio_flush() ;
+                ChannelPlan_SetRocketChannel(&sChannels, theTarget, theEnabled) ;
               }
+            }
 
-              LoRa_StartReceive(&sLoRaRadio) ;
+            char theResponse[64] ;
+            GatewayProtocol_BuildAckJson(theCommandId, theOk, theResponse, sizeof(theResponse)) ;
+            OutputToUsb(theResponse) ;
+            ReportChannels(inCurrentMs) ;
+          }
+          else if (theCommandType == kUsbCmdCommandQueue)
+          {
+            char theResponse[64] ;
+            GatewayProtocol_BuildAckJson(theCommandId, true, theResponse, sizeof(theResponse)) ;
+            OutputToUsb(theResponse) ;
+            ReportCommands(inCurrentMs) ;
+          }
+          else if (theCommandType == kUsbCmdTelemetryProfile)
+          {
+            bool theOk = false ;
+            uint8_t theProfile ;
+            uint16_t theIntervalMs ;
+            if (GatewayProtocol_ParseTelemetryProfileParams(sUsbLineBuffer, &theProfile, &theIntervalMs))
+            {
+              uint8_t thePacket[8] ;
+              uint8_t theTarget = theRocketId < 0 ? 0xFF : (uint8_t)theRocketId ;
+              int theLen = GatewayProtocol_BuildTelemetryProfileCommand(theTarget, theProfile, theIntervalMs,
+                thePacket, sizeof(thePacket)) ;
+              theOk = sLoRaOk && theLen > 0 && SendCommand(thePacket, theLen, theCommandId, inCurrentMs) ;
             }
-            else
+
+            char theResponse[64] ;
+            GatewayProtocol_BuildAckJson(theCommandId, theOk, theResponse, sizeof(theResponse)) ;
+            OutputToUsb(theResponse) ;
+          }
+          // Link benchmark: one rocket, on the ground;
+          // "started" follows once it answers
+          else if (theCommandType == kUsbCmdBenchmark && sLoRaOk)
+          {
+            uint8_t theParams[kBenchParamsLen] ;
+            bool theOk = theRocketId >= 0 &&
+              GatewayProtocol_ParseBenchmarkParams(sUsbLineBuffer, (uint8_t)(sBenchSession + 1), theParams) &&
+              StartBenchmark((uint8_t)theRocketId, theParams, inCurrentMs) ;
+            if (theOk)
             {
-              char theResponse[64] ;
-              GatewayProtocol_BuildAckJson(theCommandId, false, theResponse, sizeof(theResponse)) ;
-              printf("%s", theResponse) ;
-              stdio_flush() ;
+              sBenchSession++ ;
             }
+
+            char theResponse[64] ;
+            GatewayProtocol_BuildAckJson(theCommandId, theOk, theResponse, sizeof(theResponse)) ;
+            OutputToUsb(theResponse) ;
           }
 #if kEnableWifi
           // WiFi configuration commands (handled locally)
@@ -1210,8 +2604,7 @@ static void ProcessUsbInput(uint32_t inCurrentMs)
                 theConfig->networks[i].enabled ? "true" : "false") ;
             }
             theResponseLen += snprintf(theResponse + theResponseLen, sizeof(theResponse) - theResponseLen, "]}\n") ;
-            printf("%s", theResponse) ;
-            stdio_flush() ;
+            OutputToUsb(theResponse) ;
           }
           else if (theCommandType == kUsbCmdWifiAdd)
           {
@@ -1224,15 +2617,13 @@ static void ProcessUsbInput(uint32_t inCurrentMs)
               int theIdx = WifiConfig_AddNetwork(theSsid, thePassword, thePriority) ;
               char theResponse[64] ;
               GatewayProtocol_BuildAckJson(theCommandId, (theIdx >= 0), theResponse, sizeof(theResponse)) ;
-              printf("%s", theResponse) ;
-              stdio_flush() ;
+              OutputToUsb(theResponse) ;
             }
             else
             {
               char theResponse[64] ;
               GatewayProtocol_BuildAckJson(theCommandId, false, theResponse, sizeof(theResponse)) ;
-              printf("%s", theResponse) ;
-              stdio_flush() ;
+              OutputToUsb(theResponse) ;
             }
           }
           else if (theCommandType == kUsbCmdWifiRemove)
@@ -1243,15 +2634,13 @@ static void ProcessUsbInput(uint32_t inCurrentMs)
               bool theSuccess = WifiConfig_RemoveNetworkByIndex(theIndex) ;
               char theResponse[64] ;
               GatewayProtocol_BuildAckJson(theCommandId, theSuccess, theResponse, sizeof(theResponse)) ;
-              printf("%s", theResponse) ;
-              stdio_flush() ;
+              OutputToUsb(theResponse) ;
             }
             else
             {
               char theResponse[64] ;
               GatewayProtocol_BuildAckJson(theCommandId, false, theResponse, sizeof(theResponse)) ;
-              printf("%s", theResponse) ;
-              stdio_flush() ;
+              OutputToUsb(theResponse) ;
             }
           }
           else if (theCommandType == kUsbCmdWifiSave)
@@ -1259,8 +2648,7 @@ static void ProcessUsbInput(uint32_t inCurrentMs)
             bool theSuccess = WifiConfig_Save() ;
             char theResponse[64] ;
             GatewayProtocol_BuildAckJson(theCommandId, theSuccess, theResponse, sizeof(theResponse)) ;
-            printf("%s", theResponse) ;
-            stdio_flush() ;
+            OutputToUsb(theResponse) ;
           }
           else if (theCommandType == kUsbCmdWifiStatus)
           {
@@ -1279,8 +2667,7 @@ static void ProcessUsbInput(uint32_t inCurrentMs)
               theStatus->ip[0], theStatus->ip[1], theStatus->ip[2], theStatus->ip[3],
               theStatus->rssi,
               theStatus->connected ? "true" : "false") ;
-            printf("%s", theResponse) ;
-            stdio_flush() ;
+            OutputToUsb(theResponse) ;
           }
           else if (theCommandType == kUsbCmdWifiSetAp)
           {
@@ -1296,15 +2683,13 @@ static void ProcessUsbInput(uint32_t inCurrentMs)
                 theChannel) ;
               char theResponse[64] ;
               GatewayProtocol_BuildAckJson(theCommandId, true, theResponse, sizeof(theResponse)) ;
-              printf("%s", theResponse) ;
-              stdio_flush() ;
+              OutputToUsb(theResponse) ;
             }
             else
             {
               char theResponse[64] ;
               GatewayProtocol_BuildAckJson(theCommandId, false, theResponse, sizeof(theResponse)) ;
-              printf("%s", theResponse) ;
-              stdio_flush() ;
+              OutputToUsb(theResponse) ;
             }
           }
 #endif
@@ -1317,8 +2702,7 @@ static void ProcessUsbInput(uint32_t inCurrentMs)
               snprintf(theResponse, sizeof(theResponse),
                 "{\"type\":\"error\",\"id\":%lu,\"code\":\"NO_ROCKET_ID\",\"message\":\"rocket ID required\"}\n",
                 (unsigned long)theCommandId) ;
-              printf("%s", theResponse) ;
-              stdio_flush() ;
+              OutputToUsb(theResponse) ;
             }
             else
             {
@@ -1330,24 +2714,18 @@ static void ProcessUsbInput(uint32_t inCurrentMs)
             if (theLen > 0)
             {
               DEBUG_PRINT("CMD: Sending via LoRa...\n") ;
-              if (LoRa_SendBlocking(&sLoRaRadio, thePacket, theLen, 500))
+              if (SendCommand(thePacket, theLen, theCommandId, inCurrentMs))
               {
-                sGatewayState.pPacketsSent++ ;
                 char theResponse[64] ;
                 GatewayProtocol_BuildAckJson(theCommandId, true, theResponse, sizeof(theResponse)) ;
-                printf("%s", theResponse) ;
-                stdio_flush() ;
+                OutputToUsb(theResponse) ;
               }
               else
               {
                 char theResponse[64] ;
                 GatewayProtocol_BuildAckJson(theCommandId, false, theResponse, sizeof(theResponse)) ;
-                printf("%s", theResponse) ;
-                stdio_flush() ;
+                OutputToUsb(theResponse) ;
               }
-
-              // Return to receive mode
-              LoRa_StartReceive(&sLoRaRadio) ;
             }
             }  // else (theRocketId >= 0)
           }
@@ -1462,8 +2840,12 @@ static void UpdateDisplay(uint32_t inCurrentMs)
       GatewayDisplay_SetUsbConnected(sUsbConnected) ;
       if (sUsbConnected)
       {
-        printf("{\"type\":\"link\",\"status\":\"usb_connected\"}\n") ;
-        stdio_flush() ;
+        OutputToUsb("{\"type\":\"link\",\"status\":\"usb_connected\"}\n") ;
+      }
+      else
+      {
+        // The next host starts with JSON lines
+        sUsbBinary = false ;
       }
     }
   }
@@ -1523,9 +2905,83 @@ static void UpdateDisplay(uint32_t inCurrentMs)
 }
 
 //----------------------------------------------
-// WiFi Functions (conditional)
+// Output Functions
+//----------------------------------------------
+
 //----------------------------------------------
+// Function: EncodeText
+// Purpose: Frame a JSON line as a text record in
+//   sStreamFrame
+// Returns: Frame length, 0 if it does not fit
+//----------------------------------------------
+static size_t EncodeText(const char * inJson)
+{
+  size_t theLen = strlen(inJson) ;
+  if (theLen > 0 && inJson[theLen - 1] == '\n')
+  {
+    theLen-- ;
+  }
+  return GatewayStream_Encode(kStreamRecordText, (const uint8_t *)inJson, theLen,
+                              sStreamFrame, sizeof(sStreamFrame)) ;
+}
+
+//----------------------------------------------
+// Function: WriteUsb
+// Purpose: Write binary output to USB, past the
+//   stdio CR/LF translation
+//----------------------------------------------
+static void WriteUsb(const uint8_t * inData, size_t inLen)
+{
+  stdio_usb.out_chars((const char *)inData, (int)inLen) ;
+}
+
+//----------------------------------------------
+// Function: OutputToUsb
+// Purpose: Output JSON to USB only, in its
+//   format
+//----------------------------------------------
+static void OutputToUsb(const char * inJson)
+{
+  if (!sUsbBinary)
+  {
+    printf("%s", inJson) ;
+    stdio_flush() ;
+    return ;
+  }
+
+  size_t theLen = EncodeText(inJson) ;
+  if (theLen > 0)
+  {
+    WriteUsb(sStreamFrame, theLen) ;
+  }
+}
+
 #if kEnableWifi
+//----------------------------------------------
+// Function: OutputToWifi
+// Purpose: Output JSON to the WiFi client only,
+//   in its format
+//----------------------------------------------
+static void OutputToWifi(const char * inJson)
+{
+  if (!sWifiClientConnected || sWifiClientSocket < 0)
+  {
+    return ;
+  }
+
+  if (!sWifiBinary)
+  {
+    WiFi_Write(sWifiClientSocket, (const uint8_t *)inJson, strlen(inJson)) ;
+    return ;
+  }
+
+  size_t theLen = EncodeText(inJson) ;
+  if (theLen > 0)
+  {
+    WiFi_Write(sWifiClientSocket, sStreamFrame, theLen) ;
+  }
+}
+#endif
 
 //----------------------------------------------
 // Function: OutputToAll
@@ -1533,18 +2989,174 @@ static void UpdateDisplay(uint32_t inCurrentMs)
 //----------------------------------------------
 static void OutputToAll(const char * inJson)
 {
-  // Output to USB
-  printf("%s", inJson) ;
-  stdio_flush() ;
+  OutputToUsb(inJson) ;
+#if kEnableWifi
+  OutputToWifi(inJson) ;
+#endif
+}
+
+//----------------------------------------------
+// Function: OutputToJsonClients
+// Purpose: Output JSON to the clients reading
+//   JSON; binary clients get a record instead
+//----------------------------------------------
+static void OutputToJsonClients(const char * inJson)
+{
+  if (!sUsbBinary)
+  {
+    printf("%s", inJson) ;
+    stdio_flush() ;
+  }
+#if kEnableWifi
+  if (sWifiClientConnected && sWifiClientSocket >= 0 && !sWifiBinary)
+  {
+    WiFi_Write(sWifiClientSocket, (const uint8_t *)inJson, strlen(inJson)) ;
+  }
+#endif
+}
+
+//----------------------------------------------
+// Function: OutputRecord
+// Purpose: Output a binary record to the clients
+//   reading records
+//----------------------------------------------
+static void OutputRecord(uint8_t inType, const uint8_t * inPayload, size_t inLen)
+{
+  if (!IsBinaryWanted())
+  {
+    return ;
+  }
+
+  size_t theLen = GatewayStream_Encode(inType, inPayload, inLen, sStreamFrame, sizeof(sStreamFrame)) ;
+  if (theLen == 0)
+  {
+    return ;
+  }
+
+  if (sUsbBinary)
+  {
+    WriteUsb(sStreamFrame, theLen) ;
+  }
+#if kEnableWifi
+  if (sWifiClientConnected && sWifiClientSocket >= 0 && sWifiBinary)
+  {
+    WiFi_Write(sWifiClientSocket, sStreamFrame, theLen) ;
+  }
+#endif
+}
+
+//----------------------------------------------
+// Function: OutputFrameRecord
+// Purpose: Output a received LoRa frame, with the
+//   link figures it came in with, as a binary
+//   record
+//----------------------------------------------
+static void OutputFrameRecord(const uint8_t * inFrame, uint8_t inLen)
+{
+  uint8_t theRecord[kStreamFrameHeaderLen + kLoRaPacketMaxSize] ;
+  theRecord[0] = (uint8_t)(sGatewayState.pLastRssi & 0xFF) ;
+  theRecord[1] = (uint8_t)((sGatewayState.pLastRssi >> 8) & 0xFF) ;
+  theRecord[2] = (uint8_t)sGatewayState.pLastSnr ;
+  memcpy(&theRecord[kStreamFrameHeaderLen], inFrame, inLen) ;
+
+  OutputRecord(kStreamRecordFrame, theRecord, kStreamFrameHeaderLen + inLen) ;
+}
+
+//----------------------------------------------
+// Function: IsJsonWanted
+// Purpose: Whether any client reads JSON, so it
+//   is worth building
+//----------------------------------------------
+static bool IsJsonWanted(void)
+{
+#if kEnableWifi
+  if (sWifiClientConnected && !sWifiBinary)
+  {
+    return true ;
+  }
+#endif
+  return !sUsbBinary ;
+}
+
+//----------------------------------------------
+// Function: IsBinaryWanted
+// Purpose: Whether any client reads binary
+//   records
+//----------------------------------------------
+static bool IsBinaryWanted(void)
+{
+#if kEnableWifi
+  if (sWifiClientConnected && sWifiBinary)
+  {
+    return true ;
+  }
+#endif
+  return sUsbBinary ;
+}
+
+//----------------------------------------------
+// Function: SetOutputFormat
+// Purpose: Handle the output command: switch the
+//   client that sent it and answer in its new
+//   format
+// Parameters:
+//   inLine - Command line
+//   inIsWifi - Sent by the WiFi client, not USB
+//   inCommandId - Command ID being answered
+//----------------------------------------------
+static void SetOutputFormat(const char * inLine, bool inIsWifi, uint32_t inCommandId)
+{
+  bool * theBinary = &sUsbBinary ;
+#if kEnableWifi
+  if (inIsWifi)
+  {
+    theBinary = &sWifiBinary ;
+  }
+#else
+  (void)inIsWifi ;
+#endif
+
+  int theFormat = GatewayProtocol_ParseOutputParams(inLine) ;
+  if (theFormat >= 0 && (theFormat == kOutputFormatBinary) != *theBinary)
+  {
+    *theBinary = theFormat == kOutputFormatBinary ;
+
+    // A delimiter before the first record ends
+    // whatever partial line the reader holds
+    if (*theBinary)
+    {
+      const uint8_t theDelimiter = kStreamDelimiter ;
+#if kEnableWifi
+      if (inIsWifi)
+      {
+        WiFi_Write(sWifiClientSocket, &theDelimiter, 1) ;
+      }
+      else
+#endif
+      {
+        WriteUsb(&theDelimiter, 1) ;
+      }
+    }
+  }
 
-  // Output to WiFi client if connected
-  if (sWifiClientConnected && sWifiClientSocket >= 0)
+  char theResponse[96] ;
+  GatewayProtocol_BuildOutputJson(inCommandId, *theBinary ? kOutputFormatBinary : kOutputFormatJson,
+                                  theResponse, sizeof(theResponse)) ;
+#if kEnableWifi
+  if (inIsWifi)
   {
-    int theLen = strlen(inJson) ;
-    WiFi_Write(sWifiClientSocket, (const uint8_t *)inJson, theLen) ;
+    OutputToWifi(theResponse) ;
+    return ;
   }
+#endif
+  OutputToUsb(theResponse) ;
 }
 
+//----------------------------------------------
+// WiFi Functions (conditional)
+//----------------------------------------------
+#if kEnableWifi
+
 //----------------------------------------------
 // Function: ProcessWifiInput
 // Purpose: Process incoming WiFi commands
@@ -1591,8 +3203,6 @@ static void ProcessWifiInput(uint32_t inCurrentMs)
 //----------------------------------------------
 static void ProcessCommandLine(const char * inLine, bool inIsWifi)
 {
-  (void)inIsWifi ;  // Could be used to route responses differently
-
   // Parse command
   UsbCommandType theCommandType ;
   uint32_t theCommandId ;
@@ -1603,6 +3213,13 @@ static void ProcessCommandLine(const char * inLine, bool inIsWifi)
     return ;
   }
 
+  // The reply comes back on the target's channel
+  uint32_t theCurrentMs = to_ms_since_boot(get_absolute_time()) ;
+  if (theRocketId >= 0)
+  {
+    ChannelPlan_Focus(&sChannels, (uint8_t)theRocketId, theCurrentMs, kChannelFocusMs) ;
+  }
+
   // Handle ping locally
   if (theCommandType == kUsbCmdPing)
   {
@@ -1617,6 +3234,11 @@ static void ProcessCommandLine(const char * inLine, bool inIsWifi)
     GatewayProtocol_BuildStatusJson(&sGatewayState, theCommandId, theResponse, sizeof(theResponse)) ;
     OutputToAll(theResponse) ;
   }
+  // Output format for this client
+  else if (theCommandType == kUsbCmdOutput)
+  {
+    SetOutputFormat(inLine, inIsWifi, theCommandId) ;
+  }
   // Handle gateway info locally
   else if (theCommandType == kUsbCmdGatewayInfo)
   {
@@ -1686,6 +3308,22 @@ static void ProcessCommandLine(const char * inLine, bool inIsWifi)
     OutputToAll(theResponse) ;
   }
   // Handle flash list/read/delete commands
+  else if (theCommandType == kUsbCmdFlashBulk && sLoRaOk)
+  {
+    uint8_t theSlot = 0 ;
+    uint32_t theSample = 0 ;
+    uint32_t theNowMs = to_ms_since_boot(get_absolute_time()) ;
+    bool theOk = GatewayProtocol_ParseFlashParams(inLine, &theSlot, &theSample) &&
+      StartBulkDownload(theRocketId, theSlot, theNowMs) ;
+
+    char theResponse[64] ;
+    GatewayProtocol_BuildAckJson(theCommandId, theOk, theResponse, sizeof(theResponse)) ;
+    OutputToAll(theResponse) ;
+    if (theOk)
+    {
+      ReportBulk("started", theNowMs) ;
+    }
+  }
   else if (theCommandType == kUsbCmdFlashRead && sLoRaOk)
   {
     uint8_t theSlot = 0 ;
@@ -1698,9 +3336,8 @@ static void ProcessCommandLine(const char * inLine, bool inIsWifi)
         theRocketId < 0 ? 0xFF : (uint8_t)theRocketId,
         theSlot, theSample, thePacket, sizeof(thePacket)) ;
 
-      if (theLen > 0 && LoRa_SendBlocking(&sLoRaRadio, thePacket, theLen, 500))
+      if (theLen > 0 && SendCommand(thePacket, theLen, theCommandId, theCurrentMs))
       {
-        sGatewayState.pPacketsSent++ ;
         char theResponse[64] ;
         GatewayProtocol_BuildAckJson(theCommandId, true, theResponse, sizeof(theResponse)) ;
         OutputToAll(theResponse) ;
@@ -1711,7 +3348,6 @@ static void ProcessCommandLine(const char * inLine, bool inIsWifi)
         GatewayProtocol_BuildAckJson(theCommandId, false, theResponse, sizeof(theResponse)) ;
         OutputToAll(theResponse) ;
       }
-      LoRa_StartReceive(&sLoRaRadio) ;
     }
     else
     {
@@ -1732,9 +3368,8 @@ static void ProcessCommandLine(const char * inLine, bool inIsWifi)
         theRocketId < 0 ? 0xFF : (uint8_t)theRocketId,
         theSlot, thePacket, sizeof(thePacket)) ;
 
-      if (theLen > 0 && LoRa_SendBlocking(&sLoRaRadio, thePacket, theLen, 500))
+      if (theLen > 0 && SendCommand(thePacket, theLen, theCommandId, theCurrentMs))
       {
-        sGatewayState.pPacketsSent++ ;
         char theResponse[64] ;
         GatewayProtocol_BuildAckJson(theCommandId, true, theResponse, sizeof(theResponse)) ;
         OutputToAll(theResponse) ;
@@ -1745,7 +3380,6 @@ static void ProcessCommandLine(const char * inLine, bool inIsWifi)
         GatewayProtocol_BuildAckJson(theCommandId, false, theResponse, sizeof(theResponse)) ;
         OutputToAll(theResponse) ;
       }
-      LoRa_StartReceive(&sLoRaRadio) ;
     }
     else
     {
@@ -1754,17 +3388,31 @@ static void ProcessCommandLine(const char * inLine, bool inIsWifi)
       OutputToAll(theResponse) ;
     }
   }
-  else if (theCommandType == kUsbCmdOrientationMode && sLoRaOk)
+  else if ((theCommandType == kUsbCmdOrientationMode ||
+            theCommandType == kUsbCmdCompactTelemetry ||
+            theCommandType == kUsbCmdTelemetryBatch) && sLoRaOk)
   {
     bool theEnabled = false ;
     if (GatewayProtocol_ParseOrientationModeEnabled(inLine, &theEnabled))
     {
       uint8_t thePacket[8] ;
-      int theLen = GatewayProtocol_BuildOrientationModeCommand(theRocketId < 0 ? 0xFF : (uint8_t)theRocketId, theEnabled, thePacket, sizeof(thePacket)) ;
+      uint8_t theTarget = theRocketId < 0 ? 0xFF : (uint8_t)theRocketId ;
+      int theLen ;
+      if (theCommandType == kUsbCmdOrientationMode)
+      {
+        theLen = GatewayProtocol_BuildOrientationModeCommand(theTarget, theEnabled, thePacket, sizeof(thePacket)) ;
+      }
+      else if (theCommandType == kUsbCmdCompactTelemetry)
+      {
+        theLen = GatewayProtocol_BuildTelemetryFormatCommand(theTarget, theEnabled, thePacket, sizeof(thePacket)) ;
+      }
+      else
+      {
+        theLen = GatewayProtocol_BuildTelemetryBatchCommand(theTarget, theEnabled, thePacket, sizeof(thePacket)) ;
+      }
 
-      if (theLen > 0 && LoRa_SendBlocking(&sLoRaRadio, thePacket, theLen, 500))
+      if (theLen > 0 && SendCommand(thePacket, theLen, theCommandId, theCurrentMs))
       {
-        sGatewayState.pPacketsSent++ ;
         char theResponse[64] ;
         GatewayProtocol_BuildAckJson(theCommandId, true, theResponse, sizeof(theResponse)) ;
         OutputToAll(theResponse) ;
@@ -1775,7 +3423,6 @@ static void ProcessCommandLine(const char * inLine, bool inIsWifi)
         GatewayProtocol_BuildAckJson(theCommandId, false, theResponse, sizeof(theResponse)) ;
         OutputToAll(theResponse) ;
       }
-      LoRa_StartReceive(&sLoRaRadio) ;
     }
     else
     {
@@ -1784,6 +3431,137 @@ static void ProcessCommandLine(const char * inLine, bool inIsWifi)
       OutputToAll(theResponse) ;
     }
   }
+  // TDMA schedule (handled locally)
+  else if (theCommandType == kUsbCmdTdma)
+  {
+    bool theEnabled = sTdma.pEnabled ;
+    uint16_t theSlotMs = 0 ;
+    GatewayProtocol_ParseTdmaParams(inLine, &theEnabled, &theSlotMs) ;
+    bool theOk = TdmaScheduler_Configure(&sTdma, theEnabled, theSlotMs) ;
+    if (!sTdma.pEnabled)
+    {
+      LoRa_ClearTxWindow(&sLoRaRadio) ;
+    }
+
+    // slot_ms is for the base rate
+    if (theOk && theSlotMs != 0)
+    {
+      sTdmaBaseSlotMs = theSlotMs ;
+      RetimeTdma() ;
+    }
+
+    char theResponse[64] ;
+    GatewayProtocol_BuildAckJson(theCommandId, theOk, theResponse, sizeof(theResponse)) ;
+    OutputToAll(theResponse) ;
+    ReportTdma(to_ms_since_boot(get_absolute_time())) ;
+  }
+  else if (theCommandType == kUsbCmdDataRate)
+  {
+    uint32_t theNowMs = to_ms_since_boot(get_absolute_time()) ;
+    bool theAuto = sRate.pAuto ;
+    int theRate = -1 ;
+    int theAttenDb = -1 ;
+    bool theReset = false ;
+    GatewayProtocol_ParseDataRateParams(inLine, &theAuto, &theRate, &theAttenDb, &theReset) ;
+    bool theOk = RateControl_Configure(&sRate, theAuto, theRate, theAttenDb, theReset, theNowMs) ;
+
+    char theResponse[64] ;
+    GatewayProtocol_BuildAckJson(theCommandId, theOk, theResponse, sizeof(theResponse)) ;
+    OutputToAll(theResponse) ;
+    ReportRate("stats", theNowMs) ;
+  }
+  else if (theCommandType == kUsbCmdAck)
+  {
+    int theIntervalMs = -1 ;
+    bool theNow = false ;
+    GatewayProtocol_ParseAckParams(inLine, &theIntervalMs, &theNow) ;
+    bool theOk = AckSummary_Configure(&sAck, theIntervalMs, theNow) ;
+
+    char theResponse[64] ;
+    GatewayProtocol_BuildAckJson(theCommandId, theOk, theResponse, sizeof(theResponse)) ;
+    OutputToAll(theResponse) ;
+    ReportAcks() ;
+  }
+  else if (theCommandType == kUsbCmdFec)
+  {
+    // Without a group size this only reports
+    bool theOk = true ;
+    int theGroup = GatewayProtocol_ParseFecParams(inLine) ;
+    if (theGroup >= 0)
+    {
+      uint8_t thePacket[8] ;
+      uint8_t theTarget = theRocketId < 0 ? 0xFF : (uint8_t)theRocketId ;
+      int theLen = GatewayProtocol_BuildFecCommand(theTarget, (uint8_t)theGroup, thePacket, sizeof(thePacket)) ;
+      theOk = sLoRaOk && theLen > 0 && SendCommand(thePacket, theLen, theCommandId, theCurrentMs) ;
+    }
+
+    char theResponse[64] ;
+    GatewayProtocol_BuildAckJson(theCommandId, theOk, theResponse, sizeof(theResponse)) ;
+    OutputToAll(theResponse) ;
+    ReportFec(to_ms_since_boot(get_absolute_time())) ;
+  }
+  else if (theCommandType == kUsbCmdChannelPlan)
+  {
+    // Without "enabled" this only reports
+    bool theOk = true ;
+    bool theEnabled ;
+    if (GatewayProtocol_ParseOrientationModeEnabled(inLine, &theEnabled))
+    {
+      uint8_t thePacket[8] ;
+      uint8_t theTarget = theRocketId < 0 ? 0xFF : (uint8_t)theRocketId ;
+      int theLen = GatewayProtocol_BuildChannelPlanCommand(theTarget, theEnabled, thePacket, sizeof(thePacket)) ;
+      theOk = sLoRaOk && theLen > 0 && SendCommand(thePacket, theLen, theCommandId, theCurrentMs) ;
+      if (theOk)
+      {
+        ChannelPlan_SetRocketChannel(&sChannels, theTarget, theEnabled) ;
+      }
+    }
+
+    char theResponse[64] ;
+    GatewayProtocol_BuildAckJson(theCommandId, theOk, theResponse, sizeof(theResponse)) ;
+    OutputToAll(theResponse) ;
+    ReportChannels(to_ms_since_boot(get_absolute_time())) ;
+  }
+  else if (theCommandType == kUsbCmdCommandQueue)
+  {
+    char theResponse[64] ;
+    GatewayProtocol_BuildAckJson(theCommandId, true, theResponse, sizeof(theResponse)) ;
+    OutputToAll(theResponse) ;
+    ReportCommands(theCurrentMs) ;
+  }
+  else if (theCommandType == kUsbCmdTelemetryProfile)
+  {
+    bool theOk = false ;
+    uint8_t theProfile ;
+    uint16_t theIntervalMs ;
+    if (GatewayProtocol_ParseTelemetryProfileParams(inLine, &theProfile, &theIntervalMs))
+    {
+      uint8_t thePacket[8] ;
+      uint8_t theTarget = theRocketId < 0 ? 0xFF : (uint8_t)theRocketId ;
+      int theLen = GatewayProtocol_BuildTelemetryProfileCommand(theTarget, theProfile, theIntervalMs,
+        thePacket, sizeof(thePacket)) ;
+      theOk = sLoRaOk && theLen > 0 && SendCommand(thePacket, theLen, theCommandId, theCurrentMs) ;
+    }
+
+    char theResponse[64] ;
+    GatewayProtocol_BuildAckJson(theCommandId, theOk, theResponse, sizeof(theResponse)) ;
+    OutputToAll(theResponse) ;
+  }
+  else if (theCommandType == kUsbCmdBenchmark && sLoRaOk)
+  {
+    uint8_t theParams[kBenchParamsLen] ;
+    bool theOk = theRocketId >= 0 &&
+      GatewayProtocol_ParseBenchmarkParams(inLine, (uint8_t)(sBenchSession + 1), theParams) &&
+      StartBenchmark((uint8_t)theRocketId, theParams, theCurrentMs) ;
+    if (theOk)
+    {
+      sBenchSession++ ;
+    }
+
+    char theResponse[64] ;
+    GatewayProtocol_BuildAckJson(theCommandId, theOk, theResponse, sizeof(theResponse)) ;
+    OutputToAll(theResponse) ;
+  }
   // WiFi configuration commands (handled locally)
   else if (theCommandType == kUsbCmdWifiList)
   {
@@ -1910,9 +3688,8 @@ static void ProcessCommandLine(const char * inLine, bool inIsWifi)
 
       if (theLen > 0)
       {
-        if (LoRa_SendBlocking(&sLoRaRadio, thePacket, theLen, 500))
+        if (SendCommand(thePacket, theLen, theCommandId, theCurrentMs))
         {
-          sGatewayState.pPacketsSent++ ;
           char theResponse[64] ;
           GatewayProtocol_BuildAckJson(theCommandId, true, theResponse, sizeof(theResponse)) ;
           OutputToAll(theResponse) ;
@@ -1923,7 +3700,6 @@ static void ProcessCommandLine(const char * inLine, bool inIsWifi)
           GatewayProtocol_BuildAckJson(theCommandId, false, theResponse, sizeof(theResponse)) ;
           OutputToAll(theResponse) ;
         }
-        LoRa_StartReceive(&sLoRaRadio) ;
       }
     }
   }
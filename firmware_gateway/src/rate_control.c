@@ -0,0 +1,649 @@
+//----------------------------------------------
+// Module: rate_control.c
+// Description: Adaptive LoRa data rate (gateway
+//   side: margin estimate, handshake, fallback)
+// Author: Mark Gavin
+// Created: 2026-02-14
+// Copyright: (c) 2025-2026 by Mark Gavin
+// License: Proprietary - All Rights Reserved
+// Modified: 2026-02-16 (JSON writer)
+// Modified: 2026-02-16 (bulk download rate)
+//----------------------------------------------
+
+#include "rate_control.h"
+#include "gateway_protocol.h"
+#include "json_writer.h"
+
+#include <string.h>
+
+//----------------------------------------------
+// Internal: Bandwidth in kHz (table rates only)
+//----------------------------------------------
+static uint16_t BandwidthKhz(LoRa_Bandwidth inBW)
+{
+  switch (inBW)
+  {
+    case LORA_BW_125: return 125 ;
+    case LORA_BW_250: return 250 ;
+    case LORA_BW_500: return 500 ;
+    default: return 0 ;
+  }
+}
+
+//----------------------------------------------
+// Internal: Account Time
+// Adds the time since the last call to the rate
+// in use
+//----------------------------------------------
+static void AccountTime(RateControl * ioControl, uint32_t inNowMs)
+{
+  ioControl->pStats[ioControl->pRate].pMs += inNowMs - ioControl->pAccountedMs ;
+  ioControl->pAccountedMs = inNowMs ;
+}
+
+//----------------------------------------------
+// Internal: Set Rate
+// SNR readings and frame spacings taken at the
+// old rate no longer apply
+//----------------------------------------------
+static void SetRate(RateControl * ioControl, uint8_t inRate, uint32_t inNowMs)
+{
+  AccountTime(ioControl, inNowMs) ;
+  ioControl->pRate = inRate ;
+  ioControl->pRateSinceMs = inNowMs ;
+  ioControl->pAnnounceMs = inNowMs ;
+  ioControl->pPhase = kRatePhaseIdle ;
+
+  for (int i = 0 ; i < kRateMaxRockets ; i++)
+  {
+    ioControl->pRockets[i].pSnrCount = 0 ;
+    ioControl->pRockets[i].pSnrNext = 0 ;
+    ioControl->pRockets[i].pIntervalMs = 0 ;
+  }
+}
+
+//----------------------------------------------
+// Internal: Add SNR Sample
+//----------------------------------------------
+static void AddSnr(RateRocket * ioRocket, int8_t inSnr)
+{
+  ioRocket->pSnr[ioRocket->pSnrNext] = inSnr ;
+  ioRocket->pSnrNext = (ioRocket->pSnrNext + 1) % kRateSnrWindow ;
+  if (ioRocket->pSnrCount < kRateSnrWindow)
+  {
+    ioRocket->pSnrCount++ ;
+  }
+}
+
+//----------------------------------------------
+// Internal: Worst Link
+// Lowest average SNR over the active rockets.
+// Returns false if none has inMinSamples yet.
+//----------------------------------------------
+static bool WorstSnr(
+  const RateControl * inControl,
+  uint8_t inMinSamples,
+  int16_t * outSnr)
+{
+  bool theFound = false ;
+  for (int i = 0 ; i < kRateMaxRockets ; i++)
+  {
+    const RateRocket * theRocket = &inControl->pRockets[i] ;
+    if (!theRocket->pActive)
+    {
+      continue ;
+    }
+
+    // One rocket short of samples holds the decision
+    if (theRocket->pSnrCount < inMinSamples)
+    {
+      return false ;
+    }
+
+    int16_t theSum = 0 ;
+    for (int j = 0 ; j < theRocket->pSnrCount ; j++)
+    {
+      theSum += theRocket->pSnr[j] ;
+    }
+    int16_t theAverage = theSum / theRocket->pSnrCount ;
+    if (!theFound || theAverage < *outSnr)
+    {
+      *outSnr = theAverage ;
+      theFound = true ;
+    }
+  }
+  return theFound ;
+}
+
+//----------------------------------------------
+// Internal: Margin
+// SNR measured at the rate in use, moved to the
+// noise bandwidth of inRate, over its floor
+//----------------------------------------------
+static int16_t Margin(const RateControl * inControl, int16_t inSnr, uint8_t inRate)
+{
+  const LoRa_DataRate * theNow = LoRa_GetDataRate(inControl->pRate) ;
+  const LoRa_DataRate * theTo = LoRa_GetDataRate(inRate) ;
+  return inSnr + theNow->pNoiseDb - theTo->pNoiseDb - theTo->pMinSnrDb ;
+}
+
+//----------------------------------------------
+// Internal: Choose Rate
+//----------------------------------------------
+static uint8_t ChooseRate(const RateControl * inControl, uint32_t inNowMs)
+{
+  if (!inControl->pAuto)
+  {
+    return inControl->pManualRate ;
+  }
+
+  uint8_t theRate = inControl->pRate ;
+  int16_t theSnr ;
+
+  // Too little margin: the fastest rate with enough
+  if (WorstSnr(inControl, kRateDownSamples, &theSnr) &&
+      Margin(inControl, theSnr, theRate) < kRateMarginDownDb)
+  {
+    while (theRate > 0 && Margin(inControl, theSnr, theRate) < kRateMarginUpDb)
+    {
+      theRate-- ;
+    }
+    return theRate ;
+  }
+
+  // Plenty: one step up once settled
+  if (theRate + 1 < kLoRaDataRateCount &&
+      (inNowMs - inControl->pRateSinceMs) >= kRateHoldMs &&
+      WorstSnr(inControl, kRateSnrWindow, &theSnr) &&
+      Margin(inControl, theSnr, theRate + 1) >= kRateMarginUpDb)
+  {
+    return theRate + 1 ;
+  }
+
+  return theRate ;
+}
+
+//----------------------------------------------
+// Internal: Build Command
+//----------------------------------------------
+static int BuildCommand(
+  uint8_t inPhase,
+  uint8_t inToken,
+  uint8_t inRate,
+  uint8_t * outPacket,
+  int inMaxLen)
+{
+  if (inMaxLen < kRateCommandLen) return 0 ;
+
+  outPacket[0] = kLoRaMagic ;
+  outPacket[1] = kLoRaPacketCommand ;
+  outPacket[2] = 0xFF ;           // Every rocket
+  outPacket[3] = kCmdDataRate ;
+  outPacket[4] = inPhase ;
+  outPacket[5] = inToken ;
+  outPacket[6] = inRate ;
+  return kRateCommandLen ;
+}
+
+//----------------------------------------------
+// Function: RateControl_Init
+//----------------------------------------------
+void RateControl_Init(RateControl * outControl, uint32_t inNowMs)
+{
+  memset(outControl, 0, sizeof(RateControl)) ;
+  outControl->pAuto = true ;
+  outControl->pRate = kLoRaDataRateBase ;
+  outControl->pManualRate = kLoRaDataRateBase ;
+  outControl->pRateSinceMs = inNowMs ;
+  outControl->pNextChangeMs = inNowMs ;
+  outControl->pStatsStartMs = inNowMs ;
+  outControl->pLastStatsMs = inNowMs ;
+  outControl->pAccountedMs = inNowMs ;
+}
+
+//----------------------------------------------
+// Function: RateControl_Configure
+//----------------------------------------------
+bool RateControl_Configure(
+  RateControl * ioControl,
+  bool inAuto,
+  int inRate,
+  int inAttenDb,
+  bool inReset,
+  uint32_t inNowMs)
+{
+  if (inRate >= kLoRaDataRateCount || inAttenDb > kRateMaxAttenDb)
+  {
+    return false ;
+  }
+
+  // A fixed rate, or hold the one in use
+  if (inRate >= 0)
+  {
+    ioControl->pAuto = false ;
+    ioControl->pManualRate = (uint8_t)inRate ;
+  }
+  else
+  {
+    ioControl->pAuto = inAuto ;
+    ioControl->pManualRate = ioControl->pRate ;
+  }
+  ioControl->pNextChangeMs = inNowMs ;
+
+  if (inAttenDb >= 0)
+  {
+    ioControl->pAttenDb = (int8_t)inAttenDb ;
+  }
+
+  if (inReset)
+  {
+    memset(ioControl->pStats, 0, sizeof(ioControl->pStats)) ;
+    ioControl->pSwitches = 0 ;
+    ioControl->pFallbacks = 0 ;
+    ioControl->pAborted = 0 ;
+    ioControl->pStatsStartMs = inNowMs ;
+    ioControl->pAccountedMs = inNowMs ;
+  }
+
+  return true ;
+}
+
+//----------------------------------------------
+// Function: RateControl_ApplyLinkBudget
+//----------------------------------------------
+bool RateControl_ApplyLinkBudget(
+  RateControl * ioControl,
+  int16_t * ioRssi,
+  int8_t * ioSnr)
+{
+  if (ioControl->pAttenDb == 0)
+  {
+    return true ;
+  }
+
+  *ioRssi -= ioControl->pAttenDb ;
+  int16_t theSnr = *ioSnr - ioControl->pAttenDb ;
+  *ioSnr = theSnr < -128 ? -128 : (int8_t)theSnr ;
+
+  if (theSnr < LoRa_GetDataRate(ioControl->pRate)->pMinSnrDb)
+  {
+    ioControl->pStats[ioControl->pRate].pDropped++ ;
+    return false ;
+  }
+
+  return true ;
+}
+
+//----------------------------------------------
+// Function: RateControl_RecordFrame
+//----------------------------------------------
+void RateControl_RecordFrame(
+  RateControl * ioControl,
+  uint8_t inRocketId,
+  uint8_t inSequence,
+  uint8_t inLen,
+  int8_t inSnr,
+  uint32_t inNowMs)
+{
+  if (inRocketId >= kRateMaxRockets)
+  {
+    return ;
+  }
+
+  RateRocket * theRocket = &ioControl->pRockets[inRocketId] ;
+  RateStats * theStats = &ioControl->pStats[ioControl->pRate] ;
+
+  // Same sequence rules as the TDMA statistics
+  if (theRocket->pActive && theRocket->pSequenceValid)
+  {
+    uint8_t theStep = (uint8_t)(inSequence - theRocket->pLastSequence) ;
+    if (theStep > 1 && theStep < 128)
+    {
+      theStats->pLost += theStep - 1 ;
+    }
+  }
+
+  // Frame spacing, smoothed over about four frames
+  uint32_t theGapMs = inNowMs - theRocket->pLastHeardMs ;
+  if (theRocket->pActive && theGapMs < kRateActiveMs)
+  {
+    if (theGapMs < kRateMinIntervalMs) theGapMs = kRateMinIntervalMs ;
+    if (theGapMs > kRateMaxIntervalMs) theGapMs = kRateMaxIntervalMs ;
+    theRocket->pIntervalMs = theRocket->pIntervalMs == 0 ?
+      theGapMs : (3 * theRocket->pIntervalMs + theGapMs) / 4 ;
+  }
+
+  theRocket->pActive = true ;
+  theRocket->pSequenceValid = true ;
+  theRocket->pLastSequence = inSequence ;
+  theRocket->pLastHeardMs = inNowMs ;
+  AddSnr(theRocket, inSnr) ;
+
+  theStats->pFrames++ ;
+  theStats->pBytes += inLen ;
+}
+
+//----------------------------------------------
+// Function: RateControl_ProcessConfirm
+//----------------------------------------------
+bool RateControl_ProcessConfirm(
+  RateControl * ioControl,
+  const uint8_t * inPacket,
+  int inLen,
+  uint32_t inNowMs)
+{
+  if (inPacket == NULL || inLen < kRateConfirmLen ||
+      inPacket[0] != kLoRaMagic || inPacket[1] != kLoRaPacketRateAck ||
+      inPacket[2] >= kRateMaxRockets)
+  {
+    return false ;
+  }
+
+  RateRocket * theRocket = &ioControl->pRockets[inPacket[2]] ;
+  theRocket->pActive = true ;
+  theRocket->pLastHeardMs = inNowMs ;
+  theRocket->pDownlinkSnr = (int8_t)inPacket[6] ;
+
+  // The downlink counts toward the margin too
+  AddSnr(theRocket, theRocket->pDownlinkSnr) ;
+
+  if (ioControl->pPhase != kRatePhaseProposing ||
+      inPacket[3] != ioControl->pToken || inPacket[4] != ioControl->pTarget)
+  {
+    return true ;
+  }
+
+  if (inPacket[5] == 0)
+  {
+    ioControl->pPhase = kRatePhaseIdle ;
+    ioControl->pNextChangeMs = inNowMs + kRateFallbackHoldMs ;
+    ioControl->pAborted++ ;
+    return true ;
+  }
+
+  theRocket->pConfirmed = true ;
+  return true ;
+}
+
+//----------------------------------------------
+// Function: RateControl_CheckSilence
+//----------------------------------------------
+bool RateControl_CheckSilence(RateControl * ioControl, uint32_t inNowMs, bool inPaused)
+{
+  bool theMissed = false ;
+
+  for (int i = 0 ; i < kRateMaxRockets ; i++)
+  {
+    RateRocket * theRocket = &ioControl->pRockets[i] ;
+    if (!theRocket->pActive)
+    {
+      continue ;
+    }
+
+    if (inPaused)
+    {
+      theRocket->pLastHeardMs = inNowMs ;
+      continue ;
+    }
+
+    uint32_t theSilentMs = inNowMs - theRocket->pLastHeardMs ;
+    if (theSilentMs >= kRateActiveMs)
+    {
+      theRocket->pActive = false ;
+      theRocket->pSequenceValid = false ;
+      theRocket->pSnrCount = 0 ;
+      theRocket->pSnrNext = 0 ;
+      theRocket->pIntervalMs = 0 ;
+      continue ;
+    }
+
+    uint32_t theIntervalMs = theRocket->pIntervalMs != 0 ?
+      theRocket->pIntervalMs : kRateMaxIntervalMs ;
+    if (theSilentMs >= kRateMaxMisses * theIntervalMs)
+    {
+      theMissed = true ;
+    }
+  }
+
+  if (!theMissed || ioControl->pRate == kLoRaDataRateBase)
+  {
+    return false ;
+  }
+
+  SetRate(ioControl, kLoRaDataRateBase, inNowMs) ;
+  ioControl->pNextChangeMs = inNowMs + kRateFallbackHoldMs ;
+  ioControl->pFallbacks++ ;
+  return true ;
+}
+
+//----------------------------------------------
+// Function: RateControl_NextCommand
+//----------------------------------------------
+int RateControl_NextCommand(
+  RateControl * ioControl,
+  uint32_t inNowMs,
+  uint32_t inConfirmWaitMs,
+  uint8_t * outPacket,
+  int inMaxLen,
+  bool * outAnnounce)
+{
+  *outAnnounce = false ;
+
+  if (ioControl->pPhase == kRatePhaseProposing)
+  {
+    // Every active rocket is in: commit
+    bool theAll = true ;
+    for (int i = 0 ; i < kRateMaxRockets ; i++)
+    {
+      if (ioControl->pRockets[i].pActive && !ioControl->pRockets[i].pConfirmed)
+      {
+        theAll = false ;
+      }
+    }
+
+    if (theAll)
+    {
+      SetRate(ioControl, ioControl->pTarget, inNowMs) ;
+      ioControl->pSwitches++ ;
+      return BuildCommand(kRateCommit, ioControl->pToken, ioControl->pRate, outPacket, inMaxLen) ;
+    }
+
+    if ((inNowMs - ioControl->pProposeMs) < inConfirmWaitMs)
+    {
+      return 0 ;
+    }
+
+    if (ioControl->pProposals >= kRateMaxProposals)
+    {
+      ioControl->pPhase = kRatePhaseIdle ;
+      ioControl->pNextChangeMs = inNowMs + kRateFallbackHoldMs ;
+      ioControl->pAborted++ ;
+      return 0 ;
+    }
+
+    ioControl->pProposals++ ;
+    ioControl->pProposeMs = inNowMs ;
+    return BuildCommand(kRatePropose, ioControl->pToken, ioControl->pTarget, outPacket, inMaxLen) ;
+  }
+
+  // Pull in rockets left at the base rate
+  if (ioControl->pRate != kLoRaDataRateBase &&
+      (inNowMs - ioControl->pAnnounceMs) >= kRateAnnounceMs)
+  {
+    ioControl->pAnnounceMs = inNowMs ;
+    *outAnnounce = true ;
+    return BuildCommand(kRateCommit, ioControl->pToken, ioControl->pRate, outPacket, inMaxLen) ;
+  }
+
+  if ((int32_t)(inNowMs - ioControl->pNextChangeMs) < 0)
+  {
+    return 0 ;
+  }
+
+  uint8_t theTarget = ChooseRate(ioControl, inNowMs) ;
+  if (theTarget == ioControl->pRate)
+  {
+    return 0 ;
+  }
+
+  // Nobody to agree with: stay put
+  bool theAnyActive = false ;
+  for (int i = 0 ; i < kRateMaxRockets ; i++)
+  {
+    ioControl->pRockets[i].pConfirmed = false ;
+    theAnyActive = theAnyActive || ioControl->pRockets[i].pActive ;
+  }
+  if (!theAnyActive)
+  {
+    return 0 ;
+  }
+
+  ioControl->pPhase = kRatePhaseProposing ;
+  ioControl->pTarget = theTarget ;
+  ioControl->pToken++ ;
+  ioControl->pProposals = 1 ;
+  ioControl->pProposeMs = inNowMs ;
+  return BuildCommand(kRatePropose, ioControl->pToken, theTarget, outPacket, inMaxLen) ;
+}
+
+//----------------------------------------------
+// Function: RateControl_GetBulkRate
+//----------------------------------------------
+uint8_t RateControl_GetBulkRate(const RateControl * inControl, uint8_t inRocketId)
+{
+  uint8_t theRate = inControl->pRate ;
+  if (!inControl->pAuto || inControl->pPhase != kRatePhaseIdle)
+  {
+    return theRate ;
+  }
+
+  const RateRocket * theTarget = NULL ;
+  for (int i = 0 ; i < kRateMaxRockets ; i++)
+  {
+    const RateRocket * theRocket = &inControl->pRockets[i] ;
+    if (!theRocket->pActive)
+    {
+      continue ;
+    }
+    if (theTarget != NULL || (inRocketId != 0xFF && i != inRocketId))
+    {
+      return theRate ;
+    }
+    theTarget = theRocket ;
+  }
+
+  if (theTarget == NULL || theTarget->pSnrCount < kRateSnrWindow)
+  {
+    return theRate ;
+  }
+
+  int16_t theSum = 0 ;
+  for (int j = 0 ; j < theTarget->pSnrCount ; j++)
+  {
+    theSum += theTarget->pSnr[j] ;
+  }
+  int16_t theSnr = theSum / theTarget->pSnrCount ;
+  while (theRate + 1 < kLoRaDataRateCount &&
+         Margin(inControl, theSnr, theRate + 1) >= kRateMarginUpDb)
+  {
+    theRate++ ;
+  }
+  return theRate ;
+}
+
+//----------------------------------------------
+// Function: RateControl_IsStatsDue
+//----------------------------------------------
+bool RateControl_IsStatsDue(const RateControl * inControl, uint32_t inNowMs)
+{
+  bool theAnyActive = false ;
+  for (int i = 0 ; i < kRateMaxRockets ; i++)
+  {
+    theAnyActive = theAnyActive || inControl->pRockets[i].pActive ;
+  }
+
+  return theAnyActive && (inNowMs - inControl->pLastStatsMs) >= kRateStatsIntervalMs ;
+}
+
+//----------------------------------------------
+// Function: RateControl_StatsToJson
+//----------------------------------------------
+int RateControl_StatsToJson(
+  RateControl * ioControl,
+  const char * inEvent,
+  uint32_t inNowMs,
+  char * outJson,
+  int inMaxLen)
+{
+  if (outJson == NULL || inEvent == NULL || inMaxLen <= 0) return 0 ;
+
+  AccountTime(ioControl, inNowMs) ;
+  ioControl->pLastStatsMs = inNowMs ;
+
+  const LoRa_DataRate * theRate = LoRa_GetDataRate(ioControl->pRate) ;
+  int16_t theSnr = 0 ;
+  bool theHaveSnr = WorstSnr(ioControl, 1, &theSnr) ;
+  uint8_t theActive = 0 ;
+  for (int i = 0 ; i < kRateMaxRockets ; i++)
+  {
+    if (ioControl->pRockets[i].pActive)
+    {
+      theActive++ ;
+    }
+  }
+
+  JsonWriter theWriter ;
+  JsonWriter_Init(&theWriter, outJson, inMaxLen) ;
+  JsonWriter_BeginObject(&theWriter, NULL) ;
+  JsonWriter_String(&theWriter, "type", "data_rate") ;
+  JsonWriter_String(&theWriter, "event", inEvent) ;
+  JsonWriter_Bool(&theWriter, "auto", ioControl->pAuto) ;
+  JsonWriter_Uint(&theWriter, "rate", ioControl->pRate) ;
+  JsonWriter_Uint(&theWriter, "sf", theRate->pSpreadFactor) ;
+  JsonWriter_Uint(&theWriter, "bw_khz", BandwidthKhz(theRate->pBandwidth)) ;
+  JsonWriter_Bool(&theWriter, "proposing", ioControl->pPhase == kRatePhaseProposing) ;
+  JsonWriter_Uint(&theWriter, "target",
+    ioControl->pPhase == kRatePhaseProposing ? ioControl->pTarget : ioControl->pRate) ;
+  JsonWriter_Uint(&theWriter, "rockets", theActive) ;
+
+  if (theHaveSnr)
+  {
+    JsonWriter_Int(&theWriter, "snr", theSnr) ;
+    JsonWriter_Int(&theWriter, "margin_db", Margin(ioControl, theSnr, ioControl->pRate)) ;
+  }
+
+  JsonWriter_Int(&theWriter, "atten_db", ioControl->pAttenDb) ;
+  JsonWriter_Uint(&theWriter, "switches", ioControl->pSwitches) ;
+  JsonWriter_Uint(&theWriter, "fallbacks", ioControl->pFallbacks) ;
+  JsonWriter_Uint(&theWriter, "aborted", ioControl->pAborted) ;
+  JsonWriter_Uint(&theWriter, "ms", inNowMs - ioControl->pStatsStartMs) ;
+
+  JsonWriter_BeginArray(&theWriter, "rates") ;
+  for (uint8_t i = 0 ; i < kLoRaDataRateCount ; i++)
+  {
+    const LoRa_DataRate * theEntry = LoRa_GetDataRate(i) ;
+    const RateStats * theStats = &ioControl->pStats[i] ;
+    uint32_t theExpected = theStats->pFrames + theStats->pLost ;
+
+    // Loss in tenths of a percent, rounded
+    uint32_t theLossPermille = theExpected > 0 ?
+      (uint32_t)(((uint64_t)theStats->pLost * 1000 + theExpected / 2) / theExpected) : 0 ;
+
+    JsonWriter_BeginObject(&theWriter, NULL) ;
+    JsonWriter_Uint(&theWriter, "rate", i) ;
+    JsonWriter_Uint(&theWriter, "sf", theEntry->pSpreadFactor) ;
+    JsonWriter_Uint(&theWriter, "bw_khz", BandwidthKhz(theEntry->pBandwidth)) ;
+    JsonWriter_Uint(&theWriter, "ms", theStats->pMs) ;
+    JsonWriter_Uint(&theWriter, "frames", theStats->pFrames) ;
+    JsonWriter_Uint(&theWriter, "lost", theStats->pLost) ;
+    JsonWriter_Uint(&theWriter, "dropped", theStats->pDropped) ;
+    JsonWriter_Uint(&theWriter, "bytes_per_s",
+      theStats->pMs > 0 ? (uint32_t)((uint64_t)theStats->pBytes * 1000 / theStats->pMs) : 0) ;
+    JsonWriter_Fixed(&theWriter, "loss_pct", (int32_t)theLossPermille, 1) ;
+    JsonWriter_EndObject(&theWriter) ;
+  }
+  JsonWriter_EndArray(&theWriter) ;
+  JsonWriter_EndObject(&theWriter) ;
+
+  return JsonWriter_Finish(&theWriter) ;
+}
@@ -0,0 +1,362 @@
+//----------------------------------------------
+// Module: tdma_scheduler.c
+// Description: TDMA beacon and slot scheduler for
+//   multi-rocket operation
+// Author: Mark Gavin
+// Created: 2026-02-12
+// Modified: 2026-02-15 (slot owner lookup for the channel plan)
+// Modified: 2026-02-16 (JSON writer)
+// Copyright: (c) 2025-2026 by Mark Gavin
+// License: Proprietary - All Rights Reserved
+//----------------------------------------------
+
+#include "tdma_scheduler.h"
+#include "gateway_protocol.h"
+#include "json_writer.h"
+
+#include <string.h>
+
+//----------------------------------------------
+// Internal: Count Joined Rockets
+//----------------------------------------------
+static uint8_t CountJoined(const TdmaScheduler * inScheduler)
+{
+  uint8_t theCount = 0 ;
+  for (int i = 0 ; i < kTdmaMaxRockets ; i++)
+  {
+    if (inScheduler->pRockets[i].pJoined)
+    {
+      theCount++ ;
+    }
+  }
+  return theCount ;
+}
+
+//----------------------------------------------
+// Internal: Deal Slots
+// Drops rockets that have gone silent, then
+// hands the data slots round-robin to the rest.
+// The starting rocket advances each superframe
+// so leftover slots rotate fairly.
+//----------------------------------------------
+static void DealSlots(TdmaScheduler * ioScheduler, uint32_t inNowMs)
+{
+  uint8_t theJoined[kTdmaMaxRockets] ;
+  uint8_t theCount = 0 ;
+
+  for (uint8_t i = 0 ; i < kTdmaMaxRockets ; i++)
+  {
+    TdmaRocket * theRocket = &ioScheduler->pRockets[i] ;
+    theRocket->pSlots = 0 ;
+
+    if (theRocket->pJoined && (inNowMs - theRocket->pLastHeardMs) > kTdmaJoinTimeoutMs)
+    {
+      theRocket->pJoined = false ;
+      theRocket->pSequenceValid = false ;
+    }
+
+    if (theRocket->pJoined)
+    {
+      theJoined[theCount++] = i ;
+    }
+  }
+
+  if (theCount == 0)
+  {
+    memset(ioScheduler->pSlots, kTdmaSlotFree, sizeof(ioScheduler->pSlots)) ;
+    ioScheduler->pNextRocket = 0 ;
+    return ;
+  }
+
+  uint8_t theFirst = ioScheduler->pNextRocket % theCount ;
+  for (int i = 0 ; i < kTdmaSlotCount ; i++)
+  {
+    uint8_t theId = theJoined[(theFirst + i) % theCount] ;
+    ioScheduler->pSlots[i] = theId ;
+    ioScheduler->pRockets[theId].pSlots++ ;
+  }
+  ioScheduler->pNextRocket = (uint8_t)((theFirst + kTdmaSlotCount) % theCount) ;
+}
+
+//----------------------------------------------
+// Function: TdmaScheduler_Init
+//----------------------------------------------
+void TdmaScheduler_Init(
+  TdmaScheduler * outScheduler,
+  bool inEnabled,
+  uint16_t inSlotMs,
+  uint16_t inDownlinkMs)
+{
+  memset(outScheduler, 0, sizeof(TdmaScheduler)) ;
+  memset(outScheduler->pSlots, kTdmaSlotFree, sizeof(outScheduler->pSlots)) ;
+  outScheduler->pEnabled = inEnabled ;
+  outScheduler->pSlotMs = inSlotMs ;
+  outScheduler->pDownlinkMs = inDownlinkMs ;
+}
+
+//----------------------------------------------
+// Function: TdmaScheduler_Configure
+//----------------------------------------------
+bool TdmaScheduler_Configure(
+  TdmaScheduler * ioScheduler,
+  bool inEnabled,
+  uint16_t inSlotMs)
+{
+  if (inSlotMs != 0 && (inSlotMs < kTdmaMinSlotMs || inSlotMs > kTdmaMaxSlotMs))
+  {
+    return false ;
+  }
+
+  if (inSlotMs != 0)
+  {
+    ioScheduler->pSlotMs = inSlotMs ;
+  }
+
+  // Restarting begins a fresh superframe at once
+  if (inEnabled && !ioScheduler->pEnabled)
+  {
+    ioScheduler->pStarted = false ;
+  }
+  ioScheduler->pEnabled = inEnabled ;
+  return true ;
+}
+
+//----------------------------------------------
+// Function: TdmaScheduler_SetTiming
+//----------------------------------------------
+void TdmaScheduler_SetTiming(
+  TdmaScheduler * ioScheduler,
+  uint16_t inSlotMs,
+  uint16_t inDownlinkMs)
+{
+  ioScheduler->pSlotMs = inSlotMs ;
+  ioScheduler->pDownlinkMs = inDownlinkMs ;
+  ioScheduler->pStarted = false ;
+}
+
+//----------------------------------------------
+// Function: TdmaScheduler_IsBeaconDue
+//----------------------------------------------
+bool TdmaScheduler_IsBeaconDue(const TdmaScheduler * inScheduler, uint32_t inNowUs)
+{
+  if (!inScheduler->pEnabled)
+  {
+    return false ;
+  }
+
+  return !inScheduler->pStarted || (int32_t)(inNowUs - inScheduler->pNextBeaconUs) >= 0 ;
+}
+
+//----------------------------------------------
+// Function: TdmaScheduler_BuildBeacon
+//----------------------------------------------
+int TdmaScheduler_BuildBeacon(
+  TdmaScheduler * ioScheduler,
+  uint32_t inNowUs,
+  uint32_t inNowMs,
+  uint32_t inBeaconAirUs,
+  uint8_t * outPacket,
+  int inMaxLen)
+{
+  if (outPacket == NULL || inMaxLen < kTdmaBeaconLen) return 0 ;
+
+  DealSlots(ioScheduler, inNowMs) ;
+
+  // Downlink window, data slots, contention slot,
+  // then the next beacon
+  uint32_t theSuperframeUs = inBeaconAirUs + kTdmaTailGuardMs * 1000 +
+    ((uint32_t)ioScheduler->pDownlinkMs + (kTdmaSlotCount + 1) * (uint32_t)ioScheduler->pSlotMs) * 1000 ;
+  uint32_t theSuperframeMs = (theSuperframeUs + 999) / 1000 ;
+  if (theSuperframeMs > 0xFFFF)
+  {
+    theSuperframeMs = 0xFFFF ;
+  }
+  ioScheduler->pSuperframeMs = (uint16_t)theSuperframeMs ;
+
+  ioScheduler->pStarted = true ;
+  ioScheduler->pBeaconSeq++ ;
+  ioScheduler->pBeaconsSent++ ;
+  ioScheduler->pAnchorUs = inNowUs + inBeaconAirUs ;
+  ioScheduler->pDownlinkEndUs = ioScheduler->pAnchorUs + (uint32_t)ioScheduler->pDownlinkMs * 1000 ;
+  ioScheduler->pNextBeaconUs = inNowUs + theSuperframeMs * 1000 ;
+
+  outPacket[0] = kLoRaMagic ;
+  outPacket[1] = kLoRaPacketBeacon ;
+  outPacket[2] = ioScheduler->pBeaconSeq ;
+  outPacket[3] = kTdmaSlotCount ;
+  outPacket[4] = ioScheduler->pSlotMs & 0xFF ;
+  outPacket[5] = (ioScheduler->pSlotMs >> 8) & 0xFF ;
+  outPacket[6] = ioScheduler->pDownlinkMs & 0xFF ;
+  outPacket[7] = (ioScheduler->pDownlinkMs >> 8) & 0xFF ;
+  outPacket[8] = theSuperframeMs & 0xFF ;
+  outPacket[9] = (theSuperframeMs >> 8) & 0xFF ;
+  outPacket[10] = ioScheduler->pHeardMask & 0xFF ;
+  outPacket[11] = (ioScheduler->pHeardMask >> 8) & 0xFF ;
+  memcpy(&outPacket[12], ioScheduler->pSlots, kTdmaSlotCount) ;
+
+  ioScheduler->pHeardMask = 0 ;
+  return kTdmaBeaconLen ;
+}
+
+//----------------------------------------------
+// Function: TdmaScheduler_RecordFrame
+//----------------------------------------------
+bool TdmaScheduler_RecordFrame(
+  TdmaScheduler * ioScheduler,
+  uint8_t inRocketId,
+  uint8_t inSequence,
+  uint32_t inRxUs,
+  uint32_t inNowMs,
+  int16_t inRssi,
+  int8_t inSnr)
+{
+  if (inRocketId >= kTdmaMaxRockets)
+  {
+    return false ;
+  }
+
+  TdmaRocket * theRocket = &ioScheduler->pRockets[inRocketId] ;
+
+  // First rocket after a quiet spell starts a new
+  // statistics interval
+  if (!theRocket->pJoined)
+  {
+    if (CountJoined(ioScheduler) == 0)
+    {
+      ioScheduler->pStatsStartMs = inNowMs ;
+    }
+    theRocket->pJoined = true ;
+  }
+
+  // An 8-bit sequence step of more than one is a
+  // lost frame; a large jump is a restart
+  if (theRocket->pSequenceValid)
+  {
+    uint8_t theStep = (uint8_t)(inSequence - theRocket->pLastSequence) ;
+    if (theStep > 1 && theStep < 128)
+    {
+      theRocket->pLost += theStep - 1 ;
+      theRocket->pIntervalLost += theStep - 1 ;
+    }
+  }
+  theRocket->pSequenceValid = true ;
+  theRocket->pLastSequence = inSequence ;
+  theRocket->pLastHeardMs = inNowMs ;
+  theRocket->pLastRssi = inRssi ;
+  theRocket->pLastSnr = inSnr ;
+  theRocket->pFrames++ ;
+  theRocket->pIntervalFrames++ ;
+  ioScheduler->pHeardMask |= (uint16_t)(1u << inRocketId) ;
+
+  if (!ioScheduler->pEnabled || !ioScheduler->pStarted)
+  {
+    return false ;
+  }
+
+  // RxDone falls inside the slot the frame was sent in
+  int32_t theIntoUs = (int32_t)(inRxUs - ioScheduler->pAnchorUs) -
+    (int32_t)ioScheduler->pDownlinkMs * 1000 ;
+  if (theIntoUs >= 0)
+  {
+    uint32_t theSlot = (uint32_t)theIntoUs / ((uint32_t)ioScheduler->pSlotMs * 1000) ;
+    if (theSlot < kTdmaSlotCount && ioScheduler->pSlots[theSlot] == inRocketId)
+    {
+      return true ;
+    }
+  }
+
+  theRocket->pOutOfSlot++ ;
+  return false ;
+}
+
+//----------------------------------------------
+// Function: TdmaScheduler_GetSlotOwner
+//----------------------------------------------
+uint8_t TdmaScheduler_GetSlotOwner(const TdmaScheduler * inScheduler, uint32_t inNowUs)
+{
+  if (!inScheduler->pEnabled || !inScheduler->pStarted)
+  {
+    return kTdmaSlotFree ;
+  }
+
+  int32_t theIntoUs = (int32_t)(inNowUs - inScheduler->pAnchorUs) -
+    (int32_t)inScheduler->pDownlinkMs * 1000 ;
+  if (theIntoUs < 0)
+  {
+    return kTdmaSlotFree ;
+  }
+
+  uint32_t theSlot = (uint32_t)theIntoUs / ((uint32_t)inScheduler->pSlotMs * 1000) ;
+  return theSlot < kTdmaSlotCount ? inScheduler->pSlots[theSlot] : kTdmaSlotFree ;
+}
+
+//----------------------------------------------
+// Function: TdmaScheduler_IsStatsDue
+//----------------------------------------------
+bool TdmaScheduler_IsStatsDue(const TdmaScheduler * inScheduler, uint32_t inNowMs)
+{
+  return CountJoined(inScheduler) > 0 &&
+    (inNowMs - inScheduler->pStatsStartMs) >= kTdmaStatsIntervalMs ;
+}
+
+//----------------------------------------------
+// Function: TdmaScheduler_StatsToJson
+//----------------------------------------------
+int TdmaScheduler_StatsToJson(
+  TdmaScheduler * ioScheduler,
+  uint32_t inNowMs,
+  char * outJson,
+  int inMaxLen)
+{
+  if (outJson == NULL || inMaxLen <= 0) return 0 ;
+
+  uint32_t theIntervalMs = inNowMs - ioScheduler->pStatsStartMs ;
+  float theSeconds = theIntervalMs > 0 ? theIntervalMs / 1000.0f : 1.0f ;
+
+  uint32_t theTotal = 0 ;
+  for (int i = 0 ; i < kTdmaMaxRockets ; i++)
+  {
+    theTotal += ioScheduler->pRockets[i].pIntervalFrames ;
+  }
+
+  JsonWriter theWriter ;
+  JsonWriter_Init(&theWriter, outJson, inMaxLen) ;
+  JsonWriter_BeginObject(&theWriter, NULL) ;
+  JsonWriter_String(&theWriter, "type", "tdma_stats") ;
+  JsonWriter_Bool(&theWriter, "enabled", ioScheduler->pEnabled) ;
+  JsonWriter_Uint(&theWriter, "slot_ms", ioScheduler->pSlotMs) ;
+  JsonWriter_Uint(&theWriter, "superframe_ms", ioScheduler->pSuperframeMs) ;
+  JsonWriter_Uint(&theWriter, "beacons", ioScheduler->pBeaconsSent) ;
+  JsonWriter_Uint(&theWriter, "interval_ms", theIntervalMs) ;
+  JsonWriter_Float(&theWriter, "total_rate", theTotal / theSeconds, 2) ;
+
+  JsonWriter_BeginArray(&theWriter, "rockets") ;
+  for (int i = 0 ; i < kTdmaMaxRockets ; i++)
+  {
+    TdmaRocket * theRocket = &ioScheduler->pRockets[i] ;
+    if (!theRocket->pJoined)
+    {
+      continue ;
+    }
+
+    JsonWriter_BeginObject(&theWriter, NULL) ;
+    JsonWriter_Int(&theWriter, "id", i) ;
+    JsonWriter_Uint(&theWriter, "slots", theRocket->pSlots) ;
+    JsonWriter_Uint(&theWriter, "rx", theRocket->pIntervalFrames) ;
+    JsonWriter_Float(&theWriter, "rate", theRocket->pIntervalFrames / theSeconds, 2) ;
+    JsonWriter_Uint(&theWriter, "lost", theRocket->pIntervalLost) ;
+    JsonWriter_Uint(&theWriter, "out_of_slot", theRocket->pOutOfSlot) ;
+    JsonWriter_Int(&theWriter, "rssi", theRocket->pLastRssi) ;
+    JsonWriter_Int(&theWriter, "snr", theRocket->pLastSnr) ;
+    JsonWriter_EndObject(&theWriter) ;
+
+    theRocket->pIntervalFrames = 0 ;
+    theRocket->pIntervalLost = 0 ;
+  }
+  JsonWriter_EndArray(&theWriter) ;
+  JsonWriter_EndObject(&theWriter) ;
+
+  ioScheduler->pStatsStartMs = inNowMs ;
+
+  return JsonWriter_Finish(&theWriter) ;
+}
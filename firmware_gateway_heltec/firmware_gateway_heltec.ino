@@ -9,6 +9,22 @@
 // Created: 2026-01-15
 // Copyright: (c) 2025-2026 by Mark Gavin
 // License: Proprietary - All Rights Reserved
+// Modified: 2026-02-10 (compact telemetry decoder)
+// Modified: 2026-02-11 (telemetry batch expansion)
+// Modified: 2026-02-14 (aggregated ACK summary)
+// Modified: 2026-02-15 (fc_info uplink channel)
+// Modified: 2026-02-15 (listen before talk)
+// Modified: 2026-02-15 (flight event trailer and ACKs)
+// Modified: 2026-02-15 (recovery beacon, telemetry_profile command)
+// Modified: 2026-02-15 (downlink queueing delay in fc_info)
+// Modified: 2026-02-15 (layout asserts, table CRC-8)
+// Modified: 2026-02-15 (binary output per client)
+// Modified: 2026-02-16 (JSON writer, no String per packet)
+// Modified: 2026-02-16 (fc_info and ack_stats on the JSON writer)
+// Modified: 2026-02-16 (rocket radio SPI times in fc_info)
+// Modified: 2026-02-16 (flight status in flash_list, verification time in fc_info)
+// Modified: 2026-02-16 (SD card rates in fc_info)
+// Modified: 2026-02-16 (jsonString escapes like JsonWriter_String)
 //----------------------------------------------
 
 #include <RadioLib.h>
@@ -107,7 +123,8 @@
 //----------------------------------------------
 // LoRa Configuration (MUST match flight computer!)
 //----------------------------------------------
-#define LORA_FREQUENCY      915.0       // MHz
+#define LORA_FREQUENCY      915.0       // MHz (control channel; rockets on their own
+                                        // uplink channel are not heard here)
 #define LORA_BANDWIDTH      125.0       // kHz
 #define LORA_SPREAD_FACTOR  7
 #define LORA_CODING_RATE    5           // 4/5
@@ -115,6 +132,13 @@
 #define LORA_PREAMBLE_LEN   8
 #define LORA_TX_POWER       14          // dBm (reduced from 20 to lower heat)
 
+// Listen before talk: a channel scan (CAD) before each
+// send; a busy channel backs off a random, doubling
+// time, and after LBT_MAX_DEFERRALS the packet goes anyway
+#define LBT_ENABLED         true
+#define LBT_BACKOFF_MS      5
+#define LBT_MAX_DEFERRALS   4
+
 //----------------------------------------------
 // WiFi Configuration
 //----------------------------------------------
@@ -131,6 +155,17 @@
 #define TCP_PORT        5000
 #define MAX_CLIENTS     4
 
+// Binary output records (must match gateway_stream.h)
+#define STREAM_VERSION              1
+#define STREAM_RECORD_TELEMETRY     0x01    // StreamTelemetryRecord
+#define STREAM_RECORD_FRAME         0x02    // RSSI, SNR, then the LoRa frame
+#define STREAM_RECORD_FLASH_DATA    0x03    // Storage data packet as received
+#define STREAM_RECORD_TEXT          0x04    // JSON line without its newline
+#define STREAM_GATEWAY_GPS_VALID    0x01
+#define STREAM_TELEMETRY_SIZE       71
+#define STREAM_TEXT_MAX             4096    // Longest line sent as a record
+#define STREAM_FRAME_SIZE(len)      ((len) + 4 + ((len) + 2) / 254)
+
 // Stored WiFi networks
 #define MAX_WIFI_NETWORKS   4
 #define WIFI_SSID_MAX_LEN   32
@@ -155,18 +190,59 @@ TinyGPSPlus gps;
 HardwareSerial gpsSerial(1);
 WiFiServer server(TCP_PORT);
 WiFiClient clients[MAX_CLIENTS];
+bool clientBinary[MAX_CLIENTS];     // Binary records instead of JSON lines
+uint8_t streamFrame[STREAM_FRAME_SIZE(STREAM_TEXT_MAX)];  // One encoded record
+char jsonLine[STREAM_TEXT_MAX];     // Per-packet JSON, built by the json* writer
 
 // TFT display using hardware SPI
 Adafruit_ST7735 tft = Adafruit_ST7735(TFT_CS, TFT_DC, TFT_MOSI, TFT_SCLK, TFT_RST);
 
 //----------------------------------------------
-// Binary Telemetry Packet (must match flight computer)
+// Binary Telemetry Packet (must match lora_protocol.h)
 //----------------------------------------------
 #define LORA_MAGIC              0xAF
+#define LORA_MAGIC_COMPACT      0xAC    // Bit-packed telemetry frame
+#define LORA_MAGIC_COMPACT_EVENT 0xAD   // Compact frame with an event trailer
 #define LORA_PACKET_TELEMETRY   0x01
+#define LORA_PACKET_BATCH       0x0A    // Batched 100 Hz samples
+#define LORA_PACKET_RECOVERY    0x12    // GPS recovery beacon after landing
+#define RECOVERY_PACKET_SIZE    21      // Layout: lora_protocol.h
+#define BATCH_HEADER_SIZE       20
 #define LORA_PACKET_SIZE        55
 #define MAX_ROCKETS             15
 
+// ACK summary (layout: lora_protocol.h), sent every
+// ackIntervalMs instead of an ACK per frame
+#define LORA_PACKET_ACK_SUMMARY 0x0E
+#define ACK_SUMMARY_HEADER_SIZE 6
+#define ACK_SUMMARY_ENTRY_SIZE  8
+#define ACK_SUMMARY_MAX_ENTRIES 12
+#define ACK_MAX_ROCKETS         16
+#define ACK_EVENT_ENTRY_SIZE    2
+#define ACK_EVENT_MAX_ENTRIES   8
+
+#define ACK_INTERVAL_MS         1000    // 0 = ACK every frame
+#define ACK_MIN_INTERVAL_MS     100
+#define ACK_MAX_INTERVAL_MS     4000    // Under the flight link timeout
+
+// Telemetry FEC parity frame (layout: telemetry_fec.h,
+// constants in lora_protocol.h)
+#define LORA_PACKET_PARITY      0x0F
+
+// Flight event trailer after a telemetry frame's
+// CRC (layout: lora_protocol.h); the sender marks
+// the frame with LORA_PACKET_EVENT_FLAG in the type
+// byte or LORA_MAGIC_COMPACT_EVENT
+#define EVENT_TRAILER_SIZE      15
+#define EVENT_TRAILER_TAG       0xE7
+#define LORA_PACKET_EVENT_FLAG  0x80
+
+// Compact frame sections (layout: lora_protocol.h)
+#define COMPACT_HAS_GPS         0x01
+#define COMPACT_HAS_ORIENTATION 0x02
+#define COMPACT_HAS_SLOW        0x04
+#define COMPACT_MIN_SIZE        19
+
 typedef struct __attribute__((packed)) {
     uint8_t magic;
     uint8_t packetType;
@@ -196,6 +272,45 @@ typedef struct __attribute__((packed)) {
     uint8_t crc;
 } LoRaTelemetryPacket;
 
+// Layout pinned to firmware_common/include/lora_protocol.h
+// (a sketch cannot include from outside its folder)
+static_assert(sizeof(LoRaTelemetryPacket) == LORA_PACKET_SIZE, "telemetry packet size");
+static_assert(offsetof(LoRaTelemetryPacket, rocketId) == 2, "telemetry rocket ID offset");
+static_assert(offsetof(LoRaTelemetryPacket, sequence) == 3, "telemetry sequence offset");
+static_assert(offsetof(LoRaTelemetryPacket, timeMs) == 5, "telemetry time offset");
+static_assert(offsetof(LoRaTelemetryPacket, altitudeCm) == 9, "telemetry altitude offset");
+static_assert(offsetof(LoRaTelemetryPacket, gpsLatitude) == 21, "telemetry GPS offset");
+static_assert(offsetof(LoRaTelemetryPacket, accelX) == 34, "telemetry accel offset");
+static_assert(offsetof(LoRaTelemetryPacket, state) == 52, "telemetry state offset");
+static_assert(offsetof(LoRaTelemetryPacket, flags) == 53, "telemetry flags offset");
+static_assert(offsetof(LoRaTelemetryPacket, crc) == LORA_PACKET_SIZE - 1, "telemetry CRC offset");
+
+//----------------------------------------------
+// Binary Output Telemetry Record (must match gateway_stream.h)
+//----------------------------------------------
+typedef struct __attribute__((packed)) {
+    LoRaTelemetryPacket packet;     // As received (compact frames expanded)
+    int16_t rssi;                   // dBm
+    int8_t snr;                     // dB
+    uint32_t groundPressurePa;      // Gateway barometer, 0 if none
+    uint8_t gatewayFlags;           // STREAM_GATEWAY_*
+    int32_t gatewayLatitude;        // Microdegrees
+    int32_t gatewayLongitude;       // Microdegrees
+} StreamTelemetryRecord;
+
+static_assert(sizeof(StreamTelemetryRecord) == STREAM_TELEMETRY_SIZE, "stream telemetry size");
+
+//----------------------------------------------
+// JSON Writer State (same scheme as json_writer.h)
+//----------------------------------------------
+typedef struct {
+    char* buf;
+    int maxLen;
+    int len;
+    bool first;                     // Nothing yet in the open object or array
+    bool overflow;                  // Something did not fit; jsonFinish returns 0
+} JsonWriter;
+
 //----------------------------------------------
 // Multi-Rocket Tracking
 //----------------------------------------------
@@ -211,11 +326,36 @@ typedef struct {
     int16_t rssi;               // Signal strength
 } RocketData;
 
+// Compact frame fields carried only in slow sections
+typedef struct {
+    bool originValid;           // Slow section received
+    uint8_t originEpoch;        // 2-bit GPS origin epoch
+    int32_t originLat;          // Microdegrees
+    int32_t originLon;          // Microdegrees
+    int16_t temperatureC10;
+    uint8_t satellites;
+    int16_t gpsSpeedCmps;
+    uint16_t gpsHeadingDeg10;
+    uint16_t sequence;          // Last full sequence number
+} CompactState;
+
+CompactState compactState[16];
+
 // Flight state names
 const char* flightStateNames[] = {
     "IDLE", "ARMED", "BOOST", "COAST", "APOGEE", "DESCENT", "LANDED", "COMPLETE"
 };
 
+// Flight event names (kEvent* 0x01-0x09)
+const char* flightEventNames[] = {
+    "armed", "disarmed", "launch", "burnout", "apogee", "descent", "landed", "complete", "reset"
+};
+
+// Stored flight status (FlightSlotStatus in the flight firmware)
+const char* slotStatusNames[] = {
+    "empty", "unverified", "valid", "legacy", "corrupt"
+};
+
 //----------------------------------------------
 // State Variables
 //----------------------------------------------
@@ -280,6 +420,39 @@ uint32_t lastDisplayCycleMs = 0;
 #define DISPLAY_CYCLE_INTERVAL_MS 3000   // Cycle every 3 seconds
 #define ROCKET_TIMEOUT_MS         10000  // Mark inactive after 10s no data
 
+// ACK summary state, per rocket ID
+typedef struct {
+    bool pending;           // Heard since the last summary
+    bool seqValid;
+    uint8_t lastSeq;
+    uint16_t bitmap;        // Bit n: lastSeq - 1 - n received
+    uint8_t frames;
+    int32_t rssiSum;
+    int16_t snrSum;
+    bool eventValid;
+    uint8_t eventSeq;       // Latest flight event heard
+    bool eventPending;      // Its ACK is owed
+} AckRecord;
+
+AckRecord ackRecords[ACK_MAX_ROCKETS];
+uint16_t ackIntervalMs = ACK_INTERVAL_MS;
+bool ackRequested = false;
+uint8_t ackSequence = 0;
+uint8_t ackNextRocket = 0;
+uint32_t lastAckSummaryMs = 0;
+uint32_t ackFrameCount = 0;
+uint32_t ackSummaryCount = 0;
+uint32_t ackAirUs = 0;
+uint32_t eventCount = 0;
+uint32_t eventRepeats = 0;
+
+// Listen before talk and collision counters
+uint32_t lbtChecks = 0;
+uint32_t lbtDeferrals = 0;
+uint32_t lbtForced = 0;
+uint32_t lbtHoldMaxMs = 0;
+uint32_t crcErrors = 0;
+
 // Distance to current display rocket (for display)
 float distanceToRocket = 0.0;    // meters
 float prevDistanceToRocket = -1.0;
@@ -389,6 +562,9 @@ void loop() {
     // Handle incoming LoRa packets
     handleLoRa();
 
+    // ACK every rocket heard, once per interval
+    serviceAckSummary();
+
     // Handle WiFi clients
     handleWiFiClients();
 
@@ -981,6 +1157,15 @@ void handleLoRa() {
         Serial.printf("LoRa RX [%d]: RSSI=%.1f SNR=%.1f len=%d\n",
                       loraPacketCount, lastRssi, lastSnr, lastLoraPacketLen);
 
+        // A flight event trailer comes off before decoding
+        takeEventTrailer();
+
+        // Compact frames become full telemetry packets in place
+        // (a bad frame keeps its magic and is forwarded as hex)
+        if (lastLoraPacketLen >= 1 && lastLoraPacketBinary[0] == LORA_MAGIC_COMPACT) {
+            expandCompactTelemetry();
+        }
+
         // Decode and forward to WiFi clients as JSON
         if (lastLoraPacketLen >= 2 && lastLoraPacketBinary[0] == LORA_MAGIC) {
             uint8_t packetType = lastLoraPacketBinary[1];
@@ -989,8 +1174,24 @@ void handleLoRa() {
                 case LORA_PACKET_TELEMETRY:  // 0x01
                     if (lastLoraPacketLen >= sizeof(LoRaTelemetryPacket)) {
                         forwardTelemetryAsJson();
-                        // Send ACK back to flight computer with signal quality info
-                        sendAckToFlightComputer();
+                        // ACK with signal quality info, now or in the next summary
+                        ackTelemetry(lastLoraPacketBinary[2], lastLoraPacketBinary[3]);
+                    } else {
+                        forwardAsHex();
+                    }
+                    break;
+
+                case LORA_PACKET_BATCH:  // 0x0A
+                    if (forwardTelemetryBatchAsJson()) {
+                        ackTelemetry(lastLoraPacketBinary[2], lastLoraPacketBinary[3]);
+                    } else {
+                        forwardAsHex();
+                    }
+                    break;
+
+                case LORA_PACKET_RECOVERY:  // 0x12
+                    if (forwardRecoveryAsJson()) {
+                        ackTelemetry(lastLoraPacketBinary[2], lastLoraPacketBinary[3]);
                     } else {
                         forwardAsHex();
                     }
@@ -1016,6 +1217,16 @@ void handleLoRa() {
                     forwardBaroCompareAsJson();
                     break;
 
+                case LORA_PACKET_PARITY:  // 0x0F
+                    // Telemetry FEC parity: only the RP2040
+                    // gateway rebuilds lost frames from it
+                    break;
+
+                case 0x11:  // kLoRaPacketCommandReply
+                    // Answers the RP2040 gateway's requests;
+                    // commands from here carry no request ID
+                    break;
+
                 default:
                     // Unknown packet type - forward as hex for debugging
                     forwardAsHex();
@@ -1030,6 +1241,7 @@ void handleLoRa() {
         lastLoraPacket = String(lastLoraPacketLen) + "B";
 
     } else if (state == RADIOLIB_ERR_CRC_MISMATCH) {
+        crcErrors++;
         Serial.println("LoRa RX: CRC error");
     } else {
         Serial.printf("LoRa RX error: %d\n", state);
@@ -1101,6 +1313,44 @@ float calculateDistance(float lat1, float lon1, float lat2, float lon2) {
     return R * c;
 }
 
+//----------------------------------------------
+// Listen Before Talk
+// Scans for LoRa activity before a send, backing off
+// while the channel is busy. Gives up waiting after
+// LBT_MAX_DEFERRALS so ACKs and commands still go out.
+//----------------------------------------------
+void listenBeforeTalk() {
+    if (!LBT_ENABLED) {
+        return;
+    }
+
+    // The scan's DIO1 interrupt is not a received packet
+    bool pending = loraPacketReceived;
+    uint32_t startMs = millis();
+    uint8_t deferrals = 0;
+
+    while (true) {
+        lbtChecks++;
+        if (radio.scanChannel() != RADIOLIB_LORA_DETECTED) {
+            break;
+        }
+        if (deferrals >= LBT_MAX_DEFERRALS) {
+            lbtForced++;
+            break;
+        }
+        uint32_t span = (uint32_t)LBT_BACKOFF_MS << deferrals;
+        deferrals++;
+        lbtDeferrals++;
+        delay(span + random(span));
+    }
+
+    uint32_t heldMs = millis() - startMs;
+    if (heldMs > lbtHoldMaxMs) {
+        lbtHoldMaxMs = heldMs;
+    }
+    loraPacketReceived = pending;
+}
+
 //----------------------------------------------
 // Send ACK to Flight Computer
 // Sends signal quality info back so FC knows we received it
@@ -1120,6 +1370,7 @@ void sendAckToFlightComputer() {
     ackPacket[4] = (int8_t)lastSnr;
 
     // Send ACK via LoRa
+    listenBeforeTalk();
     int state = radio.transmit(ackPacket, 5);
     if (state == RADIOLIB_ERR_NONE) {
         loraTxCount++;
@@ -1130,6 +1381,595 @@ void sendAckToFlightComputer() {
     radio.startReceive();
 }
 
+//----------------------------------------------
+// ACK a Telemetry Frame
+// Noted for the next summary; with summaries off
+// (ackIntervalMs 0) an ACK goes out at once
+//----------------------------------------------
+void ackTelemetry(uint8_t rocketId, uint8_t sequence) {
+    ackFrameCount++;
+    if (rocketId < ACK_MAX_ROCKETS) {
+        AckRecord& rec = ackRecords[rocketId];
+        uint8_t step = (uint8_t)(sequence - rec.lastSeq);
+        uint8_t back = (uint8_t)(rec.lastSeq - sequence);
+
+        if (rec.seqValid && step >= 1 && step < 128) {
+            // Newer: the old latest moves into the bitmap
+            rec.bitmap = step > 16 ? 0 : (uint16_t)((rec.bitmap << step) | (1u << (step - 1)));
+            rec.lastSeq = sequence;
+        } else if (rec.seqValid && back >= 1 && back <= 16) {
+            rec.bitmap |= (uint16_t)(1u << (back - 1));    // Late frame fills its gap
+        } else if (!rec.seqValid || step != 0) {
+            rec.seqValid = true;                            // First frame, or a restart
+            rec.lastSeq = sequence;
+            rec.bitmap = 0;
+        }
+
+        rec.pending = true;
+        if (rec.frames < 255) {
+            rec.frames++;
+            rec.rssiSum += (int16_t)lastRssi;
+            rec.snrSum += (int8_t)lastSnr;
+        }
+    }
+
+    if (ackIntervalMs == 0) {
+        sendAckToFlightComputer();
+    }
+}
+
+//----------------------------------------------
+// Take a Flight Event Trailer
+// Strips it from a telemetry frame in
+// lastLoraPacketBinary, forwards the event once and
+// asks for a summary to ACK it. Only a frame the
+// sender marked has one; the mark is cleared and
+// the trailer always removed, so the frame's own
+// CRC still judges the rest.
+//----------------------------------------------
+bool takeEventTrailer() {
+    uint8_t* data = lastLoraPacketBinary;
+    int len = lastLoraPacketLen;
+
+    uint8_t rocketId;
+    if (len >= COMPACT_MIN_SIZE + EVENT_TRAILER_SIZE && data[0] == LORA_MAGIC_COMPACT_EVENT) {
+        data[0] = LORA_MAGIC_COMPACT;
+        rocketId = data[1] & 0x0F;
+    } else if (len >= 5 + EVENT_TRAILER_SIZE && data[0] == LORA_MAGIC &&
+               (data[1] & LORA_PACKET_EVENT_FLAG) != 0) {
+        uint8_t type = data[1] & ~LORA_PACKET_EVENT_FLAG;
+        if (type != LORA_PACKET_TELEMETRY && type != LORA_PACKET_BATCH &&
+            type != LORA_PACKET_RECOVERY) {
+            return false;
+        }
+        data[1] = type;
+        rocketId = data[2];
+    } else {
+        return false;
+    }
+    lastLoraPacketLen = len - EVENT_TRAILER_SIZE;
+
+    const uint8_t* trailer = &data[len - EVENT_TRAILER_SIZE];
+    if (trailer[14] != EVENT_TRAILER_TAG || crc8(trailer, 13) != trailer[13]) {
+        return false;
+    }
+
+    if (rocketId >= ACK_MAX_ROCKETS) {
+        return true;
+    }
+
+    // The rocket resends its oldest unACKed event, so
+    // a different sequence is a new one
+    AckRecord& rec = ackRecords[rocketId];
+    bool isNew = !rec.eventValid || rec.eventSeq != trailer[0];
+    rec.eventValid = true;
+    rec.eventSeq = trailer[0];
+    rec.eventPending = true;
+    ackRequested = true;
+
+    if (!isNew) {
+        eventRepeats++;
+        return true;
+    }
+    eventCount++;
+
+    uint8_t type = trailer[1];
+    uint8_t state = trailer[2];
+    uint32_t timeMs = trailer[3] | (trailer[4] << 8) | ((uint32_t)trailer[5] << 16) | ((uint32_t)trailer[6] << 24);
+    int32_t altDm = (int32_t)(trailer[7] | (trailer[8] << 8) | ((uint32_t)trailer[9] << 16) | ((uint32_t)trailer[10] << 24));
+    int16_t velDms = (int16_t)(trailer[11] | (trailer[12] << 8));
+
+    JsonWriter w;
+    jsonInit(w, jsonLine, sizeof(jsonLine));
+    jsonBeginObject(w, NULL);
+    jsonString(w, "type", "event");
+    jsonUint(w, "rocket_id", rocketId);
+    jsonUint(w, "seq", trailer[0]);
+    jsonString(w, "event", type >= 1 && type <= 9 ? flightEventNames[type - 1] : "unknown");
+    jsonString(w, "state", flightStateNames[state > 7 ? 0 : state]);
+    jsonUint(w, "time_ms", timeMs);
+    jsonFixed(w, "alt", altDm, 1);
+    jsonFixed(w, "vel", velDms, 1);
+    jsonFloat(w, "rssi", lastRssi, 1);
+    jsonFloat(w, "snr", lastSnr, 1);
+    jsonEndObject(w);
+    if (jsonFinish(w) == 0) {
+        return true;
+    }
+
+    forwardToClients(jsonLine);
+    Serial.printf("Event: %s\n", jsonLine);
+    return true;
+}
+
+//----------------------------------------------
+// Send the ACK Summary When Due
+// One entry per rocket heard since the last one,
+// round robin if more than fit
+//----------------------------------------------
+void serviceAckSummary() {
+    bool anyPending = false;
+    for (int i = 0; i < ACK_MAX_ROCKETS; i++) {
+        anyPending = anyPending || ackRecords[i].pending;
+    }
+
+    bool due = ackRequested ||
+        (ackIntervalMs != 0 && anyPending && millis() - lastAckSummaryMs >= ackIntervalMs);
+    if (!due) {
+        return;
+    }
+
+    uint8_t packet[ACK_SUMMARY_HEADER_SIZE + ACK_SUMMARY_MAX_ENTRIES * ACK_SUMMARY_ENTRY_SIZE +
+                   1 + ACK_EVENT_MAX_ENTRIES * ACK_EVENT_ENTRY_SIZE];
+    packet[0] = LORA_MAGIC;
+    packet[1] = LORA_PACKET_ACK_SUMMARY;
+    packet[2] = ackSequence++;
+    packet[3] = ackIntervalMs & 0xFF;
+    packet[4] = (ackIntervalMs >> 8) & 0xFF;
+
+    int len = ACK_SUMMARY_HEADER_SIZE;
+    uint8_t count = 0;
+    uint8_t next = ackNextRocket;
+    for (int i = 0; i < ACK_MAX_ROCKETS && count < ACK_SUMMARY_MAX_ENTRIES; i++) {
+        uint8_t id = (ackNextRocket + i) % ACK_MAX_ROCKETS;
+        AckRecord& rec = ackRecords[id];
+        if (!rec.pending) {
+            continue;
+        }
+
+        int16_t rssi = rec.rssiSum / rec.frames;
+        packet[len + 0] = id;
+        packet[len + 1] = rec.lastSeq;
+        packet[len + 2] = rec.bitmap & 0xFF;
+        packet[len + 3] = (rec.bitmap >> 8) & 0xFF;
+        packet[len + 4] = rec.frames;
+        packet[len + 5] = (uint8_t)(int8_t)(rec.snrSum / rec.frames);
+        packet[len + 6] = rssi & 0xFF;
+        packet[len + 7] = (rssi >> 8) & 0xFF;
+        len += ACK_SUMMARY_ENTRY_SIZE;
+        count++;
+
+        rec.pending = false;
+        rec.frames = 0;
+        rec.rssiSum = 0;
+        rec.snrSum = 0;
+        next = (id + 1) % ACK_MAX_ROCKETS;
+    }
+    packet[5] = count;
+
+    // Flight event ACKs: count, then rocket ID and
+    // latest event sequence
+    uint8_t events = 0;
+    for (int i = 0; i < ACK_MAX_ROCKETS && events < ACK_EVENT_MAX_ENTRIES; i++) {
+        AckRecord& rec = ackRecords[i];
+        if (!rec.eventPending) {
+            continue;
+        }
+        packet[len + 1 + events * ACK_EVENT_ENTRY_SIZE] = i;
+        packet[len + 2 + events * ACK_EVENT_ENTRY_SIZE] = rec.eventSeq;
+        rec.eventPending = false;
+        events++;
+    }
+    if (events > 0) {
+        packet[len] = events;
+        len += 1 + events * ACK_EVENT_ENTRY_SIZE;
+    }
+
+    ackNextRocket = next;
+    ackRequested = false;
+    lastAckSummaryMs = millis();
+
+    listenBeforeTalk();
+    int state = radio.transmit(packet, len);
+    if (state == RADIOLIB_ERR_NONE) {
+        loraTxCount++;
+        ackSummaryCount++;
+        ackAirUs += radio.getTimeOnAir(len);
+    }
+
+    // Restart receiving
+    radio.startReceive();
+}
+
+//----------------------------------------------
+// Send ACK Summary Settings and Counters
+//----------------------------------------------
+void sendAckStats(int clientIdx) {
+    JsonWriter w;
+    jsonInit(w, jsonLine, sizeof(jsonLine));
+    jsonBeginObject(w, NULL);
+    jsonString(w, "type", "ack_stats");
+    jsonUint(w, "interval_ms", ackIntervalMs);
+    jsonUint(w, "frames", ackFrameCount);
+    jsonUint(w, "summaries", ackSummaryCount);
+    jsonUint(w, "air_ms", ackAirUs / 1000);
+    jsonUint(w, "per_frame_air_ms", (uint32_t)((uint64_t)ackFrameCount * radio.getTimeOnAir(5) / 1000));
+    jsonUint(w, "events", eventCount);
+    jsonUint(w, "event_repeats", eventRepeats);
+    jsonEndObject(w);
+
+    if (jsonFinish(w) > 0) {
+        sendToClient(clientIdx, jsonLine);
+    }
+}
+
+//----------------------------------------------
+// Compact Frame Bit Reader (LSB first)
+//----------------------------------------------
+uint32_t readBits(const uint8_t* data, int& bitPos, int bits) {
+    uint32_t value = 0;
+    for (int i = 0; i < bits; i++, bitPos++) {
+        if (data[bitPos >> 3] & (1 << (bitPos & 7))) {
+            value |= (1UL << i);
+        }
+    }
+    return value;
+}
+
+int32_t readSigned(const uint8_t* data, int& bitPos, int bits) {
+    uint32_t value = readBits(data, bitPos, bits);
+    if (value & (1UL << (bits - 1))) {
+        value |= ~((1UL << bits) - 1);
+    }
+    return (int32_t)value;
+}
+
+// CRC-8, polynomial 0x31, init 0xFF (table as lora_protocol.c)
+static const uint8_t CRC8_TABLE[256] = {
+    0x00, 0x31, 0x62, 0x53, 0xC4, 0xF5, 0xA6, 0x97, 0xB9, 0x88, 0xDB, 0xEA, 0x7D, 0x4C, 0x1F, 0x2E,
+    0x43, 0x72, 0x21, 0x10, 0x87, 0xB6, 0xE5, 0xD4, 0xFA, 0xCB, 0x98, 0xA9, 0x3E, 0x0F, 0x5C, 0x6D,
+    0x86, 0xB7, 0xE4, 0xD5, 0x42, 0x73, 0x20, 0x11, 0x3F, 0x0E, 0x5D, 0x6C, 0xFB, 0xCA, 0x99, 0xA8,
+    0xC5, 0xF4, 0xA7, 0x96, 0x01, 0x30, 0x63, 0x52, 0x7C, 0x4D, 0x1E, 0x2F, 0xB8, 0x89, 0xDA, 0xEB,
+    0x3D, 0x0C, 0x5F, 0x6E, 0xF9, 0xC8, 0x9B, 0xAA, 0x84, 0xB5, 0xE6, 0xD7, 0x40, 0x71, 0x22, 0x13,
+    0x7E, 0x4F, 0x1C, 0x2D, 0xBA, 0x8B, 0xD8, 0xE9, 0xC7, 0xF6, 0xA5, 0x94, 0x03, 0x32, 0x61, 0x50,
+    0xBB, 0x8A, 0xD9, 0xE8, 0x7F, 0x4E, 0x1D, 0x2C, 0x02, 0x33, 0x60, 0x51, 0xC6, 0xF7, 0xA4, 0x95,
+    0xF8, 0xC9, 0x9A, 0xAB, 0x3C, 0x0D, 0x5E, 0x6F, 0x41, 0x70, 0x23, 0x12, 0x85, 0xB4, 0xE7, 0xD6,
+    0x7A, 0x4B, 0x18, 0x29, 0xBE, 0x8F, 0xDC, 0xED, 0xC3, 0xF2, 0xA1, 0x90, 0x07, 0x36, 0x65, 0x54,
+    0x39, 0x08, 0x5B, 0x6A, 0xFD, 0xCC, 0x9F, 0xAE, 0x80, 0xB1, 0xE2, 0xD3, 0x44, 0x75, 0x26, 0x17,
+    0xFC, 0xCD, 0x9E, 0xAF, 0x38, 0x09, 0x5A, 0x6B, 0x45, 0x74, 0x27, 0x16, 0x81, 0xB0, 0xE3, 0xD2,
+    0xBF, 0x8E, 0xDD, 0xEC, 0x7B, 0x4A, 0x19, 0x28, 0x06, 0x37, 0x64, 0x55, 0xC2, 0xF3, 0xA0, 0x91,
+    0x47, 0x76, 0x25, 0x14, 0x83, 0xB2, 0xE1, 0xD0, 0xFE, 0xCF, 0x9C, 0xAD, 0x3A, 0x0B, 0x58, 0x69,
+    0x04, 0x35, 0x66, 0x57, 0xC0, 0xF1, 0xA2, 0x93, 0xBD, 0x8C, 0xDF, 0xEE, 0x79, 0x48, 0x1B, 0x2A,
+    0xC1, 0xF0, 0xA3, 0x92, 0x05, 0x34, 0x67, 0x56, 0x78, 0x49, 0x1A, 0x2B, 0xBC, 0x8D, 0xDE, 0xEF,
+    0x82, 0xB3, 0xE0, 0xD1, 0x46, 0x77, 0x24, 0x15, 0x3B, 0x0A, 0x59, 0x68, 0xFF, 0xCE, 0x9D, 0xAC
+};
+
+uint8_t crc8Update(uint8_t crc, const uint8_t* data, size_t len) {
+    for (size_t i = 0; i < len; i++) {
+        crc = CRC8_TABLE[crc ^ data[i]];
+    }
+    return crc;
+}
+
+uint8_t crc8(const uint8_t* data, int len) {
+    return crc8Update(0xFF, data, len);
+}
+
+//----------------------------------------------
+// Expand Compact Telemetry Frame
+// Replaces the compact frame in lastLoraPacketBinary
+// with the equivalent full LoRaTelemetryPacket.
+// GPS origin and slow fields are remembered per
+// rocket; position is only reported once the
+// matching origin has been received.
+//----------------------------------------------
+bool expandCompactTelemetry() {
+    const uint8_t* data = lastLoraPacketBinary;
+    int len = lastLoraPacketLen;
+
+    if (len < COMPACT_MIN_SIZE || crc8(data, len - 1) != data[len - 1]) {
+        return false;
+    }
+
+    int bitPos = 8;
+    uint8_t rocketId = readBits(data, bitPos, 4);
+    uint8_t seqLow = readBits(data, bitPos, 8);
+    uint8_t state = readBits(data, bitPos, 3);
+    uint8_t flags = readBits(data, bitPos, 8);
+    uint8_t sections = readBits(data, bitPos, 3);
+
+    int bits = 139;
+    if (sections & COMPACT_HAS_GPS) bits += 34;
+    if (sections & COMPACT_HAS_ORIENTATION) bits += 72;
+    if (sections & COMPACT_HAS_SLOW) bits += 96;
+    if ((bits + 7) / 8 + 1 != len) {
+        return false;
+    }
+
+    CompactState& rocket = compactState[rocketId];
+    LoRaTelemetryPacket pkt;
+    memset(&pkt, 0, sizeof(pkt));
+    pkt.magic = LORA_MAGIC;
+    pkt.packetType = LORA_PACKET_TELEMETRY;
+    pkt.rocketId = rocketId;
+
+    // Extend the 8-bit sequence from the last one seen
+    uint16_t sequence = (rocket.sequence & 0xFF00) | seqLow;
+    if (sequence < rocket.sequence) sequence += 0x100;
+    rocket.sequence = sequence;
+    pkt.sequence = sequence;
+
+    pkt.timeMs = readBits(data, bitPos, 18) * 10;
+    pkt.altitudeCm = readSigned(data, bitPos, 19) * 10;
+    pkt.velocityCmps = constrain(readSigned(data, bitPos, 15) * 10, -32768, 32767);
+    pkt.pressurePa = readBits(data, bitPos, 17);
+    pkt.accelX = readSigned(data, bitPos, 12) * 20;
+    pkt.accelY = readSigned(data, bitPos, 12) * 20;
+    pkt.accelZ = readSigned(data, bitPos, 12) * 20;
+
+    uint8_t gpsEpoch = 0;
+    int32_t deltaLat = 0;
+    int32_t deltaLon = 0;
+    if (sections & COMPACT_HAS_GPS) {
+        gpsEpoch = readBits(data, bitPos, 2);
+        deltaLat = readSigned(data, bitPos, 16);
+        deltaLon = readSigned(data, bitPos, 16);
+    }
+
+    if (sections & COMPACT_HAS_ORIENTATION) {
+        pkt.gyroX = readSigned(data, bitPos, 12) * 10;
+        pkt.gyroY = readSigned(data, bitPos, 12) * 10;
+        pkt.gyroZ = readSigned(data, bitPos, 12) * 10;
+        pkt.magX = readSigned(data, bitPos, 12);
+        pkt.magY = readSigned(data, bitPos, 12);
+        pkt.magZ = readSigned(data, bitPos, 12);
+    }
+
+    if (sections & COMPACT_HAS_SLOW) {
+        rocket.originEpoch = readBits(data, bitPos, 2);
+        rocket.originLat = (int32_t)readBits(data, bitPos, 32);
+        rocket.originLon = (int32_t)readBits(data, bitPos, 32);
+        rocket.temperatureC10 = (int16_t)(readBits(data, bitPos, 8) * 5) - 400;
+        rocket.satellites = readBits(data, bitPos, 5);
+        rocket.gpsSpeedCmps = readBits(data, bitPos, 9) * 100;
+        rocket.gpsHeadingDeg10 = readBits(data, bitPos, 8) * 3600 / 256;
+        rocket.originValid = true;
+    }
+
+    pkt.temperatureC10 = rocket.temperatureC10;
+    pkt.gpsSatellites = rocket.satellites;
+    pkt.gpsSpeedCmps = rocket.gpsSpeedCmps;
+    pkt.gpsHeadingDeg10 = rocket.gpsHeadingDeg10;
+
+    if ((sections & COMPACT_HAS_GPS) && rocket.originValid && rocket.originEpoch == gpsEpoch) {
+        pkt.gpsLatitude = rocket.originLat + deltaLat * 10;
+        pkt.gpsLongitude = rocket.originLon + deltaLon * 10;
+    } else {
+        flags &= ~0x10;  // kFlagGpsFix: no usable position yet
+    }
+
+    pkt.state = state;
+    pkt.flags = flags;
+    pkt.crc = crc8((const uint8_t*)&pkt, sizeof(pkt) - 1);
+
+    memcpy(lastLoraPacketBinary, &pkt, sizeof(pkt));
+    lastLoraPacketLen = sizeof(pkt);
+    return true;
+}
+
+//----------------------------------------------
+// JSON Writer
+// Builds a line in a caller's buffer, with no
+// String and no printf. Packet fields are already
+// scaled integers (cm, microdegrees, tenths), so
+// jsonFixed places the decimal point; jsonFloat is
+// for the few values computed as floats. Commas
+// are placed by the writer.
+//----------------------------------------------
+static const char jsonHexDigits[] = "0123456789ABCDEF";
+static const uint32_t jsonPowersOf10[] = {
+    1, 10, 100, 1000, 10000, 100000, 1000000, 10000000, 100000000, 1000000000
+};
+
+void jsonInit(JsonWriter& w, char* buf, int maxLen) {
+    w.buf = buf;
+    w.maxLen = maxLen;
+    w.len = 0;
+    w.first = true;
+    w.overflow = maxLen < 1;      // One byte held back for the NUL
+}
+
+bool jsonRoom(JsonWriter& w, int count) {
+    if (w.overflow || w.len + count > w.maxLen - 1) {
+        w.overflow = true;
+        return false;
+    }
+    return true;
+}
+
+void jsonPutChar(JsonWriter& w, char c) {
+    if (jsonRoom(w, 1)) {
+        w.buf[w.len++] = c;
+    }
+}
+
+void jsonPutText(JsonWriter& w, const char* text) {
+    int len = strlen(text);
+    if (jsonRoom(w, len)) {
+        memcpy(&w.buf[w.len], text, len);
+        w.len += len;
+    }
+}
+
+// Decimal, zero-padded to at least minDigits
+void jsonPutDigits(JsonWriter& w, uint32_t value, uint8_t minDigits) {
+    char digits[10];
+    int count = 0;
+    do {
+        digits[count++] = '0' + value % 10;
+        value /= 10;
+    } while (value != 0);
+    while (count < minDigits) {
+        digits[count++] = '0';
+    }
+    if (jsonRoom(w, count)) {
+        while (count > 0) {
+            w.buf[w.len++] = digits[--count];
+        }
+    }
+}
+
+// Comma if needed, then "key": (no key in arrays)
+void jsonPutKey(JsonWriter& w, const char* key) {
+    if (!w.first) {
+        jsonPutChar(w, ',');
+    }
+    w.first = false;
+    if (key != NULL) {
+        jsonPutChar(w, '"');
+        jsonPutText(w, key);
+        jsonPutText(w, "\":");
+    }
+}
+
+void jsonBeginObject(JsonWriter& w, const char* key) {
+    jsonPutKey(w, key);
+    jsonPutChar(w, '{');
+    w.first = true;
+}
+
+void jsonEndObject(JsonWriter& w) {
+    jsonPutChar(w, '}');
+    w.first = false;
+}
+
+void jsonBeginArray(JsonWriter& w, const char* key) {
+    jsonPutKey(w, key);
+    jsonPutChar(w, '[');
+    w.first = true;
+}
+
+void jsonEndArray(JsonWriter& w) {
+    jsonPutChar(w, ']');
+    w.first = false;
+}
+
+// Keys are literals; values may come off the air
+// (rocket names), so quotes, backslashes and control
+// bytes are escaped as in JsonWriter_String
+void jsonString(JsonWriter& w, const char* key, const char* value) {
+    jsonPutKey(w, key);
+    jsonPutChar(w, '"');
+    for (const char* p = value; *p != '\0'; p++) {
+        uint8_t b = (uint8_t)*p;
+        if (b == '"' || b == '\\') {
+            jsonPutChar(w, '\\');
+            jsonPutChar(w, (char)b);
+        } else if (b < 0x20) {
+            jsonPutText(w, "\\u00");
+            jsonPutChar(w, jsonHexDigits[b >> 4]);
+            jsonPutChar(w, jsonHexDigits[b & 0x0F]);
+        } else {
+            jsonPutChar(w, (char)b);
+        }
+    }
+    jsonPutChar(w, '"');
+}
+
+void jsonBool(JsonWriter& w, const char* key, bool value) {
+    jsonPutKey(w, key);
+    jsonPutText(w, value ? "true" : "false");
+}
+
+void jsonUint(JsonWriter& w, const char* key, uint32_t value) {
+    jsonPutKey(w, key);
+    jsonPutDigits(w, value, 1);
+}
+
+// value is the number times 10^decimals: jsonFixed(w, "alt", 12345, 2)
+// writes "alt":123.45
+void jsonFixed(JsonWriter& w, const char* key, int32_t value, uint8_t decimals) {
+    if (decimals > 9) decimals = 9;
+    jsonPutKey(w, key);
+
+    // Magnitude as unsigned, so INT32_MIN is whole
+    uint32_t magnitude = (uint32_t)value;
+    if (value < 0) {
+        jsonPutChar(w, '-');
+        magnitude = 0u - magnitude;
+    }
+    if (decimals == 0) {
+        jsonPutDigits(w, magnitude, 1);
+        return;
+    }
+    uint32_t scale = jsonPowersOf10[decimals];
+    jsonPutDigits(w, magnitude / scale, 1);
+    jsonPutChar(w, '.');
+    jsonPutDigits(w, magnitude % scale, decimals);
+}
+
+void jsonInt(JsonWriter& w, const char* key, int32_t value) {
+    jsonFixed(w, key, value, 0);
+}
+
+// Rounded half away from zero, clamped to the int32 range
+void jsonFloat(JsonWriter& w, const char* key, float value, uint8_t decimals) {
+    if (decimals > 9) decimals = 9;
+    float scaled = value * (float)jsonPowersOf10[decimals];
+    scaled += scaled < 0.0f ? -0.5f : 0.5f;
+    int32_t fixed;
+    if (scaled >= 2147483520.0f) {
+        fixed = INT32_MAX;
+    } else if (scaled > -2147483520.0f) {
+        fixed = (int32_t)scaled;
+    } else {
+        fixed = INT32_MIN;        // Also NaN
+    }
+    jsonFixed(w, key, fixed, decimals);
+}
+
+// Bytes as a string of upper-case hex pairs
+void jsonHex(JsonWriter& w, const char* key, const uint8_t* data, int len) {
+    jsonPutKey(w, key);
+    jsonPutChar(w, '"');
+    if (len > 0 && jsonRoom(w, len * 2)) {
+        for (int i = 0; i < len; i++) {
+            w.buf[w.len++] = jsonHexDigits[data[i] >> 4];
+            w.buf[w.len++] = jsonHexDigits[data[i] & 0x0F];
+        }
+    }
+    jsonPutChar(w, '"');
+}
+
+// NUL-terminates; returns the length, 0 if it did
+// not fit. No newline: println adds it.
+int jsonFinish(JsonWriter& w) {
+    if (w.maxLen < 1) {
+        return 0;
+    }
+    if (w.overflow) {
+        w.buf[0] = '\0';
+        return 0;
+    }
+    w.buf[w.len] = '\0';
+    return w.len;
+}
+
+// Value in hundredths to tenths, rounded half away from zero
+int32_t hundredthsToTenths(int32_t value) {
+    return (value + (value < 0 ? -5 : 5)) / 10;
+}
+
 //----------------------------------------------
 // Forward Telemetry as JSON
 //----------------------------------------------
@@ -1171,63 +2011,249 @@ void forwardTelemetryAsJson() {
         lastDisplayCycleMs = millis();
     }
 
-    // Build JSON telemetry
-    String json = "{\"type\":\"tel\"";
-    json += ",\"id\":" + String(rocketId);
-    json += ",\"seq\":" + String(pkt->sequence);
-    json += ",\"time\":" + String(pkt->timeMs);
-    json += ",\"alt\":" + String(rocketAlt, 2);
-    json += ",\"vel\":" + String(pkt->velocityCmps / 100.0, 2);
-    json += ",\"pres\":" + String(pkt->pressurePa);
-    json += ",\"temp\":" + String(pkt->temperatureC10 / 10.0, 1);
+    // Binary clients get the packet as it is
+    if (anyClient(true)) {
+        StreamTelemetryRecord record;
+        memcpy(&record.packet, pkt, sizeof(LoRaTelemetryPacket));
+        record.rssi = (int16_t)lastRssi;
+        record.snr = (int8_t)lastSnr;
+        record.groundPressurePa = baroOk ? (uint32_t)(groundPressurePa + 0.5f) : 0;
+        record.gatewayFlags = gps.location.isValid() ? STREAM_GATEWAY_GPS_VALID : 0;
+        record.gatewayLatitude = gps.location.isValid() ? (int32_t)(gps.location.lat() * 1000000.0) : 0;
+        record.gatewayLongitude = gps.location.isValid() ? (int32_t)(gps.location.lng() * 1000000.0) : 0;
+        sendRecordToClients(STREAM_RECORD_TELEMETRY, (const uint8_t*)&record, sizeof(record));
+    }
+
+    // JSON only if a client still reads it
+    if (!anyClient(false)) {
+        return;
+    }
+
+    // Build JSON telemetry from the packet's own units
+    JsonWriter w;
+    jsonInit(w, jsonLine, sizeof(jsonLine));
+    jsonBeginObject(w, NULL);
+    jsonString(w, "type", "tel");
+    jsonUint(w, "id", rocketId);
+    jsonUint(w, "seq", pkt->sequence);
+    jsonUint(w, "time", pkt->timeMs);
+    jsonFixed(w, "alt", pkt->altitudeCm, 2);
+    jsonFixed(w, "vel", pkt->velocityCmps, 2);
+    jsonUint(w, "pres", pkt->pressurePa);
+    jsonFixed(w, "temp", pkt->temperatureC10, 1);
 
     // GPS
-    json += ",\"lat\":" + String(rocketLat, 6);
-    json += ",\"lon\":" + String(rocketLon, 6);
-    json += ",\"gspd\":" + String(pkt->gpsSpeedCmps / 100.0, 1);
-    json += ",\"ghdg\":" + String(pkt->gpsHeadingDeg10 / 10.0, 1);
-    json += ",\"sats\":" + String(pkt->gpsSatellites);
-
-    // IMU - Accelerometer (convert from milli-g to g)
-    json += ",\"ax\":" + String(pkt->accelX / 1000.0, 3);
-    json += ",\"ay\":" + String(pkt->accelY / 1000.0, 3);
-    json += ",\"az\":" + String(pkt->accelZ / 1000.0, 3);
-
-    // IMU - Gyroscope (convert from 0.1 deg/s to deg/s)
-    json += ",\"gx\":" + String(pkt->gyroX / 10.0, 1);
-    json += ",\"gy\":" + String(pkt->gyroY / 10.0, 1);
-    json += ",\"gz\":" + String(pkt->gyroZ / 10.0, 1);
+    jsonFixed(w, "lat", pkt->gpsLatitude, 6);
+    jsonFixed(w, "lon", pkt->gpsLongitude, 6);
+    jsonFixed(w, "gspd", hundredthsToTenths(pkt->gpsSpeedCmps), 1);
+    jsonFixed(w, "ghdg", pkt->gpsHeadingDeg10, 1);
+    jsonUint(w, "sats", pkt->gpsSatellites);
+
+    // IMU - Accelerometer (milli-g, written as g)
+    jsonFixed(w, "ax", pkt->accelX, 3);
+    jsonFixed(w, "ay", pkt->accelY, 3);
+    jsonFixed(w, "az", pkt->accelZ, 3);
+
+    // IMU - Gyroscope (0.1 deg/s, written as deg/s)
+    jsonFixed(w, "gx", pkt->gyroX, 1);
+    jsonFixed(w, "gy", pkt->gyroY, 1);
+    jsonFixed(w, "gz", pkt->gyroZ, 1);
 
     // IMU - Magnetometer (milligauss)
-    json += ",\"mx\":" + String(pkt->magX);
-    json += ",\"my\":" + String(pkt->magY);
-    json += ",\"mz\":" + String(pkt->magZ);
+    jsonInt(w, "mx", pkt->magX);
+    jsonInt(w, "my", pkt->magY);
+    jsonInt(w, "mz", pkt->magZ);
 
     // State and flags
     uint8_t stateIdx = pkt->state;
     if (stateIdx > 7) stateIdx = 0;
-    json += ",\"state\":\"" + String(flightStateNames[stateIdx]) + "\"";
-    json += ",\"flags\":" + String(pkt->flags);
+    jsonString(w, "state", flightStateNames[stateIdx]);
+    jsonUint(w, "flags", pkt->flags);
 
     // Add RSSI/SNR
-    json += ",\"rssi\":" + String(lastRssi, 1);
-    json += ",\"snr\":" + String(lastSnr, 1);
+    jsonFloat(w, "rssi", lastRssi, 1);
+    jsonFloat(w, "snr", lastSnr, 1);
 
     // Add distance if valid
     if (rocketDist > 0) {
-        json += ",\"dist\":" + String(rocketDist, 1);
+        jsonFloat(w, "dist", rocketDist, 1);
     }
 
-    json += "}";
+    jsonEndObject(w);
+    if (jsonFinish(w) == 0) {
+        return;
+    }
 
-    // Send to all clients
-    for (int i = 0; i < MAX_CLIENTS; i++) {
-        if (clients[i] && clients[i].connected()) {
-            clients[i].println(json);
+    // Binary clients had the record above
+    forwardToJsonClients(jsonLine);
+
+    Serial.printf("TX JSON: %.80s...\n", jsonLine);
+}
+
+//----------------------------------------------
+// Forward Telemetry Batch as JSON
+// Expands the delta-coded 100 Hz samples (layout:
+// lora_protocol.h) into [t ms, alt m, vel m/s,
+// accel m/s^2] records.
+//----------------------------------------------
+bool readVarint(const uint8_t* data, int len, int& offset, uint32_t& value) {
+    value = 0;
+    for (int shift = 0; shift < 35; shift += 7) {
+        if (offset >= len) return false;
+        uint8_t b = data[offset++];
+        value |= (uint32_t)(b & 0x7F) << shift;
+        if ((b & 0x80) == 0) return true;
+    }
+    return false;
+}
+
+int32_t unZigZag(uint32_t value) {
+    return (int32_t)(value >> 1) ^ -(int32_t)(value & 1);
+}
+
+bool forwardTelemetryBatchAsJson() {
+    const uint8_t* data = lastLoraPacketBinary;
+    int len = lastLoraPacketLen;
+
+    if (len < BATCH_HEADER_SIZE + 1 || crc8(data, len - 1) != data[len - 1]) {
+        return false;
+    }
+
+    uint8_t rocketId = data[2];
+    if (rocketId >= MAX_ROCKETS) rocketId = 0;
+    uint16_t sequence = data[3] | (data[4] << 8);
+    uint8_t stateIdx = data[5];
+    if (stateIdx > 7) stateIdx = 0;
+    uint8_t count = data[7];
+
+    int32_t timeMs, altDm;
+    int16_t velDms, accDms2;
+    memcpy(&timeMs, &data[8], 4);
+    memcpy(&altDm, &data[12], 4);
+    memcpy(&velDms, &data[16], 2);
+    memcpy(&accDms2, &data[18], 2);
+
+    JsonWriter w;
+    jsonInit(w, jsonLine, sizeof(jsonLine));
+    jsonBeginObject(w, NULL);
+    jsonString(w, "type", "tel_batch");
+    jsonUint(w, "id", rocketId);
+    jsonUint(w, "seq", sequence);
+    jsonString(w, "state", flightStateNames[stateIdx]);
+    jsonUint(w, "flags", data[6]);
+    jsonFloat(w, "rssi", lastRssi, 1);
+    jsonFloat(w, "snr", lastSnr, 1);
+    jsonBeginArray(w, "s");
+
+    int offset = BATCH_HEADER_SIZE;
+    for (int i = 0; i < count; i++) {
+        if (i > 0) {
+            uint32_t step, dAlt, dVel, dAcc;
+            if (!readVarint(data, len - 1, offset, step) ||
+                !readVarint(data, len - 1, offset, dAlt) ||
+                !readVarint(data, len - 1, offset, dVel) ||
+                !readVarint(data, len - 1, offset, dAcc)) {
+                return false;
+            }
+            timeMs += step;
+            altDm += unZigZag(dAlt);
+            velDms += unZigZag(dVel);
+            accDms2 += unZigZag(dAcc);
         }
+        jsonBeginArray(w, NULL);
+        jsonInt(w, NULL, timeMs);
+        jsonFixed(w, NULL, altDm, 1);
+        jsonFixed(w, NULL, velDms, 1);
+        jsonFixed(w, NULL, accDms2, 1);
+        jsonEndArray(w);
     }
+    jsonEndArray(w);
+    jsonEndObject(w);
 
-    Serial.println("TX JSON: " + json.substring(0, 80) + "...");
+    // Keep the tracking view current between snapshots
+    rockets[rocketId].active = true;
+    rockets[rocketId].lastUpdateMs = millis();
+    rockets[rocketId].altitudeM = altDm / 10.0;
+    rockets[rocketId].state = stateIdx;
+    rockets[rocketId].rssi = (int16_t)lastRssi;
+
+    if (jsonFinish(w) > 0) {
+        forwardToJsonClients(jsonLine);
+    }
+    sendFrameToClients();
+    return true;
+}
+
+//----------------------------------------------
+// Forward Recovery Beacon as JSON
+// Sent instead of telemetry once landed: position,
+// max altitude and time since landing (layout:
+// lora_protocol.h)
+//----------------------------------------------
+bool forwardRecoveryAsJson() {
+    const uint8_t* data = lastLoraPacketBinary;
+
+    if (lastLoraPacketLen != RECOVERY_PACKET_SIZE || crc8(data, RECOVERY_PACKET_SIZE - 1) != data[RECOVERY_PACKET_SIZE - 1]) {
+        return false;
+    }
+
+    uint8_t rocketId = data[2];
+    if (rocketId >= MAX_ROCKETS) rocketId = 0;
+    uint16_t sequence = data[3] | (data[4] << 8);
+    uint8_t stateIdx = data[5];
+    if (stateIdx > 7) stateIdx = 0;
+
+    int32_t latUdeg, lonUdeg;
+    memcpy(&latUdeg, &data[8], 4);
+    memcpy(&lonUdeg, &data[12], 4);
+    float rocketLat = latUdeg / 1000000.0;
+    float rocketLon = lonUdeg / 1000000.0;
+    uint16_t maxAltM = data[16] | (data[17] << 8);
+    uint16_t landedS = data[18] | (data[19] << 8);
+
+    rockets[rocketId].active = true;
+    rockets[rocketId].lastUpdateMs = millis();
+    rockets[rocketId].latitude = rocketLat;
+    rockets[rocketId].longitude = rocketLon;
+    rockets[rocketId].altitudeM = 0.0;
+    rockets[rocketId].state = stateIdx;
+    rockets[rocketId].satellites = data[7];
+    rockets[rocketId].rssi = (int16_t)lastRssi;
+
+    float rocketDist = 0.0;
+    if (gps.location.isValid() && rocketLat != 0.0 && rocketLon != 0.0) {
+        rocketDist = calculateDistance(
+            gps.location.lat(), gps.location.lng(),
+            rocketLat, rocketLon
+        );
+        rockets[rocketId].distanceM = rocketDist;
+    }
+
+    JsonWriter w;
+    jsonInit(w, jsonLine, sizeof(jsonLine));
+    jsonBeginObject(w, NULL);
+    jsonString(w, "type", "recovery");
+    jsonUint(w, "id", rocketId);
+    jsonUint(w, "seq", sequence);
+    jsonString(w, "state", flightStateNames[stateIdx]);
+    jsonUint(w, "flags", data[6]);
+    jsonUint(w, "sats", data[7]);
+    jsonFixed(w, "lat", latUdeg, 6);
+    jsonFixed(w, "lon", lonUdeg, 6);
+    jsonUint(w, "max_alt", maxAltM);
+    jsonUint(w, "landed_s", landedS);
+    jsonFloat(w, "rssi", lastRssi, 1);
+    jsonFloat(w, "snr", lastSnr, 1);
+    if (rocketDist > 0) {
+        jsonFloat(w, "dist", rocketDist, 1);
+    }
+    jsonEndObject(w);
+
+    if (jsonFinish(w) > 0) {
+        forwardToJsonClients(jsonLine);
+    }
+    sendFrameToClients();
+    return true;
 }
 
 //----------------------------------------------
@@ -1248,28 +2274,38 @@ void forwardBaroCompareAsJson() {
     // Check for diagnostic packet (p390 == 0xFFFFFFFF)
     if (p390 == 0xFFFFFFFF) {
         // Diagnostic: bytes 6=bmp390ok, 7=bmp581ok, 8=lastError, 9=i2cAddr, 10=chipId
-        String json = "{\"type\":\"baro_diag\"";
-        json += ",\"bmp390\":" + String(lastLoraPacketBinary[6]);
-        json += ",\"bmp581\":" + String(lastLoraPacketBinary[7]);
-        json += ",\"err\":" + String(lastLoraPacketBinary[8]);
-        json += ",\"addr\":\"0x" + String(lastLoraPacketBinary[9], HEX) + "\"";
-        json += ",\"chipId\":\"0x" + String(lastLoraPacketBinary[10], HEX) + "\"";
-        json += ",\"errMsg\":\"";
+        const char* errMsg;
         switch (lastLoraPacketBinary[8]) {
-            case 0: json += "OK"; break;
-            case 1: json += "I2C read failed"; break;
-            case 2: json += "Wrong chip ID"; break;
-            case 3: json += "Reset failed"; break;
-            case 4: json += "Configure failed"; break;
-            case 5: json += "SetMode failed"; break;
-            case 6: json += "INT_SOURCE write failed"; break;
-            case 7: json += "INT_CONFIG write failed"; break;
-            default: json += "Unknown"; break;
-        }
-        json += "\"";
-        json += ",\"rssi\":" + String(lastRssi, 1);
-        json += ",\"snr\":" + String(lastSnr, 1) + "}";
-        forwardToClients(json);
+            case 0: errMsg = "OK"; break;
+            case 1: errMsg = "I2C read failed"; break;
+            case 2: errMsg = "Wrong chip ID"; break;
+            case 3: errMsg = "Reset failed"; break;
+            case 4: errMsg = "Configure failed"; break;
+            case 5: errMsg = "SetMode failed"; break;
+            case 6: errMsg = "INT_SOURCE write failed"; break;
+            case 7: errMsg = "INT_CONFIG write failed"; break;
+            default: errMsg = "Unknown"; break;
+        }
+        char addr[5], chipId[5];
+        snprintf(addr, sizeof(addr), "0x%x", lastLoraPacketBinary[9]);
+        snprintf(chipId, sizeof(chipId), "0x%x", lastLoraPacketBinary[10]);
+
+        JsonWriter w;
+        jsonInit(w, jsonLine, sizeof(jsonLine));
+        jsonBeginObject(w, NULL);
+        jsonString(w, "type", "baro_diag");
+        jsonUint(w, "bmp390", lastLoraPacketBinary[6]);
+        jsonUint(w, "bmp581", lastLoraPacketBinary[7]);
+        jsonUint(w, "err", lastLoraPacketBinary[8]);
+        jsonString(w, "addr", addr);
+        jsonString(w, "chipId", chipId);
+        jsonString(w, "errMsg", errMsg);
+        jsonFloat(w, "rssi", lastRssi, 1);
+        jsonFloat(w, "snr", lastSnr, 1);
+        jsonEndObject(w);
+        if (jsonFinish(w) > 0) {
+            forwardToClients(jsonLine);
+        }
         return;
     }
 
@@ -1281,43 +2317,44 @@ void forwardBaroCompareAsJson() {
                     ((uint32_t)lastLoraPacketBinary[11] << 24);
     int16_t t581 = (int16_t)(lastLoraPacketBinary[12] | (lastLoraPacketBinary[13] << 8));
 
-    float dP = (float)p581 / 10.0 - (float)p390 / 10.0;
-    float dT = (float)t581 / 100.0 - (float)t390 / 100.0;
-
-    String json = "{\"type\":\"baro\"";
-    json += ",\"p390\":" + String(p390 / 10.0, 1);
-    json += ",\"t390\":" + String(t390 / 100.0, 2);
-    json += ",\"p581\":" + String(p581 / 10.0, 1);
-    json += ",\"t581\":" + String(t581 / 100.0, 2);
-    json += ",\"dP\":" + String(dP, 1);
-    json += ",\"dT\":" + String(dT, 2);
-    json += ",\"rssi\":" + String(lastRssi, 1);
-    json += ",\"snr\":" + String(lastSnr, 1);
-    json += "}";
-
-    forwardToClients(json);
+    // Differences in the sensors' own units (0.1 Pa, 0.01 C)
+    JsonWriter w;
+    jsonInit(w, jsonLine, sizeof(jsonLine));
+    jsonBeginObject(w, NULL);
+    jsonString(w, "type", "baro");
+    jsonFixed(w, "p390", (int32_t)p390, 1);
+    jsonFixed(w, "t390", t390, 2);
+    jsonFixed(w, "p581", (int32_t)p581, 1);
+    jsonFixed(w, "t581", t581, 2);
+    jsonFixed(w, "dP", (int32_t)(p581 - p390), 1);
+    jsonFixed(w, "dT", t581 - t390, 2);
+    jsonFloat(w, "rssi", lastRssi, 1);
+    jsonFloat(w, "snr", lastSnr, 1);
+    jsonEndObject(w);
+
+    if (jsonFinish(w) > 0) {
+        forwardToClients(jsonLine);
+    }
 }
 
 //----------------------------------------------
 // Forward Unknown Packet as Hex
 //----------------------------------------------
 void forwardAsHex() {
-    String hex = "{\"type\":\"raw\",\"len\":" + String(lastLoraPacketLen);
-    hex += ",\"hex\":\"";
-    for (int i = 0; i < lastLoraPacketLen && i < 64; i++) {
-        char buf[3];
-        sprintf(buf, "%02X", lastLoraPacketBinary[i]);
-        hex += buf;
-    }
-    hex += "\",\"rssi\":" + String(lastRssi, 1);
-    hex += ",\"snr\":" + String(lastSnr, 1);
-    hex += "}";
-
-    for (int i = 0; i < MAX_CLIENTS; i++) {
-        if (clients[i] && clients[i].connected()) {
-            clients[i].println(hex);
-        }
-    }
+    JsonWriter w;
+    jsonInit(w, jsonLine, sizeof(jsonLine));
+    jsonBeginObject(w, NULL);
+    jsonString(w, "type", "raw");
+    jsonUint(w, "len", lastLoraPacketLen);
+    jsonHex(w, "hex", lastLoraPacketBinary, lastLoraPacketLen < 64 ? lastLoraPacketLen : 64);
+    jsonFloat(w, "rssi", lastRssi, 1);
+    jsonFloat(w, "snr", lastSnr, 1);
+    jsonEndObject(w);
+
+    if (jsonFinish(w) > 0) {
+        forwardToJsonClients(jsonLine);
+    }
+    sendFrameToClients();
 }
 
 //----------------------------------------------
@@ -1333,15 +2370,16 @@ void forwardAckAsJson() {
     uint8_t cmdId = lastLoraPacketBinary[2];
     bool success = lastLoraPacketBinary[3] != 0;
 
-    String json = "{\"type\":\"ack\"";
-    json += ",\"id\":" + String(cmdId);
-    json += ",\"ok\":" + String(success ? "true" : "false");
-    json += "}";
+    JsonWriter w;
+    jsonInit(w, jsonLine, sizeof(jsonLine));
+    jsonBeginObject(w, NULL);
+    jsonString(w, "type", "ack");
+    jsonUint(w, "id", cmdId);
+    jsonBool(w, "ok", success);
+    jsonEndObject(w);
 
-    for (int i = 0; i < MAX_CLIENTS; i++) {
-        if (clients[i] && clients[i].connected()) {
-            clients[i].println(json);
-        }
+    if (jsonFinish(w) > 0) {
+        forwardToClients(jsonLine);
     }
     Serial.println("Forwarded ack");
 }
@@ -1349,6 +2387,21 @@ void forwardAckAsJson() {
 //----------------------------------------------
 // Forward Device Info (fc_info) as JSON
 //----------------------------------------------
+// Copy a length-prefixed fc_info string into out
+// (NUL terminated, truncated to fit); jsonString
+// escapes it on the way out
+void readInfoString(int& offset, char* out, int outSize) {
+    uint8_t len = lastLoraPacketBinary[offset++];
+    int n = 0;
+    for (int i = 0; i < len && offset < lastLoraPacketLen; i++) {
+        char c = (char)lastLoraPacketBinary[offset++];
+        if (n < outSize - 1 && c != '\0') {
+            out[n++] = c;
+        }
+    }
+    out[n] = '\0';
+}
+
 void forwardDeviceInfoAsJson() {
     // Format: magic, type, versionLen, version[], buildLen, build[], flags, state, sampleCount(4),
     //         rocketId, nameLen, name[], baroTypeLen, baroType[], imuTypeLen, imuType[]
@@ -1360,19 +2413,13 @@ void forwardDeviceInfoAsJson() {
     int offset = 2;
 
     // Version string
-    uint8_t versionLen = lastLoraPacketBinary[offset++];
-    String version = "";
-    for (int i = 0; i < versionLen && offset < lastLoraPacketLen; i++) {
-        version += (char)lastLoraPacketBinary[offset++];
-    }
+    char version[32];
+    readInfoString(offset, version, sizeof(version));
 
     // Build string
-    String build = "";
+    char build[32] = "";
     if (offset < lastLoraPacketLen) {
-        uint8_t buildLen = lastLoraPacketBinary[offset++];
-        for (int i = 0; i < buildLen && offset < lastLoraPacketLen; i++) {
-            build += (char)lastLoraPacketBinary[offset++];
-        }
+        readInfoString(offset, build, sizeof(build));
     }
 
     // Hardware flags
@@ -1404,59 +2451,151 @@ void forwardDeviceInfoAsJson() {
     }
 
     // Rocket name (added in v2)
-    String rocketName = "";
+    char rocketName[32] = "";
     if (offset < lastLoraPacketLen) {
-        uint8_t nameLen = lastLoraPacketBinary[offset++];
-        for (int i = 0; i < nameLen && offset < lastLoraPacketLen; i++) {
-            rocketName += (char)lastLoraPacketBinary[offset++];
-        }
+        readInfoString(offset, rocketName, sizeof(rocketName));
     }
 
     // Barometer type string (added in v3 - Heltec flight computer)
-    String baroType = "";
+    char baroType[32] = "";
     if (offset < lastLoraPacketLen) {
-        uint8_t baroTypeLen = lastLoraPacketBinary[offset++];
-        for (int i = 0; i < baroTypeLen && offset < lastLoraPacketLen; i++) {
-            baroType += (char)lastLoraPacketBinary[offset++];
-        }
+        readInfoString(offset, baroType, sizeof(baroType));
     }
 
     // IMU type string (added in v3 - Heltec flight computer)
-    String imuType = "";
+    char imuType[32] = "";
+    if (offset < lastLoraPacketLen) {
+        readInfoString(offset, imuType, sizeof(imuType));
+    }
+
+    // Uplink channel (0 = control channel)
+    int channel = -1;
     if (offset < lastLoraPacketLen) {
-        uint8_t imuTypeLen = lastLoraPacketBinary[offset++];
-        for (int i = 0; i < imuTypeLen && offset < lastLoraPacketLen; i++) {
-            imuType += (char)lastLoraPacketBinary[offset++];
+        channel = lastLoraPacketBinary[offset++];
+    }
+
+    // Channel access counts (LBT deferrals, forced
+    // sends, CRC errors), u16 each
+    bool hasCounts = false;
+    uint16_t counts[3] = {0, 0, 0};
+    if (offset + 6 <= lastLoraPacketLen) {
+        for (int i = 0; i < 3; i++) {
+            counts[i] = lastLoraPacketBinary[offset] | (lastLoraPacketBinary[offset + 1] << 8);
+            offset += 2;
+        }
+        hasCounts = true;
+    }
+
+    // Downlink queueing delay per class (average,
+    // longest, ms), then held and dropped frames
+    bool hasDownlink = false;
+    uint16_t delays[8] = {0};
+    uint16_t downlinkCounts[2] = {0, 0};
+    if (offset + 20 <= lastLoraPacketLen) {
+        for (int i = 0; i < 8; i++) {
+            delays[i] = lastLoraPacketBinary[offset] | (lastLoraPacketBinary[offset + 1] << 8);
+            offset += 2;
+        }
+        for (int i = 0; i < 2; i++) {
+            downlinkCounts[i] = lastLoraPacketBinary[offset] | (lastLoraPacketBinary[offset + 1] << 8);
+            offset += 2;
         }
+        hasDownlink = true;
     }
 
-    String json = "{\"type\":\"fc_info\"";
-    json += ",\"version\":\"" + version + "\"";
-    json += ",\"build\":\"" + build + "\"";
-    json += ",\"bmp390\":" + String((flags & 0x01) ? "true" : "false");
-    json += ",\"lora\":" + String((flags & 0x02) ? "true" : "false");
-    json += ",\"imu\":" + String((flags & 0x04) ? "true" : "false");
-    json += ",\"oled\":" + String((flags & 0x10) ? "true" : "false");
-    json += ",\"gps\":" + String((flags & 0x20) ? "true" : "false");
-    json += ",\"state\":\"" + String(flightStateNames[state > 7 ? 0 : state]) + "\"";
-    json += ",\"samples\":" + String(samples);
-    json += ",\"rocket_id\":" + String(rocketId);
-    json += ",\"rocket_name\":\"" + rocketName + "\"";
+    // Radio SPI time of the rocket's last send and receive (us)
+    bool hasSpi = false;
+    uint16_t spiUs[2] = {0, 0};
+    if (offset + 4 <= lastLoraPacketLen) {
+        for (int i = 0; i < 2; i++) {
+            spiUs[i] = lastLoraPacketBinary[offset] | (lastLoraPacketBinary[offset + 1] << 8);
+            offset += 2;
+        }
+        hasSpi = true;
+    }
 
-    // Include sensor type strings if present (from Heltec flight computer)
-    if (baroType.length() > 0) {
-        json += ",\"baro_type\":\"" + baroType + "\"";
+    // Boot verification time of the stored flights (us)
+    bool hasVerify = false;
+    uint32_t verifyUs = 0;
+    if (offset + 4 <= lastLoraPacketLen) {
+        verifyUs = lastLoraPacketBinary[offset] |
+                   (lastLoraPacketBinary[offset+1] << 8) |
+                   (lastLoraPacketBinary[offset+2] << 16) |
+                   ((uint32_t)lastLoraPacketBinary[offset+3] << 24);
+        offset += 4;
+        hasVerify = true;
     }
-    if (imuType.length() > 0) {
-        json += ",\"imu_type\":\"" + imuType + "\"";
+
+    // SD card write and read rate from the rocket's boot benchmark (KB/s, 0 if not run)
+    uint16_t sdKBps[2] = {0, 0};
+    if (offset + 4 <= lastLoraPacketLen) {
+        for (int i = 0; i < 2; i++) {
+            sdKBps[i] = lastLoraPacketBinary[offset] | (lastLoraPacketBinary[offset + 1] << 8);
+            offset += 2;
+        }
     }
 
-    json += "}";
+    JsonWriter w;
+    jsonInit(w, jsonLine, sizeof(jsonLine));
+    jsonBeginObject(w, NULL);
+    jsonString(w, "type", "fc_info");
+    jsonString(w, "version", version);
+    jsonString(w, "build", build);
+    jsonBool(w, "bmp390", flags & 0x01);
+    jsonBool(w, "lora", flags & 0x02);
+    jsonBool(w, "imu", flags & 0x04);
+    jsonBool(w, "oled", flags & 0x10);
+    jsonBool(w, "gps", flags & 0x20);
+    jsonString(w, "state", flightStateNames[state > 7 ? 0 : state]);
+    jsonUint(w, "samples", samples);
+    jsonUint(w, "rocket_id", rocketId);
+    jsonString(w, "rocket_name", rocketName);
 
-    for (int i = 0; i < MAX_CLIENTS; i++) {
-        if (clients[i] && clients[i].connected()) {
-            clients[i].println(json);
+    // Include sensor type strings if present (from Heltec flight computer)
+    if (baroType[0] != '\0') {
+        jsonString(w, "baro_type", baroType);
+    }
+    if (imuType[0] != '\0') {
+        jsonString(w, "imu_type", imuType);
+    }
+    if (channel >= 0) {
+        jsonUint(w, "channel", channel);
+    }
+    if (hasCounts) {
+        jsonUint(w, "lbt_deferrals", counts[0]);
+        jsonUint(w, "lbt_forced", counts[1]);
+        jsonUint(w, "crc_errors", counts[2]);
+    }
+    if (hasDownlink) {
+        // Averages and maxima are interleaved per class
+        jsonBeginArray(w, "dl_delay_ms");
+        for (int i = 0; i < 8; i += 2) {
+            jsonUint(w, NULL, delays[i]);
         }
+        jsonEndArray(w);
+        jsonBeginArray(w, "dl_delay_max_ms");
+        for (int i = 1; i < 8; i += 2) {
+            jsonUint(w, NULL, delays[i]);
+        }
+        jsonEndArray(w);
+        jsonUint(w, "dl_held", downlinkCounts[0]);
+        jsonUint(w, "dl_dropped", downlinkCounts[1]);
+    }
+    if (hasSpi) {
+        jsonUint(w, "spi_tx_us", spiUs[0]);
+        jsonUint(w, "spi_rx_us", spiUs[1]);
+    }
+    if (hasVerify) {
+        jsonUint(w, "verify_us", verifyUs);
+    }
+    if (sdKBps[0] != 0 || sdKBps[1] != 0) {
+        jsonFixed(w, "sd_write_mbps", sdKBps[0], 3);
+        jsonFixed(w, "sd_read_mbps", sdKBps[1], 3);
+    }
+    jsonEndObject(w);
+
+    if (jsonFinish(w) > 0) {
+        forwardToClients(jsonLine);
     }
     Serial.println("Forwarded fc_info");
 }
@@ -1474,12 +2613,18 @@ void forwardFlashListAsJson() {
     uint8_t flightCount = lastLoraPacketBinary[2];
     int offset = 3;
 
-    String json = "{\"type\":\"flash_list\"";
-    json += ",\"count\":" + String(flightCount);
-    json += ",\"flights\":[";
+    // Boot verification status of each flight, after the entries (newer flight firmware)
+    int statusOffset = 3 + flightCount * 17;
+    bool hasStatus = lastLoraPacketLen >= statusOffset + flightCount;
 
-    bool first = true;
-    while (offset + 17 <= lastLoraPacketLen) {  // Each entry is 17 bytes
+    JsonWriter w;
+    jsonInit(w, jsonLine, sizeof(jsonLine));
+    jsonBeginObject(w, NULL);
+    jsonString(w, "type", "flash_list");
+    jsonUint(w, "count", flightCount);
+    jsonBeginArray(w, "flights");
+
+    for (uint8_t i = 0; i < flightCount && offset + 17 <= lastLoraPacketLen; i++) {  // Each entry is 17 bytes
         uint8_t slot = lastLoraPacketBinary[offset++];
 
         uint32_t flightId = lastLoraPacketBinary[offset] |
@@ -1506,23 +2651,24 @@ void forwardFlashListAsJson() {
                            (lastLoraPacketBinary[offset+3] << 24);
         offset += 4;
 
-        if (!first) json += ",";
-        first = false;
-
-        json += "{\"slot\":" + String(slot);
-        json += ",\"id\":" + String(flightId);
-        json += ",\"alt\":" + String(altCm / 100.0, 1);
-        json += ",\"time\":" + String(timeMs);
-        json += ",\"samples\":" + String(samples);
-        json += "}";
+        jsonBeginObject(w, NULL);
+        jsonUint(w, "slot", slot);
+        jsonUint(w, "id", flightId);
+        jsonFixed(w, "alt", hundredthsToTenths(altCm), 1);
+        jsonUint(w, "time", timeMs);
+        jsonUint(w, "samples", samples);
+        if (hasStatus) {
+            uint8_t status = lastLoraPacketBinary[statusOffset + i];
+            jsonString(w, "status", status < 5 ? slotStatusNames[status] : "unknown");
+        }
+        jsonEndObject(w);
     }
 
-    json += "]}";
+    jsonEndArray(w);
+    jsonEndObject(w);
 
-    for (int i = 0; i < MAX_CLIENTS; i++) {
-        if (clients[i] && clients[i].connected()) {
-            clients[i].println(json);
-        }
+    if (jsonFinish(w) > 0) {
+        forwardToClients(jsonLine);
     }
     Serial.println("Forwarded flash_list");
 }
@@ -1538,6 +2684,12 @@ void forwardFlashDataAsJson() {
         return;
     }
 
+    // Binary clients get the packet as it is
+    sendRecordToClients(STREAM_RECORD_FLASH_DATA, lastLoraPacketBinary, lastLoraPacketLen);
+    if (!anyClient(false)) {
+        return;
+    }
+
     uint8_t slot = lastLoraPacketBinary[2];
 
     uint32_t startSample = lastLoraPacketBinary[3] |
@@ -1548,20 +2700,16 @@ void forwardFlashDataAsJson() {
     // Check if this is a header packet
     if (startSample == 0xFFFFFFFF) {
         // Header packet - forward the raw hex data for desktop to decode
-        String json = "{\"type\":\"flash_header\"";
-        json += ",\"slot\":" + String(slot);
-        json += ",\"data\":\"";
-        for (int i = 7; i < lastLoraPacketLen && i < 64; i++) {
-            char buf[3];
-            sprintf(buf, "%02X", lastLoraPacketBinary[i]);
-            json += buf;
-        }
-        json += "\"}";
-
-        for (int i = 0; i < MAX_CLIENTS; i++) {
-            if (clients[i] && clients[i].connected()) {
-                clients[i].println(json);
-            }
+        JsonWriter w;
+        jsonInit(w, jsonLine, sizeof(jsonLine));
+        jsonBeginObject(w, NULL);
+        jsonString(w, "type", "flash_header");
+        jsonUint(w, "slot", slot);
+        jsonHex(w, "data", &lastLoraPacketBinary[7], (lastLoraPacketLen < 64 ? lastLoraPacketLen : 64) - 7);
+        jsonEndObject(w);
+
+        if (jsonFinish(w) > 0) {
+            forwardToJsonClients(jsonLine);
         }
         Serial.println("Forwarded flash_header");
         return;
@@ -1576,40 +2724,146 @@ void forwardFlashDataAsJson() {
     uint8_t sampleCount = lastLoraPacketBinary[11];
 
     // Forward sample data as hex (desktop will decode the FlightSample structs)
-    String json = "{\"type\":\"flash_data\"";
-    json += ",\"slot\":" + String(slot);
-    json += ",\"start\":" + String(startSample);
-    json += ",\"total\":" + String(totalSamples);
-    json += ",\"count\":" + String(sampleCount);
-    json += ",\"data\":\"";
+    JsonWriter w;
+    jsonInit(w, jsonLine, sizeof(jsonLine));
+    jsonBeginObject(w, NULL);
+    jsonString(w, "type", "flash_data");
+    jsonUint(w, "slot", slot);
+    jsonUint(w, "start", startSample);
+    jsonUint(w, "total", totalSamples);
+    jsonUint(w, "count", sampleCount);
 
     // Hex encode the sample data starting at offset 12
-    for (int i = 12; i < lastLoraPacketLen; i++) {
-        char buf[3];
-        sprintf(buf, "%02X", lastLoraPacketBinary[i]);
-        json += buf;
+    jsonHex(w, "data", &lastLoraPacketBinary[12], lastLoraPacketLen - 12);
+    jsonEndObject(w);
+
+    if (jsonFinish(w) > 0) {
+        forwardToJsonClients(jsonLine);
     }
-    json += "\"}";
+    Serial.println("Forwarded flash_data");
+}
 
+//----------------------------------------------
+// Forward a Line to WiFi Clients
+// Binary clients get it as a text record
+//----------------------------------------------
+void forwardToClients(const char* data) {
     for (int i = 0; i < MAX_CLIENTS; i++) {
         if (clients[i] && clients[i].connected()) {
-            clients[i].println(json);
+            sendToClient(i, data);
         }
     }
-    Serial.println("Forwarded flash_data");
+}
+
+void forwardToClients(const String& data) {
+    forwardToClients(data.c_str());
 }
 
 //----------------------------------------------
-// Forward String to WiFi Clients
+// Forward a Line to JSON Clients Only
+// For lines binary clients get as a record instead
 //----------------------------------------------
-void forwardToClients(const String& data) {
+void forwardToJsonClients(const char* data) {
     for (int i = 0; i < MAX_CLIENTS; i++) {
-        if (clients[i] && clients[i].connected()) {
+        if (clients[i] && clients[i].connected() && !clientBinary[i]) {
             clients[i].println(data);
         }
     }
 }
 
+void forwardToJsonClients(const String& data) {
+    forwardToJsonClients(data.c_str());
+}
+
+//----------------------------------------------
+// Send a Line to One Client, in its Format
+//----------------------------------------------
+void sendToClient(int clientIdx, const char* line) {
+    if (!clientBinary[clientIdx]) {
+        clients[clientIdx].println(line);
+        return;
+    }
+    size_t len = encodeStreamRecord(STREAM_RECORD_TEXT, (const uint8_t*)line, strlen(line));
+    if (len > 0) {
+        clients[clientIdx].write(streamFrame, len);
+    }
+}
+
+void sendToClient(int clientIdx, const String& line) {
+    sendToClient(clientIdx, line.c_str());
+}
+
+//----------------------------------------------
+// Binary Output (layout: gateway_stream.h)
+// A record is type, payload and CRC-8, COBS-encoded
+// so it holds no 0x00, then a 0x00 to end it
+//----------------------------------------------
+size_t encodeStreamRecord(uint8_t type, const uint8_t* payload, size_t len) {
+    if (STREAM_FRAME_SIZE(len) > sizeof(streamFrame)) {
+        return 0;
+    }
+
+    uint8_t crc = crc8Update(crc8Update(0xFF, &type, 1), payload, len);
+
+    // Each block of up to 254 non-zero bytes is led by
+    // its length plus one, which stands for the zero
+    // that ended it
+    size_t codeAt = 0;
+    size_t out = 1;
+    uint8_t code = 1;
+    for (size_t i = 0; i < len + 2; i++) {
+        uint8_t b = i == 0 ? type : (i <= len ? payload[i - 1] : crc);
+        if (b != 0) {
+            streamFrame[out++] = b;
+            code++;
+        }
+        if (b == 0 || code == 0xFF) {
+            streamFrame[codeAt] = code;
+            codeAt = out++;
+            code = 1;
+        }
+    }
+    streamFrame[codeAt] = code;
+    streamFrame[out++] = 0x00;
+    return out;
+}
+
+// Whether any connected client reads binary (or JSON)
+bool anyClient(bool binary) {
+    for (int i = 0; i < MAX_CLIENTS; i++) {
+        if (clients[i] && clients[i].connected() && clientBinary[i] == binary) {
+            return true;
+        }
+    }
+    return false;
+}
+
+void sendRecordToClients(uint8_t type, const uint8_t* payload, size_t len) {
+    if (!anyClient(true)) {
+        return;
+    }
+    size_t frameLen = encodeStreamRecord(type, payload, len);
+    if (frameLen == 0) {
+        return;
+    }
+    for (int i = 0; i < MAX_CLIENTS; i++) {
+        if (clients[i] && clients[i].connected() && clientBinary[i]) {
+            clients[i].write(streamFrame, frameLen);
+        }
+    }
+}
+
+// The received frame with its RSSI and SNR
+void sendFrameToClients() {
+    uint8_t record[3 + sizeof(lastLoraPacketBinary)];
+    int16_t rssi = (int16_t)lastRssi;
+    record[0] = rssi & 0xFF;
+    record[1] = (rssi >> 8) & 0xFF;
+    record[2] = (uint8_t)(int8_t)lastSnr;
+    memcpy(&record[3], lastLoraPacketBinary, lastLoraPacketLen);
+    sendRecordToClients(STREAM_RECORD_FRAME, record, 3 + lastLoraPacketLen);
+}
+
 //----------------------------------------------
 // Handle WiFi Clients
 //----------------------------------------------
@@ -1621,6 +2875,7 @@ void handleWiFiClients() {
         for (int i = 0; i < MAX_CLIENTS; i++) {
             if (!clients[i] || !clients[i].connected()) {
                 clients[i] = newClient;
+                clientBinary[i] = false;
                 Serial.printf("WiFi: Client %d connected from %s\n",
                               i, newClient.remoteIP().toString().c_str());
 
@@ -1715,6 +2970,38 @@ void handleClientCommand(int clientIdx, const String& command) {
         return;
     }
 
+    // Output format for this client: {"cmd":"output","format":"binary"}
+    // The reply comes in the new format
+    if (cmd == "output") {
+        String format = extractJsonString(command, "format");
+        if (format == "binary" && !clientBinary[clientIdx]) {
+            clientBinary[clientIdx] = true;
+            clients[clientIdx].write((uint8_t)0x00);  // Reader in step before the first record
+        } else if (format == "json") {
+            clientBinary[clientIdx] = false;
+        }
+        sendToClient(clientIdx, String("{\"type\":\"output\",\"id\":") + extractJsonInt(command, "id", 0) +
+                     ",\"format\":\"" + (clientBinary[clientIdx] ? "binary" : "json") +
+                     "\",\"version\":" + STREAM_VERSION + "}");
+        return;
+    }
+
+    // ACK summary interval: {"cmd":"ack","interval_ms":1000,"now":true}
+    if (cmd == "ack") {
+        int interval = extractJsonInt(command, "interval_ms", -1);
+        bool ok = interval <= ACK_MAX_INTERVAL_MS &&
+                  (interval <= 0 || interval >= ACK_MIN_INTERVAL_MS);
+        if (ok && interval >= 0) {
+            ackIntervalMs = interval;
+        }
+        if (ok && command.indexOf("\"now\":true") >= 0) {
+            ackRequested = true;
+        }
+        sendToClient(clientIdx, String("{\"type\":\"ack\",\"id\":0,\"ok\":") + (ok ? "true" : "false") + "}");
+        sendAckStats(clientIdx);
+        return;
+    }
+
     if (cmd == "wifi_status") {
         sendWifiStatus(clientIdx);
         return;
@@ -1772,11 +3059,11 @@ void handleClientCommand(int clientIdx, const String& command) {
                     delay(1);
                 }
                 response += "]}";
-                clients[clientIdx].println(response);
+                sendToClient(clientIdx, response);
                 return;
             }
         }
-        clients[clientIdx].println("{\"type\":\"error\",\"msg\":\"Invalid gps_cmd format\"}");
+        sendToClient(clientIdx, "{\"type\":\"error\",\"msg\":\"Invalid gps_cmd format\"}");
         return;
     }
 
@@ -1819,7 +3106,7 @@ void handleClientCommand(int clientIdx, const String& command) {
     if (targetRocket < 0 || targetRocket >= MAX_ROCKETS) {
         Serial.printf("Command '%s' rejected: missing or invalid rocket ID\n", cmd.c_str());
         String err = "{\"type\":\"error\",\"code\":\"NO_ROCKET_ID\",\"message\":\"rocket ID required for " + cmd + "\"}";
-        clients[clientIdx].println(err);
+        sendToClient(clientIdx, err);
         return;
     }
     uint8_t loraPacket[32];
@@ -1852,6 +3139,29 @@ void handleClientCommand(int clientIdx, const String& command) {
         loraPacket[4] = enabled ? 1 : 0;
         packetLen = 5;
     }
+    else if (cmd == "compact_telemetry") {
+        loraPacket[3] = 0x0B;  // kCmdTelemetryFormat
+        bool enabled = command.indexOf("\"enabled\":true") >= 0;
+        loraPacket[4] = enabled ? 1 : 0;  // kTelemetryFormatCompact / Full
+        packetLen = 5;
+    }
+    else if (cmd == "telemetry_batch") {
+        loraPacket[3] = 0x0C;  // kCmdTelemetryBatch
+        bool enabled = command.indexOf("\"enabled\":true") >= 0;
+        loraPacket[4] = enabled ? 1 : 0;
+        packetLen = 5;
+    }
+    else if (cmd == "telemetry_profile") {
+        loraPacket[3] = 0x30;  // kCmdTelemetryProfile
+        // {"cmd":"telemetry_profile","rocket":0,"profile":3,"interval_ms":500}
+        // or "defaults":true (profile 0xFF)
+        bool defaults = command.indexOf("\"defaults\":true") >= 0;
+        int interval = defaults ? 0 : extractJsonInt(command, "interval_ms", 0);
+        loraPacket[4] = defaults ? 0xFF : (uint8_t)extractJsonInt(command, "profile", 0xFF);
+        loraPacket[5] = interval & 0xFF;
+        loraPacket[6] = (interval >> 8) & 0xFF;
+        packetLen = 7;
+    }
     else if (cmd == "set_rocket_name") {
         loraPacket[3] = 0x09;  // kCmdSetRocketName
         // Extract name parameter from JSON: {"cmd":"set_rocket_name","rocket":0,"name":"My Rocket"}
@@ -1931,7 +3241,7 @@ void handleClientCommand(int clientIdx, const String& command) {
         Serial.printf("Unknown command: %s\n", cmd.c_str());
         // Send error response
         String err = "{\"type\":\"error\",\"code\":\"UNKNOWN_CMD\",\"message\":\"Unknown command: " + cmd + "\"}";
-        clients[clientIdx].println(err);
+        sendToClient(clientIdx, err);
         return;
     }
 
@@ -1940,6 +3250,7 @@ void handleClientCommand(int clientIdx, const String& command) {
     if (packetLen > 0) {
         bool sent = false;
         for (int attempt = 0; attempt < 3; attempt++) {
+            listenBeforeTalk();
             int state = radio.transmit(loraPacket, packetLen);
             if (state == RADIOLIB_ERR_NONE) {
                 loraTxCount++;
@@ -1958,7 +3269,7 @@ void handleClientCommand(int clientIdx, const String& command) {
         }
         if (!sent) {
             String err = "{\"type\":\"error\",\"code\":\"LORA_TX_FAIL\",\"message\":\"LoRa transmit failed after 3 attempts\"}";
-            clients[clientIdx].println(err);
+            sendToClient(clientIdx, err);
         }
 
         // Restart receiving after transmit
@@ -2128,7 +3439,7 @@ void sendWifiStatus(int clientIdx) {
     }
 
     response += "}";
-    clients[clientIdx].println(response);
+    sendToClient(clientIdx, response);
     Serial.println("Sent wifi_status");
 }
 
@@ -2149,7 +3460,7 @@ void sendWifiList(int clientIdx) {
     }
 
     response += "]}";
-    clients[clientIdx].println(response);
+    sendToClient(clientIdx, response);
     Serial.println("Sent wifi_list");
 }
 
@@ -2158,7 +3469,7 @@ void sendWifiList(int clientIdx) {
 //----------------------------------------------
 void handleWifiAdd(int clientIdx, const String& command) {
     if (storedNetworkCount >= MAX_WIFI_NETWORKS) {
-        clients[clientIdx].println("{\"type\":\"ack\",\"ok\":false,\"error\":\"Max networks reached\"}");
+        sendToClient(clientIdx, "{\"type\":\"ack\",\"ok\":false,\"error\":\"Max networks reached\"}");
         return;
     }
 
@@ -2167,7 +3478,7 @@ void handleWifiAdd(int clientIdx, const String& command) {
     int priority = extractJsonInt(command, "priority", 100);
 
     if (ssid.length() == 0) {
-        clients[clientIdx].println("{\"type\":\"ack\",\"ok\":false,\"error\":\"SSID required\"}");
+        sendToClient(clientIdx, "{\"type\":\"ack\",\"ok\":false,\"error\":\"SSID required\"}");
         return;
     }
 
@@ -2185,7 +3496,7 @@ void handleWifiAdd(int clientIdx, const String& command) {
     sortNetworksByPriority();
 
     Serial.printf("Added WiFi network: %s (priority %d)\n", ssid.c_str(), priority);
-    clients[clientIdx].println("{\"type\":\"ack\",\"ok\":true}");
+    sendToClient(clientIdx, "{\"type\":\"ack\",\"ok\":true}");
 }
 
 //----------------------------------------------
@@ -2195,7 +3506,7 @@ void handleWifiRemove(int clientIdx, const String& command) {
     int index = extractJsonInt(command, "index", -1);
 
     if (index < 0 || index >= storedNetworkCount) {
-        clients[clientIdx].println("{\"type\":\"ack\",\"ok\":false,\"error\":\"Invalid index\"}");
+        sendToClient(clientIdx, "{\"type\":\"ack\",\"ok\":false,\"error\":\"Invalid index\"}");
         return;
     }
 
@@ -2207,7 +3518,7 @@ void handleWifiRemove(int clientIdx, const String& command) {
     }
     storedNetworkCount--;
 
-    clients[clientIdx].println("{\"type\":\"ack\",\"ok\":true}");
+    sendToClient(clientIdx, "{\"type\":\"ack\",\"ok\":true}");
 }
 
 //----------------------------------------------
@@ -2215,7 +3526,7 @@ void handleWifiRemove(int clientIdx, const String& command) {
 //----------------------------------------------
 void handleWifiSave(int clientIdx) {
     saveWifiNetworks();
-    clients[clientIdx].println("{\"type\":\"ack\",\"ok\":true,\"message\":\"Saved to flash\"}");
+    sendToClient(clientIdx, "{\"type\":\"ack\",\"ok\":true,\"message\":\"Saved to flash\"}");
 }
 
 //----------------------------------------------
@@ -2225,7 +3536,7 @@ void handleWifiScan(int clientIdx) {
     Serial.println("Scanning WiFi networks...");
 
     // Send immediate ack that scan is starting
-    clients[clientIdx].println("{\"type\":\"wifi_scan_start\"}");
+    sendToClient(clientIdx, "{\"type\":\"wifi_scan_start\"}");
 
     // Perform scan (this blocks for a few seconds)
     int numNetworks = WiFi.scanNetworks(false, false, false, 300);  // active scan, 300ms per channel
@@ -2296,7 +3607,7 @@ void handleWifiScan(int clientIdx) {
     // Clean up scan results
     WiFi.scanDelete();
 
-    clients[clientIdx].println(response);
+    sendToClient(clientIdx, response);
     Serial.printf("Scan complete: %d networks found (%d unique)\n", numNetworks, uniqueCount);
 }
 
@@ -2304,7 +3615,7 @@ void handleWifiScan(int clientIdx) {
 // Handle WiFi Connect Command (try to connect now)
 //----------------------------------------------
 void handleWifiConnect(int clientIdx) {
-    clients[clientIdx].println("{\"type\":\"ack\",\"ok\":true,\"message\":\"Reconnecting...\"}");
+    sendToClient(clientIdx, "{\"type\":\"ack\",\"ok\":true,\"message\":\"Reconnecting...\"}");
 
     // Disconnect and reconnect
     WiFi.disconnect();
@@ -2355,11 +3666,17 @@ void sendGatewayStatus(int clientIdx) {
     response += ",\"tx\":" + String(loraTxCount);
     response += ",\"rssi\":" + String((int)lastRssi);
     response += ",\"snr\":" + String((int)lastSnr);
+    response += ",\"crc_errors\":" + String(crcErrors);
+    response += ",\"lbt\":" + String(LBT_ENABLED ? "true" : "false");
+    response += ",\"cad_checks\":" + String(lbtChecks);
+    response += ",\"lbt_deferrals\":" + String(lbtDeferrals);
+    response += ",\"lbt_forced\":" + String(lbtForced);
+    response += ",\"lbt_hold_max_ms\":" + String(lbtHoldMaxMs);
     response += ",\"clients\":" + String(clientCount);
     response += ",\"uptime\":" + String(millis() / 1000);
     response += "}";
 
-    clients[clientIdx].println(response);
+    sendToClient(clientIdx, response);
     Serial.println("Sent gateway status");
 }
 
@@ -2368,7 +3685,7 @@ void sendGatewayStatus(int clientIdx) {
 //----------------------------------------------
 void sendPingResponse(int clientIdx) {
     String response = "{\"type\":\"ack\",\"id\":0,\"ok\":true}";
-    clients[clientIdx].println(response);
+    sendToClient(clientIdx, response);
     Serial.println("Sent ping response");
 }
 
@@ -2387,7 +3704,7 @@ void sendGatewaySettings(int clientIdx) {
     response += ",\"wifi_tx_power_max\":20";
     response += "}";
 
-    clients[clientIdx].println(response);
+    sendToClient(clientIdx, response);
     Serial.println("Sent gateway settings");
 }
 
@@ -2452,7 +3769,7 @@ void applyGatewaySettings(int clientIdx, const String& command) {
     } else {
         response = "{\"type\":\"ack\",\"ok\":false,\"error\":\"No valid settings provided\"}";
     }
-    clients[clientIdx].println(response);
+    sendToClient(clientIdx, response);
 }
 
 //----------------------------------------------
@@ -2486,7 +3803,7 @@ void sendRocketList(int clientIdx) {
     }
 
     response += "]}";
-    clients[clientIdx].println(response);
+    sendToClient(clientIdx, response);
     Serial.println("Sent rocket list");
 }
 
@@ -2535,10 +3852,10 @@ void sendGpsDebug(int clientIdx) {
     }
 
     response += "}";
-    clients[clientIdx].println(response);
+    sendToClient(clientIdx, response);
 
     // Now capture raw NMEA for 2 seconds
-    clients[clientIdx].println("{\"type\":\"nmea_capture\",\"duration_ms\":2000}");
+    sendToClient(clientIdx, "{\"type\":\"nmea_capture\",\"duration_ms\":2000}");
 
     char nmeaBuffer[128];
     uint8_t nmeaIdx = 0;
@@ -2564,7 +3881,7 @@ void sendGpsDebug(int clientIdx) {
 
                 // Send the sentence
                 String nmea = "{\"type\":\"nmea\",\"data\":\"" + String(nmeaBuffer) + "\"}";
-                clients[clientIdx].println(nmea);
+                sendToClient(clientIdx, nmea);
                 sentenceCount++;
                 nmeaIdx = 0;
             }
@@ -2572,7 +3889,7 @@ void sendGpsDebug(int clientIdx) {
         delay(1);
     }
 
-    clients[clientIdx].println("{\"type\":\"nmea_capture_end\",\"count\":" + String(sentenceCount) + "}");
+    sendToClient(clientIdx, "{\"type\":\"nmea_capture_end\",\"count\":" + String(sentenceCount) + "}");
     Serial.printf("GPS debug sent: %d NMEA sentences\n", sentenceCount);
 }
 
@@ -2628,7 +3945,7 @@ void sendGatewayInfo(int clientIdx) {
 
     response += "}";
 
-    clients[clientIdx].println(response);
+    sendToClient(clientIdx, response);
     Serial.println("Sent gateway info");
 }
 
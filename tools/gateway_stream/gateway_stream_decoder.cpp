@@ -0,0 +1,151 @@
+//----------------------------------------------
+// Module: gateway_stream_decoder.cpp
+// Description: Host decoder for the gateways'
+//   binary output stream
+// Author: Mark Gavin
+// Created: 2026-02-15
+// Copyright: (c) 2025-2026 by Mark Gavin
+// License: Proprietary - All Rights Reserved
+//----------------------------------------------
+
+#include "gateway_stream_decoder.h"
+
+#include <cstring>
+
+//----------------------------------------------
+// Function: GatewayStreamDecoder::Feed
+//----------------------------------------------
+void GatewayStreamDecoder::Feed(const uint8_t * inData, size_t inLen)
+{
+  for (size_t i = 0 ; i < inLen ; i++)
+  {
+    uint8_t theByte = inData[i] ;
+
+    if (theByte == kStreamDelimiter)
+    {
+      if (pInStep && !pOverflow && !pFrame.empty())
+      {
+        Dispatch() ;
+      }
+      else if (pInStep && pOverflow)
+      {
+        pBadFrames++ ;
+      }
+      pInStep = true ;
+      pOverflow = false ;
+      pFrame.clear() ;
+      continue ;
+    }
+
+    // Still in JSON: pass whole lines on
+    if (!pInStep && theByte == '\n')
+    {
+      if (pOnText)
+      {
+        size_t theLen = pFrame.size() ;
+        if (theLen > 0 && pFrame[theLen - 1] == '\r')
+        {
+          theLen-- ;
+        }
+        pOnText(std::string(pFrame.begin(), pFrame.begin() + theLen)) ;
+      }
+      pFrame.clear() ;
+      continue ;
+    }
+
+    if (pFrame.size() >= kStreamDecoderMaxFrame)
+    {
+      pOverflow = true ;
+      continue ;
+    }
+    pFrame.push_back(theByte) ;
+  }
+}
+
+//----------------------------------------------
+// Function: GatewayStreamDecoder::Reset
+//----------------------------------------------
+void GatewayStreamDecoder::Reset(void)
+{
+  pFrame.clear() ;
+  pInStep = false ;
+  pOverflow = false ;
+}
+
+//----------------------------------------------
+// Function: GatewayStreamDecoder::Dispatch
+// Purpose: Decode the frame in pFrame, in place,
+//   and hand the record to its callback
+//----------------------------------------------
+void GatewayStreamDecoder::Dispatch(void)
+{
+  uint8_t theType = 0 ;
+  size_t theLen = 0 ;
+  if (!GatewayStream_Decode(pFrame.data(), pFrame.size(), &theType,
+                            pFrame.data(), pFrame.size(), &theLen))
+  {
+    pBadFrames++ ;
+    return ;
+  }
+
+  Record(theType, pFrame.data(), theLen) ;
+}
+
+//----------------------------------------------
+// Function: GatewayStreamDecoder::Record
+// Purpose: Check a decoded record's length and
+//   call back
+//----------------------------------------------
+void GatewayStreamDecoder::Record(uint8_t inType, const uint8_t * inPayload, size_t inLen)
+{
+  switch (inType)
+  {
+    case kStreamRecordTelemetry:
+      if (inLen != kStreamTelemetryLen)
+      {
+        pBadFrames++ ;
+        return ;
+      }
+      if (pOnTelemetry)
+      {
+        StreamTelemetryRecord theRecord ;
+        memcpy(&theRecord, inPayload, sizeof(theRecord)) ;
+        pOnTelemetry(theRecord) ;
+      }
+      break ;
+
+    case kStreamRecordFrame:
+      if (inLen < kStreamFrameHeaderLen)
+      {
+        pBadFrames++ ;
+        return ;
+      }
+      if (pOnFrame)
+      {
+        pOnFrame(LoRaProtocol_GetI16(inPayload, 0), (int8_t)inPayload[2],
+                 inPayload + kStreamFrameHeaderLen, inLen - kStreamFrameHeaderLen) ;
+      }
+      break ;
+
+    case kStreamRecordFlashData:
+      if (pOnFlashData)
+      {
+        pOnFlashData(inPayload, inLen) ;
+      }
+      break ;
+
+    case kStreamRecordText:
+      if (pOnText)
+      {
+        pOnText(std::string((const char *)inPayload, inLen)) ;
+      }
+      break ;
+
+    default:
+      // A newer gateway's record: skipped, not an error
+      pUnknownRecords++ ;
+      return ;
+  }
+
+  pRecords++ ;
+}
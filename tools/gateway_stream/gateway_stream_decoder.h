@@ -0,0 +1,89 @@
+//----------------------------------------------
+// Module: gateway_stream_decoder.h
+// Description: Host decoder for the gateways'
+//   binary output stream
+// Author: Mark Gavin
+// Created: 2026-02-15
+// Copyright: (c) 2025-2026 by Mark Gavin
+// License: Proprietary - All Rights Reserved
+//
+// Feed it bytes as they come off USB or TCP, in
+// pieces of any size; it calls back once per
+// record. Record layouts and framing are in
+// firmware_common/include/gateway_stream.h and
+// docs/PROTOCOL.md ("Binary Output").
+//
+// Until the first 0x00 the client is still
+// reading JSON lines (the switch to binary may
+// land mid-line); whole lines before it go to the
+// text callback, the partial one is dropped.
+//
+// Records are read through the packed structs,
+// which assumes a little-endian host.
+//
+// Usage:
+//   GatewayStreamDecoder theDecoder ;
+//   theDecoder.pOnTelemetry = [](const StreamTelemetryRecord & inRecord) { ... } ;
+//   theDecoder.Feed(theBytes, theCount) ;
+//----------------------------------------------
+
+#pragma once
+
+#include "gateway_stream.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <vector>
+
+//----------------------------------------------
+// Constants
+//----------------------------------------------
+#define kStreamDecoderMaxFrame  8192    // Longer frames are dropped as errors
+
+//----------------------------------------------
+// Class: GatewayStreamDecoder
+//----------------------------------------------
+class GatewayStreamDecoder
+{
+public:
+  // Callbacks; any left empty skips its records
+  std::function<void(const StreamTelemetryRecord & inRecord)> pOnTelemetry ;
+  std::function<void(int16_t inRssi, int8_t inSnr, const uint8_t * inFrame, size_t inLen)> pOnFrame ;
+  std::function<void(const uint8_t * inPacket, size_t inLen)> pOnFlashData ;
+  std::function<void(const std::string & inLine)> pOnText ;
+
+  //----------------------------------------------
+  // Function: Feed
+  // Purpose: Take the next bytes of the stream
+  // Parameters:
+  //   inData - Bytes as received
+  //   inLen - Their number
+  //----------------------------------------------
+  void Feed(const uint8_t * inData, size_t inLen) ;
+
+  //----------------------------------------------
+  // Function: Reset
+  // Purpose: Forget partial input and go back to
+  //   waiting for the first delimiter (after a
+  //   reconnect, or a switch back to JSON)
+  //----------------------------------------------
+  void Reset(void) ;
+
+  // Statistics
+  uint32_t GetRecords(void) const { return pRecords ; }
+  uint32_t GetBadFrames(void) const { return pBadFrames ; }
+  uint32_t GetUnknownRecords(void) const { return pUnknownRecords ; }
+
+private:
+  void Dispatch(void) ;
+  void Record(uint8_t inType, const uint8_t * inPayload, size_t inLen) ;
+
+  std::vector<uint8_t> pFrame ;       // Bytes since the last delimiter
+  bool pInStep = false ;              // A delimiter has been seen
+  bool pOverflow = false ;            // Current frame is too long; drop it
+  uint32_t pRecords = 0 ;
+  uint32_t pBadFrames = 0 ;           // COBS, CRC or length errors
+  uint32_t pUnknownRecords = 0 ;      // Well formed, type not known here
+} ;
@@ -0,0 +1,8 @@
+//----------------------------------------------
+// Host shim: hardware/spi.h (pins.h only)
+//----------------------------------------------
+#pragma once
+
+typedef struct spi_inst spi_inst_t ;
+extern spi_inst_t * spi0 ;
+extern spi_inst_t * spi1 ;
@@ -0,0 +1,361 @@
+//----------------------------------------------
+// Module: stream_bench.cpp
+// Description: Host round-trip check and
+//   benchmark of the gateway binary output
+//   against the telemetry JSON it replaces
+// Author: Mark Gavin
+// Created: 2026-02-15
+// Copyright: (c) 2025-2026 by Mark Gavin
+// License: Proprietary - All Rights Reserved
+//
+// Build and run (from the repository root):
+//   c++ -O2 -Itools/gateway_stream/shim -Ifirmware_common/include -Ifirmware_gateway/include -x c firmware_common/src/lora_protocol.c -x c firmware_common/src/gateway_stream.c -x c firmware_gateway/src/gateway_protocol.c -x c firmware_gateway/src/json_writer.c -x c++ tools/gateway_stream/gateway_stream_decoder.cpp tools/gateway_stream/stream_bench.cpp -o /tmp/stream_bench
+//   /tmp/stream_bench [packets]
+//
+// The real gateway_stream.c and gateway_protocol.c
+// are compiled in unchanged (the shims only give
+// pins.h its SPI and I2C types). Checks:
+//   - a stream of mixed records, joined mid-line
+//     after JSON output and fed in random pieces,
+//     comes out of the decoder record for record
+//   - a frame with a flipped bit is counted bad
+//     and the decoder is in step at the next one
+// Then times, per telemetry packet, the JSON line
+// (GatewayProtocol_TelemetryToJson) against the
+// binary record (fill and GatewayStream_Encode),
+// with the bytes each puts on the link, and the
+// host decoder's rate.
+//
+// Exits non-zero if a check fails. Figures are
+// host figures: compare them with each other,
+// not with the RP2040.
+//----------------------------------------------
+
+#include "gateway_stream_decoder.h"
+
+extern "C"
+{
+#include "gateway_protocol.h"
+#include "pins.h"
+}
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <string>
+#include <vector>
+
+//----------------------------------------------
+// Bench Constants
+//----------------------------------------------
+#define kBenchPackets           100000
+#define kBenchPool              1024        // Distinct packets cycled through
+#define kBenchRecords           20000       // Records in the round-trip stream
+#define kBenchGroundPa          101325.0f
+#define kBenchGatewayLat        35.347200f
+#define kBenchGatewayLon        -117.808100f
+
+static uint32_t sSeed = 0x2545F491 ;
+static uint32_t sFailures = 0 ;
+static volatile uint32_t sSink = 0 ;        // Keeps timed loops from folding away
+
+//----------------------------------------------
+// Internal: NextRandom (xorshift32)
+//----------------------------------------------
+static uint32_t NextRandom(void)
+{
+  sSeed ^= sSeed << 13 ;
+  sSeed ^= sSeed >> 17 ;
+  sSeed ^= sSeed << 5 ;
+  return sSeed ;
+}
+
+//----------------------------------------------
+// Internal: RandomRange
+//----------------------------------------------
+static int32_t RandomRange(int32_t inLow, int32_t inHigh)
+{
+  return inLow + (int32_t)(NextRandom() % (uint32_t)(inHigh - inLow + 1)) ;
+}
+
+//----------------------------------------------
+// Internal: NowNs
+//----------------------------------------------
+static uint64_t NowNs(void)
+{
+  struct timespec theNow ;
+  clock_gettime(CLOCK_MONOTONIC, &theNow) ;
+  return (uint64_t)theNow.tv_sec * 1000000000ULL + (uint64_t)theNow.tv_nsec ;
+}
+
+//----------------------------------------------
+// Internal: Check
+//----------------------------------------------
+static void Check(bool inOk, const char * inWhat, uint32_t inIndex)
+{
+  if (!inOk)
+  {
+    if (sFailures < 10)
+    {
+      printf("  FAIL: %s (record %u)\n", inWhat, inIndex) ;
+    }
+    sFailures++ ;
+  }
+}
+
+//----------------------------------------------
+// Internal: RandomPacket
+// A telemetry packet with values in flight ranges,
+// so the JSON is as long as it is in use
+//----------------------------------------------
+static void RandomPacket(LoRaTelemetryPacket * outPacket)
+{
+  outPacket->pMagic = kLoRaMagic ;
+  outPacket->pPacketType = kLoRaPacketTelemetry ;
+  outPacket->pRocketId = (uint8_t)RandomRange(0, 15) ;
+  outPacket->pSequence = (uint16_t)NextRandom() ;
+  outPacket->pTimeMs = (uint32_t)RandomRange(0, 600000) ;
+  outPacket->pAltitudeCm = RandomRange(-500, 300000) ;
+  outPacket->pVelocityCmps = (int16_t)RandomRange(-8000, 30000) ;
+  outPacket->pPressurePa = (uint32_t)RandomRange(70000, 101325) ;
+  outPacket->pTemperatureC10 = (int16_t)RandomRange(-100, 400) ;
+  outPacket->pGpsLatitude = RandomRange(35300000, 35400000) ;
+  outPacket->pGpsLongitude = RandomRange(-117850000, -117750000) ;
+  outPacket->pGpsSpeedCmps = (int16_t)RandomRange(0, 30000) ;
+  outPacket->pGpsHeadingDeg10 = (uint16_t)RandomRange(0, 3599) ;
+  outPacket->pGpsSatellites = (uint8_t)RandomRange(0, 14) ;
+  outPacket->pAccelX = (int16_t)RandomRange(-16000, 16000) ;
+  outPacket->pAccelY = (int16_t)RandomRange(-16000, 16000) ;
+  outPacket->pAccelZ = (int16_t)RandomRange(-16000, 16000) ;
+  outPacket->pGyroX = (int16_t)RandomRange(-20000, 20000) ;
+  outPacket->pGyroY = (int16_t)RandomRange(-20000, 20000) ;
+  outPacket->pGyroZ = (int16_t)RandomRange(-20000, 20000) ;
+  outPacket->pMagX = (int16_t)RandomRange(-600, 600) ;
+  outPacket->pMagY = (int16_t)RandomRange(-600, 600) ;
+  outPacket->pMagZ = (int16_t)RandomRange(-600, 600) ;
+  outPacket->pState = (uint8_t)RandomRange(0, 7) ;
+  outPacket->pFlags = (uint8_t)NextRandom() ;
+  outPacket->pCrc = LoRaProtocol_Crc8((const uint8_t *)outPacket, kLoRaTelemetryLen - 1) ;
+}
+
+//----------------------------------------------
+// Internal: FillRecord
+// As the gateway does before encoding
+//----------------------------------------------
+static void FillRecord(const LoRaTelemetryPacket * inPacket, StreamTelemetryRecord * outRecord)
+{
+  memcpy(&outRecord->pPacket, inPacket, sizeof(LoRaTelemetryPacket)) ;
+  outRecord->pRssi = -87 ;
+  outRecord->pSnr = 9 ;
+  outRecord->pGroundPressurePa = (uint32_t)(kBenchGroundPa + 0.5f) ;
+  outRecord->pGatewayFlags = kStreamGatewayGpsValid ;
+  outRecord->pGatewayLatitude = (int32_t)(kBenchGatewayLat * 1000000.0f) ;
+  outRecord->pGatewayLongitude = (int32_t)(kBenchGatewayLon * 1000000.0f) ;
+}
+
+//----------------------------------------------
+// Internal: Append
+//----------------------------------------------
+static void Append(std::vector<uint8_t> & ioStream, uint8_t inType,
+                   const uint8_t * inPayload, size_t inLen)
+{
+  uint8_t theFrame[GATEWAY_STREAM_FRAME_SIZE(kStreamDecoderMaxFrame)] ;
+  size_t theLen = GatewayStream_Encode(inType, inPayload, inLen, theFrame, sizeof(theFrame)) ;
+  ioStream.insert(ioStream.end(), theFrame, theFrame + theLen) ;
+}
+
+//----------------------------------------------
+// Internal: CheckRoundTrip
+//----------------------------------------------
+static void CheckRoundTrip(void)
+{
+  struct Expected
+  {
+    uint8_t pType ;
+    std::vector<uint8_t> pPayload ;
+  } ;
+  std::vector<Expected> theExpected ;
+  std::vector<uint8_t> theStream ;
+
+  // JSON output before the switch, cut mid-line
+  const char * theJson = "{\"type\":\"tel\",\"id\":1}\r\n{\"type\":\"ack\",\"id\":4,\"ok\":true}\n{\"type\":\"te" ;
+  theStream.insert(theStream.end(), theJson, theJson + strlen(theJson)) ;
+  theStream.push_back(kStreamDelimiter) ;
+
+  for (uint32_t n = 0 ; n < kBenchRecords ; n++)
+  {
+    Expected theRecord ;
+    theRecord.pType = (uint8_t)RandomRange(kStreamRecordTelemetry, kStreamRecordText) ;
+    if (theRecord.pType == kStreamRecordTelemetry)
+    {
+      LoRaTelemetryPacket thePacket ;
+      StreamTelemetryRecord theTelemetry ;
+      RandomPacket(&thePacket) ;
+      FillRecord(&thePacket, &theTelemetry) ;
+      const uint8_t * theBytes = (const uint8_t *)&theTelemetry ;
+      theRecord.pPayload.assign(theBytes, theBytes + sizeof(theTelemetry)) ;
+    }
+    else if (theRecord.pType == kStreamRecordText)
+    {
+      char theLine[64] ;
+      int theLen = snprintf(theLine, sizeof(theLine), "{\"type\":\"ack\",\"id\":%u,\"ok\":true}", n) ;
+      theRecord.pPayload.assign(theLine, theLine + theLen) ;
+    }
+    else
+    {
+      // Frames and flash data: any bytes, zeros
+      // included, up to a bulk chunk and past 254
+      size_t theLen = (size_t)RandomRange(kStreamFrameHeaderLen, 300) ;
+      for (size_t i = 0 ; i < theLen ; i++)
+      {
+        theRecord.pPayload.push_back((NextRandom() & 3) == 0 ? 0 : (uint8_t)NextRandom()) ;
+      }
+    }
+    Append(theStream, theRecord.pType, theRecord.pPayload.data(), theRecord.pPayload.size()) ;
+    theExpected.push_back(theRecord) ;
+  }
+
+  // One damaged frame between two good ones
+  size_t theDamagedAt = theStream.size() ;
+  uint8_t theText[] = "damaged" ;
+  Append(theStream, kStreamRecordText, theText, sizeof(theText) - 1) ;
+  theStream[theDamagedAt + 3] ^= 0x10 ;
+  Expected theLast ;
+  theLast.pType = kStreamRecordText ;
+  theLast.pPayload.assign(theText, theText + 4) ;
+  Append(theStream, theLast.pType, theLast.pPayload.data(), theLast.pPayload.size()) ;
+  theExpected.push_back(theLast) ;
+
+  // Collect what comes out
+  std::vector<std::string> theLines ;
+  std::vector<Expected> theGot ;
+  GatewayStreamDecoder theDecoder ;
+  theDecoder.pOnTelemetry = [&](const StreamTelemetryRecord & inRecord)
+  {
+    const uint8_t * theBytes = (const uint8_t *)&inRecord ;
+    theGot.push_back({ kStreamRecordTelemetry, std::vector<uint8_t>(theBytes, theBytes + sizeof(inRecord)) }) ;
+  } ;
+  theDecoder.pOnFrame = [&](int16_t inRssi, int8_t inSnr, const uint8_t * inFrame, size_t inLen)
+  {
+    std::vector<uint8_t> thePayload = { (uint8_t)(inRssi & 0xFF), (uint8_t)((inRssi >> 8) & 0xFF), (uint8_t)inSnr } ;
+    thePayload.insert(thePayload.end(), inFrame, inFrame + inLen) ;
+    theGot.push_back({ kStreamRecordFrame, thePayload }) ;
+  } ;
+  theDecoder.pOnFlashData = [&](const uint8_t * inPacket, size_t inLen)
+  {
+    theGot.push_back({ kStreamRecordFlashData, std::vector<uint8_t>(inPacket, inPacket + inLen) }) ;
+  } ;
+  theDecoder.pOnText = [&](const std::string & inLine)
+  {
+    if (theDecoder.GetRecords() == 0 && theGot.empty() && theLines.size() < 2)
+    {
+      theLines.push_back(inLine) ;
+      return ;
+    }
+    theGot.push_back({ kStreamRecordText, std::vector<uint8_t>(inLine.begin(), inLine.end()) }) ;
+  } ;
+
+  size_t theOffset = 0 ;
+  while (theOffset < theStream.size())
+  {
+    size_t theChunk = (size_t)RandomRange(1, 64) ;
+    if (theChunk > theStream.size() - theOffset)
+    {
+      theChunk = theStream.size() - theOffset ;
+    }
+    theDecoder.Feed(&theStream[theOffset], theChunk) ;
+    theOffset += theChunk ;
+  }
+
+  Check(theLines.size() == 2 && theLines[0] == "{\"type\":\"tel\",\"id\":1}" &&
+        theLines[1] == "{\"type\":\"ack\",\"id\":4,\"ok\":true}", "JSON lines before the switch", 0) ;
+  Check(theGot.size() == theExpected.size(), "record count", (uint32_t)theGot.size()) ;
+  for (size_t i = 0 ; i < theGot.size() && i < theExpected.size() ; i++)
+  {
+    Check(theGot[i].pType == theExpected[i].pType && theGot[i].pPayload == theExpected[i].pPayload,
+          "record round trip", (uint32_t)i) ;
+  }
+  Check(theDecoder.GetBadFrames() == 1, "damaged frame counted", 0) ;
+
+  printf("  %u records, %zu bytes, fed in 1-64 byte pieces\n", kBenchRecords + 1, theStream.size()) ;
+}
+
+//----------------------------------------------
+// Internal: BenchTelemetry
+//----------------------------------------------
+static void BenchTelemetry(uint32_t inPackets)
+{
+  static LoRaTelemetryPacket sPool[kBenchPool] ;
+  for (uint32_t i = 0 ; i < kBenchPool ; i++)
+  {
+    RandomPacket(&sPool[i]) ;
+  }
+
+  // JSON line, as the gateway builds it
+  char theJson[kJsonBufferSize] ;
+  uint64_t theJsonBytes = 0 ;
+  uint64_t theStart = NowNs() ;
+  for (uint32_t n = 0 ; n < inPackets ; n++)
+  {
+    int theLen = GatewayProtocol_TelemetryToJson(&sPool[n % kBenchPool], -87, 9, kBenchGroundPa,
+      true, kBenchGatewayLat, kBenchGatewayLon, theJson, sizeof(theJson)) ;
+    theJsonBytes += (uint64_t)theLen ;
+    sSink += (uint8_t)theJson[theLen / 2] ;
+  }
+  uint64_t theJsonNs = NowNs() - theStart ;
+
+  // Binary record into one stream for the decoder
+  std::vector<uint8_t> theStream ;
+  theStream.reserve((size_t)inPackets * GATEWAY_STREAM_FRAME_SIZE(kStreamTelemetryLen)) ;
+  uint8_t theFrame[GATEWAY_STREAM_FRAME_SIZE(kStreamTelemetryLen)] ;
+  theStart = NowNs() ;
+  for (uint32_t n = 0 ; n < inPackets ; n++)
+  {
+    StreamTelemetryRecord theRecord ;
+    FillRecord(&sPool[n % kBenchPool], &theRecord) ;
+    size_t theLen = GatewayStream_Encode(kStreamRecordTelemetry, (const uint8_t *)&theRecord,
+                                         sizeof(theRecord), theFrame, sizeof(theFrame)) ;
+    theStream.insert(theStream.end(), theFrame, theFrame + theLen) ;
+  }
+  uint64_t theBinaryNs = NowNs() - theStart ;
+
+  // Host side
+  GatewayStreamDecoder theDecoder ;
+  uint32_t theDecoded = 0 ;
+  theDecoder.pOnTelemetry = [&](const StreamTelemetryRecord & inRecord)
+  {
+    theDecoded++ ;
+    sSink += (uint32_t)inRecord.pPacket.pAltitudeCm ;
+  } ;
+  uint8_t theSync = kStreamDelimiter ;
+  theDecoder.Feed(&theSync, 1) ;
+  theStart = NowNs() ;
+  theDecoder.Feed(theStream.data(), theStream.size()) ;
+  uint64_t theDecodeNs = NowNs() - theStart ;
+  Check(theDecoded == inPackets, "telemetry decoded", theDecoded) ;
+
+  printf("  %-28s %8.2f us/pkt  %6.1f bytes/pkt\n", "JSON (TelemetryToJson)",
+    theJsonNs / 1000.0 / inPackets, (double)theJsonBytes / inPackets) ;
+  printf("  %-28s %8.2f us/pkt  %6.1f bytes/pkt  (%.1fx CPU, %.1fx bytes)\n", "binary record",
+    theBinaryNs / 1000.0 / inPackets, (double)theStream.size() / inPackets,
+    (double)theJsonNs / theBinaryNs, (double)theJsonBytes / theStream.size()) ;
+  printf("  %-28s %8.2f Mpkt/s\n", "host decoder", inPackets * 1000.0 / theDecodeNs) ;
+}
+
+int main(int argc, char ** argv)
+{
+  uint32_t thePackets = kBenchPackets ;
+  if (argc > 1)
+  {
+    thePackets = (uint32_t)strtoul(argv[1], NULL, 0) ;
+  }
+
+  printf("Gateway stream: telemetry record %u bytes, %u packets\n", kStreamTelemetryLen, thePackets) ;
+
+  CheckRoundTrip() ;
+  BenchTelemetry(thePackets) ;
+  printf("Checks: %s (%u failures)\n", sFailures == 0 ? "pass" : "FAIL", sFailures) ;
+
+  return sFailures == 0 ? 0 : 1 ;
+}
@@ -0,0 +1,500 @@
+//----------------------------------------------
+// Module: json_bench.c
+// Description: Host check and benchmark of the
+//   gateway JSON builders on the JSON writer
+//   (firmware_gateway/json_writer.c)
+// Author: Mark Gavin
+// Created: 2026-02-16
+// Copyright: (c) 2025-2026 by Mark Gavin
+// License: Proprietary - All Rights Reserved
+//
+// Build and run (from the repository root):
+//   cc -O2 -Itools/gateway_stream/shim -Ifirmware_common/include -Ifirmware_gateway/include tools/json_bench/json_bench.c -lm -o /tmp/json_bench
+//   /tmp/json_bench [packets]
+//
+// The real gateway_protocol.c and json_writer.c
+// are compiled in unchanged (the shims only give
+// pins.h its SPI and I2C types). Checks, each over
+// random packets:
+//   - the telemetry line has the same keys, in the
+//     same order, as the snprintf formatter it
+//     replaced (kept below as RefTelemetryToJson),
+//     and every number agrees to within the last
+//     digit written
+//   - flash data hex reads back as the packet bytes
+//   - a line that does not fit returns 0
+// Then times telemetry against the reference, and
+// the batch, event, recovery and flash data
+// builders, in packets per second.
+//
+// Exits non-zero if a check fails. Figures are
+// host figures: compare them with each other,
+// not with the RP2040, where the float formatting
+// the writer avoids is done in software.
+//----------------------------------------------
+
+#include "../../firmware_common/src/lora_protocol.c"
+#include "../../firmware_common/src/gateway_stream.c"
+#include "../../firmware_gateway/src/json_writer.c"
+#include "../../firmware_gateway/src/gateway_protocol.c"
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+//----------------------------------------------
+// Bench Constants
+//----------------------------------------------
+#define kBenchPackets           100000
+#define kBenchPool              1024        // Distinct packets cycled through
+#define kBenchJsonLen           1024
+#define kBenchGroundPa          101325.0f
+#define kBenchGatewayLat        35.347200f
+#define kBenchGatewayLon        -117.808100f
+
+static uint32_t sSeed = 0x2545F491 ;
+static uint32_t sFailures = 0 ;
+static volatile uint32_t sSink = 0 ;        // Keeps timed loops from folding away
+
+//----------------------------------------------
+// Internal: NextRandom (xorshift32)
+//----------------------------------------------
+static uint32_t NextRandom(void)
+{
+  sSeed ^= sSeed << 13 ;
+  sSeed ^= sSeed >> 17 ;
+  sSeed ^= sSeed << 5 ;
+  return sSeed ;
+}
+
+//----------------------------------------------
+// Internal: RandomRange
+//----------------------------------------------
+static int32_t RandomRange(int32_t inLow, int32_t inHigh)
+{
+  return inLow + (int32_t)(NextRandom() % (uint32_t)(inHigh - inLow + 1)) ;
+}
+
+//----------------------------------------------
+// Internal: NowNs
+//----------------------------------------------
+static uint64_t NowNs(void)
+{
+  struct timespec theNow ;
+  clock_gettime(CLOCK_MONOTONIC, &theNow) ;
+  return (uint64_t)theNow.tv_sec * 1000000000ULL + (uint64_t)theNow.tv_nsec ;
+}
+
+//----------------------------------------------
+// Internal: Check
+//----------------------------------------------
+static void Check(bool inPassed, const char * inWhat)
+{
+  if (!inPassed)
+  {
+    sFailures++ ;
+    if (sFailures <= 10)
+    {
+      printf("FAIL: %s\n", inWhat) ;
+    }
+  }
+}
+
+//----------------------------------------------
+// Internal: RefTelemetryToJson
+// The snprintf formatter GatewayProtocol_
+// TelemetryToJson replaced, as it was
+//----------------------------------------------
+static int RefTelemetryToJson(
+  const LoRaTelemetryPacket * inPacket,
+  int16_t inRssi,
+  int8_t inSnr,
+  float inGroundPressurePa,
+  bool inGwGpsValid,
+  float inGwGpsLat,
+  float inGwGpsLon,
+  char * outJson,
+  int inMaxLen)
+{
+  float theGroundAltitudeM = CalculateAltitude(inGroundPressurePa, kSeaLevelPressurePa) ;
+  float theDiffAltitudeM = 0.0f ;
+  if (inGroundPressurePa > 0.0f && inPacket->pPressurePa > 0)
+  {
+    theDiffAltitudeM = CalculateAltitude((float)inPacket->pPressurePa, inGroundPressurePa) ;
+  }
+
+  return snprintf(outJson, inMaxLen,
+    "{\"type\":\"tel\",\"id\":%u,\"seq\":%u,\"t\":%lu,\"alt\":%.2f,\"dalt\":%.2f,"
+    "\"vel\":%.2f,\"pres\":%lu,\"gpres\":%.0f,\"galt\":%.1f,\"temp\":%.1f,"
+    "\"lat\":%.6f,\"lon\":%.6f,\"gspd\":%.2f,\"hdg\":%.1f,\"sat\":%u,\"gps\":%s,"
+    "\"ax\":%.3f,\"ay\":%.3f,\"az\":%.3f,\"gx\":%.1f,\"gy\":%.1f,\"gz\":%.1f,"
+    "\"mx\":%d,\"my\":%d,\"mz\":%d,\"state\":\"%s\",\"flags\":%u,\"rssi\":%d,\"snr\":%d,"
+    "\"gw_gps\":%s,\"gw_lat\":%.6f,\"gw_lon\":%.6f}\n",
+    inPacket->pRocketId,
+    inPacket->pSequence,
+    (unsigned long)inPacket->pTimeMs,
+    inPacket->pAltitudeCm / 100.0f,
+    theDiffAltitudeM,
+    inPacket->pVelocityCmps / 100.0f,
+    (unsigned long)inPacket->pPressurePa,
+    inGroundPressurePa,
+    theGroundAltitudeM,
+    inPacket->pTemperatureC10 / 10.0f,
+    inPacket->pGpsLatitude / 1000000.0f,
+    inPacket->pGpsLongitude / 1000000.0f,
+    inPacket->pGpsSpeedCmps / 100.0f,
+    inPacket->pGpsHeadingDeg10 / 10.0f,
+    inPacket->pGpsSatellites,
+    (inPacket->pFlags & kFlagGpsFix) != 0 ? "true" : "false",
+    inPacket->pAccelX / 1000.0f,
+    inPacket->pAccelY / 1000.0f,
+    inPacket->pAccelZ / 1000.0f,
+    inPacket->pGyroX / 10.0f,
+    inPacket->pGyroY / 10.0f,
+    inPacket->pGyroZ / 10.0f,
+    inPacket->pMagX,
+    inPacket->pMagY,
+    inPacket->pMagZ,
+    GatewayProtocol_GetStateName(inPacket->pState),
+    inPacket->pFlags,
+    inRssi,
+    inSnr,
+    inGwGpsValid ? "true" : "false",
+    inGwGpsValid ? inGwGpsLat : 0.0f,
+    inGwGpsValid ? inGwGpsLon : 0.0f) ;
+}
+
+//----------------------------------------------
+// Internal: SameJson
+// Whether two lines differ only in numbers, and
+// those by no more than a unit in the reference's
+// last digit (its floats were rounded from
+// float, not from the packet's integers)
+//----------------------------------------------
+static bool SameJson(const char * inRef, const char * inNew)
+{
+  while (*inRef != '\0' && *inNew != '\0')
+  {
+    bool theRefNumber = *inRef == '-' || (*inRef >= '0' && *inRef <= '9') ;
+    bool theNewNumber = *inNew == '-' || (*inNew >= '0' && *inNew <= '9') ;
+    if (theRefNumber != theNewNumber)
+    {
+      return false ;
+    }
+    if (!theRefNumber)
+    {
+      if (*inRef++ != *inNew++)
+      {
+        return false ;
+      }
+      continue ;
+    }
+
+    char * theRefEnd ;
+    char * theNewEnd ;
+    double theRef = strtod(inRef, &theRefEnd) ;
+    double theNew = strtod(inNew, &theNewEnd) ;
+    const char * thePoint = memchr(inRef, '.', theRefEnd - inRef) ;
+    int theDecimals = thePoint != NULL ? (int)(theRefEnd - thePoint - 1) : 0 ;
+    double theTolerance = pow(10.0, -theDecimals) * 1.01 + fabs(theRef) * 1e-6 ;
+    if (fabs(theRef - theNew) > theTolerance)
+    {
+      return false ;
+    }
+    inRef = theRefEnd ;
+    inNew = theNewEnd ;
+  }
+  return *inRef == *inNew ;
+}
+
+//----------------------------------------------
+// Internal: RandomTelemetry
+//----------------------------------------------
+static void RandomTelemetry(LoRaTelemetryPacket * outPacket)
+{
+  memset(outPacket, 0, sizeof(*outPacket)) ;
+  outPacket->pMagic = kLoRaMagic ;
+  outPacket->pPacketType = kLoRaPacketTelemetry ;
+  outPacket->pRocketId = (uint8_t)RandomRange(0, 14) ;
+  outPacket->pSequence = (uint16_t)NextRandom() ;
+  outPacket->pTimeMs = NextRandom() % 3600000 ;
+  outPacket->pAltitudeCm = RandomRange(-5000, 900000) ;
+  outPacket->pVelocityCmps = (int16_t)RandomRange(-30000, 30000) ;
+  outPacket->pPressurePa = (uint32_t)RandomRange(30000, 103000) ;
+  outPacket->pTemperatureC10 = (int16_t)RandomRange(-400, 600) ;
+  outPacket->pGpsLatitude = RandomRange(-90000000, 90000000) ;
+  outPacket->pGpsLongitude = RandomRange(-180000000, 180000000) ;
+  outPacket->pGpsSpeedCmps = (int16_t)RandomRange(0, 30000) ;
+  outPacket->pGpsHeadingDeg10 = (int16_t)RandomRange(0, 3599) ;
+  outPacket->pGpsSatellites = (uint8_t)RandomRange(0, 24) ;
+  outPacket->pAccelX = (int16_t)RandomRange(-16000, 16000) ;
+  outPacket->pAccelY = (int16_t)RandomRange(-16000, 16000) ;
+  outPacket->pAccelZ = (int16_t)RandomRange(-16000, 16000) ;
+  outPacket->pGyroX = (int16_t)RandomRange(-20000, 20000) ;
+  outPacket->pGyroY = (int16_t)RandomRange(-20000, 20000) ;
+  outPacket->pGyroZ = (int16_t)RandomRange(-20000, 20000) ;
+  outPacket->pMagX = (int16_t)RandomRange(-4000, 4000) ;
+  outPacket->pMagY = (int16_t)RandomRange(-4000, 4000) ;
+  outPacket->pMagZ = (int16_t)RandomRange(-4000, 4000) ;
+  outPacket->pState = (uint8_t)RandomRange(0, 7) ;
+  outPacket->pFlags = (uint8_t)NextRandom() ;
+}
+
+//----------------------------------------------
+// Internal: PutVarint
+//----------------------------------------------
+static int PutVarint(uint8_t * outData, uint32_t inValue)
+{
+  int theLen = 0 ;
+  do
+  {
+    uint8_t theByte = inValue & 0x7F ;
+    inValue >>= 7 ;
+    outData[theLen++] = inValue != 0 ? (theByte | 0x80) : theByte ;
+  } while (inValue != 0) ;
+  return theLen ;
+}
+
+//----------------------------------------------
+// Internal: ZigZag
+//----------------------------------------------
+static uint32_t ZigZag(int32_t inValue)
+{
+  return ((uint32_t)inValue << 1) ^ (uint32_t)(inValue >> 31) ;
+}
+
+//----------------------------------------------
+// Internal: RandomBatch
+// A full batch frame (layout: lora_protocol.h)
+//----------------------------------------------
+static int RandomBatch(uint8_t * outFrame)
+{
+  int32_t theTimeMs = RandomRange(0, 600000) ;
+  int32_t theAltitudeDm = RandomRange(0, 30000) ;
+  int16_t theVelocityDms = (int16_t)RandomRange(-3000, 3000) ;
+  int16_t theAccelDms2 = (int16_t)RandomRange(-1500, 1500) ;
+
+  outFrame[0] = kLoRaMagic ;
+  outFrame[1] = kLoRaPacketTelemetryBatch ;
+  outFrame[2] = (uint8_t)RandomRange(0, 14) ;
+  outFrame[3] = (uint8_t)NextRandom() ;
+  outFrame[4] = (uint8_t)NextRandom() ;
+  outFrame[5] = (uint8_t)RandomRange(0, 7) ;
+  outFrame[6] = (uint8_t)NextRandom() ;
+  memcpy(&outFrame[8], &theTimeMs, 4) ;
+  memcpy(&outFrame[12], &theAltitudeDm, 4) ;
+  memcpy(&outFrame[16], &theVelocityDms, 2) ;
+  memcpy(&outFrame[18], &theAccelDms2, 2) ;
+
+  int theLen = 20 ;
+  uint8_t theCount = 1 ;
+  while (theCount < 20)
+  {
+    theLen += PutVarint(&outFrame[theLen], 10) ;
+    theLen += PutVarint(&outFrame[theLen], ZigZag(RandomRange(-40, 40))) ;
+    theLen += PutVarint(&outFrame[theLen], ZigZag(RandomRange(-20, 20))) ;
+    theLen += PutVarint(&outFrame[theLen], ZigZag(RandomRange(-20, 20))) ;
+    theCount++ ;
+  }
+  outFrame[7] = theCount ;
+  outFrame[theLen] = LoRaProtocol_Crc8(outFrame, theLen) ;
+  return theLen + 1 ;
+}
+
+//----------------------------------------------
+// Internal: RandomRecovery
+//----------------------------------------------
+static void RandomRecovery(uint8_t * outBeacon)
+{
+  for (int i = 0 ; i < kRecoveryPacketLen ; i++)
+  {
+    outBeacon[i] = (uint8_t)NextRandom() ;
+  }
+  outBeacon[0] = kLoRaMagic ;
+  outBeacon[1] = kLoRaPacketRecovery ;
+  outBeacon[2] = (uint8_t)RandomRange(0, 14) ;
+  outBeacon[5] = (uint8_t)RandomRange(0, 7) ;
+  int32_t theLatitude = RandomRange(-90000000, 90000000) ;
+  int32_t theLongitude = RandomRange(-180000000, 180000000) ;
+  memcpy(&outBeacon[8], &theLatitude, 4) ;
+  memcpy(&outBeacon[12], &theLongitude, 4) ;
+  outBeacon[kRecoveryPacketLen - 1] = LoRaProtocol_Crc8(outBeacon, kRecoveryPacketLen - 1) ;
+}
+
+//----------------------------------------------
+// Internal: RandomFlashData
+// A full-size flash data chunk
+//----------------------------------------------
+static int RandomFlashData(uint8_t * outPacket)
+{
+  int theLen = kLoRaMaxPacketLen ;
+  for (int i = 0 ; i < theLen ; i++)
+  {
+    outPacket[i] = (uint8_t)NextRandom() ;
+  }
+  outPacket[0] = kLoRaMagic ;
+  outPacket[1] = kLoRaPacketFlashBulk ;
+  uint32_t theStart = NextRandom() % 100000 ;
+  memcpy(&outPacket[3], &theStart, 4) ;
+  return theLen ;
+}
+
+//----------------------------------------------
+// Internal: HexMatches
+// Whether the "data" hex of a flash data line is
+// inData
+//----------------------------------------------
+static bool HexMatches(const char * inJson, const uint8_t * inData, int inLen)
+{
+  const char * theHex = strstr(inJson, "\"data\":\"") ;
+  if (theHex == NULL)
+  {
+    return false ;
+  }
+  theHex += 8 ;
+  for (int i = 0 ; i < inLen ; i++)
+  {
+    unsigned theByte ;
+    if (sscanf(&theHex[i * 2], "%2X", &theByte) != 1 || theByte != inData[i])
+    {
+      return false ;
+    }
+  }
+  return theHex[inLen * 2] == '"' ;
+}
+
+//----------------------------------------------
+// Internal: Report
+//----------------------------------------------
+static void Report(const char * inName, uint64_t inNs, uint32_t inPackets, uint32_t inBytes)
+{
+  double theSeconds = inNs / 1e9 ;
+  printf("  %-22s %10.0f pkt/s  %6.1f bytes/line\n",
+         inName, inPackets / theSeconds, (double)inBytes / inPackets) ;
+}
+
+int main(int argc, char ** argv)
+{
+  uint32_t thePackets = argc > 1 ? (uint32_t)strtoul(argv[1], NULL, 10) : kBenchPackets ;
+  if (thePackets == 0)
+  {
+    thePackets = kBenchPackets ;
+  }
+
+  static LoRaTelemetryPacket sTelemetry[kBenchPool] ;
+  static uint8_t sBatches[kBenchPool][kLoRaMaxPacketLen] ;
+  static int sBatchLens[kBenchPool] ;
+  static uint8_t sRecoveries[kBenchPool][kRecoveryPacketLen] ;
+  static uint8_t sFlashData[kBenchPool][kLoRaMaxPacketLen] ;
+  static int sFlashLens[kBenchPool] ;
+  static FlightEvent sEvents[kBenchPool] ;
+  for (int i = 0 ; i < kBenchPool ; i++)
+  {
+    RandomTelemetry(&sTelemetry[i]) ;
+    sBatchLens[i] = RandomBatch(sBatches[i]) ;
+    RandomRecovery(sRecoveries[i]) ;
+    sFlashLens[i] = RandomFlashData(sFlashData[i]) ;
+    sEvents[i].pSequence = (uint8_t)NextRandom() ;
+    sEvents[i].pType = (uint8_t)RandomRange(1, 9) ;
+    sEvents[i].pState = (uint8_t)RandomRange(0, 7) ;
+    sEvents[i].pTimeMs = NextRandom() % 600000 ;
+    sEvents[i].pAltitudeDm = RandomRange(-100, 30000) ;
+    sEvents[i].pVelocityDms = (int16_t)RandomRange(-3000, 3000) ;
+  }
+
+  char theRef[kBenchJsonLen] ;
+  char theNew[kBenchJsonLen] ;
+
+  // Checks
+  for (int i = 0 ; i < kBenchPool ; i++)
+  {
+    bool theGwValid = (i & 1) != 0 ;
+    float theGround = (i & 2) != 0 ? kBenchGroundPa : 0.0f ;
+    int theRefLen = RefTelemetryToJson(&sTelemetry[i], -90, 7, theGround, theGwValid,
+                                       kBenchGatewayLat, kBenchGatewayLon, theRef, sizeof(theRef)) ;
+    int theNewLen = GatewayProtocol_TelemetryToJson(&sTelemetry[i], -90, 7, theGround, theGwValid,
+                                                    kBenchGatewayLat, kBenchGatewayLon, theNew, sizeof(theNew)) ;
+    Check(theNewLen == (int)strlen(theNew) && theNew[theNewLen - 1] == '\n', "telemetry length") ;
+    bool theSame = theRefLen > 0 && SameJson(theRef, theNew) ;
+    if (!theSame && sFailures == 0)
+    {
+      printf("  ref: %s  new: %s", theRef, theNew) ;
+    }
+    Check(theSame, "telemetry matches the snprintf formatter") ;
+
+    int theLen = GatewayProtocol_FlashDataToJson(sFlashData[i], sFlashLens[i], 0, theNew, sizeof(theNew)) ;
+    Check(theLen > 0 && HexMatches(theNew, &sFlashData[i][12], sFlashLens[i] - 12), "flash data hex") ;
+
+    Check(GatewayProtocol_TelemetryBatchToJson(sBatches[i], sBatchLens[i], -90, 7, theNew, 128, NULL, NULL) == 0,
+          "batch too long for its buffer returns 0") ;
+    Check(GatewayProtocol_TelemetryBatchToJson(sBatches[i], sBatchLens[i], -90, 7, theNew, sizeof(theNew), NULL, NULL) > 0,
+          "batch") ;
+    Check(GatewayProtocol_RecoveryToJson(sRecoveries[i], kRecoveryPacketLen, -90, 7, true,
+                                         kBenchGatewayLat, kBenchGatewayLon, theNew, sizeof(theNew)) > 0,
+          "recovery") ;
+  }
+  printf("Checks: %s (%u failures)\n", sFailures == 0 ? "pass" : "FAIL", sFailures) ;
+
+  // Timing
+  printf("JSON lines, %u packets:\n", thePackets) ;
+
+  uint32_t theBytes = 0 ;
+  uint64_t theStart = NowNs() ;
+  for (uint32_t n = 0 ; n < thePackets ; n++)
+  {
+    theBytes += RefTelemetryToJson(&sTelemetry[n % kBenchPool], -90, 7, kBenchGroundPa, true,
+                                   kBenchGatewayLat, kBenchGatewayLon, theRef, sizeof(theRef)) ;
+  }
+  Report("telemetry (snprintf)", NowNs() - theStart, thePackets, theBytes) ;
+
+  theBytes = 0 ;
+  theStart = NowNs() ;
+  for (uint32_t n = 0 ; n < thePackets ; n++)
+  {
+    theBytes += GatewayProtocol_TelemetryToJson(&sTelemetry[n % kBenchPool], -90, 7, kBenchGroundPa, true,
+                                                kBenchGatewayLat, kBenchGatewayLon, theNew, sizeof(theNew)) ;
+  }
+  Report("telemetry (writer)", NowNs() - theStart, thePackets, theBytes) ;
+
+  theBytes = 0 ;
+  theStart = NowNs() ;
+  for (uint32_t n = 0 ; n < thePackets ; n++)
+  {
+    uint32_t i = n % kBenchPool ;
+    theBytes += GatewayProtocol_TelemetryBatchToJson(sBatches[i], sBatchLens[i], -90, 7,
+                                                     theNew, sizeof(theNew), NULL, NULL) ;
+  }
+  Report("batch (20 samples)", NowNs() - theStart, thePackets, theBytes) ;
+
+  theBytes = 0 ;
+  theStart = NowNs() ;
+  for (uint32_t n = 0 ; n < thePackets ; n++)
+  {
+    theBytes += GatewayProtocol_EventToJson((uint8_t)(n & 0x0F), &sEvents[n % kBenchPool], -90, 7,
+                                            theNew, sizeof(theNew)) ;
+  }
+  Report("event", NowNs() - theStart, thePackets, theBytes) ;
+
+  theBytes = 0 ;
+  theStart = NowNs() ;
+  for (uint32_t n = 0 ; n < thePackets ; n++)
+  {
+    theBytes += GatewayProtocol_RecoveryToJson(sRecoveries[n % kBenchPool], kRecoveryPacketLen, -90, 7, true,
+                                               kBenchGatewayLat, kBenchGatewayLon, theNew, sizeof(theNew)) ;
+  }
+  Report("recovery", NowNs() - theStart, thePackets, theBytes) ;
+
+  theBytes = 0 ;
+  theStart = NowNs() ;
+  for (uint32_t n = 0 ; n < thePackets ; n++)
+  {
+    uint32_t i = n % kBenchPool ;
+    theBytes += GatewayProtocol_FlashDataToJson(sFlashData[i], sFlashLens[i], 0, theNew, sizeof(theNew)) ;
+  }
+  Report("flash data", NowNs() - theStart, thePackets, theBytes) ;
+
+  sSink += theBytes ;
+  return sFailures == 0 ? 0 : 1 ;
+}
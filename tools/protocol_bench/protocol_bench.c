@@ -0,0 +1,323 @@
+//----------------------------------------------
+// Module: protocol_bench.c
+// Description: Host round-trip check and decode
+//   benchmark for the shared LoRa protocol module
+//   (firmware_common/lora_protocol.c)
+// Author: Mark Gavin
+// Created: 2026-02-15
+// Copyright: (c) 2025-2026 by Mark Gavin
+// License: Proprietary - All Rights Reserved
+//
+// Build and run (from the repository root):
+//   cc -O2 -Ifirmware_common/include tools/protocol_bench/protocol_bench.c -o /tmp/protocol_bench
+//   /tmp/protocol_bench [packets]
+//
+// The real lora_protocol.c is compiled in
+// unchanged. Checks, each over random packets:
+//   - every field written through the struct reads
+//     back the same through the accessors
+//   - the table CRC-8 equals the bitwise one it
+//     replaced, for every length up to 256
+//   - a valid packet passes LoRaProtocol_IsTelemetry
+//     and any single flipped bit fails it
+// Then times the bitwise and table CRC, and a
+// telemetry decode (validate, then read ID,
+// sequence, altitude, state and flags) in place
+// against the same after a copy into the struct.
+//
+// Exits non-zero if a check fails. Figures are
+// host figures: compare them with each other,
+// not with the RP2040.
+//----------------------------------------------
+
+#include "../../firmware_common/src/lora_protocol.c"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+//----------------------------------------------
+// Bench Constants
+//----------------------------------------------
+#define kBenchPackets           100000
+#define kBenchPool              1024        // Distinct packets cycled through
+#define kBenchCrcBytes          (16UL * 1024UL * 1024UL)
+
+static uint32_t sSeed = 0x2545F491 ;
+static uint32_t sFailures = 0 ;
+static volatile uint32_t sSink = 0 ;        // Keeps timed loops from folding away
+
+//----------------------------------------------
+// Internal: NextRandom (xorshift32)
+//----------------------------------------------
+static uint32_t NextRandom(void)
+{
+  sSeed ^= sSeed << 13 ;
+  sSeed ^= sSeed >> 17 ;
+  sSeed ^= sSeed << 5 ;
+  return sSeed ;
+}
+
+//----------------------------------------------
+// Internal: NowNs
+//----------------------------------------------
+static uint64_t NowNs(void)
+{
+  struct timespec theNow ;
+  clock_gettime(CLOCK_MONOTONIC, &theNow) ;
+  return (uint64_t)theNow.tv_sec * 1000000000ULL + (uint64_t)theNow.tv_nsec ;
+}
+
+//----------------------------------------------
+// Internal: BitwiseCrc8
+// The per-bit loop every module carried before
+// the shared table
+//----------------------------------------------
+static uint8_t BitwiseCrc8(const uint8_t * inData, size_t inLen)
+{
+  uint8_t theCrc = 0xFF ;
+
+  for (size_t i = 0 ; i < inLen ; i++)
+  {
+    theCrc ^= inData[i] ;
+    for (int j = 0 ; j < 8 ; j++)
+    {
+      theCrc = (theCrc & 0x80) ? (uint8_t)((theCrc << 1) ^ 0x31) : (uint8_t)(theCrc << 1) ;
+    }
+  }
+
+  return theCrc ;
+}
+
+//----------------------------------------------
+// Internal: Check
+//----------------------------------------------
+static void Check(bool inOk, const char * inWhat, uint32_t inIndex)
+{
+  if (!inOk)
+  {
+    if (sFailures < 10)
+    {
+      printf("  FAIL: %s (packet %u)\n", inWhat, inIndex) ;
+    }
+    sFailures++ ;
+  }
+}
+
+//----------------------------------------------
+// Internal: RandomPacket
+// Fill every field through the struct, as the
+// flight computer does, and seal it
+//----------------------------------------------
+static void RandomPacket(uint8_t * outData)
+{
+  LoRaTelemetryPacket thePacket ;
+
+  thePacket.pMagic = kLoRaMagic ;
+  thePacket.pPacketType = kLoRaPacketTelemetry ;
+  thePacket.pRocketId = (uint8_t)(NextRandom() & 0x0F) ;
+  thePacket.pSequence = (uint16_t)NextRandom() ;
+  thePacket.pTimeMs = NextRandom() ;
+  thePacket.pAltitudeCm = (int32_t)NextRandom() ;
+  thePacket.pVelocityCmps = (int16_t)NextRandom() ;
+  thePacket.pPressurePa = NextRandom() ;
+  thePacket.pTemperatureC10 = (int16_t)NextRandom() ;
+  thePacket.pGpsLatitude = (int32_t)NextRandom() ;
+  thePacket.pGpsLongitude = (int32_t)NextRandom() ;
+  thePacket.pGpsSpeedCmps = (int16_t)NextRandom() ;
+  thePacket.pGpsHeadingDeg10 = (uint16_t)NextRandom() ;
+  thePacket.pGpsSatellites = (uint8_t)NextRandom() ;
+  thePacket.pAccelX = (int16_t)NextRandom() ;
+  thePacket.pAccelY = (int16_t)NextRandom() ;
+  thePacket.pAccelZ = (int16_t)NextRandom() ;
+  thePacket.pGyroX = (int16_t)NextRandom() ;
+  thePacket.pGyroY = (int16_t)NextRandom() ;
+  thePacket.pGyroZ = (int16_t)NextRandom() ;
+  thePacket.pMagX = (int16_t)NextRandom() ;
+  thePacket.pMagY = (int16_t)NextRandom() ;
+  thePacket.pMagZ = (int16_t)NextRandom() ;
+  thePacket.pState = (uint8_t)(NextRandom() & 0x07) ;
+  thePacket.pFlags = (uint8_t)NextRandom() ;
+  thePacket.pCrc = LoRaProtocol_Crc8((const uint8_t *)&thePacket, kLoRaTelemetryLen - 1) ;
+
+  memcpy(outData, &thePacket, kLoRaTelemetryLen) ;
+}
+
+//----------------------------------------------
+// Internal: CheckRoundTrip
+// Read every field back in place from an odd
+// address and compare with the struct copy
+//----------------------------------------------
+static void CheckRoundTrip(uint32_t inPackets)
+{
+  uint8_t theBuffer[kLoRaTelemetryLen + 1] ;
+  uint8_t * theData = &theBuffer[1] ;       // Misaligned on purpose
+
+  for (uint32_t n = 0 ; n < inPackets ; n++)
+  {
+    RandomPacket(theData) ;
+
+    LoRaTelemetryPacket theCopy ;
+    memcpy(&theCopy, theData, kLoRaTelemetryLen) ;
+
+#define CHECK_FIELD(field, get) \
+    Check(get(theData, offsetof(LoRaTelemetryPacket, field)) == theCopy.field, #field, n)
+
+    CHECK_FIELD(pRocketId, LoRaProtocol_GetU8) ;
+    CHECK_FIELD(pSequence, LoRaProtocol_GetU16) ;
+    CHECK_FIELD(pTimeMs, LoRaProtocol_GetU32) ;
+    CHECK_FIELD(pAltitudeCm, LoRaProtocol_GetI32) ;
+    CHECK_FIELD(pVelocityCmps, LoRaProtocol_GetI16) ;
+    CHECK_FIELD(pPressurePa, LoRaProtocol_GetU32) ;
+    CHECK_FIELD(pTemperatureC10, LoRaProtocol_GetI16) ;
+    CHECK_FIELD(pGpsLatitude, LoRaProtocol_GetI32) ;
+    CHECK_FIELD(pGpsLongitude, LoRaProtocol_GetI32) ;
+    CHECK_FIELD(pGpsSpeedCmps, LoRaProtocol_GetI16) ;
+    CHECK_FIELD(pGpsHeadingDeg10, LoRaProtocol_GetU16) ;
+    CHECK_FIELD(pGpsSatellites, LoRaProtocol_GetU8) ;
+    CHECK_FIELD(pAccelX, LoRaProtocol_GetI16) ;
+    CHECK_FIELD(pAccelY, LoRaProtocol_GetI16) ;
+    CHECK_FIELD(pAccelZ, LoRaProtocol_GetI16) ;
+    CHECK_FIELD(pGyroX, LoRaProtocol_GetI16) ;
+    CHECK_FIELD(pGyroY, LoRaProtocol_GetI16) ;
+    CHECK_FIELD(pGyroZ, LoRaProtocol_GetI16) ;
+    CHECK_FIELD(pMagX, LoRaProtocol_GetI16) ;
+    CHECK_FIELD(pMagY, LoRaProtocol_GetI16) ;
+    CHECK_FIELD(pMagZ, LoRaProtocol_GetI16) ;
+    CHECK_FIELD(pState, LoRaProtocol_GetU8) ;
+    CHECK_FIELD(pFlags, LoRaProtocol_GetU8) ;
+
+#undef CHECK_FIELD
+
+    Check(LoRaProtocol_IsTelemetry(theData, kLoRaTelemetryLen), "valid packet rejected", n) ;
+    Check(!LoRaProtocol_IsTelemetry(theData, kLoRaTelemetryLen - 1), "short packet accepted", n) ;
+
+    // CRC-8 catches every single-bit error
+    uint32_t theBit = NextRandom() % (kLoRaTelemetryLen * 8) ;
+    theData[theBit / 8] ^= (uint8_t)(1 << (theBit % 8)) ;
+    Check(!LoRaProtocol_IsTelemetry(theData, kLoRaTelemetryLen), "flipped bit accepted", n) ;
+  }
+}
+
+//----------------------------------------------
+// Internal: CheckCrc
+// Table against bitwise, every length to 256
+//----------------------------------------------
+static void CheckCrc(void)
+{
+  uint8_t theData[256] ;
+
+  for (uint32_t theLen = 0 ; theLen <= sizeof(theData) ; theLen++)
+  {
+    for (uint32_t i = 0 ; i < theLen ; i++)
+    {
+      theData[i] = (uint8_t)NextRandom() ;
+    }
+    Check(LoRaProtocol_Crc8(theData, theLen) == BitwiseCrc8(theData, theLen), "table CRC differs", theLen) ;
+  }
+}
+
+//----------------------------------------------
+// Internal: BenchCrc
+//----------------------------------------------
+static void BenchCrc(void)
+{
+  static uint8_t sData[4096] ;
+  uint32_t theRounds = kBenchCrcBytes / sizeof(sData) ;
+
+  for (uint32_t i = 0 ; i < sizeof(sData) ; i++)
+  {
+    sData[i] = (uint8_t)NextRandom() ;
+  }
+
+  uint64_t theStart = NowNs() ;
+  for (uint32_t r = 0 ; r < theRounds ; r++)
+  {
+    sSink += BitwiseCrc8(sData, sizeof(sData)) ;
+  }
+  uint64_t theBitwiseNs = NowNs() - theStart ;
+
+  theStart = NowNs() ;
+  for (uint32_t r = 0 ; r < theRounds ; r++)
+  {
+    sSink += LoRaProtocol_Crc8(sData, sizeof(sData)) ;
+  }
+  uint64_t theTableNs = NowNs() - theStart ;
+
+  printf("  %-28s %8.1f MB/s\n", "CRC-8 bitwise", kBenchCrcBytes * 1000.0 / theBitwiseNs) ;
+  printf("  %-28s %8.1f MB/s  (%.1fx)\n", "CRC-8 table", kBenchCrcBytes * 1000.0 / theTableNs,
+    (double)theBitwiseNs / theTableNs) ;
+}
+
+//----------------------------------------------
+// Internal: BenchDecode
+//----------------------------------------------
+static void BenchDecode(uint32_t inPackets)
+{
+  static uint8_t sPool[kBenchPool][kLoRaTelemetryLen] ;
+
+  for (uint32_t i = 0 ; i < kBenchPool ; i++)
+  {
+    RandomPacket(sPool[i]) ;
+  }
+
+  // Copy into the struct, as the decoders did
+  uint64_t theStart = NowNs() ;
+  for (uint32_t n = 0 ; n < inPackets ; n++)
+  {
+    const uint8_t * theData = sPool[n % kBenchPool] ;
+    if (theData[0] != kLoRaMagic || theData[1] != kLoRaPacketTelemetry ||
+        BitwiseCrc8(theData, kLoRaTelemetryLen - 1) != theData[kLoRaTelemetryLen - 1])
+    {
+      continue ;
+    }
+    LoRaTelemetryPacket thePacket ;
+    memcpy(&thePacket, theData, sizeof(thePacket)) ;
+    sSink += thePacket.pRocketId + thePacket.pSequence + (uint32_t)thePacket.pAltitudeCm +
+      thePacket.pState + thePacket.pFlags ;
+  }
+  uint64_t theCopyNs = NowNs() - theStart ;
+
+  // Read in place through the accessors
+  theStart = NowNs() ;
+  for (uint32_t n = 0 ; n < inPackets ; n++)
+  {
+    const uint8_t * theData = sPool[n % kBenchPool] ;
+    if (!LoRaProtocol_IsTelemetry(theData, kLoRaTelemetryLen))
+    {
+      continue ;
+    }
+    sSink += LoRaProtocol_GetU8(theData, offsetof(LoRaTelemetryPacket, pRocketId)) +
+      LoRaProtocol_GetU16(theData, offsetof(LoRaTelemetryPacket, pSequence)) +
+      (uint32_t)LoRaProtocol_GetI32(theData, offsetof(LoRaTelemetryPacket, pAltitudeCm)) +
+      LoRaProtocol_GetU8(theData, offsetof(LoRaTelemetryPacket, pState)) +
+      LoRaProtocol_GetU8(theData, offsetof(LoRaTelemetryPacket, pFlags)) ;
+  }
+  uint64_t theInPlaceNs = NowNs() - theStart ;
+
+  printf("  %-28s %8.2f Mpkt/s  %6.1f ns/pkt\n", "decode copy, bitwise CRC",
+    inPackets * 1000.0 / theCopyNs, (double)theCopyNs / inPackets) ;
+  printf("  %-28s %8.2f Mpkt/s  %6.1f ns/pkt\n", "decode in place, table CRC",
+    inPackets * 1000.0 / theInPlaceNs, (double)theInPlaceNs / inPackets) ;
+}
+
+int main(int argc, char ** argv)
+{
+  uint32_t thePackets = kBenchPackets ;
+  if (argc > 1)
+  {
+    thePackets = (uint32_t)strtoul(argv[1], NULL, 0) ;
+  }
+
+  printf("LoRa protocol: telemetry %u bytes, %u packets\n", kLoRaTelemetryLen, thePackets) ;
+
+  CheckCrc() ;
+  CheckRoundTrip(thePackets) ;
+  printf("Checks: %s (%u failures)\n", sFailures == 0 ? "pass" : "FAIL", sFailures) ;
+
+  BenchCrc() ;
+  BenchDecode(thePackets * 10) ;
+
+  return sFailures == 0 ? 0 : 1 ;
+}
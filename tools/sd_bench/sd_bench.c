@@ -0,0 +1,702 @@
+//----------------------------------------------
+// Module: sd_bench.c
+// Description: Host throughput benchmark for the
+//   flight computer SD driver (diskio.c) against
+//   a simulated SPI-mode SD card
+// Author: Mark Gavin
+// Created: 2026-02-06
+// Copyright: (c) 2025-2026 by Mark Gavin
+// License: Proprietary - All Rights Reserved
+//
+// Build and run (from the repository root):
+//   cc -O2 -Itools/sd_bench/shim -Ifirmware_flight/include tools/sd_bench/sd_bench.c -o /tmp/sd_bench
+//   /tmp/sd_bench [program_us] [cpu_byte_ns]
+//
+// The real diskio.c is compiled in unchanged. The
+// shims provide a simulated clock: each SPI byte
+// costs 8 bit times at the divided SPI clock
+// (same divider search as the Pico SDK, 125 MHz
+// clk_peri). A CPU-driven byte also costs
+// cpu_byte_ns of call overhead; DMA bytes do not.
+// The card model answers commands, checks CRC7 and
+// CRC16 once CMD59 is on, and holds busy for
+// program_us after each written block.
+//
+// Figures are relative: they show protocol and
+// driver overhead, not a particular card. Use
+// SdLogger_Benchmark for on-target numbers.
+//----------------------------------------------
+
+#include "../../firmware_flight/src/diskio.c"
+
+#include <stdlib.h>
+#include <string.h>
+
+#undef printf
+
+//----------------------------------------------
+// Simulation Constants
+//----------------------------------------------
+#define kSimClkPeriHz           125000000
+#define kSimCardSectors         16384       // 8 MB image
+#define kSimReadLatencyUs       100         // Nac: command to first data token
+#define kSimReadBlockUs         20          // Card gap between CMD18 blocks
+#define kSimStopBusyUs          250         // Busy after stop token / CMD12
+#define kSimDmaSetupNs          2000        // Channel configuration per data phase
+#define kSimBenchBytes          (2UL * 1024UL * 1024UL)
+#define kSimLoggerBlocks        4           // kSdBufferSectors
+#define kSimPollGapUs           1000        // Main loop period between polls
+
+//----------------------------------------------
+// Simulated Clock
+//----------------------------------------------
+static uint64_t sSimNs = 0 ;
+static uint64_t sSimCpuNs = 0 ;             // Time the CPU spent in the driver
+static uint32_t sSimBaudrate = 400000 ;
+static uint32_t sSimCpuByteNs = 500 ;
+static uint32_t sSimProgramUs = 150 ;
+
+uint32_t time_us_32(void)
+{
+  return (uint32_t)(sSimNs / 1000) ;
+}
+
+absolute_time_t make_timeout_time_ms(uint32_t inMs)
+{
+  return sSimNs / 1000 + (uint64_t)inMs * 1000 ;
+}
+
+bool time_reached(absolute_time_t inTime)
+{
+  return sSimNs / 1000 >= inTime ;
+}
+
+void sleep_ms(uint32_t inMs)
+{
+  sSimNs += (uint64_t)inMs * 1000000 ;
+}
+
+void tight_loop_contents(void)
+{
+}
+
+//----------------------------------------------
+// Simulated SD Card
+//----------------------------------------------
+typedef enum
+{
+  kCardCommand = 0 ,
+  kCardWriteToken ,
+  kCardWriteData
+} CardMode ;
+
+static struct
+{
+  bool pSelected ;
+  bool pIdle ;
+  bool pCrcOn ;
+  bool pAppCmd ;
+  CardMode pMode ;
+  bool pMultiWrite ;
+
+  // Command being received
+  uint8_t pCmd[6] ;
+  int pCmdLen ;
+
+  // Bytes queued for MISO
+  uint8_t pOut[600] ;
+  int pOutHead ;
+  int pOutTail ;
+
+  // Write data phase
+  uint8_t pBlock[514] ;
+  int pBlockLen ;
+  uint32_t pWriteSector ;
+
+  // Read streaming
+  bool pReading ;
+  bool pMultiRead ;
+  uint32_t pReadSector ;
+  uint64_t pReadReadyNs ;
+
+  uint64_t pBusyUntilNs ;
+  uint32_t pCrcErrors ;
+  uint8_t * pImage ;
+} sCard ;
+
+static void CardQueue(uint8_t inByte)
+{
+  sCard.pOut[sCard.pOutTail++] = inByte ;
+}
+
+static uint8_t SimCrc7(const uint8_t * inData, int inLen)
+{
+  uint8_t theCrc = 0 ;
+  for (int i = 0 ; i < inLen ; i++)
+  {
+    for (int theBit = 7 ; theBit >= 0 ; theBit--)
+    {
+      uint8_t theIn = ((inData[i] >> theBit) & 1) ^ ((theCrc >> 6) & 1) ;
+      theCrc = (uint8_t)((theCrc << 1) & 0x7F) ;
+      if (theIn) theCrc ^= 0x09 ;
+    }
+  }
+  return (uint8_t)((theCrc << 1) | 1) ;
+}
+
+static uint16_t SimCrc16(const uint8_t * inData, int inLen)
+{
+  uint16_t theCrc = 0 ;
+  for (int i = 0 ; i < inLen ; i++)
+  {
+    theCrc ^= (uint16_t)(inData[i] << 8) ;
+    for (int theBit = 0 ; theBit < 8 ; theBit++)
+    {
+      theCrc = (theCrc & 0x8000) ? (uint16_t)((theCrc << 1) ^ 0x1021) : (uint16_t)(theCrc << 1) ;
+    }
+  }
+  return theCrc ;
+}
+
+static void CardExecute(void)
+{
+  uint8_t theCmd = sCard.pCmd[0] & 0x3F ;
+  uint32_t theArg = ((uint32_t)sCard.pCmd[1] << 24) | ((uint32_t)sCard.pCmd[2] << 16) |
+                    ((uint32_t)sCard.pCmd[3] << 8) | sCard.pCmd[4] ;
+  bool theApp = sCard.pAppCmd ;
+  sCard.pAppCmd = false ;
+
+  CardQueue(0xFF) ;   // Ncr
+
+  bool theCrcOk = (SimCrc7(sCard.pCmd, 5) == sCard.pCmd[5]) ;
+  if ((sCard.pCrcOn || theCmd == 0 || theCmd == 8) && !theCrcOk)
+  {
+    sCard.pCrcErrors++ ;
+    CardQueue(0x08 | (sCard.pIdle ? 0x01 : 0x00)) ;
+    return ;
+  }
+
+  uint8_t theR1 = sCard.pIdle ? 0x01 : 0x00 ;
+
+  switch (theApp ? (0x80 | theCmd) : theCmd)
+  {
+    case 0:
+      sCard.pIdle = true ;
+      CardQueue(0x01) ;
+      break ;
+
+    case 8:
+      CardQueue(theR1) ;
+      CardQueue(0x00) ; CardQueue(0x00) ; CardQueue(0x01) ; CardQueue(0xAA) ;
+      break ;
+
+    case 59:
+      sCard.pCrcOn = (theArg & 1) != 0 ;
+      CardQueue(theR1) ;
+      break ;
+
+    case 55:
+      sCard.pAppCmd = true ;
+      CardQueue(theR1) ;
+      break ;
+
+    case 0x80 | 41:
+      CardQueue(theR1) ;
+      sCard.pIdle = false ;   // Ready on the next poll
+      break ;
+
+    case 58:
+      CardQueue(theR1) ;
+      CardQueue(0xC0) ; CardQueue(0xFF) ; CardQueue(0x80) ; CardQueue(0x00) ;
+      break ;
+
+    case 0x80 | 23:
+    case 16:
+      CardQueue(theR1) ;
+      break ;
+
+    case 12:
+      sCard.pReading = false ;
+      sCard.pOutHead = sCard.pOutTail = 0 ;
+      CardQueue(0xFF) ;   // Stuff byte
+      CardQueue(0x00) ;
+      sCard.pBusyUntilNs = sSimNs + (uint64_t)kSimStopBusyUs * 1000 ;
+      break ;
+
+    case 17:
+    case 18:
+      CardQueue(0x00) ;
+      sCard.pReading = true ;
+      sCard.pMultiRead = (theCmd == 18) ;
+      sCard.pReadSector = theArg ;
+      sCard.pReadReadyNs = sSimNs + (uint64_t)kSimReadLatencyUs * 1000 ;
+      break ;
+
+    case 24:
+    case 25:
+      CardQueue(0x00) ;
+      sCard.pMode = kCardWriteToken ;
+      sCard.pMultiWrite = (theCmd == 25) ;
+      sCard.pWriteSector = theArg ;
+      break ;
+
+    default:
+      CardQueue(0x04 | theR1) ;   // Illegal command
+      break ;
+  }
+}
+
+static void CardReceive(uint8_t inByte)
+{
+  switch (sCard.pMode)
+  {
+    case kCardCommand:
+      if (sCard.pCmdLen == 0 && (inByte & 0xC0) != 0x40) break ;
+      sCard.pCmd[sCard.pCmdLen++] = inByte ;
+      if (sCard.pCmdLen == 6)
+      {
+        sCard.pCmdLen = 0 ;
+        CardExecute() ;
+      }
+      break ;
+
+    case kCardWriteToken:
+      if (inByte == 0xFE || inByte == 0xFC)
+      {
+        sCard.pMode = kCardWriteData ;
+        sCard.pBlockLen = 0 ;
+      }
+      else if (inByte == 0xFD && sCard.pMultiWrite)
+      {
+        CardQueue(0xFF) ;   // Nbr
+        sCard.pBusyUntilNs = sSimNs + (uint64_t)kSimStopBusyUs * 1000 ;
+        sCard.pMode = kCardCommand ;
+      }
+      break ;
+
+    case kCardWriteData:
+      sCard.pBlock[sCard.pBlockLen++] = inByte ;
+      if (sCard.pBlockLen == 514)
+      {
+        uint16_t theCrc = (uint16_t)((sCard.pBlock[512] << 8) | sCard.pBlock[513]) ;
+        if (sCard.pCrcOn && theCrc != SimCrc16(sCard.pBlock, 512))
+        {
+          sCard.pCrcErrors++ ;
+          CardQueue(0x0B) ;
+        }
+        else
+        {
+          if (sCard.pWriteSector < kSimCardSectors)
+          {
+            memcpy(&sCard.pImage[(size_t)sCard.pWriteSector * 512], sCard.pBlock, 512) ;
+          }
+          sCard.pWriteSector++ ;
+          CardQueue(0x05) ;
+        }
+        sCard.pBusyUntilNs = sSimNs + (uint64_t)sSimProgramUs * 1000 ;
+        sCard.pMode = sCard.pMultiWrite ? kCardWriteToken : kCardCommand ;
+      }
+      break ;
+  }
+}
+
+static uint8_t CardXfer(uint8_t inMosi)
+{
+  if (!sCard.pSelected)
+  {
+    return 0xFF ;
+  }
+
+  // Next read block due?
+  if (sCard.pReading && sCard.pOutHead == sCard.pOutTail && sSimNs >= sCard.pReadReadyNs)
+  {
+    sCard.pOutHead = sCard.pOutTail = 0 ;
+    CardQueue(0xFE) ;
+    const uint8_t * theData = &sCard.pImage[(size_t)(sCard.pReadSector % kSimCardSectors) * 512] ;
+    memcpy(&sCard.pOut[sCard.pOutTail], theData, 512) ;
+    sCard.pOutTail += 512 ;
+    uint16_t theCrc = SimCrc16(theData, 512) ;
+    CardQueue((uint8_t)(theCrc >> 8)) ;
+    CardQueue((uint8_t)theCrc) ;
+    sCard.pReadSector++ ;
+    sCard.pReadReadyNs = ~0ULL ;
+  }
+
+  uint8_t theMiso ;
+  if (sCard.pOutHead < sCard.pOutTail)
+  {
+    theMiso = sCard.pOut[sCard.pOutHead++] ;
+    if (sCard.pOutHead == sCard.pOutTail)
+    {
+      sCard.pOutHead = sCard.pOutTail = 0 ;
+      if (sCard.pReading)
+      {
+        if (sCard.pMultiRead && sCard.pReadReadyNs == ~0ULL)
+        {
+          sCard.pReadReadyNs = sSimNs + (uint64_t)kSimReadBlockUs * 1000 ;
+        }
+        else if (!sCard.pMultiRead && sCard.pReadReadyNs == ~0ULL)
+        {
+          sCard.pReading = false ;
+        }
+      }
+    }
+  }
+  else
+  {
+    theMiso = (sSimNs < sCard.pBusyUntilNs) ? 0x00 : 0xFF ;
+  }
+
+  CardReceive(inMosi) ;
+  return theMiso ;
+}
+
+//----------------------------------------------
+// SPI Shim
+//----------------------------------------------
+static spi_hw_t sSimSpiHw ;
+spi_inst_t * spi0 = (spi_inst_t *)0x1 ;
+spi_inst_t * spi1 = (spi_inst_t *)0x2 ;
+i2c_inst_t * i2c0 = (i2c_inst_t *)0x3 ;
+i2c_inst_t * i2c1 = (i2c_inst_t *)0x4 ;
+
+static uint64_t ByteNs(void)
+{
+  return 8000000000ULL / sSimBaudrate ;
+}
+
+unsigned spi_set_baudrate(spi_inst_t * inSpi, unsigned inBaudrate)
+{
+  (void)inSpi ;
+
+  // Same prescale/postdiv search as the Pico SDK
+  uint32_t thePrescale ;
+  uint32_t thePostdiv ;
+  for (thePrescale = 2 ; thePrescale <= 254 ; thePrescale += 2)
+  {
+    if ((uint64_t)kSimClkPeriHz < (uint64_t)(thePrescale + 2) * 256 * inBaudrate) break ;
+  }
+  for (thePostdiv = 256 ; thePostdiv > 1 ; --thePostdiv)
+  {
+    if (kSimClkPeriHz / (thePrescale * (thePostdiv - 1)) > inBaudrate) break ;
+  }
+  sSimBaudrate = kSimClkPeriHz / (thePrescale * thePostdiv) ;
+  return sSimBaudrate ;
+}
+
+unsigned spi_init(spi_inst_t * inSpi, unsigned inBaudrate)
+{
+  return spi_set_baudrate(inSpi, inBaudrate) ;
+}
+
+int spi_write_read_blocking(spi_inst_t * inSpi, const uint8_t * inSrc, uint8_t * outDst, size_t inLen)
+{
+  (void)inSpi ;
+  for (size_t i = 0 ; i < inLen ; i++)
+  {
+    sSimNs += ByteNs() + sSimCpuByteNs ;
+    sSimCpuNs += ByteNs() + sSimCpuByteNs ;
+    outDst[i] = CardXfer(inSrc[i]) ;
+  }
+  return (int)inLen ;
+}
+
+spi_hw_t * spi_get_hw(spi_inst_t * inSpi)
+{
+  (void)inSpi ;
+  return &sSimSpiHw ;
+}
+
+unsigned spi_get_dreq(spi_inst_t * inSpi, int inIsTx)
+{
+  (void)inSpi ;
+  return inIsTx ? 18 : 19 ;
+}
+
+// Every transfer completes inside the call that
+// starts it, so the FIFOs are always drained
+bool spi_is_busy(const spi_inst_t * inSpi) { (void)inSpi ; return false ; }
+bool spi_is_readable(const spi_inst_t * inSpi) { (void)inSpi ; return false ; }
+
+//----------------------------------------------
+// GPIO Shim
+//----------------------------------------------
+void gpio_init(unsigned inPin) { (void)inPin ; }
+void gpio_set_dir(unsigned inPin, bool inOut) { (void)inPin ; (void)inOut ; }
+void gpio_set_function(unsigned inPin, unsigned inFunc) { (void)inPin ; (void)inFunc ; }
+void gpio_pull_up(unsigned inPin) { (void)inPin ; }
+
+void gpio_put(unsigned inPin, bool inValue)
+{
+  if (inPin == kPinSdCs)
+  {
+    sCard.pSelected = !inValue ;
+    if (inValue) sCard.pCmdLen = 0 ;
+  }
+}
+
+//----------------------------------------------
+// DMA Shim
+//----------------------------------------------
+typedef struct
+{
+  dma_channel_config pConfig ;
+  volatile void * pWrite ;
+  const volatile void * pRead ;
+  uint pCount ;
+} SimDmaChannel ;
+
+static SimDmaChannel sSimDma[12] ;
+static bool sSimDmaClaimed[12] ;
+static bool sSimDmaAvailable = true ;
+static dma_hw_t sSimDmaHw ;
+dma_hw_t * dma_hw = &sSimDmaHw ;
+static int sSimSniffChannel = -1 ;
+
+int dma_claim_unused_channel(bool inRequired)
+{
+  (void)inRequired ;
+  for (int i = 0 ; sSimDmaAvailable && i < 12 ; i++)
+  {
+    if (!sSimDmaClaimed[i])
+    {
+      sSimDmaClaimed[i] = true ;
+      return i ;
+    }
+  }
+  return -1 ;
+}
+
+void dma_channel_unclaim(uint inChannel) { sSimDmaClaimed[inChannel] = false ; }
+
+dma_channel_config dma_channel_get_default_config(uint inChannel)
+{
+  (void)inChannel ;
+  dma_channel_config theConfig = { true, false, false } ;
+  return theConfig ;
+}
+
+void channel_config_set_transfer_data_size(dma_channel_config * ioConfig, enum dma_channel_transfer_size inSize) { (void)ioConfig ; (void)inSize ; }
+void channel_config_set_dreq(dma_channel_config * ioConfig, uint inDreq) { (void)ioConfig ; (void)inDreq ; }
+void channel_config_set_read_increment(dma_channel_config * ioConfig, bool inIncrement) { ioConfig->pReadIncrement = inIncrement ; }
+void channel_config_set_write_increment(dma_channel_config * ioConfig, bool inIncrement) { ioConfig->pWriteIncrement = inIncrement ; }
+void channel_config_set_sniff_enable(dma_channel_config * ioConfig, bool inSniff) { ioConfig->pSniff = inSniff ; }
+void dma_sniffer_enable(uint inChannel, uint inMode, bool inForce) { (void)inMode ; (void)inForce ; sSimSniffChannel = (int)inChannel ; }
+void dma_sniffer_disable(void) { sSimSniffChannel = -1 ; }
+
+void dma_channel_configure(uint inChannel, const dma_channel_config * inConfig,
+  volatile void * inWrite, const volatile void * inRead, uint inCount, bool inTrigger)
+{
+  (void)inTrigger ;
+  sSimDma[inChannel].pConfig = *inConfig ;
+  sSimDma[inChannel].pWrite = inWrite ;
+  sSimDma[inChannel].pRead = inRead ;
+  sSimDma[inChannel].pCount = inCount ;
+}
+
+static void SniffByte(uint8_t inByte)
+{
+  uint16_t theCrc = (uint16_t)sSimDmaHw.sniff_data ;
+  theCrc ^= (uint16_t)(inByte << 8) ;
+  for (int theBit = 0 ; theBit < 8 ; theBit++)
+  {
+    theCrc = (theCrc & 0x8000) ? (uint16_t)((theCrc << 1) ^ 0x1021) : (uint16_t)(theCrc << 1) ;
+  }
+  sSimDmaHw.sniff_data = theCrc ;
+}
+
+void dma_start_channel_mask(uint32_t inMask)
+{
+  int theTx = -1 ;
+  int theRx = -1 ;
+  for (int i = 0 ; i < 12 ; i++)
+  {
+    if (!(inMask & (1u << i))) continue ;
+    if (sSimDma[i].pWrite == &sSimSpiHw.dr) theTx = i ;
+    if (sSimDma[i].pRead == &sSimSpiHw.dr) theRx = i ;
+  }
+  if (theTx < 0 || theRx < 0) abort() ;
+
+  SimDmaChannel * theTxCh = &sSimDma[theTx] ;
+  SimDmaChannel * theRxCh = &sSimDma[theRx] ;
+  const uint8_t * theSrc = (const uint8_t *)theTxCh->pRead ;
+  uint8_t * theDst = (uint8_t *)theRxCh->pWrite ;
+
+  sSimNs += kSimDmaSetupNs ;
+  sSimCpuNs += kSimDmaSetupNs ;
+
+  for (uint i = 0 ; i < theTxCh->pCount ; i++)
+  {
+    uint8_t theOut = theTxCh->pConfig.pReadIncrement ? theSrc[i] : theSrc[0] ;
+    sSimNs += ByteNs() ;
+    uint8_t theIn = CardXfer(theOut) ;
+    if (theRxCh->pConfig.pWriteIncrement) theDst[i] = theIn ; else theDst[0] = theIn ;
+
+    if (sSimSniffChannel == theTx && theTxCh->pConfig.pSniff) SniffByte(theOut) ;
+    if (sSimSniffChannel == theRx && theRxCh->pConfig.pSniff) SniffByte(theIn) ;
+  }
+}
+
+bool dma_channel_is_busy(uint inChannel)
+{
+  // Transfer already ran in dma_start_channel_mask; the
+  // CPU was blocked for the whole data phase
+  // (accounted there as bus time only)
+  (void)inChannel ;
+  return false ;
+}
+
+void dma_channel_abort(uint inChannel)
+{
+  sSimDma[inChannel].pCount = 0 ;
+}
+
+//----------------------------------------------
+// Benchmark Helpers
+//----------------------------------------------
+static void ResetCard(void)
+{
+  uint8_t * theImage = sCard.pImage ;
+  memset(&sCard, 0, sizeof(sCard)) ;
+  sCard.pImage = theImage ;
+  sStatus = STA_NOINIT ;
+  sCardType = CT_NONE ;
+  sWritePhase = kPhaseIdle ;
+  sWriteResult = kSdDiskIdle ;
+}
+
+static bool InitCard(bool inUseDma)
+{
+  ResetCard() ;
+  if (sDmaTx >= 0) dma_channel_unclaim((uint)sDmaTx) ;
+  if (sDmaRx >= 0) dma_channel_unclaim((uint)sDmaRx) ;
+  sDmaTx = -1 ;
+  sDmaRx = -1 ;
+  sSimDmaAvailable = inUseDma ;
+  return disk_initialize(0) == 0 ;
+}
+
+static double MBps(uint64_t inBytes, uint64_t inNs)
+{
+  return inNs ? ((double)inBytes * 1000.0 / (double)inNs) : 0.0 ;
+}
+
+static void FillPattern(uint8_t * outBuff, uint32_t inLen, uint32_t inSeed)
+{
+  for (uint32_t i = 0 ; i < inLen ; i++)
+  {
+    outBuff[i] = (uint8_t)((i * 31u) ^ (inSeed * 7u) ^ (i >> 9)) ;
+  }
+}
+
+//----------------------------------------------
+// Benchmark: synchronous disk_write / disk_read
+//----------------------------------------------
+static void BenchSync(const char * inLabel, bool inUseDma, UINT inBlocks)
+{
+  static uint8_t sBuff[64 * 512] ;
+  static uint8_t sCheck[64 * 512] ;
+  uint32_t theChunk = inBlocks * 512 ;
+  bool theOk = InitCard(inUseDma) ;
+
+  uint64_t theStart = sSimNs ;
+  for (uint32_t theOffset = 0 ; theOk && theOffset < kSimBenchBytes ; theOffset += theChunk)
+  {
+    FillPattern(sBuff, theChunk, theOffset) ;
+    theOk = disk_write(0, sBuff, theOffset / 512, inBlocks) == RES_OK ;
+  }
+  uint64_t theWriteNs = sSimNs - theStart ;
+
+  theStart = sSimNs ;
+  for (uint32_t theOffset = 0 ; theOk && theOffset < kSimBenchBytes ; theOffset += theChunk)
+  {
+    theOk = disk_read(0, sBuff, theOffset / 512, inBlocks) == RES_OK ;
+    FillPattern(sCheck, theChunk, theOffset) ;
+    theOk = theOk && memcmp(sBuff, sCheck, theChunk) == 0 ;
+  }
+  uint64_t theReadNs = sSimNs - theStart ;
+
+  printf("  %-28s %2u blk  write %6.2f MB/s  read %6.2f MB/s  %s\n",
+         inLabel, inBlocks, MBps(kSimBenchBytes, theWriteNs), MBps(kSimBenchBytes, theReadNs),
+         theOk ? "ok" : "FAILED") ;
+}
+
+//----------------------------------------------
+// Benchmark: async write polled from a 1 kHz loop
+//----------------------------------------------
+static void BenchAsync(bool inUseDma)
+{
+  static uint8_t sBuff[kSimLoggerBlocks * 512] ;
+  uint32_t theChunk = kSimLoggerBlocks * 512 ;
+  bool theOk = InitCard(inUseDma) ;
+
+  uint64_t theStart = sSimNs ;
+  uint64_t theCpuStart = sSimCpuNs ;
+  uint64_t theMaxPollNs = 0 ;
+
+  for (uint32_t theOffset = 0 ; theOk && theOffset < kSimBenchBytes ; theOffset += theChunk)
+  {
+    FillPattern(sBuff, theChunk, theOffset) ;
+
+    uint64_t theCallStart = sSimNs ;
+    theOk = SdDisk_WriteStart(sBuff, theOffset / 512, kSimLoggerBlocks) ;
+    if (sSimNs - theCallStart > theMaxPollNs) theMaxPollNs = sSimNs - theCallStart ;
+
+    SdDiskState theState = kSdDiskBusy ;
+    while (theOk && theState == kSdDiskBusy)
+    {
+      // Rest of the main loop runs between polls
+      sSimNs += (uint64_t)kSimPollGapUs * 1000 ;
+
+      theCallStart = sSimNs ;
+      theState = SdDisk_WritePoll() ;
+      if (sSimNs - theCallStart > theMaxPollNs) theMaxPollNs = sSimNs - theCallStart ;
+    }
+    theOk = theOk && theState == kSdDiskDone ;
+  }
+
+  uint64_t theTotalNs = sSimNs - theStart ;
+  uint64_t theCpuNs = sSimCpuNs - theCpuStart ;
+
+  printf("  %-28s %2u blk  write %6.2f MB/s  driver %4.1f%% of loop  max call %5.1f us  %s\n",
+         inUseDma ? "async, DMA" : "async, CPU loop", kSimLoggerBlocks,
+         MBps(kSimBenchBytes, theTotalNs),
+         100.0 * (double)theCpuNs / (double)theTotalNs,
+         (double)theMaxPollNs / 1000.0,
+         theOk ? "ok" : "FAILED") ;
+}
+
+//----------------------------------------------
+// Function: main
+//----------------------------------------------
+int main(int argc, char ** argv)
+{
+  if (argc > 1) sSimProgramUs = (uint32_t)atoi(argv[1]) ;
+  if (argc > 2) sSimCpuByteNs = (uint32_t)atoi(argv[2]) ;
+
+  sCard.pImage = calloc(kSimCardSectors, 512) ;
+  if (sCard.pImage == NULL) return 1 ;
+
+  if (!InitCard(true))
+  {
+    printf("Card init failed (CRC errors: %u)\n", sCard.pCrcErrors) ;
+    return 1 ;
+  }
+
+  uint32_t theSdHz = spi_set_baudrate(spi1, kSpiSdBaudrate) ;
+  printf("SD driver benchmark: %lu KB, SPI %u Hz, program %u us/block, CPU byte overhead %u ns\n",
+         kSimBenchBytes / 1024, theSdHz, sSimProgramUs, sSimCpuByteNs) ;
+
+  BenchSync("sync, CPU loop", false, 1) ;
+  BenchSync("sync, DMA", true, 1) ;
+  BenchSync("sync, CPU loop", false, kSimLoggerBlocks) ;
+  BenchSync("sync, DMA", true, kSimLoggerBlocks) ;
+  BenchSync("sync, CPU loop", false, 16) ;
+  BenchSync("sync, DMA", true, 16) ;
+  BenchAsync(false) ;
+  BenchAsync(true) ;
+
+  printf("CRC errors seen by card: %u\n", sCard.pCrcErrors) ;
+  free(sCard.pImage) ;
+  return sCard.pCrcErrors ? 1 : 0 ;
+}
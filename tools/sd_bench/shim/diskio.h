@@ -0,0 +1,30 @@
+//----------------------------------------------
+// Host shim: FatFs diskio.h
+//----------------------------------------------
+#pragma once
+
+typedef BYTE DSTATUS ;
+
+typedef enum
+{
+  RES_OK = 0,
+  RES_ERROR,
+  RES_WRPRT,
+  RES_NOTRDY,
+  RES_PARERR
+} DRESULT ;
+
+#define STA_NOINIT          0x01
+#define STA_NODISK          0x02
+#define STA_PROTECT         0x04
+
+#define CTRL_SYNC           0
+#define GET_SECTOR_COUNT    1
+#define GET_SECTOR_SIZE     2
+#define GET_BLOCK_SIZE      3
+
+DSTATUS disk_initialize(BYTE inDrive) ;
+DSTATUS disk_status(BYTE inDrive) ;
+DRESULT disk_read(BYTE inDrive, BYTE * outBuff, LBA_t inSector, UINT inCount) ;
+DRESULT disk_write(BYTE inDrive, const BYTE * inBuff, LBA_t inSector, UINT inCount) ;
+DRESULT disk_ioctl(BYTE inDrive, BYTE inCmd, void * ioBuff) ;
@@ -0,0 +1,12 @@
+//----------------------------------------------
+// Host shim: FatFs basic types for diskio.c
+//----------------------------------------------
+#pragma once
+
+#include <stdint.h>
+
+typedef unsigned int UINT ;
+typedef uint8_t BYTE ;
+typedef uint16_t WORD ;
+typedef uint32_t DWORD ;
+typedef uint32_t LBA_t ;
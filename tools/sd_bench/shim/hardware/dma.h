@@ -0,0 +1,44 @@
+//----------------------------------------------
+// Host shim: hardware/dma.h (simulated channels
+// and sniffer)
+//----------------------------------------------
+#pragma once
+
+#include <stdint.h>
+#include <stdbool.h>
+
+typedef unsigned int uint ;
+
+enum dma_channel_transfer_size { DMA_SIZE_8 = 0, DMA_SIZE_16 = 1, DMA_SIZE_32 = 2 } ;
+
+#define DMA_SNIFF_CTRL_CALC_VALUE_CRC16     0x2
+
+typedef struct
+{
+  bool pReadIncrement ;
+  bool pWriteIncrement ;
+  bool pSniff ;
+} dma_channel_config ;
+
+typedef struct
+{
+  volatile uint32_t sniff_data ;
+} dma_hw_t ;
+
+extern dma_hw_t * dma_hw ;
+
+int dma_claim_unused_channel(bool inRequired) ;
+void dma_channel_unclaim(uint inChannel) ;
+dma_channel_config dma_channel_get_default_config(uint inChannel) ;
+void channel_config_set_transfer_data_size(dma_channel_config * ioConfig, enum dma_channel_transfer_size inSize) ;
+void channel_config_set_dreq(dma_channel_config * ioConfig, uint inDreq) ;
+void channel_config_set_read_increment(dma_channel_config * ioConfig, bool inIncrement) ;
+void channel_config_set_write_increment(dma_channel_config * ioConfig, bool inIncrement) ;
+void channel_config_set_sniff_enable(dma_channel_config * ioConfig, bool inSniff) ;
+void dma_sniffer_enable(uint inChannel, uint inMode, bool inForce) ;
+void dma_sniffer_disable(void) ;
+void dma_channel_configure(uint inChannel, const dma_channel_config * inConfig,
+  volatile void * inWrite, const volatile void * inRead, uint inCount, bool inTrigger) ;
+void dma_start_channel_mask(uint32_t inMask) ;
+bool dma_channel_is_busy(uint inChannel) ;
+void dma_channel_abort(uint inChannel) ;
@@ -0,0 +1,16 @@
+//----------------------------------------------
+// Host shim: hardware/gpio.h
+//----------------------------------------------
+#pragma once
+
+#include <stdbool.h>
+
+#define GPIO_IN             0
+#define GPIO_OUT            1
+#define GPIO_FUNC_SPI       1
+
+void gpio_init(unsigned inPin) ;
+void gpio_set_dir(unsigned inPin, bool inOut) ;
+void gpio_put(unsigned inPin, bool inValue) ;
+void gpio_set_function(unsigned inPin, unsigned inFunc) ;
+void gpio_pull_up(unsigned inPin) ;
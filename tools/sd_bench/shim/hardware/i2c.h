@@ -0,0 +1,8 @@
+//----------------------------------------------
+// Host shim: hardware/i2c.h (pins.h only)
+//----------------------------------------------
+#pragma once
+
+typedef struct i2c_inst i2c_inst_t ;
+extern i2c_inst_t * i2c0 ;
+extern i2c_inst_t * i2c1 ;
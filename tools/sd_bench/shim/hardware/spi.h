@@ -0,0 +1,25 @@
+//----------------------------------------------
+// Host shim: hardware/spi.h (simulated card)
+//----------------------------------------------
+#pragma once
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+typedef struct
+{
+  volatile uint32_t dr ;
+} spi_hw_t ;
+
+typedef struct spi_inst spi_inst_t ;
+extern spi_inst_t * spi0 ;
+extern spi_inst_t * spi1 ;
+
+unsigned spi_init(spi_inst_t * inSpi, unsigned inBaudrate) ;
+unsigned spi_set_baudrate(spi_inst_t * inSpi, unsigned inBaudrate) ;
+int spi_write_read_blocking(spi_inst_t * inSpi, const uint8_t * inSrc, uint8_t * outDst, size_t inLen) ;
+spi_hw_t * spi_get_hw(spi_inst_t * inSpi) ;
+unsigned spi_get_dreq(spi_inst_t * inSpi, int inIsTx) ;
+bool spi_is_busy(const spi_inst_t * inSpi) ;
+bool spi_is_readable(const spi_inst_t * inSpi) ;
@@ -0,0 +1,17 @@
+//----------------------------------------------
+// Host shim: pico/stdlib.h (simulated clock)
+//----------------------------------------------
+#pragma once
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+typedef unsigned int uint ;
+typedef uint64_t absolute_time_t ;
+
+uint32_t time_us_32(void) ;
+absolute_time_t make_timeout_time_ms(uint32_t inMs) ;
+bool time_reached(absolute_time_t inTime) ;
+void sleep_ms(uint32_t inMs) ;
+void tight_loop_contents(void) ;
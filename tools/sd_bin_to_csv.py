@@ -0,0 +1,170 @@
+#!/usr/bin/env python3
+"""
+Rocket Avionics SD Log Converter
+Converts binary FLTnnnnn.BIN flight logs written by the flight computer's
+SD logger into CSV.
+
+Usage:
+    python3 sd_bin_to_csv.py FLT00001.BIN [output.csv]
+
+If no output file is given, the CSV is written next to the input with a
+.csv extension.
+
+File layout (little-endian):
+    Sector 0   64-byte SdLogHeader, zero padded to 512 bytes
+    Offset 512 packed FlightSample records (pSampleSize bytes each)
+
+A log that was never closed (power loss in flight) has a sample count of
+0xFFFFFFFF. Its tail is preallocated space holding stale card data, so
+records are read until the first one that is implausible.
+"""
+
+import os
+import struct
+import sys
+
+HEADER_FORMAT = "<IHHIIIIffII24x"
+HEADER_SIZE = struct.calcsize(HEADER_FORMAT)
+DATA_OFFSET = 512
+
+SD_LOG_MAGIC = 0x474C4453
+SAMPLE_COUNT_OPEN = 0xFFFFFFFF
+
+# FlightSample (flight_storage.h), packed
+SAMPLE_FORMAT = "<IihIhiihHB3h3h3hB"
+SAMPLE_SIZE = struct.calcsize(SAMPLE_FORMAT)
+
+# FlightState values that can appear in a sample
+MAX_FLIGHT_STATE = 7
+
+CSV_COLUMNS = [
+    "time_ms", "altitude_m", "velocity_mps", "pressure_pa", "temperature_c",
+    "gps_lat", "gps_lon", "gps_speed_mps", "gps_heading_deg", "gps_sats",
+    "accel_x_g", "accel_y_g", "accel_z_g",
+    "gyro_x_dps", "gyro_y_dps", "gyro_z_dps",
+    "mag_x_gauss", "mag_y_gauss", "mag_z_gauss",
+    "state",
+]
+
+
+def read_header(data):
+    """Parse and validate the log header."""
+    if len(data) < HEADER_SIZE:
+        raise ValueError("file too short for header")
+
+    (magic, version, sample_size, file_number, sample_count, dropped,
+     rate_hz, max_alt, max_vel, flight_time_ms, max_write_us) = \
+        struct.unpack_from(HEADER_FORMAT, data, 0)
+
+    if magic != SD_LOG_MAGIC:
+        raise ValueError("not an SD flight log (magic 0x%08X)" % magic)
+    if sample_size != SAMPLE_SIZE:
+        raise ValueError("unsupported sample size %d (expected %d)" %
+                         (sample_size, SAMPLE_SIZE))
+
+    return {
+        "version": version,
+        "file_number": file_number,
+        "sample_count": sample_count,
+        "dropped": dropped,
+        "rate_hz": rate_hz,
+        "max_alt": max_alt,
+        "max_vel": max_vel,
+        "flight_time_ms": flight_time_ms,
+        "max_write_us": max_write_us,
+    }
+
+
+def iter_samples(data, header):
+    """Yield unpacked sample tuples."""
+    available = (len(data) - DATA_OFFSET) // SAMPLE_SIZE
+    closed = header["sample_count"] != SAMPLE_COUNT_OPEN
+    count = min(header["sample_count"], available) if closed else available
+
+    last_time = -1
+    for i in range(count):
+        sample = struct.unpack_from(SAMPLE_FORMAT, data,
+                                    DATA_OFFSET + i * SAMPLE_SIZE)
+        if not closed:
+            # Stop at the first record that was not written this flight
+            if sample[0] < last_time or sample[-1] > MAX_FLIGHT_STATE:
+                break
+            last_time = sample[0]
+        yield sample
+
+
+def format_row(s):
+    """Convert a sample tuple to CSV fields in engineering units."""
+    return [
+        "%d" % s[0],
+        "%.2f" % (s[1] / 100.0),
+        "%.2f" % (s[2] / 100.0),
+        "%d" % s[3],
+        "%.1f" % (s[4] / 10.0),
+        "%.6f" % (s[5] / 1e6),
+        "%.6f" % (s[6] / 1e6),
+        "%.2f" % (s[7] / 100.0),
+        "%.1f" % (s[8] / 10.0),
+        "%d" % s[9],
+        "%.3f" % (s[10] / 1000.0),
+        "%.3f" % (s[11] / 1000.0),
+        "%.3f" % (s[12] / 1000.0),
+        "%.1f" % (s[13] / 10.0),
+        "%.1f" % (s[14] / 10.0),
+        "%.1f" % (s[15] / 10.0),
+        "%.3f" % (s[16] / 1000.0),
+        "%.3f" % (s[17] / 1000.0),
+        "%.3f" % (s[18] / 1000.0),
+        "%d" % s[19],
+    ]
+
+
+def convert(in_path, out_path):
+    with open(in_path, "rb") as f:
+        data = f.read()
+
+    header = read_header(data)
+
+    rows = 0
+    with open(out_path, "w") as out:
+        out.write(",".join(CSV_COLUMNS) + "\n")
+        for sample in iter_samples(data, header):
+            out.write(",".join(format_row(sample)) + "\n")
+            rows += 1
+
+        out.write("# Summary\n")
+        out.write("# Samples: %d\n" % rows)
+        out.write("# Sample Rate: %d Hz\n" % header["rate_hz"])
+        out.write("# Dropped Samples: %d\n" % header["dropped"])
+        out.write("# Max Altitude: %.2f m\n" % header["max_alt"])
+        out.write("# Max Velocity: %.2f m/s\n" % header["max_vel"])
+        out.write("# Flight Time: %d ms\n" % header["flight_time_ms"])
+        out.write("# Max SD Write: %d us\n" % header["max_write_us"])
+        if header["sample_count"] == SAMPLE_COUNT_OPEN:
+            out.write("# Warning: log was not closed (recovered)\n")
+
+    return rows, header
+
+
+def main():
+    if len(sys.argv) < 2:
+        print(__doc__)
+        sys.exit(1)
+
+    in_path = sys.argv[1]
+    out_path = sys.argv[2] if len(sys.argv) > 2 else \
+        os.path.splitext(in_path)[0] + ".csv"
+
+    try:
+        rows, header = convert(in_path, out_path)
+    except (OSError, ValueError) as e:
+        print("Error: %s" % e)
+        sys.exit(1)
+
+    print("Wrote %d samples to %s" % (rows, out_path))
+    if header["dropped"]:
+        print("Warning: %d samples were dropped in flight" % header["dropped"])
+
+
+if __name__ == "__main__":
+    main()